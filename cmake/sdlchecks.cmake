@@ -425,7 +425,7 @@ endmacro()
 macro(CheckX11)
   cmake_push_check_state(RESET)
   if(SDL_X11)
-    foreach(_LIB X11 Xext Xcursor Xi Xfixes Xrandr Xrender Xss)
+    foreach(_LIB X11 Xext Xcursor Xi Xfixes Xpresent Xrandr Xrender Xss)
         FindLibraryAndSONAME("${_LIB}")
     endforeach()
 
@@ -453,6 +453,7 @@ macro(CheckX11)
     find_file(HAVE_XINPUT2_H NAMES "X11/extensions/XInput2.h" HINTS "${X_INCLUDEDIR}")
     find_file(HAVE_XRANDR_H NAMES "X11/extensions/Xrandr.h" HINTS "${X_INCLUDEDIR}")
     find_file(HAVE_XFIXES_H_ NAMES "X11/extensions/Xfixes.h" HINTS "${X_INCLUDEDIR}")
+    find_file(HAVE_XPRESENT_H NAMES "X11/extensions/Xpresent.h" HINTS "${X_INCLUDEDIR}")
     find_file(HAVE_XRENDER_H NAMES "X11/extensions/Xrender.h" HINTS "${X_INCLUDEDIR}")
     find_file(HAVE_XSS_H NAMES "X11/extensions/scrnsaver.h" HINTS "${X_INCLUDEDIR}")
     find_file(HAVE_XSHAPE_H NAMES "X11/extensions/shape.h" HINTS "${X_INCLUDEDIR}")
@@ -592,6 +593,17 @@ macro(CheckX11)
         set(HAVE_X11_XFIXES TRUE)
       endif()
 
+      # Present events arrive as generic events and update regions are XFixes regions
+      if(SDL_X11_XPRESENT AND HAVE_XPRESENT_H AND XPRESENT_LIB AND HAVE_X11_XFIXES AND SDL_VIDEO_DRIVER_X11_SUPPORTS_GENERIC_EVENTS)
+        if(HAVE_X11_SHARED)
+          set(SDL_VIDEO_DRIVER_X11_DYNAMIC_XPRESENT "\"${XPRESENT_LIB_SONAME}\"")
+        else()
+          list(APPEND EXTRA_LIBS ${XPRESENT_LIB})
+        endif()
+        set(SDL_VIDEO_DRIVER_X11_XPRESENT 1)
+        set(HAVE_X11_XPRESENT TRUE)
+      endif()
+
       if(SDL_X11_XRANDR AND HAVE_XRANDR_H AND XRANDR_LIB)
         if(HAVE_X11_SHARED)
           set(SDL_VIDEO_DRIVER_X11_DYNAMIC_XRANDR "\"${XRANDR_LIB_SONAME}\"")
@@ -884,6 +896,7 @@ macro(CheckOpenGL)
     if(HAVE_OPENGL)
       set(SDL_VIDEO_OPENGL 1)
       set(SDL_VIDEO_RENDER_OGL 1)
+      set(SDL_VIDEO_RENDER_OGL3 1)
     endif()
   endif()
 endmacro()
@@ -909,6 +922,7 @@ macro(CheckOpenGLES)
         set(HAVE_OPENGLES TRUE)
         set(SDL_VIDEO_OPENGL_ES2 1)
         set(SDL_VIDEO_RENDER_OGL_ES2 1)
+        set(SDL_VIDEO_RENDER_OGL_ES3 1)
     endif()
   endif()
 endmacro()
@@ -1842,6 +1842,126 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_BATCHING  "SDL_RENDER_BATCHING"
 
+/**
+ * A variable controlling whether the 2D render API optimizes batches before
+ * sending them to the render backend.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Submit render commands exactly as they were recorded (default)
+ * - "1": Drop redundant state changes, reorder draws that don't overlap so
+ *   draws using the same texture are next to each other, and merge adjacent
+ *   compatible draws into a single draw call.
+ *
+ * This only makes a difference when batching is enabled, see
+ * SDL_HINT_RENDER_BATCHING. The output is the same either way.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_OPTIMIZE_BATCHES  "SDL_RENDER_OPTIMIZE_BATCHES"
+
+/**
+ * A variable controlling whether small static textures are packed into
+ * shared atlas textures.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Every texture gets its own texture in the render backend (default)
+ * - "1": Static textures up to 256x256 are packed into larger textures shared
+ *   with other textures of the same format and scale mode, so draws using
+ *   different textures can be batched together.
+ *
+ * A copy of the pixels of packed textures is kept in system memory, and
+ * SDL_GL_BindTexture() can't be used with them.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_TEXTURE_ATLAS  "SDL_RENDER_TEXTURE_ATLAS"
+
+/**
+ * A variable controlling whether draws that are entirely outside the
+ * viewport and clip rect are dropped before they are queued.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Every draw is sent to the render backend, which clips it (default)
+ * - "1": SDL_RenderCopy(), SDL_RenderCopyEx(), SDL_RenderCopyBatch() and
+ *   SDL_RenderGeometry() check the bounds of what they draw against the
+ *   viewport and clip rect, and skip draws that can't touch any pixel.
+ *
+ * The output is the same either way. Culled draws are counted in
+ * SDL_RenderStats.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_CULLING  "SDL_RENDER_CULLING"
+
+/**
+ * A variable controlling whether the renderer submits frames from a
+ * dedicated render thread.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Rendering happens on the thread calling the render API (default)
+ * - "1": SDL_RenderPresent() hands the finished frame to a render thread
+ *   that owns the graphics context and returns right away, so the
+ *   application can build the next frame while the previous one is being
+ *   drawn and presented.
+ *
+ * Calls that need the graphics context, like texture updates, reading
+ * pixels or SDL_RenderFlush(), wait for the render thread to finish the
+ * previous frame first. Batching is always enabled in this mode.
+ *
+ * This is currently only supported by the OpenGL renderer, other renderers
+ * ignore this hint.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_THREAD  "SDL_RENDER_THREAD"
+
+/**
+ * A variable setting how many megabytes of memory the textures of a renderer
+ * should use at most.
+ *
+ * When the textures use more than this, restorable textures that haven't
+ * been drawn recently are evicted until they fit again, see
+ * SDL_SetTextureRestorable(). Other textures are counted but never evicted.
+ *
+ * This hint should be set before the renderer is created.
+ *
+ * By default there is no budget.
+ */
+#define SDL_HINT_RENDER_TEXTURE_BUDGET  "SDL_RENDER_TEXTURE_BUDGET"
+
+/**
+ * A variable controlling whether the renderer measures how long the GPU
+ * takes to draw each frame.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": GPU time isn't measured (default)
+ * - "1": GPU time is measured with timer queries, if the renderer supports
+ *   them, and reported by SDL_RenderGetStats()
+ *
+ * This is currently only supported by the OpenGL renderer.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_GPU_TIMING  "SDL_RENDER_GPU_TIMING"
+
+/**
+ * A variable controlling whether render statistics are logged.
+ *
+ * The variable is a number of frames, the statistics of every Nth frame
+ * presented are logged with SDL_Log(). The default is "0", which never logs
+ * them.
+ *
+ * This hint is checked when the renderer is created.
+ *
+ * \sa SDL_RenderGetStats
+ */
+#define SDL_HINT_RENDER_LOG_STATS  "SDL_RENDER_LOG_STATS"
+
 /**
  * A variable controlling how the 2D render API renders lines
  *
@@ -1901,7 +2021,10 @@ extern "C" {
  * - "opengl"
  * - "opengles2"
  * - "opengles"
+ * - "opengl3"
+ * - "opengles3"
  * - "metal"
+ * - "vulkan"
  * - "software"
  *
  * The default varies by platform, but it's the first one in the list that is
@@ -1935,6 +2058,45 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_OPENGL_SHADERS      "SDL_RENDER_OPENGL_SHADERS"
 
+/**
+ * A variable specifying a directory where the OpenGL render driver caches
+ * its linked shader programs.
+ *
+ * The directory must already exist. Cached programs are specific to the
+ * driver they were created with, and are rebuilt if the driver changes.
+ *
+ * This requires GL_ARB_get_program_binary.
+ *
+ * By default shader programs are not cached.
+ */
+#define SDL_HINT_RENDER_OPENGL_SHADER_CACHE "SDL_RENDER_OPENGL_SHADER_CACHE"
+
+/**
+ * A variable specifying a directory where the Vulkan render driver keeps its
+ * pipeline cache.
+ *
+ * The directory must already exist. The cache is loaded when the renderer is
+ * created and saved when it's destroyed, and it's ignored if it was written
+ * by a different device or driver.
+ *
+ * By default the pipeline cache is not kept across runs.
+ */
+#define SDL_HINT_RENDER_VULKAN_PIPELINE_CACHE "SDL_RENDER_VULKAN_PIPELINE_CACHE"
+
+/**
+ * A variable controlling how many megabytes of released render targets the
+ * OpenGL render driver keeps for reuse.
+ *
+ * Destroyed render target textures are kept with their framebuffer objects,
+ * and reused by the next render target created with the same size and
+ * format, until they exceed this size or go unused for a couple of seconds.
+ *
+ * Set this to "0" to free render targets right away.
+ *
+ * By default up to 32 megabytes of render targets are kept.
+ */
+#define SDL_HINT_RENDER_OPENGL_TARGET_POOL  "SDL_RENDER_OPENGL_TARGET_POOL"
+
 /**
  * A variable controlling the scaling quality
  *
@@ -1948,6 +2110,21 @@ extern "C" {
  */
 #define SDL_HINT_RENDER_SCALE_QUALITY       "SDL_RENDER_SCALE_QUALITY"
 
+/**
+ * A variable controlling how many threads the software renderer uses
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Use one thread per CPU core, up to 16
+ * - "1": Render on the calling thread only
+ * - "N": Use N threads, up to 16
+ *
+ * By default the software renderer uses one thread per CPU core.
+ *
+ * This hint should be set before the renderer is created.
+ */
+#define SDL_HINT_RENDER_SOFTWARE_THREADS    "SDL_RENDER_SOFTWARE_THREADS"
+
 /**
  * A variable controlling whether updates to the SDL screen surface should be
  * synchronized with the vertical refresh, to avoid tearing.
@@ -2442,6 +2619,20 @@ extern "C" {
  */
 #define SDL_HINT_VIDEO_X11_NET_WM_PING      "SDL_VIDEO_X11_NET_WM_PING"
 
+/**
+ * A variable controlling whether the X11 Present extension should be used to
+ * show window framebuffers.
+ *
+ * This variable can be set to the following values:
+ *
+ * - "0": Copy framebuffers to the window with XShmPutImage
+ * - "1": Flip framebuffers with XPresentPixmap
+ *
+ * By default SDL uses XShmPutImage. The hint is checked when the window
+ * framebuffer is created.
+ */
+#define SDL_HINT_VIDEO_X11_PRESENT          "SDL_VIDEO_X11_PRESENT"
+
 /**
  * A variable forcing the visual ID chosen for new X11 windows
  */
@@ -136,6 +136,44 @@ typedef enum SDL_RendererFlip
     SDL_FLIP_VERTICAL = 0x00000002     /**< flip vertically */
 } SDL_RendererFlip;
 
+/**
+ * Counters describing the work done for a frame, see SDL_RenderGetStats()
+ */
+typedef struct SDL_RenderStats
+{
+    Uint32 frame;                   /**< The number of frames presented before this one */
+
+    Uint32 viewport_commands;       /**< Viewport changes sent to the backend */
+    Uint32 cliprect_commands;       /**< Clip rectangle changes sent to the backend */
+    Uint32 draw_color_commands;     /**< Draw color changes sent to the backend */
+    Uint32 clear_commands;          /**< Clears sent to the backend */
+    Uint32 draw_points_commands;    /**< Point draws sent to the backend */
+    Uint32 draw_lines_commands;     /**< Line draws sent to the backend */
+    Uint32 fill_rects_commands;     /**< Rectangle fills sent to the backend */
+    Uint32 copy_commands;           /**< Texture copies sent to the backend */
+    Uint32 geometry_commands;       /**< Geometry draws sent to the backend */
+    Uint32 update_texture_commands; /**< Texture updates queued in order with the draws */
+    Uint32 vertices;                /**< Vertices drawn, rectangles count as 4 */
+    Uint32 vertex_bytes;            /**< Bytes of vertex data sent to the backend */
+    Uint32 culled_draws;            /**< Draws skipped for being outside the viewport and clip rect */
+
+    Uint32 flushes;                 /**< Command queue flushes, including the one for presenting */
+    Uint32 texture_flushes;         /**< Flushes because a texture in use was updated */
+    Uint32 target_flushes;          /**< Flushes because the render target changed */
+    Uint32 read_pixels_flushes;     /**< Flushes because pixels were read back */
+    Uint32 no_batching_flushes;     /**< Flushes because batching is disabled */
+
+    Uint32 texture_binds;           /**< Textures bound by the backend */
+    Uint32 blend_changes;           /**< Blend mode changes made by the backend */
+    Uint32 shader_changes;          /**< Shader changes made by the backend */
+    Uint64 texture_upload_bytes;    /**< Bytes of pixel data uploaded to textures */
+    Uint64 texture_bytes;           /**< Memory used by textures when the frame was presented */
+    Uint32 evicted_textures;        /**< Restorable textures evicted to stay in the texture budget */
+    Uint32 restored_textures;       /**< Evicted textures uploaded again to be used */
+
+    float gpu_time;                 /**< GPU time of a recent frame in milliseconds, or -1 if unknown */
+} SDL_RenderStats;
+
 /**
  * A structure representing rendering state
  */
@@ -148,6 +186,30 @@ typedef struct SDL_Renderer SDL_Renderer;
 struct SDL_Texture;
 typedef struct SDL_Texture SDL_Texture;
 
+/**
+ * A recorded sequence of rendering commands that can be replayed
+ */
+struct SDL_RenderCommandList;
+typedef struct SDL_RenderCommandList SDL_RenderCommandList;
+
+/**
+ * A ring of buffers that rendered frames are captured into
+ */
+struct SDL_RenderCapture;
+typedef struct SDL_RenderCapture SDL_RenderCapture;
+
+/**
+ * A frame captured with SDL_RenderCaptureFrame()
+ */
+typedef struct SDL_RenderCapturedFrame
+{
+    Uint32 frame;       /**< The frame number SDL_RenderCaptureFrame() returned */
+    SDL_Rect rect;      /**< The area that was read, clipped to the viewport */
+    Uint32 format;      /**< The SDL_PixelFormatEnum value of the pixel data */
+    void *pixels;       /**< The pixel data, or NULL if the frame couldn't be read */
+    int pitch;          /**< The pitch of the pixel data, of the Y plane for YUV formats */
+} SDL_RenderCapturedFrame;
+
 /* Function prototypes */
 
 /**
@@ -566,6 +628,32 @@ extern DECLSPEC int SDLCALL SDL_SetTextureUserData(SDL_Texture * texture,
  */
 extern DECLSPEC void * SDLCALL SDL_GetTextureUserData(SDL_Texture * texture);
 
+/**
+ * Set whether a texture may be evicted to keep within the texture budget.
+ *
+ * A restorable texture keeps a copy of its pixels in system memory. When the
+ * textures of a renderer use more memory than SDL_HINT_RENDER_TEXTURE_BUDGET
+ * allows, the restorable textures that were drawn least recently are freed,
+ * and they're uploaded again from the copy the next time they're drawn.
+ *
+ * Only static textures can be restorable. Call this before the texture's
+ * pixels are first updated, pixels uploaded before aren't kept. Textures
+ * packed into the texture atlas aren't evicted on their own.
+ *
+ * \param texture the texture to update.
+ * \param restorable SDL_TRUE to keep a copy of the pixels so the texture can
+ *                   be evicted, SDL_FALSE to free the copy.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderGetStats
+ * \sa SDL_UpdateTexture
+ */
+extern DECLSPEC int SDLCALL SDL_SetTextureRestorable(SDL_Texture * texture,
+                                                     SDL_bool restorable);
+
 /**
  * Update the given texture rectangle with new pixel data.
  *
@@ -1624,6 +1712,47 @@ extern DECLSPEC int SDLCALL SDL_RenderCopyExF(SDL_Renderer * renderer,
                                             const SDL_FPoint *center,
                                             const SDL_RendererFlip flip);
 
+/**
+ * Copy many portions of a texture to the current rendering target at once.
+ *
+ * This draws `count` sprites from the same texture as a single batch, which
+ * is much faster than calling SDL_RenderCopyExF() for each of them. It is
+ * meant for particle systems, tile maps and similar scenes with thousands
+ * of sprites.
+ *
+ * Sprites are rotated around the center of their destination rectangle.
+ * When `colors` is given, it is used instead of the texture color and alpha
+ * modulation, like SDL_RenderGeometry() does.
+ *
+ * \param renderer the rendering context.
+ * \param texture the source texture.
+ * \param srcrects an array of `count` source rectangles, or NULL to use the
+ *                 entire texture for every sprite.
+ * \param dstrects an array of `count` destination rectangles.
+ * \param angles an array of `count` angles in degrees, or NULL to draw the
+ *               sprites without rotation.
+ * \param flips an array of `count` SDL_RendererFlip values, or NULL to draw
+ *              the sprites without flipping.
+ * \param colors an array of `count` colors to modulate the sprites with, or
+ *               NULL to use the texture color and alpha modulation.
+ * \param count the number of sprites to draw.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderCopyExF
+ * \sa SDL_RenderGeometry
+ */
+extern DECLSPEC int SDLCALL SDL_RenderCopyBatch(SDL_Renderer *renderer,
+                                                SDL_Texture *texture,
+                                                const SDL_Rect *srcrects,
+                                                const SDL_FRect *dstrects,
+                                                const double *angles,
+                                                const SDL_RendererFlip *flips,
+                                                const SDL_Color *colors,
+                                                int count);
+
 /**
  * Render a list of triangles, optionally using a texture and indices into the
  * vertex array Color and alpha modulation is done per vertex
@@ -1713,6 +1842,236 @@ extern DECLSPEC int SDLCALL SDL_RenderReadPixels(SDL_Renderer * renderer,
                                                  Uint32 format,
                                                  void *pixels, int pitch);
 
+/**
+ * The callback used to deliver pixels read with SDL_RenderReadPixelsAsync().
+ *
+ * \param userdata what was passed as `userdata` to
+ *                 SDL_RenderReadPixelsAsync().
+ * \param rect the area that was read, clipped to the viewport.
+ * \param format an SDL_PixelFormatEnum value of the format of the pixel data.
+ * \param pixels the pixel data, or NULL if the pixels couldn't be read. It is
+ *               only valid until the callback returns.
+ * \param pitch the pitch of the `pixels` data.
+ *
+ * \since This datatype is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderReadPixelsAsync
+ */
+typedef void (SDLCALL *SDL_RenderReadPixelsCallback)(void *userdata,
+                                                     const SDL_Rect *rect,
+                                                     Uint32 format,
+                                                     const void *pixels,
+                                                     int pitch);
+
+/**
+ * Read pixels from the current rendering target without waiting for them.
+ *
+ * This queues a read of the current rendering target, the pixels are passed
+ * to `callback` once the GPU is done with them, usually a frame or two
+ * later. Callbacks are called in the order the reads were requested, from
+ * SDL_RenderPresent(), SDL_RenderPollReadPixels() or SDL_DestroyRenderer().
+ * If the renderer can't read pixels asynchronously, the pixels are read
+ * with SDL_RenderReadPixels() and the callback is called before this
+ * function returns.
+ *
+ * This is much cheaper than SDL_RenderReadPixels() for capturing rendered
+ * output every frame, since it doesn't stall the rendering pipeline.
+ *
+ * \param renderer the rendering context.
+ * \param rect an SDL_Rect structure representing the area to read, or NULL
+ *             for the entire render target.
+ * \param format an SDL_PixelFormatEnum value of the desired format of the
+ *               pixel data, or 0 to use the format of the rendering target.
+ * \param callback the function to call with the pixels.
+ * \param userdata a pointer that is passed to `callback`.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderPollReadPixels
+ * \sa SDL_RenderReadPixels
+ */
+extern DECLSPEC int SDLCALL SDL_RenderReadPixelsAsync(SDL_Renderer *renderer,
+                                                      const SDL_Rect *rect,
+                                                      Uint32 format,
+                                                      SDL_RenderReadPixelsCallback callback,
+                                                      void *userdata);
+
+/**
+ * Deliver the pixels of finished SDL_RenderReadPixelsAsync() calls.
+ *
+ * \param renderer the rendering context.
+ * \param wait SDL_TRUE to wait for all pending reads to finish.
+ * \returns the number of reads that are still pending, or a negative error
+ *          code on failure; call SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderReadPixelsAsync
+ */
+extern DECLSPEC int SDLCALL SDL_RenderPollReadPixels(SDL_Renderer *renderer, SDL_bool wait);
+
+/**
+ * The callback used to deliver frames captured with SDL_RenderCaptureFrame().
+ *
+ * This is called on the capture's worker thread.
+ *
+ * \param userdata what was passed as `userdata` to SDL_CreateRenderCapture().
+ * \param frame the captured frame, its pixels are only valid until the
+ *              callback returns.
+ *
+ * \since This datatype is available since SDL 2.32.0.
+ *
+ * \sa SDL_CreateRenderCapture
+ */
+typedef void (SDLCALL *SDL_RenderCaptureCallback)(void *userdata,
+                                                  const SDL_RenderCapturedFrame *frame);
+
+/**
+ * Create a ring of buffers to capture rendered frames into.
+ *
+ * A capture is meant for recording the output of a renderer every frame.
+ * Frames are read with SDL_RenderReadPixelsAsync(), so the rendering
+ * pipeline isn't stalled, and converted to `format` on a worker thread. The
+ * format can be a YUV format, to feed a video encoder directly.
+ *
+ * Up to `depth` frames can be in flight at once. If `callback` is NULL, the
+ * frames are fetched with SDL_RenderGetCapturedFrame() and given back with
+ * SDL_RenderReleaseCapturedFrame(), otherwise they are passed to `callback`
+ * on the worker thread.
+ *
+ * \param renderer the rendering context.
+ * \param format an SDL_PixelFormatEnum value of the format to convert the
+ *               frames to, or 0 to use the format of the rendering target.
+ * \param depth the number of frames that can be in flight, at least 1.
+ * \param callback the function to call with each frame, or NULL to poll
+ *                 for them.
+ * \param userdata a pointer that is passed to `callback`.
+ * \returns the capture or NULL on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderCaptureFrame
+ * \sa SDL_DestroyRenderCapture
+ */
+extern DECLSPEC SDL_RenderCapture *SDLCALL SDL_CreateRenderCapture(SDL_Renderer *renderer,
+                                                                   Uint32 format, int depth,
+                                                                   SDL_RenderCaptureCallback callback,
+                                                                   void *userdata);
+
+/**
+ * Capture the current rendering target.
+ *
+ * This should be called after rendering and before SDL_RenderPresent(). The
+ * frame is numbered with the frame count of SDL_RenderGetStats(), so dropped
+ * frames show up as gaps.
+ *
+ * This fails if all the buffers of the capture are in use, either because
+ * the reads haven't finished or because the frames haven't been released.
+ *
+ * \param capture the capture to read the frame into.
+ * \param rect an SDL_Rect structure representing the area to read, or NULL
+ *             for the entire render target.
+ * \param frame a pointer filled in with the number of the frame, may be
+ *              NULL.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderGetCapturedFrame
+ */
+extern DECLSPEC int SDLCALL SDL_RenderCaptureFrame(SDL_RenderCapture *capture,
+                                                   const SDL_Rect *rect,
+                                                   Uint32 *frame);
+
+/**
+ * Get the oldest captured frame that is ready.
+ *
+ * Frames are returned in the order they were captured. The frame keeps its
+ * buffer until it's given back with SDL_RenderReleaseCapturedFrame().
+ *
+ * This can't be used with a capture that has a callback.
+ *
+ * \param capture the capture to get a frame from.
+ * \param wait SDL_TRUE to wait for the oldest frame if none is ready.
+ * \param frame an SDL_RenderCapturedFrame structure filled in with the frame.
+ * \returns 1 if a frame was returned, 0 if none is ready, or a negative error
+ *          code on failure; call SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderCaptureFrame
+ * \sa SDL_RenderReleaseCapturedFrame
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetCapturedFrame(SDL_RenderCapture *capture,
+                                                       SDL_bool wait,
+                                                       SDL_RenderCapturedFrame *frame);
+
+/**
+ * Give back the buffer of a frame from SDL_RenderGetCapturedFrame().
+ *
+ * \param capture the capture the frame came from.
+ * \param frame the frame to release, its pixels can't be used afterwards.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderGetCapturedFrame
+ */
+extern DECLSPEC void SDLCALL SDL_RenderReleaseCapturedFrame(SDL_RenderCapture *capture,
+                                                            const SDL_RenderCapturedFrame *frame);
+
+/**
+ * Destroy a capture.
+ *
+ * Frames that are still being read are finished first, they are dropped
+ * without being delivered. Captures that are still around when their
+ * renderer is destroyed are destroyed with it.
+ *
+ * \param capture the capture to destroy.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_CreateRenderCapture
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyRenderCapture(SDL_RenderCapture *capture);
+
+/**
+ * Mark a part of the window as changed in the current frame.
+ *
+ * Applications that only change small parts of the window from one frame to
+ * the next, like most user interfaces, can describe what changed with damage
+ * rectangles. Damage makes two things cheaper:
+ *
+ * - Where the renderer knows what the window contained in the previous
+ *   frames, drawing is clipped to the damaged area and everything else keeps
+ *   the contents of the previous frame. This includes SDL_RenderClear().
+ * - SDL_RenderPresent() passes the damage on to the window system, which only
+ *   needs to update that part of the screen. This uses
+ *   EGL_KHR_swap_buffers_with_damage and EGL_KHR_partial_update where
+ *   available, and updates only the damaged part of the window surface with
+ *   the software renderer.
+ *
+ * In a frame with damage, the application still draws the whole frame, but
+ * everything outside the damage must look the same as in the previous frame.
+ * Damage has to be added before anything is drawn to the window in the
+ * frame. It's cleared when the frame is presented, and frames without
+ * damage are drawn and presented in full, as usual.
+ *
+ * \param renderer the rendering context.
+ * \param rect the changed part of the window in rendering coordinates, or
+ *             NULL for the whole window.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderPresent
+ */
+extern DECLSPEC int SDLCALL SDL_RenderAddDamageRect(SDL_Renderer *renderer, const SDL_Rect *rect);
+
 /**
  * Update the screen with any rendering performed since the previous call.
  *
@@ -1755,6 +2114,27 @@ extern DECLSPEC int SDLCALL SDL_RenderReadPixels(SDL_Renderer * renderer,
  */
 extern DECLSPEC void SDLCALL SDL_RenderPresent(SDL_Renderer * renderer);
 
+/**
+ * Get the statistics of the last frame presented with SDL_RenderPresent().
+ *
+ * The command counters describe what was sent to the backend after batching,
+ * so they can be lower than the number of calls made by the application.
+ *
+ * The GPU time is only measured if SDL_HINT_RENDER_GPU_TIMING is set and the
+ * renderer supports it. The result arrives a few frames late, so it is the
+ * time of the most recent frame the GPU has finished.
+ *
+ * \param renderer the rendering context.
+ * \param stats an SDL_RenderStats structure filled in with the statistics.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderPresent
+ */
+extern DECLSPEC int SDLCALL SDL_RenderGetStats(SDL_Renderer *renderer, SDL_RenderStats *stats);
+
 /**
  * Destroy the specified texture.
  *
@@ -1815,6 +2195,89 @@ extern DECLSPEC void SDLCALL SDL_DestroyRenderer(SDL_Renderer * renderer);
  */
 extern DECLSPEC int SDLCALL SDL_RenderFlush(SDL_Renderer * renderer);
 
+/**
+ * Start recording rendering commands into a command list.
+ *
+ * Until SDL_RenderEndCommandList() is called, rendering functions like
+ * SDL_RenderCopy() and SDL_RenderFillRect() are recorded instead of drawn.
+ * Anything that was queued before this call is drawn first. Changing the
+ * render target, reading pixels and presenting fail while recording.
+ *
+ * Command lists are meant for content that doesn't change between frames,
+ * like static UI layers: they are recorded once and replayed every frame
+ * with SDL_RenderReplayCommandList(), which skips all the work of queueing the
+ * commands again.
+ *
+ * \param renderer the rendering context.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderEndCommandList
+ */
+extern DECLSPEC int SDLCALL SDL_RenderBeginCommandList(SDL_Renderer *renderer);
+
+/**
+ * Stop recording rendering commands and return them as a command list.
+ *
+ * The command list keeps the state it was recorded with: the draw colors,
+ * blend modes, viewports, clip rectangles and render scale. It doesn't keep
+ * the render target, a command list is drawn to the current target when it
+ * is replayed. Textures are used with their contents at the time the list
+ * is replayed.
+ *
+ * \param renderer the rendering context.
+ * \returns the recorded command list or NULL on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderBeginCommandList
+ * \sa SDL_RenderReplayCommandList
+ * \sa SDL_DestroyRenderCommandList
+ */
+extern DECLSPEC SDL_RenderCommandList *SDLCALL SDL_RenderEndCommandList(SDL_Renderer *renderer);
+
+/**
+ * Draw a recorded command list to the current rendering target.
+ *
+ * The list can be moved with an offset, which is applied to the viewports
+ * it was recorded with. Anything that was drawn outside of those viewports
+ * stays clipped.
+ *
+ * Draws that use a texture that was destroyed since the list was recorded
+ * are skipped.
+ *
+ * \param renderer the rendering context.
+ * \param list the command list to draw.
+ * \param x the horizontal offset to draw the list at.
+ * \param y the vertical offset to draw the list at.
+ * \returns 0 on success or a negative error code on failure; call
+ *          SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderEndCommandList
+ */
+extern DECLSPEC int SDLCALL SDL_RenderReplayCommandList(SDL_Renderer *renderer,
+                                                        SDL_RenderCommandList *list,
+                                                        float x, float y);
+
+/**
+ * Destroy a command list.
+ *
+ * Command lists that are still around when their renderer is destroyed are
+ * destroyed with it.
+ *
+ * \param list the command list to destroy.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_RenderEndCommandList
+ */
+extern DECLSPEC void SDLCALL SDL_DestroyRenderCommandList(SDL_RenderCommandList *list);
+
 
 /**
  * Bind an OpenGL/ES/ES2 texture to the current context.
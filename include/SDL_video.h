@@ -1806,6 +1806,49 @@ extern DECLSPEC int SDLCALL SDL_SetWindowHitTest(SDL_Window * window,
  */
 extern DECLSPEC int SDLCALL SDL_FlashWindow(SDL_Window * window, SDL_FlashOperation operation);
 
+/**
+ * Timing feedback for a single presented frame.
+ *
+ * \sa SDL_GetWindowPresentFeedback
+ *
+ * \since This datatype is available since SDL 2.32.0.
+ */
+typedef struct SDL_WindowPresentFeedback
+{
+    Uint64 frame;   /**< Frames completed since feedback started, skipped frames included */
+    Uint64 msc;     /**< Media stream counter (vblank count) the frame became visible at */
+    Uint64 ust;     /**< Unadjusted system time the frame became visible, in microseconds */
+} SDL_WindowPresentFeedback;
+
+/**
+ * Get timing feedback for a frame presented to a window.
+ *
+ * Each time a frame presented with SDL_UpdateWindowSurface() or
+ * SDL_GL_SwapWindow() actually reaches the screen, the video driver records
+ * when it happened. This function returns the oldest recorded frame that has
+ * not been returned yet. Only a small number of frames are kept; if the
+ * application doesn't call this regularly, older entries are dropped and the
+ * gap is visible in `frame`.
+ *
+ * Feedback is collected from the first call of this function on, so the
+ * first call usually returns 0.
+ *
+ * This is currently only implemented on X11 when the Present extension is
+ * available.
+ *
+ * \param window the window to query.
+ * \param feedback filled in with the frame timing.
+ * \returns 1 if `feedback` was filled in, 0 if no new frame has completed,
+ *          or a negative error code on failure or if present feedback is
+ *          not supported; call SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL 2.32.0.
+ *
+ * \sa SDL_UpdateWindowSurface
+ * \sa SDL_GL_SwapWindow
+ */
+extern DECLSPEC int SDLCALL SDL_GetWindowPresentFeedback(SDL_Window * window, SDL_WindowPresentFeedback * feedback);
+
 /**
  * Destroy a window.
  *
@@ -52,6 +52,10 @@
 #endif
 
 #ifndef SDL_RENDER_DISABLED
+/* The software renderer is always available */
+#ifndef SDL_VIDEO_RENDER_SW
+#define SDL_VIDEO_RENDER_SW 1
+#endif
 /* define the not defined ones as 0 */
 #ifndef SDL_VIDEO_RENDER_D3D
 #define SDL_VIDEO_RENDER_D3D 0
@@ -65,6 +69,9 @@
 #ifndef SDL_VIDEO_RENDER_METAL
 #define SDL_VIDEO_RENDER_METAL 0
 #endif
+#ifndef SDL_VIDEO_RENDER_VULKAN
+#define SDL_VIDEO_RENDER_VULKAN 0
+#endif
 #ifndef SDL_VIDEO_RENDER_OGL
 #define SDL_VIDEO_RENDER_OGL  0
 #endif
@@ -74,6 +81,12 @@
 #ifndef SDL_VIDEO_RENDER_OGL_ES2
 #define SDL_VIDEO_RENDER_OGL_ES2 0
 #endif
+#ifndef SDL_VIDEO_RENDER_OGL3
+#define SDL_VIDEO_RENDER_OGL3 0
+#endif
+#ifndef SDL_VIDEO_RENDER_OGL_ES3
+#define SDL_VIDEO_RENDER_OGL_ES3 0
+#endif
 #ifndef SDL_VIDEO_RENDER_DIRECTFB
 #define SDL_VIDEO_RENDER_DIRECTFB 0
 #endif
@@ -97,12 +110,18 @@
 #define SDL_VIDEO_RENDER_D3D12 0
 #undef SDL_VIDEO_RENDER_METAL
 #define SDL_VIDEO_RENDER_METAL 0
+#undef SDL_VIDEO_RENDER_VULKAN
+#define SDL_VIDEO_RENDER_VULKAN 0
 #undef SDL_VIDEO_RENDER_OGL
 #define SDL_VIDEO_RENDER_OGL  0
 #undef SDL_VIDEO_RENDER_OGL_ES
 #define SDL_VIDEO_RENDER_OGL_ES 0
 #undef SDL_VIDEO_RENDER_OGL_ES2
 #define SDL_VIDEO_RENDER_OGL_ES2 0
+#undef SDL_VIDEO_RENDER_OGL3
+#define SDL_VIDEO_RENDER_OGL3 0
+#undef SDL_VIDEO_RENDER_OGL_ES3
+#define SDL_VIDEO_RENDER_OGL_ES3 0
 #undef SDL_VIDEO_RENDER_DIRECTFB
 #define SDL_VIDEO_RENDER_DIRECTFB 0
 #undef SDL_VIDEO_RENDER_PS2
@@ -119,9 +138,12 @@
         SDL_VIDEO_RENDER_D3D11    | \
         SDL_VIDEO_RENDER_D3D12    | \
         SDL_VIDEO_RENDER_METAL    | \
+        SDL_VIDEO_RENDER_VULKAN   | \
         SDL_VIDEO_RENDER_OGL      | \
         SDL_VIDEO_RENDER_OGL_ES   | \
         SDL_VIDEO_RENDER_OGL_ES2  | \
+        SDL_VIDEO_RENDER_OGL3     | \
+        SDL_VIDEO_RENDER_OGL_ES3  | \
         SDL_VIDEO_RENDER_DIRECTFB | \
         SDL_VIDEO_RENDER_PS2      | \
         SDL_VIDEO_RENDER_PSP      | \
@@ -26,7 +26,10 @@
 #include "SDL_render.h"
 #include "SDL_timer.h"
 #include "SDL_sysrender.h"
+#include "software/SDL_render_sw_c.h"
 #include "../video/SDL_pixels_c.h"
+#include "../video/SDL_yuv_c.h"
+#include "../thread/SDL_systhread.h"
 
 #if defined(__ANDROID__)
 #include "../core/android/SDL_android.h"
@@ -96,11 +99,237 @@ static const SDL_RenderDriver *render_drivers[] = {
 #if SDL_VIDEO_RENDER_OGL
     &GL_RenderDriver,
 #endif
+#if SDL_VIDEO_RENDER_OGL3
+    &GL3_RenderDriver,
+#endif
+#if SDL_VIDEO_RENDER_OGL_ES3
+    &GLES3_RenderDriver,
+#endif
+#if SDL_VIDEO_RENDER_VULKAN
+    &VULKAN_RenderDriver,
+#endif
+#if SDL_VIDEO_RENDER_SW
+    &SW_RenderDriver,
+#endif
 };
 #endif /* !SDL_RENDER_DISABLED */
 
 static char renderer_magic;
 static char texture_magic;
+static char command_list_magic;
+static char capture_magic;
+
+/* Small static textures can be packed into shared textures, so draws using
+   different textures can be batched together. Each atlas is packed with a
+   skyline allocator, space is only reclaimed when the whole atlas is empty. */
+#define TEXTURE_ATLAS_SIZE        1024
+#define TEXTURE_ATLAS_MAX_TEXTURE 256
+
+typedef struct SDL_TextureAtlasNode
+{
+    int x, y, w;
+} SDL_TextureAtlasNode;
+
+struct SDL_TextureAtlas
+{
+    SDL_Texture *texture;
+    int refcount;
+    int num_nodes;
+    SDL_TextureAtlasNode nodes[TEXTURE_ATLAS_SIZE + 1];
+    SDL_TextureAtlas *next;
+};
+
+/* Vertex data is allocated in blocks of this size, bigger allocations get a
+   block of their own. */
+#define RENDER_VERTEX_BLOCK_SIZE (128 * 1024)
+
+/* The number of frames the peak vertex data use is remembered for */
+#define RENDER_VERTEX_PEAK_AGE 120
+
+/* How far into a block's allocation its data starts, so the data addresses
+   are aligned like the offsets */
+static size_t GetRenderVertexBlockPadding(const SDL_RenderVertexBlock *block, size_t offset, size_t alignment)
+{
+    return (offset - (uintptr_t)block->allocation) & (alignment - 1);
+}
+
+/* Get a block from the pool that holds at least size bytes, or a new one */
+static SDL_RenderVertexBlock *GetRenderVertexBlock(SDL_Renderer *renderer, size_t size, size_t offset, size_t alignment)
+{
+    SDL_RenderVertexBlock *block;
+    SDL_RenderVertexBlock **prev;
+    size_t padding;
+
+    /* Vertex data is always at least 16 byte aligned */
+    alignment = SDL_max(alignment, 16);
+
+    for (prev = &renderer->vertex_blocks_pool; *prev; prev = &(*prev)->next) {
+        if ((*prev)->capacity >= size + GetRenderVertexBlockPadding(*prev, offset, alignment)) {
+            break;
+        }
+    }
+
+    if (*prev) {
+        block = *prev;
+        *prev = block->next;
+    } else {
+        block = (SDL_RenderVertexBlock *)SDL_malloc(sizeof(*block));
+        if (!block) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        block->capacity = SDL_max(size, RENDER_VERTEX_BLOCK_SIZE) + alignment;
+        block->allocation = SDL_malloc(block->capacity);
+        if (!block->allocation) {
+            SDL_free(block);
+            SDL_OutOfMemory();
+            return NULL;
+        }
+    }
+
+    padding = GetRenderVertexBlockPadding(block, offset, alignment);
+    block->data = (Uint8 *)block->allocation + padding;
+    block->size = block->capacity - padding;
+    block->offset = offset;
+    block->used = 0;
+    block->next = NULL;
+    return block;
+}
+
+static void FreeRenderVertexBlocks(SDL_RenderVertexBlock *blocks)
+{
+    while (blocks) {
+        SDL_RenderVertexBlock *next = blocks->next;
+        SDL_free(blocks->allocation);
+        SDL_free(blocks);
+        blocks = next;
+    }
+}
+
+/* Put blocks that have been drawn back in the pool, which keeps only as much
+   as the most vertex data used recently. */
+static void ReleaseRenderVertexBlocks(SDL_Renderer *renderer, SDL_RenderVertexBlock *blocks, size_t used)
+{
+    SDL_RenderVertexBlock **prev;
+    size_t kept = 0;
+
+    renderer->vertex_data_frame_peak = SDL_max(renderer->vertex_data_frame_peak, used);
+    if (used >= renderer->vertex_data_peak) {
+        renderer->vertex_data_peak = used;
+        renderer->vertex_data_peak_age = 0;
+    }
+
+    while (blocks) {
+        SDL_RenderVertexBlock *next = blocks->next;
+        blocks->next = renderer->vertex_blocks_pool;
+        renderer->vertex_blocks_pool = blocks;
+        blocks = next;
+    }
+
+    for (prev = &renderer->vertex_blocks_pool; *prev && kept < renderer->vertex_data_peak; prev = &(*prev)->next) {
+        kept += (*prev)->capacity;
+    }
+    FreeRenderVertexBlocks(*prev);
+    *prev = NULL;
+}
+
+/* Age the peak vertex data use once per frame, so it doesn't matter how
+   many times a frame is flushed */
+static void AgeRenderVertexPeak(SDL_Renderer *renderer)
+{
+    if (++renderer->vertex_data_peak_age > RENDER_VERTEX_PEAK_AGE) {
+        renderer->vertex_data_peak = renderer->vertex_data_frame_peak;
+        renderer->vertex_data_peak_age = 0;
+    }
+    renderer->vertex_data_frame_peak = 0;
+}
+
+/* Start over with no vertex data queued */
+static void ResetRenderVertices(SDL_Renderer *renderer)
+{
+    if (!renderer->GrowVertexData) {
+        ReleaseRenderVertexBlocks(renderer, renderer->vertex_blocks, renderer->vertex_data_used);
+        renderer->vertex_blocks = NULL;
+        renderer->vertex_blocks_tail = NULL;
+    }
+    renderer->vertex_data_used = 0;
+}
+
+/* Make sure numbytes more vertex data can be allocated, in any number of pieces */
+static SDL_bool ReserveRenderVertices(SDL_Renderer *renderer, size_t numbytes)
+{
+    SDL_RenderVertexBlock *block;
+
+    if (renderer->GrowVertexData) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        if (!SDL_AllocateRenderVertices(renderer, numbytes, 0, NULL)) {
+            return SDL_FALSE;
+        }
+        renderer->vertex_data_used = vertex_data_used;
+        return SDL_TRUE;
+    }
+
+    /* Once the current block is full, the rest goes in here */
+    block = GetRenderVertexBlock(renderer, numbytes, 0, 0);
+    if (!block) {
+        return SDL_FALSE;
+    }
+    block->next = renderer->vertex_blocks_pool;
+    renderer->vertex_blocks_pool = block;
+    return SDL_TRUE;
+}
+
+/* The vertex data queued for the backend, as a chain of blocks */
+static const SDL_RenderVertexBlock *GetQueuedVertexBlocks(SDL_Renderer *renderer, SDL_RenderVertexBlock *single)
+{
+    if (renderer->GrowVertexData) {
+        /* The backend owns one contiguous buffer */
+        SDL_zerop(single);
+        single->data = (Uint8 *)renderer->vertex_data;
+        single->used = renderer->vertex_data_used;
+        single->size = renderer->vertex_data_allocation;
+        return single;
+    }
+    return renderer->vertex_blocks;
+}
+
+static void *GetQueuedVertexData(SDL_Renderer *renderer, size_t offset)
+{
+    if (renderer->GrowVertexData) {
+        return (Uint8 *)renderer->vertex_data + offset;
+    }
+    return SDL_GetRenderVertexData(renderer->vertex_blocks, offset);
+}
+
+/* Offsets keep counting from one block to the next, but a command's vertex
+   data has to be all in one of them. */
+static SDL_bool IsQueuedVertexDataInOneBlock(SDL_Renderer *renderer, size_t offset, size_t size)
+{
+    const SDL_RenderVertexBlock *block = renderer->vertex_blocks;
+
+    if (renderer->GrowVertexData) {
+        return SDL_TRUE;
+    }
+    while (block->next && offset >= block->next->offset) {
+        block = block->next;
+    }
+    return (offset + size) <= (block->offset + block->used);
+}
+
+void *SDL_GetRenderVertexData(const SDL_RenderVertexBlock *blocks, size_t offset)
+{
+    while (blocks->next && offset >= blocks->next->offset) {
+        blocks = blocks->next;
+    }
+    return blocks->data + (offset - blocks->offset);
+}
+
+void SDL_CopyRenderVertexData(void *dst, const SDL_RenderVertexBlock *blocks)
+{
+    for (; blocks; blocks = blocks->next) {
+        SDL_memcpy((Uint8 *)dst + blocks->offset, blocks->data, blocks->used);
+    }
+}
 
 static SDL_INLINE void DebugLogRenderCommands(const SDL_RenderCommand *cmd)
 {
@@ -196,2457 +425,4810 @@ static SDL_INLINE void DebugLogRenderCommands(const SDL_RenderCommand *cmd)
                         (int) cmd->data.draw.blend, cmd->data.draw.texture);
                 break;
 
+            case SDL_RENDERCMD_UPDATE_TEXTURE:
+                SDL_Log(" %u. update texture (first=%u, tex=%p, x=%d, y=%d, w=%d, h=%d)", i++,
+                        (unsigned int) cmd->data.update.first, cmd->data.update.texture,
+                        cmd->data.update.rect.x, cmd->data.update.rect.y,
+                        cmd->data.update.rect.w, cmd->data.update.rect.h);
+                break;
+
         }
         cmd = cmd->next;
     }
 #endif
 }
 
-static int FlushRenderCommands(SDL_Renderer *renderer)
-{
-    int retval;
-
-    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
+/* How far back a draw may be moved to join other draws using its texture */
+#define BATCH_REORDER_WINDOW 64
 
-    if (!renderer->render_commands) { /* nothing to do! */
-        SDL_assert(renderer->vertex_data_used == 0);
-        return 0;
+static SDL_bool CanMergeRenderCommands(const SDL_RenderCommand *a, const SDL_RenderCommand *b)
+{
+    if (b->command != a->command) {
+        return SDL_FALSE;
     }
-
-    DebugLogRenderCommands(renderer->render_commands);
-
-    retval = renderer->RunCommandQueue(renderer, renderer->render_commands, renderer->vertex_data, renderer->vertex_data_used);
-
-    /* Move the whole render command queue to the unused pool so we can reuse them next time. */
-    if (renderer->render_commands_tail) {
-        renderer->render_commands_tail->next = renderer->render_commands_pool;
-        renderer->render_commands_pool = renderer->render_commands;
-        renderer->render_commands_tail = NULL;
-        renderer->render_commands = NULL;
+    switch (a->command) {
+    case SDL_RENDERCMD_DRAW_POINTS:
+    case SDL_RENDERCMD_FILL_RECTS:
+        /* These are drawn with the command's color */
+        if (a->data.draw.r != b->data.draw.r || a->data.draw.g != b->data.draw.g ||
+            a->data.draw.b != b->data.draw.b || a->data.draw.a != b->data.draw.a) {
+            return SDL_FALSE;
+        }
+        break;
+    case SDL_RENDERCMD_GEOMETRY:
+        /* The color is part of the vertices, but indices are relative to
+           the command's own vertices */
+        if (a->data.draw.index_size || b->data.draw.index_size) {
+            return SDL_FALSE;
+        }
+        break;
+    default:
+        /* Lines are strips and copies are single rectangles, they can't be concatenated */
+        return SDL_FALSE;
     }
-    renderer->vertex_data_used = 0;
-    renderer->render_command_generation++;
-    renderer->color_queued = SDL_FALSE;
-    renderer->viewport_queued = SDL_FALSE;
-    renderer->cliprect_queued = SDL_FALSE;
-    return retval;
+    if (a->data.draw.texture != b->data.draw.texture || a->data.draw.blend != b->data.draw.blend) {
+        return SDL_FALSE;
+    }
+    /* The backend's vertex data must be the same size per element, so it can be concatenated */
+    if (!a->data.draw.size || !b->data.draw.size ||
+        (a->data.draw.size * b->data.draw.count) != (b->data.draw.size * a->data.draw.count)) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
 }
 
-static int FlushRenderCommandsIfTextureNeeded(SDL_Texture *texture)
+static SDL_bool IsReorderableRenderCommand(const SDL_RenderCommand *cmd)
 {
-    SDL_Renderer *renderer = texture->renderer;
-    if (texture->last_command_generation == renderer->render_command_generation) {
-        /* the current command queue depends on this texture, flush the queue now before it changes */
-        return FlushRenderCommands(renderer);
-    }
-    return 0;
+    /* Textured draws don't depend on the current draw color, so only the
+       pixels they touch matter. */
+    return ((cmd->command == SDL_RENDERCMD_COPY || cmd->command == SDL_RENDERCMD_GEOMETRY) &&
+            cmd->data.draw.texture && cmd->data.draw.bounds.w >= 0.0f && cmd->data.draw.bounds.h >= 0.0f)
+               ? SDL_TRUE
+               : SDL_FALSE;
 }
 
-static SDL_INLINE int FlushRenderCommandsIfNotBatching(SDL_Renderer *renderer)
+static SDL_bool CanGroupRenderCommands(const SDL_RenderCommand *a, const SDL_RenderCommand *b)
 {
-    return renderer->batching ? 0 : FlushRenderCommands(renderer);
+    if (a->command == SDL_RENDERCMD_COPY) {
+        return (b->command == SDL_RENDERCMD_COPY &&
+                a->data.draw.texture == b->data.draw.texture &&
+                a->data.draw.blend == b->data.draw.blend)
+                   ? SDL_TRUE
+                   : SDL_FALSE;
+    }
+    return CanMergeRenderCommands(a, b);
 }
 
-int SDL_RenderFlush(SDL_Renderer *renderer)
+static SDL_bool RenderCommandsOverlap(const SDL_RenderCommand *a, const SDL_RenderCommand *b)
 {
-    return FlushRenderCommands(renderer);
+    /* Pad by a pixel, rasterization rules differ between backends */
+    const SDL_FRect *ra = &a->data.draw.bounds;
+    const SDL_FRect *rb = &b->data.draw.bounds;
+    return (ra->x - 1.0f < rb->x + rb->w + 1.0f && rb->x - 1.0f < ra->x + ra->w + 1.0f &&
+            ra->y - 1.0f < rb->y + rb->h + 1.0f && rb->y - 1.0f < ra->y + ra->h + 1.0f)
+               ? SDL_TRUE
+               : SDL_FALSE;
 }
 
-void *SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const size_t alignment, size_t *offset)
+/* Drop state changes that don't change anything, or that are replaced
+   before any command uses them. */
+static void RemoveRedundantStateCommands(SDL_RenderCommand **cmds, int count)
 {
-    const size_t needed = renderer->vertex_data_used + numbytes + alignment;
-    const size_t current_offset = renderer->vertex_data_used;
+    SDL_RenderCommand *viewport = NULL, *cliprect = NULL, *color = NULL;
+    SDL_bool viewport_used = SDL_TRUE, cliprect_used = SDL_TRUE, color_used = SDL_TRUE;
+    int i;
 
-    const size_t aligner = (alignment && ((current_offset & (alignment - 1)) != 0)) ? (alignment - (current_offset & (alignment - 1))) : 0;
-    const size_t aligned = current_offset + aligner;
+    for (i = 0; i < count; ++i) {
+        SDL_RenderCommand *cmd = cmds[i];
 
-    if (renderer->vertex_data_allocation < needed) {
-        const size_t current_allocation = renderer->vertex_data ? renderer->vertex_data_allocation : 1024;
-        size_t newsize = current_allocation * 2;
-        void *ptr;
-        while (newsize < needed) {
-            newsize *= 2;
-        }
+        switch (cmd->command) {
+        case SDL_RENDERCMD_SETVIEWPORT:
+            if (viewport && SDL_memcmp(&viewport->data.viewport.rect, &cmd->data.viewport.rect, sizeof(SDL_Rect)) == 0) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                if (!viewport_used) {
+                    viewport->command = SDL_RENDERCMD_NO_OP;
+                }
+                viewport = cmd;
+                viewport_used = SDL_FALSE;
+            }
+            break;
 
-        ptr = SDL_realloc(renderer->vertex_data, newsize);
+        case SDL_RENDERCMD_SETCLIPRECT:
+            if (cliprect && cliprect->data.cliprect.enabled == cmd->data.cliprect.enabled &&
+                (!cmd->data.cliprect.enabled ||
+                 SDL_memcmp(&cliprect->data.cliprect.rect, &cmd->data.cliprect.rect, sizeof(SDL_Rect)) == 0)) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                if (!cliprect_used) {
+                    cliprect->command = SDL_RENDERCMD_NO_OP;
+                }
+                cliprect = cmd;
+                cliprect_used = SDL_FALSE;
+            }
+            break;
 
-        if (!ptr) {
-            SDL_OutOfMemory();
-            return NULL;
+        case SDL_RENDERCMD_SETDRAWCOLOR:
+            if (color && color->data.color.r == cmd->data.color.r && color->data.color.g == cmd->data.color.g &&
+                color->data.color.b == cmd->data.color.b && color->data.color.a == cmd->data.color.a) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                if (!color_used) {
+                    color->command = SDL_RENDERCMD_NO_OP;
+                }
+                color = cmd;
+                color_used = SDL_FALSE;
+            }
+            break;
+
+        case SDL_RENDERCMD_NO_OP:
+            break;
+
+        default:
+            viewport_used = SDL_TRUE;
+            cliprect_used = SDL_TRUE;
+            color_used = SDL_TRUE;
+            break;
         }
-        renderer->vertex_data = ptr;
-        renderer->vertex_data_allocation = newsize;
     }
+}
 
-    if (offset) {
-        *offset = aligned;
-    }
+/* Move textured draws back next to an earlier draw with the same texture,
+   as long as they don't overlap anything they move past. Returns whether
+   anything was moved. */
+static SDL_bool SortRenderCommandsByTexture(SDL_RenderCommand **cmds, int count)
+{
+    SDL_bool moved = SDL_FALSE;
+    int i, j;
+
+    for (i = 1; i < count; ++i) {
+        SDL_RenderCommand *cmd = cmds[i];
+        int target = -1;
 
-    renderer->vertex_data_used += aligner + numbytes;
+        if (!IsReorderableRenderCommand(cmd)) {
+            continue;
+        }
+
+        for (j = i - 1; j >= 0 && j >= (i - BATCH_REORDER_WINDOW); --j) {
+            const SDL_RenderCommand *prev = cmds[j];
+            if (prev->command == SDL_RENDERCMD_NO_OP) {
+                continue;
+            }
+            if (!IsReorderableRenderCommand(prev)) {
+                break; /* state changes and untextured draws are barriers */
+            }
+            if (CanGroupRenderCommands(prev, cmd)) {
+                target = j + 1;
+                break;
+            }
+            if (RenderCommandsOverlap(prev, cmd)) {
+                break;
+            }
+        }
 
-    return ((Uint8 *)renderer->vertex_data) + aligned;
+        if (target >= 0 && target < i) {
+            SDL_memmove(&cmds[target + 1], &cmds[target], (i - target) * sizeof(*cmds));
+            cmds[target] = cmd;
+            moved = SDL_TRUE;
+        }
+    }
+    return moved;
 }
 
-static SDL_RenderCommand *AllocateRenderCommand(SDL_Renderer *renderer)
+/* Find the run of draws starting at cmds[i] that can be merged into it,
+   returns the index just past the run. */
+static int GetRenderCommandRun(SDL_Renderer *renderer, SDL_RenderCommand **cmds, int i, int count,
+                               size_t *total_size, size_t *total_count, SDL_bool *contiguous, int *merged)
 {
-    SDL_RenderCommand *retval = NULL;
+    const SDL_RenderCommand *first = cmds[i];
+    size_t end = first->data.draw.first + first->data.draw.size;
+    int j;
 
-    /* !!! FIXME: are there threading limitations in SDL's render API? If not, we need to mutex this. */
-    retval = renderer->render_commands_pool;
-    if (retval) {
-        renderer->render_commands_pool = retval->next;
-        retval->next = NULL;
-    } else {
-        retval = SDL_calloc(1, sizeof(*retval));
-        if (!retval) {
-            SDL_OutOfMemory();
-            return NULL;
-        }
+    *total_size = first->data.draw.size;
+    *total_count = first->data.draw.count;
+    *contiguous = SDL_TRUE;
+    *merged = 0;
+
+    if (first->command != SDL_RENDERCMD_DRAW_POINTS &&
+        first->command != SDL_RENDERCMD_FILL_RECTS &&
+        first->command != SDL_RENDERCMD_GEOMETRY) {
+        return i + 1;
     }
 
-    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
-    if (renderer->render_commands_tail) {
-        renderer->render_commands_tail->next = retval;
-    } else {
-        renderer->render_commands = retval;
+    for (j = i + 1; j < count; ++j) {
+        const SDL_RenderCommand *cmd = cmds[j];
+        if (cmd->command == SDL_RENDERCMD_NO_OP) {
+            continue;
+        }
+        if (!CanMergeRenderCommands(first, cmd)) {
+            break;
+        }
+        if (cmd->data.draw.first != end) {
+            *contiguous = SDL_FALSE;
+        }
+        end = cmd->data.draw.first + cmd->data.draw.size;
+        *total_size += cmd->data.draw.size;
+        *total_count += cmd->data.draw.count;
+        ++*merged;
     }
-    renderer->render_commands_tail = retval;
 
-    return retval;
+    if (*merged && *contiguous && !IsQueuedVertexDataInOneBlock(renderer, first->data.draw.first, *total_size)) {
+        *contiguous = SDL_FALSE;
+    }
+    return j;
 }
 
-static int QueueCmdSetViewport(SDL_Renderer *renderer)
+/* How much vertex data MergeRenderCommands() will have to move */
+static size_t GetMergedRenderVertexSize(SDL_Renderer *renderer, SDL_RenderCommand **cmds, int count)
 {
-    int retval = 0;
-    if (!renderer->viewport_queued || (SDL_memcmp(&renderer->viewport, &renderer->last_queued_viewport, sizeof(SDL_DRect)) != 0)) {
-        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
-        retval = -1;
-        if (cmd) {
-            cmd->command = SDL_RENDERCMD_SETVIEWPORT;
-            cmd->data.viewport.first = 0; /* render backend will fill this in. */
-            /* Convert SDL_DRect to SDL_Rect */
-            cmd->data.viewport.rect.x = (int)SDL_floor(renderer->viewport.x);
-            cmd->data.viewport.rect.y = (int)SDL_floor(renderer->viewport.y);
-            cmd->data.viewport.rect.w = (int)SDL_floor(renderer->viewport.w);
-            cmd->data.viewport.rect.h = (int)SDL_floor(renderer->viewport.h);
-            retval = renderer->QueueSetViewport(renderer, cmd);
-            if (retval < 0) {
-                cmd->command = SDL_RENDERCMD_NO_OP;
-            } else {
-                SDL_copyp(&renderer->last_queued_viewport, &renderer->viewport);
-                renderer->viewport_queued = SDL_TRUE;
-            }
+    size_t needed = 0;
+    int i = 0;
+
+    while (i < count) {
+        size_t total_size, total_count;
+        SDL_bool contiguous;
+        int merged;
+
+        i = GetRenderCommandRun(renderer, cmds, i, count, &total_size, &total_count, &contiguous, &merged);
+        if (merged && !contiguous) {
+            needed += total_size + 16;
         }
     }
-    return retval;
+    return needed;
 }
 
-static int QueueCmdSetClipRect(SDL_Renderer *renderer)
+/* Merge runs of compatible draws into one, moving their vertex data
+   together if it isn't contiguous already. */
+static void MergeRenderCommands(SDL_Renderer *renderer, SDL_RenderCommand **cmds, int count)
 {
-    int retval = 0;
-    if ((!renderer->cliprect_queued) ||
-        (renderer->clipping_enabled != renderer->last_queued_cliprect_enabled) ||
-        (SDL_memcmp(&renderer->clip_rect, &renderer->last_queued_cliprect, sizeof(SDL_DRect)) != 0)) {
-        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
-        if (!cmd) {
-            retval = -1;
-        } else {
-            cmd->command = SDL_RENDERCMD_SETCLIPRECT;
-            cmd->data.cliprect.enabled = renderer->clipping_enabled;
-            /* Convert SDL_DRect to SDL_Rect */
-            cmd->data.cliprect.rect.x = (int)SDL_floor(renderer->clip_rect.x);
-            cmd->data.cliprect.rect.y = (int)SDL_floor(renderer->clip_rect.y);
-            cmd->data.cliprect.rect.w = (int)SDL_floor(renderer->clip_rect.w);
-            cmd->data.cliprect.rect.h = (int)SDL_floor(renderer->clip_rect.h);
-            SDL_copyp(&renderer->last_queued_cliprect, &renderer->clip_rect);
-            renderer->last_queued_cliprect_enabled = renderer->clipping_enabled;
-            renderer->cliprect_queued = SDL_TRUE;
+    int i = 0;
+
+    while (i < count) {
+        SDL_RenderCommand *first = cmds[i];
+        size_t total_size, total_count;
+        SDL_bool contiguous;
+        int merged;
+        const int j = GetRenderCommandRun(renderer, cmds, i, count, &total_size, &total_count, &contiguous, &merged);
+
+        if (merged) {
+            if (!contiguous) {
+                size_t offset;
+                Uint8 *dst;
+                int k;
+
+                /* Space for this was reserved up front if anything was reordered */
+                dst = (Uint8 *)SDL_AllocateRenderVertices(renderer, total_size, 16, &offset);
+                if (!dst) {
+                    return;
+                }
+                for (k = i; k < j; ++k) {
+                    const SDL_RenderCommand *cmd = cmds[k];
+                    if (cmd->command != SDL_RENDERCMD_NO_OP) {
+                        SDL_memcpy(dst, GetQueuedVertexData(renderer, cmd->data.draw.first), cmd->data.draw.size);
+                        dst += cmd->data.draw.size;
+                    }
+                }
+                first->data.draw.first = offset;
+            }
+            for (++i; i < j; ++i) {
+                cmds[i]->command = SDL_RENDERCMD_NO_OP;
+            }
+            first->data.draw.size = total_size;
+            first->data.draw.count = total_count;
         }
+        i = j;
     }
-    return retval;
 }
 
-static int QueueCmdSetDrawColor(SDL_Renderer *renderer, SDL_Color *col)
+static void OptimizeRenderCommands(SDL_Renderer *renderer)
 {
-    const Uint32 color = (((Uint32)col->a << 24) | (col->r << 16) | (col->g << 8) | col->b);
-    int retval = 0;
+    SDL_RenderCommand **cmds;
+    SDL_RenderCommand *cmd;
+    SDL_bool isstack;
+    int count = 0;
+    int i;
 
-    if (!renderer->color_queued || (color != renderer->last_queued_color)) {
-        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
-        retval = -1;
+    for (cmd = renderer->render_commands; cmd; cmd = cmd->next) {
+        ++count;
+    }
+    if (count < 2) {
+        return;
+    }
 
-        if (cmd) {
-            cmd->command = SDL_RENDERCMD_SETDRAWCOLOR;
-            cmd->data.color.first = 0; /* render backend will fill this in. */
-            cmd->data.color.r = col->r;
-            cmd->data.color.g = col->g;
-            cmd->data.color.b = col->b;
-            cmd->data.color.a = col->a;
-            retval = renderer->QueueSetDrawColor(renderer, cmd);
-            if (retval < 0) {
-                cmd->command = SDL_RENDERCMD_NO_OP;
-            } else {
-                renderer->last_queued_color = color;
-                renderer->color_queued = SDL_TRUE;
+    cmds = SDL_small_alloc(SDL_RenderCommand *, count, &isstack);
+    if (!cmds) {
+        return;
+    }
+    for (i = 0, cmd = renderer->render_commands; cmd; cmd = cmd->next) {
+        cmds[i++] = cmd;
+    }
+
+    RemoveRedundantStateCommands(cmds, count);
+
+    /* Reordered geometry has to be merged, since backends may join adjacent
+       draws assuming their vertex data is contiguous. Make sure there's
+       room to move the runs that need it, or go back to the queued order. */
+    if (SortRenderCommandsByTexture(cmds, count)) {
+        const size_t needed = GetMergedRenderVertexSize(renderer, cmds, count);
+        if (needed > 0 && !ReserveRenderVertices(renderer, needed)) {
+            SDL_ClearError();
+            for (i = 0, cmd = renderer->render_commands; cmd; cmd = cmd->next) {
+                cmds[i++] = cmd;
             }
         }
     }
-    return retval;
-}
 
-static int QueueCmdClear(SDL_Renderer *renderer)
-{
-    SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
-    if (!cmd) {
-        return -1;
+    MergeRenderCommands(renderer, cmds, count);
+
+    for (i = 0; i < (count - 1); ++i) {
+        cmds[i]->next = cmds[i + 1];
     }
+    cmds[count - 1]->next = NULL;
+    renderer->render_commands = cmds[0];
+    renderer->render_commands_tail = cmds[count - 1];
 
-    cmd->command = SDL_RENDERCMD_CLEAR;
-    cmd->data.color.first = 0;
-    cmd->data.color.r = renderer->color.r;
-    cmd->data.color.g = renderer->color.g;
-    cmd->data.color.b = renderer->color.b;
-    cmd->data.color.a = renderer->color.a;
-    return 0;
+    SDL_small_free(cmds, isstack);
 }
 
-static SDL_RenderCommand *PrepQueueCmdDraw(SDL_Renderer *renderer, const SDL_RenderCommandType cmdtype, SDL_Texture *texture)
+static void CountRenderCommands(SDL_Renderer *renderer, const SDL_RenderCommand *cmd, size_t vertsize)
 {
-    SDL_RenderCommand *cmd = NULL;
-    int retval = 0;
-    SDL_Color *color;
-    SDL_BlendMode blendMode;
+    SDL_RenderStats *stats = &renderer->stats;
 
-    if (texture) {
-        color = &texture->color;
-        blendMode = texture->blendMode;
-    } else {
-        color = &renderer->color;
-        blendMode = renderer->blendMode;
+    while (cmd) {
+        switch (cmd->command) {
+        case SDL_RENDERCMD_SETVIEWPORT:
+            ++stats->viewport_commands;
+            break;
+        case SDL_RENDERCMD_SETCLIPRECT:
+            ++stats->cliprect_commands;
+            break;
+        case SDL_RENDERCMD_SETDRAWCOLOR:
+            ++stats->draw_color_commands;
+            break;
+        case SDL_RENDERCMD_CLEAR:
+            ++stats->clear_commands;
+            break;
+        case SDL_RENDERCMD_DRAW_POINTS:
+            ++stats->draw_points_commands;
+            stats->vertices += (Uint32)cmd->data.draw.count;
+            break;
+        case SDL_RENDERCMD_DRAW_LINES:
+            ++stats->draw_lines_commands;
+            stats->vertices += (Uint32)cmd->data.draw.count;
+            break;
+        case SDL_RENDERCMD_FILL_RECTS:
+            ++stats->fill_rects_commands;
+            stats->vertices += (Uint32)cmd->data.draw.count * 4;
+            break;
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX:
+            ++stats->copy_commands;
+            stats->vertices += 4;
+            break;
+        case SDL_RENDERCMD_GEOMETRY:
+            ++stats->geometry_commands;
+            stats->vertices += (Uint32)cmd->data.draw.count;
+            break;
+        case SDL_RENDERCMD_UPDATE_TEXTURE:
+            ++stats->update_texture_commands;
+            break;
+        default:
+            break;
+        }
+        cmd = cmd->next;
     }
+    stats->vertex_bytes += (Uint32)vertsize;
+}
 
-    if (cmdtype != SDL_RENDERCMD_GEOMETRY) {
-        /* !!! FIXME: drop this draw if viewport w or h is zero. */
-        retval = QueueCmdSetDrawColor(renderer, color);
+static Uint64 GetTexturePixelsSize(Uint32 format, int w, int h)
+{
+    if (SDL_ISPIXELFORMAT_FOURCC(format)) {
+        /* All the YUV formats have a full size Y plane and quarter size chroma planes */
+        return (Uint64)w * h + 2 * (Uint64)((w + 1) / 2) * ((h + 1) / 2);
     }
+    return (Uint64)w * h * SDL_BYTESPERPIXEL(format);
+}
 
-    /* Set the viewport and clip rect directly before draws, so the backends
-     * don't have to worry about that state not being valid at draw time. */
-    if (retval == 0 && !renderer->viewport_queued) {
-        retval = QueueCmdSetViewport(renderer);
+static void CountTextureUpload(SDL_Texture *texture, const SDL_Rect *rect)
+{
+    texture->renderer->stats.texture_upload_bytes += GetTexturePixelsSize(texture->format, rect->w, rect->h);
+}
+
+static void LogRenderStats(const SDL_RenderStats *stats)
+{
+    SDL_Log("Render stats for frame %u:", (unsigned int)stats->frame);
+    SDL_Log(" commands: %u viewport, %u cliprect, %u color, %u clear, %u points, %u lines, %u rects, %u copy, %u geometry, %u texture updates",
+            (unsigned int)stats->viewport_commands, (unsigned int)stats->cliprect_commands,
+            (unsigned int)stats->draw_color_commands, (unsigned int)stats->clear_commands,
+            (unsigned int)stats->draw_points_commands, (unsigned int)stats->draw_lines_commands,
+            (unsigned int)stats->fill_rects_commands, (unsigned int)stats->copy_commands,
+            (unsigned int)stats->geometry_commands, (unsigned int)stats->update_texture_commands);
+    SDL_Log(" vertices: %u (%u bytes), %u draws culled", (unsigned int)stats->vertices,
+            (unsigned int)stats->vertex_bytes, (unsigned int)stats->culled_draws);
+    SDL_Log(" flushes: %u (texture %u, target %u, read pixels %u, no batching %u)",
+            (unsigned int)stats->flushes, (unsigned int)stats->texture_flushes,
+            (unsigned int)stats->target_flushes, (unsigned int)stats->read_pixels_flushes,
+            (unsigned int)stats->no_batching_flushes);
+    SDL_Log(" state: %u texture binds, %u blend changes, %u shader changes",
+            (unsigned int)stats->texture_binds, (unsigned int)stats->blend_changes,
+            (unsigned int)stats->shader_changes);
+    SDL_Log(" texture uploads: %" SDL_PRIu64 " bytes", stats->texture_upload_bytes);
+    SDL_Log(" textures: %" SDL_PRIu64 " bytes (%u evicted, %u restored)", stats->texture_bytes,
+            (unsigned int)stats->evicted_textures, (unsigned int)stats->restored_textures);
+    if (stats->gpu_time >= 0.0f) {
+        SDL_Log(" GPU time: %.3f ms", stats->gpu_time);
     }
-    if (retval == 0 && !renderer->cliprect_queued) {
-        retval = QueueCmdSetClipRect(renderer);
+}
+
+/* Called after presenting, start counting the next frame */
+static void FinishRenderStats(SDL_Renderer *renderer)
+{
+    SDL_RenderStats *stats = &renderer->stats;
+    const Uint32 frame = stats->frame;
+    const float gpu_time = stats->gpu_time;
+
+    stats->texture_bytes = renderer->texture_memory;
+    renderer->frame_stats = *stats;
+    if (renderer->log_stats_interval > 0 && (frame % renderer->log_stats_interval) == 0) {
+        LogRenderStats(stats);
     }
 
-    if (retval == 0) {
-        cmd = AllocateRenderCommand(renderer);
-        if (cmd) {
-            cmd->command = cmdtype;
-            cmd->data.draw.first = 0; /* render backend will fill this in. */
-            cmd->data.draw.count = 0; /* render backend will fill this in. */
-            cmd->data.draw.r = color->r;
-            cmd->data.draw.g = color->g;
-            cmd->data.draw.b = color->b;
-            cmd->data.draw.a = color->a;
-            cmd->data.draw.blend = blendMode;
-            cmd->data.draw.texture = texture;
+    SDL_zerop(stats);
+    stats->frame = frame + 1;
+    stats->gpu_time = gpu_time; /* the backend updates this when a measurement is ready */
+}
+
+static void InitRenderStats(SDL_Renderer *renderer)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_LOG_STATS);
+
+    renderer->stats.gpu_time = -1.0f;
+    renderer->frame_stats.gpu_time = -1.0f;
+    renderer->log_stats_interval = hint ? SDL_atoi(hint) : 0;
+}
+
+static int SDLCALL SDL_RenderThread(void *data)
+{
+    SDL_Renderer *renderer = (SDL_Renderer *)data;
+
+    SDL_LockMutex(renderer->render_thread_lock);
+    for (;;) {
+        while (!renderer->render_thread_busy && !renderer->render_thread_quit) {
+            SDL_CondWait(renderer->render_thread_cond, renderer->render_thread_lock);
+        }
+        if (!renderer->render_thread_busy) {
+            break;
+        }
+        SDL_UnlockMutex(renderer->render_thread_lock);
+
+        if (renderer->render_thread_commands) {
+            renderer->RunCommandQueue(renderer, renderer->render_thread_commands, renderer->render_thread_vertex_blocks, renderer->render_thread_vertex_data_used);
         }
+        if (renderer->render_thread_present) {
+            renderer->RenderPresent(renderer);
+        }
+        renderer->ReleaseContext(renderer);
+
+        SDL_LockMutex(renderer->render_thread_lock);
+        renderer->render_thread_busy = SDL_FALSE;
+        SDL_CondBroadcast(renderer->render_thread_cond);
     }
-    return cmd;
+    SDL_UnlockMutex(renderer->render_thread_lock);
+
+    return 0;
 }
 
-static int QueueCmdDrawPoints(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
+/* Free the backend storage of a texture, keeping track of the memory used */
+static void DestroyBackendTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_POINTS, NULL);
-    int retval = -1;
-    if (cmd) {
-        retval = renderer->QueueDrawPoints(renderer, cmd, points, count);
-        if (retval < 0) {
-            cmd->command = SDL_RENDERCMD_NO_OP;
-        }
+    renderer->DestroyTexture(renderer, texture);
+    texture->driverdata = NULL;
+    renderer->texture_memory -= texture->memory;
+    texture->memory = 0;
+}
+
+static void FreeDestroyedTextures(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    while (texture) {
+        SDL_Texture *next = texture->next;
+        DestroyBackendTexture(renderer, texture);
+        SDL_free(texture);
+        texture = next;
     }
-    return retval;
 }
 
-static int QueueCmdDrawLines(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
+/* Wait for the render thread to finish its frame, after this the calling
+   thread is free to use the backend. */
+static void WaitRenderThread(SDL_Renderer *renderer)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_LINES, NULL);
-    int retval = -1;
-    if (cmd) {
-        retval = renderer->QueueDrawLines(renderer, cmd, points, count);
-        if (retval < 0) {
-            cmd->command = SDL_RENDERCMD_NO_OP;
+    SDL_RenderCommand *tail;
+
+    if (!renderer->render_thread) {
+        return;
+    }
+
+    SDL_LockMutex(renderer->render_thread_lock);
+    while (renderer->render_thread_busy) {
+        SDL_CondWait(renderer->render_thread_cond, renderer->render_thread_lock);
+    }
+    SDL_UnlockMutex(renderer->render_thread_lock);
+
+    /* The pool is only touched from here, so the render thread doesn't need to lock it */
+    if (renderer->render_thread_commands) {
+        for (tail = renderer->render_thread_commands; tail->next; tail = tail->next) {
         }
+        tail->next = renderer->render_commands_pool;
+        renderer->render_commands_pool = renderer->render_thread_commands;
+        renderer->render_thread_commands = NULL;
     }
-    return retval;
+    if (renderer->render_thread_vertex_blocks) {
+        ReleaseRenderVertexBlocks(renderer, renderer->render_thread_vertex_blocks, renderer->render_thread_vertex_data_used);
+        renderer->render_thread_vertex_blocks = NULL;
+    }
+    renderer->render_thread_vertex_data_used = 0;
+    FreeDestroyedTextures(renderer, renderer->render_thread_destroyed_textures);
+    renderer->render_thread_destroyed_textures = NULL;
 }
 
-static int QueueCmdFillRects(SDL_Renderer *renderer, const SDL_FRect *rects, const int count)
+static int FlushRenderCommands(SDL_Renderer *renderer)
 {
-    SDL_RenderCommand *cmd;
-    int retval = -1;
-    const int use_rendergeometry = (!renderer->QueueFillRects);
+    SDL_RenderVertexBlock single;
+    int retval;
 
-    cmd = PrepQueueCmdDraw(renderer, (use_rendergeometry ? SDL_RENDERCMD_GEOMETRY : SDL_RENDERCMD_FILL_RECTS), NULL);
+    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
 
-    if (cmd) {
-        if (use_rendergeometry) {
-            SDL_bool isstack1;
-            SDL_bool isstack2;
-            float *xy = SDL_small_alloc(float, 4 * 2 * count, &isstack1);
-            int *indices = SDL_small_alloc(int, 6 * count, &isstack2);
+    WaitRenderThread(renderer);
 
-            if (xy && indices) {
-                int i;
-                float *ptr_xy = xy;
-                int *ptr_indices = indices;
-                const int xy_stride = 2 * sizeof(float);
-                const int num_vertices = 4 * count;
-                const int num_indices = 6 * count;
-                const int size_indices = 4;
-                int cur_index = 0;
-                const int *rect_index_order = renderer->rect_index_order;
+    if (renderer->recording_command_list) { /* the queue is kept for SDL_RenderEndCommandList() */
+        return 0;
+    }
 
-                for (i = 0; i < count; ++i) {
-                    float minx, miny, maxx, maxy;
+    if (!renderer->render_commands) { /* nothing to do! */
+        SDL_assert(renderer->vertex_data_used == 0);
+        return 0;
+    }
 
-                    minx = rects[i].x;
-                    miny = rects[i].y;
-                    maxx = rects[i].x + rects[i].w;
-                    maxy = rects[i].y + rects[i].h;
+    if (renderer->optimize_batches) {
+        OptimizeRenderCommands(renderer);
+    }
 
-                    *ptr_xy++ = minx;
-                    *ptr_xy++ = miny;
-                    *ptr_xy++ = maxx;
-                    *ptr_xy++ = miny;
-                    *ptr_xy++ = maxx;
-                    *ptr_xy++ = maxy;
-                    *ptr_xy++ = minx;
-                    *ptr_xy++ = maxy;
+    DebugLogRenderCommands(renderer->render_commands);
+    CountRenderCommands(renderer, renderer->render_commands, renderer->vertex_data_used);
+    ++renderer->stats.flushes;
 
-                    *ptr_indices++ = cur_index + rect_index_order[0];
-                    *ptr_indices++ = cur_index + rect_index_order[1];
-                    *ptr_indices++ = cur_index + rect_index_order[2];
-                    *ptr_indices++ = cur_index + rect_index_order[3];
-                    *ptr_indices++ = cur_index + rect_index_order[4];
-                    *ptr_indices++ = cur_index + rect_index_order[5];
-                    cur_index += 4;
-                }
+    retval = renderer->RunCommandQueue(renderer, renderer->render_commands, GetQueuedVertexBlocks(renderer, &single), renderer->vertex_data_used);
 
-                retval = renderer->QueueGeometry(renderer, cmd, NULL,
-                                                 xy, xy_stride, &renderer->color, 0 /* color_stride */, NULL, 0,
-                                                 num_vertices, indices, num_indices, size_indices,
-                                                 1.0f, 1.0f);
+    /* Move the whole render command queue to the unused pool so we can reuse them next time. */
+    if (renderer->render_commands_tail) {
+        renderer->render_commands_tail->next = renderer->render_commands_pool;
+        renderer->render_commands_pool = renderer->render_commands;
+        renderer->render_commands_tail = NULL;
+        renderer->render_commands = NULL;
+    }
+    ResetRenderVertices(renderer);
+    renderer->render_command_generation++;
+    renderer->color_queued = SDL_FALSE;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
+    FreeDestroyedTextures(renderer, renderer->destroyed_textures);
+    renderer->destroyed_textures = NULL;
+    return retval;
+}
 
-                if (retval < 0) {
-                    cmd->command = SDL_RENDERCMD_NO_OP;
-                }
-            }
-            SDL_small_free(xy, isstack1);
-            SDL_small_free(indices, isstack2);
+/* Hand the frame to the render thread, and start a new command queue in the
+   other vertex buffer while it works on it. */
+static void SubmitRenderThread(SDL_Renderer *renderer, SDL_bool present)
+{
+    WaitRenderThread(renderer);
 
-        } else {
-            retval = renderer->QueueFillRects(renderer, cmd, rects, count);
-            if (retval < 0) {
-                cmd->command = SDL_RENDERCMD_NO_OP;
-            }
+    if (renderer->render_commands && !renderer->recording_command_list) {
+        if (renderer->optimize_batches) {
+            OptimizeRenderCommands(renderer);
         }
+
+        DebugLogRenderCommands(renderer->render_commands);
+        CountRenderCommands(renderer, renderer->render_commands, renderer->vertex_data_used);
+        ++renderer->stats.flushes;
+
+        renderer->render_thread_commands = renderer->render_commands;
+        renderer->render_commands_tail = NULL;
+        renderer->render_commands = NULL;
+
+        renderer->render_thread_vertex_blocks = renderer->vertex_blocks;
+        renderer->render_thread_vertex_data_used = renderer->vertex_data_used;
+        renderer->vertex_blocks = NULL;
+        renderer->vertex_blocks_tail = NULL;
+
+        renderer->render_thread_destroyed_textures = renderer->destroyed_textures;
+        renderer->destroyed_textures = NULL;
+
+        renderer->vertex_data_used = 0;
+        renderer->render_command_generation++;
+        renderer->color_queued = SDL_FALSE;
+        renderer->viewport_queued = SDL_FALSE;
+        renderer->cliprect_queued = SDL_FALSE;
     }
-    return retval;
+
+    /* This ends the frame, the render thread counts its backend state changes into the next one */
+    FinishRenderStats(renderer);
+
+    if (!renderer->render_thread_commands && !present) {
+        return;
+    }
+
+    renderer->render_thread_present = present;
+    renderer->ReleaseContext(renderer);
+
+    SDL_LockMutex(renderer->render_thread_lock);
+    renderer->render_thread_busy = SDL_TRUE;
+    SDL_CondBroadcast(renderer->render_thread_cond);
+    SDL_UnlockMutex(renderer->render_thread_lock);
 }
 
-static int QueueCmdCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+static void StartRenderThread(SDL_Renderer *renderer)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY, texture);
-    int retval = -1;
-    if (cmd) {
-        retval = renderer->QueueCopy(renderer, cmd, texture, srcrect, dstrect);
-        if (retval < 0) {
-            cmd->command = SDL_RENDERCMD_NO_OP;
-        }
+    renderer->render_thread_lock = SDL_CreateMutex();
+    renderer->render_thread_cond = SDL_CreateCond();
+    if (renderer->render_thread_lock && renderer->render_thread_cond) {
+        renderer->ReleaseContext(renderer);
+        renderer->render_thread = SDL_CreateThreadInternal(SDL_RenderThread, "SDLRender", 0, renderer);
+    }
+    if (!renderer->render_thread) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "Couldn't start render thread: %s", SDL_GetError());
+        SDL_DestroyCond(renderer->render_thread_cond);
+        renderer->render_thread_cond = NULL;
+        SDL_DestroyMutex(renderer->render_thread_lock);
+        renderer->render_thread_lock = NULL;
     }
-    return retval;
 }
 
-static int QueueCmdCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
-                          const SDL_Rect *srcquad, const SDL_FRect *dstrect,
-                          const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip, float scale_x, float scale_y)
+static void StopRenderThread(SDL_Renderer *renderer)
 {
-    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY_EX, texture);
-    int retval = -1;
-    if (cmd) {
-        retval = renderer->QueueCopyEx(renderer, cmd, texture, srcquad, dstrect, angle, center, flip, scale_x, scale_y);
-        if (retval < 0) {
-            cmd->command = SDL_RENDERCMD_NO_OP;
-        }
+    if (!renderer->render_thread) {
+        return;
     }
-    return retval;
+
+    WaitRenderThread(renderer);
+
+    SDL_LockMutex(renderer->render_thread_lock);
+    renderer->render_thread_quit = SDL_TRUE;
+    SDL_CondBroadcast(renderer->render_thread_cond);
+    SDL_UnlockMutex(renderer->render_thread_lock);
+
+    SDL_WaitThread(renderer->render_thread, NULL);
+    renderer->render_thread = NULL;
+    SDL_DestroyCond(renderer->render_thread_cond);
+    renderer->render_thread_cond = NULL;
+    SDL_DestroyMutex(renderer->render_thread_lock);
+    renderer->render_thread_lock = NULL;
 }
 
-static int QueueCmdGeometry(SDL_Renderer *renderer, SDL_Texture *texture,
-                            const float *xy, int xy_stride,
-                            const SDL_Color *color, int color_stride,
-                            const float *uv, int uv_stride,
-                            int num_vertices,
-                            const void *indices, int num_indices, int size_indices,
-                            float scale_x, float scale_y)
+/* Flush the queue, counting the flush in reason if there's anything to draw */
+static int FlushRenderCommandsWithReason(SDL_Renderer *renderer, Uint32 *reason)
 {
-    SDL_RenderCommand *cmd;
-    int retval = -1;
-    cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_GEOMETRY, texture);
-    if (cmd) {
-        retval = renderer->QueueGeometry(renderer, cmd, texture,
-                                         xy, xy_stride,
-                                         color, color_stride, uv, uv_stride,
-                                         num_vertices, indices, num_indices, size_indices,
-                                         scale_x, scale_y);
-        if (retval < 0) {
-            cmd->command = SDL_RENDERCMD_NO_OP;
-        }
+    if (renderer->render_commands && !renderer->recording_command_list) {
+        ++*reason;
     }
-    return retval;
+    return FlushRenderCommands(renderer);
 }
 
-static int UpdateLogicalSize(SDL_Renderer *renderer, SDL_bool flush_viewport_cmd);
+static int FlushRenderCommandsIfTextureNeeded(SDL_Texture *texture)
+{
+    SDL_Renderer *renderer = texture->renderer;
 
-int SDL_GetNumRenderDrivers(void)
+    /* The render thread may be using the texture, and holds the context anyway */
+    WaitRenderThread(renderer);
+
+    if (texture->last_command_generation == renderer->render_command_generation) {
+        /* the current command queue depends on this texture, flush the queue now before it changes */
+        return FlushRenderCommandsWithReason(renderer, &renderer->stats.texture_flushes);
+    }
+    return 0;
+}
+
+/* Updates can go into the queue in order with the draws, so the queued draws
+   still see the old contents without having to be flushed first. */
+static SDL_bool CanQueueTextureUpdate(SDL_Texture *texture, const SDL_Rect *rect)
 {
-#ifndef SDL_RENDER_DISABLED
-    return SDL_arraysize(render_drivers);
-#else
+    SDL_Renderer *renderer = texture->renderer;
+
+    if (!renderer->QueueUpdateTexture || renderer->recording_command_list ||
+        SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return SDL_FALSE;
+    }
+
+    /* Big updates like video frames would bloat the queue, they're cheaper uploaded directly */
+    if (renderer->max_queued_update_size &&
+        (size_t)rect->w * rect->h * SDL_BYTESPERPIXEL(texture->format) > renderer->max_queued_update_size) {
+        return SDL_FALSE;
+    }
+
+    /* Textures that aren't in use are updated right away, unless that means
+       waiting for the render thread */
+    return (texture->last_command_generation == renderer->render_command_generation ||
+            renderer->render_thread)
+               ? SDL_TRUE
+               : SDL_FALSE;
+}
+
+static Uint64 GetTextureBudget(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_TEXTURE_BUDGET);
+    const int megabytes = hint ? SDL_atoi(hint) : 0;
+
+    if (megabytes <= 0) {
+        return 0;
+    }
+    return (Uint64)megabytes * 1024 * 1024;
+}
+
+/* Upload an evicted texture again from its shadow copy */
+static int RestoreTexture(SDL_Texture *texture)
+{
+    SDL_Renderer *renderer = texture->renderer;
+    SDL_Rect rect;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+
+    WaitRenderThread(renderer);
+    if (renderer->CreateTexture(renderer, texture) < 0) {
+        return -1;
+    }
+    texture->evicted = SDL_FALSE;
+    texture->memory = GetTexturePixelsSize(texture->format, texture->w, texture->h);
+    renderer->texture_memory += texture->memory;
+    ++renderer->stats.restored_textures;
+
+    CountTextureUpload(texture, &rect);
+    return renderer->UpdateTexture(renderer, texture, &rect, texture->shadow, texture->w * SDL_BYTESPERPIXEL(texture->format));
+}
+
+/* Mark a texture as used by the queued commands, restoring it first if it was evicted */
+static int UseTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    if (texture->evicted && RestoreTexture(texture) < 0) {
+        return -1;
+    }
+    texture->last_command_generation = renderer->render_command_generation;
     return 0;
-#endif
 }
 
-int SDL_GetRenderDriverInfo(int index, SDL_RendererInfo *info)
+/* Least recently drawn first */
+static int SDLCALL CompareTextureAge(const void *a, const void *b)
 {
-#ifndef SDL_RENDER_DISABLED
-    if (index < 0 || index >= SDL_GetNumRenderDrivers()) {
-        return SDL_SetError("index must be in the range of 0 - %d",
-                            SDL_GetNumRenderDrivers() - 1);
+    const SDL_Texture *A = *(const SDL_Texture *const *)a;
+    const SDL_Texture *B = *(const SDL_Texture *const *)b;
+    const Uint32 generation = A->renderer->render_command_generation;
+    const Uint32 age_a = generation - A->last_command_generation;
+    const Uint32 age_b = generation - B->last_command_generation;
+
+    if (age_a != age_b) {
+        return (age_a > age_b) ? -1 : 1;
     }
-    *info = render_drivers[index]->info;
     return 0;
-#else
-    return SDL_SetError("SDL not built with rendering support");
-#endif
 }
 
-static void GetWindowViewportValues(SDL_Renderer *renderer, int *logical_w, int *logical_h, SDL_DRect *viewport, SDL_FPoint *scale)
+static SDL_bool IsEvictableTexture(SDL_Renderer *renderer, SDL_Texture *texture)
 {
-    SDL_LockMutex(renderer->target_mutex);
-    *logical_w = renderer->target ? renderer->logical_w_backup : renderer->logical_w;
-    *logical_h = renderer->target ? renderer->logical_h_backup : renderer->logical_h;
-    *viewport = renderer->target ? renderer->viewport_backup : renderer->viewport;
-    *scale = renderer->target ? renderer->scale_backup : renderer->scale;
-    SDL_UnlockMutex(renderer->target_mutex);
+    return (texture->shadow && !texture->evicted &&
+            texture->last_command_generation != renderer->render_command_generation)
+               ? SDL_TRUE
+               : SDL_FALSE;
 }
 
-static int SDLCALL SDL_RendererEventWatch(void *userdata, SDL_Event *event)
+/* Free the restorable textures that were drawn least recently, until the
+   textures fit in the budget again. */
+static void EnforceTextureBudget(SDL_Renderer *renderer)
 {
-    SDL_Renderer *renderer = (SDL_Renderer *)userdata;
+    SDL_Texture **candidates;
+    SDL_Texture *texture;
+    int count = 0;
+    int i;
 
-    if (event->type == SDL_WINDOWEVENT) {
-        SDL_Window *window = SDL_GetWindowFromID(event->window.windowID);
-        if (window == renderer->window) {
-            if (renderer->WindowEvent) {
-                renderer->WindowEvent(renderer, &event->window);
-            }
+    if (!renderer->texture_budget || renderer->texture_memory <= renderer->texture_budget) {
+        return;
+    }
 
-            /* In addition to size changes, we also want to do this block for
-             * window display changes as well! If the new display has a new DPI,
-             * we need to update the viewport for the new window/drawable ratio.
-             */
-            if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
-                event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED) {
-                /* Make sure we're operating on the default render target */
-                SDL_Texture *saved_target = SDL_GetRenderTarget(renderer);
-                if (saved_target) {
-                    SDL_SetRenderTarget(renderer, NULL);
-                }
+    for (texture = renderer->textures; texture; texture = texture->next) {
+        if (IsEvictableTexture(renderer, texture)) {
+            ++count;
+        }
+    }
+    if (count == 0) {
+        return;
+    }
 
-                /* Update the DPI scale if the window has been resized. */
-                if (window && renderer->GetOutputSize) {
-                    int window_w, window_h;
-                    int output_w, output_h;
-                    if (renderer->GetOutputSize(renderer, &output_w, &output_h) == 0) {
-                        SDL_GetWindowSize(renderer->window, &window_w, &window_h);
-                        renderer->dpi_scale.x = (float)window_w / output_w;
-                        renderer->dpi_scale.y = (float)window_h / output_h;
-                    }
-                }
+    candidates = (SDL_Texture **)SDL_malloc(count * sizeof(*candidates));
+    if (!candidates) {
+        return;
+    }
+    count = 0;
+    for (texture = renderer->textures; texture; texture = texture->next) {
+        if (IsEvictableTexture(renderer, texture)) {
+            candidates[count++] = texture;
+        }
+    }
+    SDL_qsort(candidates, count, sizeof(*candidates), CompareTextureAge);
 
-                if (renderer->logical_w) {
-#if defined(__ANDROID__)
-                    /* Don't immediatly flush because the app may be in
-                     * background, and the egl context shouldn't be used. */
-                    SDL_bool flush_viewport_cmd = SDL_FALSE;
-#else
-                    SDL_bool flush_viewport_cmd = SDL_TRUE;
-#endif
-                    UpdateLogicalSize(renderer, flush_viewport_cmd);
-                } else {
-                    /* Window was resized, reset viewport */
-                    int w, h;
+    /* The render thread may still be drawing with them */
+    WaitRenderThread(renderer);
 
-                    if (renderer->GetOutputSize) {
-                        renderer->GetOutputSize(renderer, &w, &h);
-                    } else {
-                        SDL_GetWindowSize(renderer->window, &w, &h);
-                    }
+    for (i = 0; i < count && renderer->texture_memory > renderer->texture_budget; ++i) {
+        DestroyBackendTexture(renderer, candidates[i]);
+        candidates[i]->evicted = SDL_TRUE;
+        ++renderer->stats.evicted_textures;
+    }
+    SDL_free(candidates);
+}
 
-                    renderer->viewport.x = (double)0;
-                    renderer->viewport.y = (double)0;
-                    renderer->viewport.w = (double)w;
-                    renderer->viewport.h = (double)h;
-                    QueueCmdSetViewport(renderer);
-#if defined(__ANDROID__)
-                    /* Don't immediatly flush because the app may be in
-                     * background, and the egl context shouldn't be used. */
-#else
-                    FlushRenderCommandsIfNotBatching(renderer);
-#endif
-                }
+static SDL_INLINE int FlushRenderCommandsIfNotBatching(SDL_Renderer *renderer)
+{
+    return renderer->batching ? 0 : FlushRenderCommandsWithReason(renderer, &renderer->stats.no_batching_flushes);
+}
 
-                if (saved_target) {
-                    SDL_SetRenderTarget(renderer, saved_target);
-                }
-            } else if (event->window.event == SDL_WINDOWEVENT_HIDDEN) {
-                renderer->hidden = SDL_TRUE;
-            } else if (event->window.event == SDL_WINDOWEVENT_SHOWN) {
-                if (!(SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)) {
-                    renderer->hidden = SDL_FALSE;
-                }
-            } else if (event->window.event == SDL_WINDOWEVENT_MINIMIZED) {
-                renderer->hidden = SDL_TRUE;
-            } else if (event->window.event == SDL_WINDOWEVENT_RESTORED ||
-                       event->window.event == SDL_WINDOWEVENT_MAXIMIZED) {
-                if (!(SDL_GetWindowFlags(window) & SDL_WINDOW_HIDDEN)) {
-                    renderer->hidden = SDL_FALSE;
-                }
+int SDL_RenderFlush(SDL_Renderer *renderer)
+{
+    return FlushRenderCommands(renderer);
+}
+
+void *SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const size_t alignment, size_t *offset)
+{
+    const size_t needed = renderer->vertex_data_used + numbytes + alignment;
+    const size_t current_offset = renderer->vertex_data_used;
+
+    const size_t aligner = (alignment && ((current_offset & (alignment - 1)) != 0)) ? (alignment - (current_offset & (alignment - 1))) : 0;
+    const size_t aligned = current_offset + aligner;
+
+    if (renderer->GrowVertexData) {
+        if (renderer->vertex_data_allocation < needed) {
+            if (renderer->GrowVertexData(renderer, needed) < 0) {
+                return NULL;
             }
         }
-    } else if (event->type == SDL_MOUSEMOTION) {
-        SDL_Window *window = SDL_GetWindowFromID(event->motion.windowID);
-        if (window == renderer->window) {
-            int logical_w, logical_h;
-            SDL_DRect viewport;
-            SDL_FPoint scale;
-            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
-            if (logical_w) {
-                event->motion.x -= (int)(viewport.x * renderer->dpi_scale.x);
-                event->motion.y -= (int)(viewport.y * renderer->dpi_scale.y);
-                event->motion.x = (int)(event->motion.x / (scale.x * renderer->dpi_scale.x));
-                event->motion.y = (int)(event->motion.y / (scale.y * renderer->dpi_scale.y));
-                if (event->motion.xrel != 0 && renderer->relative_scaling) {
-                    float rel = renderer->xrel + event->motion.xrel / (scale.x * renderer->dpi_scale.x);
-                    float truncated = SDL_truncf(rel);
-                    renderer->xrel = rel - truncated;
-                    event->motion.xrel = (Sint32)truncated;
-                }
-                if (event->motion.yrel != 0 && renderer->relative_scaling) {
-                    float rel = renderer->yrel + event->motion.yrel / (scale.y * renderer->dpi_scale.y);
-                    float truncated = SDL_truncf(rel);
-                    renderer->yrel = rel - truncated;
-                    event->motion.yrel = (Sint32)truncated;
-                }
-            }
+
+        if (offset) {
+            *offset = aligned;
         }
-    } else if (event->type == SDL_MOUSEBUTTONDOWN ||
-               event->type == SDL_MOUSEBUTTONUP) {
-        SDL_Window *window = SDL_GetWindowFromID(event->button.windowID);
-        if (window == renderer->window) {
-            int logical_w, logical_h;
-            SDL_DRect viewport;
-            SDL_FPoint scale;
-            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
-            if (logical_w) {
-                event->button.x -= (int)(viewport.x * renderer->dpi_scale.x);
-                event->button.y -= (int)(viewport.y * renderer->dpi_scale.y);
-                event->button.x = (int)(event->button.x / (scale.x * renderer->dpi_scale.x));
-                event->button.y = (int)(event->button.y / (scale.y * renderer->dpi_scale.y));
+
+        renderer->vertex_data_used += aligner + numbytes;
+
+        return ((Uint8 *)renderer->vertex_data) + aligned;
+    } else {
+        SDL_RenderVertexBlock *block = renderer->vertex_blocks_tail;
+
+        if (!block || (aligned + numbytes) > (block->offset + block->size)) {
+            /* Start a new block, what's left of this one goes unused */
+            block = GetRenderVertexBlock(renderer, numbytes + alignment, current_offset, alignment);
+            if (!block) {
+                return NULL;
             }
-        }
-    } else if (event->type == SDL_MOUSEWHEEL) {
-        SDL_Window *window = SDL_GetWindowFromID(event->wheel.windowID);
-        if (window == renderer->window) {
-            int logical_w, logical_h;
-            SDL_DRect viewport;
-            SDL_FPoint scale;
-            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
-            if (logical_w) {
-                event->wheel.mouseX -= (int)(viewport.x * renderer->dpi_scale.x);
-                event->wheel.mouseY -= (int)(viewport.y * renderer->dpi_scale.y);
-                event->wheel.mouseX = (int)(event->wheel.mouseX / (scale.x * renderer->dpi_scale.x));
-                event->wheel.mouseY = (int)(event->wheel.mouseY / (scale.y * renderer->dpi_scale.y));
+            if (renderer->vertex_blocks_tail) {
+                renderer->vertex_blocks_tail->next = block;
+            } else {
+                renderer->vertex_blocks = block;
             }
+            renderer->vertex_blocks_tail = block;
         }
-    } else if (event->type == SDL_FINGERDOWN ||
-               event->type == SDL_FINGERUP ||
-               event->type == SDL_FINGERMOTION) {
-        int logical_w, logical_h;
-        float physical_w, physical_h;
-        SDL_DRect viewport;
-        SDL_FPoint scale;
-        GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
 
-        /* !!! FIXME: we probably should drop events that are outside of the
-           !!! FIXME: viewport, but we can't do that from an event watcher,
-           !!! FIXME: and we would have to track if a touch happened outside
-           !!! FIXME: the viewport and then slid into it to insert extra
-           !!! FIXME: events, which is a mess, so for now we just clamp these
-           !!! FIXME: events to the edge. */
-
-        if (renderer->GetOutputSize) {
-            int w, h;
-            renderer->GetOutputSize(renderer, &w, &h);
-            physical_w = (float)w;
-            physical_h = (float)h;
-        } else {
-            int w, h;
-            SDL_GetWindowSize(renderer->window, &w, &h);
-            physical_w = ((float)w) * renderer->dpi_scale.x;
-            physical_h = ((float)h) * renderer->dpi_scale.y;
+        if (offset) {
+            *offset = aligned;
         }
 
-        if (physical_w == 0.0f) { /* nowhere for the touch to go, avoid division by zero and put it dead center. */
-            event->tfinger.x = 0.5f;
-        } else {
-            const float normalized_viewport_x = ((float)viewport.x) / physical_w;
-            const float normalized_viewport_w = ((float)viewport.w) / physical_w;
-            if (event->tfinger.x <= normalized_viewport_x) {
-                event->tfinger.x = 0.0f; /* to the left of the viewport, clamp to the edge. */
-            } else if (event->tfinger.x >= (normalized_viewport_x + normalized_viewport_w)) {
-                event->tfinger.x = 1.0f; /* to the right of the viewport, clamp to the edge. */
-            } else {
-                event->tfinger.x = (event->tfinger.x - normalized_viewport_x) / normalized_viewport_w;
-            }
-        }
+        renderer->vertex_data_used = aligned + numbytes;
+        block->used = renderer->vertex_data_used - block->offset;
 
-        if (physical_h == 0.0f) { /* nowhere for the touch to go, avoid division by zero and put it dead center. */
-            event->tfinger.y = 0.5f;
-        } else {
-            const float normalized_viewport_y = ((float)viewport.y) / physical_h;
-            const float normalized_viewport_h = ((float)viewport.h) / physical_h;
-            if (event->tfinger.y <= normalized_viewport_y) {
-                event->tfinger.y = 0.0f; /* to the left of the viewport, clamp to the edge. */
-            } else if (event->tfinger.y >= (normalized_viewport_y + normalized_viewport_h)) {
-                event->tfinger.y = 1.0f; /* to the right of the viewport, clamp to the edge. */
-            } else {
-                event->tfinger.y = (event->tfinger.y - normalized_viewport_y) / normalized_viewport_h;
-            }
-        }
+        return block->data + (aligned - block->offset);
     }
-
-    return 0;
 }
 
-int SDL_CreateWindowAndRenderer(int width, int height, Uint32 window_flags,
-                                SDL_Window **window, SDL_Renderer **renderer)
+static SDL_RenderCommand *AllocateRenderCommand(SDL_Renderer *renderer)
 {
-    *window = SDL_CreateWindow(NULL, SDL_WINDOWPOS_UNDEFINED,
-                               SDL_WINDOWPOS_UNDEFINED,
-                               width, height, window_flags);
-    if (!*window) {
-        *renderer = NULL;
-        return -1;
+    SDL_RenderCommand *retval = NULL;
+
+    /* !!! FIXME: are there threading limitations in SDL's render API? If not, we need to mutex this. */
+    retval = renderer->render_commands_pool;
+    if (retval) {
+        renderer->render_commands_pool = retval->next;
+        retval->next = NULL;
+    } else {
+        retval = SDL_calloc(1, sizeof(*retval));
+        if (!retval) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
     }
 
-    *renderer = SDL_CreateRenderer(*window, -1, 0);
-    if (!*renderer) {
-        return -1;
+    SDL_assert((renderer->render_commands == NULL) == (renderer->render_commands_tail == NULL));
+    if (renderer->render_commands_tail) {
+        renderer->render_commands_tail->next = retval;
+    } else {
+        renderer->render_commands = retval;
     }
+    renderer->render_commands_tail = retval;
 
-    return 0;
+    return retval;
 }
 
-#ifndef SDL_RENDER_DISABLED
-static SDL_INLINE void VerifyDrawQueueFunctions(const SDL_Renderer *renderer)
+static int QueueCmdSetViewport(SDL_Renderer *renderer)
 {
-    /* all of these functions are required to be implemented, even as no-ops, so we don't
-        have to check that they aren't NULL over and over. */
-    SDL_assert(renderer->QueueSetViewport != NULL);
-    SDL_assert(renderer->QueueSetDrawColor != NULL);
-    SDL_assert(renderer->QueueDrawPoints != NULL);
-    SDL_assert(renderer->QueueDrawLines != NULL || renderer->QueueGeometry != NULL);
-    SDL_assert(renderer->QueueFillRects != NULL || renderer->QueueGeometry != NULL);
-    SDL_assert(renderer->QueueCopy != NULL || renderer->QueueGeometry != NULL);
-    SDL_assert(renderer->RunCommandQueue != NULL);
+    int retval = 0;
+    if (!renderer->viewport_queued || (SDL_memcmp(&renderer->viewport, &renderer->last_queued_viewport, sizeof(SDL_DRect)) != 0)) {
+        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
+        retval = -1;
+        if (cmd) {
+            cmd->command = SDL_RENDERCMD_SETVIEWPORT;
+            cmd->data.viewport.first = 0; /* render backend will fill this in. */
+            /* Convert SDL_DRect to SDL_Rect */
+            cmd->data.viewport.rect.x = (int)SDL_floor(renderer->viewport.x);
+            cmd->data.viewport.rect.y = (int)SDL_floor(renderer->viewport.y);
+            cmd->data.viewport.rect.w = (int)SDL_floor(renderer->viewport.w);
+            cmd->data.viewport.rect.h = (int)SDL_floor(renderer->viewport.h);
+            retval = renderer->QueueSetViewport(renderer, cmd);
+            if (retval < 0) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                SDL_copyp(&renderer->last_queued_viewport, &renderer->viewport);
+                renderer->viewport_queued = SDL_TRUE;
+            }
+        }
+    }
+    return retval;
 }
 
-static SDL_RenderLineMethod SDL_GetRenderLineMethod(void)
+/* The clip rect sent to the backend, which is limited to the damaged part of
+   the window when only that part is drawn */
+static SDL_bool GetQueuedClipRect(SDL_Renderer *renderer, SDL_DRect *rect)
 {
-    const char *hint = SDL_GetHint(SDL_HINT_RENDER_LINE_METHOD);
+    SDL_DRect damage;
+    double x1, y1;
 
-    int method = 0;
-    if (hint) {
-        method = SDL_atoi(hint);
+    *rect = renderer->clip_rect;
+    if (!renderer->damage_clipping || renderer->target || renderer->recording_command_list) {
+        return renderer->clipping_enabled;
     }
-    switch (method) {
-    case 1:
-        return SDL_RENDERLINEMETHOD_POINTS;
-    case 2:
-        return SDL_RENDERLINEMETHOD_LINES;
-    case 3:
-        return SDL_RENDERLINEMETHOD_GEOMETRY;
-    default:
-        return SDL_RENDERLINEMETHOD_POINTS;
+
+    damage.x = renderer->damage_clip.x - SDL_floor(renderer->viewport.x);
+    damage.y = renderer->damage_clip.y - SDL_floor(renderer->viewport.y);
+    damage.w = renderer->damage_clip.w;
+    damage.h = renderer->damage_clip.h;
+    if (!renderer->clipping_enabled) {
+        *rect = damage;
+        return SDL_TRUE;
     }
+
+    x1 = SDL_min(rect->x + rect->w, damage.x + damage.w);
+    y1 = SDL_min(rect->y + rect->h, damage.y + damage.h);
+    rect->x = SDL_max(rect->x, damage.x);
+    rect->y = SDL_max(rect->y, damage.y);
+    rect->w = SDL_max(x1 - rect->x, 0.0);
+    rect->h = SDL_max(y1 - rect->y, 0.0);
+    return SDL_TRUE;
 }
 
-static void SDL_CalculateSimulatedVSyncInterval(SDL_Renderer *renderer, SDL_Window *window)
+static int QueueCmdSetClipRect(SDL_Renderer *renderer)
 {
-    /* FIXME: SDL refresh rate API should return numerator/denominator */
-    int refresh_rate = 0;
-    int display_index = SDL_GetWindowDisplayIndex(window);
-    SDL_DisplayMode mode;
+    SDL_DRect clip_rect;
+    const SDL_bool clipping_enabled = GetQueuedClipRect(renderer, &clip_rect);
+    int retval = 0;
 
-    if (display_index < 0) {
-        display_index = 0;
+    if ((!renderer->cliprect_queued) ||
+        (clipping_enabled != renderer->last_queued_cliprect_enabled) ||
+        (SDL_memcmp(&clip_rect, &renderer->last_queued_cliprect, sizeof(SDL_DRect)) != 0)) {
+        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
+        if (!cmd) {
+            retval = -1;
+        } else {
+            cmd->command = SDL_RENDERCMD_SETCLIPRECT;
+            cmd->data.cliprect.enabled = clipping_enabled;
+            /* Convert SDL_DRect to SDL_Rect */
+            cmd->data.cliprect.rect.x = (int)SDL_floor(clip_rect.x);
+            cmd->data.cliprect.rect.y = (int)SDL_floor(clip_rect.y);
+            cmd->data.cliprect.rect.w = (int)SDL_floor(clip_rect.w);
+            cmd->data.cliprect.rect.h = (int)SDL_floor(clip_rect.h);
+            SDL_copyp(&renderer->last_queued_cliprect, &clip_rect);
+            renderer->last_queued_cliprect_enabled = clipping_enabled;
+            renderer->cliprect_queued = SDL_TRUE;
+        }
     }
-    if (SDL_GetDesktopDisplayMode(display_index, &mode) == 0) {
-        refresh_rate = mode.refresh_rate;
+    return retval;
+}
+
+static int QueueCmdSetDrawColor(SDL_Renderer *renderer, SDL_Color *col)
+{
+    const Uint32 color = (((Uint32)col->a << 24) | (col->r << 16) | (col->g << 8) | col->b);
+    int retval = 0;
+
+    if (!renderer->color_queued || (color != renderer->last_queued_color)) {
+        SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
+        retval = -1;
+
+        if (cmd) {
+            cmd->command = SDL_RENDERCMD_SETDRAWCOLOR;
+            cmd->data.color.first = 0; /* render backend will fill this in. */
+            cmd->data.color.r = col->r;
+            cmd->data.color.g = col->g;
+            cmd->data.color.b = col->b;
+            cmd->data.color.a = col->a;
+            retval = renderer->QueueSetDrawColor(renderer, cmd);
+            if (retval < 0) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                renderer->last_queued_color = color;
+                renderer->color_queued = SDL_TRUE;
+            }
+        }
     }
-    if (!refresh_rate) {
-        /* Pick a good default refresh rate */
-        refresh_rate = 60;
+    return retval;
+}
+
+static int QueueCmdClear(SDL_Renderer *renderer)
+{
+    SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
+    if (!cmd) {
+        return -1;
     }
-    renderer->simulate_vsync_interval = (1000 / refresh_rate);
+
+    cmd->command = SDL_RENDERCMD_CLEAR;
+    cmd->data.color.first = 0;
+    cmd->data.color.r = renderer->color.r;
+    cmd->data.color.g = renderer->color.g;
+    cmd->data.color.b = renderer->color.b;
+    cmd->data.color.a = renderer->color.a;
+    return 0;
 }
-#endif /* !SDL_RENDER_DISABLED */
 
-SDL_Renderer *SDL_CreateRenderer(SDL_Window *window, int index, Uint32 flags)
+/* Decide which part of the window is drawn in this frame. This happens at the
+   first draw to the window, EGL_KHR_partial_update needs to know before any
+   rendering starts. Only the damage can be drawn if the back buffer has the
+   contents of a frame whose damage since then is known. */
+static void LockDamageRegion(SDL_Renderer *renderer)
 {
-#ifndef SDL_RENDER_DISABLED
-    SDL_Renderer *renderer = NULL;
-    int n = SDL_GetNumRenderDrivers();
-    SDL_bool batching = SDL_TRUE;
-    const char *hint;
+    SDL_Rect clip;
+    int age, i;
 
-#if defined(__ANDROID__)
-    Android_ActivityMutex_Lock_Running();
-#endif
+    renderer->damage_locked = SDL_TRUE;
 
-    if (!window) {
-        SDL_InvalidParamError("window");
-        goto error;
+    /* The render thread may still be drawing into the back buffer */
+    if (renderer->num_damage_rects == 0 || !renderer->GetBufferAge || renderer->render_thread) {
+        return;
     }
 
-    if (SDL_HasWindowSurface(window)) {
-        SDL_SetError("Surface already associated with window");
-        goto error;
+    age = renderer->GetBufferAge(renderer);
+    if (age < 1 || age - 1 > renderer->num_damage_history) {
+        return;
     }
 
-    if (SDL_GetRenderer(window)) {
-        SDL_SetError("Renderer already associated with window");
-        goto error;
+    clip = renderer->damage_rects[0];
+    for (i = 1; i < renderer->num_damage_rects; ++i) {
+        SDL_UnionRect(&clip, &renderer->damage_rects[i], &clip);
+    }
+    for (i = 0; i < age - 1; ++i) {
+        SDL_UnionRect(&clip, &renderer->damage_history[i], &clip);
     }
 
-    hint = SDL_GetHint(SDL_HINT_RENDER_VSYNC);
-    if (hint && *hint) {
-        if (SDL_GetHintBoolean(SDL_HINT_RENDER_VSYNC, SDL_TRUE)) {
-            flags |= SDL_RENDERER_PRESENTVSYNC;
-        } else {
-            flags &= ~SDL_RENDERER_PRESENTVSYNC;
-        }
+    renderer->damage_clip = clip;
+    renderer->damage_clipping = SDL_TRUE;
+    renderer->cliprect_queued = SDL_FALSE;
+    if (renderer->SetDamageRegion) {
+        renderer->SetDamageRegion(renderer, &clip);
     }
+}
 
-    if (index < 0) {
-        hint = SDL_GetHint(SDL_HINT_RENDER_DRIVER);
-        if (hint) {
-            for (index = 0; index < n; ++index) {
-                const SDL_RenderDriver *driver = render_drivers[index];
+/* Hand the damage of the frame to RenderPresent(), the backend is done with
+   the previous present damage by now */
+static void PresentDamage(SDL_Renderer *renderer)
+{
+    SDL_Rect *rects = renderer->present_damage_rects;
+    const int max_rects = renderer->max_present_damage_rects;
 
-                if (SDL_strcasecmp(hint, driver->info.name) == 0) {
-                    /* Create a new renderer instance */
-                    renderer = driver->CreateRenderer(window, flags);
-                    if (renderer) {
-                        batching = SDL_FALSE;
-                    }
-                    break;
-                }
-            }
-        }
+    renderer->present_damage_rects = renderer->damage_rects;
+    renderer->num_present_damage_rects = renderer->num_damage_rects;
+    renderer->max_present_damage_rects = renderer->max_damage_rects;
+    renderer->damage_rects = rects;
+    renderer->num_damage_rects = 0;
+    renderer->max_damage_rects = max_rects;
+}
 
-        if (!renderer) {
-            for (index = 0; index < n; ++index) {
-                const SDL_RenderDriver *driver = render_drivers[index];
+/* Start tracking the damage of the next frame, after presenting */
+static void FinishDamage(SDL_Renderer *renderer, SDL_bool presented)
+{
+    int i;
 
-                if ((driver->info.flags & flags) == flags) {
-                    /* Create a new renderer instance */
-                    renderer = driver->CreateRenderer(window, flags);
-                    if (renderer) {
-                        /* Yay, we got one! */
-                        break;
-                    }
-                }
-            }
-        }
-        if (!renderer) {
-            SDL_SetError("Couldn't find matching render driver");
-            goto error;
+    if (!presented) {
+        renderer->num_damage_history = -1;
+    } else if (renderer->num_present_damage_rects > 0) {
+        SDL_memmove(&renderer->damage_history[1], &renderer->damage_history[0],
+                    (SDL_RENDER_DAMAGE_HISTORY - 1) * sizeof(SDL_Rect));
+        renderer->damage_history[0] = renderer->present_damage_rects[0];
+        for (i = 1; i < renderer->num_present_damage_rects; ++i) {
+            SDL_UnionRect(&renderer->damage_history[0], &renderer->present_damage_rects[i], &renderer->damage_history[0]);
         }
+        renderer->num_damage_history = SDL_min(SDL_max(renderer->num_damage_history, 0) + 1, SDL_RENDER_DAMAGE_HISTORY);
     } else {
-        if (index >= n) {
-            SDL_SetError("index must be -1 or in the range of 0 - %d",
-                         n - 1);
-            goto error;
-        }
-        /* Create a new renderer instance */
-        renderer = render_drivers[index]->CreateRenderer(window, flags);
-        batching = SDL_FALSE;
-        if (!renderer) {
-            goto error;
-        }
+        renderer->num_damage_history = 0;
     }
 
-    if (flags & SDL_RENDERER_PRESENTVSYNC) {
-        renderer->wanted_vsync = SDL_TRUE;
-
-        if (!(renderer->info.flags & SDL_RENDERER_PRESENTVSYNC)) {
-            renderer->simulate_vsync = SDL_TRUE;
-            renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
-        }
+    renderer->damage_locked = SDL_FALSE;
+    if (renderer->damage_clipping) {
+        renderer->damage_clipping = SDL_FALSE;
+        renderer->cliprect_queued = SDL_FALSE;
     }
-    SDL_CalculateSimulatedVSyncInterval(renderer, window);
+}
 
-    VerifyDrawQueueFunctions(renderer);
+static SDL_RenderCommand *PrepQueueCmdDraw(SDL_Renderer *renderer, const SDL_RenderCommandType cmdtype, SDL_Texture *texture)
+{
+    SDL_RenderCommand *cmd = NULL;
+    int retval = 0;
+    SDL_Color *color;
+    SDL_BlendMode blendMode;
 
-    /* let app/user override batching decisions. */
-    if (renderer->always_batch) {
-        batching = SDL_TRUE;
-    } else if (SDL_GetHint(SDL_HINT_RENDER_BATCHING)) {
-        batching = SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_TRUE);
+    if (!renderer->damage_locked && !renderer->target && !renderer->recording_command_list) {
+        LockDamageRegion(renderer);
     }
 
-    renderer->batching = batching;
-    renderer->magic = &renderer_magic;
-    renderer->window = window;
-    renderer->target_mutex = SDL_CreateMutex();
-    renderer->scale.x = 1.0f;
-    renderer->scale.y = 1.0f;
-    renderer->dpi_scale.x = 1.0f;
-    renderer->dpi_scale.y = 1.0f;
-
-    /* Default value, if not specified by the renderer back-end */
-    if (renderer->rect_index_order[0] == 0 && renderer->rect_index_order[1] == 0) {
-        renderer->rect_index_order[0] = 0;
-        renderer->rect_index_order[1] = 1;
-        renderer->rect_index_order[2] = 2;
-        renderer->rect_index_order[3] = 0;
-        renderer->rect_index_order[4] = 2;
-        renderer->rect_index_order[5] = 3;
+    if (texture) {
+        color = &texture->color;
+        blendMode = texture->blendMode;
+    } else {
+        color = &renderer->color;
+        blendMode = renderer->blendMode;
     }
 
-    /* new textures start at zero, so we start at 1 so first render doesn't flush by accident. */
-    renderer->render_command_generation = 1;
-
-    if (renderer->GetOutputSize) {
-        int window_w, window_h;
-        int output_w, output_h;
-        if (renderer->GetOutputSize(renderer, &output_w, &output_h) == 0) {
-            SDL_GetWindowSize(renderer->window, &window_w, &window_h);
-            renderer->dpi_scale.x = (float)window_w / output_w;
-            renderer->dpi_scale.y = (float)window_h / output_h;
-        }
+    if (cmdtype != SDL_RENDERCMD_GEOMETRY) {
+        /* !!! FIXME: drop this draw if viewport w or h is zero. */
+        retval = QueueCmdSetDrawColor(renderer, color);
     }
 
-    renderer->relative_scaling = SDL_GetHintBoolean(SDL_HINT_MOUSE_RELATIVE_SCALING, SDL_TRUE);
-
-    renderer->line_method = SDL_GetRenderLineMethod();
-
-    if (SDL_GetWindowFlags(window) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) {
-        renderer->hidden = SDL_TRUE;
-    } else {
-        renderer->hidden = SDL_FALSE;
+    /* Set the viewport and clip rect directly before draws, so the backends
+     * don't have to worry about that state not being valid at draw time. */
+    if (retval == 0 && !renderer->viewport_queued) {
+        retval = QueueCmdSetViewport(renderer);
+    }
+    if (retval == 0 && !renderer->cliprect_queued) {
+        retval = QueueCmdSetClipRect(renderer);
     }
 
-    SDL_SetWindowData(window, SDL_WINDOWRENDERDATA, renderer);
-
-    SDL_RenderSetViewport(renderer, NULL);
-
-    SDL_AddEventWatch(SDL_RendererEventWatch, renderer);
-
-    SDL_LogInfo(SDL_LOG_CATEGORY_RENDER,
-                "Created renderer: %s", renderer->info.name);
-
-#if defined(__ANDROID__)
-    Android_ActivityMutex_Unlock();
-#endif
-    return renderer;
-
-error:
-
-#if defined(__ANDROID__)
-    Android_ActivityMutex_Unlock();
-#endif
-    return NULL;
-
-#else
-    SDL_SetError("SDL not built with rendering support");
-    return NULL;
-#endif
-}
-
-SDL_Renderer *SDL_GetRenderer(SDL_Window *window)
-{
-    return (SDL_Renderer *)SDL_GetWindowData(window, SDL_WINDOWRENDERDATA);
+    if (retval == 0) {
+        cmd = AllocateRenderCommand(renderer);
+        if (cmd) {
+            cmd->command = cmdtype;
+            cmd->data.draw.first = 0; /* render backend will fill this in. */
+            cmd->data.draw.count = 0; /* render backend will fill this in. */
+            cmd->data.draw.r = color->r;
+            cmd->data.draw.g = color->g;
+            cmd->data.draw.b = color->b;
+            cmd->data.draw.a = color->a;
+            cmd->data.draw.blend = blendMode;
+            cmd->data.draw.texture = texture;
+            cmd->data.draw.packed = NULL;
+            cmd->data.draw.size = 0;
+            cmd->data.draw.indices = 0;
+            cmd->data.draw.num_indices = 0;
+            cmd->data.draw.index_size = 0;
+            if (texture && texture->atlas) {
+                /* Packed textures keep their own color and blend mode, but draw from the atlas */
+                cmd->data.draw.texture = texture->atlas->texture;
+                cmd->data.draw.packed = texture;
+                cmd->data.draw.texture->last_command_generation = renderer->render_command_generation;
+            }
+            cmd->data.draw.bounds.w = -1.0f;
+        }
+    }
+    return cmd;
 }
 
-SDL_Window *SDL_RenderGetWindow(SDL_Renderer *renderer)
+static int QueueCmdUpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *rect, const void *pixels, int pitch)
 {
-    CHECK_RENDERER_MAGIC(renderer, NULL);
-    return renderer->window;
+    SDL_RenderCommand *cmd = AllocateRenderCommand(renderer);
+    int retval = -1;
+    if (cmd) {
+        cmd->command = SDL_RENDERCMD_UPDATE_TEXTURE;
+        cmd->data.update.first = 0; /* render backend will fill this in. */
+        cmd->data.update.texture = texture;
+        cmd->data.update.rect = *rect;
+        retval = renderer->QueueUpdateTexture(renderer, cmd, texture, rect, pixels, pitch);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            texture->last_command_generation = renderer->render_command_generation;
+        }
+    }
+    return retval;
 }
 
-int SDL_GetRendererInfo(SDL_Renderer *renderer, SDL_RendererInfo *info)
+/* Remember how much vertex data the backend queued for a draw, the batch
+   optimizer needs it to merge draws. */
+static void FinishQueueCmdDraw(SDL_Renderer *renderer, SDL_RenderCommand *cmd, size_t vertex_data_used)
 {
-    CHECK_RENDERER_MAGIC(renderer, -1);
-
-    *info = renderer->info;
-    return 0;
+    if (renderer->vertex_data_used > vertex_data_used) {
+        cmd->data.draw.size = renderer->vertex_data_used - cmd->data.draw.first;
+    }
 }
 
-int SDL_GetRendererOutputSize(SDL_Renderer *renderer, int *w, int *h)
+static void SetQueueCmdDrawBounds(SDL_RenderCommand *cmd, const float *xy, int xy_stride, int num_vertices, float scale_x, float scale_y)
 {
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    float minx, miny, maxx, maxy;
+    int i;
 
-    if (renderer->target) {
-        return SDL_QueryTexture(renderer->target, NULL, NULL, w, h);
-    } else if (renderer->GetOutputSize) {
-        return renderer->GetOutputSize(renderer, w, h);
-    } else if (renderer->window) {
-        SDL_GetWindowSize(renderer->window, w, h);
-        return 0;
-    } else {
-        SDL_assert(0 && "This should never happen");
-        return SDL_SetError("Renderer doesn't support querying output size");
+    if (num_vertices <= 0) {
+        return;
     }
-}
-
-static SDL_bool IsSupportedBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
-{
-    switch (blendMode) {
-    /* These are required to be supported by all renderers */
-    case SDL_BLENDMODE_NONE:
-    case SDL_BLENDMODE_BLEND:
-    case SDL_BLENDMODE_ADD:
-    case SDL_BLENDMODE_MOD:
-    case SDL_BLENDMODE_MUL:
-        return SDL_TRUE;
 
-    default:
-        return renderer->SupportsBlendMode && renderer->SupportsBlendMode(renderer, blendMode);
+    minx = maxx = xy[0];
+    miny = maxy = xy[1];
+    for (i = 1; i < num_vertices; ++i) {
+        const float *xy_ = (const float *)((const char *)xy + i * xy_stride);
+        minx = SDL_min(minx, xy_[0]);
+        miny = SDL_min(miny, xy_[1]);
+        maxx = SDL_max(maxx, xy_[0]);
+        maxy = SDL_max(maxy, xy_[1]);
     }
+    cmd->data.draw.bounds.x = minx * scale_x;
+    cmd->data.draw.bounds.y = miny * scale_y;
+    cmd->data.draw.bounds.w = (maxx - minx) * scale_x;
+    cmd->data.draw.bounds.h = (maxy - miny) * scale_y;
 }
 
-static SDL_bool IsSupportedFormat(SDL_Renderer *renderer, Uint32 format)
+static int QueueCmdDrawPoints(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
 {
-    Uint32 i;
-
-    for (i = 0; i < renderer->info.num_texture_formats; ++i) {
-        if (renderer->info.texture_formats[i] == format) {
-            return SDL_TRUE;
+    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_POINTS, NULL);
+    int retval = -1;
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        retval = renderer->QueueDrawPoints(renderer, cmd, points, count);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
         }
     }
-    return SDL_FALSE;
+    return retval;
 }
 
-static Uint32 GetClosestSupportedFormat(SDL_Renderer *renderer, Uint32 format)
+static int QueueCmdDrawLines(SDL_Renderer *renderer, const SDL_FPoint *points, const int count)
 {
-    Uint32 i;
-
-    if (SDL_ISPIXELFORMAT_FOURCC(format)) {
-        /* Look for an exact match */
-        for (i = 0; i < renderer->info.num_texture_formats; ++i) {
-            if (renderer->info.texture_formats[i] == format) {
-                return renderer->info.texture_formats[i];
-            }
-        }
-    } else {
-        SDL_bool hasAlpha = SDL_ISPIXELFORMAT_ALPHA(format);
-
-        /* We just want to match the first format that has the same channels */
-        for (i = 0; i < renderer->info.num_texture_formats; ++i) {
-            if (!SDL_ISPIXELFORMAT_FOURCC(renderer->info.texture_formats[i]) &&
-                SDL_ISPIXELFORMAT_ALPHA(renderer->info.texture_formats[i]) == hasAlpha) {
-                return renderer->info.texture_formats[i];
-            }
+    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_DRAW_LINES, NULL);
+    int retval = -1;
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        retval = renderer->QueueDrawLines(renderer, cmd, points, count);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
         }
     }
-    return renderer->info.texture_formats[0];
+    return retval;
 }
 
-static SDL_ScaleMode SDL_GetScaleMode(void)
+static int QueueCmdFillRects(SDL_Renderer *renderer, const SDL_FRect *rects, const int count)
 {
-    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
-
-    if (!hint || SDL_strcasecmp(hint, "nearest") == 0) {
-        return SDL_ScaleModeNearest;
-    } else if (SDL_strcasecmp(hint, "linear") == 0) {
-        return SDL_ScaleModeLinear;
-    } else if (SDL_strcasecmp(hint, "best") == 0) {
-        return SDL_ScaleModeBest;
-    } else {
-        return (SDL_ScaleMode)SDL_atoi(hint);
-    }
-}
+    SDL_RenderCommand *cmd;
+    int retval = -1;
+    const int use_rendergeometry = (!renderer->QueueFillRects);
 
-SDL_Texture *SDL_CreateTexture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h)
-{
-    SDL_Texture *texture;
-    SDL_bool texture_is_fourcc_and_target;
+    cmd = PrepQueueCmdDraw(renderer, (use_rendergeometry ? SDL_RENDERCMD_GEOMETRY : SDL_RENDERCMD_FILL_RECTS), NULL);
 
-    CHECK_RENDERER_MAGIC(renderer, NULL);
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        if (use_rendergeometry) {
+            SDL_bool isstack1;
+            SDL_bool isstack2;
+            float *xy = SDL_small_alloc(float, 4 * 2 * count, &isstack1);
+            int *indices = SDL_small_alloc(int, 6 * count, &isstack2);
 
-    if (!format) {
-        format = renderer->info.texture_formats[0];
-    }
-    if (SDL_BYTESPERPIXEL(format) == 0) {
-        SDL_SetError("Invalid texture format");
-        return NULL;
+            if (xy && indices) {
+                int i;
+                float *ptr_xy = xy;
+                int *ptr_indices = indices;
+                const int xy_stride = 2 * sizeof(float);
+                const int num_vertices = 4 * count;
+                const int num_indices = 6 * count;
+                const int size_indices = 4;
+                int cur_index = 0;
+                const int *rect_index_order = renderer->rect_index_order;
+
+                for (i = 0; i < count; ++i) {
+                    float minx, miny, maxx, maxy;
+
+                    minx = rects[i].x;
+                    miny = rects[i].y;
+                    maxx = rects[i].x + rects[i].w;
+                    maxy = rects[i].y + rects[i].h;
+
+                    *ptr_xy++ = minx;
+                    *ptr_xy++ = miny;
+                    *ptr_xy++ = maxx;
+                    *ptr_xy++ = miny;
+                    *ptr_xy++ = maxx;
+                    *ptr_xy++ = maxy;
+                    *ptr_xy++ = minx;
+                    *ptr_xy++ = maxy;
+
+                    *ptr_indices++ = cur_index + rect_index_order[0];
+                    *ptr_indices++ = cur_index + rect_index_order[1];
+                    *ptr_indices++ = cur_index + rect_index_order[2];
+                    *ptr_indices++ = cur_index + rect_index_order[3];
+                    *ptr_indices++ = cur_index + rect_index_order[4];
+                    *ptr_indices++ = cur_index + rect_index_order[5];
+                    cur_index += 4;
+                }
+
+                retval = renderer->QueueGeometry(renderer, cmd, NULL,
+                                                 xy, xy_stride, &renderer->color, 0 /* color_stride */, NULL, 0,
+                                                 num_vertices, indices, num_indices, size_indices,
+                                                 1.0f, 1.0f);
+
+                if (retval < 0) {
+                    cmd->command = SDL_RENDERCMD_NO_OP;
+                } else {
+                    FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
+                    if (renderer->optimize_batches) {
+                        SetQueueCmdDrawBounds(cmd, xy, xy_stride, num_vertices, 1.0f, 1.0f);
+                    }
+                }
+            }
+            SDL_small_free(xy, isstack1);
+            SDL_small_free(indices, isstack2);
+
+        } else {
+            retval = renderer->QueueFillRects(renderer, cmd, rects, count);
+            if (retval < 0) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            } else {
+                FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
+            }
+        }
+    }
+    return retval;
+}
+
+static int QueueCmdCopy(SDL_Renderer *renderer, SDL_Texture *texture, const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY, texture);
+    SDL_Rect atlas_srcrect;
+    int retval = -1;
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        if (texture->atlas) {
+            atlas_srcrect.x = srcrect->x + texture->atlas_rect.x;
+            atlas_srcrect.y = srcrect->y + texture->atlas_rect.y;
+            atlas_srcrect.w = srcrect->w;
+            atlas_srcrect.h = srcrect->h;
+            srcrect = &atlas_srcrect;
+            texture = texture->atlas->texture;
+        }
+        retval = renderer->QueueCopy(renderer, cmd, texture, srcrect, dstrect);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
+            if (renderer->optimize_batches) {
+                SDL_copyp(&cmd->data.draw.bounds, dstrect);
+            }
+        }
+    }
+    return retval;
+}
+
+static int QueueCmdCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
+                          const SDL_Rect *srcquad, const SDL_FRect *dstrect,
+                          const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip, float scale_x, float scale_y)
+{
+    SDL_RenderCommand *cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_COPY_EX, texture);
+    SDL_Rect atlas_srcquad;
+    int retval = -1;
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        if (texture->atlas) {
+            atlas_srcquad.x = srcquad->x + texture->atlas_rect.x;
+            atlas_srcquad.y = srcquad->y + texture->atlas_rect.y;
+            atlas_srcquad.w = srcquad->w;
+            atlas_srcquad.h = srcquad->h;
+            srcquad = &atlas_srcquad;
+            texture = texture->atlas->texture;
+        }
+        retval = renderer->QueueCopyEx(renderer, cmd, texture, srcquad, dstrect, angle, center, flip, scale_x, scale_y);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
+        }
+    }
+    return retval;
+}
+
+static int QueueCmdGeometry(SDL_Renderer *renderer, SDL_Texture *texture,
+                            const float *xy, int xy_stride,
+                            const SDL_Color *color, int color_stride,
+                            const float *uv, int uv_stride,
+                            int num_vertices,
+                            const void *indices, int num_indices, int size_indices,
+                            float scale_x, float scale_y)
+{
+    SDL_RenderCommand *cmd;
+    float *atlas_uv = NULL;
+    SDL_bool isstack = SDL_FALSE;
+    int retval = -1;
+
+    if (texture && texture->atlas) {
+        /* Map the texture coordinates into the atlas */
+        const SDL_Texture *atlas = texture->atlas->texture;
+        const float offset_u = (float)texture->atlas_rect.x / atlas->w;
+        const float offset_v = (float)texture->atlas_rect.y / atlas->h;
+        const float scale_u = (float)texture->w / atlas->w;
+        const float scale_v = (float)texture->h / atlas->h;
+        int i;
+
+        atlas_uv = SDL_small_alloc(float, num_vertices * 2, &isstack);
+        if (!atlas_uv) {
+            return SDL_OutOfMemory();
+        }
+        for (i = 0; i < num_vertices; ++i) {
+            const float *uv_ = (const float *)((const char *)uv + i * uv_stride);
+            atlas_uv[i * 2 + 0] = offset_u + uv_[0] * scale_u;
+            atlas_uv[i * 2 + 1] = offset_v + uv_[1] * scale_v;
+        }
+    }
+
+    cmd = PrepQueueCmdDraw(renderer, SDL_RENDERCMD_GEOMETRY, texture);
+    if (cmd) {
+        const size_t vertex_data_used = renderer->vertex_data_used;
+        if (atlas_uv) {
+            texture = texture->atlas->texture;
+            uv = atlas_uv;
+            uv_stride = 2 * sizeof(float);
+        }
+        retval = renderer->QueueGeometry(renderer, cmd, texture,
+                                         xy, xy_stride,
+                                         color, color_stride, uv, uv_stride,
+                                         num_vertices, indices, num_indices, size_indices,
+                                         scale_x, scale_y);
+        if (retval < 0) {
+            cmd->command = SDL_RENDERCMD_NO_OP;
+        } else {
+            FinishQueueCmdDraw(renderer, cmd, vertex_data_used);
+            if (renderer->optimize_batches) {
+                SetQueueCmdDrawBounds(cmd, xy, xy_stride, num_vertices, scale_x, scale_y);
+            }
+        }
+    }
+
+    if (atlas_uv) {
+        SDL_small_free(atlas_uv, isstack);
+    }
+    return retval;
+}
+
+static int UpdateLogicalSize(SDL_Renderer *renderer, SDL_bool flush_viewport_cmd);
+
+int SDL_GetNumRenderDrivers(void)
+{
+#ifndef SDL_RENDER_DISABLED
+    return SDL_arraysize(render_drivers);
+#else
+    return 0;
+#endif
+}
+
+int SDL_GetRenderDriverInfo(int index, SDL_RendererInfo *info)
+{
+#ifndef SDL_RENDER_DISABLED
+    if (index < 0 || index >= SDL_GetNumRenderDrivers()) {
+        return SDL_SetError("index must be in the range of 0 - %d",
+                            SDL_GetNumRenderDrivers() - 1);
+    }
+    *info = render_drivers[index]->info;
+    return 0;
+#else
+    return SDL_SetError("SDL not built with rendering support");
+#endif
+}
+
+static void GetWindowViewportValues(SDL_Renderer *renderer, int *logical_w, int *logical_h, SDL_DRect *viewport, SDL_FPoint *scale)
+{
+    SDL_LockMutex(renderer->target_mutex);
+    *logical_w = renderer->target ? renderer->logical_w_backup : renderer->logical_w;
+    *logical_h = renderer->target ? renderer->logical_h_backup : renderer->logical_h;
+    *viewport = renderer->target ? renderer->viewport_backup : renderer->viewport;
+    *scale = renderer->target ? renderer->scale_backup : renderer->scale;
+    SDL_UnlockMutex(renderer->target_mutex);
+}
+
+static int SDLCALL SDL_RendererEventWatch(void *userdata, SDL_Event *event)
+{
+    SDL_Renderer *renderer = (SDL_Renderer *)userdata;
+
+    if (event->type == SDL_WINDOWEVENT) {
+        SDL_Window *window = SDL_GetWindowFromID(event->window.windowID);
+        if (window == renderer->window) {
+            if (renderer->WindowEvent) {
+                WaitRenderThread(renderer);
+                renderer->WindowEvent(renderer, &event->window);
+            }
+
+            /* In addition to size changes, we also want to do this block for
+             * window display changes as well! If the new display has a new DPI,
+             * we need to update the viewport for the new window/drawable ratio.
+             */
+            if (event->window.event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+                event->window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED) {
+                /* Make sure we're operating on the default render target */
+                SDL_Texture *saved_target = SDL_GetRenderTarget(renderer);
+                if (saved_target) {
+                    SDL_SetRenderTarget(renderer, NULL);
+                }
+
+                /* The window contents are gone, the next frame is drawn in full */
+                renderer->num_damage_history = -1;
+
+                /* Update the DPI scale if the window has been resized. */
+                if (window && renderer->GetOutputSize) {
+                    int window_w, window_h;
+                    int output_w, output_h;
+                    if (renderer->GetOutputSize(renderer, &output_w, &output_h) == 0) {
+                        SDL_GetWindowSize(renderer->window, &window_w, &window_h);
+                        renderer->dpi_scale.x = (float)window_w / output_w;
+                        renderer->dpi_scale.y = (float)window_h / output_h;
+                    }
+                }
+
+                if (renderer->logical_w) {
+#if defined(__ANDROID__)
+                    /* Don't immediatly flush because the app may be in
+                     * background, and the egl context shouldn't be used. */
+                    SDL_bool flush_viewport_cmd = SDL_FALSE;
+#else
+                    SDL_bool flush_viewport_cmd = SDL_TRUE;
+#endif
+                    UpdateLogicalSize(renderer, flush_viewport_cmd);
+                } else {
+                    /* Window was resized, reset viewport */
+                    int w, h;
+
+                    if (renderer->GetOutputSize) {
+                        renderer->GetOutputSize(renderer, &w, &h);
+                    } else {
+                        SDL_GetWindowSize(renderer->window, &w, &h);
+                    }
+
+                    renderer->viewport.x = (double)0;
+                    renderer->viewport.y = (double)0;
+                    renderer->viewport.w = (double)w;
+                    renderer->viewport.h = (double)h;
+                    QueueCmdSetViewport(renderer);
+#if defined(__ANDROID__)
+                    /* Don't immediatly flush because the app may be in
+                     * background, and the egl context shouldn't be used. */
+#else
+                    FlushRenderCommandsIfNotBatching(renderer);
+#endif
+                }
+
+                if (saved_target) {
+                    SDL_SetRenderTarget(renderer, saved_target);
+                }
+            } else if (event->window.event == SDL_WINDOWEVENT_HIDDEN) {
+                renderer->hidden = SDL_TRUE;
+            } else if (event->window.event == SDL_WINDOWEVENT_SHOWN) {
+                if (!(SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED)) {
+                    renderer->hidden = SDL_FALSE;
+                }
+            } else if (event->window.event == SDL_WINDOWEVENT_MINIMIZED) {
+                renderer->hidden = SDL_TRUE;
+            } else if (event->window.event == SDL_WINDOWEVENT_RESTORED ||
+                       event->window.event == SDL_WINDOWEVENT_MAXIMIZED) {
+                if (!(SDL_GetWindowFlags(window) & SDL_WINDOW_HIDDEN)) {
+                    renderer->hidden = SDL_FALSE;
+                }
+            }
+        }
+    } else if (event->type == SDL_MOUSEMOTION) {
+        SDL_Window *window = SDL_GetWindowFromID(event->motion.windowID);
+        if (window == renderer->window) {
+            int logical_w, logical_h;
+            SDL_DRect viewport;
+            SDL_FPoint scale;
+            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
+            if (logical_w) {
+                event->motion.x -= (int)(viewport.x * renderer->dpi_scale.x);
+                event->motion.y -= (int)(viewport.y * renderer->dpi_scale.y);
+                event->motion.x = (int)(event->motion.x / (scale.x * renderer->dpi_scale.x));
+                event->motion.y = (int)(event->motion.y / (scale.y * renderer->dpi_scale.y));
+                if (event->motion.xrel != 0 && renderer->relative_scaling) {
+                    float rel = renderer->xrel + event->motion.xrel / (scale.x * renderer->dpi_scale.x);
+                    float truncated = SDL_truncf(rel);
+                    renderer->xrel = rel - truncated;
+                    event->motion.xrel = (Sint32)truncated;
+                }
+                if (event->motion.yrel != 0 && renderer->relative_scaling) {
+                    float rel = renderer->yrel + event->motion.yrel / (scale.y * renderer->dpi_scale.y);
+                    float truncated = SDL_truncf(rel);
+                    renderer->yrel = rel - truncated;
+                    event->motion.yrel = (Sint32)truncated;
+                }
+            }
+        }
+    } else if (event->type == SDL_MOUSEBUTTONDOWN ||
+               event->type == SDL_MOUSEBUTTONUP) {
+        SDL_Window *window = SDL_GetWindowFromID(event->button.windowID);
+        if (window == renderer->window) {
+            int logical_w, logical_h;
+            SDL_DRect viewport;
+            SDL_FPoint scale;
+            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
+            if (logical_w) {
+                event->button.x -= (int)(viewport.x * renderer->dpi_scale.x);
+                event->button.y -= (int)(viewport.y * renderer->dpi_scale.y);
+                event->button.x = (int)(event->button.x / (scale.x * renderer->dpi_scale.x));
+                event->button.y = (int)(event->button.y / (scale.y * renderer->dpi_scale.y));
+            }
+        }
+    } else if (event->type == SDL_MOUSEWHEEL) {
+        SDL_Window *window = SDL_GetWindowFromID(event->wheel.windowID);
+        if (window == renderer->window) {
+            int logical_w, logical_h;
+            SDL_DRect viewport;
+            SDL_FPoint scale;
+            GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
+            if (logical_w) {
+                event->wheel.mouseX -= (int)(viewport.x * renderer->dpi_scale.x);
+                event->wheel.mouseY -= (int)(viewport.y * renderer->dpi_scale.y);
+                event->wheel.mouseX = (int)(event->wheel.mouseX / (scale.x * renderer->dpi_scale.x));
+                event->wheel.mouseY = (int)(event->wheel.mouseY / (scale.y * renderer->dpi_scale.y));
+            }
+        }
+    } else if (event->type == SDL_FINGERDOWN ||
+               event->type == SDL_FINGERUP ||
+               event->type == SDL_FINGERMOTION) {
+        int logical_w, logical_h;
+        float physical_w, physical_h;
+        SDL_DRect viewport;
+        SDL_FPoint scale;
+        GetWindowViewportValues(renderer, &logical_w, &logical_h, &viewport, &scale);
+
+        /* !!! FIXME: we probably should drop events that are outside of the
+           !!! FIXME: viewport, but we can't do that from an event watcher,
+           !!! FIXME: and we would have to track if a touch happened outside
+           !!! FIXME: the viewport and then slid into it to insert extra
+           !!! FIXME: events, which is a mess, so for now we just clamp these
+           !!! FIXME: events to the edge. */
+
+        if (renderer->GetOutputSize) {
+            int w, h;
+            renderer->GetOutputSize(renderer, &w, &h);
+            physical_w = (float)w;
+            physical_h = (float)h;
+        } else {
+            int w, h;
+            SDL_GetWindowSize(renderer->window, &w, &h);
+            physical_w = ((float)w) * renderer->dpi_scale.x;
+            physical_h = ((float)h) * renderer->dpi_scale.y;
+        }
+
+        if (physical_w == 0.0f) { /* nowhere for the touch to go, avoid division by zero and put it dead center. */
+            event->tfinger.x = 0.5f;
+        } else {
+            const float normalized_viewport_x = ((float)viewport.x) / physical_w;
+            const float normalized_viewport_w = ((float)viewport.w) / physical_w;
+            if (event->tfinger.x <= normalized_viewport_x) {
+                event->tfinger.x = 0.0f; /* to the left of the viewport, clamp to the edge. */
+            } else if (event->tfinger.x >= (normalized_viewport_x + normalized_viewport_w)) {
+                event->tfinger.x = 1.0f; /* to the right of the viewport, clamp to the edge. */
+            } else {
+                event->tfinger.x = (event->tfinger.x - normalized_viewport_x) / normalized_viewport_w;
+            }
+        }
+
+        if (physical_h == 0.0f) { /* nowhere for the touch to go, avoid division by zero and put it dead center. */
+            event->tfinger.y = 0.5f;
+        } else {
+            const float normalized_viewport_y = ((float)viewport.y) / physical_h;
+            const float normalized_viewport_h = ((float)viewport.h) / physical_h;
+            if (event->tfinger.y <= normalized_viewport_y) {
+                event->tfinger.y = 0.0f; /* to the left of the viewport, clamp to the edge. */
+            } else if (event->tfinger.y >= (normalized_viewport_y + normalized_viewport_h)) {
+                event->tfinger.y = 1.0f; /* to the right of the viewport, clamp to the edge. */
+            } else {
+                event->tfinger.y = (event->tfinger.y - normalized_viewport_y) / normalized_viewport_h;
+            }
+        }
+    }
+
+    return 0;
+}
+
+int SDL_CreateWindowAndRenderer(int width, int height, Uint32 window_flags,
+                                SDL_Window **window, SDL_Renderer **renderer)
+{
+    *window = SDL_CreateWindow(NULL, SDL_WINDOWPOS_UNDEFINED,
+                               SDL_WINDOWPOS_UNDEFINED,
+                               width, height, window_flags);
+    if (!*window) {
+        *renderer = NULL;
+        return -1;
+    }
+
+    *renderer = SDL_CreateRenderer(*window, -1, 0);
+    if (!*renderer) {
+        return -1;
+    }
+
+    return 0;
+}
+
+#ifndef SDL_RENDER_DISABLED
+static SDL_INLINE void VerifyDrawQueueFunctions(const SDL_Renderer *renderer)
+{
+    /* all of these functions are required to be implemented, even as no-ops, so we don't
+        have to check that they aren't NULL over and over. */
+    SDL_assert(renderer->QueueSetViewport != NULL);
+    SDL_assert(renderer->QueueSetDrawColor != NULL);
+    SDL_assert(renderer->QueueDrawPoints != NULL);
+    SDL_assert(renderer->QueueDrawLines != NULL || renderer->QueueGeometry != NULL);
+    SDL_assert(renderer->QueueFillRects != NULL || renderer->QueueGeometry != NULL);
+    SDL_assert(renderer->QueueCopy != NULL || renderer->QueueGeometry != NULL);
+    SDL_assert(renderer->RunCommandQueue != NULL);
+}
+
+static SDL_RenderLineMethod SDL_GetRenderLineMethod(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_LINE_METHOD);
+
+    int method = 0;
+    if (hint) {
+        method = SDL_atoi(hint);
+    }
+    switch (method) {
+    case 1:
+        return SDL_RENDERLINEMETHOD_POINTS;
+    case 2:
+        return SDL_RENDERLINEMETHOD_LINES;
+    case 3:
+        return SDL_RENDERLINEMETHOD_GEOMETRY;
+    default:
+        return SDL_RENDERLINEMETHOD_POINTS;
+    }
+}
+
+static void SDL_CalculateSimulatedVSyncInterval(SDL_Renderer *renderer, SDL_Window *window)
+{
+    /* FIXME: SDL refresh rate API should return numerator/denominator */
+    int refresh_rate = 0;
+    int display_index = SDL_GetWindowDisplayIndex(window);
+    SDL_DisplayMode mode;
+
+    if (display_index < 0) {
+        display_index = 0;
+    }
+    if (SDL_GetDesktopDisplayMode(display_index, &mode) == 0) {
+        refresh_rate = mode.refresh_rate;
+    }
+    if (!refresh_rate) {
+        /* Pick a good default refresh rate */
+        refresh_rate = 60;
+    }
+    renderer->simulate_vsync_interval = (1000 / refresh_rate);
+}
+#endif /* !SDL_RENDER_DISABLED */
+
+SDL_Renderer *SDL_CreateRenderer(SDL_Window *window, int index, Uint32 flags)
+{
+#ifndef SDL_RENDER_DISABLED
+    SDL_Renderer *renderer = NULL;
+    int n = SDL_GetNumRenderDrivers();
+    SDL_bool batching = SDL_TRUE;
+    SDL_bool use_render_thread;
+    const char *hint;
+
+#if defined(__ANDROID__)
+    Android_ActivityMutex_Lock_Running();
+#endif
+
+    if (!window) {
+        SDL_InvalidParamError("window");
+        goto error;
+    }
+
+    if (SDL_HasWindowSurface(window)) {
+        SDL_SetError("Surface already associated with window");
+        goto error;
+    }
+
+    if (SDL_GetRenderer(window)) {
+        SDL_SetError("Renderer already associated with window");
+        goto error;
+    }
+
+    hint = SDL_GetHint(SDL_HINT_RENDER_VSYNC);
+    if (hint && *hint) {
+        if (SDL_GetHintBoolean(SDL_HINT_RENDER_VSYNC, SDL_TRUE)) {
+            flags |= SDL_RENDERER_PRESENTVSYNC;
+        } else {
+            flags &= ~SDL_RENDERER_PRESENTVSYNC;
+        }
+    }
+
+    if (index < 0) {
+        hint = SDL_GetHint(SDL_HINT_RENDER_DRIVER);
+        if (hint) {
+            for (index = 0; index < n; ++index) {
+                const SDL_RenderDriver *driver = render_drivers[index];
+
+                if (SDL_strcasecmp(hint, driver->info.name) == 0) {
+                    /* Create a new renderer instance */
+                    renderer = driver->CreateRenderer(window, flags);
+                    if (renderer) {
+                        batching = SDL_FALSE;
+                    }
+                    break;
+                }
+            }
+        }
+
+        if (!renderer) {
+            for (index = 0; index < n; ++index) {
+                const SDL_RenderDriver *driver = render_drivers[index];
+
+                if ((driver->info.flags & flags) == flags) {
+                    /* Create a new renderer instance */
+                    renderer = driver->CreateRenderer(window, flags);
+                    if (renderer) {
+                        /* Yay, we got one! */
+                        break;
+                    }
+                }
+            }
+        }
+        if (!renderer) {
+            SDL_SetError("Couldn't find matching render driver");
+            goto error;
+        }
+    } else {
+        if (index >= n) {
+            SDL_SetError("index must be -1 or in the range of 0 - %d",
+                         n - 1);
+            goto error;
+        }
+        /* Create a new renderer instance */
+        renderer = render_drivers[index]->CreateRenderer(window, flags);
+        batching = SDL_FALSE;
+        if (!renderer) {
+            goto error;
+        }
+    }
+
+    if (flags & SDL_RENDERER_PRESENTVSYNC) {
+        renderer->wanted_vsync = SDL_TRUE;
+
+        if (!(renderer->info.flags & SDL_RENDERER_PRESENTVSYNC)) {
+            renderer->simulate_vsync = SDL_TRUE;
+            renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
+        }
+    }
+    SDL_CalculateSimulatedVSyncInterval(renderer, window);
+
+    VerifyDrawQueueFunctions(renderer);
+
+    /* let app/user override batching decisions. */
+    if (renderer->always_batch) {
+        batching = SDL_TRUE;
+    } else if (SDL_GetHint(SDL_HINT_RENDER_BATCHING)) {
+        batching = SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_TRUE);
+    }
+
+    /* The render thread needs the whole frame queued up, and double buffers
+       the vertex data, so it can't be owned by the backend. */
+    use_render_thread = (renderer->ReleaseContext && !renderer->GrowVertexData &&
+                         SDL_GetHintBoolean(SDL_HINT_RENDER_THREAD, SDL_FALSE));
+    if (use_render_thread) {
+        batching = SDL_TRUE;
+    }
+
+    renderer->batching = batching;
+    renderer->optimize_batches = SDL_GetHintBoolean(SDL_HINT_RENDER_OPTIMIZE_BATCHES, SDL_FALSE);
+    renderer->use_texture_atlas = SDL_GetHintBoolean(SDL_HINT_RENDER_TEXTURE_ATLAS, SDL_FALSE);
+    renderer->cull_draws = SDL_GetHintBoolean(SDL_HINT_RENDER_CULLING, SDL_FALSE);
+    renderer->texture_budget = GetTextureBudget();
+    renderer->num_damage_history = -1;
+    InitRenderStats(renderer);
+    renderer->magic = &renderer_magic;
+    renderer->window = window;
+    renderer->target_mutex = SDL_CreateMutex();
+    renderer->scale.x = 1.0f;
+    renderer->scale.y = 1.0f;
+    renderer->dpi_scale.x = 1.0f;
+    renderer->dpi_scale.y = 1.0f;
+
+    /* Default value, if not specified by the renderer back-end */
+    if (renderer->rect_index_order[0] == 0 && renderer->rect_index_order[1] == 0) {
+        renderer->rect_index_order[0] = 0;
+        renderer->rect_index_order[1] = 1;
+        renderer->rect_index_order[2] = 2;
+        renderer->rect_index_order[3] = 0;
+        renderer->rect_index_order[4] = 2;
+        renderer->rect_index_order[5] = 3;
+    }
+
+    /* new textures start at zero, so we start at 1 so first render doesn't flush by accident. */
+    renderer->render_command_generation = 1;
+
+    if (renderer->GetOutputSize) {
+        int window_w, window_h;
+        int output_w, output_h;
+        if (renderer->GetOutputSize(renderer, &output_w, &output_h) == 0) {
+            SDL_GetWindowSize(renderer->window, &window_w, &window_h);
+            renderer->dpi_scale.x = (float)window_w / output_w;
+            renderer->dpi_scale.y = (float)window_h / output_h;
+        }
+    }
+
+    renderer->relative_scaling = SDL_GetHintBoolean(SDL_HINT_MOUSE_RELATIVE_SCALING, SDL_TRUE);
+
+    renderer->line_method = SDL_GetRenderLineMethod();
+
+    if (SDL_GetWindowFlags(window) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED)) {
+        renderer->hidden = SDL_TRUE;
+    } else {
+        renderer->hidden = SDL_FALSE;
+    }
+
+    SDL_SetWindowData(window, SDL_WINDOWRENDERDATA, renderer);
+
+    SDL_RenderSetViewport(renderer, NULL);
+
+    SDL_AddEventWatch(SDL_RendererEventWatch, renderer);
+
+    if (use_render_thread) {
+        StartRenderThread(renderer);
+    }
+
+    SDL_LogInfo(SDL_LOG_CATEGORY_RENDER,
+                "Created renderer: %s", renderer->info.name);
+
+#if defined(__ANDROID__)
+    Android_ActivityMutex_Unlock();
+#endif
+    return renderer;
+
+error:
+
+#if defined(__ANDROID__)
+    Android_ActivityMutex_Unlock();
+#endif
+    return NULL;
+
+#else
+    SDL_SetError("SDL not built with rendering support");
+    return NULL;
+#endif
+}
+
+SDL_Renderer *SDL_CreateSoftwareRenderer(SDL_Surface *surface)
+{
+#if !defined(SDL_RENDER_DISABLED) && SDL_VIDEO_RENDER_SW
+    SDL_Renderer *renderer;
+
+    renderer = SW_CreateRendererForSurface(surface);
+
+    if (renderer) {
+        /* Applications may touch the surface directly between draws, so only
+           batch when asked to. */
+        renderer->batching = SDL_GetHintBoolean(SDL_HINT_RENDER_BATCHING, SDL_FALSE);
+        renderer->optimize_batches = SDL_GetHintBoolean(SDL_HINT_RENDER_OPTIMIZE_BATCHES, SDL_FALSE);
+        renderer->use_texture_atlas = SDL_GetHintBoolean(SDL_HINT_RENDER_TEXTURE_ATLAS, SDL_FALSE);
+        renderer->cull_draws = SDL_GetHintBoolean(SDL_HINT_RENDER_CULLING, SDL_FALSE);
+        renderer->texture_budget = GetTextureBudget();
+        renderer->num_damage_history = -1;
+        InitRenderStats(renderer);
+        renderer->magic = &renderer_magic;
+        renderer->target_mutex = SDL_CreateMutex();
+        renderer->scale.x = 1.0f;
+        renderer->scale.y = 1.0f;
+        renderer->dpi_scale.x = 1.0f;
+        renderer->dpi_scale.y = 1.0f;
+
+        renderer->rect_index_order[0] = 0;
+        renderer->rect_index_order[1] = 1;
+        renderer->rect_index_order[2] = 2;
+        renderer->rect_index_order[3] = 0;
+        renderer->rect_index_order[4] = 2;
+        renderer->rect_index_order[5] = 3;
+
+        /* new textures start at zero, so we start at 1 so first render doesn't flush by accident. */
+        renderer->render_command_generation = 1;
+
+        /* Software renderer always uses line method, for speed */
+        renderer->line_method = SDL_RENDERLINEMETHOD_LINES;
+
+        SDL_RenderSetViewport(renderer, NULL);
+    }
+    return renderer;
+#else
+    SDL_SetError("SDL not built with rendering support");
+    return NULL;
+#endif /* !SDL_RENDER_DISABLED */
+}
+
+SDL_Renderer *SDL_GetRenderer(SDL_Window *window)
+{
+    return (SDL_Renderer *)SDL_GetWindowData(window, SDL_WINDOWRENDERDATA);
+}
+
+SDL_Window *SDL_RenderGetWindow(SDL_Renderer *renderer)
+{
+    CHECK_RENDERER_MAGIC(renderer, NULL);
+    return renderer->window;
+}
+
+int SDL_GetRendererInfo(SDL_Renderer *renderer, SDL_RendererInfo *info)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    *info = renderer->info;
+    return 0;
+}
+
+int SDL_GetRendererOutputSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (renderer->target) {
+        return SDL_QueryTexture(renderer->target, NULL, NULL, w, h);
+    } else if (renderer->GetOutputSize) {
+        return renderer->GetOutputSize(renderer, w, h);
+    } else if (renderer->window) {
+        SDL_GetWindowSize(renderer->window, w, h);
+        return 0;
+    } else {
+        SDL_assert(0 && "This should never happen");
+        return SDL_SetError("Renderer doesn't support querying output size");
+    }
+}
+
+static SDL_bool IsSupportedBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+{
+    switch (blendMode) {
+    /* These are required to be supported by all renderers */
+    case SDL_BLENDMODE_NONE:
+    case SDL_BLENDMODE_BLEND:
+    case SDL_BLENDMODE_ADD:
+    case SDL_BLENDMODE_MOD:
+    case SDL_BLENDMODE_MUL:
+        return SDL_TRUE;
+
+    default:
+        return renderer->SupportsBlendMode && renderer->SupportsBlendMode(renderer, blendMode);
+    }
+}
+
+static SDL_bool IsSupportedFormat(SDL_Renderer *renderer, Uint32 format)
+{
+    Uint32 i;
+
+    for (i = 0; i < renderer->info.num_texture_formats; ++i) {
+        if (renderer->info.texture_formats[i] == format) {
+            return SDL_TRUE;
+        }
+    }
+    return SDL_FALSE;
+}
+
+static Uint32 GetClosestSupportedFormat(SDL_Renderer *renderer, Uint32 format)
+{
+    Uint32 i;
+
+    if (SDL_ISPIXELFORMAT_FOURCC(format)) {
+        /* Look for an exact match */
+        for (i = 0; i < renderer->info.num_texture_formats; ++i) {
+            if (renderer->info.texture_formats[i] == format) {
+                return renderer->info.texture_formats[i];
+            }
+        }
+    } else {
+        SDL_bool hasAlpha = SDL_ISPIXELFORMAT_ALPHA(format);
+
+        /* We just want to match the first format that has the same channels */
+        for (i = 0; i < renderer->info.num_texture_formats; ++i) {
+            if (!SDL_ISPIXELFORMAT_FOURCC(renderer->info.texture_formats[i]) &&
+                SDL_ISPIXELFORMAT_ALPHA(renderer->info.texture_formats[i]) == hasAlpha) {
+                return renderer->info.texture_formats[i];
+            }
+        }
+    }
+    return renderer->info.texture_formats[0];
+}
+
+static SDL_ScaleMode SDL_GetScaleMode(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SCALE_QUALITY);
+
+    if (!hint || SDL_strcasecmp(hint, "nearest") == 0) {
+        return SDL_ScaleModeNearest;
+    } else if (SDL_strcasecmp(hint, "linear") == 0) {
+        return SDL_ScaleModeLinear;
+    } else if (SDL_strcasecmp(hint, "best") == 0) {
+        return SDL_ScaleModeBest;
+    } else {
+        return (SDL_ScaleMode)SDL_atoi(hint);
+    }
+}
+
+static SDL_bool IsTextureAtlasCandidate(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    if (!renderer->use_texture_atlas ||
+        texture->access != SDL_TEXTUREACCESS_STATIC ||
+        SDL_ISPIXELFORMAT_FOURCC(texture->format) ||
+        SDL_ISPIXELFORMAT_INDEXED(texture->format)) {
+        return SDL_FALSE;
+    }
+    if (texture->w > TEXTURE_ATLAS_MAX_TEXTURE || texture->h > TEXTURE_ATLAS_MAX_TEXTURE) {
+        return SDL_FALSE;
+    }
+    if ((renderer->info.max_texture_width && renderer->info.max_texture_width < TEXTURE_ATLAS_SIZE) ||
+        (renderer->info.max_texture_height && renderer->info.max_texture_height < TEXTURE_ATLAS_SIZE)) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+/* Returns the y position a w pixels wide rectangle would have at the given skyline node, or -1 if it doesn't fit */
+static int FitTextureAtlasNode(const SDL_TextureAtlas *atlas, int index, int w, int h)
+{
+    int x = atlas->nodes[index].x;
+    int y = 0;
+
+    if (x + w > TEXTURE_ATLAS_SIZE) {
+        return -1;
+    }
+    while (w > 0 && index < atlas->num_nodes) {
+        y = SDL_max(y, atlas->nodes[index].y);
+        if (y + h > TEXTURE_ATLAS_SIZE) {
+            return -1;
+        }
+        w -= atlas->nodes[index].w;
+        ++index;
+    }
+    return y;
+}
+
+static SDL_bool PackTextureAtlas(SDL_TextureAtlas *atlas, int w, int h, SDL_Point *position)
+{
+    SDL_TextureAtlasNode *nodes = atlas->nodes;
+    int best = -1, best_y = TEXTURE_ATLAS_SIZE, best_w = TEXTURE_ATLAS_SIZE + 1;
+    int i;
+
+    /* Place the rectangle as low as possible, preferring narrow gaps */
+    for (i = 0; i < atlas->num_nodes; ++i) {
+        const int y = FitTextureAtlasNode(atlas, i, w, h);
+        if (y >= 0 && (y < best_y || (y == best_y && nodes[i].w < best_w))) {
+            best = i;
+            best_y = y;
+            best_w = nodes[i].w;
+        }
+    }
+    if (best < 0) {
+        return SDL_FALSE;
+    }
+
+    position->x = nodes[best].x;
+    position->y = best_y;
+
+    /* Insert the new top edge and trim the nodes it covers */
+    SDL_memmove(&nodes[best + 1], &nodes[best], (atlas->num_nodes - best) * sizeof(*nodes));
+    ++atlas->num_nodes;
+    nodes[best].y = best_y + h;
+    nodes[best].w = w;
+
+    for (i = best + 1; i < atlas->num_nodes;) {
+        const int shrink = (nodes[i - 1].x + nodes[i - 1].w) - nodes[i].x;
+        if (shrink <= 0) {
+            break;
+        }
+        nodes[i].x += shrink;
+        nodes[i].w -= shrink;
+        if (nodes[i].w > 0) {
+            break;
+        }
+        SDL_memmove(&nodes[i], &nodes[i + 1], (atlas->num_nodes - i - 1) * sizeof(*nodes));
+        --atlas->num_nodes;
+    }
+
+    /* Merge neighbors at the same height */
+    for (i = 0; i < (atlas->num_nodes - 1);) {
+        if (nodes[i].y == nodes[i + 1].y) {
+            nodes[i].w += nodes[i + 1].w;
+            SDL_memmove(&nodes[i + 1], &nodes[i + 2], (atlas->num_nodes - i - 2) * sizeof(*nodes));
+            --atlas->num_nodes;
+        } else {
+            ++i;
+        }
+    }
+    return SDL_TRUE;
+}
+
+static SDL_TextureAtlas *CreateTextureAtlas(SDL_Renderer *renderer, Uint32 format, SDL_ScaleMode scaleMode)
+{
+    SDL_TextureAtlas *atlas;
+    SDL_Texture *texture;
+
+    atlas = (SDL_TextureAtlas *)SDL_calloc(1, sizeof(*atlas));
+    if (!atlas) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC, TEXTURE_ATLAS_SIZE, TEXTURE_ATLAS_SIZE);
+    if (!texture) {
+        SDL_free(atlas);
+        return NULL;
+    }
+    SDL_SetTextureScaleMode(texture, scaleMode);
+
+    /* Move the atlas to the end of the texture list, so it outlives the
+       textures packed into it when the renderer is destroyed. */
+    if (texture->next) {
+        SDL_Texture *last = texture->next;
+        while (last->next) {
+            last = last->next;
+        }
+        renderer->textures = texture->next;
+        renderer->textures->prev = NULL;
+        texture->prev = last;
+        texture->next = NULL;
+        last->next = texture;
+    }
+
+    atlas->texture = texture;
+    atlas->num_nodes = 1;
+    atlas->nodes[0].w = TEXTURE_ATLAS_SIZE;
+    atlas->next = renderer->texture_atlases;
+    renderer->texture_atlases = atlas;
+    return atlas;
+}
+
+static void ReleaseTextureAtlas(SDL_Renderer *renderer, SDL_TextureAtlas *atlas)
+{
+    SDL_TextureAtlas **prev;
+
+    if (--atlas->refcount > 0) {
+        return;
+    }
+
+    for (prev = &renderer->texture_atlases; *prev; prev = &(*prev)->next) {
+        if (*prev == atlas) {
+            *prev = atlas->next;
+            break;
+        }
+    }
+    SDL_DestroyTexture(atlas->texture);
+    SDL_free(atlas);
+}
+
+/* Upload part of a packed texture from its pixels, along with the border
+   around it that keeps linear filtering from picking up its neighbors. */
+static int UploadTextureAtlasRect(SDL_Texture *texture, const SDL_Rect *rect)
+{
+    const int bpp = SDL_BYTESPERPIXEL(texture->format);
+    const int x0 = (rect->x == 0) ? -1 : rect->x;
+    const int y0 = (rect->y == 0) ? -1 : rect->y;
+    const int x1 = (rect->x + rect->w == texture->w) ? texture->w + 1 : rect->x + rect->w;
+    const int y1 = (rect->y + rect->h == texture->h) ? texture->h + 1 : rect->y + rect->h;
+    SDL_Rect dstrect;
+    Uint8 *temp_pixels;
+    int temp_pitch;
+    int x, y, retval;
+
+    dstrect.x = texture->atlas_rect.x + x0;
+    dstrect.y = texture->atlas_rect.y + y0;
+    dstrect.w = x1 - x0;
+    dstrect.h = y1 - y0;
+
+    temp_pitch = dstrect.w * bpp;
+    temp_pixels = (Uint8 *)SDL_malloc((size_t)temp_pitch * dstrect.h);
+    if (!temp_pixels) {
+        return SDL_OutOfMemory();
+    }
+
+    for (y = y0; y < y1; ++y) {
+        const Uint8 *src = (const Uint8 *)texture->pixels + SDL_clamp(y, 0, texture->h - 1) * texture->pitch;
+        Uint8 *dst = temp_pixels + (y - y0) * temp_pitch;
+
+        for (x = x0; x < 0; ++x) {
+            SDL_memcpy(dst, src, bpp);
+            dst += bpp;
+        }
+        x = SDL_max(x0, 0);
+        SDL_memcpy(dst, src + x * bpp, (SDL_min(x1, texture->w) - x) * bpp);
+        dst += (SDL_min(x1, texture->w) - x) * bpp;
+        for (x = texture->w; x < x1; ++x) {
+            SDL_memcpy(dst, src + (texture->w - 1) * bpp, bpp);
+            dst += bpp;
+        }
+    }
+
+    retval = SDL_UpdateTexture(texture->atlas->texture, &dstrect, temp_pixels, temp_pitch);
+    SDL_free(temp_pixels);
+    return retval;
+}
+
+/* Pack a texture into an atlas matching its format and scale mode */
+static int AddTextureToAtlas(SDL_Texture *texture)
+{
+    SDL_Renderer *renderer = texture->renderer;
+    SDL_TextureAtlas *atlas;
+    SDL_Point position;
+    SDL_Rect rect;
+
+    if (!texture->pixels) {
+        /* The pitch is 4 byte aligned */
+        texture->pitch = (((texture->w * SDL_BYTESPERPIXEL(texture->format)) + 3) & ~3);
+        texture->pixels = SDL_calloc(1, (size_t)texture->pitch * texture->h);
+        if (!texture->pixels) {
+            return SDL_OutOfMemory();
+        }
+    }
+
+    for (atlas = renderer->texture_atlases; atlas; atlas = atlas->next) {
+        if (atlas->texture->format == texture->format &&
+            atlas->texture->scaleMode == texture->scaleMode &&
+            PackTextureAtlas(atlas, texture->w + 2, texture->h + 2, &position)) {
+            break;
+        }
+    }
+    if (!atlas) {
+        atlas = CreateTextureAtlas(renderer, texture->format, texture->scaleMode);
+        if (!atlas) {
+            return -1;
+        }
+        if (!PackTextureAtlas(atlas, texture->w + 2, texture->h + 2, &position)) {
+            ++atlas->refcount;
+            ReleaseTextureAtlas(renderer, atlas);
+            return SDL_SetError("Texture doesn't fit in a texture atlas");
+        }
+    }
+
+    ++atlas->refcount;
+    texture->atlas = atlas;
+    texture->atlas_rect.x = position.x + 1;
+    texture->atlas_rect.y = position.y + 1;
+    texture->atlas_rect.w = texture->w;
+    texture->atlas_rect.h = texture->h;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+    if (UploadTextureAtlasRect(texture, &rect) < 0) {
+        texture->atlas = NULL;
+        ReleaseTextureAtlas(renderer, atlas);
+        return -1;
+    }
+    return 0;
+}
+
+static int SDL_UpdateTextureAtlas(SDL_Texture *texture, const SDL_Rect *rect,
+                                  const void *pixels, int pitch)
+{
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst = (Uint8 *)texture->pixels + rect->y * texture->pitch + rect->x * SDL_BYTESPERPIXEL(texture->format);
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        src += pitch;
+        dst += texture->pitch;
+    }
+    return UploadTextureAtlasRect(texture, rect);
+}
+
+SDL_Texture *SDL_CreateTexture(SDL_Renderer *renderer, Uint32 format, int access, int w, int h)
+{
+    SDL_Texture *texture;
+    SDL_bool texture_is_fourcc_and_target;
+
+    CHECK_RENDERER_MAGIC(renderer, NULL);
+
+    if (!format) {
+        format = renderer->info.texture_formats[0];
+    }
+    if (SDL_BYTESPERPIXEL(format) == 0) {
+        SDL_SetError("Invalid texture format");
+        return NULL;
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(format)) {
+        if (!IsSupportedFormat(renderer, format)) {
+            SDL_SetError("Palettized textures are not supported");
+            return NULL;
+        }
+    }
+    if (w <= 0 || h <= 0) {
+        SDL_SetError("Texture dimensions can't be 0");
+        return NULL;
+    }
+    if ((renderer->info.max_texture_width && w > renderer->info.max_texture_width) ||
+        (renderer->info.max_texture_height && h > renderer->info.max_texture_height)) {
+        SDL_SetError("Texture dimensions are limited to %dx%d", renderer->info.max_texture_width, renderer->info.max_texture_height);
+        return NULL;
+    }
+    texture = (SDL_Texture *)SDL_calloc(1, sizeof(*texture));
+    if (!texture) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    texture->magic = &texture_magic;
+    texture->format = format;
+    texture->access = access;
+    texture->w = w;
+    texture->h = h;
+    texture->color.r = 255;
+    texture->color.g = 255;
+    texture->color.b = 255;
+    texture->color.a = 255;
+    texture->scaleMode = SDL_GetScaleMode();
+    texture->renderer = renderer;
+    texture->next = renderer->textures;
+    if (renderer->textures) {
+        renderer->textures->prev = texture;
+    }
+    renderer->textures = texture;
+
+    /* FOURCC format cannot be used directly by renderer back-ends for target texture */
+    texture_is_fourcc_and_target = (access == SDL_TEXTUREACCESS_TARGET && SDL_ISPIXELFORMAT_FOURCC(texture->format));
+
+    if (texture_is_fourcc_and_target == SDL_FALSE && IsSupportedFormat(renderer, format)) {
+        if (IsTextureAtlasCandidate(renderer, texture) && AddTextureToAtlas(texture) == 0) {
+            /* The texture lives in an atlas, there's no backend texture */
+        } else {
+            /* Fall back to a texture of its own if it couldn't be packed */
+            SDL_free(texture->pixels);
+            texture->pixels = NULL;
+            texture->pitch = 0;
+
+            WaitRenderThread(renderer);
+            if (renderer->CreateTexture(renderer, texture) < 0) {
+                SDL_DestroyTexture(texture);
+                return NULL;
+            }
+            texture->memory = GetTexturePixelsSize(format, w, h);
+            renderer->texture_memory += texture->memory;
+        }
+    } else {
+        int closest_format;
+
+        if (texture_is_fourcc_and_target == SDL_FALSE) {
+            closest_format = GetClosestSupportedFormat(renderer, format);
+        } else {
+            closest_format = renderer->info.texture_formats[0];
+        }
+
+        texture->native = SDL_CreateTexture(renderer, closest_format, access, w, h);
+        if (!texture->native) {
+            SDL_DestroyTexture(texture);
+            return NULL;
+        }
+
+        /* Swap textures to have texture before texture->native in the list */
+        texture->native->next = texture->next;
+        if (texture->native->next) {
+            texture->native->next->prev = texture->native;
+        }
+        texture->prev = texture->native->prev;
+        if (texture->prev) {
+            texture->prev->next = texture;
+        }
+        texture->native->prev = texture;
+        texture->next = texture->native;
+        renderer->textures = texture;
+
+        if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+#if SDL_HAVE_YUV
+            texture->yuv = SDL_SW_CreateYUVTexture(format, w, h);
+#else
+            SDL_SetError("SDL not built with YUV support");
+#endif
+            if (!texture->yuv) {
+                SDL_DestroyTexture(texture);
+                return NULL;
+            }
+        } else if (access == SDL_TEXTUREACCESS_STREAMING) {
+            /* The pitch is 4 byte aligned */
+            texture->pitch = (((w * SDL_BYTESPERPIXEL(format)) + 3) & ~3);
+            texture->pixels = SDL_calloc(1, (size_t)texture->pitch * h);
+            if (!texture->pixels) {
+                SDL_DestroyTexture(texture);
+                return NULL;
+            }
+        }
+    }
+    return texture;
+}
+
+SDL_Texture *SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *surface)
+{
+    const SDL_PixelFormat *fmt;
+    SDL_bool needAlpha;
+    SDL_bool direct_update;
+    int i;
+    Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
+    SDL_Texture *texture;
+
+    CHECK_RENDERER_MAGIC(renderer, NULL);
+
+    if (!surface) {
+        SDL_InvalidParamError("SDL_CreateTextureFromSurface(): surface");
+        return NULL;
+    }
+
+    /* See what the best texture format is */
+    fmt = surface->format;
+    if (fmt->Amask || SDL_HasColorKey(surface)) {
+        needAlpha = SDL_TRUE;
+    } else {
+        needAlpha = SDL_FALSE;
+    }
+
+    /* If Palette contains alpha values, promotes to alpha format */
+    if (fmt->palette) {
+        SDL_bool is_opaque, has_alpha_channel;
+        SDL_DetectPalette(fmt->palette, &is_opaque, &has_alpha_channel);
+        if (!is_opaque) {
+            needAlpha = SDL_TRUE;
+        }
+    }
+
+    /* Try to have the best pixel format for the texture */
+    /* No alpha, but a colorkey => promote to alpha */
+    if (!fmt->Amask && SDL_HasColorKey(surface)) {
+        if (fmt->format == SDL_PIXELFORMAT_RGB888) {
+            for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
+                if (renderer->info.texture_formats[i] == SDL_PIXELFORMAT_ARGB8888) {
+                    format = SDL_PIXELFORMAT_ARGB8888;
+                    break;
+                }
+            }
+        } else if (fmt->format == SDL_PIXELFORMAT_BGR888) {
+            for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
+                if (renderer->info.texture_formats[i] == SDL_PIXELFORMAT_ABGR8888) {
+                    format = SDL_PIXELFORMAT_ABGR8888;
+                    break;
+                }
+            }
+        }
+    } else {
+        /* Exact match would be fine */
+        for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
+            if (renderer->info.texture_formats[i] == fmt->format) {
+                format = fmt->format;
+                break;
+            }
+        }
+    }
+
+    /* Fallback, choose a valid pixel format */
+    if (format == SDL_PIXELFORMAT_UNKNOWN) {
+        format = renderer->info.texture_formats[0];
+        for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
+            if (!SDL_ISPIXELFORMAT_FOURCC(renderer->info.texture_formats[i]) &&
+                SDL_ISPIXELFORMAT_ALPHA(renderer->info.texture_formats[i]) == needAlpha) {
+                format = renderer->info.texture_formats[i];
+                break;
+            }
+        }
+    }
+
+    texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC,
+                                surface->w, surface->h);
+    if (!texture) {
+        return NULL;
+    }
+
+    if (format == surface->format->format) {
+        if (surface->format->Amask && SDL_HasColorKey(surface)) {
+            /* Surface and Renderer formats are identicals.
+             * Intermediate conversion is needed to convert color key to alpha (SDL_ConvertColorkeyToAlpha()). */
+            direct_update = SDL_FALSE;
+        } else {
+            /* Update Texture directly */
+            direct_update = SDL_TRUE;
+        }
+    } else {
+        /* Surface and Renderer formats are differents, it needs an intermediate conversion. */
+        direct_update = SDL_FALSE;
+    }
+
+    if (direct_update) {
+        if (SDL_MUSTLOCK(surface)) {
+            SDL_LockSurface(surface);
+            SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+            SDL_UnlockSurface(surface);
+        } else {
+            SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+        }
+
+#if SDL_VIDEO_RENDER_DIRECTFB
+        /* DirectFB allows palette format for textures.
+         * Copy SDL_Surface palette to the texture */
+        if (SDL_ISPIXELFORMAT_INDEXED(format)) {
+            if (SDL_strcasecmp(renderer->info.name, "directfb") == 0) {
+                extern void DirectFB_SetTexturePalette(SDL_Renderer *renderer, SDL_Texture *texture, SDL_Palette *pal);
+                DirectFB_SetTexturePalette(renderer, texture, surface->format->palette);
+            }
+        }
+#endif
+
+    } else {
+        SDL_PixelFormat *dst_fmt;
+        SDL_Surface *temp = NULL;
+
+        /* Set up a destination surface for the texture update */
+        dst_fmt = SDL_AllocFormat(format);
+        if (!dst_fmt) {
+            SDL_DestroyTexture(texture);
+            return NULL;
+        }
+        temp = SDL_ConvertSurface(surface, dst_fmt, 0);
+        SDL_FreeFormat(dst_fmt);
+        if (temp) {
+            SDL_UpdateTexture(texture, NULL, temp->pixels, temp->pitch);
+            SDL_FreeSurface(temp);
+        } else {
+            SDL_DestroyTexture(texture);
+            return NULL;
+        }
+    }
+
+    {
+        Uint8 r, g, b, a;
+        SDL_BlendMode blendMode;
+
+        SDL_GetSurfaceColorMod(surface, &r, &g, &b);
+        SDL_SetTextureColorMod(texture, r, g, b);
+
+        SDL_GetSurfaceAlphaMod(surface, &a);
+        SDL_SetTextureAlphaMod(texture, a);
+
+        if (SDL_HasColorKey(surface)) {
+            /* We converted to a texture with alpha format */
+            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+        } else {
+            SDL_GetSurfaceBlendMode(surface, &blendMode);
+            SDL_SetTextureBlendMode(texture, blendMode);
+        }
+    }
+    return texture;
+}
+
+int SDL_QueryTexture(SDL_Texture *texture, Uint32 *format, int *access,
+                     int *w, int *h)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (format) {
+        *format = texture->format;
+    }
+    if (access) {
+        *access = texture->access;
+    }
+    if (w) {
+        *w = texture->w;
+    }
+    if (h) {
+        *h = texture->h;
+    }
+    return 0;
+}
+
+int SDL_SetTextureColorMod(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (r < 255 || g < 255 || b < 255) {
+        texture->modMode |= SDL_TEXTUREMODULATE_COLOR;
+    } else {
+        texture->modMode &= ~SDL_TEXTUREMODULATE_COLOR;
+    }
+    texture->color.r = r;
+    texture->color.g = g;
+    texture->color.b = b;
+    if (texture->native) {
+        return SDL_SetTextureColorMod(texture->native, r, g, b);
+    }
+    return 0;
+}
+
+int SDL_GetTextureColorMod(SDL_Texture *texture, Uint8 *r, Uint8 *g,
+                           Uint8 *b)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (r) {
+        *r = texture->color.r;
+    }
+    if (g) {
+        *g = texture->color.g;
+    }
+    if (b) {
+        *b = texture->color.b;
+    }
+    return 0;
+}
+
+int SDL_SetTextureAlphaMod(SDL_Texture *texture, Uint8 alpha)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (alpha < 255) {
+        texture->modMode |= SDL_TEXTUREMODULATE_ALPHA;
+    } else {
+        texture->modMode &= ~SDL_TEXTUREMODULATE_ALPHA;
+    }
+    texture->color.a = alpha;
+    if (texture->native) {
+        return SDL_SetTextureAlphaMod(texture->native, alpha);
+    }
+    return 0;
+}
+
+int SDL_GetTextureAlphaMod(SDL_Texture *texture, Uint8 *alpha)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (alpha) {
+        *alpha = texture->color.a;
+    }
+    return 0;
+}
+
+int SDL_SetTextureBlendMode(SDL_Texture *texture, SDL_BlendMode blendMode)
+{
+    SDL_Renderer *renderer;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    renderer = texture->renderer;
+    if (!IsSupportedBlendMode(renderer, blendMode)) {
+        return SDL_Unsupported();
+    }
+    texture->blendMode = blendMode;
+    if (texture->native) {
+        return SDL_SetTextureBlendMode(texture->native, blendMode);
+    }
+    return 0;
+}
+
+int SDL_GetTextureBlendMode(SDL_Texture *texture, SDL_BlendMode *blendMode)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (blendMode) {
+        *blendMode = texture->blendMode;
+    }
+    return 0;
+}
+
+int SDL_SetTextureScaleMode(SDL_Texture *texture, SDL_ScaleMode scaleMode)
+{
+    SDL_Renderer *renderer;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    renderer = texture->renderer;
+    if (texture->atlas) {
+        SDL_TextureAtlas *atlas = texture->atlas;
+        const SDL_ScaleMode oldScaleMode = texture->scaleMode;
+        const SDL_Rect oldRect = texture->atlas_rect;
+
+        if (scaleMode == atlas->texture->scaleMode) {
+            return 0;
+        }
+
+        /* Move the texture to an atlas with the new scale mode */
+        texture->scaleMode = scaleMode;
+        if (AddTextureToAtlas(texture) < 0) {
+            texture->scaleMode = oldScaleMode;
+            texture->atlas = atlas;
+            texture->atlas_rect = oldRect;
+            return -1;
+        }
+        ReleaseTextureAtlas(renderer, atlas);
+        return 0;
+    }
+    texture->scaleMode = scaleMode;
+    if (texture->native) {
+        return SDL_SetTextureScaleMode(texture->native, scaleMode);
+    } else if (!texture->evicted) { /* evicted textures get it when they're restored */
+        WaitRenderThread(renderer);
+        renderer->SetTextureScaleMode(renderer, texture, scaleMode);
+    }
+    return 0;
+}
+
+int SDL_GetTextureScaleMode(SDL_Texture *texture, SDL_ScaleMode *scaleMode)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (scaleMode) {
+        *scaleMode = texture->scaleMode;
+    }
+    return 0;
+}
+
+int SDL_SetTextureUserData(SDL_Texture *texture, void *userdata)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    texture->userdata = userdata;
+    return 0;
+}
+
+int SDL_SetTextureRestorable(SDL_Texture *texture, SDL_bool restorable)
+{
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (texture->native) {
+        return SDL_SetTextureRestorable(texture->native, restorable);
+    }
+    if (texture->access != SDL_TEXTUREACCESS_STATIC || SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        return SDL_SetError("Only static RGB textures can be restorable");
+    }
+    if (texture->atlas) {
+        return 0; /* the atlas is never evicted */
+    }
+
+    if (restorable) {
+        if (!texture->shadow) {
+            texture->shadow = SDL_calloc(texture->h, (size_t)texture->w * SDL_BYTESPERPIXEL(texture->format));
+            if (!texture->shadow) {
+                return SDL_OutOfMemory();
+            }
+        }
+    } else if (texture->shadow) {
+        if (texture->evicted && RestoreTexture(texture) < 0) {
+            return -1;
+        }
+        SDL_free(texture->shadow);
+        texture->shadow = NULL;
+    }
+    return 0;
+}
+
+void *SDL_GetTextureUserData(SDL_Texture *texture)
+{
+    CHECK_TEXTURE_MAGIC(texture, NULL);
+
+    return texture->userdata;
+}
+
+#if SDL_HAVE_YUV
+static int SDL_UpdateTextureYUV(SDL_Texture *texture, const SDL_Rect *rect,
+                                const void *pixels, int pitch)
+{
+    SDL_Texture *native = texture->native;
+    SDL_Rect full_rect;
+
+    if (SDL_SW_UpdateYUVTexture(texture->yuv, rect, pixels, pitch) < 0) {
+        return -1;
+    }
+
+    full_rect.x = 0;
+    full_rect.y = 0;
+    full_rect.w = texture->w;
+    full_rect.h = texture->h;
+    rect = &full_rect;
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        /* We can lock the texture and copy to it */
+        void *native_pixels = NULL;
+        int native_pitch = 0;
+
+        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
+            return -1;
+        }
+        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                            rect->w, rect->h, native_pixels, native_pitch);
+        SDL_UnlockTexture(native);
+    } else {
+        /* Use a temporary buffer for updating */
+        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
+        const size_t alloclen = (size_t)rect->h * temp_pitch;
+        if (alloclen > 0) {
+            void *temp_pixels = SDL_malloc(alloclen);
+            if (!temp_pixels) {
+                return SDL_OutOfMemory();
+            }
+            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                                rect->w, rect->h, temp_pixels, temp_pitch);
+            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
+            SDL_free(temp_pixels);
+        }
+    }
+    return 0;
+}
+#endif /* SDL_HAVE_YUV */
+
+/* Keep the shadow copy of a restorable texture up to date */
+static void UpdateTextureShadow(SDL_Texture *texture, const SDL_Rect *rect,
+                                const void *pixels, int pitch)
+{
+    const size_t bpp = SDL_BYTESPERPIXEL(texture->format);
+    const size_t shadow_pitch = (size_t)texture->w * bpp;
+    const size_t length = (size_t)rect->w * bpp;
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst = (Uint8 *)texture->shadow + rect->y * shadow_pitch + rect->x * bpp;
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        src += pitch;
+        dst += shadow_pitch;
+    }
+}
+
+static int SDL_UpdateTextureNative(SDL_Texture *texture, const SDL_Rect *rect,
+                                   const void *pixels, int pitch)
+{
+    SDL_Texture *native = texture->native;
+
+    if (!rect->w || !rect->h) {
+        return 0; /* nothing to do. */
+    }
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        /* We can lock the texture and copy to it */
+        void *native_pixels = NULL;
+        int native_pitch = 0;
+
+        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
+            return -1;
+        }
+        SDL_ConvertPixels(rect->w, rect->h,
+                          texture->format, pixels, pitch,
+                          native->format, native_pixels, native_pitch);
+        SDL_UnlockTexture(native);
+    } else {
+        /* Use a temporary buffer for updating */
+        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
+        const size_t alloclen = (size_t)rect->h * temp_pitch;
+        if (alloclen > 0) {
+            void *temp_pixels = SDL_malloc(alloclen);
+            if (!temp_pixels) {
+                return SDL_OutOfMemory();
+            }
+            SDL_ConvertPixels(rect->w, rect->h,
+                              texture->format, pixels, pitch,
+                              native->format, temp_pixels, temp_pitch);
+            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
+            SDL_free(temp_pixels);
+        }
+    }
+    return 0;
+}
+
+int SDL_UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                      const void *pixels, int pitch)
+{
+    SDL_Rect real_rect;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (!pixels) {
+        return SDL_InvalidParamError("pixels");
+    }
+    if (!pitch) {
+        return SDL_InvalidParamError("pitch");
+    }
+
+    real_rect.x = 0;
+    real_rect.y = 0;
+    real_rect.w = texture->w;
+    real_rect.h = texture->h;
+    if (rect) {
+        if (!SDL_IntersectRect(rect, &real_rect, &real_rect)) {
+            return 0;
+        }
+    }
+
+    if (real_rect.w == 0 || real_rect.h == 0) {
+        return 0; /* nothing to do. */
+#if SDL_HAVE_YUV
+    } else if (texture->yuv) {
+        return SDL_UpdateTextureYUV(texture, &real_rect, pixels, pitch);
+#endif
+    } else if (texture->native) {
+        return SDL_UpdateTextureNative(texture, &real_rect, pixels, pitch);
+    } else if (texture->atlas) {
+        return SDL_UpdateTextureAtlas(texture, &real_rect, pixels, pitch);
+    } else {
+        SDL_Renderer *renderer = texture->renderer;
+        if (texture->shadow) {
+            UpdateTextureShadow(texture, &real_rect, pixels, pitch);
+            if (texture->evicted) {
+                return 0; /* it's uploaded from the shadow when it's used again */
+            }
+        }
+        CountTextureUpload(texture, &real_rect);
+        if (CanQueueTextureUpdate(texture, &real_rect)) {
+            return QueueCmdUpdateTexture(renderer, texture, &real_rect, pixels, pitch);
+        }
+        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+            return -1;
+        }
+        return renderer->UpdateTexture(renderer, texture, &real_rect, pixels, pitch);
+    }
+}
+
+#if SDL_HAVE_YUV
+static int SDL_UpdateTextureYUVPlanar(SDL_Texture *texture, const SDL_Rect *rect,
+                                      const Uint8 *Yplane, int Ypitch,
+                                      const Uint8 *Uplane, int Upitch,
+                                      const Uint8 *Vplane, int Vpitch)
+{
+    SDL_Texture *native = texture->native;
+    SDL_Rect full_rect;
+
+    if (SDL_SW_UpdateYUVTexturePlanar(texture->yuv, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch) < 0) {
+        return -1;
+    }
+
+    full_rect.x = 0;
+    full_rect.y = 0;
+    full_rect.w = texture->w;
+    full_rect.h = texture->h;
+    rect = &full_rect;
+
+    if (!rect->w || !rect->h) {
+        return 0; /* nothing to do. */
+    }
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        /* We can lock the texture and copy to it */
+        void *native_pixels = NULL;
+        int native_pitch = 0;
+
+        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
+            return -1;
+        }
+        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                            rect->w, rect->h, native_pixels, native_pitch);
+        SDL_UnlockTexture(native);
+    } else {
+        /* Use a temporary buffer for updating */
+        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
+        const size_t alloclen = (size_t)rect->h * temp_pitch;
+        if (alloclen > 0) {
+            void *temp_pixels = SDL_malloc(alloclen);
+            if (!temp_pixels) {
+                return SDL_OutOfMemory();
+            }
+            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                                rect->w, rect->h, temp_pixels, temp_pitch);
+            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
+            SDL_free(temp_pixels);
+        }
+    }
+    return 0;
+}
+
+static int SDL_UpdateTextureNVPlanar(SDL_Texture *texture, const SDL_Rect *rect,
+                                     const Uint8 *Yplane, int Ypitch,
+                                     const Uint8 *UVplane, int UVpitch)
+{
+    SDL_Texture *native = texture->native;
+    SDL_Rect full_rect;
+
+    if (SDL_SW_UpdateNVTexturePlanar(texture->yuv, rect, Yplane, Ypitch, UVplane, UVpitch) < 0) {
+        return -1;
+    }
+
+    full_rect.x = 0;
+    full_rect.y = 0;
+    full_rect.w = texture->w;
+    full_rect.h = texture->h;
+    rect = &full_rect;
+
+    if (!rect->w || !rect->h) {
+        return 0; /* nothing to do. */
+    }
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        /* We can lock the texture and copy to it */
+        void *native_pixels = NULL;
+        int native_pitch = 0;
+
+        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
+            return -1;
+        }
+        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                            rect->w, rect->h, native_pixels, native_pitch);
+        SDL_UnlockTexture(native);
+    } else {
+        /* Use a temporary buffer for updating */
+        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
+        const size_t alloclen = (size_t)rect->h * temp_pitch;
+        if (alloclen > 0) {
+            void *temp_pixels = SDL_malloc(alloclen);
+            if (!temp_pixels) {
+                return SDL_OutOfMemory();
+            }
+            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
+                                rect->w, rect->h, temp_pixels, temp_pitch);
+            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
+            SDL_free(temp_pixels);
+        }
+    }
+    return 0;
+}
+
+#endif /* SDL_HAVE_YUV */
+
+int SDL_UpdateYUVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                         const Uint8 *Yplane, int Ypitch,
+                         const Uint8 *Uplane, int Upitch,
+                         const Uint8 *Vplane, int Vpitch)
+{
+#if SDL_HAVE_YUV
+    SDL_Renderer *renderer;
+    SDL_Rect real_rect;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (!Yplane) {
+        return SDL_InvalidParamError("Yplane");
+    }
+    if (!Ypitch) {
+        return SDL_InvalidParamError("Ypitch");
+    }
+    if (!Uplane) {
+        return SDL_InvalidParamError("Uplane");
+    }
+    if (!Upitch) {
+        return SDL_InvalidParamError("Upitch");
+    }
+    if (!Vplane) {
+        return SDL_InvalidParamError("Vplane");
+    }
+    if (!Vpitch) {
+        return SDL_InvalidParamError("Vpitch");
+    }
+
+    if (texture->format != SDL_PIXELFORMAT_YV12 &&
+        texture->format != SDL_PIXELFORMAT_IYUV) {
+        return SDL_SetError("Texture format must by YV12 or IYUV");
+    }
+
+    real_rect.x = 0;
+    real_rect.y = 0;
+    real_rect.w = texture->w;
+    real_rect.h = texture->h;
+    if (rect) {
+        SDL_IntersectRect(rect, &real_rect, &real_rect);
+    }
+
+    if (real_rect.w == 0 || real_rect.h == 0) {
+        return 0; /* nothing to do. */
+    }
+
+    if (texture->yuv) {
+        return SDL_UpdateTextureYUVPlanar(texture, &real_rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+    } else {
+        SDL_assert(!texture->native);
+        renderer = texture->renderer;
+        SDL_assert(renderer->UpdateTextureYUV);
+        if (renderer->UpdateTextureYUV) {
+            if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+                return -1;
+            }
+            CountTextureUpload(texture, &real_rect);
+            return renderer->UpdateTextureYUV(renderer, texture, &real_rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
+        } else {
+            return SDL_Unsupported();
+        }
+    }
+#else
+    return -1;
+#endif
+}
+
+int SDL_UpdateNVTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                        const Uint8 *Yplane, int Ypitch,
+                        const Uint8 *UVplane, int UVpitch)
+{
+#if SDL_HAVE_YUV
+    SDL_Renderer *renderer;
+    SDL_Rect real_rect;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (!Yplane) {
+        return SDL_InvalidParamError("Yplane");
     }
-    if (SDL_ISPIXELFORMAT_INDEXED(format)) {
-        if (!IsSupportedFormat(renderer, format)) {
-            SDL_SetError("Palettized textures are not supported");
-            return NULL;
-        }
+    if (!Ypitch) {
+        return SDL_InvalidParamError("Ypitch");
     }
-    if (w <= 0 || h <= 0) {
-        SDL_SetError("Texture dimensions can't be 0");
-        return NULL;
+    if (!UVplane) {
+        return SDL_InvalidParamError("UVplane");
     }
-    if ((renderer->info.max_texture_width && w > renderer->info.max_texture_width) ||
-        (renderer->info.max_texture_height && h > renderer->info.max_texture_height)) {
-        SDL_SetError("Texture dimensions are limited to %dx%d", renderer->info.max_texture_width, renderer->info.max_texture_height);
-        return NULL;
+    if (!UVpitch) {
+        return SDL_InvalidParamError("UVpitch");
     }
-    texture = (SDL_Texture *)SDL_calloc(1, sizeof(*texture));
-    if (!texture) {
-        SDL_OutOfMemory();
-        return NULL;
+
+    if (texture->format != SDL_PIXELFORMAT_NV12 &&
+        texture->format != SDL_PIXELFORMAT_NV21) {
+        return SDL_SetError("Texture format must by NV12 or NV21");
     }
-    texture->magic = &texture_magic;
-    texture->format = format;
-    texture->access = access;
-    texture->w = w;
-    texture->h = h;
-    texture->color.r = 255;
-    texture->color.g = 255;
-    texture->color.b = 255;
-    texture->color.a = 255;
-    texture->scaleMode = SDL_GetScaleMode();
-    texture->renderer = renderer;
-    texture->next = renderer->textures;
-    if (renderer->textures) {
-        renderer->textures->prev = texture;
+
+    real_rect.x = 0;
+    real_rect.y = 0;
+    real_rect.w = texture->w;
+    real_rect.h = texture->h;
+    if (rect) {
+        SDL_IntersectRect(rect, &real_rect, &real_rect);
     }
-    renderer->textures = texture;
 
-    /* FOURCC format cannot be used directly by renderer back-ends for target texture */
-    texture_is_fourcc_and_target = (access == SDL_TEXTUREACCESS_TARGET && SDL_ISPIXELFORMAT_FOURCC(texture->format));
+    if (real_rect.w == 0 || real_rect.h == 0) {
+        return 0; /* nothing to do. */
+    }
 
-    if (texture_is_fourcc_and_target == SDL_FALSE && IsSupportedFormat(renderer, format)) {
-        if (renderer->CreateTexture(renderer, texture) < 0) {
-            SDL_DestroyTexture(texture);
-            return NULL;
-        }
+    if (texture->yuv) {
+        return SDL_UpdateTextureNVPlanar(texture, &real_rect, Yplane, Ypitch, UVplane, UVpitch);
     } else {
-        int closest_format;
-
-        if (texture_is_fourcc_and_target == SDL_FALSE) {
-            closest_format = GetClosestSupportedFormat(renderer, format);
+        SDL_assert(!texture->native);
+        renderer = texture->renderer;
+        SDL_assert(renderer->UpdateTextureNV);
+        if (renderer->UpdateTextureNV) {
+            if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+                return -1;
+            }
+            CountTextureUpload(texture, &real_rect);
+            return renderer->UpdateTextureNV(renderer, texture, &real_rect, Yplane, Ypitch, UVplane, UVpitch);
         } else {
-            closest_format = renderer->info.texture_formats[0];
+            return SDL_Unsupported();
         }
+    }
+#else
+    return -1;
+#endif
+}
 
-        texture->native = SDL_CreateTexture(renderer, closest_format, access, w, h);
-        if (!texture->native) {
-            SDL_DestroyTexture(texture);
-            return NULL;
-        }
+#if SDL_HAVE_YUV
+static int SDL_LockTextureYUV(SDL_Texture *texture, const SDL_Rect *rect,
+                              void **pixels, int *pitch)
+{
+    return SDL_SW_LockYUVTexture(texture->yuv, rect, pixels, pitch);
+}
+#endif /* SDL_HAVE_YUV */
 
-        /* Swap textures to have texture before texture->native in the list */
-        texture->native->next = texture->next;
-        if (texture->native->next) {
-            texture->native->next->prev = texture->native;
+static int SDL_LockTextureNative(SDL_Texture *texture, const SDL_Rect *rect,
+                                 void **pixels, int *pitch)
+{
+    texture->locked_rect = *rect;
+    *pixels = (void *)((Uint8 *)texture->pixels +
+                       rect->y * texture->pitch +
+                       rect->x * SDL_BYTESPERPIXEL(texture->format));
+    *pitch = texture->pitch;
+    return 0;
+}
+
+int SDL_LockTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                    void **pixels, int *pitch)
+{
+    SDL_Rect full_rect;
+
+    CHECK_TEXTURE_MAGIC(texture, -1);
+
+    if (texture->access != SDL_TEXTUREACCESS_STREAMING) {
+        return SDL_SetError("SDL_LockTexture(): texture must be streaming");
+    }
+
+    if (!rect) {
+        full_rect.x = 0;
+        full_rect.y = 0;
+        full_rect.w = texture->w;
+        full_rect.h = texture->h;
+        rect = &full_rect;
+    }
+
+#if SDL_HAVE_YUV
+    if (texture->yuv) {
+        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+            return -1;
         }
-        texture->prev = texture->native->prev;
-        if (texture->prev) {
-            texture->prev->next = texture;
+        return SDL_LockTextureYUV(texture, rect, pixels, pitch);
+    } else
+#endif
+        if (texture->native) {
+        /* Calls a real SDL_LockTexture/SDL_UnlockTexture on unlock, flushing then. */
+        return SDL_LockTextureNative(texture, rect, pixels, pitch);
+    } else {
+        SDL_Renderer *renderer = texture->renderer;
+        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
+            return -1;
         }
-        texture->native->prev = texture;
-        texture->next = texture->native;
-        renderer->textures = texture;
+        texture->locked_rect = *rect;
+        return renderer->LockTexture(renderer, texture, rect, pixels, pitch);
+    }
+}
+
+int SDL_LockTextureToSurface(SDL_Texture *texture, const SDL_Rect *rect,
+                             SDL_Surface **surface)
+{
+    SDL_Rect real_rect;
+    void *pixels = NULL;
+    int pitch = 0; /* fix static analysis */
+    int ret;
+
+    if (!texture || !surface) {
+        return -1;
+    }
+
+    real_rect.x = 0;
+    real_rect.y = 0;
+    real_rect.w = texture->w;
+    real_rect.h = texture->h;
+    if (rect) {
+        SDL_IntersectRect(rect, &real_rect, &real_rect);
+    }
+
+    ret = SDL_LockTexture(texture, &real_rect, &pixels, &pitch);
+    if (ret < 0) {
+        return ret;
+    }
+
+    texture->locked_surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, real_rect.w, real_rect.h, 0, pitch, texture->format);
+    if (!texture->locked_surface) {
+        SDL_UnlockTexture(texture);
+        return -1;
+    }
+
+    *surface = texture->locked_surface;
+    return 0;
+}
 
-        if (SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
 #if SDL_HAVE_YUV
-            texture->yuv = SDL_SW_CreateYUVTexture(format, w, h);
-#else
-            SDL_SetError("SDL not built with YUV support");
+static void SDL_UnlockTextureYUV(SDL_Texture *texture)
+{
+    SDL_Texture *native = texture->native;
+    void *native_pixels = NULL;
+    int native_pitch = 0;
+    SDL_Rect rect;
+
+    rect.x = 0;
+    rect.y = 0;
+    rect.w = texture->w;
+    rect.h = texture->h;
+
+    if (SDL_LockTexture(native, &rect, &native_pixels, &native_pitch) < 0) {
+        return;
+    }
+    SDL_SW_CopyYUVToRGB(texture->yuv, &rect, native->format,
+                        rect.w, rect.h, native_pixels, native_pitch);
+    SDL_UnlockTexture(native);
+}
+#endif /* SDL_HAVE_YUV */
+
+static void SDL_UnlockTextureNative(SDL_Texture *texture)
+{
+    SDL_Texture *native = texture->native;
+    void *native_pixels = NULL;
+    int native_pitch = 0;
+    const SDL_Rect *rect = &texture->locked_rect;
+    const void *pixels = (void *)((Uint8 *)texture->pixels +
+                                  rect->y * texture->pitch +
+                                  rect->x * SDL_BYTESPERPIXEL(texture->format));
+    int pitch = texture->pitch;
+
+    if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
+        return;
+    }
+    SDL_ConvertPixels(rect->w, rect->h,
+                      texture->format, pixels, pitch,
+                      native->format, native_pixels, native_pitch);
+    SDL_UnlockTexture(native);
+}
+
+void SDL_UnlockTexture(SDL_Texture *texture)
+{
+    CHECK_TEXTURE_MAGIC(texture, );
+
+    if (texture->access != SDL_TEXTUREACCESS_STREAMING) {
+        return;
+    }
+#if SDL_HAVE_YUV
+    if (texture->yuv) {
+        SDL_UnlockTextureYUV(texture);
+    } else
 #endif
-            if (!texture->yuv) {
-                SDL_DestroyTexture(texture);
-                return NULL;
-            }
-        } else if (access == SDL_TEXTUREACCESS_STREAMING) {
-            /* The pitch is 4 byte aligned */
-            texture->pitch = (((w * SDL_BYTESPERPIXEL(format)) + 3) & ~3);
-            texture->pixels = SDL_calloc(1, (size_t)texture->pitch * h);
-            if (!texture->pixels) {
-                SDL_DestroyTexture(texture);
-                return NULL;
-            }
-        }
+        if (texture->native) {
+        SDL_UnlockTextureNative(texture);
+    } else {
+        SDL_Renderer *renderer = texture->renderer;
+        WaitRenderThread(renderer);
+        CountTextureUpload(texture, &texture->locked_rect);
+        renderer->UnlockTexture(renderer, texture);
     }
-    return texture;
+
+    SDL_FreeSurface(texture->locked_surface);
+    texture->locked_surface = NULL;
 }
 
-SDL_Texture *SDL_CreateTextureFromSurface(SDL_Renderer *renderer, SDL_Surface *surface)
+SDL_bool SDL_RenderTargetSupported(SDL_Renderer *renderer)
 {
-    const SDL_PixelFormat *fmt;
-    SDL_bool needAlpha;
-    SDL_bool direct_update;
-    int i;
-    Uint32 format = SDL_PIXELFORMAT_UNKNOWN;
-    SDL_Texture *texture;
-
-    CHECK_RENDERER_MAGIC(renderer, NULL);
+    if (!renderer || !renderer->SetRenderTarget) {
+        return SDL_FALSE;
+    }
+    return (renderer->info.flags & SDL_RENDERER_TARGETTEXTURE) != 0;
+}
 
-    if (!surface) {
-        SDL_InvalidParamError("SDL_CreateTextureFromSurface(): surface");
-        return NULL;
+int SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    if (!SDL_RenderTargetSupported(renderer)) {
+        return SDL_Unsupported();
     }
 
-    /* See what the best texture format is */
-    fmt = surface->format;
-    if (fmt->Amask || SDL_HasColorKey(surface)) {
-        needAlpha = SDL_TRUE;
-    } else {
-        needAlpha = SDL_FALSE;
+    if (renderer->recording_command_list) {
+        return SDL_SetError("Can't change the render target while recording a command list");
     }
 
-    /* If Palette contains alpha values, promotes to alpha format */
-    if (fmt->palette) {
-        SDL_bool is_opaque, has_alpha_channel;
-        SDL_DetectPalette(fmt->palette, &is_opaque, &has_alpha_channel);
-        if (!is_opaque) {
-            needAlpha = SDL_TRUE;
+    /* texture == NULL is valid and means reset the target to the window */
+    if (texture) {
+        CHECK_TEXTURE_MAGIC(texture, -1);
+        if (renderer != texture->renderer) {
+            return SDL_SetError("Texture was not created with this renderer");
+        }
+        if (texture->access != SDL_TEXTUREACCESS_TARGET) {
+            return SDL_SetError("Texture not created with SDL_TEXTUREACCESS_TARGET");
+        }
+        if (texture->native) {
+            /* Always render to the native texture */
+            texture = texture->native;
         }
     }
 
-    /* Try to have the best pixel format for the texture */
-    /* No alpha, but a colorkey => promote to alpha */
-    if (!fmt->Amask && SDL_HasColorKey(surface)) {
-        if (fmt->format == SDL_PIXELFORMAT_RGB888) {
-            for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
-                if (renderer->info.texture_formats[i] == SDL_PIXELFORMAT_ARGB8888) {
-                    format = SDL_PIXELFORMAT_ARGB8888;
-                    break;
-                }
-            }
-        } else if (fmt->format == SDL_PIXELFORMAT_BGR888) {
-            for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
-                if (renderer->info.texture_formats[i] == SDL_PIXELFORMAT_ABGR8888) {
-                    format = SDL_PIXELFORMAT_ABGR8888;
-                    break;
-                }
-            }
-        }
+    if (texture == renderer->target) {
+        /* Nothing to do! */
+        return 0;
+    }
+
+    FlushRenderCommandsWithReason(renderer, &renderer->stats.target_flushes); /* time to send everything to the GPU! */
+
+    SDL_LockMutex(renderer->target_mutex);
+
+    if (texture && !renderer->target) {
+        /* Make a backup of the viewport */
+        renderer->viewport_backup = renderer->viewport;
+        renderer->clip_rect_backup = renderer->clip_rect;
+        renderer->clipping_enabled_backup = renderer->clipping_enabled;
+        renderer->scale_backup = renderer->scale;
+        renderer->logical_w_backup = renderer->logical_w;
+        renderer->logical_h_backup = renderer->logical_h;
+    }
+    renderer->target = texture;
+
+    if (renderer->SetRenderTarget(renderer, texture) < 0) {
+        SDL_UnlockMutex(renderer->target_mutex);
+        return -1;
+    }
+
+    if (texture) {
+        renderer->viewport.x = (double)0;
+        renderer->viewport.y = (double)0;
+        renderer->viewport.w = (double)texture->w;
+        renderer->viewport.h = (double)texture->h;
+        SDL_zero(renderer->clip_rect);
+        renderer->clipping_enabled = SDL_FALSE;
+        renderer->scale.x = 1.0f;
+        renderer->scale.y = 1.0f;
+        renderer->logical_w = texture->w;
+        renderer->logical_h = texture->h;
     } else {
-        /* Exact match would be fine */
-        for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
-            if (renderer->info.texture_formats[i] == fmt->format) {
-                format = fmt->format;
-                break;
-            }
-        }
+        renderer->viewport = renderer->viewport_backup;
+        renderer->clip_rect = renderer->clip_rect_backup;
+        renderer->clipping_enabled = renderer->clipping_enabled_backup;
+        renderer->scale = renderer->scale_backup;
+        renderer->logical_w = renderer->logical_w_backup;
+        renderer->logical_h = renderer->logical_h_backup;
     }
 
-    /* Fallback, choose a valid pixel format */
-    if (format == SDL_PIXELFORMAT_UNKNOWN) {
-        format = renderer->info.texture_formats[0];
-        for (i = 0; i < (int)renderer->info.num_texture_formats; ++i) {
-            if (!SDL_ISPIXELFORMAT_FOURCC(renderer->info.texture_formats[i]) &&
-                SDL_ISPIXELFORMAT_ALPHA(renderer->info.texture_formats[i]) == needAlpha) {
-                format = renderer->info.texture_formats[i];
-                break;
-            }
-        }
+    SDL_UnlockMutex(renderer->target_mutex);
+
+    if (QueueCmdSetViewport(renderer) < 0) {
+        return -1;
+    }
+    if (QueueCmdSetClipRect(renderer) < 0) {
+        return -1;
     }
 
-    texture = SDL_CreateTexture(renderer, format, SDL_TEXTUREACCESS_STATIC,
-                                surface->w, surface->h);
-    if (!texture) {
-        return NULL;
+    /* All set! */
+    return FlushRenderCommandsIfNotBatching(renderer);
+}
+
+SDL_Texture *SDL_GetRenderTarget(SDL_Renderer *renderer)
+{
+    CHECK_RENDERER_MAGIC(renderer, NULL);
+
+    return renderer->target;
+}
+
+static int UpdateLogicalSize(SDL_Renderer *renderer, SDL_bool flush_viewport_cmd)
+{
+    int w = 1, h = 1;
+    float want_aspect;
+    float real_aspect;
+    float scale;
+    SDL_Rect viewport;
+    /* 0 is for letterbox, 1 is for overscan */
+    int scale_policy = 0;
+    const char *hint;
+
+    if (!renderer->logical_w || !renderer->logical_h) {
+        return 0;
+    }
+    if (SDL_GetRendererOutputSize(renderer, &w, &h) < 0) {
+        return -1;
     }
 
-    if (format == surface->format->format) {
-        if (surface->format->Amask && SDL_HasColorKey(surface)) {
-            /* Surface and Renderer formats are identicals.
-             * Intermediate conversion is needed to convert color key to alpha (SDL_ConvertColorkeyToAlpha()). */
-            direct_update = SDL_FALSE;
-        } else {
-            /* Update Texture directly */
-            direct_update = SDL_TRUE;
+    hint = SDL_GetHint(SDL_HINT_RENDER_LOGICAL_SIZE_MODE);
+    if (hint && (*hint == '1' || SDL_strcasecmp(hint, "overscan") == 0)) {
+#if SDL_VIDEO_RENDER_D3D
+        SDL_bool overscan_supported = SDL_TRUE;
+        /* Unfortunately, Direct3D 9 doesn't support negative viewport numbers
+           which the overscan implementation relies on.
+        */
+        if (SDL_strcasecmp(SDL_GetCurrentVideoDriver(), "direct3d") == 0) {
+            overscan_supported = SDL_FALSE;
         }
-    } else {
-        /* Surface and Renderer formats are differents, it needs an intermediate conversion. */
-        direct_update = SDL_FALSE;
+        if (overscan_supported) {
+            scale_policy = 1;
+        }
+#else
+        scale_policy = 1;
+#endif
     }
 
-    if (direct_update) {
-        if (SDL_MUSTLOCK(surface)) {
-            SDL_LockSurface(surface);
-            SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
-            SDL_UnlockSurface(surface);
+    want_aspect = (float)renderer->logical_w / renderer->logical_h;
+    real_aspect = (float)w / h;
+
+    /* Clear the scale because we're setting viewport in output coordinates */
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+
+    if (renderer->integer_scale) {
+        if (want_aspect > real_aspect) {
+            scale = (float)(w / renderer->logical_w); /* This an integer division! */
         } else {
-            SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch);
+            scale = (float)(h / renderer->logical_h); /* This an integer division! */
         }
 
-#if SDL_VIDEO_RENDER_DIRECTFB
-        /* DirectFB allows palette format for textures.
-         * Copy SDL_Surface palette to the texture */
-        if (SDL_ISPIXELFORMAT_INDEXED(format)) {
-            if (SDL_strcasecmp(renderer->info.name, "directfb") == 0) {
-                extern void DirectFB_SetTexturePalette(SDL_Renderer *renderer, SDL_Texture *texture, SDL_Palette *pal);
-                DirectFB_SetTexturePalette(renderer, texture, surface->format->palette);
-            }
+        if (scale < 1.0f) {
+            scale = 1.0f;
         }
-#endif
 
-    } else {
-        SDL_PixelFormat *dst_fmt;
-        SDL_Surface *temp = NULL;
+        viewport.w = (int)SDL_floor(renderer->logical_w * scale);
+        viewport.x = (w - viewport.w) / 2;
+        viewport.h = (int)SDL_floor(renderer->logical_h * scale);
+        viewport.y = (h - viewport.h) / 2;
+    } else if (SDL_fabs(want_aspect - real_aspect) < 0.0001) {
+        /* The aspect ratios are the same, just scale appropriately */
+        scale = (float)w / renderer->logical_w;
 
-        /* Set up a destination surface for the texture update */
-        dst_fmt = SDL_AllocFormat(format);
-        if (!dst_fmt) {
-            SDL_DestroyTexture(texture);
-            return NULL;
-        }
-        temp = SDL_ConvertSurface(surface, dst_fmt, 0);
-        SDL_FreeFormat(dst_fmt);
-        if (temp) {
-            SDL_UpdateTexture(texture, NULL, temp->pixels, temp->pitch);
-            SDL_FreeSurface(temp);
+        SDL_zero(viewport);
+        SDL_GetRendererOutputSize(renderer, &viewport.w, &viewport.h);
+    } else if (want_aspect > real_aspect) {
+        if (scale_policy == 1) {
+            /* We want a wider aspect ratio than is available -
+             zoom so logical height matches the real height
+             and the width will grow off the screen
+             */
+            scale = (float)h / renderer->logical_h;
+            viewport.y = 0;
+            viewport.h = h;
+            viewport.w = (int)SDL_floor(renderer->logical_w * scale);
+            viewport.x = (w - viewport.w) / 2;
         } else {
-            SDL_DestroyTexture(texture);
-            return NULL;
+            /* We want a wider aspect ratio than is available - letterbox it */
+            scale = (float)w / renderer->logical_w;
+            viewport.x = 0;
+            viewport.w = w;
+            viewport.h = (int)SDL_floor(renderer->logical_h * scale);
+            viewport.y = (h - viewport.h) / 2;
         }
-    }
-
-    {
-        Uint8 r, g, b, a;
-        SDL_BlendMode blendMode;
-
-        SDL_GetSurfaceColorMod(surface, &r, &g, &b);
-        SDL_SetTextureColorMod(texture, r, g, b);
-
-        SDL_GetSurfaceAlphaMod(surface, &a);
-        SDL_SetTextureAlphaMod(texture, a);
-
-        if (SDL_HasColorKey(surface)) {
-            /* We converted to a texture with alpha format */
-            SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+    } else {
+        if (scale_policy == 1) {
+            /* We want a narrower aspect ratio than is available -
+             zoom so logical width matches the real width
+             and the height will grow off the screen
+             */
+            scale = (float)w / renderer->logical_w;
+            viewport.x = 0;
+            viewport.w = w;
+            viewport.h = (int)SDL_floor(renderer->logical_h * scale);
+            viewport.y = (h - viewport.h) / 2;
         } else {
-            SDL_GetSurfaceBlendMode(surface, &blendMode);
-            SDL_SetTextureBlendMode(texture, blendMode);
+            /* We want a narrower aspect ratio than is available - use side-bars */
+            scale = (float)h / renderer->logical_h;
+            viewport.y = 0;
+            viewport.h = h;
+            viewport.w = (int)SDL_floor(renderer->logical_w * scale);
+            viewport.x = (w - viewport.w) / 2;
         }
     }
-    return texture;
-}
-
-int SDL_QueryTexture(SDL_Texture *texture, Uint32 *format, int *access,
-                     int *w, int *h)
-{
-    CHECK_TEXTURE_MAGIC(texture, -1);
 
-    if (format) {
-        *format = texture->format;
-    }
-    if (access) {
-        *access = texture->access;
-    }
-    if (w) {
-        *w = texture->w;
-    }
-    if (h) {
-        *h = texture->h;
+    /* Set the new viewport */
+    renderer->viewport.x = (double)viewport.x * renderer->scale.x;
+    renderer->viewport.y = (double)viewport.y * renderer->scale.y;
+    renderer->viewport.w = (double)viewport.w * renderer->scale.x;
+    renderer->viewport.h = (double)viewport.h * renderer->scale.y;
+    QueueCmdSetViewport(renderer);
+    if (flush_viewport_cmd) {
+        FlushRenderCommandsIfNotBatching(renderer);
     }
-    return 0;
-}
 
-int SDL_SetTextureColorMod(SDL_Texture *texture, Uint8 r, Uint8 g, Uint8 b)
-{
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    /* Set the new scale */
+    SDL_RenderSetScale(renderer, scale, scale);
 
-    if (r < 255 || g < 255 || b < 255) {
-        texture->modMode |= SDL_TEXTUREMODULATE_COLOR;
-    } else {
-        texture->modMode &= ~SDL_TEXTUREMODULATE_COLOR;
-    }
-    texture->color.r = r;
-    texture->color.g = g;
-    texture->color.b = b;
-    if (texture->native) {
-        return SDL_SetTextureColorMod(texture->native, r, g, b);
-    }
     return 0;
 }
 
-int SDL_GetTextureColorMod(SDL_Texture *texture, Uint8 *r, Uint8 *g,
-                           Uint8 *b)
+int SDL_RenderSetLogicalSize(SDL_Renderer *renderer, int w, int h)
 {
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (r) {
-        *r = texture->color.r;
-    }
-    if (g) {
-        *g = texture->color.g;
-    }
-    if (b) {
-        *b = texture->color.b;
+    if (!w || !h) {
+        /* Clear any previous logical resolution */
+        renderer->logical_w = 0;
+        renderer->logical_h = 0;
+        SDL_RenderSetViewport(renderer, NULL);
+        SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+        return 0;
     }
-    return 0;
-}
 
-int SDL_SetTextureAlphaMod(SDL_Texture *texture, Uint8 alpha)
-{
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    renderer->logical_w = w;
+    renderer->logical_h = h;
 
-    if (alpha < 255) {
-        texture->modMode |= SDL_TEXTUREMODULATE_ALPHA;
-    } else {
-        texture->modMode &= ~SDL_TEXTUREMODULATE_ALPHA;
-    }
-    texture->color.a = alpha;
-    if (texture->native) {
-        return SDL_SetTextureAlphaMod(texture->native, alpha);
-    }
-    return 0;
+    return UpdateLogicalSize(renderer, SDL_TRUE);
 }
 
-int SDL_GetTextureAlphaMod(SDL_Texture *texture, Uint8 *alpha)
+void SDL_RenderGetLogicalSize(SDL_Renderer *renderer, int *w, int *h)
 {
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, );
 
-    if (alpha) {
-        *alpha = texture->color.a;
+    if (w) {
+        *w = renderer->logical_w;
+    }
+    if (h) {
+        *h = renderer->logical_h;
     }
-    return 0;
 }
 
-int SDL_SetTextureBlendMode(SDL_Texture *texture, SDL_BlendMode blendMode)
+int SDL_RenderSetIntegerScale(SDL_Renderer *renderer, SDL_bool enable)
 {
-    SDL_Renderer *renderer;
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    renderer->integer_scale = enable;
 
-    renderer = texture->renderer;
-    if (!IsSupportedBlendMode(renderer, blendMode)) {
-        return SDL_Unsupported();
-    }
-    texture->blendMode = blendMode;
-    if (texture->native) {
-        return SDL_SetTextureBlendMode(texture->native, blendMode);
-    }
-    return 0;
+    return UpdateLogicalSize(renderer, SDL_TRUE);
 }
 
-int SDL_GetTextureBlendMode(SDL_Texture *texture, SDL_BlendMode *blendMode)
+SDL_bool SDL_RenderGetIntegerScale(SDL_Renderer *renderer)
 {
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, SDL_FALSE);
 
-    if (blendMode) {
-        *blendMode = texture->blendMode;
-    }
-    return 0;
+    return renderer->integer_scale;
 }
 
-int SDL_SetTextureScaleMode(SDL_Texture *texture, SDL_ScaleMode scaleMode)
+int SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    SDL_Renderer *renderer;
-
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    int retval;
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    renderer = texture->renderer;
-    texture->scaleMode = scaleMode;
-    if (texture->native) {
-        return SDL_SetTextureScaleMode(texture->native, scaleMode);
+    if (rect) {
+        renderer->viewport.x = (double)rect->x * renderer->scale.x;
+        renderer->viewport.y = (double)rect->y * renderer->scale.y;
+        renderer->viewport.w = (double)rect->w * renderer->scale.x;
+        renderer->viewport.h = (double)rect->h * renderer->scale.y;
     } else {
-        renderer->SetTextureScaleMode(renderer, texture, scaleMode);
+        int w, h;
+        if (SDL_GetRendererOutputSize(renderer, &w, &h) < 0) {
+            return -1;
+        }
+        renderer->viewport.x = 0.0;
+        renderer->viewport.y = 0.0;
+        /* NOLINTBEGIN(clang-analyzer-core.uninitialized.Assign): SDL_GetRendererOutputSize cannot fail */
+        renderer->viewport.w = (double)w;
+        renderer->viewport.h = (double)h;
+        /* NOLINTEND(clang-analyzer-core.uninitialized.Assign) */
     }
-    return 0;
+    retval = QueueCmdSetViewport(renderer);
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-int SDL_GetTextureScaleMode(SDL_Texture *texture, SDL_ScaleMode *scaleMode)
+void SDL_RenderGetViewport(SDL_Renderer *renderer, SDL_Rect *rect)
 {
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, );
 
-    if (scaleMode) {
-        *scaleMode = texture->scaleMode;
+    if (rect) {
+        rect->x = (int)SDL_floor(renderer->viewport.x / renderer->scale.x);
+        rect->y = (int)SDL_floor(renderer->viewport.y / renderer->scale.y);
+        rect->w = (int)SDL_floor(renderer->viewport.w / renderer->scale.x);
+        rect->h = (int)SDL_floor(renderer->viewport.h / renderer->scale.y);
     }
-    return 0;
 }
 
-int SDL_SetTextureUserData(SDL_Texture *texture, void *userdata)
+static void RenderGetViewportSize(SDL_Renderer *renderer, SDL_FRect *rect)
 {
-    CHECK_TEXTURE_MAGIC(texture, -1);
-
-    texture->userdata = userdata;
-    return 0;
+    rect->x = 0.0f;
+    rect->y = 0.0f;
+    rect->w = (float)(renderer->viewport.w / renderer->scale.x);
+    rect->h = (float)(renderer->viewport.h / renderer->scale.y);
 }
 
-void *SDL_GetTextureUserData(SDL_Texture *texture)
+int SDL_RenderSetClipRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    CHECK_TEXTURE_MAGIC(texture, NULL);
+    int retval;
+    CHECK_RENDERER_MAGIC(renderer, -1)
 
-    return texture->userdata;
+    if (rect && rect->w >= 0 && rect->h >= 0) {
+        renderer->clipping_enabled = SDL_TRUE;
+        renderer->clip_rect.x = (double)rect->x * renderer->scale.x;
+        renderer->clip_rect.y = (double)rect->y * renderer->scale.y;
+        renderer->clip_rect.w = (double)rect->w * renderer->scale.x;
+        renderer->clip_rect.h = (double)rect->h * renderer->scale.y;
+    } else {
+        renderer->clipping_enabled = SDL_FALSE;
+        SDL_zero(renderer->clip_rect);
+    }
+
+    retval = QueueCmdSetClipRect(renderer);
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-#if SDL_HAVE_YUV
-static int SDL_UpdateTextureYUV(SDL_Texture *texture, const SDL_Rect *rect,
-                                const void *pixels, int pitch)
+void SDL_RenderGetClipRect(SDL_Renderer *renderer, SDL_Rect *rect)
 {
-    SDL_Texture *native = texture->native;
-    SDL_Rect full_rect;
+    CHECK_RENDERER_MAGIC(renderer, )
 
-    if (SDL_SW_UpdateYUVTexture(texture->yuv, rect, pixels, pitch) < 0) {
-        return -1;
+    if (rect) {
+        rect->x = (int)SDL_floor(renderer->clip_rect.x / renderer->scale.x);
+        rect->y = (int)SDL_floor(renderer->clip_rect.y / renderer->scale.y);
+        rect->w = (int)SDL_floor(renderer->clip_rect.w / renderer->scale.x);
+        rect->h = (int)SDL_floor(renderer->clip_rect.h / renderer->scale.y);
     }
+}
 
-    full_rect.x = 0;
-    full_rect.y = 0;
-    full_rect.w = texture->w;
-    full_rect.h = texture->h;
-    rect = &full_rect;
+SDL_bool SDL_RenderIsClipEnabled(SDL_Renderer *renderer)
+{
+    CHECK_RENDERER_MAGIC(renderer, SDL_FALSE)
+    return renderer->clipping_enabled;
+}
 
-    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
-        /* We can lock the texture and copy to it */
-        void *native_pixels = NULL;
-        int native_pitch = 0;
+int SDL_RenderSetScale(SDL_Renderer *renderer, float scaleX, float scaleY)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
-            return -1;
-        }
-        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                            rect->w, rect->h, native_pixels, native_pitch);
-        SDL_UnlockTexture(native);
-    } else {
-        /* Use a temporary buffer for updating */
-        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
-        const size_t alloclen = (size_t)rect->h * temp_pitch;
-        if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
-            if (!temp_pixels) {
-                return SDL_OutOfMemory();
-            }
-            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                                rect->w, rect->h, temp_pixels, temp_pitch);
-            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
-        }
-    }
+    renderer->scale.x = scaleX;
+    renderer->scale.y = scaleY;
     return 0;
 }
-#endif /* SDL_HAVE_YUV */
 
-static int SDL_UpdateTextureNative(SDL_Texture *texture, const SDL_Rect *rect,
-                                   const void *pixels, int pitch)
+void SDL_RenderGetScale(SDL_Renderer *renderer, float *scaleX, float *scaleY)
 {
-    SDL_Texture *native = texture->native;
+    CHECK_RENDERER_MAGIC(renderer, );
 
-    if (!rect->w || !rect->h) {
-        return 0; /* nothing to do. */
+    if (scaleX) {
+        *scaleX = renderer->scale.x;
+    }
+    if (scaleY) {
+        *scaleY = renderer->scale.y;
     }
+}
 
-    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
-        /* We can lock the texture and copy to it */
-        void *native_pixels = NULL;
-        int native_pitch = 0;
+void SDL_RenderWindowToLogical(SDL_Renderer *renderer, int windowX, int windowY, float *logicalX, float *logicalY)
+{
+    float window_physical_x, window_physical_y;
 
-        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
-            return -1;
-        }
-        SDL_ConvertPixels(rect->w, rect->h,
-                          texture->format, pixels, pitch,
-                          native->format, native_pixels, native_pitch);
-        SDL_UnlockTexture(native);
-    } else {
-        /* Use a temporary buffer for updating */
-        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
-        const size_t alloclen = (size_t)rect->h * temp_pitch;
-        if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
-            if (!temp_pixels) {
-                return SDL_OutOfMemory();
-            }
-            SDL_ConvertPixels(rect->w, rect->h,
-                              texture->format, pixels, pitch,
-                              native->format, temp_pixels, temp_pitch);
-            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
-        }
+    CHECK_RENDERER_MAGIC(renderer, );
+
+    window_physical_x = ((float)windowX) / renderer->dpi_scale.x;
+    window_physical_y = ((float)windowY) / renderer->dpi_scale.y;
+
+    if (logicalX) {
+        *logicalX = (float)((window_physical_x - renderer->viewport.x) / renderer->scale.x);
+    }
+    if (logicalY) {
+        *logicalY = (float)((window_physical_y - renderer->viewport.y) / renderer->scale.y);
     }
-    return 0;
 }
 
-int SDL_UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect,
-                      const void *pixels, int pitch)
+void SDL_RenderLogicalToWindow(SDL_Renderer *renderer, float logicalX, float logicalY, int *windowX, int *windowY)
 {
-    SDL_Rect real_rect;
+    float window_physical_x, window_physical_y;
 
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, );
 
-    if (!pixels) {
-        return SDL_InvalidParamError("pixels");
+    window_physical_x = (float)((logicalX * renderer->scale.x) + renderer->viewport.x);
+    window_physical_y = (float)((logicalY * renderer->scale.y) + renderer->viewport.y);
+
+    if (windowX) {
+        *windowX = (int)(window_physical_x * renderer->dpi_scale.x);
     }
-    if (!pitch) {
-        return SDL_InvalidParamError("pitch");
+    if (windowY) {
+        *windowY = (int)(window_physical_y * renderer->dpi_scale.y);
     }
+}
 
-    real_rect.x = 0;
-    real_rect.y = 0;
-    real_rect.w = texture->w;
-    real_rect.h = texture->h;
-    if (rect) {
-        if (!SDL_IntersectRect(rect, &real_rect, &real_rect)) {
-            return 0;
-        }
-    }
+int SDL_SetRenderDrawColor(SDL_Renderer *renderer,
+                           Uint8 r, Uint8 g, Uint8 b, Uint8 a)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (real_rect.w == 0 || real_rect.h == 0) {
-        return 0; /* nothing to do. */
-#if SDL_HAVE_YUV
-    } else if (texture->yuv) {
-        return SDL_UpdateTextureYUV(texture, &real_rect, pixels, pitch);
-#endif
-    } else if (texture->native) {
-        return SDL_UpdateTextureNative(texture, &real_rect, pixels, pitch);
-    } else {
-        SDL_Renderer *renderer = texture->renderer;
-        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
-            return -1;
-        }
-        return renderer->UpdateTexture(renderer, texture, &real_rect, pixels, pitch);
-    }
+    renderer->color.r = r;
+    renderer->color.g = g;
+    renderer->color.b = b;
+    renderer->color.a = a;
+    return 0;
 }
 
-#if SDL_HAVE_YUV
-static int SDL_UpdateTextureYUVPlanar(SDL_Texture *texture, const SDL_Rect *rect,
-                                      const Uint8 *Yplane, int Ypitch,
-                                      const Uint8 *Uplane, int Upitch,
-                                      const Uint8 *Vplane, int Vpitch)
+int SDL_GetRenderDrawColor(SDL_Renderer *renderer,
+                           Uint8 *r, Uint8 *g, Uint8 *b, Uint8 *a)
 {
-    SDL_Texture *native = texture->native;
-    SDL_Rect full_rect;
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (SDL_SW_UpdateYUVTexturePlanar(texture->yuv, rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch) < 0) {
-        return -1;
+    if (r) {
+        *r = renderer->color.r;
+    }
+    if (g) {
+        *g = renderer->color.g;
+    }
+    if (b) {
+        *b = renderer->color.b;
+    }
+    if (a) {
+        *a = renderer->color.a;
     }
+    return 0;
+}
 
-    full_rect.x = 0;
-    full_rect.y = 0;
-    full_rect.w = texture->w;
-    full_rect.h = texture->h;
-    rect = &full_rect;
+int SDL_SetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!rect->w || !rect->h) {
-        return 0; /* nothing to do. */
+    if (!IsSupportedBlendMode(renderer, blendMode)) {
+        return SDL_Unsupported();
     }
+    renderer->blendMode = blendMode;
+    return 0;
+}
 
-    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
-        /* We can lock the texture and copy to it */
-        void *native_pixels = NULL;
-        int native_pitch = 0;
+int SDL_GetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode *blendMode)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
-            return -1;
-        }
-        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                            rect->w, rect->h, native_pixels, native_pitch);
-        SDL_UnlockTexture(native);
-    } else {
-        /* Use a temporary buffer for updating */
-        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
-        const size_t alloclen = (size_t)rect->h * temp_pitch;
-        if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
-            if (!temp_pixels) {
-                return SDL_OutOfMemory();
-            }
-            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                                rect->w, rect->h, temp_pixels, temp_pitch);
-            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
-        }
-    }
+    *blendMode = renderer->blendMode;
     return 0;
 }
 
-static int SDL_UpdateTextureNVPlanar(SDL_Texture *texture, const SDL_Rect *rect,
-                                     const Uint8 *Yplane, int Ypitch,
-                                     const Uint8 *UVplane, int UVpitch)
+/* Clears ignore the viewport and clip rect, so while only the damaged part of
+   the window is drawn, clearing fills that part instead */
+static int QueueCmdClearDamage(SDL_Renderer *renderer)
 {
-    SDL_Texture *native = texture->native;
-    SDL_Rect full_rect;
+    const SDL_DRect viewport = renderer->viewport;
+    const SDL_bool clipping_enabled = renderer->clipping_enabled;
+    const SDL_BlendMode blendMode = renderer->blendMode;
+    SDL_FRect rect;
+    int retval;
 
-    if (SDL_SW_UpdateNVTexturePlanar(texture->yuv, rect, Yplane, Ypitch, UVplane, UVpitch) < 0) {
-        return -1;
-    }
+    renderer->viewport.x = renderer->damage_clip.x;
+    renderer->viewport.y = renderer->damage_clip.y;
+    renderer->viewport.w = renderer->damage_clip.w;
+    renderer->viewport.h = renderer->damage_clip.h;
+    renderer->clipping_enabled = SDL_FALSE;
+    renderer->blendMode = SDL_BLENDMODE_NONE;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
 
-    full_rect.x = 0;
-    full_rect.y = 0;
-    full_rect.w = texture->w;
-    full_rect.h = texture->h;
-    rect = &full_rect;
+    rect.x = 0.0f;
+    rect.y = 0.0f;
+    rect.w = (float)renderer->damage_clip.w;
+    rect.h = (float)renderer->damage_clip.h;
+    retval = QueueCmdFillRects(renderer, &rect, 1);
 
-    if (!rect->w || !rect->h) {
-        return 0; /* nothing to do. */
-    }
+    renderer->viewport = viewport;
+    renderer->clipping_enabled = clipping_enabled;
+    renderer->blendMode = blendMode;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
+    return retval;
+}
 
-    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
-        /* We can lock the texture and copy to it */
-        void *native_pixels = NULL;
-        int native_pitch = 0;
+int SDL_RenderClear(SDL_Renderer *renderer)
+{
+    int retval;
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-        if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
-            return -1;
+    if (!renderer->target && !renderer->recording_command_list) {
+        if (!renderer->damage_locked) {
+            LockDamageRegion(renderer);
         }
-        SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                            rect->w, rect->h, native_pixels, native_pitch);
-        SDL_UnlockTexture(native);
-    } else {
-        /* Use a temporary buffer for updating */
-        const int temp_pitch = (((rect->w * SDL_BYTESPERPIXEL(native->format)) + 3) & ~3);
-        const size_t alloclen = (size_t)rect->h * temp_pitch;
-        if (alloclen > 0) {
-            void *temp_pixels = SDL_malloc(alloclen);
-            if (!temp_pixels) {
-                return SDL_OutOfMemory();
-            }
-            SDL_SW_CopyYUVToRGB(texture->yuv, rect, native->format,
-                                rect->w, rect->h, temp_pixels, temp_pitch);
-            SDL_UpdateTexture(native, rect, temp_pixels, temp_pitch);
-            SDL_free(temp_pixels);
+        if (renderer->damage_clipping) {
+            retval = QueueCmdClearDamage(renderer);
+            return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
         }
     }
-    return 0;
-}
 
-#endif /* SDL_HAVE_YUV */
+    retval = QueueCmdClear(renderer);
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+}
 
-int SDL_UpdateYUVTexture(SDL_Texture *texture, const SDL_Rect *rect,
-                         const Uint8 *Yplane, int Ypitch,
-                         const Uint8 *Uplane, int Upitch,
-                         const Uint8 *Vplane, int Vpitch)
+int SDL_RenderAddDamageRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-#if SDL_HAVE_YUV
-    SDL_Renderer *renderer;
-    SDL_Rect real_rect;
+    SDL_Rect output, damage;
+    SDL_Rect *rects;
 
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!Yplane) {
-        return SDL_InvalidParamError("Yplane");
-    }
-    if (!Ypitch) {
-        return SDL_InvalidParamError("Ypitch");
-    }
-    if (!Uplane) {
-        return SDL_InvalidParamError("Uplane");
-    }
-    if (!Upitch) {
-        return SDL_InvalidParamError("Upitch");
-    }
-    if (!Vplane) {
-        return SDL_InvalidParamError("Vplane");
+    if (renderer->target) {
+        return SDL_SetError("Damage can only be added while rendering to the window");
     }
-    if (!Vpitch) {
-        return SDL_InvalidParamError("Vpitch");
+    if (renderer->damage_locked) {
+        return SDL_SetError("Damage has to be added before drawing the frame");
     }
-
-    if (texture->format != SDL_PIXELFORMAT_YV12 &&
-        texture->format != SDL_PIXELFORMAT_IYUV) {
-        return SDL_SetError("Texture format must by YV12 or IYUV");
+    if (SDL_GetRendererOutputSize(renderer, &output.w, &output.h) < 0) {
+        return -1;
     }
+    output.x = 0;
+    output.y = 0;
 
-    real_rect.x = 0;
-    real_rect.y = 0;
-    real_rect.w = texture->w;
-    real_rect.h = texture->h;
     if (rect) {
-        SDL_IntersectRect(rect, &real_rect, &real_rect);
-    }
-
-    if (real_rect.w == 0 || real_rect.h == 0) {
-        return 0; /* nothing to do. */
+        /* Round out to whole pixels */
+        const double x0 = SDL_floor(renderer->viewport.x + rect->x * renderer->scale.x);
+        const double y0 = SDL_floor(renderer->viewport.y + rect->y * renderer->scale.y);
+        const double x1 = SDL_ceil(renderer->viewport.x + (rect->x + rect->w) * renderer->scale.x);
+        const double y1 = SDL_ceil(renderer->viewport.y + (rect->y + rect->h) * renderer->scale.y);
+        damage.x = (int)x0;
+        damage.y = (int)y0;
+        damage.w = (int)(x1 - x0);
+        damage.h = (int)(y1 - y0);
+        if (!SDL_IntersectRect(&damage, &output, &damage)) {
+            return 0;
+        }
+    } else {
+        damage = output;
+        if (SDL_RectEmpty(&damage)) {
+            return 0;
+        }
     }
 
-    if (texture->yuv) {
-        return SDL_UpdateTextureYUVPlanar(texture, &real_rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
-    } else {
-        SDL_assert(!texture->native);
-        renderer = texture->renderer;
-        SDL_assert(renderer->UpdateTextureYUV);
-        if (renderer->UpdateTextureYUV) {
-            if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
-                return -1;
-            }
-            return renderer->UpdateTextureYUV(renderer, texture, &real_rect, Yplane, Ypitch, Uplane, Upitch, Vplane, Vpitch);
-        } else {
-            return SDL_Unsupported();
+    if (renderer->num_damage_rects == renderer->max_damage_rects) {
+        const int max_rects = renderer->max_damage_rects ? 2 * renderer->max_damage_rects : 8;
+        rects = (SDL_Rect *)SDL_realloc(renderer->damage_rects, max_rects * sizeof(*rects));
+        if (!rects) {
+            return SDL_OutOfMemory();
         }
+        renderer->damage_rects = rects;
+        renderer->max_damage_rects = max_rects;
     }
-#else
-    return -1;
-#endif
+    renderer->damage_rects[renderer->num_damage_rects++] = damage;
+    return 0;
 }
 
-int SDL_UpdateNVTexture(SDL_Texture *texture, const SDL_Rect *rect,
-                        const Uint8 *Yplane, int Ypitch,
-                        const Uint8 *UVplane, int UVpitch)
+/* !!! FIXME: delete all the duplicate code for the integer versions in 2.1,
+   !!! FIXME:  making the floating point versions the only available APIs. */
+
+int SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y)
 {
-#if SDL_HAVE_YUV
-    SDL_Renderer *renderer;
-    SDL_Rect real_rect;
+    SDL_FPoint fpoint;
+    fpoint.x = (float)x;
+    fpoint.y = (float)y;
+    return SDL_RenderDrawPointsF(renderer, &fpoint, 1);
+}
 
-    CHECK_TEXTURE_MAGIC(texture, -1);
+int SDL_RenderDrawPointF(SDL_Renderer *renderer, float x, float y)
+{
+    SDL_FPoint fpoint;
+    fpoint.x = x;
+    fpoint.y = y;
+    return SDL_RenderDrawPointsF(renderer, &fpoint, 1);
+}
 
-    if (!Yplane) {
-        return SDL_InvalidParamError("Yplane");
-    }
-    if (!Ypitch) {
-        return SDL_InvalidParamError("Ypitch");
-    }
-    if (!UVplane) {
-        return SDL_InvalidParamError("UVplane");
-    }
-    if (!UVpitch) {
-        return SDL_InvalidParamError("UVpitch");
-    }
+static int RenderDrawPointsWithRects(SDL_Renderer *renderer,
+                                     const SDL_Point *points, const int count)
+{
+    int retval;
+    SDL_bool isstack;
+    SDL_FRect *frects;
+    int i;
 
-    if (texture->format != SDL_PIXELFORMAT_NV12 &&
-        texture->format != SDL_PIXELFORMAT_NV21) {
-        return SDL_SetError("Texture format must by NV12 or NV21");
+    if (count < 1) {
+        return 0;
     }
 
-    real_rect.x = 0;
-    real_rect.y = 0;
-    real_rect.w = texture->w;
-    real_rect.h = texture->h;
-    if (rect) {
-        SDL_IntersectRect(rect, &real_rect, &real_rect);
+    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
+    if (!frects) {
+        return SDL_OutOfMemory();
     }
 
-    if (real_rect.w == 0 || real_rect.h == 0) {
-        return 0; /* nothing to do. */
+    for (i = 0; i < count; ++i) {
+        frects[i].x = points[i].x * renderer->scale.x;
+        frects[i].y = points[i].y * renderer->scale.y;
+        frects[i].w = renderer->scale.x;
+        frects[i].h = renderer->scale.y;
     }
 
-    if (texture->yuv) {
-        return SDL_UpdateTextureNVPlanar(texture, &real_rect, Yplane, Ypitch, UVplane, UVpitch);
-    } else {
-        SDL_assert(!texture->native);
-        renderer = texture->renderer;
-        SDL_assert(renderer->UpdateTextureNV);
-        if (renderer->UpdateTextureNV) {
-            if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
-                return -1;
-            }
-            return renderer->UpdateTextureNV(renderer, texture, &real_rect, Yplane, Ypitch, UVplane, UVpitch);
-        } else {
-            return SDL_Unsupported();
-        }
-    }
-#else
-    return -1;
-#endif
-}
+    retval = QueueCmdFillRects(renderer, frects, count);
 
-#if SDL_HAVE_YUV
-static int SDL_LockTextureYUV(SDL_Texture *texture, const SDL_Rect *rect,
-                              void **pixels, int *pitch)
-{
-    return SDL_SW_LockYUVTexture(texture->yuv, rect, pixels, pitch);
-}
-#endif /* SDL_HAVE_YUV */
+    SDL_small_free(frects, isstack);
 
-static int SDL_LockTextureNative(SDL_Texture *texture, const SDL_Rect *rect,
-                                 void **pixels, int *pitch)
-{
-    texture->locked_rect = *rect;
-    *pixels = (void *)((Uint8 *)texture->pixels +
-                       rect->y * texture->pitch +
-                       rect->x * SDL_BYTESPERPIXEL(texture->format));
-    *pitch = texture->pitch;
-    return 0;
+    return retval;
 }
 
-int SDL_LockTexture(SDL_Texture *texture, const SDL_Rect *rect,
-                    void **pixels, int *pitch)
+int SDL_RenderDrawPoints(SDL_Renderer *renderer,
+                         const SDL_Point *points, int count)
 {
-    SDL_Rect full_rect;
+    SDL_FPoint *fpoints;
+    int i;
+    int retval;
+    SDL_bool isstack;
 
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (texture->access != SDL_TEXTUREACCESS_STREAMING) {
-        return SDL_SetError("SDL_LockTexture(): texture must be streaming");
+    if (!points) {
+        return SDL_InvalidParamError("SDL_RenderDrawPoints(): points");
     }
-
-    if (!rect) {
-        full_rect.x = 0;
-        full_rect.y = 0;
-        full_rect.w = texture->w;
-        full_rect.h = texture->h;
-        rect = &full_rect;
+    if (count < 1) {
+        return 0;
     }
 
-#if SDL_HAVE_YUV
-    if (texture->yuv) {
-        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
-            return -1;
-        }
-        return SDL_LockTextureYUV(texture, rect, pixels, pitch);
-    } else
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
 #endif
-        if (texture->native) {
-        /* Calls a real SDL_LockTexture/SDL_UnlockTexture on unlock, flushing then. */
-        return SDL_LockTextureNative(texture, rect, pixels, pitch);
+
+    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
+        retval = RenderDrawPointsWithRects(renderer, points, count);
     } else {
-        SDL_Renderer *renderer = texture->renderer;
-        if (FlushRenderCommandsIfTextureNeeded(texture) < 0) {
-            return -1;
+        fpoints = SDL_small_alloc(SDL_FPoint, count, &isstack);
+        if (!fpoints) {
+            return SDL_OutOfMemory();
         }
-        return renderer->LockTexture(renderer, texture, rect, pixels, pitch);
+        for (i = 0; i < count; ++i) {
+            fpoints[i].x = (float)points[i].x;
+            fpoints[i].y = (float)points[i].y;
+        }
+
+        retval = QueueCmdDrawPoints(renderer, fpoints, count);
+
+        SDL_small_free(fpoints, isstack);
     }
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-int SDL_LockTextureToSurface(SDL_Texture *texture, const SDL_Rect *rect,
-                             SDL_Surface **surface)
+static int RenderDrawPointsWithRectsF(SDL_Renderer *renderer,
+                                      const SDL_FPoint *fpoints, const int count)
 {
-    SDL_Rect real_rect;
-    void *pixels = NULL;
-    int pitch = 0; /* fix static analysis */
-    int ret;
-
-    if (!texture || !surface) {
-        return -1;
-    }
+    int retval;
+    SDL_bool isstack;
+    SDL_FRect *frects;
+    int i;
 
-    real_rect.x = 0;
-    real_rect.y = 0;
-    real_rect.w = texture->w;
-    real_rect.h = texture->h;
-    if (rect) {
-        SDL_IntersectRect(rect, &real_rect, &real_rect);
+    if (count < 1) {
+        return 0;
     }
 
-    ret = SDL_LockTexture(texture, &real_rect, &pixels, &pitch);
-    if (ret < 0) {
-        return ret;
+    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
+    if (!frects) {
+        return SDL_OutOfMemory();
     }
 
-    texture->locked_surface = SDL_CreateRGBSurfaceWithFormatFrom(pixels, real_rect.w, real_rect.h, 0, pitch, texture->format);
-    if (!texture->locked_surface) {
-        SDL_UnlockTexture(texture);
-        return -1;
+    for (i = 0; i < count; ++i) {
+        frects[i].x = fpoints[i].x * renderer->scale.x;
+        frects[i].y = fpoints[i].y * renderer->scale.y;
+        frects[i].w = renderer->scale.x;
+        frects[i].h = renderer->scale.y;
     }
 
-    *surface = texture->locked_surface;
-    return 0;
-}
-
-#if SDL_HAVE_YUV
-static void SDL_UnlockTextureYUV(SDL_Texture *texture)
-{
-    SDL_Texture *native = texture->native;
-    void *native_pixels = NULL;
-    int native_pitch = 0;
-    SDL_Rect rect;
+    retval = QueueCmdFillRects(renderer, frects, count);
 
-    rect.x = 0;
-    rect.y = 0;
-    rect.w = texture->w;
-    rect.h = texture->h;
+    SDL_small_free(frects, isstack);
 
-    if (SDL_LockTexture(native, &rect, &native_pixels, &native_pitch) < 0) {
-        return;
-    }
-    SDL_SW_CopyYUVToRGB(texture->yuv, &rect, native->format,
-                        rect.w, rect.h, native_pixels, native_pitch);
-    SDL_UnlockTexture(native);
+    return retval;
 }
-#endif /* SDL_HAVE_YUV */
 
-static void SDL_UnlockTextureNative(SDL_Texture *texture)
+int SDL_RenderDrawPointsF(SDL_Renderer *renderer,
+                          const SDL_FPoint *points, int count)
 {
-    SDL_Texture *native = texture->native;
-    void *native_pixels = NULL;
-    int native_pitch = 0;
-    const SDL_Rect *rect = &texture->locked_rect;
-    const void *pixels = (void *)((Uint8 *)texture->pixels +
-                                  rect->y * texture->pitch +
-                                  rect->x * SDL_BYTESPERPIXEL(texture->format));
-    int pitch = texture->pitch;
+    int retval;
 
-    if (SDL_LockTexture(native, rect, &native_pixels, &native_pitch) < 0) {
-        return;
-    }
-    SDL_ConvertPixels(rect->w, rect->h,
-                      texture->format, pixels, pitch,
-                      native->format, native_pixels, native_pitch);
-    SDL_UnlockTexture(native);
-}
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-void SDL_UnlockTexture(SDL_Texture *texture)
-{
-    CHECK_TEXTURE_MAGIC(texture, );
+    if (!points) {
+        return SDL_InvalidParamError("SDL_RenderDrawPointsF(): points");
+    }
+    if (count < 1) {
+        return 0;
+    }
 
-    if (texture->access != SDL_TEXTUREACCESS_STREAMING) {
-        return;
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
     }
-#if SDL_HAVE_YUV
-    if (texture->yuv) {
-        SDL_UnlockTextureYUV(texture);
-    } else
 #endif
-        if (texture->native) {
-        SDL_UnlockTextureNative(texture);
+
+    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
+        retval = RenderDrawPointsWithRectsF(renderer, points, count);
     } else {
-        SDL_Renderer *renderer = texture->renderer;
-        renderer->UnlockTexture(renderer, texture);
+        retval = QueueCmdDrawPoints(renderer, points, count);
     }
-
-    SDL_FreeSurface(texture->locked_surface);
-    texture->locked_surface = NULL;
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-SDL_bool SDL_RenderTargetSupported(SDL_Renderer *renderer)
+int SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
 {
-    if (!renderer || !renderer->SetRenderTarget) {
-        return SDL_FALSE;
-    }
-    return (renderer->info.flags & SDL_RENDERER_TARGETTEXTURE) != 0;
+    SDL_FPoint points[2];
+    points[0].x = (float)x1;
+    points[0].y = (float)y1;
+    points[1].x = (float)x2;
+    points[1].y = (float)y2;
+    return SDL_RenderDrawLinesF(renderer, points, 2);
 }
 
-int SDL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+int SDL_RenderDrawLineF(SDL_Renderer *renderer, float x1, float y1, float x2, float y2)
 {
-    if (!SDL_RenderTargetSupported(renderer)) {
-        return SDL_Unsupported();
-    }
+    SDL_FPoint points[2];
+    points[0].x = x1;
+    points[0].y = y1;
+    points[1].x = x2;
+    points[1].y = y2;
+    return SDL_RenderDrawLinesF(renderer, points, 2);
+}
 
-    /* texture == NULL is valid and means reset the target to the window */
-    if (texture) {
-        CHECK_TEXTURE_MAGIC(texture, -1);
-        if (renderer != texture->renderer) {
-            return SDL_SetError("Texture was not created with this renderer");
-        }
-        if (texture->access != SDL_TEXTUREACCESS_TARGET) {
-            return SDL_SetError("Texture not created with SDL_TEXTUREACCESS_TARGET");
-        }
-        if (texture->native) {
-            /* Always render to the native texture */
-            texture = texture->native;
-        }
-    }
+static int RenderDrawLineBresenham(SDL_Renderer *renderer, int x1, int y1, int x2, int y2, SDL_bool draw_last)
+{
+    int i, deltax, deltay, numpixels;
+    int d, dinc1, dinc2;
+    int x, xinc1, xinc2;
+    int y, yinc1, yinc2;
+    int retval;
+    SDL_bool isstack;
+    SDL_FPoint *points;
+    SDL_Rect clip_rect;
 
-    if (texture == renderer->target) {
-        /* Nothing to do! */
+    /* the backend might clip this further to the clipping rect, but we
+       just want a basic safety against generating millions of points for
+       massive lines. */
+    clip_rect.x = 0;
+    clip_rect.y = 0;
+    clip_rect.w = (int) renderer->viewport.w;
+    clip_rect.h = (int) renderer->viewport.h;
+    if (!SDL_IntersectRectAndLine(&clip_rect, &x1, &y1, &x2, &y2)) {
         return 0;
     }
 
-    FlushRenderCommands(renderer); /* time to send everything to the GPU! */
-
-    SDL_LockMutex(renderer->target_mutex);
-
-    if (texture && !renderer->target) {
-        /* Make a backup of the viewport */
-        renderer->viewport_backup = renderer->viewport;
-        renderer->clip_rect_backup = renderer->clip_rect;
-        renderer->clipping_enabled_backup = renderer->clipping_enabled;
-        renderer->scale_backup = renderer->scale;
-        renderer->logical_w_backup = renderer->logical_w;
-        renderer->logical_h_backup = renderer->logical_h;
-    }
-    renderer->target = texture;
-
-    if (renderer->SetRenderTarget(renderer, texture) < 0) {
-        SDL_UnlockMutex(renderer->target_mutex);
-        return -1;
-    }
+    deltax = SDL_abs(x2 - x1);
+    deltay = SDL_abs(y2 - y1);
 
-    if (texture) {
-        renderer->viewport.x = (double)0;
-        renderer->viewport.y = (double)0;
-        renderer->viewport.w = (double)texture->w;
-        renderer->viewport.h = (double)texture->h;
-        SDL_zero(renderer->clip_rect);
-        renderer->clipping_enabled = SDL_FALSE;
-        renderer->scale.x = 1.0f;
-        renderer->scale.y = 1.0f;
-        renderer->logical_w = texture->w;
-        renderer->logical_h = texture->h;
+    if (deltax >= deltay) {
+        numpixels = deltax + 1;
+        d = (2 * deltay) - deltax;
+        dinc1 = deltay * 2;
+        dinc2 = (deltay - deltax) * 2;
+        xinc1 = 1;
+        xinc2 = 1;
+        yinc1 = 0;
+        yinc2 = 1;
     } else {
-        renderer->viewport = renderer->viewport_backup;
-        renderer->clip_rect = renderer->clip_rect_backup;
-        renderer->clipping_enabled = renderer->clipping_enabled_backup;
-        renderer->scale = renderer->scale_backup;
-        renderer->logical_w = renderer->logical_w_backup;
-        renderer->logical_h = renderer->logical_h_backup;
+        numpixels = deltay + 1;
+        d = (2 * deltax) - deltay;
+        dinc1 = deltax * 2;
+        dinc2 = (deltax - deltay) * 2;
+        xinc1 = 0;
+        xinc2 = 1;
+        yinc1 = 1;
+        yinc2 = 1;
     }
 
-    SDL_UnlockMutex(renderer->target_mutex);
-
-    if (QueueCmdSetViewport(renderer) < 0) {
-        return -1;
+    if (x1 > x2) {
+        xinc1 = -xinc1;
+        xinc2 = -xinc2;
     }
-    if (QueueCmdSetClipRect(renderer) < 0) {
-        return -1;
+    if (y1 > y2) {
+        yinc1 = -yinc1;
+        yinc2 = -yinc2;
     }
 
-    /* All set! */
-    return FlushRenderCommandsIfNotBatching(renderer);
-}
-
-SDL_Texture *SDL_GetRenderTarget(SDL_Renderer *renderer)
-{
-    CHECK_RENDERER_MAGIC(renderer, NULL);
-
-    return renderer->target;
-}
+    x = x1;
+    y = y1;
 
-static int UpdateLogicalSize(SDL_Renderer *renderer, SDL_bool flush_viewport_cmd)
-{
-    int w = 1, h = 1;
-    float want_aspect;
-    float real_aspect;
-    float scale;
-    SDL_Rect viewport;
-    /* 0 is for letterbox, 1 is for overscan */
-    int scale_policy = 0;
-    const char *hint;
+    if (!draw_last) {
+        --numpixels;
+    }
 
-    if (!renderer->logical_w || !renderer->logical_h) {
-        return 0;
+    points = SDL_small_alloc(SDL_FPoint, numpixels, &isstack);
+    if (!points) {
+        return SDL_OutOfMemory();
     }
-    if (SDL_GetRendererOutputSize(renderer, &w, &h) < 0) {
-        return -1;
+    for (i = 0; i < numpixels; ++i) {
+        points[i].x = (float)x;
+        points[i].y = (float)y;
+
+        if (d < 0) {
+            d += dinc1;
+            x += xinc1;
+            y += yinc1;
+        } else {
+            d += dinc2;
+            x += xinc2;
+            y += yinc2;
+        }
     }
 
-    hint = SDL_GetHint(SDL_HINT_RENDER_LOGICAL_SIZE_MODE);
-    if (hint && (*hint == '1' || SDL_strcasecmp(hint, "overscan") == 0)) {
-#if SDL_VIDEO_RENDER_D3D
-        SDL_bool overscan_supported = SDL_TRUE;
-        /* Unfortunately, Direct3D 9 doesn't support negative viewport numbers
-           which the overscan implementation relies on.
-        */
-        if (SDL_strcasecmp(SDL_GetCurrentVideoDriver(), "direct3d") == 0) {
-            overscan_supported = SDL_FALSE;
-        }
-        if (overscan_supported) {
-            scale_policy = 1;
-        }
-#else
-        scale_policy = 1;
-#endif
+    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
+        retval = RenderDrawPointsWithRectsF(renderer, points, numpixels);
+    } else {
+        retval = QueueCmdDrawPoints(renderer, points, numpixels);
     }
 
-    want_aspect = (float)renderer->logical_w / renderer->logical_h;
-    real_aspect = (float)w / h;
+    SDL_small_free(points, isstack);
 
-    /* Clear the scale because we're setting viewport in output coordinates */
-    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    return retval;
+}
 
-    if (renderer->integer_scale) {
-        if (want_aspect > real_aspect) {
-            scale = (float)(w / renderer->logical_w); /* This an integer division! */
-        } else {
-            scale = (float)(h / renderer->logical_h); /* This an integer division! */
-        }
+static int RenderDrawLinesWithRectsF(SDL_Renderer *renderer,
+                                     const SDL_FPoint *points, const int count)
+{
+    const float scale_x = renderer->scale.x;
+    const float scale_y = renderer->scale.y;
+    SDL_FRect *frect;
+    SDL_FRect *frects;
+    int i, nrects = 0;
+    int retval = 0;
+    SDL_bool isstack;
+    SDL_bool drew_line = SDL_FALSE;
+    SDL_bool draw_last = SDL_FALSE;
 
-        if (scale < 1.0f) {
-            scale = 1.0f;
-        }
+    frects = SDL_small_alloc(SDL_FRect, count - 1, &isstack);
+    if (!frects) {
+        return SDL_OutOfMemory();
+    }
 
-        viewport.w = (int)SDL_floor(renderer->logical_w * scale);
-        viewport.x = (w - viewport.w) / 2;
-        viewport.h = (int)SDL_floor(renderer->logical_h * scale);
-        viewport.y = (h - viewport.h) / 2;
-    } else if (SDL_fabs(want_aspect - real_aspect) < 0.0001) {
-        /* The aspect ratios are the same, just scale appropriately */
-        scale = (float)w / renderer->logical_w;
+    for (i = 0; i < count - 1; ++i) {
+        SDL_bool same_x = (points[i].x == points[i + 1].x);
+        SDL_bool same_y = (points[i].y == points[i + 1].y);
 
-        SDL_zero(viewport);
-        SDL_GetRendererOutputSize(renderer, &viewport.w, &viewport.h);
-    } else if (want_aspect > real_aspect) {
-        if (scale_policy == 1) {
-            /* We want a wider aspect ratio than is available -
-             zoom so logical height matches the real height
-             and the width will grow off the screen
-             */
-            scale = (float)h / renderer->logical_h;
-            viewport.y = 0;
-            viewport.h = h;
-            viewport.w = (int)SDL_floor(renderer->logical_w * scale);
-            viewport.x = (w - viewport.w) / 2;
+        if (i == (count - 2)) {
+            if (!drew_line || points[i + 1].x != points[0].x || points[i + 1].y != points[0].y) {
+                draw_last = SDL_TRUE;
+            }
         } else {
-            /* We want a wider aspect ratio than is available - letterbox it */
-            scale = (float)w / renderer->logical_w;
-            viewport.x = 0;
-            viewport.w = w;
-            viewport.h = (int)SDL_floor(renderer->logical_h * scale);
-            viewport.y = (h - viewport.h) / 2;
+            if (same_x && same_y) {
+                continue;
+            }
         }
-    } else {
-        if (scale_policy == 1) {
-            /* We want a narrower aspect ratio than is available -
-             zoom so logical width matches the real width
-             and the height will grow off the screen
-             */
-            scale = (float)w / renderer->logical_w;
-            viewport.x = 0;
-            viewport.w = w;
-            viewport.h = (int)SDL_floor(renderer->logical_h * scale);
-            viewport.y = (h - viewport.h) / 2;
+        if (same_x) {
+            const float minY = SDL_min(points[i].y, points[i + 1].y);
+            const float maxY = SDL_max(points[i].y, points[i + 1].y);
+
+            frect = &frects[nrects++];
+            frect->x = points[i].x * scale_x;
+            frect->y = minY * scale_y;
+            frect->w = scale_x;
+            frect->h = (maxY - minY + draw_last) * scale_y;
+            if (!draw_last && points[i + 1].y < points[i].y) {
+                frect->y += scale_y;
+            }
+        } else if (same_y) {
+            const float minX = SDL_min(points[i].x, points[i + 1].x);
+            const float maxX = SDL_max(points[i].x, points[i + 1].x);
+
+            frect = &frects[nrects++];
+            frect->x = minX * scale_x;
+            frect->y = points[i].y * scale_y;
+            frect->w = (maxX - minX + draw_last) * scale_x;
+            frect->h = scale_y;
+            if (!draw_last && points[i + 1].x < points[i].x) {
+                frect->x += scale_x;
+            }
         } else {
-            /* We want a narrower aspect ratio than is available - use side-bars */
-            scale = (float)h / renderer->logical_h;
-            viewport.y = 0;
-            viewport.h = h;
-            viewport.w = (int)SDL_floor(renderer->logical_w * scale);
-            viewport.x = (w - viewport.w) / 2;
+            retval += RenderDrawLineBresenham(renderer, (int)SDL_roundf(points[i].x), (int)SDL_roundf(points[i].y),
+                                              (int)SDL_roundf(points[i + 1].x), (int)SDL_roundf(points[i + 1].y), draw_last);
         }
+        drew_line = SDL_TRUE;
     }
 
-    /* Set the new viewport */
-    renderer->viewport.x = (double)viewport.x * renderer->scale.x;
-    renderer->viewport.y = (double)viewport.y * renderer->scale.y;
-    renderer->viewport.w = (double)viewport.w * renderer->scale.x;
-    renderer->viewport.h = (double)viewport.h * renderer->scale.y;
-    QueueCmdSetViewport(renderer);
-    if (flush_viewport_cmd) {
-        FlushRenderCommandsIfNotBatching(renderer);
+    if (nrects) {
+        retval += QueueCmdFillRects(renderer, frects, nrects);
     }
 
-    /* Set the new scale */
-    SDL_RenderSetScale(renderer, scale, scale);
+    SDL_small_free(frects, isstack);
 
-    return 0;
+    if (retval < 0) {
+        retval = -1;
+    }
+    return retval;
 }
 
-int SDL_RenderSetLogicalSize(SDL_Renderer *renderer, int w, int h)
+int SDL_RenderDrawLines(SDL_Renderer *renderer,
+                        const SDL_Point *points, int count)
 {
+    SDL_FPoint *fpoints;
+    int i;
+    int retval;
+    SDL_bool isstack;
+
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!w || !h) {
-        /* Clear any previous logical resolution */
-        renderer->logical_w = 0;
-        renderer->logical_h = 0;
-        SDL_RenderSetViewport(renderer, NULL);
-        SDL_RenderSetScale(renderer, 1.0f, 1.0f);
+    if (!points) {
+        return SDL_InvalidParamError("SDL_RenderDrawLines(): points");
+    }
+    if (count < 2) {
         return 0;
     }
 
-    renderer->logical_w = w;
-    renderer->logical_h = h;
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+#endif
 
-    return UpdateLogicalSize(renderer, SDL_TRUE);
+    fpoints = SDL_small_alloc(SDL_FPoint, count, &isstack);
+    if (!fpoints) {
+        return SDL_OutOfMemory();
+    }
+
+    for (i = 0; i < count; ++i) {
+        fpoints[i].x = (float)points[i].x;
+        fpoints[i].y = (float)points[i].y;
+    }
+
+    retval = SDL_RenderDrawLinesF(renderer, fpoints, count);
+
+    SDL_small_free(fpoints, isstack);
+
+    return retval;
 }
 
-void SDL_RenderGetLogicalSize(SDL_Renderer *renderer, int *w, int *h)
+int SDL_RenderDrawLinesF(SDL_Renderer *renderer,
+                         const SDL_FPoint *points, int count)
 {
-    CHECK_RENDERER_MAGIC(renderer, );
+    int retval = 0;
 
-    if (w) {
-        *w = renderer->logical_w;
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!points) {
+        return SDL_InvalidParamError("SDL_RenderDrawLinesF(): points");
     }
-    if (h) {
-        *h = renderer->logical_h;
+    if (count < 2) {
+        return 0;
     }
-}
 
-int SDL_RenderSetIntegerScale(SDL_Renderer *renderer, SDL_bool enable)
-{
-    CHECK_RENDERER_MAGIC(renderer, -1);
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+#endif
 
-    renderer->integer_scale = enable;
+    if (renderer->line_method == SDL_RENDERLINEMETHOD_POINTS) {
+        retval = RenderDrawLinesWithRectsF(renderer, points, count);
+    } else if (renderer->line_method == SDL_RENDERLINEMETHOD_GEOMETRY) {
+        SDL_bool isstack1;
+        SDL_bool isstack2;
+        const float scale_x = renderer->scale.x;
+        const float scale_y = renderer->scale.y;
+        float *xy = SDL_small_alloc(float, 4 * 2 * count, &isstack1);
+        int *indices = SDL_small_alloc(int,
+                                       (4) * 3 * (count - 1) + (2) * 3 * (count), &isstack2);
 
-    return UpdateLogicalSize(renderer, SDL_TRUE);
-}
+        if (xy && indices) {
+            int i;
+            float *ptr_xy = xy;
+            int *ptr_indices = indices;
+            const int xy_stride = 2 * sizeof(float);
+            int num_vertices = 4 * count;
+            int num_indices = 0;
+            const int size_indices = 4;
+            int cur_index = -4;
+            const int is_looping = (points[0].x == points[count - 1].x && points[0].y == points[count - 1].y);
+            SDL_FPoint p; /* previous point */
+            p.x = p.y = 0.0f;
+            /*       p            q
+
+                    0----1------ 4----5
+                    | \  |``\    | \  |
+                    |  \ |   ` `\|  \ |
+                    3----2-------7----6
+            */
+            for (i = 0; i < count; ++i) {
+                SDL_FPoint q = points[i]; /* current point */
+
+                q.x *= scale_x;
+                q.y *= scale_y;
 
-SDL_bool SDL_RenderGetIntegerScale(SDL_Renderer *renderer)
-{
-    CHECK_RENDERER_MAGIC(renderer, SDL_FALSE);
+                *ptr_xy++ = q.x;
+                *ptr_xy++ = q.y;
+                *ptr_xy++ = q.x + scale_x;
+                *ptr_xy++ = q.y;
+                *ptr_xy++ = q.x + scale_x;
+                *ptr_xy++ = q.y + scale_y;
+                *ptr_xy++ = q.x;
+                *ptr_xy++ = q.y + scale_y;
 
-    return renderer->integer_scale;
-}
+#define ADD_TRIANGLE(i1, i2, i3)     \
+    *ptr_indices++ = cur_index + i1; \
+    *ptr_indices++ = cur_index + i2; \
+    *ptr_indices++ = cur_index + i3; \
+    num_indices += 3;
 
-int SDL_RenderSetViewport(SDL_Renderer *renderer, const SDL_Rect *rect)
-{
-    int retval;
-    CHECK_RENDERER_MAGIC(renderer, -1);
+                /* closed polyline, don´t draw twice the point */
+                if (i || is_looping == 0) {
+                    ADD_TRIANGLE(4, 5, 6)
+                    ADD_TRIANGLE(4, 6, 7)
+                }
 
-    if (rect) {
-        renderer->viewport.x = (double)rect->x * renderer->scale.x;
-        renderer->viewport.y = (double)rect->y * renderer->scale.y;
-        renderer->viewport.w = (double)rect->w * renderer->scale.x;
-        renderer->viewport.h = (double)rect->h * renderer->scale.y;
-    } else {
-        int w, h;
-        if (SDL_GetRendererOutputSize(renderer, &w, &h) < 0) {
-            return -1;
-        }
-        renderer->viewport.x = 0.0;
-        renderer->viewport.y = 0.0;
-        /* NOLINTBEGIN(clang-analyzer-core.uninitialized.Assign): SDL_GetRendererOutputSize cannot fail */
-        renderer->viewport.w = (double)w;
-        renderer->viewport.h = (double)h;
-        /* NOLINTEND(clang-analyzer-core.uninitialized.Assign) */
-    }
-    retval = QueueCmdSetViewport(renderer);
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
-}
+                /* first point only, no segment */
+                if (i == 0) {
+                    p = q;
+                    cur_index += 4;
+                    continue;
+                }
 
-void SDL_RenderGetViewport(SDL_Renderer *renderer, SDL_Rect *rect)
-{
-    CHECK_RENDERER_MAGIC(renderer, );
+                /* draw segment */
+                if (p.y == q.y) {
+                    if (p.x < q.x) {
+                        ADD_TRIANGLE(1, 4, 7)
+                        ADD_TRIANGLE(1, 7, 2)
+                    } else {
+                        ADD_TRIANGLE(5, 0, 3)
+                        ADD_TRIANGLE(5, 3, 6)
+                    }
+                } else if (p.x == q.x) {
+                    if (p.y < q.y) {
+                        ADD_TRIANGLE(2, 5, 4)
+                        ADD_TRIANGLE(2, 4, 3)
+                    } else {
+                        ADD_TRIANGLE(6, 1, 0)
+                        ADD_TRIANGLE(6, 0, 7)
+                    }
+                } else {
+                    if (p.y < q.y) {
+                        if (p.x < q.x) {
+                            ADD_TRIANGLE(1, 5, 4)
+                            ADD_TRIANGLE(1, 4, 2)
+                            ADD_TRIANGLE(2, 4, 7)
+                            ADD_TRIANGLE(2, 7, 3)
+                        } else {
+                            ADD_TRIANGLE(4, 0, 5)
+                            ADD_TRIANGLE(5, 0, 3)
+                            ADD_TRIANGLE(5, 3, 6)
+                            ADD_TRIANGLE(6, 3, 2)
+                        }
+                    } else {
+                        if (p.x < q.x) {
+                            ADD_TRIANGLE(0, 4, 7)
+                            ADD_TRIANGLE(0, 7, 1)
+                            ADD_TRIANGLE(1, 7, 6)
+                            ADD_TRIANGLE(1, 6, 2)
+                        } else {
+                            ADD_TRIANGLE(6, 5, 1)
+                            ADD_TRIANGLE(6, 1, 0)
+                            ADD_TRIANGLE(7, 6, 0)
+                            ADD_TRIANGLE(7, 0, 3)
+                        }
+                    }
+                }
 
-    if (rect) {
-        rect->x = (int)SDL_floor(renderer->viewport.x / renderer->scale.x);
-        rect->y = (int)SDL_floor(renderer->viewport.y / renderer->scale.y);
-        rect->w = (int)SDL_floor(renderer->viewport.w / renderer->scale.x);
-        rect->h = (int)SDL_floor(renderer->viewport.h / renderer->scale.y);
-    }
-}
+                p = q;
+                cur_index += 4;
+            }
 
-static void RenderGetViewportSize(SDL_Renderer *renderer, SDL_FRect *rect)
-{
-    rect->x = 0.0f;
-    rect->y = 0.0f;
-    rect->w = (float)(renderer->viewport.w / renderer->scale.x);
-    rect->h = (float)(renderer->viewport.h / renderer->scale.y);
-}
+            retval = QueueCmdGeometry(renderer, NULL,
+                                      xy, xy_stride, &renderer->color, 0 /* color_stride */, NULL, 0,
+                                      num_vertices, indices, num_indices, size_indices,
+                                      1.0f, 1.0f);
+        }
 
-int SDL_RenderSetClipRect(SDL_Renderer *renderer, const SDL_Rect *rect)
-{
-    int retval;
-    CHECK_RENDERER_MAGIC(renderer, -1)
+        SDL_small_free(xy, isstack1);
+        SDL_small_free(indices, isstack2);
 
-    if (rect && rect->w >= 0 && rect->h >= 0) {
-        renderer->clipping_enabled = SDL_TRUE;
-        renderer->clip_rect.x = (double)rect->x * renderer->scale.x;
-        renderer->clip_rect.y = (double)rect->y * renderer->scale.y;
-        renderer->clip_rect.w = (double)rect->w * renderer->scale.x;
-        renderer->clip_rect.h = (double)rect->h * renderer->scale.y;
+    } else if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
+        retval = RenderDrawLinesWithRectsF(renderer, points, count);
     } else {
-        renderer->clipping_enabled = SDL_FALSE;
-        SDL_zero(renderer->clip_rect);
+        retval = QueueCmdDrawLines(renderer, points, count);
     }
 
-    retval = QueueCmdSetClipRect(renderer);
     return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-void SDL_RenderGetClipRect(SDL_Renderer *renderer, SDL_Rect *rect)
+int SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
-    CHECK_RENDERER_MAGIC(renderer, )
+    SDL_FRect frect;
+    SDL_FRect *prect = NULL;
 
     if (rect) {
-        rect->x = (int)SDL_floor(renderer->clip_rect.x / renderer->scale.x);
-        rect->y = (int)SDL_floor(renderer->clip_rect.y / renderer->scale.y);
-        rect->w = (int)SDL_floor(renderer->clip_rect.w / renderer->scale.x);
-        rect->h = (int)SDL_floor(renderer->clip_rect.h / renderer->scale.y);
+        frect.x = (float)rect->x;
+        frect.y = (float)rect->y;
+        frect.w = (float)rect->w;
+        frect.h = (float)rect->h;
+        prect = &frect;
     }
-}
 
-SDL_bool SDL_RenderIsClipEnabled(SDL_Renderer *renderer)
-{
-    CHECK_RENDERER_MAGIC(renderer, SDL_FALSE)
-    return renderer->clipping_enabled;
+    return SDL_RenderDrawRectF(renderer, prect);
 }
 
-int SDL_RenderSetScale(SDL_Renderer *renderer, float scaleX, float scaleY)
+int SDL_RenderDrawRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
 {
-    CHECK_RENDERER_MAGIC(renderer, -1);
-
-    renderer->scale.x = scaleX;
-    renderer->scale.y = scaleY;
-    return 0;
-}
+    SDL_FRect frect;
+    SDL_FPoint points[5];
 
-void SDL_RenderGetScale(SDL_Renderer *renderer, float *scaleX, float *scaleY)
-{
-    CHECK_RENDERER_MAGIC(renderer, );
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (scaleX) {
-        *scaleX = renderer->scale.x;
-    }
-    if (scaleY) {
-        *scaleY = renderer->scale.y;
+    /* If 'rect' == NULL, then outline the whole surface */
+    if (!rect) {
+        RenderGetViewportSize(renderer, &frect);
+        rect = &frect;
     }
-}
-
-void SDL_RenderWindowToLogical(SDL_Renderer *renderer, int windowX, int windowY, float *logicalX, float *logicalY)
-{
-    float window_physical_x, window_physical_y;
-
-    CHECK_RENDERER_MAGIC(renderer, );
-
-    window_physical_x = ((float)windowX) / renderer->dpi_scale.x;
-    window_physical_y = ((float)windowY) / renderer->dpi_scale.y;
 
-    if (logicalX) {
-        *logicalX = (float)((window_physical_x - renderer->viewport.x) / renderer->scale.x);
-    }
-    if (logicalY) {
-        *logicalY = (float)((window_physical_y - renderer->viewport.y) / renderer->scale.y);
-    }
+    points[0].x = rect->x;
+    points[0].y = rect->y;
+    points[1].x = rect->x + rect->w - 1;
+    points[1].y = rect->y;
+    points[2].x = rect->x + rect->w - 1;
+    points[2].y = rect->y + rect->h - 1;
+    points[3].x = rect->x;
+    points[3].y = rect->y + rect->h - 1;
+    points[4].x = rect->x;
+    points[4].y = rect->y;
+    return SDL_RenderDrawLinesF(renderer, points, 5);
 }
 
-void SDL_RenderLogicalToWindow(SDL_Renderer *renderer, float logicalX, float logicalY, int *windowX, int *windowY)
+int SDL_RenderDrawRects(SDL_Renderer *renderer,
+                        const SDL_Rect *rects, int count)
 {
-    float window_physical_x, window_physical_y;
-
-    CHECK_RENDERER_MAGIC(renderer, );
+    int i;
 
-    window_physical_x = (float)((logicalX * renderer->scale.x) + renderer->viewport.x);
-    window_physical_y = (float)((logicalY * renderer->scale.y) + renderer->viewport.y);
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (windowX) {
-        *windowX = (int)(window_physical_x * renderer->dpi_scale.x);
+    if (!rects) {
+        return SDL_InvalidParamError("SDL_RenderDrawRects(): rects");
     }
-    if (windowY) {
-        *windowY = (int)(window_physical_y * renderer->dpi_scale.y);
+    if (count < 1) {
+        return 0;
     }
-}
 
-int SDL_SetRenderDrawColor(SDL_Renderer *renderer,
-                           Uint8 r, Uint8 g, Uint8 b, Uint8 a)
-{
-    CHECK_RENDERER_MAGIC(renderer, -1);
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+#endif
 
-    renderer->color.r = r;
-    renderer->color.g = g;
-    renderer->color.b = b;
-    renderer->color.a = a;
+    for (i = 0; i < count; ++i) {
+        if (SDL_RenderDrawRect(renderer, &rects[i]) < 0) {
+            return -1;
+        }
+    }
     return 0;
 }
 
-int SDL_GetRenderDrawColor(SDL_Renderer *renderer,
-                           Uint8 *r, Uint8 *g, Uint8 *b, Uint8 *a)
+int SDL_RenderDrawRectsF(SDL_Renderer *renderer,
+                         const SDL_FRect *rects, int count)
 {
+    int i;
+
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (r) {
-        *r = renderer->color.r;
+    if (!rects) {
+        return SDL_InvalidParamError("SDL_RenderDrawRectsF(): rects");
     }
-    if (g) {
-        *g = renderer->color.g;
+    if (count < 1) {
+        return 0;
     }
-    if (b) {
-        *b = renderer->color.b;
+
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
     }
-    if (a) {
-        *a = renderer->color.a;
+#endif
+
+    for (i = 0; i < count; ++i) {
+        if (SDL_RenderDrawRectF(renderer, &rects[i]) < 0) {
+            return -1;
+        }
     }
     return 0;
 }
 
-int SDL_SetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+int SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect)
 {
+    SDL_FRect frect;
+
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!IsSupportedBlendMode(renderer, blendMode)) {
-        return SDL_Unsupported();
+    /* If 'rect' == NULL, then outline the whole surface */
+    if (rect) {
+        frect.x = (float)rect->x;
+        frect.y = (float)rect->y;
+        frect.w = (float)rect->w;
+        frect.h = (float)rect->h;
+    } else {
+        RenderGetViewportSize(renderer, &frect);
     }
-    renderer->blendMode = blendMode;
-    return 0;
+    return SDL_RenderFillRectsF(renderer, &frect, 1);
 }
 
-int SDL_GetRenderDrawBlendMode(SDL_Renderer *renderer, SDL_BlendMode *blendMode)
+int SDL_RenderFillRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
 {
+    SDL_FRect frect;
+
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    *blendMode = renderer->blendMode;
-    return 0;
+    /* If 'rect' == NULL, then outline the whole surface */
+    if (!rect) {
+        RenderGetViewportSize(renderer, &frect);
+        rect = &frect;
+    }
+    return SDL_RenderFillRectsF(renderer, rect, 1);
 }
 
-int SDL_RenderClear(SDL_Renderer *renderer)
+int SDL_RenderFillRects(SDL_Renderer *renderer,
+                        const SDL_Rect *rects, int count)
 {
+    SDL_FRect *frects;
+    int i;
     int retval;
+    SDL_bool isstack;
+
     CHECK_RENDERER_MAGIC(renderer, -1);
-    retval = QueueCmdClear(renderer);
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
-}
 
-/* !!! FIXME: delete all the duplicate code for the integer versions in 2.1,
-   !!! FIXME:  making the floating point versions the only available APIs. */
+    if (!rects) {
+        return SDL_InvalidParamError("SDL_RenderFillRects(): rects");
+    }
+    if (count < 1) {
+        return 0;
+    }
 
-int SDL_RenderDrawPoint(SDL_Renderer *renderer, int x, int y)
-{
-    SDL_FPoint fpoint;
-    fpoint.x = (float)x;
-    fpoint.y = (float)y;
-    return SDL_RenderDrawPointsF(renderer, &fpoint, 1);
-}
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+#endif
 
-int SDL_RenderDrawPointF(SDL_Renderer *renderer, float x, float y)
-{
-    SDL_FPoint fpoint;
-    fpoint.x = x;
-    fpoint.y = y;
-    return SDL_RenderDrawPointsF(renderer, &fpoint, 1);
+    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
+    if (!frects) {
+        return SDL_OutOfMemory();
+    }
+    for (i = 0; i < count; ++i) {
+        frects[i].x = rects[i].x * renderer->scale.x;
+        frects[i].y = rects[i].y * renderer->scale.y;
+        frects[i].w = rects[i].w * renderer->scale.x;
+        frects[i].h = rects[i].h * renderer->scale.y;
+    }
+
+    retval = QueueCmdFillRects(renderer, frects, count);
+
+    SDL_small_free(frects, isstack);
+
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-static int RenderDrawPointsWithRects(SDL_Renderer *renderer,
-                                     const SDL_Point *points, const int count)
+int SDL_RenderFillRectsF(SDL_Renderer *renderer,
+                         const SDL_FRect *rects, int count)
 {
-    int retval;
-    SDL_bool isstack;
     SDL_FRect *frects;
     int i;
+    int retval;
+    SDL_bool isstack;
+
+    CHECK_RENDERER_MAGIC(renderer, -1);
 
+    if (!rects) {
+        return SDL_InvalidParamError("SDL_RenderFillRectsF(): rects");
+    }
     if (count < 1) {
         return 0;
     }
 
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't draw while we're hidden */
+    if (renderer->hidden) {
+        return 0;
+    }
+#endif
+
     frects = SDL_small_alloc(SDL_FRect, count, &isstack);
     if (!frects) {
         return SDL_OutOfMemory();
     }
-
     for (i = 0; i < count; ++i) {
-        frects[i].x = points[i].x * renderer->scale.x;
-        frects[i].y = points[i].y * renderer->scale.y;
-        frects[i].w = renderer->scale.x;
-        frects[i].h = renderer->scale.y;
+        frects[i].x = rects[i].x * renderer->scale.x;
+        frects[i].y = rects[i].y * renderer->scale.y;
+        frects[i].w = rects[i].w * renderer->scale.x;
+        frects[i].h = rects[i].h * renderer->scale.y;
     }
 
     retval = QueueCmdFillRects(renderer, frects, count);
 
     SDL_small_free(frects, isstack);
 
-    return retval;
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-int SDL_RenderDrawPoints(SDL_Renderer *renderer,
-                         const SDL_Point *points, int count)
+/* Whether a draw with these bounds in render coordinates is entirely outside the
+   viewport, clip rect and drawn damage, using the pixel rectangles the backend clips to.
+   Culled draws are counted in the render stats. */
+static SDL_bool IsDrawCulled(SDL_Renderer *renderer, float minx, float miny, float maxx, float maxy)
 {
-    SDL_FPoint *fpoints;
-    int i;
+    double left, top, right, bottom;
+
+    if (!renderer->cull_draws) {
+        return SDL_FALSE;
+    }
+
+    left = 0.0;
+    top = 0.0;
+    right = SDL_floor(renderer->viewport.w);
+    bottom = SDL_floor(renderer->viewport.h);
+    if (renderer->clipping_enabled) {
+        const double clipx = SDL_floor(renderer->clip_rect.x);
+        const double clipy = SDL_floor(renderer->clip_rect.y);
+        left = SDL_max(left, clipx);
+        top = SDL_max(top, clipy);
+        right = SDL_min(right, clipx + SDL_floor(renderer->clip_rect.w));
+        bottom = SDL_min(bottom, clipy + SDL_floor(renderer->clip_rect.h));
+    }
+    if (renderer->damage_clipping && !renderer->target) {
+        const double damagex = renderer->damage_clip.x - SDL_floor(renderer->viewport.x);
+        const double damagey = renderer->damage_clip.y - SDL_floor(renderer->viewport.y);
+        left = SDL_max(left, damagex);
+        top = SDL_max(top, damagey);
+        right = SDL_min(right, damagex + renderer->damage_clip.w);
+        bottom = SDL_min(bottom, damagey + renderer->damage_clip.h);
+    }
+
+    if (minx * renderer->scale.x >= right || maxx * renderer->scale.x <= left ||
+        miny * renderer->scale.y >= bottom || maxy * renderer->scale.y <= top) {
+        ++renderer->stats.culled_draws;
+        return SDL_TRUE;
+    }
+    return SDL_FALSE;
+}
+
+int SDL_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture,
+                   const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+{
+    SDL_FRect dstfrect;
+    SDL_FRect *pdstfrect = NULL;
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+        pdstfrect = &dstfrect;
+    }
+    return SDL_RenderCopyF(renderer, texture, srcrect, pdstfrect);
+}
+
+int SDL_RenderCopyF(SDL_Renderer *renderer, SDL_Texture *texture,
+                    const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    SDL_Rect real_srcrect;
+    SDL_FRect real_dstrect;
     int retval;
-    SDL_bool isstack;
+    int use_rendergeometry;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
+    CHECK_TEXTURE_MAGIC(texture, -1);
 
-    if (!points) {
-        return SDL_InvalidParamError("SDL_RenderDrawPoints(): points");
-    }
-    if (count < 1) {
-        return 0;
+    if (renderer != texture->renderer) {
+        return SDL_SetError("Texture was not created with this renderer");
     }
 
 #if DONT_DRAW_WHILE_HIDDEN
@@ -2656,68 +5238,143 @@ int SDL_RenderDrawPoints(SDL_Renderer *renderer,
     }
 #endif
 
-    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
-        retval = RenderDrawPointsWithRects(renderer, points, count);
-    } else {
-        fpoints = SDL_small_alloc(SDL_FPoint, count, &isstack);
-        if (!fpoints) {
-            return SDL_OutOfMemory();
+    use_rendergeometry = (!renderer->QueueCopy);
+
+    real_srcrect.x = 0;
+    real_srcrect.y = 0;
+    real_srcrect.w = texture->w;
+    real_srcrect.h = texture->h;
+    if (srcrect) {
+        if (!SDL_IntersectRect(srcrect, &real_srcrect, &real_srcrect)) {
+            return 0;
         }
-        for (i = 0; i < count; ++i) {
-            fpoints[i].x = (float)points[i].x;
-            fpoints[i].y = (float)points[i].y;
+    }
+
+    RenderGetViewportSize(renderer, &real_dstrect);
+    if (dstrect) {
+        if (!SDL_HasIntersectionF(dstrect, &real_dstrect)) {
+            return 0;
         }
+        real_dstrect = *dstrect;
+    }
+    if (IsDrawCulled(renderer, real_dstrect.x, real_dstrect.y,
+                     real_dstrect.x + real_dstrect.w, real_dstrect.y + real_dstrect.h)) {
+        return 0;
+    }
+
+    if (texture->native) {
+        texture = texture->native;
+    }
+
+    if (UseTexture(renderer, texture) < 0) {
+        return -1;
+    }
+
+    if (use_rendergeometry) {
+        float xy[8];
+        const int xy_stride = 2 * sizeof(float);
+        float uv[8];
+        const int uv_stride = 2 * sizeof(float);
+        const int num_vertices = 4;
+        const int *indices = renderer->rect_index_order;
+        const int num_indices = 6;
+        const int size_indices = 4;
+        float minu, minv, maxu, maxv;
+        float minx, miny, maxx, maxy;
+
+        minu = (float)(real_srcrect.x) / (float)texture->w;
+        minv = (float)(real_srcrect.y) / (float)texture->h;
+        maxu = (float)(real_srcrect.x + real_srcrect.w) / (float)texture->w;
+        maxv = (float)(real_srcrect.y + real_srcrect.h) / (float)texture->h;
+
+        minx = real_dstrect.x;
+        miny = real_dstrect.y;
+        maxx = real_dstrect.x + real_dstrect.w;
+        maxy = real_dstrect.y + real_dstrect.h;
+
+        uv[0] = minu;
+        uv[1] = minv;
+        uv[2] = maxu;
+        uv[3] = minv;
+        uv[4] = maxu;
+        uv[5] = maxv;
+        uv[6] = minu;
+        uv[7] = maxv;
+
+        xy[0] = minx;
+        xy[1] = miny;
+        xy[2] = maxx;
+        xy[3] = miny;
+        xy[4] = maxx;
+        xy[5] = maxy;
+        xy[6] = minx;
+        xy[7] = maxy;
+
+        retval = QueueCmdGeometry(renderer, texture,
+                                  xy, xy_stride, &texture->color, 0 /* color_stride */, uv, uv_stride,
+                                  num_vertices,
+                                  indices, num_indices, size_indices,
+                                  renderer->scale.x, renderer->scale.y);
+    } else {
 
-        retval = QueueCmdDrawPoints(renderer, fpoints, count);
+        real_dstrect.x *= renderer->scale.x;
+        real_dstrect.y *= renderer->scale.y;
+        real_dstrect.w *= renderer->scale.x;
+        real_dstrect.h *= renderer->scale.y;
 
-        SDL_small_free(fpoints, isstack);
+        retval = QueueCmdCopy(renderer, texture, &real_srcrect, &real_dstrect);
     }
     return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-static int RenderDrawPointsWithRectsF(SDL_Renderer *renderer,
-                                      const SDL_FPoint *fpoints, const int count)
+int SDL_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
+                     const SDL_Rect *srcrect, const SDL_Rect *dstrect,
+                     const double angle, const SDL_Point *center, const SDL_RendererFlip flip)
 {
-    int retval;
-    SDL_bool isstack;
-    SDL_FRect *frects;
-    int i;
-
-    if (count < 1) {
-        return 0;
-    }
+    SDL_FRect dstfrect;
+    SDL_FRect *pdstfrect = NULL;
+    SDL_FPoint fcenter;
+    SDL_FPoint *pfcenter = NULL;
 
-    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
-    if (!frects) {
-        return SDL_OutOfMemory();
+    if (dstrect) {
+        dstfrect.x = (float)dstrect->x;
+        dstfrect.y = (float)dstrect->y;
+        dstfrect.w = (float)dstrect->w;
+        dstfrect.h = (float)dstrect->h;
+        pdstfrect = &dstfrect;
     }
 
-    for (i = 0; i < count; ++i) {
-        frects[i].x = fpoints[i].x * renderer->scale.x;
-        frects[i].y = fpoints[i].y * renderer->scale.y;
-        frects[i].w = renderer->scale.x;
-        frects[i].h = renderer->scale.y;
+    if (center) {
+        fcenter.x = (float)center->x;
+        fcenter.y = (float)center->y;
+        pfcenter = &fcenter;
     }
 
-    retval = QueueCmdFillRects(renderer, frects, count);
-
-    SDL_small_free(frects, isstack);
-
-    return retval;
+    return SDL_RenderCopyExF(renderer, texture, srcrect, pdstfrect, angle, pfcenter, flip);
 }
 
-int SDL_RenderDrawPointsF(SDL_Renderer *renderer,
-                          const SDL_FPoint *points, int count)
+int SDL_RenderCopyExF(SDL_Renderer *renderer, SDL_Texture *texture,
+                      const SDL_Rect *srcrect, const SDL_FRect *dstrect,
+                      const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
 {
+    SDL_Rect real_srcrect;
+    SDL_FRect real_dstrect;
+    SDL_FPoint real_center;
     int retval;
+    int use_rendergeometry;
+
+    if (flip == SDL_FLIP_NONE && (int)(angle / 360) == angle / 360) { /* fast path when we don't need rotation or flipping */
+        return SDL_RenderCopyF(renderer, texture, srcrect, dstrect);
+    }
 
     CHECK_RENDERER_MAGIC(renderer, -1);
+    CHECK_TEXTURE_MAGIC(texture, -1);
 
-    if (!points) {
-        return SDL_InvalidParamError("SDL_RenderDrawPointsF(): points");
+    if (renderer != texture->renderer) {
+        return SDL_SetError("Texture was not created with this renderer");
     }
-    if (count < 1) {
-        return 0;
+    if (!renderer->QueueCopyEx && !renderer->QueueGeometry) {
+        return SDL_SetError("Renderer does not support RenderCopyEx");
     }
 
 #if DONT_DRAW_WHILE_HIDDEN
@@ -2727,252 +5384,193 @@ int SDL_RenderDrawPointsF(SDL_Renderer *renderer,
     }
 #endif
 
-    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
-        retval = RenderDrawPointsWithRectsF(renderer, points, count);
-    } else {
-        retval = QueueCmdDrawPoints(renderer, points, count);
-    }
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
-}
-
-int SDL_RenderDrawLine(SDL_Renderer *renderer, int x1, int y1, int x2, int y2)
-{
-    SDL_FPoint points[2];
-    points[0].x = (float)x1;
-    points[0].y = (float)y1;
-    points[1].x = (float)x2;
-    points[1].y = (float)y2;
-    return SDL_RenderDrawLinesF(renderer, points, 2);
-}
-
-int SDL_RenderDrawLineF(SDL_Renderer *renderer, float x1, float y1, float x2, float y2)
-{
-    SDL_FPoint points[2];
-    points[0].x = x1;
-    points[0].y = y1;
-    points[1].x = x2;
-    points[1].y = y2;
-    return SDL_RenderDrawLinesF(renderer, points, 2);
-}
-
-static int RenderDrawLineBresenham(SDL_Renderer *renderer, int x1, int y1, int x2, int y2, SDL_bool draw_last)
-{
-    int i, deltax, deltay, numpixels;
-    int d, dinc1, dinc2;
-    int x, xinc1, xinc2;
-    int y, yinc1, yinc2;
-    int retval;
-    SDL_bool isstack;
-    SDL_FPoint *points;
-    SDL_Rect clip_rect;
+    use_rendergeometry = (!renderer->QueueCopyEx);
 
-    /* the backend might clip this further to the clipping rect, but we
-       just want a basic safety against generating millions of points for
-       massive lines. */
-    clip_rect.x = 0;
-    clip_rect.y = 0;
-    clip_rect.w = (int) renderer->viewport.w;
-    clip_rect.h = (int) renderer->viewport.h;
-    if (!SDL_IntersectRectAndLine(&clip_rect, &x1, &y1, &x2, &y2)) {
-        return 0;
+    real_srcrect.x = 0;
+    real_srcrect.y = 0;
+    real_srcrect.w = texture->w;
+    real_srcrect.h = texture->h;
+    if (srcrect) {
+        if (!SDL_IntersectRect(srcrect, &real_srcrect, &real_srcrect)) {
+            return 0;
+        }
     }
 
-    deltax = SDL_abs(x2 - x1);
-    deltay = SDL_abs(y2 - y1);
-
-    if (deltax >= deltay) {
-        numpixels = deltax + 1;
-        d = (2 * deltay) - deltax;
-        dinc1 = deltay * 2;
-        dinc2 = (deltay - deltax) * 2;
-        xinc1 = 1;
-        xinc2 = 1;
-        yinc1 = 0;
-        yinc2 = 1;
+    /* We don't intersect the dstrect with the viewport as RenderCopy does because of potential rotation clipping issues... TODO: should we? */
+    if (dstrect) {
+        real_dstrect = *dstrect;
     } else {
-        numpixels = deltay + 1;
-        d = (2 * deltax) - deltay;
-        dinc1 = deltax * 2;
-        dinc2 = (deltax - deltay) * 2;
-        xinc1 = 0;
-        xinc2 = 1;
-        yinc1 = 1;
-        yinc2 = 1;
-    }
-
-    if (x1 > x2) {
-        xinc1 = -xinc1;
-        xinc2 = -xinc2;
-    }
-    if (y1 > y2) {
-        yinc1 = -yinc1;
-        yinc2 = -yinc2;
-    }
-
-    x = x1;
-    y = y1;
-
-    if (!draw_last) {
-        --numpixels;
-    }
-
-    points = SDL_small_alloc(SDL_FPoint, numpixels, &isstack);
-    if (!points) {
-        return SDL_OutOfMemory();
+        RenderGetViewportSize(renderer, &real_dstrect);
     }
-    for (i = 0; i < numpixels; ++i) {
-        points[i].x = (float)x;
-        points[i].y = (float)y;
 
-        if (d < 0) {
-            d += dinc1;
-            x += xinc1;
-            y += yinc1;
-        } else {
-            d += dinc2;
-            x += xinc2;
-            y += yinc2;
-        }
+    if (texture->native) {
+        texture = texture->native;
     }
 
-    if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
-        retval = RenderDrawPointsWithRectsF(renderer, points, numpixels);
+    if (center) {
+        real_center = *center;
     } else {
-        retval = QueueCmdDrawPoints(renderer, points, numpixels);
-    }
-
-    SDL_small_free(points, isstack);
-
-    return retval;
-}
-
-static int RenderDrawLinesWithRectsF(SDL_Renderer *renderer,
-                                     const SDL_FPoint *points, const int count)
-{
-    const float scale_x = renderer->scale.x;
-    const float scale_y = renderer->scale.y;
-    SDL_FRect *frect;
-    SDL_FRect *frects;
-    int i, nrects = 0;
-    int retval = 0;
-    SDL_bool isstack;
-    SDL_bool drew_line = SDL_FALSE;
-    SDL_bool draw_last = SDL_FALSE;
-
-    frects = SDL_small_alloc(SDL_FRect, count - 1, &isstack);
-    if (!frects) {
-        return SDL_OutOfMemory();
+        real_center.x = real_dstrect.w / 2.0f;
+        real_center.y = real_dstrect.h / 2.0f;
     }
 
-    for (i = 0; i < count - 1; ++i) {
-        SDL_bool same_x = (points[i].x == points[i + 1].x);
-        SDL_bool same_y = (points[i].y == points[i + 1].y);
-
-        if (i == (count - 2)) {
-            if (!drew_line || points[i + 1].x != points[0].x || points[i + 1].y != points[0].y) {
-                draw_last = SDL_TRUE;
-            }
-        } else {
-            if (same_x && same_y) {
-                continue;
-            }
-        }
-        if (same_x) {
-            const float minY = SDL_min(points[i].y, points[i + 1].y);
-            const float maxY = SDL_max(points[i].y, points[i + 1].y);
-
-            frect = &frects[nrects++];
-            frect->x = points[i].x * scale_x;
-            frect->y = minY * scale_y;
-            frect->w = scale_x;
-            frect->h = (maxY - minY + draw_last) * scale_y;
-            if (!draw_last && points[i + 1].y < points[i].y) {
-                frect->y += scale_y;
-            }
-        } else if (same_y) {
-            const float minX = SDL_min(points[i].x, points[i + 1].x);
-            const float maxX = SDL_max(points[i].x, points[i + 1].x);
-
-            frect = &frects[nrects++];
-            frect->x = minX * scale_x;
-            frect->y = points[i].y * scale_y;
-            frect->w = (maxX - minX + draw_last) * scale_x;
-            frect->h = scale_y;
-            if (!draw_last && points[i + 1].x < points[i].x) {
-                frect->x += scale_x;
+    if (renderer->cull_draws) {
+        /* Cull using the bounds of the rotated corners */
+        const float radian_angle = (float)((M_PI * angle) / 180.0);
+        const float s = SDL_sinf(radian_angle);
+        const float c = SDL_cosf(radian_angle);
+        const float centerx = real_center.x + real_dstrect.x;
+        const float centery = real_center.y + real_dstrect.y;
+        float minx = 0.0f, miny = 0.0f, maxx = 0.0f, maxy = 0.0f;
+        int i;
+
+        for (i = 0; i < 4; ++i) {
+            const float dx = real_dstrect.x + ((i & 1) ? real_dstrect.w : 0.0f) - centerx;
+            const float dy = real_dstrect.y + ((i & 2) ? real_dstrect.h : 0.0f) - centery;
+            const float x = (c * dx - s * dy) + centerx;
+            const float y = (s * dx + c * dy) + centery;
+            if (i == 0 || x < minx) {
+                minx = x;
+            }
+            if (i == 0 || x > maxx) {
+                maxx = x;
+            }
+            if (i == 0 || y < miny) {
+                miny = y;
+            }
+            if (i == 0 || y > maxy) {
+                maxy = y;
             }
-        } else {
-            retval += RenderDrawLineBresenham(renderer, (int)SDL_roundf(points[i].x), (int)SDL_roundf(points[i].y),
-                                              (int)SDL_roundf(points[i + 1].x), (int)SDL_roundf(points[i + 1].y), draw_last);
         }
-        drew_line = SDL_TRUE;
+        if (IsDrawCulled(renderer, minx, miny, maxx, maxy)) {
+            return 0;
+        }
     }
 
-    if (nrects) {
-        retval += QueueCmdFillRects(renderer, frects, nrects);
+    if (UseTexture(renderer, texture) < 0) {
+        return -1;
     }
 
-    SDL_small_free(frects, isstack);
+    if (use_rendergeometry) {
+        float xy[8];
+        const int xy_stride = 2 * sizeof(float);
+        float uv[8];
+        const int uv_stride = 2 * sizeof(float);
+        const int num_vertices = 4;
+        const int *indices = renderer->rect_index_order;
+        const int num_indices = 6;
+        const int size_indices = 4;
+        float minu, minv, maxu, maxv;
+        float minx, miny, maxx, maxy;
+        float centerx, centery;
 
-    if (retval < 0) {
-        retval = -1;
-    }
-    return retval;
-}
+        float s_minx, s_miny, s_maxx, s_maxy;
+        float c_minx, c_miny, c_maxx, c_maxy;
 
-int SDL_RenderDrawLines(SDL_Renderer *renderer,
-                        const SDL_Point *points, int count)
-{
-    SDL_FPoint *fpoints;
-    int i;
-    int retval;
-    SDL_bool isstack;
+        const float radian_angle = (float)((M_PI * angle) / 180.0);
+        const float s = SDL_sinf(radian_angle);
+        const float c = SDL_cosf(radian_angle);
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+        minu = (float)(real_srcrect.x) / (float)texture->w;
+        minv = (float)(real_srcrect.y) / (float)texture->h;
+        maxu = (float)(real_srcrect.x + real_srcrect.w) / (float)texture->w;
+        maxv = (float)(real_srcrect.y + real_srcrect.h) / (float)texture->h;
 
-    if (!points) {
-        return SDL_InvalidParamError("SDL_RenderDrawLines(): points");
-    }
-    if (count < 2) {
-        return 0;
-    }
+        centerx = real_center.x + real_dstrect.x;
+        centery = real_center.y + real_dstrect.y;
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
-    }
-#endif
+        if (flip & SDL_FLIP_HORIZONTAL) {
+            minx = real_dstrect.x + real_dstrect.w;
+            maxx = real_dstrect.x;
+        } else {
+            minx = real_dstrect.x;
+            maxx = real_dstrect.x + real_dstrect.w;
+        }
 
-    fpoints = SDL_small_alloc(SDL_FPoint, count, &isstack);
-    if (!fpoints) {
-        return SDL_OutOfMemory();
-    }
+        if (flip & SDL_FLIP_VERTICAL) {
+            miny = real_dstrect.y + real_dstrect.h;
+            maxy = real_dstrect.y;
+        } else {
+            miny = real_dstrect.y;
+            maxy = real_dstrect.y + real_dstrect.h;
+        }
 
-    for (i = 0; i < count; ++i) {
-        fpoints[i].x = (float)points[i].x;
-        fpoints[i].y = (float)points[i].y;
-    }
+        uv[0] = minu;
+        uv[1] = minv;
+        uv[2] = maxu;
+        uv[3] = minv;
+        uv[4] = maxu;
+        uv[5] = maxv;
+        uv[6] = minu;
+        uv[7] = maxv;
 
-    retval = SDL_RenderDrawLinesF(renderer, fpoints, count);
+        /* apply rotation with 2x2 matrix ( c -s )
+         *                                ( s  c ) */
+        s_minx = s * (minx - centerx);
+        s_miny = s * (miny - centery);
+        s_maxx = s * (maxx - centerx);
+        s_maxy = s * (maxy - centery);
+        c_minx = c * (minx - centerx);
+        c_miny = c * (miny - centery);
+        c_maxx = c * (maxx - centerx);
+        c_maxy = c * (maxy - centery);
 
-    SDL_small_free(fpoints, isstack);
+        /* (minx, miny) */
+        xy[0] = (c_minx - s_miny) + centerx;
+        xy[1] = (s_minx + c_miny) + centery;
+        /* (maxx, miny) */
+        xy[2] = (c_maxx - s_miny) + centerx;
+        xy[3] = (s_maxx + c_miny) + centery;
+        /* (maxx, maxy) */
+        xy[4] = (c_maxx - s_maxy) + centerx;
+        xy[5] = (s_maxx + c_maxy) + centery;
+        /* (minx, maxy) */
+        xy[6] = (c_minx - s_maxy) + centerx;
+        xy[7] = (s_minx + c_maxy) + centery;
 
-    return retval;
+        retval = QueueCmdGeometry(renderer, texture,
+                                  xy, xy_stride, &texture->color, 0 /* color_stride */, uv, uv_stride,
+                                  num_vertices,
+                                  indices, num_indices, size_indices,
+                                  renderer->scale.x, renderer->scale.y);
+    } else {
+
+        retval = QueueCmdCopyEx(renderer, texture, &real_srcrect, &real_dstrect, angle, &real_center, flip, renderer->scale.x, renderer->scale.y);
+    }
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-int SDL_RenderDrawLinesF(SDL_Renderer *renderer,
-                         const SDL_FPoint *points, int count)
-{
+int SDL_RenderCopyBatch(SDL_Renderer *renderer, SDL_Texture *texture,
+                        const SDL_Rect *srcrects, const SDL_FRect *dstrects,
+                        const double *angles, const SDL_RendererFlip *flips,
+                        const SDL_Color *colors, int count)
+{
+    const int xy_stride = 2 * sizeof(float);
+    const int uv_stride = 2 * sizeof(float);
+    const int *rect_index_order;
+    float texw, texh;
+    Uint8 *buffer;
+    float *xy, *uv;
+    int *indices;
+    SDL_Color *vertex_colors;
+    size_t size;
+    int i, num_sprites = 0;
     int retval = 0;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
+    CHECK_TEXTURE_MAGIC(texture, -1);
 
-    if (!points) {
-        return SDL_InvalidParamError("SDL_RenderDrawLinesF(): points");
+    if (renderer != texture->renderer) {
+        return SDL_SetError("Texture was not created with this renderer");
     }
-    if (count < 2) {
-        return 0;
+    if (!renderer->QueueGeometry) {
+        return SDL_Unsupported();
+    }
+    if (!dstrects) {
+        return SDL_InvalidParamError("dstrects");
+    }
+    if (count < 0 || count > SDL_MAX_SINT32 / 6) {
+        return SDL_InvalidParamError("count");
     }
 
 #if DONT_DRAW_WHILE_HIDDEN
@@ -2982,220 +5580,297 @@ int SDL_RenderDrawLinesF(SDL_Renderer *renderer,
     }
 #endif
 
-    if (renderer->line_method == SDL_RENDERLINEMETHOD_POINTS) {
-        retval = RenderDrawLinesWithRectsF(renderer, points, count);
-    } else if (renderer->line_method == SDL_RENDERLINEMETHOD_GEOMETRY) {
-        SDL_bool isstack1;
-        SDL_bool isstack2;
-        const float scale_x = renderer->scale.x;
-        const float scale_y = renderer->scale.y;
-        float *xy = SDL_small_alloc(float, 4 * 2 * count, &isstack1);
-        int *indices = SDL_small_alloc(int,
-                                       (4) * 3 * (count - 1) + (2) * 3 * (count), &isstack2);
-
-        if (xy && indices) {
-            int i;
-            float *ptr_xy = xy;
-            int *ptr_indices = indices;
-            const int xy_stride = 2 * sizeof(float);
-            int num_vertices = 4 * count;
-            int num_indices = 0;
-            const int size_indices = 4;
-            int cur_index = -4;
-            const int is_looping = (points[0].x == points[count - 1].x && points[0].y == points[count - 1].y);
-            SDL_FPoint p; /* previous point */
-            p.x = p.y = 0.0f;
-            /*       p            q
-
-                    0----1------ 4----5
-                    | \  |``\    | \  |
-                    |  \ |   ` `\|  \ |
-                    3----2-------7----6
-            */
-            for (i = 0; i < count; ++i) {
-                SDL_FPoint q = points[i]; /* current point */
-
-                q.x *= scale_x;
-                q.y *= scale_y;
-
-                *ptr_xy++ = q.x;
-                *ptr_xy++ = q.y;
-                *ptr_xy++ = q.x + scale_x;
-                *ptr_xy++ = q.y;
-                *ptr_xy++ = q.x + scale_x;
-                *ptr_xy++ = q.y + scale_y;
-                *ptr_xy++ = q.x;
-                *ptr_xy++ = q.y + scale_y;
+    if (count == 0) {
+        return 0;
+    }
 
-#define ADD_TRIANGLE(i1, i2, i3)     \
-    *ptr_indices++ = cur_index + i1; \
-    *ptr_indices++ = cur_index + i2; \
-    *ptr_indices++ = cur_index + i3; \
-    num_indices += 3;
+    /* Every sprite is a quad: 4 vertices and 6 indices */
+    size = (size_t)count * (4 * xy_stride + 4 * uv_stride + 6 * sizeof(int) +
+                            (colors ? 4 * sizeof(SDL_Color) : 0));
+    if (size > renderer->batch_data_allocation) {
+        buffer = (Uint8 *)SDL_realloc(renderer->batch_data, size);
+        if (!buffer) {
+            return SDL_OutOfMemory();
+        }
+        renderer->batch_data = buffer;
+        renderer->batch_data_allocation = size;
+    }
+    buffer = (Uint8 *)renderer->batch_data;
+    xy = (float *)buffer;
+    uv = xy + 8 * count;
+    indices = (int *)(uv + 8 * count);
+    vertex_colors = (SDL_Color *)(indices + 6 * count);
 
-                /* closed polyline, don´t draw twice the point */
-                if (i || is_looping == 0) {
-                    ADD_TRIANGLE(4, 5, 6)
-                    ADD_TRIANGLE(4, 6, 7)
-                }
+    if (texture->native) {
+        texture = texture->native;
+    }
+    texw = (float)texture->w;
+    texh = (float)texture->h;
+    rect_index_order = renderer->rect_index_order;
 
-                /* first point only, no segment */
-                if (i == 0) {
-                    p = q;
-                    cur_index += 4;
-                    continue;
-                }
+    for (i = 0; i < count; ++i) {
+        const SDL_FRect *dstrect = &dstrects[i];
+        float *sprite_xy = xy + 8 * num_sprites;
+        float *sprite_uv = uv + 8 * num_sprites;
+        int *sprite_indices = indices + 6 * num_sprites;
+        const int first_index = 4 * num_sprites;
+        int srcx0, srcy0, srcx1, srcy1;
+        float minu, minv, maxu, maxv;
+        float minx, miny, maxx, maxy;
 
-                /* draw segment */
-                if (p.y == q.y) {
-                    if (p.x < q.x) {
-                        ADD_TRIANGLE(1, 4, 7)
-                        ADD_TRIANGLE(1, 7, 2)
-                    } else {
-                        ADD_TRIANGLE(5, 0, 3)
-                        ADD_TRIANGLE(5, 3, 6)
-                    }
-                } else if (p.x == q.x) {
-                    if (p.y < q.y) {
-                        ADD_TRIANGLE(2, 5, 4)
-                        ADD_TRIANGLE(2, 4, 3)
-                    } else {
-                        ADD_TRIANGLE(6, 1, 0)
-                        ADD_TRIANGLE(6, 0, 7)
-                    }
-                } else {
-                    if (p.y < q.y) {
-                        if (p.x < q.x) {
-                            ADD_TRIANGLE(1, 5, 4)
-                            ADD_TRIANGLE(1, 4, 2)
-                            ADD_TRIANGLE(2, 4, 7)
-                            ADD_TRIANGLE(2, 7, 3)
-                        } else {
-                            ADD_TRIANGLE(4, 0, 5)
-                            ADD_TRIANGLE(5, 0, 3)
-                            ADD_TRIANGLE(5, 3, 6)
-                            ADD_TRIANGLE(6, 3, 2)
-                        }
-                    } else {
-                        if (p.x < q.x) {
-                            ADD_TRIANGLE(0, 4, 7)
-                            ADD_TRIANGLE(0, 7, 1)
-                            ADD_TRIANGLE(1, 7, 6)
-                            ADD_TRIANGLE(1, 6, 2)
-                        } else {
-                            ADD_TRIANGLE(6, 5, 1)
-                            ADD_TRIANGLE(6, 1, 0)
-                            ADD_TRIANGLE(7, 6, 0)
-                            ADD_TRIANGLE(7, 0, 3)
-                        }
-                    }
-                }
+        if (srcrects) {
+            srcx0 = SDL_max(srcrects[i].x, 0);
+            srcy0 = SDL_max(srcrects[i].y, 0);
+            srcx1 = SDL_min(srcrects[i].x + srcrects[i].w, texture->w);
+            srcy1 = SDL_min(srcrects[i].y + srcrects[i].h, texture->h);
+            if (srcx1 <= srcx0 || srcy1 <= srcy0) {
+                continue;
+            }
+        } else {
+            srcx0 = 0;
+            srcy0 = 0;
+            srcx1 = texture->w;
+            srcy1 = texture->h;
+        }
 
-                p = q;
-                cur_index += 4;
+        minu = (float)srcx0 / texw;
+        minv = (float)srcy0 / texh;
+        maxu = (float)srcx1 / texw;
+        maxv = (float)srcy1 / texh;
+
+        minx = dstrect->x;
+        miny = dstrect->y;
+        maxx = dstrect->x + dstrect->w;
+        maxy = dstrect->y + dstrect->h;
+
+        if (flips) {
+            if (flips[i] & SDL_FLIP_HORIZONTAL) {
+                const float tmp = minx;
+                minx = maxx;
+                maxx = tmp;
             }
+            if (flips[i] & SDL_FLIP_VERTICAL) {
+                const float tmp = miny;
+                miny = maxy;
+                maxy = tmp;
+            }
+        }
 
-            retval = QueueCmdGeometry(renderer, NULL,
-                                      xy, xy_stride, &renderer->color, 0 /* color_stride */, NULL, 0,
-                                      num_vertices, indices, num_indices, size_indices,
-                                      1.0f, 1.0f);
+        sprite_uv[0] = minu;
+        sprite_uv[1] = minv;
+        sprite_uv[2] = maxu;
+        sprite_uv[3] = minv;
+        sprite_uv[4] = maxu;
+        sprite_uv[5] = maxv;
+        sprite_uv[6] = minu;
+        sprite_uv[7] = maxv;
+
+        if (angles && angles[i] != 0.0) {
+            /* apply rotation around the center of dstrect, same as SDL_RenderCopyExF() */
+            const float radian_angle = (float)((M_PI * angles[i]) / 180.0);
+            const float s = SDL_sinf(radian_angle);
+            const float c = SDL_cosf(radian_angle);
+            const float centerx = dstrect->x + dstrect->w / 2.0f;
+            const float centery = dstrect->y + dstrect->h / 2.0f;
+
+            minx -= centerx;
+            miny -= centery;
+            maxx -= centerx;
+            maxy -= centery;
+
+            sprite_xy[0] = (c * minx - s * miny) + centerx;
+            sprite_xy[1] = (s * minx + c * miny) + centery;
+            sprite_xy[2] = (c * maxx - s * miny) + centerx;
+            sprite_xy[3] = (s * maxx + c * miny) + centery;
+            sprite_xy[4] = (c * maxx - s * maxy) + centerx;
+            sprite_xy[5] = (s * maxx + c * maxy) + centery;
+            sprite_xy[6] = (c * minx - s * maxy) + centerx;
+            sprite_xy[7] = (s * minx + c * maxy) + centery;
+        } else {
+            sprite_xy[0] = minx;
+            sprite_xy[1] = miny;
+            sprite_xy[2] = maxx;
+            sprite_xy[3] = miny;
+            sprite_xy[4] = maxx;
+            sprite_xy[5] = maxy;
+            sprite_xy[6] = minx;
+            sprite_xy[7] = maxy;
         }
 
-        SDL_small_free(xy, isstack1);
-        SDL_small_free(indices, isstack2);
+        if (renderer->cull_draws &&
+            IsDrawCulled(renderer,
+                         SDL_min(SDL_min(sprite_xy[0], sprite_xy[2]), SDL_min(sprite_xy[4], sprite_xy[6])),
+                         SDL_min(SDL_min(sprite_xy[1], sprite_xy[3]), SDL_min(sprite_xy[5], sprite_xy[7])),
+                         SDL_max(SDL_max(sprite_xy[0], sprite_xy[2]), SDL_max(sprite_xy[4], sprite_xy[6])),
+                         SDL_max(SDL_max(sprite_xy[1], sprite_xy[3]), SDL_max(sprite_xy[5], sprite_xy[7])))) {
+            continue;
+        }
 
-    } else if (renderer->scale.x != 1.0f || renderer->scale.y != 1.0f) {
-        retval = RenderDrawLinesWithRectsF(renderer, points, count);
-    } else {
-        retval = QueueCmdDrawLines(renderer, points, count);
+        if (colors) {
+            SDL_Color *sprite_colors = vertex_colors + 4 * num_sprites;
+            sprite_colors[0] = colors[i];
+            sprite_colors[1] = colors[i];
+            sprite_colors[2] = colors[i];
+            sprite_colors[3] = colors[i];
+        }
+
+        sprite_indices[0] = first_index + rect_index_order[0];
+        sprite_indices[1] = first_index + rect_index_order[1];
+        sprite_indices[2] = first_index + rect_index_order[2];
+        sprite_indices[3] = first_index + rect_index_order[3];
+        sprite_indices[4] = first_index + rect_index_order[4];
+        sprite_indices[5] = first_index + rect_index_order[5];
+        ++num_sprites;
+    }
+
+    if (num_sprites > 0 && UseTexture(renderer, texture) < 0) {
+        retval = -1;
+    } else if (num_sprites > 0) {
+        if (colors) {
+            retval = QueueCmdGeometry(renderer, texture,
+                                      xy, xy_stride, vertex_colors, sizeof(SDL_Color), uv, uv_stride,
+                                      4 * num_sprites,
+                                      indices, 6 * num_sprites, sizeof(int),
+                                      renderer->scale.x, renderer->scale.y);
+        } else {
+            retval = QueueCmdGeometry(renderer, texture,
+                                      xy, xy_stride, &texture->color, 0 /* color_stride */, uv, uv_stride,
+                                      4 * num_sprites,
+                                      indices, 6 * num_sprites, sizeof(int),
+                                      renderer->scale.x, renderer->scale.y);
+        }
     }
 
     return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
 }
 
-int SDL_RenderDrawRect(SDL_Renderer *renderer, const SDL_Rect *rect)
+int SDL_RenderGeometry(SDL_Renderer *renderer,
+                       SDL_Texture *texture,
+                       const SDL_Vertex *vertices, int num_vertices,
+                       const int *indices, int num_indices)
 {
-    SDL_FRect frect;
-    SDL_FRect *prect = NULL;
-
-    if (rect) {
-        frect.x = (float)rect->x;
-        frect.y = (float)rect->y;
-        frect.w = (float)rect->w;
-        frect.h = (float)rect->h;
-        prect = &frect;
+    if (vertices) {
+        const float *xy = &vertices->position.x;
+        int xy_stride = sizeof(SDL_Vertex);
+        const SDL_Color *color = &vertices->color;
+        int color_stride = sizeof(SDL_Vertex);
+        const float *uv = &vertices->tex_coord.x;
+        int uv_stride = sizeof(SDL_Vertex);
+        int size_indices = 4;
+        return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    } else {
+        return SDL_InvalidParamError("vertices");
     }
-
-    return SDL_RenderDrawRectF(renderer, prect);
 }
 
-int SDL_RenderDrawRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
+static int remap_one_indice(
+    int prev,
+    int k,
+    SDL_Texture *texture,
+    const float *xy, int xy_stride,
+    const SDL_Color *color, int color_stride,
+    const float *uv, int uv_stride)
 {
-    SDL_FRect frect;
-    SDL_FPoint points[5];
+    const float *xy0_, *xy1_, *uv0_, *uv1_;
+    int col0_, col1_;
+    xy0_ = (const float *)((const char *)xy + prev * xy_stride);
+    xy1_ = (const float *)((const char *)xy + k * xy_stride);
+    if (xy0_[0] != xy1_[0]) {
+        return k;
+    }
+    if (xy0_[1] != xy1_[1]) {
+        return k;
+    }
+    if (texture) {
+        uv0_ = (const float *)((const char *)uv + prev * uv_stride);
+        uv1_ = (const float *)((const char *)uv + k * uv_stride);
+        if (uv0_[0] != uv1_[0]) {
+            return k;
+        }
+        if (uv0_[1] != uv1_[1]) {
+            return k;
+        }
+    }
+    col0_ = *(const int *)((const char *)color + prev * color_stride);
+    col1_ = *(const int *)((const char *)color + k * color_stride);
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    if (col0_ != col1_) {
+        return k;
+    }
 
-    /* If 'rect' == NULL, then outline the whole surface */
-    if (!rect) {
-        RenderGetViewportSize(renderer, &frect);
-        rect = &frect;
+    return prev;
+}
+
+static int remap_indices(
+    int prev[3],
+    int k,
+    SDL_Texture *texture,
+    const float *xy, int xy_stride,
+    const SDL_Color *color, int color_stride,
+    const float *uv, int uv_stride)
+{
+    int i;
+    if (prev[0] == -1) {
+        return k;
     }
 
-    points[0].x = rect->x;
-    points[0].y = rect->y;
-    points[1].x = rect->x + rect->w - 1;
-    points[1].y = rect->y;
-    points[2].x = rect->x + rect->w - 1;
-    points[2].y = rect->y + rect->h - 1;
-    points[3].x = rect->x;
-    points[3].y = rect->y + rect->h - 1;
-    points[4].x = rect->x;
-    points[4].y = rect->y;
-    return SDL_RenderDrawLinesF(renderer, points, 5);
+    for (i = 0; i < 3; i++) {
+        int new_k = remap_one_indice(prev[i], k, texture, xy, xy_stride, color, color_stride, uv, uv_stride);
+        if (new_k != k) {
+            return new_k;
+        }
+    }
+    return k;
 }
 
-int SDL_RenderDrawRects(SDL_Renderer *renderer,
-                        const SDL_Rect *rects, int count)
+int SDL_RenderGeometryRaw(SDL_Renderer *renderer,
+                          SDL_Texture *texture,
+                          const float *xy, int xy_stride,
+                          const SDL_Color *color, int color_stride,
+                          const float *uv, int uv_stride,
+                          int num_vertices,
+                          const void *indices, int num_indices, int size_indices)
 {
     int i;
+    int retval = 0;
+    int count = indices ? num_indices : num_vertices;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!rects) {
-        return SDL_InvalidParamError("SDL_RenderDrawRects(): rects");
-    }
-    if (count < 1) {
-        return 0;
+    if (!renderer->QueueGeometry) {
+        return SDL_Unsupported();
     }
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
-    }
-#endif
+    if (texture) {
+        CHECK_TEXTURE_MAGIC(texture, -1);
 
-    for (i = 0; i < count; ++i) {
-        if (SDL_RenderDrawRect(renderer, &rects[i]) < 0) {
-            return -1;
+        if (renderer != texture->renderer) {
+            return SDL_SetError("Texture was not created with this renderer");
         }
     }
-    return 0;
-}
 
-int SDL_RenderDrawRectsF(SDL_Renderer *renderer,
-                         const SDL_FRect *rects, int count)
-{
-    int i;
+    if (!xy) {
+        return SDL_InvalidParamError("xy");
+    }
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    if (!color) {
+        return SDL_InvalidParamError("color");
+    }
 
-    if (!rects) {
-        return SDL_InvalidParamError("SDL_RenderDrawRectsF(): rects");
+    if (texture && !uv) {
+        return SDL_InvalidParamError("uv");
     }
-    if (count < 1) {
-        return 0;
+
+    if (count % 3 != 0) {
+        return SDL_InvalidParamError(indices ? "num_indices" : "num_vertices");
+    }
+
+    if (indices) {
+        if (size_indices != 1 && size_indices != 2 && size_indices != 4) {
+            return SDL_InvalidParamError("size_indices");
+        }
+    } else {
+        size_indices = 0;
     }
 
 #if DONT_DRAW_WHILE_HIDDEN
@@ -3205,555 +5880,838 @@ int SDL_RenderDrawRectsF(SDL_Renderer *renderer,
     }
 #endif
 
-    for (i = 0; i < count; ++i) {
-        if (SDL_RenderDrawRectF(renderer, &rects[i]) < 0) {
-            return -1;
+    if (num_vertices < 3) {
+        return 0;
+    }
+
+    if (texture && texture->native) {
+        texture = texture->native;
+    }
+
+    if (texture) {
+        for (i = 0; i < num_vertices; ++i) {
+            const float *uv_ = (const float *)((const char *)uv + i * uv_stride);
+            float u = uv_[0];
+            float v = uv_[1];
+            if (u < 0.0f || v < 0.0f || u > 1.0f || v > 1.0f) {
+                return SDL_SetError("Values of 'uv' out of bounds %f %f at %d/%d", u, v, i, num_vertices);
+            }
         }
     }
-    return 0;
-}
 
-int SDL_RenderFillRect(SDL_Renderer *renderer, const SDL_Rect *rect)
-{
-    SDL_FRect frect;
+    if (indices) {
+        for (i = 0; i < num_indices; ++i) {
+            int j;
+            if (size_indices == 4) {
+                j = ((const Uint32 *)indices)[i];
+            } else if (size_indices == 2) {
+                j = ((const Uint16 *)indices)[i];
+            } else {
+                j = ((const Uint8 *)indices)[i];
+            }
+            if (j < 0 || j >= num_vertices) {
+                return SDL_SetError("Values of 'indices' out of bounds");
+            }
+        }
+    }
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    if (renderer->cull_draws) {
+        /* Cull using the bounds of all the vertices */
+        float minx = xy[0], miny = xy[1], maxx = xy[0], maxy = xy[1];
 
-    /* If 'rect' == NULL, then outline the whole surface */
-    if (rect) {
-        frect.x = (float)rect->x;
-        frect.y = (float)rect->y;
-        frect.w = (float)rect->w;
-        frect.h = (float)rect->h;
-    } else {
-        RenderGetViewportSize(renderer, &frect);
+        for (i = 1; i < num_vertices; ++i) {
+            const float *xy_ = (const float *)((const char *)xy + i * xy_stride);
+            minx = SDL_min(minx, xy_[0]);
+            miny = SDL_min(miny, xy_[1]);
+            maxx = SDL_max(maxx, xy_[0]);
+            maxy = SDL_max(maxy, xy_[1]);
+        }
+        if (IsDrawCulled(renderer, minx, miny, maxx, maxy)) {
+            return 0;
+        }
     }
-    return SDL_RenderFillRectsF(renderer, &frect, 1);
-}
 
-int SDL_RenderFillRectF(SDL_Renderer *renderer, const SDL_FRect *rect)
-{
-    SDL_FRect frect;
+    if (texture && UseTexture(renderer, texture) < 0) {
+        return -1;
+    }
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    retval = QueueCmdGeometry(renderer, texture,
+                              xy, xy_stride, color, color_stride, uv, uv_stride,
+                              num_vertices,
+                              indices, num_indices, size_indices,
+                              renderer->scale.x, renderer->scale.y);
 
-    /* If 'rect' == NULL, then outline the whole surface */
-    if (!rect) {
-        RenderGetViewportSize(renderer, &frect);
-        rect = &frect;
+    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+}
+
+static SDL_bool GetReadPixelsRect(SDL_Renderer *renderer, const SDL_Rect *rect, SDL_Rect *real_rect)
+{
+    real_rect->x = (int)SDL_floor(renderer->viewport.x);
+    real_rect->y = (int)SDL_floor(renderer->viewport.y);
+    real_rect->w = (int)SDL_floor(renderer->viewport.w);
+    real_rect->h = (int)SDL_floor(renderer->viewport.h);
+    if (rect) {
+        return SDL_IntersectRect(rect, real_rect, real_rect);
     }
-    return SDL_RenderFillRectsF(renderer, rect, 1);
+    return SDL_TRUE;
 }
 
-int SDL_RenderFillRects(SDL_Renderer *renderer,
-                        const SDL_Rect *rects, int count)
+int SDL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
+                         Uint32 format, void *pixels, int pitch)
 {
-    SDL_FRect *frects;
-    int i;
-    int retval;
-    SDL_bool isstack;
+    SDL_Rect real_rect;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!rects) {
-        return SDL_InvalidParamError("SDL_RenderFillRects(): rects");
+    if (!renderer->RenderReadPixels) {
+        return SDL_Unsupported();
     }
-    if (count < 1) {
-        return 0;
+
+    if (renderer->recording_command_list) {
+        return SDL_SetError("Can't read pixels while recording a command list");
     }
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
+    FlushRenderCommandsWithReason(renderer, &renderer->stats.read_pixels_flushes); /* we need to render before we read the results. */
+
+    if (!format) {
+        if (!renderer->target) {
+            format = SDL_GetWindowPixelFormat(renderer->window);
+        } else {
+            format = renderer->target->format;
+        }
     }
-#endif
 
-    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
-    if (!frects) {
-        return SDL_OutOfMemory();
+    if (!GetReadPixelsRect(renderer, rect, &real_rect)) {
+        return 0;
     }
-    for (i = 0; i < count; ++i) {
-        frects[i].x = rects[i].x * renderer->scale.x;
-        frects[i].y = rects[i].y * renderer->scale.y;
-        frects[i].w = rects[i].w * renderer->scale.x;
-        frects[i].h = rects[i].h * renderer->scale.y;
+    if (rect) {
+        if (real_rect.y > rect->y) {
+            pixels = (Uint8 *)pixels + pitch * (real_rect.y - rect->y);
+        }
+        if (real_rect.x > rect->x) {
+            int bpp = SDL_BYTESPERPIXEL(format);
+            pixels = (Uint8 *)pixels + bpp * (real_rect.x - rect->x);
+        }
     }
 
-    retval = QueueCmdFillRects(renderer, frects, count);
-
-    SDL_small_free(frects, isstack);
-
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+    return renderer->RenderReadPixels(renderer, &real_rect,
+                                      format, pixels, pitch);
 }
 
-int SDL_RenderFillRectsF(SDL_Renderer *renderer,
-                         const SDL_FRect *rects, int count)
+int SDL_RenderReadPixelsAsync(SDL_Renderer *renderer, const SDL_Rect *rect, Uint32 format,
+                              SDL_RenderReadPixelsCallback callback, void *userdata)
 {
-    SDL_FRect *frects;
-    int i;
+    SDL_Rect real_rect;
+    void *pixels;
+    int pitch;
     int retval;
-    SDL_bool isstack;
 
     CHECK_RENDERER_MAGIC(renderer, -1);
 
-    if (!rects) {
-        return SDL_InvalidParamError("SDL_RenderFillRectsF(): rects");
-    }
-    if (count < 1) {
-        return 0;
+    if (!callback) {
+        return SDL_InvalidParamError("callback");
     }
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
+    if (!renderer->RenderReadPixelsAsync && !renderer->RenderReadPixels) {
+        return SDL_Unsupported();
     }
-#endif
 
-    frects = SDL_small_alloc(SDL_FRect, count, &isstack);
-    if (!frects) {
-        return SDL_OutOfMemory();
+    if (renderer->recording_command_list) {
+        return SDL_SetError("Can't read pixels while recording a command list");
     }
-    for (i = 0; i < count; ++i) {
-        frects[i].x = rects[i].x * renderer->scale.x;
-        frects[i].y = rects[i].y * renderer->scale.y;
-        frects[i].w = rects[i].w * renderer->scale.x;
-        frects[i].h = rects[i].h * renderer->scale.y;
+
+    FlushRenderCommandsWithReason(renderer, &renderer->stats.read_pixels_flushes); /* we need to render before we read the results. */
+
+    if (!format) {
+        if (!renderer->target) {
+            format = SDL_GetWindowPixelFormat(renderer->window);
+        } else {
+            format = renderer->target->format;
+        }
     }
 
-    retval = QueueCmdFillRects(renderer, frects, count);
+    if (!GetReadPixelsRect(renderer, rect, &real_rect) || real_rect.w == 0 || real_rect.h == 0) {
+        return 0; /* nothing to do. */
+    }
 
-    SDL_small_free(frects, isstack);
+    if (renderer->RenderReadPixelsAsync) {
+        return renderer->RenderReadPixelsAsync(renderer, &real_rect, format, callback, userdata);
+    }
 
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+    /* Read the pixels right away */
+    pitch = real_rect.w * SDL_BYTESPERPIXEL(format);
+    pixels = SDL_malloc((size_t)real_rect.h * pitch);
+    if (!pixels) {
+        return SDL_OutOfMemory();
+    }
+    retval = renderer->RenderReadPixels(renderer, &real_rect, format, pixels, pitch);
+    if (retval == 0) {
+        callback(userdata, &real_rect, format, pixels, pitch);
+    }
+    SDL_free(pixels);
+    return retval;
 }
 
-int SDL_RenderCopy(SDL_Renderer *renderer, SDL_Texture *texture,
-                   const SDL_Rect *srcrect, const SDL_Rect *dstrect)
+int SDL_RenderPollReadPixels(SDL_Renderer *renderer, SDL_bool wait)
 {
-    SDL_FRect dstfrect;
-    SDL_FRect *pdstfrect = NULL;
-    if (dstrect) {
-        dstfrect.x = (float)dstrect->x;
-        dstfrect.y = (float)dstrect->y;
-        dstfrect.w = (float)dstrect->w;
-        dstfrect.h = (float)dstrect->h;
-        pdstfrect = &dstfrect;
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!renderer->PollReadPixels) {
+        return 0;
     }
-    return SDL_RenderCopyF(renderer, texture, srcrect, pdstfrect);
+    WaitRenderThread(renderer);
+    return renderer->PollReadPixels(renderer, wait);
 }
 
-int SDL_RenderCopyF(SDL_Renderer *renderer, SDL_Texture *texture,
-                    const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+/* Each capture slot goes through these states in order, and back to free */
+typedef enum
 {
-    SDL_Rect real_srcrect;
-    SDL_FRect real_dstrect;
-    int retval;
-    int use_rendergeometry;
+    SDL_CAPTURE_SLOT_FREE,
+    SDL_CAPTURE_SLOT_READING,    /* waiting for SDL_RenderReadPixelsAsync() */
+    SDL_CAPTURE_SLOT_CONVERTING, /* waiting for the worker thread */
+    SDL_CAPTURE_SLOT_READY,      /* waiting for SDL_RenderGetCapturedFrame() */
+    SDL_CAPTURE_SLOT_LOCKED      /* waiting for SDL_RenderReleaseCapturedFrame() */
+} SDL_RenderCaptureSlotState;
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
-    CHECK_TEXTURE_MAGIC(texture, -1);
+typedef struct SDL_RenderCaptureSlot
+{
+    SDL_RenderCapture *capture;
+    SDL_RenderCaptureSlotState state;
+    Uint32 sequence;
+    SDL_RenderCapturedFrame frame;
 
-    if (renderer != texture->renderer) {
-        return SDL_SetError("Texture was not created with this renderer");
-    }
+    /* The pixels as they were read, converted on the worker thread */
+    Uint32 read_format;
+    void *read_pixels;
+    size_t read_allocation;
+    int read_pitch;
+    SDL_bool read_failed;
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
-    }
-#endif
+    void *pixels;
+    size_t pixels_allocation;
+} SDL_RenderCaptureSlot;
 
-    use_rendergeometry = (!renderer->QueueCopy);
+struct SDL_RenderCapture
+{
+    const void *magic;
+    SDL_Renderer *renderer;
+    Uint32 format;
+    SDL_RenderCaptureCallback callback;
+    void *userdata;
+
+    SDL_RenderCaptureSlot *slots;
+    int num_slots;
+    Uint32 next_sequence;
+    int num_reading;
+
+    /* Protects the slot states and pixels, which the worker thread uses */
+    SDL_mutex *lock;
+    SDL_cond *cond;
+    SDL_Thread *thread;
+    SDL_bool quit;
+
+    SDL_RenderCapture *prev;
+    SDL_RenderCapture *next;
+};
 
-    real_srcrect.x = 0;
-    real_srcrect.y = 0;
-    real_srcrect.w = texture->w;
-    real_srcrect.h = texture->h;
-    if (srcrect) {
-        if (!SDL_IntersectRect(srcrect, &real_srcrect, &real_srcrect)) {
-            return 0;
+static void *GetCaptureBuffer(void **buffer, size_t *allocation, size_t size)
+{
+    if (size > *allocation) {
+        void *ptr = SDL_realloc(*buffer, size);
+        if (!ptr) {
+            return NULL;
         }
+        *buffer = ptr;
+        *allocation = size;
     }
+    return *buffer;
+}
 
-    RenderGetViewportSize(renderer, &real_dstrect);
-    if (dstrect) {
-        if (!SDL_HasIntersectionF(dstrect, &real_dstrect)) {
-            return 0;
+/* The oldest slot in a state, or NULL if there isn't one */
+static SDL_RenderCaptureSlot *GetOldestCaptureSlot(SDL_RenderCapture *capture, SDL_RenderCaptureSlotState state)
+{
+    SDL_RenderCaptureSlot *oldest = NULL;
+    int i;
+
+    for (i = 0; i < capture->num_slots; ++i) {
+        SDL_RenderCaptureSlot *slot = &capture->slots[i];
+        if (slot->state == state &&
+            (!oldest || (Sint32)(slot->sequence - oldest->sequence) < 0)) {
+            oldest = slot;
         }
-        real_dstrect = *dstrect;
     }
+    return oldest;
+}
 
-    if (texture->native) {
-        texture = texture->native;
+/* Convert a frame, called on the worker thread without the lock held */
+static void ConvertCapturedFrame(SDL_RenderCapture *capture, SDL_RenderCaptureSlot *slot)
+{
+    SDL_RenderCapturedFrame *frame = &slot->frame;
+    const int w = frame->rect.w;
+    const int h = frame->rect.h;
+    size_t size;
+    int pitch;
+
+    frame->pixels = NULL;
+    frame->pitch = 0;
+    if (slot->read_failed) {
+        return;
     }
 
-    texture->last_command_generation = renderer->render_command_generation;
+    if (SDL_ISPIXELFORMAT_FOURCC(frame->format)) {
+        if (SDL_CalculateYUVSize(frame->format, w, h, &size, &pitch) < 0) {
+            return;
+        }
+    } else {
+        pitch = w * SDL_BYTESPERPIXEL(frame->format);
+        size = (size_t)h * pitch;
+    }
+    if (!GetCaptureBuffer(&slot->pixels, &slot->pixels_allocation, size)) {
+        return;
+    }
 
-    if (use_rendergeometry) {
-        float xy[8];
-        const int xy_stride = 2 * sizeof(float);
-        float uv[8];
-        const int uv_stride = 2 * sizeof(float);
-        const int num_vertices = 4;
-        const int *indices = renderer->rect_index_order;
-        const int num_indices = 6;
-        const int size_indices = 4;
-        float minu, minv, maxu, maxv;
-        float minx, miny, maxx, maxy;
+    if (SDL_ISPIXELFORMAT_FOURCC(frame->format)) {
+        if (SDL_ConvertPixels_RGB_to_YUV(w, h, slot->read_format, slot->read_pixels, slot->read_pitch,
+                                         frame->format, slot->pixels, pitch) < 0) {
+            return;
+        }
+    } else if (SDL_ConvertPixels(w, h, slot->read_format, slot->read_pixels, slot->read_pitch,
+                                 frame->format, slot->pixels, pitch) < 0) {
+        return;
+    }
+    frame->pixels = slot->pixels;
+    frame->pitch = pitch;
+}
 
-        minu = (float)(real_srcrect.x) / (float)texture->w;
-        minv = (float)(real_srcrect.y) / (float)texture->h;
-        maxu = (float)(real_srcrect.x + real_srcrect.w) / (float)texture->w;
-        maxv = (float)(real_srcrect.y + real_srcrect.h) / (float)texture->h;
+static int SDLCALL SDL_RenderCaptureThread(void *data)
+{
+    SDL_RenderCapture *capture = (SDL_RenderCapture *)data;
+    SDL_RenderCaptureSlot *slot;
 
-        minx = real_dstrect.x;
-        miny = real_dstrect.y;
-        maxx = real_dstrect.x + real_dstrect.w;
-        maxy = real_dstrect.y + real_dstrect.h;
+    SDL_LockMutex(capture->lock);
+    for (;;) {
+        while (!capture->quit && !(slot = GetOldestCaptureSlot(capture, SDL_CAPTURE_SLOT_CONVERTING))) {
+            SDL_CondWait(capture->cond, capture->lock);
+        }
+        if (capture->quit) {
+            break;
+        }
 
-        uv[0] = minu;
-        uv[1] = minv;
-        uv[2] = maxu;
-        uv[3] = minv;
-        uv[4] = maxu;
-        uv[5] = maxv;
-        uv[6] = minu;
-        uv[7] = maxv;
+        /* Nothing else touches a converting slot */
+        SDL_UnlockMutex(capture->lock);
+        ConvertCapturedFrame(capture, slot);
+        if (capture->callback) {
+            capture->callback(capture->userdata, &slot->frame);
+        }
+        SDL_LockMutex(capture->lock);
 
-        xy[0] = minx;
-        xy[1] = miny;
-        xy[2] = maxx;
-        xy[3] = miny;
-        xy[4] = maxx;
-        xy[5] = maxy;
-        xy[6] = minx;
-        xy[7] = maxy;
+        slot->state = capture->callback ? SDL_CAPTURE_SLOT_FREE : SDL_CAPTURE_SLOT_READY;
+        SDL_CondBroadcast(capture->cond);
+    }
+    SDL_UnlockMutex(capture->lock);
+    return 0;
+}
 
-        retval = QueueCmdGeometry(renderer, texture,
-                                  xy, xy_stride, &texture->color, 0 /* color_stride */, uv, uv_stride,
-                                  num_vertices,
-                                  indices, num_indices, size_indices,
-                                  renderer->scale.x, renderer->scale.y);
-    } else {
+/* Called by the backend when the pixels of a slot have been read */
+static void SDLCALL CapturePixelsRead(void *userdata, const SDL_Rect *rect, Uint32 format, const void *pixels, int pitch)
+{
+    SDL_RenderCaptureSlot *slot = (SDL_RenderCaptureSlot *)userdata;
+    SDL_RenderCapture *capture = slot->capture;
+    const int length = rect->w * SDL_BYTESPERPIXEL(format);
 
-        real_dstrect.x *= renderer->scale.x;
-        real_dstrect.y *= renderer->scale.y;
-        real_dstrect.w *= renderer->scale.x;
-        real_dstrect.h *= renderer->scale.y;
+    slot->frame.rect = *rect;
+    slot->read_format = format;
+    slot->read_pitch = length;
+    slot->read_failed = SDL_TRUE;
 
-        retval = QueueCmdCopy(renderer, texture, &real_srcrect, &real_dstrect);
+    /* The pixels are only valid during the callback, the worker thread converts the copy */
+    if (pixels && GetCaptureBuffer(&slot->read_pixels, &slot->read_allocation, (size_t)rect->h * length)) {
+        const Uint8 *src = (const Uint8 *)pixels;
+        Uint8 *dst = (Uint8 *)slot->read_pixels;
+        int row;
+
+        if (pitch == length) {
+            SDL_memcpy(dst, src, (size_t)rect->h * length);
+        } else {
+            for (row = 0; row < rect->h; ++row) {
+                SDL_memcpy(dst, src, length);
+                src += pitch;
+                dst += length;
+            }
+        }
+        slot->read_failed = SDL_FALSE;
     }
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+
+    SDL_LockMutex(capture->lock);
+    --capture->num_reading;
+    slot->state = SDL_CAPTURE_SLOT_CONVERTING;
+    SDL_CondBroadcast(capture->cond);
+    SDL_UnlockMutex(capture->lock);
 }
 
-int SDL_RenderCopyEx(SDL_Renderer *renderer, SDL_Texture *texture,
-                     const SDL_Rect *srcrect, const SDL_Rect *dstrect,
-                     const double angle, const SDL_Point *center, const SDL_RendererFlip flip)
+SDL_RenderCapture *SDL_CreateRenderCapture(SDL_Renderer *renderer, Uint32 format, int depth,
+                                           SDL_RenderCaptureCallback callback, void *userdata)
 {
-    SDL_FRect dstfrect;
-    SDL_FRect *pdstfrect = NULL;
-    SDL_FPoint fcenter;
-    SDL_FPoint *pfcenter = NULL;
+    SDL_RenderCapture *capture;
+    int i;
 
-    if (dstrect) {
-        dstfrect.x = (float)dstrect->x;
-        dstfrect.y = (float)dstrect->y;
-        dstfrect.w = (float)dstrect->w;
-        dstfrect.h = (float)dstrect->h;
-        pdstfrect = &dstfrect;
+    CHECK_RENDERER_MAGIC(renderer, NULL);
+
+    if (depth < 1) {
+        SDL_InvalidParamError("depth");
+        return NULL;
+    }
+    if (!renderer->RenderReadPixelsAsync && !renderer->RenderReadPixels) {
+        SDL_Unsupported();
+        return NULL;
+    }
+
+    capture = (SDL_RenderCapture *)SDL_calloc(1, sizeof(*capture));
+    if (!capture) {
+        SDL_OutOfMemory();
+        return NULL;
     }
+    capture->slots = (SDL_RenderCaptureSlot *)SDL_calloc(depth, sizeof(*capture->slots));
+    if (!capture->slots) {
+        SDL_free(capture);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    for (i = 0; i < depth; ++i) {
+        capture->slots[i].capture = capture;
+    }
+    capture->num_slots = depth;
+    capture->renderer = renderer;
+    capture->format = format;
+    capture->callback = callback;
+    capture->userdata = userdata;
 
-    if (center) {
-        fcenter.x = (float)center->x;
-        fcenter.y = (float)center->y;
-        pfcenter = &fcenter;
+    capture->lock = SDL_CreateMutex();
+    capture->cond = SDL_CreateCond();
+    if (capture->lock && capture->cond) {
+        capture->thread = SDL_CreateThreadInternal(SDL_RenderCaptureThread, "SDLCapture", 0, capture);
+    }
+    if (!capture->thread) {
+        if (capture->cond) {
+            SDL_DestroyCond(capture->cond);
+        }
+        if (capture->lock) {
+            SDL_DestroyMutex(capture->lock);
+        }
+        SDL_free(capture->slots);
+        SDL_free(capture);
+        return NULL;
     }
 
-    return SDL_RenderCopyExF(renderer, texture, srcrect, pdstfrect, angle, pfcenter, flip);
+    capture->magic = &capture_magic;
+    capture->next = renderer->captures;
+    if (renderer->captures) {
+        renderer->captures->prev = capture;
+    }
+    renderer->captures = capture;
+    return capture;
 }
 
-int SDL_RenderCopyExF(SDL_Renderer *renderer, SDL_Texture *texture,
-                      const SDL_Rect *srcrect, const SDL_FRect *dstrect,
-                      const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip)
+int SDL_RenderCaptureFrame(SDL_RenderCapture *capture, const SDL_Rect *rect, Uint32 *frame)
 {
-    SDL_Rect real_srcrect;
-    SDL_FRect real_dstrect;
-    SDL_FPoint real_center;
-    int retval;
-    int use_rendergeometry;
+    SDL_Renderer *renderer;
+    SDL_RenderCaptureSlot *slot;
+    SDL_Rect real_rect;
+    int i;
 
-    if (flip == SDL_FLIP_NONE && (int)(angle / 360) == angle / 360) { /* fast path when we don't need rotation or flipping */
-        return SDL_RenderCopyF(renderer, texture, srcrect, dstrect);
+    if (!capture || capture->magic != &capture_magic) {
+        return SDL_InvalidParamError("capture");
     }
+    renderer = capture->renderer;
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
-    CHECK_TEXTURE_MAGIC(texture, -1);
+    /* Finished reads free up their slots */
+    SDL_RenderPollReadPixels(renderer, SDL_FALSE);
 
-    if (renderer != texture->renderer) {
-        return SDL_SetError("Texture was not created with this renderer");
+    slot = NULL;
+    SDL_LockMutex(capture->lock);
+    for (i = 0; i < capture->num_slots; ++i) {
+        if (capture->slots[i].state == SDL_CAPTURE_SLOT_FREE) {
+            slot = &capture->slots[i];
+            slot->state = SDL_CAPTURE_SLOT_READING;
+            slot->sequence = capture->next_sequence++;
+            ++capture->num_reading;
+            break;
+        }
     }
-    if (!renderer->QueueCopyEx && !renderer->QueueGeometry) {
-        return SDL_SetError("Renderer does not support RenderCopyEx");
+    SDL_UnlockMutex(capture->lock);
+    if (!slot) {
+        return SDL_SetError("All %d capture buffers are in use", capture->num_slots);
     }
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't draw while we're hidden */
-    if (renderer->hidden) {
-        return 0;
+    SDL_zero(slot->frame);
+    slot->frame.frame = renderer->stats.frame;
+    slot->frame.format = capture->format;
+    if (!slot->frame.format) {
+        slot->frame.format = renderer->target ? renderer->target->format : SDL_GetWindowPixelFormat(renderer->window);
+    }
+    if (frame) {
+        *frame = slot->frame.frame;
     }
-#endif
 
-    use_rendergeometry = (!renderer->QueueCopyEx);
+    if (!GetReadPixelsRect(renderer, rect, &real_rect) || real_rect.w == 0 || real_rect.h == 0) {
+        /* Nothing to read, the frame is delivered without pixels */
+        SDL_zero(real_rect);
+        CapturePixelsRead(slot, &real_rect, slot->frame.format, NULL, 0);
+        return 0;
+    }
 
-    real_srcrect.x = 0;
-    real_srcrect.y = 0;
-    real_srcrect.w = texture->w;
-    real_srcrect.h = texture->h;
-    if (srcrect) {
-        if (!SDL_IntersectRect(srcrect, &real_srcrect, &real_srcrect)) {
-            return 0;
+    /* Read the pixels in the format of the target, the worker thread converts them */
+    if (SDL_RenderReadPixelsAsync(renderer, &real_rect, 0, CapturePixelsRead, slot) < 0) {
+        SDL_LockMutex(capture->lock);
+        if (slot->state == SDL_CAPTURE_SLOT_READING) {
+            --capture->num_reading;
+            slot->state = SDL_CAPTURE_SLOT_FREE;
         }
+        SDL_UnlockMutex(capture->lock);
+        return -1;
     }
+    return 0;
+}
 
-    /* We don't intersect the dstrect with the viewport as RenderCopy does because of potential rotation clipping issues... TODO: should we? */
-    if (dstrect) {
-        real_dstrect = *dstrect;
-    } else {
-        RenderGetViewportSize(renderer, &real_dstrect);
-    }
+int SDL_RenderGetCapturedFrame(SDL_RenderCapture *capture, SDL_bool wait, SDL_RenderCapturedFrame *frame)
+{
+    SDL_RenderCaptureSlot *slot;
+    int i;
 
-    if (texture->native) {
-        texture = texture->native;
+    if (!capture || capture->magic != &capture_magic) {
+        return SDL_InvalidParamError("capture");
     }
-
-    if (center) {
-        real_center = *center;
-    } else {
-        real_center.x = real_dstrect.w / 2.0f;
-        real_center.y = real_dstrect.h / 2.0f;
+    if (!frame) {
+        return SDL_InvalidParamError("frame");
+    }
+    if (capture->callback) {
+        return SDL_SetError("The capture delivers its frames to a callback");
     }
 
-    texture->last_command_generation = renderer->render_command_generation;
-
-    if (use_rendergeometry) {
-        float xy[8];
-        const int xy_stride = 2 * sizeof(float);
-        float uv[8];
-        const int uv_stride = 2 * sizeof(float);
-        const int num_vertices = 4;
-        const int *indices = renderer->rect_index_order;
-        const int num_indices = 6;
-        const int size_indices = 4;
-        float minu, minv, maxu, maxv;
-        float minx, miny, maxx, maxy;
-        float centerx, centery;
+    SDL_RenderPollReadPixels(capture->renderer, SDL_FALSE);
 
-        float s_minx, s_miny, s_maxx, s_maxy;
-        float c_minx, c_miny, c_maxx, c_maxy;
+    SDL_LockMutex(capture->lock);
+    for (;;) {
+        /* Frames are converted in order, so the oldest one that's in flight is next */
+        SDL_RenderCaptureSlot *oldest = NULL;
+        for (i = 0; i < capture->num_slots; ++i) {
+            slot = &capture->slots[i];
+            if (slot->state != SDL_CAPTURE_SLOT_FREE && slot->state != SDL_CAPTURE_SLOT_LOCKED &&
+                (!oldest || (Sint32)(slot->sequence - oldest->sequence) < 0)) {
+                oldest = slot;
+            }
+        }
+        slot = oldest;
 
-        const float radian_angle = (float)((M_PI * angle) / 180.0);
-        const float s = SDL_sinf(radian_angle);
-        const float c = SDL_cosf(radian_angle);
+        if (!slot || slot->state == SDL_CAPTURE_SLOT_READY || !wait) {
+            break;
+        }
+        if (slot->state == SDL_CAPTURE_SLOT_READING) {
+            SDL_UnlockMutex(capture->lock);
+            if (SDL_RenderPollReadPixels(capture->renderer, SDL_TRUE) < 0) {
+                return -1;
+            }
+            SDL_LockMutex(capture->lock);
+        } else {
+            SDL_CondWait(capture->cond, capture->lock);
+        }
+    }
 
-        minu = (float)(real_srcrect.x) / (float)texture->w;
-        minv = (float)(real_srcrect.y) / (float)texture->h;
-        maxu = (float)(real_srcrect.x + real_srcrect.w) / (float)texture->w;
-        maxv = (float)(real_srcrect.y + real_srcrect.h) / (float)texture->h;
+    if (!slot || slot->state != SDL_CAPTURE_SLOT_READY) {
+        SDL_UnlockMutex(capture->lock);
+        return 0;
+    }
+    slot->state = SDL_CAPTURE_SLOT_LOCKED;
+    *frame = slot->frame;
+    SDL_UnlockMutex(capture->lock);
+    return 1;
+}
 
-        centerx = real_center.x + real_dstrect.x;
-        centery = real_center.y + real_dstrect.y;
+void SDL_RenderReleaseCapturedFrame(SDL_RenderCapture *capture, const SDL_RenderCapturedFrame *frame)
+{
+    int i;
 
-        if (flip & SDL_FLIP_HORIZONTAL) {
-            minx = real_dstrect.x + real_dstrect.w;
-            maxx = real_dstrect.x;
-        } else {
-            minx = real_dstrect.x;
-            maxx = real_dstrect.x + real_dstrect.w;
-        }
+    if (!capture || capture->magic != &capture_magic) {
+        SDL_InvalidParamError("capture");
+        return;
+    }
+    if (!frame) {
+        return;
+    }
 
-        if (flip & SDL_FLIP_VERTICAL) {
-            miny = real_dstrect.y + real_dstrect.h;
-            maxy = real_dstrect.y;
-        } else {
-            miny = real_dstrect.y;
-            maxy = real_dstrect.y + real_dstrect.h;
+    SDL_LockMutex(capture->lock);
+    for (i = 0; i < capture->num_slots; ++i) {
+        SDL_RenderCaptureSlot *slot = &capture->slots[i];
+        if (slot->state == SDL_CAPTURE_SLOT_LOCKED &&
+            slot->frame.frame == frame->frame && slot->frame.pixels == frame->pixels) {
+            slot->state = SDL_CAPTURE_SLOT_FREE;
+            break;
         }
+    }
+    SDL_UnlockMutex(capture->lock);
+}
 
-        uv[0] = minu;
-        uv[1] = minv;
-        uv[2] = maxu;
-        uv[3] = minv;
-        uv[4] = maxu;
-        uv[5] = maxv;
-        uv[6] = minu;
-        uv[7] = maxv;
+void SDL_DestroyRenderCapture(SDL_RenderCapture *capture)
+{
+    SDL_Renderer *renderer;
+    int i;
 
-        /* apply rotation with 2x2 matrix ( c -s )
-         *                                ( s  c ) */
-        s_minx = s * (minx - centerx);
-        s_miny = s * (miny - centery);
-        s_maxx = s * (maxx - centerx);
-        s_maxy = s * (maxy - centery);
-        c_minx = c * (minx - centerx);
-        c_miny = c * (miny - centery);
-        c_maxx = c * (maxx - centerx);
-        c_maxy = c * (maxy - centery);
+    if (!capture || capture->magic != &capture_magic) {
+        SDL_InvalidParamError("capture");
+        return;
+    }
+    renderer = capture->renderer;
 
-        /* (minx, miny) */
-        xy[0] = (c_minx - s_miny) + centerx;
-        xy[1] = (s_minx + c_miny) + centery;
-        /* (maxx, miny) */
-        xy[2] = (c_maxx - s_miny) + centerx;
-        xy[3] = (s_maxx + c_miny) + centery;
-        /* (maxx, maxy) */
-        xy[4] = (c_maxx - s_maxy) + centerx;
-        xy[5] = (s_maxx + c_maxy) + centery;
-        /* (minx, maxy) */
-        xy[6] = (c_minx - s_maxy) + centerx;
-        xy[7] = (s_minx + c_maxy) + centery;
+    /* The backend has pointers to the slots until the reads are done */
+    if (capture->num_reading > 0) {
+        SDL_RenderPollReadPixels(renderer, SDL_TRUE);
+    }
 
-        retval = QueueCmdGeometry(renderer, texture,
-                                  xy, xy_stride, &texture->color, 0 /* color_stride */, uv, uv_stride,
-                                  num_vertices,
-                                  indices, num_indices, size_indices,
-                                  renderer->scale.x, renderer->scale.y);
+    capture->magic = NULL;
+    if (capture->next) {
+        capture->next->prev = capture->prev;
+    }
+    if (capture->prev) {
+        capture->prev->next = capture->next;
     } else {
+        renderer->captures = capture->next;
+    }
 
-        retval = QueueCmdCopyEx(renderer, texture, &real_srcrect, &real_dstrect, angle, &real_center, flip, renderer->scale.x, renderer->scale.y);
+    SDL_LockMutex(capture->lock);
+    capture->quit = SDL_TRUE;
+    SDL_CondBroadcast(capture->cond);
+    SDL_UnlockMutex(capture->lock);
+    SDL_WaitThread(capture->thread, NULL);
+    SDL_DestroyCond(capture->cond);
+    SDL_DestroyMutex(capture->lock);
+
+    for (i = 0; i < capture->num_slots; ++i) {
+        SDL_free(capture->slots[i].read_pixels);
+        SDL_free(capture->slots[i].pixels);
     }
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
+    SDL_free(capture->slots);
+    SDL_free(capture);
 }
 
-int SDL_RenderGeometry(SDL_Renderer *renderer,
-                       SDL_Texture *texture,
-                       const SDL_Vertex *vertices, int num_vertices,
-                       const int *indices, int num_indices)
+static void SDL_RenderSimulateVSync(SDL_Renderer *renderer)
 {
-    if (vertices) {
-        const float *xy = &vertices->position.x;
-        int xy_stride = sizeof(SDL_Vertex);
-        const SDL_Color *color = &vertices->color;
-        int color_stride = sizeof(SDL_Vertex);
-        const float *uv = &vertices->tex_coord.x;
-        int uv_stride = sizeof(SDL_Vertex);
-        int size_indices = 4;
-        return SDL_RenderGeometryRaw(renderer, texture, xy, xy_stride, color, color_stride, uv, uv_stride, num_vertices, indices, num_indices, size_indices);
+    Uint32 now, elapsed;
+    const Uint32 interval = renderer->simulate_vsync_interval;
+
+    if (!interval) {
+        /* We can't do sub-ms delay, so just return here */
+        return;
+    }
+
+    now = SDL_GetTicks();
+    elapsed = (now - renderer->last_present);
+    if (elapsed < interval) {
+        Uint32 duration = (interval - elapsed);
+        SDL_Delay(duration);
+        now = SDL_GetTicks();
+    }
+
+    elapsed = (now - renderer->last_present);
+    if (!renderer->last_present || elapsed > 1000) {
+        /* It's been too long, reset the presentation timeline */
+        renderer->last_present = now;
     } else {
-        return SDL_InvalidParamError("vertices");
+        renderer->last_present += (elapsed / interval) * interval;
     }
 }
 
-static int remap_one_indice(
-    int prev,
-    int k,
-    SDL_Texture *texture,
-    const float *xy, int xy_stride,
-    const SDL_Color *color, int color_stride,
-    const float *uv, int uv_stride)
+void SDL_RenderPresent(SDL_Renderer *renderer)
 {
-    const float *xy0_, *xy1_, *uv0_, *uv1_;
-    int col0_, col1_;
-    xy0_ = (const float *)((const char *)xy + prev * xy_stride);
-    xy1_ = (const float *)((const char *)xy + k * xy_stride);
-    if (xy0_[0] != xy1_[0]) {
-        return k;
-    }
-    if (xy0_[1] != xy1_[1]) {
-        return k;
+    SDL_bool presented = SDL_TRUE;
+
+    CHECK_RENDERER_MAGIC(renderer, );
+
+    if (renderer->recording_command_list) {
+        SDL_SetError("Can't present while recording a command list");
+        return;
     }
-    if (texture) {
-        uv0_ = (const float *)((const char *)uv + prev * uv_stride);
-        uv1_ = (const float *)((const char *)uv + k * uv_stride);
-        if (uv0_[0] != uv1_[0]) {
-            return k;
+
+    EnforceTextureBudget(renderer);
+
+    if (renderer->render_thread) {
+        WaitRenderThread(renderer);
+        if (renderer->PollReadPixels) {
+            renderer->PollReadPixels(renderer, SDL_FALSE);
         }
-        if (uv0_[1] != uv1_[1]) {
-            return k;
+#if DONT_DRAW_WHILE_HIDDEN
+        if (renderer->hidden) {
+            presented = SDL_FALSE;
+        }
+#endif
+        /* The render thread draws and presents the frame while we start on the next one */
+        PresentDamage(renderer);
+        SubmitRenderThread(renderer, presented);
+        FinishDamage(renderer, presented);
+        AgeRenderVertexPeak(renderer);
+
+        if (renderer->simulate_vsync ||
+            (!presented && renderer->wanted_vsync)) {
+            SDL_RenderSimulateVSync(renderer);
         }
+        return;
+    }
+
+    FlushRenderCommands(renderer); /* time to send everything to the GPU! */
+
+    PresentDamage(renderer);
+#if DONT_DRAW_WHILE_HIDDEN
+    /* Don't present while we're hidden */
+    if (renderer->hidden) {
+        presented = SDL_FALSE;
+    } else
+#endif
+        if (renderer->RenderPresent(renderer) < 0) {
+        presented = SDL_FALSE;
     }
-    col0_ = *(const int *)((const char *)color + prev * color_stride);
-    col1_ = *(const int *)((const char *)color + k * color_stride);
+    FinishDamage(renderer, presented);
+    AgeRenderVertexPeak(renderer);
 
-    if (col0_ != col1_) {
-        return k;
+    if (renderer->PollReadPixels) {
+        renderer->PollReadPixels(renderer, SDL_FALSE);
     }
 
-    return prev;
+    FinishRenderStats(renderer);
+
+    if (renderer->simulate_vsync ||
+        (!presented && renderer->wanted_vsync)) {
+        SDL_RenderSimulateVSync(renderer);
+    }
 }
 
-static int remap_indices(
-    int prev[3],
-    int k,
-    SDL_Texture *texture,
-    const float *xy, int xy_stride,
-    const SDL_Color *color, int color_stride,
-    const float *uv, int uv_stride)
+int SDL_RenderGetStats(SDL_Renderer *renderer, SDL_RenderStats *stats)
 {
-    int i;
-    if (prev[0] == -1) {
-        return k;
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!stats) {
+        return SDL_InvalidParamError("stats");
     }
 
-    for (i = 0; i < 3; i++) {
-        int new_k = remap_one_indice(prev[i], k, texture, xy, xy_stride, color, color_stride, uv, uv_stride);
-        if (new_k != k) {
-            return new_k;
-        }
+    *stats = renderer->frame_stats;
+    return 0;
+}
+
+int SDL_RenderBeginCommandList(SDL_Renderer *renderer)
+{
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (renderer->recording_command_list) {
+        return SDL_SetError("Already recording a command list");
     }
-    return k;
+
+    if (FlushRenderCommands(renderer) < 0) {
+        return -1;
+    }
+
+    /* The list has to set up all of its own state */
+    renderer->color_queued = SDL_FALSE;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
+    renderer->recording_command_list = SDL_TRUE;
+    return 0;
 }
 
-int SDL_RenderGeometryRaw(SDL_Renderer *renderer,
-                          SDL_Texture *texture,
-                          const float *xy, int xy_stride,
-                          const SDL_Color *color, int color_stride,
-                          const float *uv, int uv_stride,
-                          int num_vertices,
-                          const void *indices, int num_indices, int size_indices)
+SDL_RenderCommandList *SDL_RenderEndCommandList(SDL_Renderer *renderer)
 {
-    int i;
-    int retval = 0;
-    int count = indices ? num_indices : num_vertices;
+    SDL_RenderCommandList *list;
 
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    CHECK_RENDERER_MAGIC(renderer, NULL);
 
-    if (!renderer->QueueGeometry) {
-        return SDL_Unsupported();
+    if (!renderer->recording_command_list) {
+        SDL_SetError("Not recording a command list");
+        return NULL;
     }
+    renderer->recording_command_list = SDL_FALSE;
 
-    if (texture) {
-        CHECK_TEXTURE_MAGIC(texture, -1);
+    /* Merged draws from an atlas would lose track of the textures they use,
+       which they need to be dropped when one is destroyed. */
+    if (renderer->optimize_batches && !renderer->texture_atlases && renderer->render_commands) {
+        OptimizeRenderCommands(renderer);
+    }
 
-        if (renderer != texture->renderer) {
-            return SDL_SetError("Texture was not created with this renderer");
+    list = (SDL_RenderCommandList *)SDL_calloc(1, sizeof(*list));
+    if (list && renderer->vertex_data_used > 0) {
+        if (renderer->GrowVertexData) {
+            /* The backend reuses its buffer, keep a copy */
+            list->vertex_blocks = GetRenderVertexBlock(renderer, renderer->vertex_data_used, 0, 0);
+            if (list->vertex_blocks) {
+                SDL_memcpy(list->vertex_blocks->data, renderer->vertex_data, renderer->vertex_data_used);
+                list->vertex_blocks->used = renderer->vertex_data_used;
+            }
+        } else {
+            list->vertex_blocks = renderer->vertex_blocks;
+            renderer->vertex_blocks = NULL;
+            renderer->vertex_blocks_tail = NULL;
+        }
+        if (list->vertex_blocks) {
+            list->vertex_data_used = renderer->vertex_data_used;
+        } else {
+            SDL_free(list);
+            list = NULL;
         }
     }
 
-    if (!xy) {
-        return SDL_InvalidParamError("xy");
+    if (list) {
+        list->magic = &command_list_magic;
+        list->renderer = renderer;
+        list->commands = renderer->render_commands;
+    } else if (renderer->render_commands_tail) {
+        /* Drop the recorded commands */
+        renderer->render_commands_tail->next = renderer->render_commands_pool;
+        renderer->render_commands_pool = renderer->render_commands;
     }
 
-    if (!color) {
-        return SDL_InvalidParamError("color");
+    renderer->render_commands = NULL;
+    renderer->render_commands_tail = NULL;
+    ResetRenderVertices(renderer);
+    renderer->render_command_generation++;
+    renderer->color_queued = SDL_FALSE;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
+
+    if (!list) {
+        SDL_OutOfMemory();
+        return NULL;
     }
 
-    if (texture && !uv) {
-        return SDL_InvalidParamError("uv");
+    list->next = renderer->command_lists;
+    if (renderer->command_lists) {
+        renderer->command_lists->prev = list;
     }
+    renderer->command_lists = list;
 
-    if (count % 3 != 0) {
-        return SDL_InvalidParamError(indices ? "num_indices" : "num_vertices");
+    WaitRenderThread(renderer);
+    if (renderer->CreateCommandList && renderer->CreateCommandList(renderer, list) < 0) {
+        SDL_DestroyRenderCommandList(list);
+        return NULL;
     }
+    return list;
+}
 
-    if (indices) {
-        if (size_indices != 1 && size_indices != 2 && size_indices != 4) {
-            return SDL_InvalidParamError("size_indices");
-        }
-    } else {
-        size_indices = 0;
+int SDL_RenderReplayCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list, float x, float y)
+{
+    SDL_RenderCommand *cmd;
+    SDL_RenderCommand *clip_commands = NULL;
+    SDL_Rect viewport;
+    SDL_bool isstack = SDL_FALSE;
+    int offset_x, offset_y;
+    int num_clip_commands = 0;
+    int retval;
+
+    CHECK_RENDERER_MAGIC(renderer, -1);
+
+    if (!list || list->magic != &command_list_magic) {
+        return SDL_InvalidParamError("list");
+    }
+    if (list->renderer != renderer) {
+        return SDL_SetError("Command list was not recorded with this renderer");
+    }
+    if (renderer->recording_command_list) {
+        return SDL_SetError("Can't draw a command list while recording one");
     }
 
 #if DONT_DRAW_WHILE_HIDDEN
@@ -3763,160 +6721,199 @@ int SDL_RenderGeometryRaw(SDL_Renderer *renderer,
     }
 #endif
 
-    if (num_vertices < 3) {
+    if (!list->commands) {
         return 0;
     }
 
-    if (texture && texture->native) {
-        texture = texture->native;
+    /* Draw everything queued before the list first */
+    if (FlushRenderCommands(renderer) < 0) {
+        return -1;
+    }
+    if (!renderer->damage_locked && !renderer->target) {
+        LockDamageRegion(renderer);
     }
 
-    if (texture) {
-        for (i = 0; i < num_vertices; ++i) {
-            const float *uv_ = (const float *)((const char *)uv + i * uv_stride);
-            float u = uv_[0];
-            float v = uv_[1];
-            if (u < 0.0f || v < 0.0f || u > 1.0f || v > 1.0f) {
-                return SDL_SetError("Values of 'uv' out of bounds %f %f at %d/%d", u, v, i, num_vertices);
+    offset_x = (int)SDL_floor(x * renderer->scale.x);
+    offset_y = (int)SDL_floor(y * renderer->scale.y);
+    if (offset_x || offset_y) {
+        for (cmd = list->commands; cmd; cmd = cmd->next) {
+            if (cmd->command == SDL_RENDERCMD_SETVIEWPORT) {
+                cmd->data.viewport.rect.x += offset_x;
+                cmd->data.viewport.rect.y += offset_y;
             }
         }
     }
 
-    if (indices) {
-        for (i = 0; i < num_indices; ++i) {
-            int j;
-            if (size_indices == 4) {
-                j = ((const Uint32 *)indices)[i];
-            } else if (size_indices == 2) {
-                j = ((const Uint16 *)indices)[i];
-            } else {
-                j = ((const Uint8 *)indices)[i];
-            }
-            if (j < 0 || j >= num_vertices) {
-                return SDL_SetError("Values of 'indices' out of bounds");
+    /* The list may draw textures that were evicted since it was recorded */
+    for (cmd = list->commands; cmd; cmd = cmd->next) {
+        if ((cmd->command == SDL_RENDERCMD_COPY || cmd->command == SDL_RENDERCMD_COPY_EX ||
+             cmd->command == SDL_RENDERCMD_GEOMETRY) &&
+            cmd->data.draw.texture && cmd->data.draw.texture->evicted) {
+            if (RestoreTexture(cmd->data.draw.texture) < 0) {
+                return -1;
             }
         }
     }
 
-    if (texture) {
-        texture->last_command_generation = renderer->render_command_generation;
+    /* Keep the list inside the part of the window that is drawn */
+    if (renderer->damage_clipping && !renderer->target) {
+        for (cmd = list->commands; cmd; cmd = cmd->next) {
+            if (cmd->command == SDL_RENDERCMD_SETCLIPRECT) {
+                ++num_clip_commands;
+            }
+        }
+        clip_commands = SDL_small_alloc(SDL_RenderCommand, num_clip_commands + 1, &isstack);
+        if (!clip_commands) {
+            return SDL_OutOfMemory();
+        }
+        SDL_zero(viewport);
+        num_clip_commands = 0;
+        for (cmd = list->commands; cmd; cmd = cmd->next) {
+            if (cmd->command == SDL_RENDERCMD_SETVIEWPORT) {
+                viewport = cmd->data.viewport.rect;
+            } else if (cmd->command == SDL_RENDERCMD_SETCLIPRECT) {
+                SDL_Rect damage = renderer->damage_clip;
+                damage.x -= viewport.x;
+                damage.y -= viewport.y;
+                clip_commands[num_clip_commands++] = *cmd;
+                if (!cmd->data.cliprect.enabled) {
+                    cmd->data.cliprect.enabled = SDL_TRUE;
+                    cmd->data.cliprect.rect = damage;
+                } else if (!SDL_IntersectRect(&cmd->data.cliprect.rect, &damage, &cmd->data.cliprect.rect)) {
+                    SDL_zero(cmd->data.cliprect.rect);
+                }
+            }
+        }
     }
 
-    retval = QueueCmdGeometry(renderer, texture,
-                              xy, xy_stride, color, color_stride, uv, uv_stride,
-                              num_vertices,
-                              indices, num_indices, size_indices,
-                              renderer->scale.x, renderer->scale.y);
-
-    return retval < 0 ? retval : FlushRenderCommandsIfNotBatching(renderer);
-}
-
-int SDL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
-                         Uint32 format, void *pixels, int pitch)
-{
-    SDL_Rect real_rect;
-
-    CHECK_RENDERER_MAGIC(renderer, -1);
+    CountRenderCommands(renderer, list->commands, list->vertex_data_used);
 
-    if (!renderer->RenderReadPixels) {
-        return SDL_Unsupported();
+    if (renderer->RunCommandList) {
+        retval = renderer->RunCommandList(renderer, list);
+    } else {
+        retval = renderer->RunCommandQueue(renderer, list->commands, list->vertex_blocks, list->vertex_data_used);
     }
 
-    FlushRenderCommands(renderer); /* we need to render before we read the results. */
-
-    if (!format) {
-        if (!renderer->target) {
-            format = SDL_GetWindowPixelFormat(renderer->window);
-        } else {
-            format = renderer->target->format;
+    if (clip_commands) {
+        num_clip_commands = 0;
+        for (cmd = list->commands; cmd; cmd = cmd->next) {
+            if (cmd->command == SDL_RENDERCMD_SETCLIPRECT) {
+                cmd->data.cliprect = clip_commands[num_clip_commands++].data.cliprect;
+            }
         }
+        SDL_small_free(clip_commands, isstack);
     }
 
-    real_rect.x = (int)SDL_floor(renderer->viewport.x);
-    real_rect.y = (int)SDL_floor(renderer->viewport.y);
-    real_rect.w = (int)SDL_floor(renderer->viewport.w);
-    real_rect.h = (int)SDL_floor(renderer->viewport.h);
-    if (rect) {
-        if (!SDL_IntersectRect(rect, &real_rect, &real_rect)) {
-            return 0;
-        }
-        if (real_rect.y > rect->y) {
-            pixels = (Uint8 *)pixels + pitch * (real_rect.y - rect->y);
-        }
-        if (real_rect.x > rect->x) {
-            int bpp = SDL_BYTESPERPIXEL(format);
-            pixels = (Uint8 *)pixels + bpp * (real_rect.x - rect->x);
+    if (offset_x || offset_y) {
+        for (cmd = list->commands; cmd; cmd = cmd->next) {
+            if (cmd->command == SDL_RENDERCMD_SETVIEWPORT) {
+                cmd->data.viewport.rect.x -= offset_x;
+                cmd->data.viewport.rect.y -= offset_y;
+            }
         }
     }
 
-    return renderer->RenderReadPixels(renderer, &real_rect,
-                                      format, pixels, pitch);
+    /* The list changed the backend state under the queue */
+    renderer->color_queued = SDL_FALSE;
+    renderer->viewport_queued = SDL_FALSE;
+    renderer->cliprect_queued = SDL_FALSE;
+    return retval;
 }
 
-static void SDL_RenderSimulateVSync(SDL_Renderer *renderer)
+void SDL_DestroyRenderCommandList(SDL_RenderCommandList *list)
 {
-    Uint32 now, elapsed;
-    const Uint32 interval = renderer->simulate_vsync_interval;
+    SDL_Renderer *renderer;
 
-    if (!interval) {
-        /* We can't do sub-ms delay, so just return here */
+    if (!list || list->magic != &command_list_magic) {
+        SDL_InvalidParamError("list");
         return;
     }
+    renderer = list->renderer;
 
-    now = SDL_GetTicks();
-    elapsed = (now - renderer->last_present);
-    if (elapsed < interval) {
-        Uint32 duration = (interval - elapsed);
-        SDL_Delay(duration);
-        now = SDL_GetTicks();
-    }
+    list->magic = NULL;
 
-    elapsed = (now - renderer->last_present);
-    if (!renderer->last_present || elapsed > 1000) {
-        /* It's been too long, reset the presentation timeline */
-        renderer->last_present = now;
+    if (list->next) {
+        list->next->prev = list->prev;
+    }
+    if (list->prev) {
+        list->prev->next = list->next;
     } else {
-        renderer->last_present += (elapsed / interval) * interval;
+        renderer->command_lists = list->next;
     }
-}
-
-void SDL_RenderPresent(SDL_Renderer *renderer)
-{
-    SDL_bool presented = SDL_TRUE;
-
-    CHECK_RENDERER_MAGIC(renderer, );
 
-    FlushRenderCommands(renderer); /* time to send everything to the GPU! */
+    if (renderer->DestroyCommandList) {
+        WaitRenderThread(renderer);
+        renderer->DestroyCommandList(renderer, list);
+    }
 
-#if DONT_DRAW_WHILE_HIDDEN
-    /* Don't present while we're hidden */
-    if (renderer->hidden) {
-        presented = SDL_FALSE;
-    } else
-#endif
-        if (renderer->RenderPresent(renderer) < 0) {
-        presented = SDL_FALSE;
+    /* Give the commands back to the renderer for reuse */
+    if (list->commands) {
+        SDL_RenderCommand *tail = list->commands;
+        while (tail->next) {
+            tail = tail->next;
+        }
+        tail->next = renderer->render_commands_pool;
+        renderer->render_commands_pool = list->commands;
     }
+    FreeRenderVertexBlocks(list->vertex_blocks);
+    SDL_free(list);
+}
 
-    if (renderer->simulate_vsync ||
-        (!presented && renderer->wanted_vsync)) {
-        SDL_RenderSimulateVSync(renderer);
+/* Recorded draws can't use a texture after it's gone */
+static void DropTextureCommands(SDL_RenderCommand *cmd, SDL_Texture *texture)
+{
+    for (; cmd; cmd = cmd->next) {
+        switch (cmd->command) {
+        case SDL_RENDERCMD_DRAW_POINTS:
+        case SDL_RENDERCMD_DRAW_LINES:
+        case SDL_RENDERCMD_FILL_RECTS:
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX:
+        case SDL_RENDERCMD_GEOMETRY:
+            if (cmd->data.draw.texture == texture || cmd->data.draw.packed == texture) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            }
+            break;
+        case SDL_RENDERCMD_UPDATE_TEXTURE:
+            if (cmd->data.update.texture == texture) {
+                cmd->command = SDL_RENDERCMD_NO_OP;
+            }
+            break;
+        default:
+            break;
+        }
     }
 }
 
 void SDL_DestroyTexture(SDL_Texture *texture)
 {
     SDL_Renderer *renderer;
+    SDL_bool deferred = SDL_FALSE;
 
     CHECK_TEXTURE_MAGIC(texture, );
 
     renderer = texture->renderer;
     if (texture == renderer->target) {
         SDL_SetRenderTarget(renderer, NULL); /* implies command queue flush */
+    } else if (!texture->atlas && !renderer->recording_command_list && renderer->render_commands &&
+               texture->last_command_generation == renderer->render_command_generation) {
+        /* The queued commands keep using it, it's destroyed after they've run */
+        WaitRenderThread(renderer);
+        deferred = SDL_TRUE;
     } else {
         FlushRenderCommandsIfTextureNeeded(texture);
     }
 
+    if (renderer->recording_command_list) {
+        DropTextureCommands(renderer->render_commands, texture);
+    }
+    if (renderer->command_lists) {
+        SDL_RenderCommandList *list;
+        for (list = renderer->command_lists; list; list = list->next) {
+            DropTextureCommands(list->commands, texture);
+        }
+    }
+
     texture->magic = NULL;
 
     if (texture->next) {
@@ -3937,12 +6934,22 @@ void SDL_DestroyTexture(SDL_Texture *texture)
     }
 #endif
     SDL_free(texture->pixels);
-
-    renderer->DestroyTexture(renderer, texture);
+    SDL_free(texture->shadow);
+    texture->shadow = NULL;
 
     SDL_FreeSurface(texture->locked_surface);
     texture->locked_surface = NULL;
 
+    if (texture->atlas) {
+        ReleaseTextureAtlas(renderer, texture->atlas);
+    } else if (deferred) {
+        texture->next = renderer->destroyed_textures;
+        renderer->destroyed_textures = texture;
+        return;
+    } else if (!texture->evicted) {
+        DestroyBackendTexture(renderer, texture);
+    }
+
     SDL_free(texture);
 }
 
@@ -3954,6 +6961,20 @@ void SDL_DestroyRenderer(SDL_Renderer *renderer)
 
     SDL_DelEventWatch(SDL_RendererEventWatch, renderer);
 
+    StopRenderThread(renderer);
+
+    if (renderer->PollReadPixels) {
+        renderer->PollReadPixels(renderer, SDL_TRUE);
+    }
+
+    while (renderer->captures) {
+        SDL_DestroyRenderCapture(renderer->captures);
+    }
+
+    while (renderer->command_lists) {
+        SDL_DestroyRenderCommandList(renderer->command_lists);
+    }
+
     if (renderer->render_commands_tail) {
         renderer->render_commands_tail->next = renderer->render_commands_pool;
         cmd = renderer->render_commands;
@@ -3971,7 +6992,14 @@ void SDL_DestroyRenderer(SDL_Renderer *renderer)
         cmd = next;
     }
 
-    SDL_free(renderer->vertex_data);
+    FreeRenderVertexBlocks(renderer->vertex_blocks);
+    renderer->vertex_blocks = NULL;
+    renderer->vertex_blocks_tail = NULL;
+    FreeRenderVertexBlocks(renderer->vertex_blocks_pool);
+    renderer->vertex_blocks_pool = NULL;
+    SDL_free(renderer->batch_data);
+    SDL_free(renderer->damage_rects);
+    SDL_free(renderer->present_damage_rects);
 
     /* Free existing textures for this renderer */
     while (renderer->textures) {
@@ -3980,6 +7008,8 @@ void SDL_DestroyRenderer(SDL_Renderer *renderer)
         SDL_DestroyTexture(renderer->textures);
         SDL_assert(tex != renderer->textures); /* satisfy static analysis. */
     }
+    FreeDestroyedTextures(renderer, renderer->destroyed_textures);
+    renderer->destroyed_textures = NULL;
 
     if (renderer->window) {
         SDL_SetWindowData(renderer->window, SDL_WINDOWRENDERDATA, NULL);
@@ -4004,7 +7034,12 @@ int SDL_GL_BindTexture(SDL_Texture *texture, float *texw, float *texh)
     renderer = texture->renderer;
     if (texture->native) {
         return SDL_GL_BindTexture(texture->native, texw, texh);
+    } else if (texture->atlas) {
+        return SDL_SetError("Texture is packed into a texture atlas");
     } else if (renderer && renderer->GL_BindTexture) {
+        if (texture->evicted && RestoreTexture(texture) < 0) {
+            return -1;
+        }
         FlushRenderCommandsIfTextureNeeded(texture); /* in case the app is going to mess with it. */
         return renderer->GL_BindTexture(renderer, texture, texw, texh);
     } else {
@@ -4020,6 +7055,8 @@ int SDL_GL_UnbindTexture(SDL_Texture *texture)
     renderer = texture->renderer;
     if (texture->native) {
         return SDL_GL_UnbindTexture(texture->native);
+    } else if (texture->atlas) {
+        return SDL_SetError("Texture is packed into a texture atlas");
     } else if (renderer && renderer->GL_UnbindTexture) {
         FlushRenderCommandsIfTextureNeeded(texture); /* in case the app messed with it. */
         return renderer->GL_UnbindTexture(renderer, texture);
@@ -4136,6 +7173,29 @@ SDL_BlendOperation SDL_GetBlendModeAlphaOperation(SDL_BlendMode blendMode)
     return (SDL_BlendOperation)(((Uint32)blendMode >> 16) & 0xF);
 }
 
+SDL_bool SDL_GL_IsProbablyAccelerated(const char *renderer)
+{
+#if defined(__WINDOWS__) || defined(__WINGDK__)
+    if (SDL_strcmp(renderer, "GDI Generic") == 0) {
+        return SDL_FALSE; /* Microsoft's fallback software renderer. Fix your system! */
+    }
+#endif
+
+#ifdef __APPLE__
+    if (SDL_strcmp(renderer, "Apple Software Renderer") == 0) {
+        return SDL_FALSE; /* (a probably very old) Apple software-based OpenGL. */
+    }
+#endif
+
+    if (SDL_strcmp(renderer, "Software Rasterizer") == 0) {
+        return SDL_FALSE; /* (a probably very old) Software Mesa, or some other generic thing. */
+    }
+
+    /* !!! FIXME: swrast? llvmpipe? softpipe? */
+
+    return SDL_TRUE;
+}
+
 int SDL_RenderSetVSync(SDL_Renderer *renderer, int vsync)
 {
     CHECK_RENDERER_MAGIC(renderer, -1);
@@ -4146,6 +7206,7 @@ int SDL_RenderSetVSync(SDL_Renderer *renderer, int vsync)
 
     renderer->wanted_vsync = vsync ? SDL_TRUE : SDL_FALSE;
 
+    WaitRenderThread(renderer);
     if (!renderer->SetVSync ||
         renderer->SetVSync(renderer, vsync) != 0) {
         renderer->simulate_vsync = vsync ? SDL_TRUE : SDL_FALSE;
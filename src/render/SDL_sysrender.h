@@ -26,6 +26,7 @@
 #include "SDL_render.h"
 #include "SDL_events.h"
 #include "SDL_mutex.h"
+#include "SDL_thread.h"
 #include "SDL_yuv_sw_c.h"
 
 /* Set up for C function definitions, even when using C++ */
@@ -46,7 +47,12 @@ typedef struct SDL_DRect
 
 /* The SDL 2D rendering system */
 
+/* How many frames of damage are remembered for partial drawing, enough for
+   the back buffers of triple buffering */
+#define SDL_RENDER_DAMAGE_HISTORY 4
+
 typedef struct SDL_RenderDriver SDL_RenderDriver;
+typedef struct SDL_TextureAtlas SDL_TextureAtlas;
 
 /* Define the SDL texture structure */
 struct SDL_Texture
@@ -71,8 +77,17 @@ struct SDL_Texture
     SDL_Rect locked_rect;
     SDL_Surface *locked_surface; /**< Locked region exposed as a SDL surface */
 
+    /* Support for packing small textures into a shared texture */
+    SDL_TextureAtlas *atlas;
+    SDL_Rect atlas_rect; /**< The location of the texture in the atlas */
+
     Uint32 last_command_generation; /* last command queue generation this texture was in. */
 
+    /* Memory accounting and eviction, see SDL_SetTextureRestorable() */
+    Uint64 memory;        /**< Bytes of backend storage, 0 while evicted */
+    void *shadow;         /**< Copy of the pixels of restorable textures, w * bpp bytes per row */
+    SDL_bool evicted;     /**< The backend texture was freed, it's recreated from the shadow on use */
+
     void *driverdata; /**< Driver specific texture representation */
     void *userdata;
 
@@ -92,9 +107,27 @@ typedef enum
     SDL_RENDERCMD_FILL_RECTS,
     SDL_RENDERCMD_COPY,
     SDL_RENDERCMD_COPY_EX,
-    SDL_RENDERCMD_GEOMETRY
+    SDL_RENDERCMD_GEOMETRY,
+    SDL_RENDERCMD_UPDATE_TEXTURE
 } SDL_RenderCommandType;
 
+/* Vertex data is written to a chain of blocks, so it never has to be moved
+   to make room for more. Offsets into the vertex data, like the first member
+   of the commands, count across the whole chain: each block holds the data
+   from its offset up to the offset of the next one. */
+typedef struct SDL_RenderVertexBlock SDL_RenderVertexBlock;
+
+struct SDL_RenderVertexBlock
+{
+    Uint8 *data;   /* the vertex data at offset */
+    size_t offset;
+    size_t used;
+    size_t size;
+    size_t capacity; /* the size of allocation, data may start a bit into it */
+    void *allocation;
+    SDL_RenderVertexBlock *next;
+};
+
 typedef struct SDL_RenderCommand
 {
     SDL_RenderCommandType command;
@@ -117,16 +150,42 @@ typedef struct SDL_RenderCommand
             Uint8 r, g, b, a;
             SDL_BlendMode blend;
             SDL_Texture *texture;
+            SDL_Texture *packed; /* the texture drawn from an atlas, if texture is one */
+            size_t size;      /* bytes of vertex data, filled in by SDL_render.c */
+            size_t indices;   /* offset of the indices in the vertex data, if index_size isn't 0 */
+            size_t num_indices;
+            int index_size;   /* 2 or 4 if the backend queued indexed geometry, then count is the number of vertices */
+            SDL_FRect bounds; /* conservative bounds in viewport space, w < 0 if unknown */
         } draw;
         struct
         {
             size_t first;
             Uint8 r, g, b, a;
         } color;
+        struct
+        {
+            size_t first; /* the pixels in the vertex data, rect.w pixels per row */
+            SDL_Texture *texture;
+            SDL_Rect rect;
+        } update;
     } data;
     struct SDL_RenderCommand *next;
 } SDL_RenderCommand;
 
+struct SDL_RenderCommandList
+{
+    const void *magic;
+    SDL_Renderer *renderer;
+    SDL_RenderCommand *commands;
+    SDL_RenderVertexBlock *vertex_blocks;
+    size_t vertex_data_used;
+
+    void *driverdata; /**< Driver specific command list representation */
+
+    SDL_RenderCommandList *prev;
+    SDL_RenderCommandList *next;
+};
+
 typedef struct SDL_VertexSolid
 {
     SDL_FPoint position;
@@ -167,7 +226,24 @@ struct SDL_Renderer
                          int num_vertices, const void *indices, int num_indices, int size_indices,
                          float scale_x, float scale_y);
 
-    int (*RunCommandQueue)(SDL_Renderer *renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize);
+    /* Optional, lets texture updates run in order with the draws, so
+       updating a texture doesn't need the queued draws using it flushed. */
+    int (*QueueUpdateTexture)(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                              const SDL_Rect *rect, const void *pixels, int pitch);
+    /* Bigger updates flush the queue and go through UpdateTexture, 0 for no limit */
+    size_t max_queued_update_size;
+
+    int (*RunCommandQueue)(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize);
+    /* Optional, lets the backend own vertex_data, one contiguous buffer used
+       instead of vertex blocks: make it hold at least numbytes, keeping the
+       first vertex_data_used bytes. */
+    int (*GrowVertexData)(SDL_Renderer *renderer, size_t numbytes);
+    /* Optional, lets the backend keep the vertices of a command list around
+       (e.g. in a GPU buffer). Backends that own vertex_data need to run
+       command lists themselves, since the vertices aren't in vertex_data. */
+    int (*CreateCommandList)(SDL_Renderer *renderer, SDL_RenderCommandList *list);
+    int (*RunCommandList)(SDL_Renderer *renderer, SDL_RenderCommandList *list);
+    void (*DestroyCommandList)(SDL_Renderer *renderer, SDL_RenderCommandList *list);
     int (*UpdateTexture)(SDL_Renderer *renderer, SDL_Texture *texture,
                          const SDL_Rect *rect, const void *pixels,
                          int pitch);
@@ -189,7 +265,20 @@ struct SDL_Renderer
     int (*SetRenderTarget)(SDL_Renderer *renderer, SDL_Texture *texture);
     int (*RenderReadPixels)(SDL_Renderer *renderer, const SDL_Rect *rect,
                             Uint32 format, void *pixels, int pitch);
+    int (*RenderReadPixelsAsync)(SDL_Renderer *renderer, const SDL_Rect *rect, Uint32 format,
+                                 SDL_RenderReadPixelsCallback callback, void *userdata);
+    int (*PollReadPixels)(SDL_Renderer *renderer, SDL_bool wait);
     int (*RenderPresent)(SDL_Renderer *renderer);
+    /* Optional, the number of frames since the contents of the back buffer
+       were presented, or 0 if they are unknown. Lets frames with damage be
+       drawn partially, see SDL_RenderAddDamageRect() */
+    int (*GetBufferAge)(SDL_Renderer *renderer);
+    /* Optional, called before the first draw of a partially drawn frame with
+       the part of the window that will be drawn, in output pixels */
+    void (*SetDamageRegion)(SDL_Renderer *renderer, const SDL_Rect *rect);
+    /* Optional, lets the calling thread give up the graphics context so
+       another thread can render. Renderers with this can use a render thread. */
+    void (*ReleaseContext)(SDL_Renderer *renderer);
     void (*DestroyTexture)(SDL_Renderer *renderer, SDL_Texture *texture);
 
     void (*DestroyRenderer)(SDL_Renderer *renderer);
@@ -258,6 +347,8 @@ struct SDL_Renderer
 
     /* The list of textures */
     SDL_Texture *textures;
+    /* Destroyed textures the queued commands still use, freed after the next flush */
+    SDL_Texture *destroyed_textures;
     SDL_Texture *target;
     SDL_mutex *target_mutex;
 
@@ -266,6 +357,13 @@ struct SDL_Renderer
 
     SDL_bool always_batch;
     SDL_bool batching;
+    SDL_bool optimize_batches;
+    SDL_bool use_texture_atlas;
+    SDL_bool cull_draws;
+    SDL_TextureAtlas *texture_atlases;
+    SDL_bool recording_command_list;
+    SDL_RenderCommandList *command_lists;
+    SDL_RenderCapture *captures;
     SDL_RenderCommand *render_commands;
     SDL_RenderCommand *render_commands_tail;
     SDL_RenderCommand *render_commands_pool;
@@ -278,10 +376,61 @@ struct SDL_Renderer
     SDL_bool viewport_queued;
     SDL_bool cliprect_queued;
 
-    void *vertex_data;
+    SDL_RenderVertexBlock *vertex_blocks;
+    SDL_RenderVertexBlock *vertex_blocks_tail;
+    SDL_RenderVertexBlock *vertex_blocks_pool;
+    size_t vertex_data_peak; /* the most vertex data used recently, pooled blocks are trimmed to this */
+    size_t vertex_data_frame_peak; /* the most vertex data used by a flush since the last present */
+    int vertex_data_peak_age; /* in frames */
+    void *vertex_data; /* only used with GrowVertexData */
     size_t vertex_data_used;
     size_t vertex_data_allocation;
 
+    /* Scratch space for SDL_RenderCopyBatch() */
+    void *batch_data;
+    size_t batch_data_allocation;
+
+    /* Backend texture memory, restorable textures are evicted to stay in the budget */
+    Uint64 texture_memory;
+    Uint64 texture_budget;
+
+    /* Damage of the frame being drawn and of the one being presented, in
+       output pixels. RenderPresent() can pass the present damage on to the
+       window system. */
+    SDL_Rect *damage_rects;
+    int num_damage_rects;
+    int max_damage_rects;
+    SDL_Rect *present_damage_rects;
+    int num_present_damage_rects;
+    int max_present_damage_rects;
+
+    /* Bounds of the damage of the previous frames, most recent first, and
+       how many are known, -1 if the window contents are unknown */
+    SDL_Rect damage_history[SDL_RENDER_DAMAGE_HISTORY];
+    int num_damage_history;
+
+    /* The part of the window drawn in this frame, fixed at the first draw */
+    SDL_bool damage_locked;
+    SDL_bool damage_clipping;
+    SDL_Rect damage_clip;
+
+    /* Statistics of the frame being rendered and the last one presented */
+    SDL_RenderStats stats;
+    SDL_RenderStats frame_stats;
+    int log_stats_interval;
+
+    /* The render thread and the frame it's working on, see SDL_HINT_RENDER_THREAD */
+    SDL_Thread *render_thread;
+    SDL_mutex *render_thread_lock;
+    SDL_cond *render_thread_cond;
+    SDL_bool render_thread_busy;
+    SDL_bool render_thread_quit;
+    SDL_bool render_thread_present;
+    SDL_RenderCommand *render_thread_commands;
+    SDL_RenderVertexBlock *render_thread_vertex_blocks;
+    size_t render_thread_vertex_data_used;
+    SDL_Texture *render_thread_destroyed_textures;
+
     void *driverdata;
 };
 
@@ -295,8 +444,12 @@ struct SDL_RenderDriver
 };
 
 /* Not all of these are available in a given build. Use #ifdefs, etc. */
+extern SDL_RenderDriver GL3_RenderDriver;
 extern SDL_RenderDriver GL_RenderDriver;
+extern SDL_RenderDriver GLES3_RenderDriver;
 extern SDL_RenderDriver METAL_RenderDriver;
+extern SDL_RenderDriver VULKAN_RenderDriver;
+extern SDL_RenderDriver SW_RenderDriver;
 
 /* Blend mode functions */
 extern SDL_BlendFactor SDL_GetBlendModeSrcColorFactor(SDL_BlendMode blendMode);
@@ -311,6 +464,15 @@ extern SDL_BlendOperation SDL_GetBlendModeAlphaOperation(SDL_BlendMode blendMode
    the next call, because it might be in an array that gets realloc()'d. */
 extern void *SDL_AllocateRenderVertices(SDL_Renderer *renderer, const size_t numbytes, const size_t alignment, size_t *offset);
 
+/* Get the address of the vertex data at offset in a chain of vertex blocks */
+extern void *SDL_GetRenderVertexData(const SDL_RenderVertexBlock *blocks, size_t offset);
+
+/* Copy a chain of vertex blocks to dst, which has to hold all of its data */
+extern void SDL_CopyRenderVertexData(void *dst, const SDL_RenderVertexBlock *blocks);
+
+/* OpenGL renderers call this with the GL_RENDERER string to see if they're running in software */
+extern SDL_bool SDL_GL_IsProbablyAccelerated(const char *renderer);
+
 extern int SDL_PrivateLowerBlitScaled(SDL_Surface *src, SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, SDL_ScaleMode scaleMode);
 extern int SDL_PrivateUpperBlitScaled(SDL_Surface *src, const SDL_Rect *srcrect, SDL_Surface *dst, SDL_Rect *dstrect, SDL_ScaleMode scaleMode);
 
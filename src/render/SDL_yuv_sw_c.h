@@ -38,10 +38,6 @@ struct SDL_SW_YUVTexture
     /* These are just so we don't have to allocate them separately */
     Uint16 pitches[3];
     Uint8 *planes[3];
-
-    /* This is a temporary surface in case we have to stretch copy */
-    SDL_Surface *stretch;
-    SDL_Surface *display;
 };
 
 typedef struct SDL_SW_YUVTexture SDL_SW_YUVTexture;
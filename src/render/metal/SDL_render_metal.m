@@ -1260,7 +1260,7 @@ static SDL_bool SetCopyState(SDL_Renderer *renderer, const SDL_RenderCommand *cm
     return SDL_TRUE;
 }
 
-static int METAL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
+static int METAL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize)
 { @autoreleasepool {
     METAL_RenderData *data = (__bridge METAL_RenderData *) renderer->driverdata;
     id<MTLBuffer> mtlbufvertex = nil;
@@ -1288,7 +1288,7 @@ static int METAL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd
          * good for those, or should we have a managed buffer for them? */
         mtlbufvertex = [data.mtldevice newBufferWithLength:vertsize options:MTLResourceStorageModeShared];
         mtlbufvertex.label = @"SDL vertex data";
-        SDL_memcpy([mtlbufvertex contents], vertices, vertsize);
+        SDL_CopyRenderVertexData([mtlbufvertex contents], vertices);
 
         statecache.vertex_buffer = mtlbufvertex;
     }
@@ -1392,6 +1392,9 @@ static int METAL_RunCommandQueue(SDL_Renderer * renderer, SDL_RenderCommand *cmd
                 break;
             }
 
+            case SDL_RENDERCMD_UPDATE_TEXTURE: /* not queued by this backend */
+                break;
+
             case SDL_RENDERCMD_NO_OP:
                 break;
         }
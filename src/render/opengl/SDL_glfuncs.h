@@ -114,9 +114,9 @@ SDL_PROC(void, glDisable, (GLenum cap))
 SDL_PROC(void, glDisableClientState, (GLenum array))
 SDL_PROC(void, glDrawArrays, (GLenum mode, GLint first, GLsizei count))
 SDL_PROC_UNUSED(void, glDrawBuffer, (GLenum mode))
-SDL_PROC_UNUSED(void, glDrawElements,
-                (GLenum mode, GLsizei count, GLenum type,
-                 const GLvoid *indices))
+SDL_PROC(void, glDrawElements,
+         (GLenum mode, GLsizei count, GLenum type,
+          const GLvoid *indices))
 SDL_PROC(void, glDrawPixels,
          (GLsizei width, GLsizei height, GLenum format, GLenum type,
           const GLvoid *pixels))
@@ -143,7 +143,7 @@ SDL_PROC_UNUSED(void, glEvalPoint1, (GLint i))
 SDL_PROC_UNUSED(void, glEvalPoint2, (GLint i, GLint j))
 SDL_PROC_UNUSED(void, glFeedbackBuffer,
                 (GLsizei size, GLenum type, GLfloat *buffer))
-SDL_PROC_UNUSED(void, glFinish, (void))
+SDL_PROC(void, glFinish, (void))
 SDL_PROC_UNUSED(void, glFlush, (void))
 SDL_PROC_UNUSED(void, glFogf, (GLenum pname, GLfloat param))
 SDL_PROC_UNUSED(void, glFogfv, (GLenum pname, const GLfloat *params))
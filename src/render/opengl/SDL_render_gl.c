@@ -22,7 +22,7 @@
 
 #if SDL_VIDEO_RENDER_OGL
 #include "SDL_hints.h"
-#include "../../video/SDL_sysvideo.h" /* For SDL_GL_SwapWindowWithResult */
+#include "../../video/SDL_sysvideo.h" /* For SDL_GL_SwapWindowWithDamage */
 #include "SDL_opengl.h"
 #include "../SDL_sysrender.h"
 #include "SDL_shaders_gl.h"
@@ -52,13 +52,40 @@
 
 static const float inv255f = 1.0f / 255.0f;
 
-typedef struct GL_FBOList GL_FBOList;
+/* Vertex data is streamed through a persistently mapped buffer, split into
+   segments that are fenced and reused round robin. */
+#define GL_VERTEX_RING_SEGMENT_SIZE (2 * 1024 * 1024)
+#define GL_VERTEX_RING_SEGMENTS     3
 
-struct GL_FBOList
+/* Texture updates smaller than this are cheaper to upload from client memory */
+#define GL_PBO_UPLOAD_MIN_SIZE (64 * 1024)
+
+/* Texture updates bigger than this aren't copied into the command queue, they
+   flush it and go through GL_UpdateTexture(), which can use the PBO */
+#define GL_MAX_QUEUED_UPDATE_SIZE GL_PBO_UPLOAD_MIN_SIZE
+
+/* Frames that can be timed before their results have to be read back */
+#define GL_TIMER_QUERIES 4
+
+/* Released render targets are kept this many frames for reuse */
+#define GL_TARGET_POOL_MAX_AGE 120
+
+/* Megabytes of released render targets kept for reuse, by default */
+#define GL_TARGET_POOL_DEFAULT_SIZE 32
+
+typedef struct GL_PooledTarget GL_PooledTarget;
+
+/* A released render target, its texture still attached to its FBO */
+struct GL_PooledTarget
 {
-    Uint32 w, h;
+    GLuint texture;
     GLuint FBO;
-    GL_FBOList *next;
+    int w, h;
+    GLint internalFormat;
+    size_t size;
+    Uint32 released; /* the frame it was released in */
+    GL_PooledTarget *prev;
+    GL_PooledTarget *next;
 };
 
 typedef struct
@@ -83,6 +110,22 @@ typedef struct
     Uint32 clear_color;
 } GL_DrawStateCache;
 
+typedef struct GL_PixelRead GL_PixelRead;
+
+struct GL_PixelRead
+{
+    GLuint buffer;
+    GLsizeiptrARB size;
+    GLsync fence;
+    SDL_Rect rect;
+    Uint32 temp_format;
+    Uint32 format;
+    SDL_bool flip;
+    SDL_RenderReadPixelsCallback callback;
+    void *userdata;
+    GL_PixelRead *next;
+};
+
 typedef struct
 {
     SDL_GLContext context;
@@ -99,7 +142,60 @@ typedef struct
     SDL_bool GL_ARB_texture_non_power_of_two_supported;
     SDL_bool GL_ARB_texture_rectangle_supported;
     SDL_bool GL_EXT_framebuffer_object_supported;
-    GL_FBOList *framebuffers;
+
+    /* Render target pool, most recently released first */
+    GL_PooledTarget *target_pool;
+    GL_PooledTarget *target_pool_tail;
+    size_t target_pool_size;
+    size_t target_pool_budget;
+    Uint32 frame;
+
+    /* Vertex buffer support */
+    PFNGLGENBUFFERSARBPROC glGenBuffersARB;
+    PFNGLDELETEBUFFERSARBPROC glDeleteBuffersARB;
+    PFNGLBINDBUFFERARBPROC glBindBufferARB;
+    PFNGLBUFFERDATAARBPROC glBufferDataARB;
+    PFNGLBUFFERSUBDATAARBPROC glBufferSubDataARB;
+    PFNGLBUFFERSTORAGEPROC glBufferStorage;
+    PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+    PFNGLFENCESYNCPROC glFenceSync;
+    PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+    PFNGLDELETESYNCPROC glDeleteSync;
+    GLuint vertex_buffer;
+    Uint8 *vertex_ring; /* persistent mapping of vertex_buffer, if supported */
+    int vertex_ring_segment;
+    size_t vertex_ring_offset;
+    GLsync vertex_ring_fences[GL_VERTEX_RING_SEGMENTS];
+    void *vertex_overflow; /* batches that don't fit in a segment */
+    size_t vertex_overflow_allocation;
+    void *vertex_scratch; /* vertex blocks joined together, for drawing from client memory */
+    size_t vertex_scratch_size;
+
+    /* Pixel buffer support */
+    PFNGLMAPBUFFERARBPROC glMapBufferARB;
+    PFNGLUNMAPBUFFERARBPROC glUnmapBufferARB;
+    GLuint upload_buffer;
+    GL_PixelRead *pixel_reads; /* pending reads, oldest first */
+    GL_PixelRead *pixel_reads_tail;
+    GL_PixelRead *pixel_reads_pool;
+    void *readback_temp;
+    size_t readback_temp_size;
+    void *readback_pixels;
+    size_t readback_pixels_size;
+
+    /* GPU timing support */
+    PFNGLGENQUERIESPROC glGenQueries;
+    PFNGLDELETEQUERIESPROC glDeleteQueries;
+    PFNGLBEGINQUERYPROC glBeginQuery;
+    PFNGLENDQUERYPROC glEndQuery;
+    PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv;
+    PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v;
+    GLuint timer_queries[GL_TIMER_QUERIES];
+    int timer_query_first; /* the oldest query waiting for its result */
+    int timer_queries_pending;
+    SDL_bool timer_query_active;
+
+    SDL_RenderStats *stats;
 
     /* OpenGL functions */
 #define SDL_PROC(ret, func, params) ret (APIENTRY *func) params;
@@ -143,7 +239,11 @@ typedef struct
     GLuint vtexture;
 #endif
 
-    GL_FBOList *fbo;
+    /* Render targets get their own FBO, with the texture attached once */
+    GLuint fbo;
+    int storage_w;
+    int storage_h;
+    GLint internalFormat;
 } GL_TextureData;
 
 SDL_FORCE_INLINE const char *
@@ -298,25 +398,113 @@ static void APIENTRY GL_HandleDebugMessage(GLenum source, GLenum type, GLuint id
     }
 }
 
-static GL_FBOList *GL_GetFBO(GL_RenderData *data, Uint32 w, Uint32 h)
+static size_t GL_GetTargetPoolBudget(void)
 {
-    GL_FBOList *result = data->framebuffers;
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_OPENGL_TARGET_POOL);
+    const int megabytes = hint ? SDL_atoi(hint) : GL_TARGET_POOL_DEFAULT_SIZE;
 
-    while (result && ((result->w != w) || (result->h != h))) {
-        result = result->next;
+    if (megabytes <= 0) {
+        return 0;
     }
+    return (size_t)megabytes * 1024 * 1024;
+}
 
-    if (!result) {
-        result = SDL_malloc(sizeof(GL_FBOList));
-        if (result) {
-            result->w = w;
-            result->h = h;
-            data->glGenFramebuffersEXT(1, &result->FBO);
-            result->next = data->framebuffers;
-            data->framebuffers = result;
+static void GL_UnlinkPooledTarget(GL_RenderData *data, GL_PooledTarget *target)
+{
+    if (target->prev) {
+        target->prev->next = target->next;
+    } else {
+        data->target_pool = target->next;
+    }
+    if (target->next) {
+        target->next->prev = target->prev;
+    } else {
+        data->target_pool_tail = target->prev;
+    }
+    data->target_pool_size -= target->size;
+}
+
+/* Find a released render target with the same storage, the most recently
+   released one is the most likely to still be resident. */
+static GL_PooledTarget *GL_TakePooledTarget(GL_RenderData *data, int w, int h, GLint internalFormat)
+{
+    GL_PooledTarget *target;
+
+    for (target = data->target_pool; target; target = target->next) {
+        if (target->w == w && target->h == h && target->internalFormat == internalFormat) {
+            GL_UnlinkPooledTarget(data, target);
+            return target;
         }
     }
-    return result;
+    return NULL;
+}
+
+/* Delete the least recently released targets until the pool fits in size
+   bytes, and the ones that haven't been reused in a while. */
+static void GL_TrimTargetPool(GL_RenderData *data, size_t size)
+{
+    while (data->target_pool_tail &&
+           (data->target_pool_size > size ||
+            (data->frame - data->target_pool_tail->released) > GL_TARGET_POOL_MAX_AGE)) {
+        GL_PooledTarget *target = data->target_pool_tail;
+        GL_UnlinkPooledTarget(data, target);
+        data->glDeleteFramebuffersEXT(1, &target->FBO);
+        data->glDeleteTextures(1, &target->texture);
+        SDL_free(target);
+    }
+}
+
+static SDL_bool GL_ReleaseToTargetPool(GL_RenderData *data, GL_TextureData *texturedata)
+{
+    const size_t size = (size_t)texturedata->storage_w * texturedata->storage_h * 4;
+    GL_PooledTarget *target;
+
+    if (size > data->target_pool_budget) {
+        return SDL_FALSE;
+    }
+
+    target = (GL_PooledTarget *)SDL_malloc(sizeof(*target));
+    if (!target) {
+        return SDL_FALSE;
+    }
+    target->texture = texturedata->texture;
+    target->FBO = texturedata->fbo;
+    target->w = texturedata->storage_w;
+    target->h = texturedata->storage_h;
+    target->internalFormat = texturedata->internalFormat;
+    target->size = size;
+    target->released = data->frame;
+    target->prev = NULL;
+    target->next = data->target_pool;
+    if (data->target_pool) {
+        data->target_pool->prev = target;
+    } else {
+        data->target_pool_tail = target;
+    }
+    data->target_pool = target;
+    data->target_pool_size += size;
+
+    GL_TrimTargetPool(data, data->target_pool_budget);
+    return SDL_TRUE;
+}
+
+/* Pooled targets still hold whatever was last drawn into them */
+static void GL_ClearPooledTarget(GL_RenderData *data, GLuint fbo)
+{
+    GLint current = 0;
+
+    data->glGetIntegerv(GL_FRAMEBUFFER_BINDING_EXT, &current);
+    data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, fbo);
+    if (data->drawstate.cliprect_enabled || data->drawstate.cliprect_enabled_dirty) {
+        data->glDisable(GL_SCISSOR_TEST);
+        data->drawstate.cliprect_enabled_dirty = data->drawstate.cliprect_enabled;
+    }
+    if (data->drawstate.clear_color != 0) {
+        data->glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+        data->drawstate.clear_color = 0;
+    }
+    data->glClear(GL_COLOR_BUFFER_BIT);
+    data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, (GLuint)current);
 }
 
 static void GL_WindowEvent(SDL_Renderer *renderer, const SDL_WindowEvent *event)
@@ -454,6 +642,7 @@ static int GL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
     GLenum format, type;
     int texture_w, texture_h;
     GLenum scaleMode;
+    GL_PooledTarget *pooled = NULL;
 
     GL_ActivateRenderer(renderer);
 
@@ -497,23 +686,6 @@ static int GL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
         }
     }
 
-    if (texture->access == SDL_TEXTUREACCESS_TARGET) {
-        data->fbo = GL_GetFBO(renderdata, texture->w, texture->h);
-    } else {
-        data->fbo = NULL;
-    }
-
-    GL_CheckError("", renderer);
-    renderdata->glGenTextures(1, &data->texture);
-    if (GL_CheckError("glGenTextures()", renderer) < 0) {
-        if (data->pixels) {
-            SDL_free(data->pixels);
-        }
-        SDL_free(data);
-        return -1;
-    }
-    texture->driverdata = data;
-
     if (renderdata->GL_ARB_texture_non_power_of_two_supported) {
         texture_w = texture->w;
         texture_h = texture->h;
@@ -531,6 +703,31 @@ static int GL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
         data->texh = (GLfloat)texture->h / texture_h;
     }
 
+    if (texture->access == SDL_TEXTUREACCESS_TARGET && !SDL_ISPIXELFORMAT_FOURCC(texture->format)) {
+        data->storage_w = texture_w;
+        data->storage_h = texture_h;
+        data->internalFormat = internalFormat;
+        pooled = GL_TakePooledTarget(renderdata, texture_w, texture_h, internalFormat);
+    }
+
+    if (pooled) {
+        data->texture = pooled->texture;
+        data->fbo = pooled->FBO;
+        SDL_free(pooled);
+        GL_ClearPooledTarget(renderdata, data->fbo);
+    } else {
+        GL_CheckError("", renderer);
+        renderdata->glGenTextures(1, &data->texture);
+        if (GL_CheckError("glGenTextures()", renderer) < 0) {
+            if (data->pixels) {
+                SDL_free(data->pixels);
+            }
+            SDL_free(data);
+            return -1;
+        }
+    }
+    texture->driverdata = data;
+
     data->format = format;
     data->formattype = type;
     scaleMode = (texture->scaleMode == SDL_ScaleModeNearest) ? GL_NEAREST : GL_LINEAR;
@@ -574,7 +771,7 @@ static int GL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
         renderdata->glPixelStorei(GL_UNPACK_CLIENT_STORAGE_APPLE, GL_FALSE);
     } else
 #endif
-    {
+    if (!pooled) {
         renderdata->glTexImage2D(textype, 0, internalFormat, texture_w,
                                  texture_h, 0, format, type, NULL);
     }
@@ -683,12 +880,56 @@ static int GL_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
             SDL_assert(!"unsupported YUV conversion mode");
             break;
         }
+
+        /* The YUV shaders are only compiled once a texture needs them */
+        if (!GL_CompileShaders(renderdata->shaders, data->shader, data->shader)) {
+            return SDL_SetError("Couldn't compile the OpenGL shader for %s textures",
+                                SDL_GetPixelFormatName(texture->format));
+        }
     }
 #endif /* SDL_HAVE_YUV */
 
     return GL_CheckError("", renderer);
 }
 
+/* Copy the pixels into a fresh pixel buffer, so the driver can upload them
+   while we keep going instead of copying them from client memory right away */
+static SDL_bool GL_UpdateTextureFromPixelBuffer(GL_RenderData *renderdata, GL_TextureData *data,
+                                                const SDL_Rect *rect, const void *pixels, int pitch,
+                                                int texturebpp)
+{
+    const size_t length = (size_t)rect->w * texturebpp;
+    const GLsizeiptrARB size = (GLsizeiptrARB)(length * rect->h);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    renderdata->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, renderdata->upload_buffer);
+    renderdata->glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, size, NULL, GL_STREAM_DRAW_ARB);
+    dst = (Uint8 *)renderdata->glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+    if (!dst) {
+        renderdata->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+        return SDL_FALSE;
+    }
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+    if (!renderdata->glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB)) {
+        /* The buffer contents were lost, upload from client memory instead */
+        renderdata->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+        return SDL_FALSE;
+    }
+
+    renderdata->glPixelStorei(GL_UNPACK_ROW_LENGTH, rect->w);
+    renderdata->glTexSubImage2D(renderdata->textype, 0, rect->x, rect->y, rect->w,
+                                rect->h, data->format, data->formattype,
+                                NULL);
+    renderdata->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+    return SDL_TRUE;
+}
+
 static int GL_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
                             const SDL_Rect *rect, const void *pixels, int pitch)
 {
@@ -705,6 +946,16 @@ static int GL_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
 
     renderdata->glBindTexture(textype, data->texture);
     renderdata->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    if (renderdata->upload_buffer &&
+#if SDL_HAVE_YUV
+        !data->yuv && !data->nv12 &&
+#endif
+        (size_t)rect->w * rect->h * texturebpp >= GL_PBO_UPLOAD_MIN_SIZE &&
+        GL_UpdateTextureFromPixelBuffer(renderdata, data, rect, pixels, pitch, texturebpp)) {
+        return GL_CheckError("glTexSubImage2D()", renderer);
+    }
+
     renderdata->glPixelStorei(GL_UNPACK_ROW_LENGTH, (pitch / texturebpp));
     renderdata->glTexSubImage2D(textype, 0, rect->x, rect->y, rect->w,
                                 rect->h, data->format, data->formattype,
@@ -895,12 +1146,21 @@ static int GL_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
     }
 
     texturedata = (GL_TextureData *)texture->driverdata;
-    data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, texturedata->fbo->FBO);
+    if (texturedata->fbo) {
+        data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, texturedata->fbo);
+        return 0;
+    }
+
+    data->glGenFramebuffersEXT(1, &texturedata->fbo);
+    data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, texturedata->fbo);
     /* TODO: check if texture pixel format allows this operation */
     data->glFramebufferTexture2DEXT(GL_FRAMEBUFFER_EXT, GL_COLOR_ATTACHMENT0_EXT, data->textype, texturedata->texture, 0);
     /* Check FBO status */
     status = data->glCheckFramebufferStatusEXT(GL_FRAMEBUFFER_EXT);
     if (status != GL_FRAMEBUFFER_COMPLETE_EXT) {
+        data->glBindFramebufferEXT(GL_FRAMEBUFFER_EXT, 0);
+        data->glDeleteFramebuffersEXT(1, &texturedata->fbo);
+        texturedata->fbo = 0;
         return SDL_SetError("glFramebufferTexture2DEXT() failed");
     }
     return 0;
@@ -916,7 +1176,7 @@ static int GL_QueueSetViewport(SDL_Renderer *renderer, SDL_RenderCommand *cmd)
 
 static int GL_QueueDrawPoints(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
 {
-    GLfloat *verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, count * 2 * sizeof(GLfloat), 0, &cmd->data.draw.first);
+    GLfloat *verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, count * 2 * sizeof(GLfloat), 4, &cmd->data.draw.first);
     int i;
 
     if (!verts) {
@@ -937,7 +1197,7 @@ static int GL_QueueDrawLines(SDL_Renderer *renderer, SDL_RenderCommand *cmd, con
     int i;
     GLfloat prevx, prevy;
     const size_t vertlen = (sizeof(GLfloat) * 2) * count;
-    GLfloat *verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, vertlen, 0, &cmd->data.draw.first);
+    GLfloat *verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, vertlen, 4, &cmd->data.draw.first);
 
     if (!verts) {
         return -1;
@@ -972,6 +1232,33 @@ static int GL_QueueDrawLines(SDL_Renderer *renderer, SDL_RenderCommand *cmd, con
     return 0;
 }
 
+/* The pixels are copied next to the vertices, so they can be uploaded from
+   the same buffer when the queue runs */
+static int GL_QueueUpdateTexture(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                                 const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    dst = (Uint8 *)SDL_AllocateRenderVertices(renderer, length * rect->h, 16, &cmd->data.update.first);
+    if (!dst) {
+        return -1;
+    }
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+    return 0;
+}
+
+/* Small meshes are expanded, so consecutive draws can still be combined
+   into a single glDrawArrays() call */
+#define GL_MIN_INDEXED_GEOMETRY 96
+
 static int GL_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
                             const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride,
                             int num_vertices, const void *indices, int num_indices, int size_indices,
@@ -982,8 +1269,20 @@ static int GL_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_
     int count = indices ? num_indices : num_vertices;
     GLfloat *verts;
     size_t sz = 2 * sizeof(GLfloat) + 4 * sizeof(Uint8) + (texture ? 2 : 0) * sizeof(GLfloat);
+    int index_size = 0;
+
+    size_indices = indices ? size_indices : 0;
+
+    if (size_indices && num_indices >= GL_MIN_INDEXED_GEOMETRY) {
+        /* Keep the indices if the shared vertices make up for their size */
+        const int needed_index_size = (num_vertices <= 0x10000) ? 2 : 4;
+        if ((size_t)num_vertices * sz + (size_t)num_indices * needed_index_size < (size_t)num_indices * sz) {
+            index_size = needed_index_size;
+            count = num_vertices;
+        }
+    }
 
-    verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, count * sz, 0, &cmd->data.draw.first);
+    verts = (GLfloat *)SDL_AllocateRenderVertices(renderer, count * sz + (size_t)num_indices * index_size, 4, &cmd->data.draw.first);
     if (!verts) {
         return -1;
     }
@@ -993,7 +1292,38 @@ static int GL_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_
     }
 
     cmd->data.draw.count = count;
-    size_indices = indices ? size_indices : 0;
+
+    if (index_size) {
+        /* The indices go right after the vertices, in the same buffer */
+        void *dst = verts + (count * sz) / sizeof(GLfloat);
+
+        cmd->data.draw.indices = cmd->data.draw.first + count * sz;
+        cmd->data.draw.num_indices = num_indices;
+        cmd->data.draw.index_size = index_size;
+
+        if (index_size == size_indices) {
+            SDL_memcpy(dst, indices, (size_t)num_indices * index_size);
+        } else if (index_size == 2) {
+            Uint16 *dst16 = (Uint16 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 4) {
+                    dst16[i] = (Uint16)((const Uint32 *)indices)[i];
+                } else {
+                    dst16[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        } else {
+            Uint32 *dst32 = (Uint32 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 2) {
+                    dst32[i] = ((const Uint16 *)indices)[i];
+                } else {
+                    dst32[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        }
+        size_indices = 0; /* the vertices are queued in order */
+    }
 
     for (i = 0; i < count; i++) {
         int j;
@@ -1082,11 +1412,13 @@ static int SetDrawState(GL_RenderData *data, const SDL_RenderCommand *cmd, const
             data->glBlendEquation(GetBlendEquation(SDL_GetBlendModeColorOperation(blend)));
         }
         data->drawstate.blend = blend;
+        ++data->stats->blend_changes;
     }
 
     if (data->shaders && (shader != data->drawstate.shader)) {
         GL_SelectShader(data->shaders, shader);
         data->drawstate.shader = shader;
+        ++data->stats->shader_changes;
     }
 
     if ((cmd->data.draw.texture != NULL) != data->drawstate.texturing) {
@@ -1169,18 +1501,199 @@ static int SetCopyState(GL_RenderData *data, const SDL_RenderCommand *cmd)
         data->glBindTexture(textype, texturedata->texture);
 
         data->drawstate.texture = texture;
+        ++data->stats->texture_binds;
     }
 
     return 0;
 }
 
-static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, void *vertices, size_t vertsize)
+static void GL_WaitVertexRingSegment(GL_RenderData *data, int segment)
+{
+    GLsync fence = data->vertex_ring_fences[segment];
+
+    if (fence) {
+        GLenum status;
+
+        do {
+            status = data->glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000000);
+        } while (status == GL_TIMEOUT_EXPIRED);
+
+        if (status == GL_WAIT_FAILED) {
+            /* We can't tell when the GPU is done with the segment, wait for everything */
+            data->glFinish();
+        }
+        data->glDeleteSync(fence);
+        data->vertex_ring_fences[segment] = NULL;
+    }
+}
+
+static int GL_GrowVertexData(SDL_Renderer *renderer, size_t numbytes)
 {
-    /* !!! FIXME: it'd be nice to use a vertex buffer instead of immediate mode... */
     GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    const SDL_bool overflowing = (renderer->vertex_data == data->vertex_overflow);
+    size_t newsize;
 
-    if (GL_ActivateRenderer(renderer) < 0) {
-        return -1;
+    if (!overflowing && numbytes <= GL_VERTEX_RING_SEGMENT_SIZE) {
+        /* Move the batch to the next segment, once the GPU is done with it */
+        const int segment = data->vertex_ring_segment;
+        const int next = (segment + 1) % GL_VERTEX_RING_SEGMENTS;
+        Uint8 *dst = data->vertex_ring + (size_t)next * GL_VERTEX_RING_SEGMENT_SIZE;
+
+        if (GL_ActivateRenderer(renderer) < 0) {
+            return -1;
+        }
+        data->vertex_ring_fences[segment] = data->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        GL_WaitVertexRingSegment(data, next);
+
+        SDL_memcpy(dst, renderer->vertex_data, renderer->vertex_data_used);
+        data->vertex_ring_segment = next;
+        data->vertex_ring_offset = 0;
+        renderer->vertex_data = dst;
+        renderer->vertex_data_allocation = GL_VERTEX_RING_SEGMENT_SIZE;
+        return 0;
+    }
+
+    /* This batch is too big for the ring, draw it from client memory */
+    newsize = SDL_max(data->vertex_overflow_allocation, 1024);
+    while (newsize < numbytes) {
+        newsize *= 2;
+    }
+    if (newsize > data->vertex_overflow_allocation) {
+        void *ptr = SDL_realloc(data->vertex_overflow, newsize);
+        if (!ptr) {
+            return SDL_OutOfMemory();
+        }
+        data->vertex_overflow = ptr;
+        data->vertex_overflow_allocation = newsize;
+    }
+    if (!overflowing) {
+        SDL_memcpy(data->vertex_overflow, renderer->vertex_data, renderer->vertex_data_used);
+    }
+    renderer->vertex_data = data->vertex_overflow;
+    renderer->vertex_data_allocation = data->vertex_overflow_allocation;
+    return 0;
+}
+
+/* Point vertex_data at the free space after the batch that was just drawn */
+static void GL_AdvanceVertexRing(SDL_Renderer *renderer, size_t vertsize)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+
+    if (renderer->vertex_data != data->vertex_overflow) {
+        data->vertex_ring_offset += (vertsize + 15) & ~15;
+        data->vertex_ring_offset = SDL_min(data->vertex_ring_offset, GL_VERTEX_RING_SEGMENT_SIZE);
+    }
+    renderer->vertex_data = data->vertex_ring + (size_t)data->vertex_ring_segment * GL_VERTEX_RING_SEGMENT_SIZE + data->vertex_ring_offset;
+    renderer->vertex_data_allocation = GL_VERTEX_RING_SEGMENT_SIZE - data->vertex_ring_offset;
+}
+
+static void GL_CreateVertexBuffer(SDL_Renderer *renderer)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_READ_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = (GLsizeiptr)GL_VERTEX_RING_SEGMENT_SIZE * GL_VERTEX_RING_SEGMENTS;
+
+    if (SDL_GL_ExtensionSupported("GL_ARB_sync")) {
+        data->glFenceSync = (PFNGLFENCESYNCPROC)SDL_GL_GetProcAddress("glFenceSync");
+        data->glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)SDL_GL_GetProcAddress("glClientWaitSync");
+        data->glDeleteSync = (PFNGLDELETESYNCPROC)SDL_GL_GetProcAddress("glDeleteSync");
+        if (!data->glFenceSync || !data->glClientWaitSync || !data->glDeleteSync) {
+            data->glFenceSync = NULL;
+            data->glClientWaitSync = NULL;
+            data->glDeleteSync = NULL;
+        }
+    }
+
+    if (SDL_GL_ExtensionSupported("GL_ARB_vertex_buffer_object")) {
+        data->glGenBuffersARB = (PFNGLGENBUFFERSARBPROC)SDL_GL_GetProcAddress("glGenBuffersARB");
+        data->glDeleteBuffersARB = (PFNGLDELETEBUFFERSARBPROC)SDL_GL_GetProcAddress("glDeleteBuffersARB");
+        data->glBindBufferARB = (PFNGLBINDBUFFERARBPROC)SDL_GL_GetProcAddress("glBindBufferARB");
+        data->glBufferDataARB = (PFNGLBUFFERDATAARBPROC)SDL_GL_GetProcAddress("glBufferDataARB");
+        data->glBufferSubDataARB = (PFNGLBUFFERSUBDATAARBPROC)SDL_GL_GetProcAddress("glBufferSubDataARB");
+        if (data->glGenBuffersARB && data->glDeleteBuffersARB && data->glBindBufferARB && data->glBufferDataARB && data->glBufferSubDataARB) {
+            data->glGenBuffersARB(1, &data->vertex_buffer);
+        }
+    }
+
+    /* SDL may read back queued vertices, so the mapping is readable too.
+       The render thread double buffers the vertex data itself, so it can't
+       use the ring. */
+    if (data->vertex_buffer &&
+        !SDL_GetHintBoolean(SDL_HINT_RENDER_THREAD, SDL_FALSE) &&
+        SDL_GL_ExtensionSupported("GL_ARB_buffer_storage") &&
+        SDL_GL_ExtensionSupported("GL_ARB_map_buffer_range") &&
+        data->glFenceSync) {
+        data->glBufferStorage = (PFNGLBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glBufferStorage");
+        data->glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapBufferRange");
+        if (data->glBufferStorage && data->glMapBufferRange) {
+            data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, data->vertex_buffer);
+            data->glBufferStorage(GL_ARRAY_BUFFER_ARB, size, NULL, flags);
+            data->vertex_ring = (Uint8 *)data->glMapBufferRange(GL_ARRAY_BUFFER_ARB, 0, size, flags);
+            data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+
+            if (!data->vertex_ring) {
+                /* The buffer may have immutable storage now, start over */
+                data->glDeleteBuffersARB(1, &data->vertex_buffer);
+                data->glGenBuffersARB(1, &data->vertex_buffer);
+            }
+        }
+    }
+
+    if (data->vertex_ring) {
+        renderer->GrowVertexData = GL_GrowVertexData;
+        renderer->vertex_data = data->vertex_ring;
+        renderer->vertex_data_allocation = GL_VERTEX_RING_SEGMENT_SIZE;
+    }
+    SDL_LogInfo(SDL_LOG_CATEGORY_RENDER, "OpenGL vertex buffer: %s",
+                data->vertex_ring ? "PERSISTENT" : (data->vertex_buffer ? "STREAMING" : "DISABLED"));
+}
+
+/* Time the frame from its first draw until it's presented */
+static void GL_BeginTimerQuery(GL_RenderData *data)
+{
+    int query;
+
+    if (data->timer_query_active || data->timer_queries_pending == GL_TIMER_QUERIES) {
+        return; /* already timing, or out of queries until the GPU catches up */
+    }
+
+    query = (data->timer_query_first + data->timer_queries_pending) % GL_TIMER_QUERIES;
+    data->glBeginQuery(GL_TIME_ELAPSED, data->timer_queries[query]);
+    data->timer_query_active = SDL_TRUE;
+}
+
+static void GL_EndTimerQuery(GL_RenderData *data)
+{
+    if (data->timer_query_active) {
+        data->glEndQuery(GL_TIME_ELAPSED);
+        data->timer_query_active = SDL_FALSE;
+        ++data->timer_queries_pending;
+    }
+
+    while (data->timer_queries_pending > 0) {
+        const GLuint query = data->timer_queries[data->timer_query_first];
+        GLint available = 0;
+        GLuint64 elapsed = 0;
+
+        data->glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            break;
+        }
+        data->glGetQueryObjectui64v(query, GL_QUERY_RESULT, &elapsed);
+        data->stats->gpu_time = (float)((double)elapsed / 1000000.0);
+
+        data->timer_query_first = (data->timer_query_first + 1) % GL_TIMER_QUERIES;
+        --data->timer_queries_pending;
+    }
+}
+
+/* Draw the commands, vertices is an offset if a vertex buffer is bound */
+static void GL_DrawCommands(SDL_Renderer *renderer, SDL_RenderCommand *cmd, void *vertices, GLuint buffer)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+
+    if (data->glBeginQuery) {
+        GL_BeginTimerQuery(data);
     }
 
     data->drawstate.target = renderer->target;
@@ -1330,10 +1843,12 @@ static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
             SDL_RenderCommand *nextcmd = cmd->next;
             size_t count = cmd->data.draw.count;
             int ret;
-            while (nextcmd) {
+            while (nextcmd && !cmd->data.draw.index_size) {
                 const SDL_RenderCommandType nextcmdtype = nextcmd->command;
                 if (nextcmdtype != thiscmdtype) {
                     break; /* can't go any further on this draw call, different render command up next. */
+                } else if (nextcmd->data.draw.index_size) {
+                    break; /* can't go any further on this draw call, indexed geometry up next. */
                 } else if (nextcmd->data.draw.texture != thistexture || nextcmd->data.draw.blend != thisblend) {
                     break; /* can't go any further on this draw call, different texture/blendmode copy up next. */
                 } else {
@@ -1371,7 +1886,13 @@ static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
                     }
                 }
 
-                data->glDrawArrays(op, 0, (GLsizei)count);
+                if (cmd->data.draw.index_size) {
+                    /* The indices are in the same buffer as the vertices */
+                    const GLenum type = (cmd->data.draw.index_size == 4) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+                    data->glDrawElements(op, (GLsizei)cmd->data.draw.num_indices, type, ((Uint8 *)vertices) + cmd->data.draw.indices);
+                } else {
+                    data->glDrawArrays(op, 0, (GLsizei)count);
+                }
 
                 /* Restore previously set color when we're done. */
                 if (thiscmdtype != SDL_RENDERCMD_DRAW_POINTS) {
@@ -1388,6 +1909,27 @@ static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
             break;
         }
 
+        case SDL_RENDERCMD_UPDATE_TEXTURE:
+        {
+            const SDL_Rect *rect = &cmd->data.update.rect;
+            GL_TextureData *texturedata = (GL_TextureData *)cmd->data.update.texture->driverdata;
+
+            if (buffer) {
+                data->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffer);
+            }
+            data->glBindTexture(data->textype, texturedata->texture);
+            data->drawstate.texture = NULL; /* we trash this state. */
+            data->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            data->glPixelStorei(GL_UNPACK_ROW_LENGTH, rect->w);
+            data->glTexSubImage2D(data->textype, 0, rect->x, rect->y, rect->w, rect->h,
+                                  texturedata->format, texturedata->formattype,
+                                  ((Uint8 *)vertices) + cmd->data.update.first);
+            if (buffer) {
+                data->glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+            }
+            break;
+        }
+
         case SDL_RENDERCMD_NO_OP:
             break;
         }
@@ -1409,10 +1951,150 @@ static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, vo
         data->glDisableClientState(GL_TEXTURE_COORD_ARRAY);
         data->drawstate.texture_array = SDL_FALSE;
     }
+}
+
+/* Upload vertex blocks to the bound array buffer, at their offsets */
+static void GL_UploadVertexBlocks(GL_RenderData *data, const SDL_RenderVertexBlock *vertices, size_t vertsize, GLenum usage)
+{
+    if (!vertices->next) {
+        data->glBufferDataARB(GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)vertsize, vertices->data, usage);
+        return;
+    }
+
+    data->glBufferDataARB(GL_ARRAY_BUFFER_ARB, (GLsizeiptrARB)vertsize, NULL, usage);
+    for (; vertices; vertices = vertices->next) {
+        data->glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, (GLintptrARB)vertices->offset, (GLsizeiptrARB)vertices->used, vertices->data);
+    }
+}
+
+/* Drawing from client memory needs the vertex blocks in one piece */
+static void *GL_JoinVertexBlocks(GL_RenderData *data, const SDL_RenderVertexBlock *vertices, size_t vertsize)
+{
+    if (!vertices || !vertices->next) {
+        return vertices ? vertices->data : NULL;
+    }
+
+    if (data->vertex_scratch_size < vertsize) {
+        void *ptr = SDL_realloc(data->vertex_scratch, vertsize);
+        if (!ptr) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        data->vertex_scratch = ptr;
+        data->vertex_scratch_size = vertsize;
+    }
+    SDL_CopyRenderVertexData(data->vertex_scratch, vertices);
+    return data->vertex_scratch;
+}
+
+static int GL_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    SDL_bool use_vertex_buffer = SDL_FALSE;
+    void *pointer;
+
+    if (GL_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    if (data->vertex_ring) {
+        /* The backend owns the vertex data, so it's always one block */
+        pointer = vertices->data;
+        if (pointer != data->vertex_overflow) {
+            /* The vertices are already in the buffer, draw from their offset */
+            data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, data->vertex_buffer);
+            data->glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, data->vertex_buffer);
+            pointer = (void *)(uintptr_t)((Uint8 *)pointer - data->vertex_ring);
+            use_vertex_buffer = SDL_TRUE;
+        }
+    } else if (data->vertex_buffer && vertsize > 0) {
+        /* Orphan the old contents, so we don't wait for draws still using them */
+        data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, data->vertex_buffer);
+        GL_UploadVertexBlocks(data, vertices, vertsize, GL_STREAM_DRAW_ARB);
+        data->glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, data->vertex_buffer);
+        pointer = NULL;
+        use_vertex_buffer = SDL_TRUE;
+    } else {
+        pointer = GL_JoinVertexBlocks(data, vertices, vertsize);
+        if (!pointer && vertsize > 0) {
+            return -1;
+        }
+    }
+
+    GL_DrawCommands(renderer, cmd, pointer, use_vertex_buffer ? data->vertex_buffer : 0);
+
+    if (use_vertex_buffer) {
+        data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        data->glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+    }
+    if (data->vertex_ring) {
+        GL_AdvanceVertexRing(renderer, vertsize);
+    }
 
     return GL_CheckError("", renderer);
 }
 
+/* Command lists keep their vertices in a buffer of their own, uploaded once */
+static int GL_CreateCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    GLuint buffer = 0;
+
+    if (!data->vertex_buffer || list->vertex_data_used == 0) {
+        return 0; /* draw from client memory */
+    }
+
+    if (GL_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    data->glGenBuffersARB(1, &buffer);
+    data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+    GL_UploadVertexBlocks(data, list->vertex_blocks, list->vertex_data_used, GL_STATIC_DRAW_ARB);
+    data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+    list->driverdata = (void *)(uintptr_t)buffer;
+
+    return GL_CheckError("glBufferDataARB()", renderer);
+}
+
+static int GL_RunCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    const GLuint buffer = (GLuint)(uintptr_t)list->driverdata;
+
+    if (GL_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    if (buffer) {
+        data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, buffer);
+        data->glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, buffer);
+        GL_DrawCommands(renderer, list->commands, NULL, buffer);
+        data->glBindBufferARB(GL_ARRAY_BUFFER_ARB, 0);
+        data->glBindBufferARB(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+    } else {
+        void *pointer = GL_JoinVertexBlocks(data, list->vertex_blocks, list->vertex_data_used);
+        if (!pointer && list->vertex_data_used > 0) {
+            return -1;
+        }
+        GL_DrawCommands(renderer, list->commands, pointer, 0);
+    }
+
+    return GL_CheckError("", renderer);
+}
+
+static void GL_DestroyCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    GLuint buffer = (GLuint)(uintptr_t)list->driverdata;
+
+    if (buffer) {
+        GL_ActivateRenderer(renderer);
+        data->glDeleteBuffersARB(1, &buffer);
+    }
+    list->driverdata = NULL;
+}
+
 static int GL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
                                Uint32 pixel_format, void *pixels, int pitch)
 {
@@ -1483,11 +2165,276 @@ static int GL_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
     return status;
 }
 
+static int GL_RenderReadPixelsAsync(SDL_Renderer *renderer, const SDL_Rect *rect, Uint32 pixel_format,
+                                    SDL_RenderReadPixelsCallback callback, void *userdata)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    Uint32 temp_format = renderer->target ? renderer->target->format : SDL_PIXELFORMAT_ARGB8888;
+    GLint internalFormat;
+    GLenum format, type;
+    GLsizeiptrARB size;
+    GL_PixelRead *read;
+    int w, h;
+
+    GL_ActivateRenderer(renderer);
+
+    if (!convert_format(data, temp_format, &internalFormat, &format, &type)) {
+        return SDL_SetError("Texture format %s not supported by OpenGL",
+                            SDL_GetPixelFormatName(temp_format));
+    }
+
+    read = data->pixel_reads_pool;
+    if (read) {
+        data->pixel_reads_pool = read->next;
+    } else {
+        read = (GL_PixelRead *)SDL_calloc(1, sizeof(*read));
+        if (!read) {
+            return SDL_OutOfMemory();
+        }
+        data->glGenBuffersARB(1, &read->buffer);
+    }
+    read->rect = *rect;
+    read->temp_format = temp_format;
+    read->format = pixel_format;
+    read->flip = renderer->target ? SDL_FALSE : SDL_TRUE;
+    read->callback = callback;
+    read->userdata = userdata;
+    read->next = NULL;
+
+    SDL_GetRendererOutputSize(renderer, &w, &h);
+
+    data->glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, read->buffer);
+    size = (GLsizeiptrARB)rect->w * rect->h * SDL_BYTESPERPIXEL(temp_format);
+    if (size > read->size) {
+        data->glBufferDataARB(GL_PIXEL_PACK_BUFFER_ARB, size, NULL, GL_STREAM_READ_ARB);
+        read->size = size;
+    }
+
+    data->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    data->glPixelStorei(GL_PACK_ROW_LENGTH, rect->w);
+
+    data->glReadPixels(rect->x, renderer->target ? rect->y : (h - rect->y) - rect->h,
+                       rect->w, rect->h, format, type, NULL);
+    data->glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    if (GL_CheckError("glReadPixels()", renderer) < 0) {
+        read->next = data->pixel_reads_pool;
+        data->pixel_reads_pool = read;
+        return -1;
+    }
+
+    read->fence = data->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (data->pixel_reads_tail) {
+        data->pixel_reads_tail->next = read;
+    } else {
+        data->pixel_reads = read;
+    }
+    data->pixel_reads_tail = read;
+    return 0;
+}
+
+static void *GL_GetReadbackBuffer(void **buffer, size_t *allocation, size_t size)
+{
+    if (size > *allocation) {
+        void *ptr = SDL_realloc(*buffer, size);
+        if (!ptr) {
+            return NULL;
+        }
+        *buffer = ptr;
+        *allocation = size;
+    }
+    return *buffer;
+}
+
+/* Deliver the pixels of a read, or NULL if the GPU couldn't tell us it was done */
+static void GL_FinishPixelRead(GL_RenderData *data, GL_PixelRead *read, SDL_bool ready)
+{
+    const SDL_Rect *rect = &read->rect;
+    const int temp_pitch = rect->w * SDL_BYTESPERPIXEL(read->temp_format);
+    const int pitch = rect->w * SDL_BYTESPERPIXEL(read->format);
+    const Uint8 *src = NULL;
+    void *pixels = NULL;
+
+    data->glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, read->buffer);
+    if (ready) {
+        src = (const Uint8 *)data->glMapBufferARB(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY_ARB);
+    }
+    if (src) {
+        /* Flip the rows to be top-down if necessary */
+        if (read->flip) {
+            Uint8 *dst = (Uint8 *)GL_GetReadbackBuffer(&data->readback_temp, &data->readback_temp_size, (size_t)rect->h * temp_pitch);
+            if (dst) {
+                int row;
+                for (row = 0; row < rect->h; ++row) {
+                    SDL_memcpy(dst + (size_t)row * temp_pitch, src + (size_t)(rect->h - 1 - row) * temp_pitch, temp_pitch);
+                }
+            }
+            src = dst;
+        }
+
+        if (src) {
+            pixels = GL_GetReadbackBuffer(&data->readback_pixels, &data->readback_pixels_size, (size_t)rect->h * pitch);
+        }
+        if (pixels && SDL_ConvertPixels(rect->w, rect->h,
+                                        read->temp_format, src, temp_pitch,
+                                        read->format, pixels, pitch) < 0) {
+            pixels = NULL;
+        }
+        data->glUnmapBufferARB(GL_PIXEL_PACK_BUFFER_ARB);
+    }
+    data->glBindBufferARB(GL_PIXEL_PACK_BUFFER_ARB, 0);
+
+    read->callback(read->userdata, rect, read->format, pixels, pitch);
+}
+
+static int GL_PollReadPixels(SDL_Renderer *renderer, SDL_bool wait)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    GL_PixelRead *read;
+    SDL_bool failed = SDL_FALSE;
+    int pending = 0;
+
+    if (!data->pixel_reads) {
+        return 0;
+    }
+
+    if (GL_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    while (data->pixel_reads) {
+        const GLuint64 timeout = wait ? 1000000000 : 0;
+        GLenum status;
+
+        read = data->pixel_reads;
+        do {
+            status = data->glClientWaitSync(read->fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        } while (wait && status == GL_TIMEOUT_EXPIRED);
+
+        if (status == GL_TIMEOUT_EXPIRED) {
+            break;
+        }
+        if (status == GL_WAIT_FAILED) {
+            /* The buffer may not hold the pixels yet, drop this read */
+            SDL_SetError("Couldn't wait for the pixel read to finish");
+            failed = SDL_TRUE;
+        }
+
+        /* Reads finish in order, so everything after this is still pending */
+        data->glDeleteSync(read->fence);
+        read->fence = NULL;
+        data->pixel_reads = read->next;
+        if (!data->pixel_reads) {
+            data->pixel_reads_tail = NULL;
+        }
+
+        GL_FinishPixelRead(data, read, status != GL_WAIT_FAILED);
+
+        read->callback = NULL;
+        read->userdata = NULL;
+        read->next = data->pixel_reads_pool;
+        data->pixel_reads_pool = read;
+    }
+
+    if (failed) {
+        return -1;
+    }
+
+    for (read = data->pixel_reads; read; read = read->next) {
+        ++pending;
+    }
+    return pending;
+}
+
+static void GL_CreateTimerQueries(SDL_Renderer *renderer)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+    const char *get_ui64 = NULL;
+
+    if (!SDL_GetHintBoolean(SDL_HINT_RENDER_GPU_TIMING, SDL_FALSE)) {
+        return;
+    }
+    if (SDL_GL_ExtensionSupported("GL_ARB_timer_query")) {
+        get_ui64 = "glGetQueryObjectui64v";
+    } else if (SDL_GL_ExtensionSupported("GL_EXT_timer_query")) {
+        get_ui64 = "glGetQueryObjectui64vEXT";
+    } else {
+        return;
+    }
+
+    data->glGenQueries = (PFNGLGENQUERIESPROC)SDL_GL_GetProcAddress("glGenQueries");
+    data->glDeleteQueries = (PFNGLDELETEQUERIESPROC)SDL_GL_GetProcAddress("glDeleteQueries");
+    data->glBeginQuery = (PFNGLBEGINQUERYPROC)SDL_GL_GetProcAddress("glBeginQuery");
+    data->glEndQuery = (PFNGLENDQUERYPROC)SDL_GL_GetProcAddress("glEndQuery");
+    data->glGetQueryObjectiv = (PFNGLGETQUERYOBJECTIVPROC)SDL_GL_GetProcAddress("glGetQueryObjectiv");
+    data->glGetQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VPROC)SDL_GL_GetProcAddress(get_ui64);
+    if (!data->glGenQueries || !data->glDeleteQueries || !data->glBeginQuery ||
+        !data->glEndQuery || !data->glGetQueryObjectiv || !data->glGetQueryObjectui64v) {
+        data->glBeginQuery = NULL; /* this turns timing off */
+        return;
+    }
+
+    data->glGenQueries(GL_TIMER_QUERIES, data->timer_queries);
+}
+
+static void GL_CreatePixelBuffers(SDL_Renderer *renderer)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+
+    /* This needs the buffer object functions loaded for the vertex buffer */
+    if (!data->vertex_buffer || !SDL_GL_ExtensionSupported("GL_ARB_pixel_buffer_object")) {
+        return;
+    }
+    data->glMapBufferARB = (PFNGLMAPBUFFERARBPROC)SDL_GL_GetProcAddress("glMapBufferARB");
+    data->glUnmapBufferARB = (PFNGLUNMAPBUFFERARBPROC)SDL_GL_GetProcAddress("glUnmapBufferARB");
+    if (!data->glMapBufferARB || !data->glUnmapBufferARB) {
+        return;
+    }
+
+    data->glGenBuffersARB(1, &data->upload_buffer);
+
+    /* We need fences to know when a read is done without waiting for it */
+    if (data->glFenceSync) {
+        renderer->RenderReadPixelsAsync = GL_RenderReadPixelsAsync;
+        renderer->PollReadPixels = GL_PollReadPixels;
+    }
+}
+
 static int GL_RenderPresent(SDL_Renderer *renderer)
 {
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+
     GL_ActivateRenderer(renderer);
 
-    return SDL_GL_SwapWindowWithResult(renderer->window);
+    if (data->glBeginQuery) {
+        GL_EndTimerQuery(data);
+    }
+
+    ++data->frame;
+    GL_TrimTargetPool(data, data->target_pool_budget);
+
+    return SDL_GL_SwapWindowWithDamage(renderer->window, renderer->present_damage_rects, renderer->num_present_damage_rects);
+}
+
+static int GL_GetBufferAge(SDL_Renderer *renderer)
+{
+    GL_ActivateRenderer(renderer);
+
+    return SDL_GL_GetBufferAge(renderer->window);
+}
+
+static void GL_SetDamageRegion(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    SDL_GL_SetDamageRegion(renderer->window, rect, 1);
+}
+
+static void GL_ReleaseContext(SDL_Renderer *renderer)
+{
+    GL_RenderData *data = (GL_RenderData *)renderer->driverdata;
+
+    if (SDL_GL_GetCurrentContext() == data->context) {
+        SDL_GL_MakeCurrent(renderer->window, NULL);
+    }
 }
 
 static void GL_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
@@ -1507,8 +2454,15 @@ static void GL_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
     if (!data) {
         return;
     }
-    if (data->texture) {
-        renderdata->glDeleteTextures(1, &data->texture);
+    if (data->fbo && data->storage_w && GL_ReleaseToTargetPool(renderdata, data)) {
+        /* The texture and its FBO are reused by the next target this size */
+    } else {
+        if (data->fbo) {
+            renderdata->glDeleteFramebuffersEXT(1, &data->fbo);
+        }
+        if (data->texture) {
+            renderdata->glDeleteTextures(1, &data->texture);
+        }
     }
 #if SDL_HAVE_YUV
     if (data->yuv) {
@@ -1543,16 +2497,39 @@ static void GL_DestroyRenderer(SDL_Renderer *renderer)
             GL_DestroyShaderContext(data->shaders);
         }
         if (data->context) {
-            while (data->framebuffers) {
-                GL_FBOList *nextnode = data->framebuffers->next;
-                /* delete the framebuffer object */
-                data->glDeleteFramebuffersEXT(1, &data->framebuffers->FBO);
-                GL_CheckError("", renderer);
-                SDL_free(data->framebuffers);
-                data->framebuffers = nextnode;
+            if (data->vertex_buffer) {
+                int i;
+                for (i = 0; i < GL_VERTEX_RING_SEGMENTS; ++i) {
+                    if (data->vertex_ring_fences[i]) {
+                        data->glDeleteSync(data->vertex_ring_fences[i]);
+                    }
+                }
+                /* Deleting the buffer unmaps it */
+                data->glDeleteBuffersARB(1, &data->vertex_buffer);
+            }
+            if (data->upload_buffer) {
+                data->glDeleteBuffersARB(1, &data->upload_buffer);
+            }
+            if (data->glBeginQuery) {
+                if (data->timer_query_active) {
+                    data->glEndQuery(GL_TIME_ELAPSED);
+                }
+                data->glDeleteQueries(GL_TIMER_QUERIES, data->timer_queries);
             }
+            while (data->pixel_reads_pool) {
+                GL_PixelRead *nextnode = data->pixel_reads_pool->next;
+                data->glDeleteBuffersARB(1, &data->pixel_reads_pool->buffer);
+                SDL_free(data->pixel_reads_pool);
+                data->pixel_reads_pool = nextnode;
+            }
+            GL_TrimTargetPool(data, 0);
+            GL_CheckError("", renderer);
             SDL_GL_DeleteContext(data->context);
         }
+        SDL_free(data->vertex_overflow);
+        SDL_free(data->vertex_scratch);
+        SDL_free(data->readback_temp);
+        SDL_free(data->readback_pixels);
         SDL_free(data);
     }
     SDL_free(renderer);
@@ -1674,32 +2651,6 @@ static int GL_SetVSync(SDL_Renderer *renderer, const int vsync)
     return retval;
 }
 
-static SDL_bool GL_IsProbablyAccelerated(const GL_RenderData *data)
-{
-    /*const char *vendor = (const char *) data->glGetString(GL_VENDOR);*/
-    const char *renderer = (const char *)data->glGetString(GL_RENDERER);
-
-#if defined(__WINDOWS__) || defined(__WINGDK__)
-    if (SDL_strcmp(renderer, "GDI Generic") == 0) {
-        return SDL_FALSE; /* Microsoft's fallback software renderer. Fix your system! */
-    }
-#endif
-
-#ifdef __APPLE__
-    if (SDL_strcmp(renderer, "Apple Software Renderer") == 0) {
-        return SDL_FALSE; /* (a probably very old) Apple software-based OpenGL. */
-    }
-#endif
-
-    if (SDL_strcmp(renderer, "Software Rasterizer") == 0) {
-        return SDL_FALSE; /* (a probably very old) Software Mesa, or some other generic thing. */
-    }
-
-    /* !!! FIXME: swrast? llvmpipe? softpipe? */
-
-    return SDL_TRUE;
-}
-
 static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
 {
     SDL_Renderer *renderer;
@@ -1763,8 +2714,14 @@ static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
     renderer->QueueDrawLines = GL_QueueDrawLines;
     renderer->QueueGeometry = GL_QueueGeometry;
     renderer->RunCommandQueue = GL_RunCommandQueue;
+    renderer->CreateCommandList = GL_CreateCommandList;
+    renderer->RunCommandList = GL_RunCommandList;
+    renderer->DestroyCommandList = GL_DestroyCommandList;
     renderer->RenderReadPixels = GL_RenderReadPixels;
     renderer->RenderPresent = GL_RenderPresent;
+    renderer->GetBufferAge = GL_GetBufferAge;
+    renderer->SetDamageRegion = GL_SetDamageRegion;
+    renderer->ReleaseContext = GL_ReleaseContext;
     renderer->DestroyTexture = GL_DestroyTexture;
     renderer->DestroyRenderer = GL_DestroyRenderer;
     renderer->SetVSync = GL_SetVSync;
@@ -1773,6 +2730,7 @@ static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
     renderer->info = GL_RenderDriver.info;
     renderer->info.flags = 0; /* will set some flags below. */
     renderer->driverdata = data;
+    data->stats = &renderer->stats;
     renderer->window = window;
 
     data->context = SDL_GL_CreateContext(window);
@@ -1795,7 +2753,7 @@ static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
         goto error;
     }
 
-    if (GL_IsProbablyAccelerated(data)) {
+    if (SDL_GL_IsProbablyAccelerated((const char *)data->glGetString(GL_RENDERER))) {
         renderer->info.flags |= SDL_RENDERER_ACCELERATED;
     }
 
@@ -1885,6 +2843,10 @@ static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
     if (SDL_GetHintBoolean(SDL_HINT_RENDER_OPENGL_SHADERS, SDL_TRUE)) {
         data->shaders = GL_CreateShaderContext();
     }
+    if (data->shaders) {
+        /* Nearly everything draws with these, the rest wait until they're needed */
+        GL_CompileShaders(data->shaders, SHADER_SOLID, SHADER_RGBA);
+    }
     SDL_LogInfo(SDL_LOG_CATEGORY_RENDER, "OpenGL shaders: %s",
                 data->shaders ? "ENABLED" : "DISABLED");
 #if SDL_HAVE_YUV
@@ -1925,7 +2887,16 @@ static SDL_Renderer *GL_CreateRenderer(SDL_Window *window, Uint32 flags)
             SDL_GL_GetProcAddress("glCheckFramebufferStatusEXT");
         renderer->info.flags |= SDL_RENDERER_TARGETTEXTURE;
     }
-    data->framebuffers = NULL;
+    data->target_pool_budget = GL_GetTargetPoolBudget();
+
+    GL_CreateVertexBuffer(renderer);
+    GL_CreatePixelBuffers(renderer);
+    if (data->upload_buffer || !data->vertex_buffer) {
+        /* Queued pixels have to be read from wherever the vertices are */
+        renderer->QueueUpdateTexture = GL_QueueUpdateTexture;
+        renderer->max_queued_update_size = GL_MAX_QUEUED_UPDATE_SIZE;
+    }
+    GL_CreateTimerQueries(renderer);
 
     /* Set up parameters for rendering */
     data->glMatrixMode(GL_MODELVIEW);
@@ -23,7 +23,9 @@
 #if SDL_VIDEO_RENDER_OGL
 
 #include "SDL_stdinc.h"
+#include "SDL_hints.h"
 #include "SDL_opengl.h"
+#include "SDL_rwops.h"
 #include "SDL_video.h"
 #include "SDL_shaders_gl.h"
 
@@ -36,6 +38,7 @@ typedef struct
     GLhandleARB program;
     GLhandleARB vert_shader;
     GLhandleARB frag_shader;
+    SDL_bool compiled; /* shaders are compiled on first use */
 } GL_ShaderData;
 
 struct GL_ShaderContext
@@ -56,6 +59,14 @@ struct GL_ShaderContext
     PFNGLUNIFORM1FARBPROC glUniform1fARB;
     PFNGLUSEPROGRAMOBJECTARBPROC glUseProgramObjectARB;
 
+    /* GL_ARB_get_program_binary, for the program cache */
+    PFNGLGETPROGRAMIVPROC glGetProgramiv;
+    PFNGLGETPROGRAMBINARYPROC glGetProgramBinary;
+    PFNGLPROGRAMBINARYPROC glProgramBinary;
+    PFNGLPROGRAMPARAMETERIPROC glProgramParameteri;
+    char *cache_path;  /* NULL if programs aren't cached */
+    Uint32 driver_crc; /* identifies the driver the cached programs are for */
+
     SDL_bool GL_ARB_texture_rectangle_supported;
 
     GL_ShaderData shaders[NUM_SHADERS];
@@ -423,11 +434,129 @@ static SDL_bool CompileShader(GL_ShaderContext *ctx, GLhandleARB shader, const c
     }
 }
 
+/* Cached programs are stored with this header, in native byte order */
+#define PROGRAM_CACHE_MAGIC 0x42504753 /* "SGPB" */
+
+typedef struct
+{
+    Uint32 magic;
+    Uint32 driver_crc;
+    Uint32 source_crc;
+    Uint32 format;
+    Uint32 length;
+    Uint32 data_crc;
+} GL_ProgramCacheHeader;
+
+static Uint32 GetShaderSourceCRC(const char *vert_defines, const char *frag_defines, int index)
+{
+    Uint32 crc = 0;
+
+    crc = SDL_crc32(crc, vert_defines, SDL_strlen(vert_defines));
+    crc = SDL_crc32(crc, shader_source[index][0], SDL_strlen(shader_source[index][0]));
+    crc = SDL_crc32(crc, frag_defines, SDL_strlen(frag_defines));
+    crc = SDL_crc32(crc, shader_source[index][1], SDL_strlen(shader_source[index][1]));
+    return crc;
+}
+
+static SDL_RWops *OpenProgramCache(GL_ShaderContext *ctx, Uint32 source_crc, const char *mode)
+{
+    const size_t len = SDL_strlen(ctx->cache_path);
+    const char *separator = "/";
+    SDL_RWops *rw;
+    char *path;
+
+    if (len > 0 && (ctx->cache_path[len - 1] == '/' || ctx->cache_path[len - 1] == '\\')) {
+        separator = "";
+    }
+    if (SDL_asprintf(&path, "%s%sSDL_gl_%08x_%08x.bin", ctx->cache_path, separator, ctx->driver_crc, source_crc) < 0) {
+        return NULL;
+    }
+    rw = SDL_RWFromFile(path, mode);
+    SDL_free(path);
+    return rw;
+}
+
+static SDL_bool LoadCachedProgram(GL_ShaderContext *ctx, Uint32 source_crc, GL_ShaderData *data)
+{
+    GL_ProgramCacheHeader header;
+    SDL_RWops *rw;
+    void *binary = NULL;
+    GLint status = 0;
+    Sint64 size;
+
+    rw = OpenProgramCache(ctx, source_crc, "rb");
+    if (!rw) {
+        return SDL_FALSE;
+    }
+
+    /* Don't trust the length in a truncated or corrupted file */
+    size = SDL_RWsize(rw);
+    if (SDL_RWread(rw, &header, sizeof(header), 1) == 1 &&
+        header.magic == PROGRAM_CACHE_MAGIC &&
+        header.driver_crc == ctx->driver_crc &&
+        header.source_crc == source_crc &&
+        header.length > 0 && header.length <= SDL_MAX_SINT32 &&
+        (Sint64)header.length <= size - (Sint64)sizeof(header)) {
+        binary = SDL_malloc(header.length);
+        if (binary && SDL_RWread(rw, binary, header.length, 1) == 1 &&
+            SDL_crc32(0, binary, header.length) == header.data_crc) {
+            ctx->glGetError();
+            ctx->glProgramBinary((GLuint)(uintptr_t)data->program, header.format, binary, (GLsizei)header.length);
+            ctx->glGetObjectParameterivARB(data->program, GL_OBJECT_LINK_STATUS_ARB, &status);
+            if (ctx->glGetError() != GL_NO_ERROR) {
+                status = 0;
+            }
+        }
+        SDL_free(binary);
+    }
+    SDL_RWclose(rw);
+
+    /* If the driver rejects the binary, we just compile the program again */
+    return status ? SDL_TRUE : SDL_FALSE;
+}
+
+static void SaveCachedProgram(GL_ShaderContext *ctx, Uint32 source_crc, GL_ShaderData *data)
+{
+    const GLuint program = (GLuint)(uintptr_t)data->program;
+    GL_ProgramCacheHeader header;
+    GLint length = 0;
+    GLenum format = 0;
+    SDL_RWops *rw;
+    void *binary;
+
+    ctx->glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+    binary = SDL_malloc(length);
+    if (!binary) {
+        return;
+    }
+    ctx->glGetProgramBinary(program, length, &length, &format, binary);
+
+    rw = OpenProgramCache(ctx, source_crc, "wb");
+    if (rw) {
+        header.magic = PROGRAM_CACHE_MAGIC;
+        header.driver_crc = ctx->driver_crc;
+        header.source_crc = source_crc;
+        header.format = format;
+        header.length = (Uint32)length;
+        header.data_crc = SDL_crc32(0, binary, length);
+        if (SDL_RWwrite(rw, &header, sizeof(header), 1) != 1 ||
+            SDL_RWwrite(rw, binary, length, 1) != 1) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "Couldn't write shader program cache: %s", SDL_GetError());
+        }
+        SDL_RWclose(rw);
+    }
+    SDL_free(binary);
+}
+
 static SDL_bool CompileShaderProgram(GL_ShaderContext *ctx, int index, GL_ShaderData *data)
 {
     const int num_tmus_bound = 4;
     const char *vert_defines = "";
     const char *frag_defines = "";
+    Uint32 source_crc = 0;
     int i;
     GLint location;
 
@@ -451,6 +580,13 @@ static SDL_bool CompileShaderProgram(GL_ShaderContext *ctx, int index, GL_Shader
     /* Create one program object to rule them all */
     data->program = ctx->glCreateProgramObjectARB();
 
+    if (ctx->cache_path) {
+        source_crc = GetShaderSourceCRC(vert_defines, frag_defines, index);
+        if (LoadCachedProgram(ctx, source_crc, data)) {
+            goto linked;
+        }
+    }
+
     /* Create the vertex shader */
     data->vert_shader = ctx->glCreateShaderObjectARB(GL_VERTEX_SHADER_ARB);
     if (!CompileShader(ctx, data->vert_shader, vert_defines, shader_source[index][0])) {
@@ -466,9 +602,17 @@ static SDL_bool CompileShaderProgram(GL_ShaderContext *ctx, int index, GL_Shader
     /* ... and in the darkness bind them */
     ctx->glAttachObjectARB(data->program, data->vert_shader);
     ctx->glAttachObjectARB(data->program, data->frag_shader);
+    if (ctx->cache_path) {
+        ctx->glProgramParameteri((GLuint)(uintptr_t)data->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
     ctx->glLinkProgramARB(data->program);
 
-    /* Set up some uniform variables */
+    if (ctx->cache_path) {
+        SaveCachedProgram(ctx, source_crc, data);
+    }
+
+linked:
+    /* Set up some uniform variables, they aren't part of cached programs */
     ctx->glUseProgramObjectARB(data->program);
     for (i = 0; i < num_tmus_bound; ++i) {
         char tex_name[10];
@@ -485,16 +629,64 @@ static SDL_bool CompileShaderProgram(GL_ShaderContext *ctx, int index, GL_Shader
 
 static void DestroyShaderProgram(GL_ShaderContext *ctx, GL_ShaderData *data)
 {
-    ctx->glDeleteObjectARB(data->vert_shader);
-    ctx->glDeleteObjectARB(data->frag_shader);
-    ctx->glDeleteObjectARB(data->program);
+    if (data->vert_shader) {
+        ctx->glDeleteObjectARB(data->vert_shader);
+    }
+    if (data->frag_shader) {
+        ctx->glDeleteObjectARB(data->frag_shader);
+    }
+    if (data->program) {
+        ctx->glDeleteObjectARB(data->program);
+    }
+    SDL_zerop(data);
+}
+
+static void InitProgramCache(GL_ShaderContext *ctx)
+{
+    const char *path = SDL_GetHint(SDL_HINT_RENDER_OPENGL_SHADER_CACHE);
+    const GLubyte *(APIENTRY * getString)(GLenum);
+    void (APIENTRY * getIntegerv)(GLenum, GLint *);
+    GLint num_formats = 0;
+    int i;
+
+    if (!path || !*path || !SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+        return;
+    }
+
+    getString = (const GLubyte *(APIENTRY *)(GLenum))SDL_GL_GetProcAddress("glGetString");
+    getIntegerv = (void (APIENTRY *)(GLenum, GLint *))SDL_GL_GetProcAddress("glGetIntegerv");
+    ctx->glGetProgramiv = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+    ctx->glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glGetProgramBinary");
+    ctx->glProgramBinary = (PFNGLPROGRAMBINARYPROC)SDL_GL_GetProcAddress("glProgramBinary");
+    ctx->glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)SDL_GL_GetProcAddress("glProgramParameteri");
+    if (!getString || !getIntegerv ||
+        !ctx->glGetProgramiv || !ctx->glGetProgramBinary || !ctx->glProgramBinary || !ctx->glProgramParameteri) {
+        return;
+    }
+
+    /* Some drivers have the extension, but no binary formats to save programs in */
+    getIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+    if (num_formats <= 0) {
+        return;
+    }
+
+    /* Programs can only be loaded by the driver that saved them */
+    ctx->driver_crc = 0;
+    for (i = 0; i < 3; ++i) {
+        static const GLenum names[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+        const char *value = (const char *)getString(names[i]);
+        if (value) {
+            ctx->driver_crc = SDL_crc32(ctx->driver_crc, value, SDL_strlen(value) + 1);
+        }
+    }
+
+    ctx->cache_path = SDL_strdup(path);
 }
 
 GL_ShaderContext *GL_CreateShaderContext(void)
 {
     GL_ShaderContext *ctx;
     SDL_bool shaders_supported;
-    int i;
 
     ctx = (GL_ShaderContext *)SDL_calloc(1, sizeof(*ctx));
     if (!ctx) {
@@ -550,20 +742,43 @@ GL_ShaderContext *GL_CreateShaderContext(void)
         return NULL;
     }
 
-    /* Compile all the shaders */
-    for (i = 0; i < NUM_SHADERS; ++i) {
-        if (!CompileShaderProgram(ctx, i, &ctx->shaders[i])) {
-            GL_DestroyShaderContext(ctx);
-            return NULL;
+    InitProgramCache(ctx);
+
+    /* The shaders are compiled when they're first selected, unless the
+       renderer asks for them earlier */
+    return ctx;
+}
+
+static SDL_bool CompileShaderOnce(GL_ShaderContext *ctx, GL_Shader shader)
+{
+    GL_ShaderData *data = &ctx->shaders[shader];
+
+    if (!data->compiled) {
+        if (!CompileShaderProgram(ctx, shader, data)) {
+            /* Draw with the fixed function pipeline instead */
+            DestroyShaderProgram(ctx, data);
         }
+        data->compiled = SDL_TRUE;
     }
+    return (shader == SHADER_NONE || data->program) ? SDL_TRUE : SDL_FALSE;
+}
 
-    /* We're done! */
-    return ctx;
+SDL_bool GL_CompileShaders(GL_ShaderContext *ctx, GL_Shader first, GL_Shader last)
+{
+    SDL_bool retval = SDL_TRUE;
+    int i;
+
+    for (i = first; i <= last; ++i) {
+        if (!CompileShaderOnce(ctx, (GL_Shader)i)) {
+            retval = SDL_FALSE;
+        }
+    }
+    return retval;
 }
 
 void GL_SelectShader(GL_ShaderContext *ctx, GL_Shader shader)
 {
+    CompileShaderOnce(ctx, shader);
     ctx->glUseProgramObjectARB(ctx->shaders[shader].program);
 }
 
@@ -574,6 +789,7 @@ void GL_DestroyShaderContext(GL_ShaderContext *ctx)
     for (i = 0; i < NUM_SHADERS; ++i) {
         DestroyShaderProgram(ctx, &ctx->shaders[i]);
     }
+    SDL_free(ctx->cache_path);
     SDL_free(ctx);
 }
 
@@ -0,0 +1,1972 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_OGL3 || SDL_VIDEO_RENDER_OGL_ES3
+#include "SDL_hints.h"
+#include "../../video/SDL_sysvideo.h" /* For SDL_GL_SwapWindowWithDamage */
+#if SDL_VIDEO_RENDER_OGL3
+#include "SDL_opengl.h"
+#else
+#include "SDL_opengles2.h"
+#endif
+#include "../SDL_sysrender.h"
+#include "SDL_shaders_gl3.h"
+
+#ifndef APIENTRY
+#define APIENTRY GL_APIENTRY
+#endif
+
+/* OpenGL ES 3.0 enums missing from the OpenGL ES 2.0 headers */
+#ifndef GL_RGBA8
+#define GL_RGBA8 0x8058
+#endif
+#ifndef GL_MIN
+#define GL_MIN 0x8007
+#endif
+#ifndef GL_MAX
+#define GL_MAX 0x8008
+#endif
+#ifndef GL_UNPACK_ROW_LENGTH
+#define GL_UNPACK_ROW_LENGTH 0x0CF2
+#endif
+#ifndef GL_PACK_ROW_LENGTH
+#define GL_PACK_ROW_LENGTH 0x0D02
+#endif
+#ifndef GL_PIXEL_UNPACK_BUFFER
+#define GL_PIXEL_UNPACK_BUFFER 0x88EC
+#endif
+#ifndef GL_UNIFORM_BUFFER
+#define GL_UNIFORM_BUFFER 0x8A11
+#endif
+#ifndef GL_INVALID_INDEX
+#define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_A
+#define GL_TEXTURE_SWIZZLE_A 0x8E45
+#endif
+#ifndef GL_MAJOR_VERSION
+#define GL_MAJOR_VERSION 0x821B
+#endif
+#ifndef GL_MINOR_VERSION
+#define GL_MINOR_VERSION 0x821C
+#endif
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_UNSIGNED_INT_8_8_8_8_REV
+#define GL_UNSIGNED_INT_8_8_8_8_REV 0x8367
+#endif
+
+/* To prevent unnecessary window recreation,
+ * these should match what applications using the renderer usually ask for
+ */
+
+#define RENDERER_CONTEXT_MAJOR    3
+#define RENDERER_CONTEXT_MINOR    3
+#define RENDERER_CONTEXT_MAJOR_ES 3
+#define RENDERER_CONTEXT_MINOR_ES 0
+
+/* OpenGL 3.3 core / OpenGL ES 3.0 renderer implementation
+
+   Everything is drawn from one vertex buffer, with a vertex array object for
+   each vertex layout. Rectangles and copies are a single instance each, four
+   corners of a triangle strip generated in the vertex shader, so a run of
+   them is one instanced draw call.
+*/
+
+static const float inv255f = 1.0f / 255.0f;
+
+/* OpenGL ES has no packed pixel types, GL_RGBA / GL_UNSIGNED_BYTE reads the bytes in memory order */
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+#define GLES3_PIXELFORMAT_RGBA SDL_PIXELFORMAT_ABGR8888
+#define GLES3_PIXELFORMAT_RGBX SDL_PIXELFORMAT_BGR888
+#else
+#define GLES3_PIXELFORMAT_RGBA SDL_PIXELFORMAT_RGBA8888
+#define GLES3_PIXELFORMAT_RGBX SDL_PIXELFORMAT_RGBX8888
+#endif
+
+/* Points, lines and untextured geometry */
+typedef struct
+{
+    GLfloat x, y;
+    SDL_Color color;
+} GL3_SolidVertex;
+
+/* Textured geometry */
+typedef struct
+{
+    GLfloat x, y;
+    SDL_Color color;
+    GLfloat u, v;
+} GL3_TextureVertex;
+
+/* A filled rectangle, drawn as one instance */
+typedef struct
+{
+    GLfloat x, y, w, h;
+    SDL_Color color;
+} GL3_RectInstance;
+
+/* A copy, drawn as one instance. The corners are at the position plus
+   the axes, so rotated and flipped copies are the same to the shader. */
+typedef struct
+{
+    GLfloat x, y;
+    SDL_Color color;
+    GLfloat u0, v0, u1, v1;
+    GLfloat ax, ay, bx, by;
+} GL3_CopyInstance;
+
+typedef struct
+{
+    GLuint index;
+    GLint size;
+    GLenum type;
+    GLboolean normalized;
+    size_t offset;
+} GL3_VertexAttribute;
+
+/* The vertex layout of each shader, they each have their own vertex array object */
+static const struct
+{
+    GLsizei stride;
+    SDL_bool instanced;
+    int num_attributes;
+    GL3_VertexAttribute attributes[4];
+} GL3_VertexLayouts[GL3_NUM_SHADERS] = {
+    /* GL3_SHADER_SOLID */
+    { sizeof(GL3_SolidVertex), SDL_FALSE, 2,
+      { { GL3_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, offsetof(GL3_SolidVertex, x) },
+        { GL3_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3_SolidVertex, color) } } },
+    /* GL3_SHADER_TEXTURE */
+    { sizeof(GL3_TextureVertex), SDL_FALSE, 3,
+      { { GL3_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, offsetof(GL3_TextureVertex, x) },
+        { GL3_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3_TextureVertex, color) },
+        { GL3_ATTRIB_TEXCOORD, 2, GL_FLOAT, GL_FALSE, offsetof(GL3_TextureVertex, u) } } },
+    /* GL3_SHADER_RECTS */
+    { sizeof(GL3_RectInstance), SDL_TRUE, 2,
+      { { GL3_ATTRIB_POSITION, 4, GL_FLOAT, GL_FALSE, offsetof(GL3_RectInstance, x) },
+        { GL3_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3_RectInstance, color) } } },
+    /* GL3_SHADER_COPY */
+    { sizeof(GL3_CopyInstance), SDL_TRUE, 4,
+      { { GL3_ATTRIB_POSITION, 2, GL_FLOAT, GL_FALSE, offsetof(GL3_CopyInstance, x) },
+        { GL3_ATTRIB_COLOR, 4, GL_UNSIGNED_BYTE, GL_TRUE, offsetof(GL3_CopyInstance, color) },
+        { GL3_ATTRIB_TEXCOORD, 4, GL_FLOAT, GL_FALSE, offsetof(GL3_CopyInstance, u0) },
+        { GL3_ATTRIB_AXES, 4, GL_FLOAT, GL_FALSE, offsetof(GL3_CopyInstance, ax) } } },
+};
+
+#define GL3_SHADER_INVALID GL3_NUM_SHADERS
+
+typedef struct
+{
+    SDL_bool viewport_dirty;
+    SDL_Rect viewport;
+    SDL_Texture *texture;
+    SDL_Texture *target;
+    int drawablew;
+    int drawableh;
+    SDL_BlendMode blend;
+    GL3_Shader shader;
+    SDL_bool cliprect_enabled_dirty;
+    SDL_bool cliprect_enabled;
+    SDL_bool cliprect_dirty;
+    SDL_Rect cliprect;
+    Uint32 clear_color;
+} GL3_DrawStateCache;
+
+typedef struct
+{
+    SDL_GLContext context;
+    SDL_bool gles;
+
+    SDL_bool debug_enabled;
+
+    /* OpenGL functions */
+#define SDL_PROC(ret, func, params) ret (APIENTRY *func) params;
+#include "SDL_gl3funcs.h"
+#undef SDL_PROC
+
+    /* Optional functions */
+    void (APIENTRY *glMultiDrawArrays)(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount);
+    void (APIENTRY *glTexStorage2D)(GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height);
+
+    GLuint programs[GL3_NUM_SHADERS];
+    GLuint vertex_arrays[GL3_NUM_SHADERS];
+    GLuint vertex_array_buffers[GL3_NUM_SHADERS]; /* the buffer and offset the attributes point at */
+    size_t vertex_array_offsets[GL3_NUM_SHADERS];
+
+    GLuint vertex_buffer;
+    GLuint uniform_buffer;
+
+    /* Scratch space for glMultiDrawArrays() */
+    GLint *multidraw_first;
+    GLsizei *multidraw_count;
+    int multidraw_allocation;
+
+    SDL_RenderStats *stats;
+
+    GL3_DrawStateCache drawstate;
+} GL3_RenderData;
+
+typedef struct
+{
+    GLuint texture;
+    GLenum format;
+    GLenum formattype;
+    void *pixels;
+    int pitch;
+    SDL_Rect locked_rect;
+
+    /* Render targets get their own FBO, with the texture attached once */
+    GLuint fbo;
+} GL3_TextureData;
+
+SDL_FORCE_INLINE const char *
+GL3_TranslateError(GLenum error)
+{
+#define GL_ERROR_TRANSLATE(e) \
+    case e:                   \
+        return #e;
+    switch (error) {
+        GL_ERROR_TRANSLATE(GL_INVALID_ENUM)
+        GL_ERROR_TRANSLATE(GL_INVALID_VALUE)
+        GL_ERROR_TRANSLATE(GL_INVALID_OPERATION)
+        GL_ERROR_TRANSLATE(GL_INVALID_FRAMEBUFFER_OPERATION)
+        GL_ERROR_TRANSLATE(GL_OUT_OF_MEMORY)
+        GL_ERROR_TRANSLATE(GL_NO_ERROR)
+    default:
+        return "UNKNOWN";
+    }
+#undef GL_ERROR_TRANSLATE
+}
+
+SDL_FORCE_INLINE void
+GL3_ClearErrors(SDL_Renderer *renderer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    if (!data->debug_enabled) {
+        return;
+    }
+    while (data->glGetError() != GL_NO_ERROR) {
+        /* continue; */
+    }
+}
+
+SDL_FORCE_INLINE int
+GL3_CheckAllErrors(const char *prefix, SDL_Renderer *renderer, const char *file, int line, const char *function)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    int ret = 0;
+
+    if (!data->debug_enabled) {
+        return 0;
+    }
+    /* check gl errors (can return multiple errors) */
+    for (;;) {
+        GLenum error = data->glGetError();
+        if (error != GL_NO_ERROR) {
+            if (prefix == NULL || prefix[0] == '\0') {
+                prefix = "generic";
+            }
+            SDL_SetError("%s: %s (%d): %s %s (0x%X)", prefix, file, line, function, GL3_TranslateError(error), error);
+            ret = -1;
+        } else {
+            break;
+        }
+    }
+    return ret;
+}
+
+#if 0
+#define GL3_CheckError(prefix, renderer)
+#else
+#define GL3_CheckError(prefix, renderer) GL3_CheckAllErrors(prefix, renderer, SDL_FILE, SDL_LINE, SDL_FUNCTION)
+#endif
+
+static int GL3_LoadFunctions(GL3_RenderData *data)
+{
+    int retval = 0;
+#define SDL_PROC(ret, func, params)                                                           \
+    do {                                                                                      \
+        data->func = SDL_GL_GetProcAddress(#func);                                            \
+        if (!data->func) {                                                                    \
+            retval = SDL_SetError("Couldn't load GL function %s: %s", #func, SDL_GetError()); \
+        }                                                                                     \
+    } while (0);
+
+#include "SDL_gl3funcs.h"
+#undef SDL_PROC
+    return retval;
+}
+
+static int GL3_ActivateRenderer(SDL_Renderer *renderer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    if (SDL_GL_GetCurrentContext() != data->context) {
+        if (SDL_GL_MakeCurrent(renderer->window, data->context) < 0) {
+            return -1;
+        }
+    }
+
+    GL3_ClearErrors(renderer);
+
+    return 0;
+}
+
+static void GL3_WindowEvent(SDL_Renderer *renderer, const SDL_WindowEvent *event)
+{
+    /* If the window x/y/w/h changed at all, assume the viewport has been
+     * changed behind our backs. x/y changes might seem weird but viewport
+     * resets have been observed on macOS at minimum!
+     */
+    if (event->event == SDL_WINDOWEVENT_SIZE_CHANGED ||
+        event->event == SDL_WINDOWEVENT_MOVED) {
+        GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+        data->drawstate.viewport_dirty = SDL_TRUE;
+    }
+}
+
+static int GL3_GetOutputSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    SDL_GL_GetDrawableSize(renderer->window, w, h);
+    return 0;
+}
+
+static GLenum GetBlendFunc(SDL_BlendFactor factor)
+{
+    switch (factor) {
+    case SDL_BLENDFACTOR_ZERO:
+        return GL_ZERO;
+    case SDL_BLENDFACTOR_ONE:
+        return GL_ONE;
+    case SDL_BLENDFACTOR_SRC_COLOR:
+        return GL_SRC_COLOR;
+    case SDL_BLENDFACTOR_ONE_MINUS_SRC_COLOR:
+        return GL_ONE_MINUS_SRC_COLOR;
+    case SDL_BLENDFACTOR_SRC_ALPHA:
+        return GL_SRC_ALPHA;
+    case SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA:
+        return GL_ONE_MINUS_SRC_ALPHA;
+    case SDL_BLENDFACTOR_DST_COLOR:
+        return GL_DST_COLOR;
+    case SDL_BLENDFACTOR_ONE_MINUS_DST_COLOR:
+        return GL_ONE_MINUS_DST_COLOR;
+    case SDL_BLENDFACTOR_DST_ALPHA:
+        return GL_DST_ALPHA;
+    case SDL_BLENDFACTOR_ONE_MINUS_DST_ALPHA:
+        return GL_ONE_MINUS_DST_ALPHA;
+    default:
+        return GL_INVALID_ENUM;
+    }
+}
+
+static GLenum GetBlendEquation(SDL_BlendOperation operation)
+{
+    switch (operation) {
+    case SDL_BLENDOPERATION_ADD:
+        return GL_FUNC_ADD;
+    case SDL_BLENDOPERATION_SUBTRACT:
+        return GL_FUNC_SUBTRACT;
+    case SDL_BLENDOPERATION_REV_SUBTRACT:
+        return GL_FUNC_REVERSE_SUBTRACT;
+    case SDL_BLENDOPERATION_MINIMUM:
+        return GL_MIN;
+    case SDL_BLENDOPERATION_MAXIMUM:
+        return GL_MAX;
+    default:
+        return GL_INVALID_ENUM;
+    }
+}
+
+static SDL_bool GL3_SupportsBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+{
+    SDL_BlendFactor srcColorFactor = SDL_GetBlendModeSrcColorFactor(blendMode);
+    SDL_BlendFactor srcAlphaFactor = SDL_GetBlendModeSrcAlphaFactor(blendMode);
+    SDL_BlendOperation colorOperation = SDL_GetBlendModeColorOperation(blendMode);
+    SDL_BlendFactor dstColorFactor = SDL_GetBlendModeDstColorFactor(blendMode);
+    SDL_BlendFactor dstAlphaFactor = SDL_GetBlendModeDstAlphaFactor(blendMode);
+    SDL_BlendOperation alphaOperation = SDL_GetBlendModeAlphaOperation(blendMode);
+
+    if (GetBlendFunc(srcColorFactor) == GL_INVALID_ENUM ||
+        GetBlendFunc(srcAlphaFactor) == GL_INVALID_ENUM ||
+        GetBlendEquation(colorOperation) == GL_INVALID_ENUM ||
+        GetBlendFunc(dstColorFactor) == GL_INVALID_ENUM ||
+        GetBlendFunc(dstAlphaFactor) == GL_INVALID_ENUM ||
+        GetBlendEquation(alphaOperation) == GL_INVALID_ENUM) {
+        return SDL_FALSE;
+    }
+    if (colorOperation != alphaOperation) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+SDL_FORCE_INLINE SDL_bool
+convert_format(GL3_RenderData *renderdata, Uint32 pixel_format,
+               GLenum *format, GLenum *type)
+{
+    if (renderdata->gles) {
+        switch (pixel_format) {
+        case GLES3_PIXELFORMAT_RGBA:
+        case GLES3_PIXELFORMAT_RGBX:
+            *format = GL_RGBA;
+            *type = GL_UNSIGNED_BYTE;
+            return SDL_TRUE;
+        default:
+            return SDL_FALSE;
+        }
+    }
+
+    switch (pixel_format) {
+    case SDL_PIXELFORMAT_ARGB8888:
+    case SDL_PIXELFORMAT_RGB888:
+        *format = GL_BGRA;
+        *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+        break;
+    case SDL_PIXELFORMAT_ABGR8888:
+    case SDL_PIXELFORMAT_BGR888:
+        *format = GL_RGBA;
+        *type = GL_UNSIGNED_INT_8_8_8_8_REV;
+        break;
+    default:
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+static int GL3_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    GL3_RenderData *renderdata = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *data;
+    GLenum format, type;
+    GLenum scaleMode;
+
+    GL3_ActivateRenderer(renderer);
+
+    renderdata->drawstate.texture = NULL; /* we trash this state. */
+
+    if (!convert_format(renderdata, texture->format, &format, &type)) {
+        return SDL_SetError("Texture format %s not supported by OpenGL",
+                            SDL_GetPixelFormatName(texture->format));
+    }
+
+    data = (GL3_TextureData *)SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        return SDL_OutOfMemory();
+    }
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        data->pitch = texture->w * SDL_BYTESPERPIXEL(texture->format);
+        data->pixels = SDL_calloc(1, (size_t)texture->h * data->pitch);
+        if (!data->pixels) {
+            SDL_free(data);
+            return SDL_OutOfMemory();
+        }
+    }
+
+    GL3_CheckError("", renderer);
+    renderdata->glGenTextures(1, &data->texture);
+    if (GL3_CheckError("glGenTextures()", renderer) < 0) {
+        SDL_free(data->pixels);
+        SDL_free(data);
+        return -1;
+    }
+    texture->driverdata = data;
+
+    data->format = format;
+    data->formattype = type;
+    scaleMode = (texture->scaleMode == SDL_ScaleModeNearest) ? GL_NEAREST : GL_LINEAR;
+    renderdata->glBindTexture(GL_TEXTURE_2D, data->texture);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, scaleMode);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, scaleMode);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    if (!SDL_ISPIXELFORMAT_ALPHA(texture->format)) {
+        /* Whatever is in the unused byte, these are opaque */
+        renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, GL_ONE);
+    }
+    if (renderdata->glTexStorage2D) {
+        /* Immutable storage, the driver doesn't have to be ready for it to be redefined */
+        renderdata->glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, texture->w, texture->h);
+    } else {
+        renderdata->glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texture->w, texture->h,
+                                 0, format, type, NULL);
+    }
+    if (GL3_CheckError("glTexImage2D()", renderer) < 0) {
+        return -1;
+    }
+
+    return GL3_CheckError("", renderer);
+}
+
+static int GL3_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                             const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    GL3_RenderData *renderdata = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *data = (GL3_TextureData *)texture->driverdata;
+    const int texturebpp = SDL_BYTESPERPIXEL(texture->format);
+
+    SDL_assert_release(texturebpp != 0); /* otherwise, division by zero later. */
+
+    GL3_ActivateRenderer(renderer);
+
+    renderdata->drawstate.texture = NULL; /* we trash this state. */
+
+    renderdata->glBindTexture(GL_TEXTURE_2D, data->texture);
+    renderdata->glPixelStorei(GL_UNPACK_ROW_LENGTH, (pitch / texturebpp));
+    renderdata->glTexSubImage2D(GL_TEXTURE_2D, 0, rect->x, rect->y, rect->w,
+                                rect->h, data->format, data->formattype,
+                                pixels);
+    return GL3_CheckError("glTexSubImage2D()", renderer);
+}
+
+static int GL3_LockTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                           const SDL_Rect *rect, void **pixels, int *pitch)
+{
+    GL3_TextureData *data = (GL3_TextureData *)texture->driverdata;
+
+    data->locked_rect = *rect;
+    *pixels =
+        (void *)((Uint8 *)data->pixels + rect->y * data->pitch +
+                 rect->x * SDL_BYTESPERPIXEL(texture->format));
+    *pitch = data->pitch;
+    return 0;
+}
+
+static void GL3_UnlockTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    GL3_TextureData *data = (GL3_TextureData *)texture->driverdata;
+    const SDL_Rect *rect;
+    void *pixels;
+
+    rect = &data->locked_rect;
+    pixels =
+        (void *)((Uint8 *)data->pixels + rect->y * data->pitch +
+                 rect->x * SDL_BYTESPERPIXEL(texture->format));
+    GL3_UpdateTexture(renderer, texture, rect, pixels, data->pitch);
+}
+
+static void GL3_SetTextureScaleMode(SDL_Renderer *renderer, SDL_Texture *texture, SDL_ScaleMode scaleMode)
+{
+    GL3_RenderData *renderdata = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *data = (GL3_TextureData *)texture->driverdata;
+    GLenum glScaleMode = (scaleMode == SDL_ScaleModeNearest) ? GL_NEAREST : GL_LINEAR;
+
+    GL3_ActivateRenderer(renderer);
+
+    renderdata->drawstate.texture = NULL; /* we trash this state. */
+
+    renderdata->glBindTexture(GL_TEXTURE_2D, data->texture);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glScaleMode);
+    renderdata->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glScaleMode);
+}
+
+static int GL3_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *texturedata;
+    GLenum status;
+
+    GL3_ActivateRenderer(renderer);
+
+    data->drawstate.viewport_dirty = SDL_TRUE;
+
+    if (!texture) {
+        data->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return 0;
+    }
+
+    texturedata = (GL3_TextureData *)texture->driverdata;
+    if (texturedata->fbo) {
+        data->glBindFramebuffer(GL_FRAMEBUFFER, texturedata->fbo);
+        return 0;
+    }
+
+    data->glGenFramebuffers(1, &texturedata->fbo);
+    data->glBindFramebuffer(GL_FRAMEBUFFER, texturedata->fbo);
+    data->glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texturedata->texture, 0);
+    /* Check FBO status */
+    status = data->glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        data->glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        data->glDeleteFramebuffers(1, &texturedata->fbo);
+        texturedata->fbo = 0;
+        return SDL_SetError("glFramebufferTexture2D() failed");
+    }
+    return 0;
+}
+
+static int GL3_QueueNoOp(SDL_Renderer *renderer, SDL_RenderCommand *cmd)
+{
+    return 0; /* nothing to do in this backend, the color is part of the vertices. */
+}
+
+static void GL3_GetDrawColor(const SDL_RenderCommand *cmd, SDL_Color *color)
+{
+    color->r = cmd->data.draw.r;
+    color->g = cmd->data.draw.g;
+    color->b = cmd->data.draw.b;
+    color->a = cmd->data.draw.a;
+}
+
+static int GL3_QueueDrawPoints(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
+{
+    GL3_SolidVertex *verts = (GL3_SolidVertex *)SDL_AllocateRenderVertices(renderer, count * sizeof(GL3_SolidVertex), 4, &cmd->data.draw.first);
+    SDL_Color color;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    GL3_GetDrawColor(cmd, &color);
+    cmd->data.draw.count = count;
+    for (i = 0; i < count; i++) {
+        verts[i].x = 0.5f + points[i].x;
+        verts[i].y = 0.5f + points[i].y;
+        verts[i].color = color;
+    }
+
+    return 0;
+}
+
+static int GL3_QueueDrawLines(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
+{
+    int i;
+    GLfloat prevx, prevy;
+    SDL_Color color;
+    GL3_SolidVertex *verts = (GL3_SolidVertex *)SDL_AllocateRenderVertices(renderer, count * sizeof(GL3_SolidVertex), 4, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+    GL3_GetDrawColor(cmd, &color);
+    cmd->data.draw.count = count;
+
+    /* 0.5f offset to hit the center of the pixel. */
+    prevx = 0.5f + points->x;
+    prevy = 0.5f + points->y;
+    verts[0].x = prevx;
+    verts[0].y = prevy;
+    verts[0].color = color;
+
+    /* bump the end of each line segment out a quarter of a pixel, to provoke
+       the diamond-exit rule. Without this, you won't just drop the last
+       pixel of the last line segment, but you might also drop pixels at the
+       edge of any given line segment along the way too. */
+    for (i = 1; i < count; i++) {
+        const GLfloat xstart = prevx;
+        const GLfloat ystart = prevy;
+        const GLfloat xend = points[i].x + 0.5f; /* 0.5f to hit pixel center. */
+        const GLfloat yend = points[i].y + 0.5f;
+        /* bump a little in the direction we are moving in. */
+        const GLfloat deltax = xend - xstart;
+        const GLfloat deltay = yend - ystart;
+        const GLfloat angle = SDL_atan2f(deltay, deltax);
+        prevx = xend + (SDL_cosf(angle) * 0.25f);
+        prevy = yend + (SDL_sinf(angle) * 0.25f);
+        verts[i].x = prevx;
+        verts[i].y = prevy;
+        verts[i].color = color;
+    }
+
+    return 0;
+}
+
+static int GL3_QueueFillRects(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FRect *rects, int count)
+{
+    GL3_RectInstance *verts = (GL3_RectInstance *)SDL_AllocateRenderVertices(renderer, count * sizeof(GL3_RectInstance), 4, &cmd->data.draw.first);
+    SDL_Color color;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    GL3_GetDrawColor(cmd, &color);
+    cmd->data.draw.count = count;
+    for (i = 0; i < count; i++) {
+        verts[i].x = rects[i].x;
+        verts[i].y = rects[i].y;
+        verts[i].w = rects[i].w;
+        verts[i].h = rects[i].h;
+        verts[i].color = color;
+    }
+
+    return 0;
+}
+
+static void GL3_SetCopyTexCoords(GL3_CopyInstance *verts, SDL_Texture *texture, const SDL_Rect *srcrect)
+{
+    verts->u0 = (GLfloat)srcrect->x / (GLfloat)texture->w;
+    verts->v0 = (GLfloat)srcrect->y / (GLfloat)texture->h;
+    verts->u1 = (GLfloat)(srcrect->x + srcrect->w) / (GLfloat)texture->w;
+    verts->v1 = (GLfloat)(srcrect->y + srcrect->h) / (GLfloat)texture->h;
+}
+
+static int GL3_QueueCopy(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                         const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    GL3_CopyInstance *verts = (GL3_CopyInstance *)SDL_AllocateRenderVertices(renderer, sizeof(GL3_CopyInstance), 4, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = 1;
+    verts->x = dstrect->x;
+    verts->y = dstrect->y;
+    GL3_GetDrawColor(cmd, &verts->color);
+    GL3_SetCopyTexCoords(verts, texture, srcrect);
+    verts->ax = dstrect->w;
+    verts->ay = 0.0f;
+    verts->bx = 0.0f;
+    verts->by = dstrect->h;
+    return 0;
+}
+
+static int GL3_QueueCopyEx(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                           const SDL_Rect *srcquad, const SDL_FRect *dstrect,
+                           const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip, float scale_x, float scale_y)
+{
+    GL3_CopyInstance *verts = (GL3_CopyInstance *)SDL_AllocateRenderVertices(renderer, sizeof(GL3_CopyInstance), 4, &cmd->data.draw.first);
+    const float radian_angle = (float)((M_PI * angle) / 180.0);
+    const float s = SDL_sinf(radian_angle);
+    const float c = SDL_cosf(radian_angle);
+    const float centerx = center->x + dstrect->x;
+    const float centery = center->y + dstrect->y;
+    float minx, miny, maxx, maxy;
+
+    if (!verts) {
+        return -1;
+    }
+
+    if (flip & SDL_FLIP_HORIZONTAL) {
+        minx = dstrect->x + dstrect->w;
+        maxx = dstrect->x;
+    } else {
+        minx = dstrect->x;
+        maxx = dstrect->x + dstrect->w;
+    }
+
+    if (flip & SDL_FLIP_VERTICAL) {
+        miny = dstrect->y + dstrect->h;
+        maxy = dstrect->y;
+    } else {
+        miny = dstrect->y;
+        maxy = dstrect->y + dstrect->h;
+    }
+
+    /* The corner at (minx, miny) rotated around the center with the 2x2
+       matrix ( c -s ), and the edges from it rotated the same way
+              ( s  c ) */
+    cmd->data.draw.count = 1;
+    verts->x = ((c * (minx - centerx) - s * (miny - centery)) + centerx) * scale_x;
+    verts->y = ((s * (minx - centerx) + c * (miny - centery)) + centery) * scale_y;
+    GL3_GetDrawColor(cmd, &verts->color);
+    GL3_SetCopyTexCoords(verts, texture, srcquad);
+    verts->ax = c * (maxx - minx) * scale_x;
+    verts->ay = s * (maxx - minx) * scale_y;
+    verts->bx = -s * (maxy - miny) * scale_x;
+    verts->by = c * (maxy - miny) * scale_y;
+    return 0;
+}
+
+/* The pixels are copied next to the vertices, so they can be uploaded from
+   the same buffer when the queue runs */
+static int GL3_QueueUpdateTexture(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                                  const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    dst = (Uint8 *)SDL_AllocateRenderVertices(renderer, length * rect->h, 16, &cmd->data.update.first);
+    if (!dst) {
+        return -1;
+    }
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+    return 0;
+}
+
+/* Small meshes are expanded, so consecutive draws can still be combined
+   into a single draw call */
+#define GL3_MIN_INDEXED_GEOMETRY 96
+
+static int GL3_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                             const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride,
+                             int num_vertices, const void *indices, int num_indices, int size_indices,
+                             float scale_x, float scale_y)
+{
+    int i;
+    int count = indices ? num_indices : num_vertices;
+    Uint8 *verts;
+    const size_t sz = texture ? sizeof(GL3_TextureVertex) : sizeof(GL3_SolidVertex);
+    int index_size = 0;
+
+    size_indices = indices ? size_indices : 0;
+
+    if (size_indices && num_indices >= GL3_MIN_INDEXED_GEOMETRY) {
+        /* Keep the indices if the shared vertices make up for their size */
+        const int needed_index_size = (num_vertices <= 0x10000) ? 2 : 4;
+        if ((size_t)num_vertices * sz + (size_t)num_indices * needed_index_size < (size_t)num_indices * sz) {
+            index_size = needed_index_size;
+            count = num_vertices;
+        }
+    }
+
+    verts = (Uint8 *)SDL_AllocateRenderVertices(renderer, count * sz + (size_t)num_indices * index_size, 4, &cmd->data.draw.first);
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+
+    if (index_size) {
+        /* The indices go right after the vertices, in the same buffer */
+        void *dst = verts + count * sz;
+
+        cmd->data.draw.indices = cmd->data.draw.first + count * sz;
+        cmd->data.draw.num_indices = num_indices;
+        cmd->data.draw.index_size = index_size;
+
+        if (index_size == size_indices) {
+            SDL_memcpy(dst, indices, (size_t)num_indices * index_size);
+        } else if (index_size == 2) {
+            Uint16 *dst16 = (Uint16 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 4) {
+                    dst16[i] = (Uint16)((const Uint32 *)indices)[i];
+                } else {
+                    dst16[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        } else {
+            Uint32 *dst32 = (Uint32 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 2) {
+                    dst32[i] = ((const Uint16 *)indices)[i];
+                } else {
+                    dst32[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        }
+        size_indices = 0; /* the vertices are queued in order */
+    }
+
+    for (i = 0; i < count; i++) {
+        int j;
+        const float *xy_;
+        GL3_SolidVertex *vert = (GL3_SolidVertex *)verts;
+        if (size_indices == 4) {
+            j = ((const Uint32 *)indices)[i];
+        } else if (size_indices == 2) {
+            j = ((const Uint16 *)indices)[i];
+        } else if (size_indices == 1) {
+            j = ((const Uint8 *)indices)[i];
+        } else {
+            j = i;
+        }
+
+        xy_ = (const float *)((const char *)xy + j * xy_stride);
+
+        /* The textured vertex starts like the solid one */
+        vert->x = xy_[0] * scale_x;
+        vert->y = xy_[1] * scale_y;
+        vert->color = *(const SDL_Color *)((const char *)color + j * color_stride);
+
+        if (texture) {
+            const float *uv_ = (const float *)((const char *)uv + j * uv_stride);
+            GL3_TextureVertex *texvert = (GL3_TextureVertex *)verts;
+            texvert->u = uv_[0];
+            texvert->v = uv_[1];
+        }
+        verts += sz;
+    }
+    return 0;
+}
+
+static void GL3_UpdateProjection(GL3_RenderData *data)
+{
+    const SDL_Rect *viewport = &data->drawstate.viewport;
+    const SDL_bool istarget = data->drawstate.target != NULL;
+    GLfloat projection[16];
+
+    /* An orthographic projection of the viewport, top-down unless drawing
+       to the window, whose rows go bottom-up. */
+    SDL_zeroa(projection);
+    projection[0] = 2.0f / viewport->w;
+    projection[5] = (istarget ? 2.0f : -2.0f) / viewport->h;
+    projection[10] = 1.0f;
+    projection[12] = -1.0f;
+    projection[13] = istarget ? -1.0f : 1.0f;
+    projection[15] = 1.0f;
+
+    data->glBindBuffer(GL_UNIFORM_BUFFER, data->uniform_buffer);
+    data->glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(projection), projection);
+    data->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+static int SetDrawState(GL3_RenderData *data, const SDL_RenderCommand *cmd, const GL3_Shader shader)
+{
+    const SDL_BlendMode blend = cmd->data.draw.blend;
+
+    if (data->drawstate.viewport_dirty) {
+        const SDL_bool istarget = data->drawstate.target != NULL;
+        const SDL_Rect *viewport = &data->drawstate.viewport;
+        data->glViewport(viewport->x,
+                         istarget ? viewport->y : (data->drawstate.drawableh - viewport->y - viewport->h),
+                         viewport->w, viewport->h);
+        if (viewport->w && viewport->h) {
+            GL3_UpdateProjection(data);
+        }
+        data->drawstate.viewport_dirty = SDL_FALSE;
+    }
+
+    if (data->drawstate.cliprect_enabled_dirty) {
+        if (!data->drawstate.cliprect_enabled) {
+            data->glDisable(GL_SCISSOR_TEST);
+        } else {
+            data->glEnable(GL_SCISSOR_TEST);
+        }
+        data->drawstate.cliprect_enabled_dirty = SDL_FALSE;
+    }
+
+    if (data->drawstate.cliprect_enabled && data->drawstate.cliprect_dirty) {
+        const SDL_Rect *viewport = &data->drawstate.viewport;
+        const SDL_Rect *rect = &data->drawstate.cliprect;
+        data->glScissor(viewport->x + rect->x,
+                        data->drawstate.target ? viewport->y + rect->y : data->drawstate.drawableh - viewport->y - rect->y - rect->h,
+                        rect->w, rect->h);
+        data->drawstate.cliprect_dirty = SDL_FALSE;
+    }
+
+    if (blend != data->drawstate.blend) {
+        if (blend == SDL_BLENDMODE_NONE) {
+            data->glDisable(GL_BLEND);
+        } else {
+            data->glEnable(GL_BLEND);
+            data->glBlendFuncSeparate(GetBlendFunc(SDL_GetBlendModeSrcColorFactor(blend)),
+                                      GetBlendFunc(SDL_GetBlendModeDstColorFactor(blend)),
+                                      GetBlendFunc(SDL_GetBlendModeSrcAlphaFactor(blend)),
+                                      GetBlendFunc(SDL_GetBlendModeDstAlphaFactor(blend)));
+            data->glBlendEquation(GetBlendEquation(SDL_GetBlendModeColorOperation(blend)));
+        }
+        data->drawstate.blend = blend;
+        ++data->stats->blend_changes;
+    }
+
+    if (shader != data->drawstate.shader) {
+        data->glUseProgram(data->programs[shader]);
+        data->glBindVertexArray(data->vertex_arrays[shader]);
+        data->drawstate.shader = shader;
+        ++data->stats->shader_changes;
+    }
+
+    if (cmd->data.draw.texture && cmd->data.draw.texture != data->drawstate.texture) {
+        SDL_Texture *texture = cmd->data.draw.texture;
+        const GL3_TextureData *texturedata = (GL3_TextureData *)texture->driverdata;
+
+        data->glBindTexture(GL_TEXTURE_2D, texturedata->texture);
+        data->drawstate.texture = texture;
+        ++data->stats->texture_binds;
+    }
+
+    return 0;
+}
+
+/* Point the attributes of the current vertex array at the vertices starting at offset */
+static void GL3_SetVertexAttributes(GL3_RenderData *data, GL3_Shader shader, GLuint buffer, size_t offset)
+{
+    int i;
+
+    if (data->vertex_array_buffers[shader] == buffer && data->vertex_array_offsets[shader] == offset) {
+        return;
+    }
+
+    data->glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    for (i = 0; i < GL3_VertexLayouts[shader].num_attributes; ++i) {
+        const GL3_VertexAttribute *attribute = &GL3_VertexLayouts[shader].attributes[i];
+        data->glVertexAttribPointer(attribute->index, attribute->size, attribute->type, attribute->normalized,
+                                    GL3_VertexLayouts[shader].stride, (const void *)(uintptr_t)(offset + attribute->offset));
+    }
+    data->glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    if (data->vertex_array_buffers[shader] != buffer) {
+        /* Indices are in the same buffer as the vertices */
+        data->glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer);
+    }
+    data->vertex_array_buffers[shader] = buffer;
+    data->vertex_array_offsets[shader] = offset;
+}
+
+/* Draw color changes don't matter here, the color is part of the vertices */
+static SDL_RenderCommand *GL3_NextDrawCommand(SDL_RenderCommand *cmd)
+{
+    for (cmd = cmd->next; cmd; cmd = cmd->next) {
+        if (cmd->command != SDL_RENDERCMD_SETDRAWCOLOR && cmd->command != SDL_RENDERCMD_NO_OP) {
+            break;
+        }
+    }
+    return cmd;
+}
+
+static SDL_bool GL3_GrowMultiDraw(GL3_RenderData *data, int count)
+{
+    GLint *first;
+    GLsizei *counts;
+    int allocation = data->multidraw_allocation ? data->multidraw_allocation : 64;
+
+    if (count <= data->multidraw_allocation) {
+        return SDL_TRUE;
+    }
+    while (allocation < count) {
+        allocation *= 2;
+    }
+    first = (GLint *)SDL_realloc(data->multidraw_first, allocation * sizeof(*first));
+    if (!first) {
+        return SDL_FALSE;
+    }
+    data->multidraw_first = first;
+    counts = (GLsizei *)SDL_realloc(data->multidraw_count, allocation * sizeof(*counts));
+    if (!counts) {
+        return SDL_FALSE;
+    }
+    data->multidraw_count = counts;
+    data->multidraw_allocation = allocation;
+    return SDL_TRUE;
+}
+
+/* Draw a run of points, lines or geometry using the same state. Draws whose
+   vertices follow each other are one draw, the others are gathered into a
+   single glMultiDrawArrays() call as long as they line up with the vertex
+   size. Returns the last command drawn. */
+static SDL_RenderCommand *GL3_DrawArrays(GL3_RenderData *data, SDL_RenderCommand *cmd, GL3_Shader shader, GLuint buffer)
+{
+    const SDL_RenderCommandType thiscmdtype = cmd->command;
+    const size_t stride = GL3_VertexLayouts[shader].stride;
+    const size_t base = cmd->data.draw.first;
+    SDL_RenderCommand *finalcmd = cmd;
+    SDL_RenderCommand *nextcmd;
+    GLenum mode;
+    size_t end = base + cmd->data.draw.count * stride;
+    SDL_bool contiguous;
+    int num_draws = 1;
+
+    switch (thiscmdtype) {
+    case SDL_RENDERCMD_DRAW_POINTS:
+        mode = GL_POINTS;
+        break;
+    case SDL_RENDERCMD_DRAW_LINES:
+        /* joined lines can't be concatenated, each is a draw of its own */
+        mode = GL_LINE_STRIP;
+        break;
+    default:
+        mode = GL_TRIANGLES;
+        break;
+    }
+    contiguous = (mode != GL_LINE_STRIP) ? SDL_TRUE : SDL_FALSE;
+
+    while ((nextcmd = GL3_NextDrawCommand(finalcmd)) != NULL) {
+        if (nextcmd->command != thiscmdtype) {
+            break; /* can't go any further on this draw call, different render command up next. */
+        } else if (nextcmd->data.draw.index_size) {
+            break; /* can't go any further on this draw call, indexed geometry up next. */
+        } else if (nextcmd->data.draw.texture != cmd->data.draw.texture || nextcmd->data.draw.blend != cmd->data.draw.blend) {
+            break; /* can't go any further on this draw call, different texture/blendmode up next. */
+        } else if (nextcmd->data.draw.first < base || ((nextcmd->data.draw.first - base) % stride) != 0) {
+            break; /* can't go any further on this draw call, the vertices don't line up. */
+        } else if (nextcmd->data.draw.first != end && !data->glMultiDrawArrays && contiguous) {
+            break; /* can't go any further on this draw call, the vertices aren't next to these. */
+        }
+        if (nextcmd->data.draw.first != end) {
+            contiguous = SDL_FALSE;
+        }
+        end = nextcmd->data.draw.first + nextcmd->data.draw.count * stride;
+        finalcmd = nextcmd;
+        ++num_draws;
+    }
+
+    GL3_SetVertexAttributes(data, shader, buffer, base);
+
+    if (contiguous) {
+        data->glDrawArrays(mode, 0, (GLsizei)((end - base) / stride));
+    } else if (!GL3_GrowMultiDraw(data, num_draws)) {
+        /* Out of memory, draw them one at a time */
+        for (nextcmd = cmd;; nextcmd = GL3_NextDrawCommand(nextcmd)) {
+            data->glDrawArrays(mode, (GLint)((nextcmd->data.draw.first - base) / stride), (GLsizei)nextcmd->data.draw.count);
+            if (nextcmd == finalcmd) {
+                break;
+            }
+        }
+    } else {
+        int i = 0;
+        for (nextcmd = cmd;; nextcmd = GL3_NextDrawCommand(nextcmd)) {
+            data->multidraw_first[i] = (GLint)((nextcmd->data.draw.first - base) / stride);
+            data->multidraw_count[i] = (GLsizei)nextcmd->data.draw.count;
+            ++i;
+            if (nextcmd == finalcmd) {
+                break;
+            }
+        }
+        if (data->glMultiDrawArrays) {
+            data->glMultiDrawArrays(mode, data->multidraw_first, data->multidraw_count, num_draws);
+        } else {
+            for (i = 0; i < num_draws; ++i) {
+                data->glDrawArrays(mode, data->multidraw_first[i], data->multidraw_count[i]);
+            }
+        }
+    }
+    return finalcmd;
+}
+
+/* Draw a run of rectangles or copies with one instanced draw call.
+   Returns the last command drawn. */
+static SDL_RenderCommand *GL3_DrawInstances(GL3_RenderData *data, SDL_RenderCommand *cmd, GL3_Shader shader, GLuint buffer)
+{
+    const size_t stride = GL3_VertexLayouts[shader].stride;
+    const size_t base = cmd->data.draw.first;
+    SDL_RenderCommand *finalcmd = cmd;
+    SDL_RenderCommand *nextcmd;
+    size_t count = cmd->data.draw.count;
+
+    while ((nextcmd = GL3_NextDrawCommand(finalcmd)) != NULL) {
+        if (shader == GL3_SHADER_COPY) {
+            if (nextcmd->command != SDL_RENDERCMD_COPY && nextcmd->command != SDL_RENDERCMD_COPY_EX) {
+                break; /* can't go any further on this draw call, different render command up next. */
+            }
+        } else if (nextcmd->command != cmd->command) {
+            break; /* can't go any further on this draw call, different render command up next. */
+        }
+        if (nextcmd->data.draw.texture != cmd->data.draw.texture || nextcmd->data.draw.blend != cmd->data.draw.blend) {
+            break; /* can't go any further on this draw call, different texture/blendmode up next. */
+        } else if (nextcmd->data.draw.first != base + count * stride) {
+            break; /* can't go any further on this draw call, the instances aren't next to these. */
+        }
+        count += nextcmd->data.draw.count;
+        finalcmd = nextcmd;
+    }
+
+    GL3_SetVertexAttributes(data, shader, buffer, base);
+    data->glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)count);
+    return finalcmd;
+}
+
+static void GL3_DrawCommands(SDL_Renderer *renderer, SDL_RenderCommand *cmd, GLuint buffer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    data->drawstate.target = renderer->target;
+    if (!data->drawstate.target) {
+        int w, h;
+        SDL_GL_GetDrawableSize(renderer->window, &w, &h);
+        if ((w != data->drawstate.drawablew) || (h != data->drawstate.drawableh)) {
+            data->drawstate.viewport_dirty = SDL_TRUE; // if the window dimensions changed, invalidate the current viewport, etc.
+            data->drawstate.cliprect_dirty = SDL_TRUE;
+            data->drawstate.drawablew = w;
+            data->drawstate.drawableh = h;
+        }
+    }
+
+#ifdef __MACOSX__
+    // On macOS on older systems, the OpenGL view change and resize events aren't
+    // necessarily synchronized, so just always reset it.
+    // Workaround for: https://discourse.libsdl.org/t/sdl-2-0-22-prerelease/35306/6
+    data->drawstate.viewport_dirty = SDL_TRUE;
+#endif
+
+    while (cmd) {
+        switch (cmd->command) {
+        case SDL_RENDERCMD_SETDRAWCOLOR: /* the color is part of the vertices */
+            break;
+
+        case SDL_RENDERCMD_SETVIEWPORT:
+        {
+            SDL_Rect *viewport = &data->drawstate.viewport;
+            if (SDL_memcmp(viewport, &cmd->data.viewport.rect, sizeof(cmd->data.viewport.rect)) != 0) {
+                SDL_copyp(viewport, &cmd->data.viewport.rect);
+                data->drawstate.viewport_dirty = SDL_TRUE;
+                data->drawstate.cliprect_dirty = SDL_TRUE;
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_SETCLIPRECT:
+        {
+            const SDL_Rect *rect = &cmd->data.cliprect.rect;
+            if (data->drawstate.cliprect_enabled != cmd->data.cliprect.enabled) {
+                data->drawstate.cliprect_enabled = cmd->data.cliprect.enabled;
+                data->drawstate.cliprect_enabled_dirty = SDL_TRUE;
+            }
+
+            if (SDL_memcmp(&data->drawstate.cliprect, rect, sizeof(*rect)) != 0) {
+                SDL_copyp(&data->drawstate.cliprect, rect);
+                data->drawstate.cliprect_dirty = SDL_TRUE;
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_CLEAR:
+        {
+            const Uint8 r = cmd->data.color.r;
+            const Uint8 g = cmd->data.color.g;
+            const Uint8 b = cmd->data.color.b;
+            const Uint8 a = cmd->data.color.a;
+            const Uint32 color = (((Uint32)a << 24) | (r << 16) | (g << 8) | b);
+            if (color != data->drawstate.clear_color) {
+                const GLfloat fr = ((GLfloat)r) * inv255f;
+                const GLfloat fg = ((GLfloat)g) * inv255f;
+                const GLfloat fb = ((GLfloat)b) * inv255f;
+                const GLfloat fa = ((GLfloat)a) * inv255f;
+                data->glClearColor(fr, fg, fb, fa);
+                data->drawstate.clear_color = color;
+            }
+
+            if (data->drawstate.cliprect_enabled || data->drawstate.cliprect_enabled_dirty) {
+                data->glDisable(GL_SCISSOR_TEST);
+                data->drawstate.cliprect_enabled_dirty = data->drawstate.cliprect_enabled;
+            }
+
+            data->glClear(GL_COLOR_BUFFER_BIT);
+            break;
+        }
+
+        case SDL_RENDERCMD_FILL_RECTS:
+        {
+            if (SetDrawState(data, cmd, GL3_SHADER_RECTS) == 0) {
+                cmd = GL3_DrawInstances(data, cmd, GL3_SHADER_RECTS, buffer);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX:
+        {
+            if (SetDrawState(data, cmd, GL3_SHADER_COPY) == 0) {
+                cmd = GL3_DrawInstances(data, cmd, GL3_SHADER_COPY, buffer);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_DRAW_POINTS:
+        case SDL_RENDERCMD_DRAW_LINES:
+        {
+            if (SetDrawState(data, cmd, GL3_SHADER_SOLID) == 0) {
+                cmd = GL3_DrawArrays(data, cmd, GL3_SHADER_SOLID, buffer);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_GEOMETRY:
+        {
+            const GL3_Shader shader = cmd->data.draw.texture ? GL3_SHADER_TEXTURE : GL3_SHADER_SOLID;
+
+            if (SetDrawState(data, cmd, shader) == 0) {
+                if (cmd->data.draw.index_size) {
+                    /* The indices are in the same buffer as the vertices */
+                    const GLenum type = (cmd->data.draw.index_size == 4) ? GL_UNSIGNED_INT : GL_UNSIGNED_SHORT;
+                    GL3_SetVertexAttributes(data, shader, buffer, cmd->data.draw.first);
+                    data->glDrawElements(GL_TRIANGLES, (GLsizei)cmd->data.draw.num_indices, type, (const void *)(uintptr_t)cmd->data.draw.indices);
+                } else {
+                    cmd = GL3_DrawArrays(data, cmd, shader, buffer);
+                }
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_UPDATE_TEXTURE:
+        {
+            const SDL_Rect *rect = &cmd->data.update.rect;
+            GL3_TextureData *texturedata = (GL3_TextureData *)cmd->data.update.texture->driverdata;
+
+            data->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+            data->glBindTexture(GL_TEXTURE_2D, texturedata->texture);
+            data->drawstate.texture = NULL; /* we trash this state. */
+            data->glPixelStorei(GL_UNPACK_ROW_LENGTH, rect->w);
+            data->glTexSubImage2D(GL_TEXTURE_2D, 0, rect->x, rect->y, rect->w, rect->h,
+                                  texturedata->format, texturedata->formattype,
+                                  (const void *)(uintptr_t)cmd->data.update.first);
+            data->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            break;
+        }
+
+        case SDL_RENDERCMD_NO_OP:
+            break;
+        }
+
+        cmd = cmd->next;
+    }
+}
+
+/* Upload vertex blocks to the bound array buffer, at their offsets */
+static void GL3_UploadVertexBlocks(GL3_RenderData *data, const SDL_RenderVertexBlock *vertices, size_t vertsize, GLenum usage)
+{
+    if (!vertices->next) {
+        data->glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertsize, vertices->data, usage);
+        return;
+    }
+
+    data->glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)vertsize, NULL, usage);
+    for (; vertices; vertices = vertices->next) {
+        data->glBufferSubData(GL_ARRAY_BUFFER, (GLintptr)vertices->offset, (GLsizeiptr)vertices->used, vertices->data);
+    }
+}
+
+static int GL3_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    if (GL3_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    if (vertsize > 0) {
+        /* Orphan the old contents, so we don't wait for draws still using them */
+        data->glBindBuffer(GL_ARRAY_BUFFER, data->vertex_buffer);
+        GL3_UploadVertexBlocks(data, vertices, vertsize, GL_STREAM_DRAW);
+        data->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    GL3_DrawCommands(renderer, cmd, data->vertex_buffer);
+
+    return GL3_CheckError("", renderer);
+}
+
+/* Command lists keep their vertices in a buffer of their own, uploaded once */
+static int GL3_CreateCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    GLuint buffer = 0;
+
+    if (list->vertex_data_used == 0) {
+        return 0; /* nothing to keep */
+    }
+
+    if (GL3_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    data->glGenBuffers(1, &buffer);
+    data->glBindBuffer(GL_ARRAY_BUFFER, buffer);
+    GL3_UploadVertexBlocks(data, list->vertex_blocks, list->vertex_data_used, GL_STATIC_DRAW);
+    data->glBindBuffer(GL_ARRAY_BUFFER, 0);
+    list->driverdata = (void *)(uintptr_t)buffer;
+
+    return GL3_CheckError("glBufferData()", renderer);
+}
+
+static int GL3_RunCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    const GLuint buffer = (GLuint)(uintptr_t)list->driverdata;
+
+    if (GL3_ActivateRenderer(renderer) < 0) {
+        return -1;
+    }
+
+    GL3_DrawCommands(renderer, list->commands, buffer ? buffer : data->vertex_buffer);
+
+    return GL3_CheckError("", renderer);
+}
+
+static void GL3_DestroyCommandList(SDL_Renderer *renderer, SDL_RenderCommandList *list)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    GLuint buffer = (GLuint)(uintptr_t)list->driverdata;
+
+    if (buffer) {
+        int i;
+
+        GL3_ActivateRenderer(renderer);
+        data->glDeleteBuffers(1, &buffer);
+
+        /* The name may be reused for another buffer, point the attributes at it again */
+        for (i = 0; i < GL3_NUM_SHADERS; ++i) {
+            if (data->vertex_array_buffers[i] == buffer) {
+                data->vertex_array_buffers[i] = 0;
+            }
+        }
+    }
+    list->driverdata = NULL;
+}
+
+static int GL3_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
+                                Uint32 pixel_format, void *pixels, int pitch)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    Uint32 temp_format;
+    void *temp_pixels;
+    int temp_pitch;
+    GLenum format, type;
+    Uint8 *src, *dst, *tmp;
+    int w, h, length, rows;
+    int status;
+
+    GL3_ActivateRenderer(renderer);
+
+    if (data->gles) {
+        /* The only format OpenGL ES always reads */
+        temp_format = SDL_PIXELFORMAT_RGBA32;
+        format = GL_RGBA;
+        type = GL_UNSIGNED_BYTE;
+    } else {
+        temp_format = renderer->target ? renderer->target->format : SDL_PIXELFORMAT_ARGB8888;
+        if (!convert_format(data, temp_format, &format, &type)) {
+            return SDL_SetError("Texture format %s not supported by OpenGL",
+                                SDL_GetPixelFormatName(temp_format));
+        }
+    }
+
+    if (rect->w == 0 || rect->h == 0) {
+        return 0; /* nothing to do. */
+    }
+
+    temp_pitch = rect->w * SDL_BYTESPERPIXEL(temp_format);
+    temp_pixels = SDL_malloc((size_t)rect->h * temp_pitch);
+    if (!temp_pixels) {
+        return SDL_OutOfMemory();
+    }
+
+    SDL_GetRendererOutputSize(renderer, &w, &h);
+
+    data->glPixelStorei(GL_PACK_ROW_LENGTH,
+                        (temp_pitch / SDL_BYTESPERPIXEL(temp_format)));
+
+    data->glReadPixels(rect->x, renderer->target ? rect->y : (h - rect->y) - rect->h,
+                       rect->w, rect->h, format, type, temp_pixels);
+
+    if (GL3_CheckError("glReadPixels()", renderer) < 0) {
+        SDL_free(temp_pixels);
+        return -1;
+    }
+
+    /* Flip the rows to be top-down if necessary */
+    if (!renderer->target) {
+        SDL_bool isstack;
+        length = rect->w * SDL_BYTESPERPIXEL(temp_format);
+        src = (Uint8 *)temp_pixels + (rect->h - 1) * temp_pitch;
+        dst = (Uint8 *)temp_pixels;
+        tmp = SDL_small_alloc(Uint8, length, &isstack);
+        rows = rect->h / 2;
+        while (rows--) {
+            SDL_memcpy(tmp, dst, length);
+            SDL_memcpy(dst, src, length);
+            SDL_memcpy(src, tmp, length);
+            dst += temp_pitch;
+            src -= temp_pitch;
+        }
+        SDL_small_free(tmp, isstack);
+    }
+
+    status = SDL_ConvertPixels(rect->w, rect->h,
+                               temp_format, temp_pixels, temp_pitch,
+                               pixel_format, pixels, pitch);
+    SDL_free(temp_pixels);
+
+    return status;
+}
+
+static int GL3_RenderPresent(SDL_Renderer *renderer)
+{
+    GL3_ActivateRenderer(renderer);
+
+    return SDL_GL_SwapWindowWithDamage(renderer->window, renderer->present_damage_rects, renderer->num_present_damage_rects);
+}
+
+static int GL3_GetBufferAge(SDL_Renderer *renderer)
+{
+    GL3_ActivateRenderer(renderer);
+
+    return SDL_GL_GetBufferAge(renderer->window);
+}
+
+static void GL3_SetDamageRegion(SDL_Renderer *renderer, const SDL_Rect *rect)
+{
+    SDL_GL_SetDamageRegion(renderer->window, rect, 1);
+}
+
+static void GL3_ReleaseContext(SDL_Renderer *renderer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    if (SDL_GL_GetCurrentContext() == data->context) {
+        SDL_GL_MakeCurrent(renderer->window, NULL);
+    }
+}
+
+static void GL3_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    GL3_RenderData *renderdata = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *data = (GL3_TextureData *)texture->driverdata;
+
+    GL3_ActivateRenderer(renderer);
+
+    if (renderdata->drawstate.texture == texture) {
+        renderdata->drawstate.texture = NULL;
+    }
+    if (renderdata->drawstate.target == texture) {
+        renderdata->drawstate.target = NULL;
+    }
+
+    if (!data) {
+        return;
+    }
+    if (data->fbo) {
+        renderdata->glDeleteFramebuffers(1, &data->fbo);
+    }
+    if (data->texture) {
+        renderdata->glDeleteTextures(1, &data->texture);
+    }
+    SDL_free(data->pixels);
+    SDL_free(data);
+    texture->driverdata = NULL;
+}
+
+static void GL3_DestroyRenderer(SDL_Renderer *renderer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    if (data) {
+        if (data->context) {
+            int i;
+
+            /* make sure we delete the right resources! */
+            GL3_ActivateRenderer(renderer);
+
+            for (i = 0; i < GL3_NUM_SHADERS; ++i) {
+                if (data->programs[i]) {
+                    data->glDeleteProgram(data->programs[i]);
+                }
+            }
+            data->glDeleteVertexArrays(GL3_NUM_SHADERS, data->vertex_arrays);
+            if (data->vertex_buffer) {
+                data->glDeleteBuffers(1, &data->vertex_buffer);
+            }
+            if (data->uniform_buffer) {
+                data->glDeleteBuffers(1, &data->uniform_buffer);
+            }
+            GL3_CheckError("", renderer);
+            SDL_GL_DeleteContext(data->context);
+        }
+        SDL_free(data->multidraw_first);
+        SDL_free(data->multidraw_count);
+        SDL_free(data);
+    }
+    SDL_free(renderer);
+}
+
+static int GL3_BindTexture(SDL_Renderer *renderer, SDL_Texture *texture, float *texw, float *texh)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    GL3_TextureData *texturedata = (GL3_TextureData *)texture->driverdata;
+
+    GL3_ActivateRenderer(renderer);
+
+    data->glBindTexture(GL_TEXTURE_2D, texturedata->texture);
+    data->drawstate.texture = texture;
+
+    if (texw) {
+        *texw = 1.0f;
+    }
+    if (texh) {
+        *texh = 1.0f;
+    }
+    return 0;
+}
+
+static int GL3_UnbindTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+
+    GL3_ActivateRenderer(renderer);
+
+    data->glBindTexture(GL_TEXTURE_2D, 0);
+    data->drawstate.texture = NULL;
+
+    return 0;
+}
+
+static int GL3_SetVSync(SDL_Renderer *renderer, const int vsync)
+{
+    int retval;
+    if (vsync) {
+        retval = SDL_GL_SetSwapInterval(1);
+    } else {
+        retval = SDL_GL_SetSwapInterval(0);
+    }
+    if (retval != 0) {
+        return retval;
+    }
+    if (SDL_GL_GetSwapInterval() != 0) {
+        renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
+    } else {
+        renderer->info.flags &= ~SDL_RENDERER_PRESENTVSYNC;
+    }
+    return retval;
+}
+
+static GLuint GL3_CompileShader(SDL_Renderer *renderer, GLenum type, const char *source)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    const GLchar *sources[3];
+    GLsizei num_sources = 0;
+    GLuint shader;
+    GLint status = 0;
+
+    /* The sources are the same for both APIs, apart from the version */
+    if (data->gles) {
+        sources[num_sources++] = "#version 300 es\n";
+        if (type == GL_FRAGMENT_SHADER) {
+            sources[num_sources++] = "precision highp float;\n";
+        }
+    } else {
+        sources[num_sources++] = "#version 330 core\n";
+    }
+    sources[num_sources++] = source;
+
+    shader = data->glCreateShader(type);
+    data->glShaderSource(shader, num_sources, sources, NULL);
+    data->glCompileShader(shader);
+    data->glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+    if (!status) {
+        char log[1024];
+
+        log[0] = '\0';
+        data->glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+        SDL_SetError("Failed to compile shader: %s", log);
+        data->glDeleteShader(shader);
+        return 0;
+    }
+    return shader;
+}
+
+static int GL3_CreateProgram(SDL_Renderer *renderer, GL3_Shader shader)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    GLuint vert_shader, frag_shader, program;
+    GLuint globals;
+    GLint location;
+    GLint status = 0;
+
+    vert_shader = GL3_CompileShader(renderer, GL_VERTEX_SHADER, GL3_GetVertexShaderSource(shader));
+    if (!vert_shader) {
+        return -1;
+    }
+    frag_shader = GL3_CompileShader(renderer, GL_FRAGMENT_SHADER, GL3_GetFragmentShaderSource(shader));
+    if (!frag_shader) {
+        data->glDeleteShader(vert_shader);
+        return -1;
+    }
+
+    program = data->glCreateProgram();
+    data->glAttachShader(program, vert_shader);
+    data->glAttachShader(program, frag_shader);
+    data->glLinkProgram(program);
+    /* The program keeps them until it's deleted */
+    data->glDeleteShader(vert_shader);
+    data->glDeleteShader(frag_shader);
+    data->glGetProgramiv(program, GL_LINK_STATUS, &status);
+    if (!status) {
+        char log[1024];
+
+        log[0] = '\0';
+        data->glGetProgramInfoLog(program, sizeof(log), NULL, log);
+        data->glDeleteProgram(program);
+        return SDL_SetError("Failed to link shader program: %s", log);
+    }
+
+    globals = data->glGetUniformBlockIndex(program, "SDL_Globals");
+    if (globals != GL_INVALID_INDEX) {
+        data->glUniformBlockBinding(program, globals, GL3_GLOBALS_BINDING);
+    }
+    location = data->glGetUniformLocation(program, "u_texture");
+    if (location >= 0) {
+        data->glUseProgram(program);
+        data->glUniform1i(location, 0);
+        data->glUseProgram(0);
+    }
+
+    data->programs[shader] = program;
+    return 0;
+}
+
+static void GL3_CreateVertexArrays(SDL_Renderer *renderer)
+{
+    GL3_RenderData *data = (GL3_RenderData *)renderer->driverdata;
+    int i, j;
+
+    data->glGenVertexArrays(GL3_NUM_SHADERS, data->vertex_arrays);
+    for (i = 0; i < GL3_NUM_SHADERS; ++i) {
+        data->glBindVertexArray(data->vertex_arrays[i]);
+        for (j = 0; j < GL3_VertexLayouts[i].num_attributes; ++j) {
+            const GLuint index = GL3_VertexLayouts[i].attributes[j].index;
+            data->glEnableVertexAttribArray(index);
+            if (GL3_VertexLayouts[i].instanced) {
+                data->glVertexAttribDivisor(index, 1);
+            }
+        }
+    }
+    data->glBindVertexArray(0);
+}
+
+static SDL_Renderer *GL3_CreateRendererForAPI(SDL_Window *window, Uint32 flags, const SDL_RendererInfo *info, SDL_bool gles)
+{
+    SDL_Renderer *renderer;
+    GL3_RenderData *data;
+    GLint value;
+    Uint32 window_flags;
+    const int wanted_profile = gles ? SDL_GL_CONTEXT_PROFILE_ES : SDL_GL_CONTEXT_PROFILE_CORE;
+    const int wanted_major = gles ? RENDERER_CONTEXT_MAJOR_ES : RENDERER_CONTEXT_MAJOR;
+    const int wanted_minor = gles ? RENDERER_CONTEXT_MINOR_ES : RENDERER_CONTEXT_MINOR;
+    int profile_mask = 0, major = 0, minor = 0;
+    SDL_bool changed_window = SDL_FALSE;
+    int i;
+
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, &profile_mask);
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, &major);
+    SDL_GL_GetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, &minor);
+
+    window_flags = SDL_GetWindowFlags(window);
+    if (!(window_flags & SDL_WINDOW_OPENGL) ||
+        profile_mask != wanted_profile || major != wanted_major || minor != wanted_minor) {
+
+        changed_window = SDL_TRUE;
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, wanted_profile);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, wanted_major);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, wanted_minor);
+
+        if (SDL_RecreateWindow(window, (window_flags & ~(SDL_WINDOW_VULKAN | SDL_WINDOW_METAL)) | SDL_WINDOW_OPENGL) < 0) {
+            goto error;
+        }
+    }
+
+    renderer = (SDL_Renderer *)SDL_calloc(1, sizeof(*renderer));
+    if (!renderer) {
+        SDL_OutOfMemory();
+        goto error;
+    }
+
+    data = (GL3_RenderData *)SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        SDL_free(renderer);
+        SDL_OutOfMemory();
+        goto error;
+    }
+
+    renderer->WindowEvent = GL3_WindowEvent;
+    renderer->GetOutputSize = GL3_GetOutputSize;
+    renderer->SupportsBlendMode = GL3_SupportsBlendMode;
+    renderer->CreateTexture = GL3_CreateTexture;
+    renderer->UpdateTexture = GL3_UpdateTexture;
+    renderer->LockTexture = GL3_LockTexture;
+    renderer->UnlockTexture = GL3_UnlockTexture;
+    renderer->SetTextureScaleMode = GL3_SetTextureScaleMode;
+    renderer->SetRenderTarget = GL3_SetRenderTarget;
+    renderer->QueueSetViewport = GL3_QueueNoOp;
+    renderer->QueueSetDrawColor = GL3_QueueNoOp;
+    renderer->QueueDrawPoints = GL3_QueueDrawPoints;
+    renderer->QueueDrawLines = GL3_QueueDrawLines;
+    renderer->QueueFillRects = GL3_QueueFillRects;
+    renderer->QueueCopy = GL3_QueueCopy;
+    renderer->QueueCopyEx = GL3_QueueCopyEx;
+    renderer->QueueGeometry = GL3_QueueGeometry;
+    renderer->QueueUpdateTexture = GL3_QueueUpdateTexture;
+    renderer->RunCommandQueue = GL3_RunCommandQueue;
+    renderer->CreateCommandList = GL3_CreateCommandList;
+    renderer->RunCommandList = GL3_RunCommandList;
+    renderer->DestroyCommandList = GL3_DestroyCommandList;
+    renderer->RenderReadPixels = GL3_RenderReadPixels;
+    renderer->RenderPresent = GL3_RenderPresent;
+    renderer->GetBufferAge = GL3_GetBufferAge;
+    renderer->SetDamageRegion = GL3_SetDamageRegion;
+    renderer->ReleaseContext = GL3_ReleaseContext;
+    renderer->DestroyTexture = GL3_DestroyTexture;
+    renderer->DestroyRenderer = GL3_DestroyRenderer;
+    renderer->SetVSync = GL3_SetVSync;
+    renderer->GL_BindTexture = GL3_BindTexture;
+    renderer->GL_UnbindTexture = GL3_UnbindTexture;
+    renderer->info = *info;
+    renderer->info.flags = 0; /* will set some flags below. */
+    renderer->driverdata = data;
+    data->gles = gles;
+    data->stats = &renderer->stats;
+    renderer->window = window;
+
+    data->context = SDL_GL_CreateContext(window);
+    if (!data->context) {
+        SDL_free(renderer);
+        SDL_free(data);
+        goto error;
+    }
+    if (SDL_GL_MakeCurrent(window, data->context) < 0) {
+        SDL_GL_DeleteContext(data->context);
+        SDL_free(renderer);
+        SDL_free(data);
+        goto error;
+    }
+
+    if (GL3_LoadFunctions(data) < 0) {
+        SDL_GL_DeleteContext(data->context);
+        SDL_free(renderer);
+        SDL_free(data);
+        goto error;
+    }
+
+    if (SDL_GL_IsProbablyAccelerated((const char *)data->glGetString(GL_RENDERER))) {
+        renderer->info.flags |= SDL_RENDERER_ACCELERATED;
+    }
+
+    if (flags & SDL_RENDERER_PRESENTVSYNC) {
+        SDL_GL_SetSwapInterval(1);
+    } else {
+        SDL_GL_SetSwapInterval(0);
+    }
+    if (SDL_GL_GetSwapInterval() != 0) {
+        renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
+    }
+
+    /* Check for debug output support */
+    if (SDL_GL_GetAttribute(SDL_GL_CONTEXT_FLAGS, &value) == 0 &&
+        (value & SDL_GL_CONTEXT_DEBUG_FLAG)) {
+        data->debug_enabled = SDL_TRUE;
+    }
+
+    for (i = 0; i < GL3_NUM_SHADERS; ++i) {
+        if (GL3_CreateProgram(renderer, (GL3_Shader)i) < 0) {
+            GL3_DestroyRenderer(renderer);
+            goto error;
+        }
+    }
+    SDL_LogInfo(SDL_LOG_CATEGORY_RENDER, "OpenGL%s shaders: ENABLED", gles ? " ES" : "");
+
+    /* OpenGL ES 3.0 has immutable textures, OpenGL needs 4.2 or the extension */
+    if (!gles) {
+        GLint gl_major = 0, gl_minor = 0;
+        data->glGetIntegerv(GL_MAJOR_VERSION, &gl_major);
+        data->glGetIntegerv(GL_MINOR_VERSION, &gl_minor);
+        if (gl_major > 4 || (gl_major == 4 && gl_minor >= 2) ||
+            SDL_GL_ExtensionSupported("GL_ARB_texture_storage")) {
+            data->glTexStorage2D = SDL_GL_GetProcAddress("glTexStorage2D");
+        }
+        data->glMultiDrawArrays = SDL_GL_GetProcAddress("glMultiDrawArrays");
+    } else {
+        data->glTexStorage2D = SDL_GL_GetProcAddress("glTexStorage2D");
+        if (SDL_GL_ExtensionSupported("GL_EXT_multi_draw_arrays")) {
+            data->glMultiDrawArrays = SDL_GL_GetProcAddress("glMultiDrawArraysEXT");
+        }
+    }
+
+    data->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &value);
+    renderer->info.max_texture_width = value;
+    renderer->info.max_texture_height = value;
+    renderer->info.flags |= SDL_RENDERER_TARGETTEXTURE;
+
+    GL3_CreateVertexArrays(renderer);
+    data->glGenBuffers(1, &data->vertex_buffer);
+
+    /* The projection, shared by all the programs */
+    data->glGenBuffers(1, &data->uniform_buffer);
+    data->glBindBuffer(GL_UNIFORM_BUFFER, data->uniform_buffer);
+    data->glBufferData(GL_UNIFORM_BUFFER, 16 * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+    data->glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    data->glBindBufferBase(GL_UNIFORM_BUFFER, GL3_GLOBALS_BINDING, data->uniform_buffer);
+
+    /* Set up parameters for rendering */
+    data->glActiveTexture(GL_TEXTURE0);
+    data->glDisable(GL_DEPTH_TEST);
+    data->glDisable(GL_CULL_FACE);
+    data->glDisable(GL_SCISSOR_TEST);
+    data->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    data->glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    data->glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+    data->drawstate.blend = SDL_BLENDMODE_INVALID;
+    data->drawstate.shader = GL3_SHADER_INVALID;
+    data->drawstate.clear_color = 0xFFFFFFFF;
+
+    if (GL3_CheckError("", renderer) < 0) {
+        GL3_DestroyRenderer(renderer);
+        goto error;
+    }
+
+    return renderer;
+
+error:
+    if (changed_window) {
+        /* Uh oh, better try to put it back... */
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, profile_mask);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, major);
+        SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, minor);
+        SDL_RecreateWindow(window, window_flags);
+    }
+    return NULL;
+}
+
+#if SDL_VIDEO_RENDER_OGL3
+static SDL_Renderer *GL3_CreateRenderer(SDL_Window *window, Uint32 flags)
+{
+    return GL3_CreateRendererForAPI(window, flags, &GL3_RenderDriver.info, SDL_FALSE);
+}
+
+SDL_RenderDriver GL3_RenderDriver = {
+    GL3_CreateRenderer,
+    { "opengl3",
+      (SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE),
+      4,
+      { SDL_PIXELFORMAT_ARGB8888,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_PIXELFORMAT_RGB888,
+        SDL_PIXELFORMAT_BGR888 },
+      0,
+      0 }
+};
+#endif /* SDL_VIDEO_RENDER_OGL3 */
+
+#if SDL_VIDEO_RENDER_OGL_ES3
+static SDL_Renderer *GLES3_CreateRenderer(SDL_Window *window, Uint32 flags)
+{
+    return GL3_CreateRendererForAPI(window, flags, &GLES3_RenderDriver.info, SDL_TRUE);
+}
+
+SDL_RenderDriver GLES3_RenderDriver = {
+    GLES3_CreateRenderer,
+    { "opengles3",
+      (SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE),
+      2,
+      { GLES3_PIXELFORMAT_RGBA,
+        GLES3_PIXELFORMAT_RGBX },
+      0,
+      0 }
+};
+#endif /* SDL_VIDEO_RENDER_OGL_ES3 */
+
+#endif /* SDL_VIDEO_RENDER_OGL3 || SDL_VIDEO_RENDER_OGL_ES3 */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,147 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_OGL3 || SDL_VIDEO_RENDER_OGL_ES3
+
+#include "SDL_shaders_gl3.h"
+
+/* OpenGL 3.3 core / OpenGL ES 3.0 shader implementation */
+
+/* *INDENT-OFF* */ /* clang-format off */
+
+#define GLOBALS_BLOCK                                                   \
+"layout(std140) uniform SDL_Globals\n"                                  \
+"{\n"                                                                   \
+"    mat4 u_projection;\n"                                              \
+"};\n"                                                                  \
+
+/* The instanced shaders draw a triangle strip of 4 vertices per instance */
+#define QUAD_CORNER                                                     \
+"    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));\n" \
+
+static const char *vertex_shader_source[GL3_NUM_SHADERS] = {
+    /* GL3_SHADER_SOLID */
+GLOBALS_BLOCK
+"layout(location = 0) in vec2 a_position;\n"
+"layout(location = 1) in vec4 a_color;\n"
+"out vec4 v_color;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    gl_Position = u_projection * vec4(a_position, 0.0, 1.0);\n"
+"    gl_PointSize = 1.0;\n"
+"    v_color = a_color;\n"
+"}\n",
+
+    /* GL3_SHADER_TEXTURE */
+GLOBALS_BLOCK
+"layout(location = 0) in vec2 a_position;\n"
+"layout(location = 1) in vec4 a_color;\n"
+"layout(location = 2) in vec2 a_texcoord;\n"
+"out vec4 v_color;\n"
+"out vec2 v_texcoord;\n"
+"\n"
+"void main()\n"
+"{\n"
+"    gl_Position = u_projection * vec4(a_position, 0.0, 1.0);\n"
+"    v_color = a_color;\n"
+"    v_texcoord = a_texcoord;\n"
+"}\n",
+
+    /* GL3_SHADER_RECTS */
+GLOBALS_BLOCK
+"layout(location = 0) in vec4 a_rect;\n"
+"layout(location = 1) in vec4 a_color;\n"
+"out vec4 v_color;\n"
+"\n"
+"void main()\n"
+"{\n"
+QUAD_CORNER
+"    gl_Position = u_projection * vec4(a_rect.xy + corner * a_rect.zw, 0.0, 1.0);\n"
+"    v_color = a_color;\n"
+"}\n",
+
+    /* GL3_SHADER_COPY */
+GLOBALS_BLOCK
+"layout(location = 0) in vec2 a_position;\n"
+"layout(location = 1) in vec4 a_color;\n"
+"layout(location = 2) in vec4 a_texrect;\n"
+"layout(location = 3) in vec4 a_axes;\n"
+"out vec4 v_color;\n"
+"out vec2 v_texcoord;\n"
+"\n"
+"void main()\n"
+"{\n"
+QUAD_CORNER
+"    vec2 position = a_position + corner.x * a_axes.xy + corner.y * a_axes.zw;\n"
+"    gl_Position = u_projection * vec4(position, 0.0, 1.0);\n"
+"    v_color = a_color;\n"
+"    v_texcoord = mix(a_texrect.xy, a_texrect.zw, corner);\n"
+"}\n",
+};
+
+#define SOLID_FRAGMENT_SHADER                                           \
+"in vec4 v_color;\n"                                                    \
+"out vec4 o_color;\n"                                                   \
+"\n"                                                                    \
+"void main()\n"                                                         \
+"{\n"                                                                   \
+"    o_color = v_color;\n"                                              \
+"}\n"                                                                   \
+
+#define TEXTURE_FRAGMENT_SHADER                                         \
+"uniform sampler2D u_texture;\n"                                        \
+"in vec4 v_color;\n"                                                    \
+"in vec2 v_texcoord;\n"                                                 \
+"out vec4 o_color;\n"                                                   \
+"\n"                                                                    \
+"void main()\n"                                                         \
+"{\n"                                                                   \
+"    o_color = texture(u_texture, v_texcoord) * v_color;\n"             \
+"}\n"                                                                   \
+
+static const char *fragment_shader_source[GL3_NUM_SHADERS] = {
+    /* GL3_SHADER_SOLID */
+    SOLID_FRAGMENT_SHADER,
+    /* GL3_SHADER_TEXTURE */
+    TEXTURE_FRAGMENT_SHADER,
+    /* GL3_SHADER_RECTS */
+    SOLID_FRAGMENT_SHADER,
+    /* GL3_SHADER_COPY */
+    TEXTURE_FRAGMENT_SHADER,
+};
+
+/* *INDENT-ON* */ /* clang-format on */
+
+const char *GL3_GetVertexShaderSource(GL3_Shader shader)
+{
+    return vertex_shader_source[shader];
+}
+
+const char *GL3_GetFragmentShaderSource(GL3_Shader shader)
+{
+    return fragment_shader_source[shader];
+}
+
+#endif /* SDL_VIDEO_RENDER_OGL3 || SDL_VIDEO_RENDER_OGL_ES3 */
+
+/* vi: set ts=4 sw=4 expandtab: */
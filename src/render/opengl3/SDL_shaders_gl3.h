@@ -0,0 +1,53 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_shaders_gl3_h_
+#define SDL_shaders_gl3_h_
+
+#include "../../SDL_internal.h"
+
+/* OpenGL 3.3 core / OpenGL ES 3.0 shader implementation */
+
+typedef enum
+{
+    GL3_SHADER_SOLID,   /* points, lines and untextured geometry */
+    GL3_SHADER_TEXTURE, /* textured geometry */
+    GL3_SHADER_RECTS,   /* solid rectangles, one instance each */
+    GL3_SHADER_COPY,    /* textured quads, one instance each */
+    GL3_NUM_SHADERS
+} GL3_Shader;
+
+/* Vertex attribute locations, the instanced shaders use them for per-instance data */
+#define GL3_ATTRIB_POSITION 0
+#define GL3_ATTRIB_COLOR    1
+#define GL3_ATTRIB_TEXCOORD 2
+#define GL3_ATTRIB_AXES     3
+
+/* The uniform block with the projection is bound here */
+#define GL3_GLOBALS_BINDING 0
+
+/* The sources don't have a #version line, it depends on the API */
+extern const char *GL3_GetVertexShaderSource(GL3_Shader shader);
+extern const char *GL3_GetFragmentShaderSource(GL3_Shader shader);
+
+#endif /* SDL_shaders_gl3_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
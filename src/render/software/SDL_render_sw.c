@@ -0,0 +1,1259 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_SW && !defined(SDL_RENDER_DISABLED)
+
+#include "SDL_hints.h"
+#include "SDL_cpuinfo.h"
+#include "SDL_atomic.h"
+#include "../SDL_sysrender.h"
+#include "../../thread/SDL_systhread.h"
+#include "SDL_render_sw_c.h"
+#include "SDL_swraster_c.h"
+
+/* The software renderer resolves the command queue into a flat list of draw
+   items, bins them into fixed size tiles of the target, and rasterizes the
+   tiles in parallel. Every tile is owned by exactly one thread and replays
+   its items in submission order, so no locking is needed on the target and
+   the result is identical to drawing everything on one thread. */
+
+#define SW_TILE_SIZE    64
+#define SW_MAX_THREADS  16
+
+/* Flushes that touch fewer pixels than this are rendered on the calling
+   thread, waking the workers up costs more than it saves. */
+#define SW_MIN_PARALLEL_PIXELS (256 * 256)
+
+typedef struct
+{
+    SDL_Rect srcrect;
+    SDL_FRect dstrect;
+} SW_CopyData;
+
+typedef struct
+{
+    SDL_Surface *surface;
+    /* Blitting changes the source surface's blit map, so every thread
+       gets its own view of the pixels. */
+    SDL_Surface *views[SW_MAX_THREADS];
+} SW_TextureData;
+
+typedef struct
+{
+    SDL_RenderCommandType command;
+    SDL_Rect clip;   /* absolute, intersected with the target */
+    SDL_Rect bounds; /* pixels the item can touch, inside clip */
+    SDL_Rect rect;   /* absolute destination of fills and unscaled copies */
+    int origin_x;
+    int origin_y;
+    SDL_Color color;
+    SDL_BlendMode blend;
+    SDL_Texture *texture;
+    SDL_bool blit;
+    const void *data;
+    int count;
+} SW_DrawItem;
+
+/* The viewport and clip rectangle, carried over between the runs of draws
+   that queued texture updates split a flush into */
+typedef struct
+{
+    SDL_Rect viewport;
+    SDL_Rect cliprect;
+    SDL_bool cliprect_enabled;
+} SW_ClipState;
+
+typedef struct SW_RenderData SW_RenderData;
+
+typedef struct
+{
+    SW_RenderData *data;
+    int index;
+    SDL_Thread *thread;
+    SDL_Surface *target; /* this thread's view of the current target */
+} SW_Worker;
+
+struct SW_RenderData
+{
+    SDL_Surface *surface;
+    SDL_Surface *window;
+
+    int num_threads;
+    SW_Worker workers[SW_MAX_THREADS];
+    SDL_sem *work_sem;
+    SDL_sem *done_sem;
+    SDL_atomic_t next_tile;
+    SDL_atomic_t quit;
+
+    /* The target the worker views were made for */
+    SDL_Surface *view_surface;
+    void *view_pixels;
+    int view_w, view_h, view_pitch;
+    Uint32 view_format;
+
+    /* Per flush state */
+    SW_DrawItem *items;
+    int num_items;
+    int max_items;
+    int tiles_x;
+    int tiles_y;
+    int *tile_offsets;
+    int max_tiles;
+    int *tile_items;
+    int max_tile_items;
+};
+
+static SDL_Surface *SW_ActivateRenderer(SDL_Renderer *renderer)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+
+    if (!data->surface) {
+        data->surface = data->window;
+    }
+    if (!data->surface) {
+        SDL_Surface *surface = SDL_GetWindowSurface(renderer->window);
+        if (surface) {
+            data->surface = data->window = surface;
+        }
+    }
+    return data->surface;
+}
+
+static void SW_WindowEvent(SDL_Renderer *renderer, const SDL_WindowEvent *event)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+
+    if (event->event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        data->surface = NULL;
+        data->window = NULL;
+    }
+}
+
+static int SW_GetOutputSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+
+    if (data->surface) {
+        if (w) {
+            *w = data->surface->w;
+        }
+        if (h) {
+            *h = data->surface->h;
+        }
+        return 0;
+    }
+
+    if (renderer->window) {
+        SDL_GetWindowSizeInPixels(renderer->window, w, h);
+        return 0;
+    }
+
+    return SDL_SetError("Software renderer doesn't have an output surface");
+}
+
+static SDL_bool SW_SupportsBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+{
+    return SW_RasterSupportsBlendMode(blendMode);
+}
+
+static int SW_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    SW_TextureData *texturedata = (SW_TextureData *)SDL_calloc(1, sizeof(*texturedata));
+
+    if (!texturedata) {
+        return SDL_OutOfMemory();
+    }
+
+    texturedata->surface = SDL_CreateRGBSurfaceWithFormat(0, texture->w, texture->h, 0, texture->format);
+    if (!texturedata->surface) {
+        SDL_free(texturedata);
+        return -1;
+    }
+    texture->driverdata = texturedata;
+    return 0;
+}
+
+static int SW_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                            const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    SDL_Surface *surface = ((SW_TextureData *)texture->driverdata)->surface;
+    Uint8 *src, *dst;
+    int row;
+    size_t length;
+
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_LockSurface(surface);
+    }
+    src = (Uint8 *)pixels;
+    dst = (Uint8 *)surface->pixels +
+          rect->y * surface->pitch +
+          rect->x * surface->format->BytesPerPixel;
+    length = (size_t)rect->w * surface->format->BytesPerPixel;
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        src += pitch;
+        dst += surface->pitch;
+    }
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_UnlockSurface(surface);
+    }
+    return 0;
+}
+
+static int SW_QueueUpdateTexture(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                                 const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    dst = (Uint8 *)SDL_AllocateRenderVertices(renderer, length * rect->h, 16, &cmd->data.update.first);
+    if (!dst) {
+        return -1;
+    }
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+    return 0;
+}
+
+static int SW_LockTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                          const SDL_Rect *rect, void **pixels, int *pitch)
+{
+    SDL_Surface *surface = ((SW_TextureData *)texture->driverdata)->surface;
+
+    *pixels =
+        (void *)((Uint8 *)surface->pixels + rect->y * surface->pitch +
+                 rect->x * surface->format->BytesPerPixel);
+    *pitch = surface->pitch;
+    return 0;
+}
+
+static void SW_UnlockTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+}
+
+static void SW_SetTextureScaleMode(SDL_Renderer *renderer, SDL_Texture *texture, SDL_ScaleMode scaleMode)
+{
+}
+
+static int SW_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+
+    if (texture) {
+        data->surface = ((SW_TextureData *)texture->driverdata)->surface;
+    } else {
+        data->surface = data->window;
+    }
+    return 0;
+}
+
+static int SW_QueueSetViewport(SDL_Renderer *renderer, SDL_RenderCommand *cmd)
+{
+    return 0; /* nothing to do in this backend. */
+}
+
+static int SW_QueueDrawPoints(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
+{
+    SDL_FPoint *verts = (SDL_FPoint *)SDL_AllocateRenderVertices(renderer, count * sizeof(SDL_FPoint), 0, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+    SDL_memcpy(verts, points, count * sizeof(SDL_FPoint));
+    return 0;
+}
+
+/* Pixels whose centers are covered by a rectangle */
+static void SW_PixelRect(const SDL_FRect *frect, SDL_Rect *rect)
+{
+    const int x2 = (int)SDL_ceilf(frect->x + frect->w - 0.5f);
+    const int y2 = (int)SDL_ceilf(frect->y + frect->h - 0.5f);
+
+    rect->x = (int)SDL_ceilf(frect->x - 0.5f);
+    rect->y = (int)SDL_ceilf(frect->y - 0.5f);
+    rect->w = SDL_max(0, x2 - rect->x);
+    rect->h = SDL_max(0, y2 - rect->y);
+}
+
+static int SW_QueueFillRects(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FRect *rects, int count)
+{
+    SDL_Rect *verts = (SDL_Rect *)SDL_AllocateRenderVertices(renderer, count * sizeof(SDL_Rect), 0, &cmd->data.draw.first);
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+    for (i = 0; i < count; ++i) {
+        SW_PixelRect(&rects[i], &verts[i]);
+    }
+    return 0;
+}
+
+static int SW_QueueCopy(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                        const SDL_Rect *srcrect, const SDL_FRect *dstrect)
+{
+    SW_CopyData *verts = (SW_CopyData *)SDL_AllocateRenderVertices(renderer, sizeof(SW_CopyData), 0, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = 1;
+    SDL_copyp(&verts->srcrect, srcrect);
+    SDL_copyp(&verts->dstrect, dstrect);
+    return 0;
+}
+
+static int SW_QueueCopyEx(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                          const SDL_Rect *srcquad, const SDL_FRect *dstrect,
+                          const double angle, const SDL_FPoint *center, const SDL_RendererFlip flip, float scale_x, float scale_y)
+{
+    /* Rotated and flipped copies are drawn as two textured triangles */
+    static const int indices[6] = { 0, 1, 2, 0, 2, 3 };
+    SW_Vertex *verts = (SW_Vertex *)SDL_AllocateRenderVertices(renderer, 6 * sizeof(SW_Vertex), 0, &cmd->data.draw.first);
+    const float radian_angle = (float)((M_PI * angle) / 180.0);
+    const float s = SDL_sinf(radian_angle);
+    const float c = SDL_cosf(radian_angle);
+    const float centerx = center->x + dstrect->x;
+    const float centery = center->y + dstrect->y;
+    float minx, miny, maxx, maxy;
+    float x[4], y[4], u[4], v[4];
+    SDL_Color color;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    if (flip & SDL_FLIP_HORIZONTAL) {
+        minx = dstrect->x + dstrect->w;
+        maxx = dstrect->x;
+    } else {
+        minx = dstrect->x;
+        maxx = dstrect->x + dstrect->w;
+    }
+    if (flip & SDL_FLIP_VERTICAL) {
+        miny = dstrect->y + dstrect->h;
+        maxy = dstrect->y;
+    } else {
+        miny = dstrect->y;
+        maxy = dstrect->y + dstrect->h;
+    }
+
+    x[0] = x[3] = minx;
+    x[1] = x[2] = maxx;
+    y[0] = y[1] = miny;
+    y[2] = y[3] = maxy;
+    u[0] = u[3] = (float)srcquad->x;
+    u[1] = u[2] = (float)(srcquad->x + srcquad->w);
+    v[0] = v[1] = (float)srcquad->y;
+    v[2] = v[3] = (float)(srcquad->y + srcquad->h);
+
+    color.r = cmd->data.draw.r;
+    color.g = cmd->data.draw.g;
+    color.b = cmd->data.draw.b;
+    color.a = cmd->data.draw.a;
+
+    cmd->data.draw.count = 6;
+    for (i = 0; i < 6; ++i) {
+        const int j = indices[i];
+        const float dx = x[j] - centerx;
+        const float dy = y[j] - centery;
+        verts[i].x = ((c * dx - s * dy) + centerx) * scale_x;
+        verts[i].y = ((s * dx + c * dy) + centery) * scale_y;
+        verts[i].color = color;
+        verts[i].u = u[j];
+        verts[i].v = v[j];
+    }
+    return 0;
+}
+
+static int SW_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                            const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride,
+                            int num_vertices, const void *indices, int num_indices, int size_indices,
+                            float scale_x, float scale_y)
+{
+    int i;
+    int count = indices ? num_indices : num_vertices;
+    SW_Vertex *verts = (SW_Vertex *)SDL_AllocateRenderVertices(renderer, count * sizeof(SW_Vertex), 0, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+    size_indices = indices ? size_indices : 0;
+
+    for (i = 0; i < count; i++) {
+        int j;
+        float *xy_;
+        if (size_indices == 4) {
+            j = ((const Uint32 *)indices)[i];
+        } else if (size_indices == 2) {
+            j = ((const Uint16 *)indices)[i];
+        } else if (size_indices == 1) {
+            j = ((const Uint8 *)indices)[i];
+        } else {
+            j = i;
+        }
+
+        xy_ = (float *)((char *)xy + j * xy_stride);
+
+        verts->x = xy_[0] * scale_x;
+        verts->y = xy_[1] * scale_y;
+        verts->color = *(SDL_Color *)((char *)color + j * color_stride);
+
+        if (texture) {
+            float *uv_ = (float *)((char *)uv + j * uv_stride);
+            verts->u = uv_[0] * texture->w;
+            verts->v = uv_[1] * texture->h;
+        } else {
+            verts->u = 0.0f;
+            verts->v = 0.0f;
+        }
+        ++verts;
+    }
+    return 0;
+}
+
+static SW_DrawItem *SW_AddDrawItem(SW_RenderData *data, SDL_RenderCommandType command, const SDL_Rect *clip)
+{
+    SW_DrawItem *item;
+
+    if (data->num_items == data->max_items) {
+        const int max_items = data->max_items ? (data->max_items * 2) : 256;
+        SW_DrawItem *items = (SW_DrawItem *)SDL_realloc(data->items, max_items * sizeof(*items));
+        if (!items) {
+            SDL_OutOfMemory();
+            return NULL;
+        }
+        data->items = items;
+        data->max_items = max_items;
+    }
+
+    item = &data->items[data->num_items++];
+    SDL_zerop(item);
+    item->command = command;
+    item->clip = *clip;
+    return item;
+}
+
+static void SW_SetDrawItemState(SW_DrawItem *item, const SDL_RenderCommand *cmd, int origin_x, int origin_y)
+{
+    item->origin_x = origin_x;
+    item->origin_y = origin_y;
+    item->color.r = cmd->data.draw.r;
+    item->color.g = cmd->data.draw.g;
+    item->color.b = cmd->data.draw.b;
+    item->color.a = cmd->data.draw.a;
+    item->blend = cmd->data.draw.blend;
+    item->texture = cmd->data.draw.texture;
+}
+
+/* Drop the item again if it can't touch any pixels */
+static void SW_FinishDrawItem(SW_RenderData *data, SW_DrawItem *item, const SDL_Rect *bounds)
+{
+    if (!SDL_IntersectRect(bounds, &item->clip, &item->bounds)) {
+        --data->num_items;
+    }
+}
+
+static void SW_PointBounds(const SDL_FPoint *points, int count, int origin_x, int origin_y, SDL_Rect *bounds)
+{
+    float minx = points[0].x, miny = points[0].y;
+    float maxx = points[0].x, maxy = points[0].y;
+    int i;
+
+    for (i = 1; i < count; ++i) {
+        minx = SDL_min(minx, points[i].x);
+        miny = SDL_min(miny, points[i].y);
+        maxx = SDL_max(maxx, points[i].x);
+        maxy = SDL_max(maxy, points[i].y);
+    }
+    bounds->x = origin_x + (int)SDL_floorf(minx);
+    bounds->y = origin_y + (int)SDL_floorf(miny);
+    bounds->w = origin_x + (int)SDL_floorf(maxx) - bounds->x + 1;
+    bounds->h = origin_y + (int)SDL_floorf(maxy) - bounds->y + 1;
+}
+
+static void SW_TriangleBounds(const SW_Vertex *verts, int origin_x, int origin_y, SDL_Rect *bounds)
+{
+    const float minx = SDL_min(verts[0].x, SDL_min(verts[1].x, verts[2].x));
+    const float miny = SDL_min(verts[0].y, SDL_min(verts[1].y, verts[2].y));
+    const float maxx = SDL_max(verts[0].x, SDL_max(verts[1].x, verts[2].x));
+    const float maxy = SDL_max(verts[0].y, SDL_max(verts[1].y, verts[2].y));
+
+    bounds->x = origin_x + (int)SDL_floorf(minx);
+    bounds->y = origin_y + (int)SDL_floorf(miny);
+    bounds->w = origin_x + (int)SDL_ceilf(maxx) - bounds->x + 1;
+    bounds->h = origin_y + (int)SDL_ceilf(maxy) - bounds->y + 1;
+}
+
+static int SW_EnsureTextureViews(SW_RenderData *data, SW_TextureData *texturedata)
+{
+    SDL_Surface *surface = texturedata->surface;
+    int i;
+
+    for (i = 0; i < data->num_threads; ++i) {
+        if (!texturedata->views[i]) {
+            texturedata->views[i] = SDL_CreateRGBSurfaceWithFormatFrom(surface->pixels, surface->w, surface->h, 0,
+                                                                       surface->pitch, surface->format->format);
+            if (!texturedata->views[i]) {
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+/* Resolve the command queue into draw items in absolute target coordinates,
+   up to the next texture update, which is left in *next */
+static int SW_BuildDrawItems(SW_RenderData *data, SDL_Surface *surface, SW_ClipState *state,
+                             SDL_RenderCommand **next, const SDL_RenderVertexBlock *vertices)
+{
+    const SDL_Rect surface_rect = { 0, 0, surface->w, surface->h };
+    SDL_Rect viewport = state->viewport;
+    SDL_Rect cliprect = state->cliprect;
+    SDL_bool cliprect_enabled = state->cliprect_enabled;
+    SDL_RenderCommand *cmd = *next;
+
+    data->num_items = 0;
+    *next = NULL;
+
+    for (; cmd; cmd = cmd->next) {
+        const Uint8 *verts;
+        SDL_Rect clip, bounds;
+        SW_DrawItem *item;
+        int i;
+
+        if (cmd->command == SDL_RENDERCMD_UPDATE_TEXTURE) {
+            /* The items so far have to be drawn before the texture changes */
+            *next = cmd;
+            break;
+        }
+
+        switch (cmd->command) {
+        case SDL_RENDERCMD_SETDRAWCOLOR:
+        {
+            continue; /* this isn't currently used in this render backend. */
+        }
+
+        case SDL_RENDERCMD_SETVIEWPORT:
+        {
+            SDL_copyp(&viewport, &cmd->data.viewport.rect);
+            continue;
+        }
+
+        case SDL_RENDERCMD_SETCLIPRECT:
+        {
+            cliprect_enabled = cmd->data.cliprect.enabled;
+            SDL_copyp(&cliprect, &cmd->data.cliprect.rect);
+            continue;
+        }
+
+        case SDL_RENDERCMD_CLEAR:
+        {
+            /* Clearing ignores the viewport and the clip rectangle */
+            item = SW_AddDrawItem(data, SDL_RENDERCMD_CLEAR, &surface_rect);
+            if (!item) {
+                return -1;
+            }
+            item->color.r = cmd->data.color.r;
+            item->color.g = cmd->data.color.g;
+            item->color.b = cmd->data.color.b;
+            item->color.a = cmd->data.color.a;
+            item->blend = SDL_BLENDMODE_NONE;
+            item->rect = surface_rect;
+            SW_FinishDrawItem(data, item, &surface_rect);
+            continue;
+        }
+
+        case SDL_RENDERCMD_NO_OP:
+            continue;
+
+        default:
+            break;
+        }
+
+        /* Everything else draws inside the viewport and clip rectangle */
+        if (!SDL_IntersectRect(&viewport, &surface_rect, &clip)) {
+            continue;
+        }
+        if (cliprect_enabled) {
+            SDL_Rect rect = cliprect;
+            rect.x += viewport.x;
+            rect.y += viewport.y;
+            if (!SDL_IntersectRect(&rect, &clip, &clip)) {
+                continue;
+            }
+        }
+        if (cmd->data.draw.count == 0) {
+            continue;
+        }
+        verts = (const Uint8 *)SDL_GetRenderVertexData(vertices, cmd->data.draw.first);
+
+        switch (cmd->command) {
+        case SDL_RENDERCMD_DRAW_POINTS:
+        case SDL_RENDERCMD_DRAW_LINES:
+        {
+            const SDL_FPoint *points = (const SDL_FPoint *)verts;
+            const int count = (int)cmd->data.draw.count;
+            item = SW_AddDrawItem(data, cmd->command, &clip);
+            if (!item) {
+                return -1;
+            }
+            SW_SetDrawItemState(item, cmd, viewport.x, viewport.y);
+            item->data = points;
+            item->count = count;
+            SW_PointBounds(points, count, viewport.x, viewport.y, &bounds);
+            SW_FinishDrawItem(data, item, &bounds);
+            break;
+        }
+
+        case SDL_RENDERCMD_FILL_RECTS:
+        {
+            const SDL_Rect *rects = (const SDL_Rect *)verts;
+            const int count = (int)cmd->data.draw.count;
+            for (i = 0; i < count; ++i) {
+                item = SW_AddDrawItem(data, cmd->command, &clip);
+                if (!item) {
+                    return -1;
+                }
+                SW_SetDrawItemState(item, cmd, viewport.x, viewport.y);
+                item->rect = rects[i];
+                item->rect.x += viewport.x;
+                item->rect.y += viewport.y;
+                SW_FinishDrawItem(data, item, &item->rect);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY:
+        {
+            const SW_CopyData *copydata = (const SW_CopyData *)verts;
+            SDL_FRect dstrect = copydata->dstrect;
+            dstrect.x += viewport.x;
+            dstrect.y += viewport.y;
+
+            item = SW_AddDrawItem(data, cmd->command, &clip);
+            if (!item) {
+                return -1;
+            }
+            SW_SetDrawItemState(item, cmd, viewport.x, viewport.y);
+            item->data = copydata;
+            item->count = 1;
+            SW_PixelRect(&dstrect, &item->rect);
+
+            /* Unscaled copies on whole pixels can use the SDL blitters */
+            if (item->rect.w == copydata->srcrect.w && item->rect.h == copydata->srcrect.h &&
+                dstrect.x == (float)item->rect.x && dstrect.y == (float)item->rect.y &&
+                dstrect.w == (float)item->rect.w && dstrect.h == (float)item->rect.h) {
+                if (SW_EnsureTextureViews(data, (SW_TextureData *)item->texture->driverdata) < 0) {
+                    return -1;
+                }
+                item->blit = SDL_TRUE;
+            }
+            SW_FinishDrawItem(data, item, &item->rect);
+            break;
+        }
+
+        case SDL_RENDERCMD_COPY_EX:
+        case SDL_RENDERCMD_GEOMETRY:
+        {
+            const SW_Vertex *triangles = (const SW_Vertex *)verts;
+            const int count = (int)cmd->data.draw.count;
+            for (i = 0; (i + 2) < count; i += 3) {
+                item = SW_AddDrawItem(data, cmd->command, &clip);
+                if (!item) {
+                    return -1;
+                }
+                SW_SetDrawItemState(item, cmd, viewport.x, viewport.y);
+                item->data = &triangles[i];
+                item->count = 3;
+                SW_TriangleBounds(&triangles[i], viewport.x, viewport.y, &bounds);
+                SW_FinishDrawItem(data, item, &bounds);
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    state->viewport = viewport;
+    state->cliprect = cliprect;
+    state->cliprect_enabled = cliprect_enabled;
+    return 0;
+}
+
+/* Sort the draw items into tiles, keeping submission order within a tile */
+static int SW_BinDrawItems(SW_RenderData *data, SDL_Surface *surface)
+{
+    const int tiles_x = (surface->w + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+    const int tiles_y = (surface->h + SW_TILE_SIZE - 1) / SW_TILE_SIZE;
+    const int num_tiles = tiles_x * tiles_y;
+    int *offsets;
+    int total = 0;
+    int i, x, y;
+
+    if (num_tiles + 1 > data->max_tiles) {
+        offsets = (int *)SDL_realloc(data->tile_offsets, (num_tiles + 1) * sizeof(*offsets));
+        if (!offsets) {
+            return SDL_OutOfMemory();
+        }
+        data->tile_offsets = offsets;
+        data->max_tiles = num_tiles + 1;
+    }
+    offsets = data->tile_offsets;
+    SDL_memset(offsets, 0, (num_tiles + 1) * sizeof(*offsets));
+
+    for (i = 0; i < data->num_items; ++i) {
+        const SDL_Rect *bounds = &data->items[i].bounds;
+        const int tx0 = bounds->x / SW_TILE_SIZE;
+        const int ty0 = bounds->y / SW_TILE_SIZE;
+        const int tx1 = (bounds->x + bounds->w - 1) / SW_TILE_SIZE;
+        const int ty1 = (bounds->y + bounds->h - 1) / SW_TILE_SIZE;
+        for (y = ty0; y <= ty1; ++y) {
+            for (x = tx0; x <= tx1; ++x) {
+                ++offsets[y * tiles_x + x + 1];
+            }
+        }
+        total += (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+    }
+
+    if (total > data->max_tile_items) {
+        int *tile_items = (int *)SDL_realloc(data->tile_items, total * sizeof(*tile_items));
+        if (!tile_items) {
+            return SDL_OutOfMemory();
+        }
+        data->tile_items = tile_items;
+        data->max_tile_items = total;
+    }
+
+    for (i = 0; i < num_tiles; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+
+    /* Fill in the lists, using the start offsets as write cursors */
+    for (i = 0; i < data->num_items; ++i) {
+        const SDL_Rect *bounds = &data->items[i].bounds;
+        const int tx0 = bounds->x / SW_TILE_SIZE;
+        const int ty0 = bounds->y / SW_TILE_SIZE;
+        const int tx1 = (bounds->x + bounds->w - 1) / SW_TILE_SIZE;
+        const int ty1 = (bounds->y + bounds->h - 1) / SW_TILE_SIZE;
+        for (y = ty0; y <= ty1; ++y) {
+            for (x = tx0; x <= tx1; ++x) {
+                data->tile_items[offsets[y * tiles_x + x]++] = i;
+            }
+        }
+    }
+
+    /* ... and shift them back so tile i spans [offsets[i], offsets[i + 1]) */
+    for (i = num_tiles; i > 0; --i) {
+        offsets[i] = offsets[i - 1];
+    }
+    offsets[0] = 0;
+
+    data->tiles_x = tiles_x;
+    data->tiles_y = tiles_y;
+    return 0;
+}
+
+static void SW_DrawCopy(SW_Worker *worker, SDL_Surface *dst, const SDL_Rect *clip, const SW_DrawItem *item)
+{
+    const SW_CopyData *copydata = (const SW_CopyData *)item->data;
+    SW_TextureData *texturedata = (SW_TextureData *)item->texture->driverdata;
+
+    if (item->blit) {
+        SDL_Surface *src = texturedata->views[worker->index];
+        SDL_Rect srcrect, dstrect;
+
+        if (!SDL_IntersectRect(&item->rect, clip, &dstrect)) {
+            return;
+        }
+        srcrect.x = copydata->srcrect.x + (dstrect.x - item->rect.x);
+        srcrect.y = copydata->srcrect.y + (dstrect.y - item->rect.y);
+        srcrect.w = dstrect.w;
+        srcrect.h = dstrect.h;
+
+        SDL_SetSurfaceColorMod(src, item->color.r, item->color.g, item->color.b);
+        SDL_SetSurfaceAlphaMod(src, item->color.a);
+        SDL_SetSurfaceBlendMode(src, item->blend);
+        SDL_LowerBlit(src, &srcrect, dst, &dstrect);
+    } else {
+        SDL_FRect dstrect = copydata->dstrect;
+        dstrect.x += item->origin_x;
+        dstrect.y += item->origin_y;
+        SW_RasterStretch(dst, clip, texturedata->surface, &copydata->srcrect, &dstrect,
+                         item->color, item->blend, item->texture->scaleMode);
+    }
+}
+
+static void SW_DrawTile(SW_RenderData *data, SW_Worker *worker, const SDL_Rect *tile, const int *indices, int count)
+{
+    SDL_Surface *dst = worker->target;
+    int i;
+
+    for (i = 0; i < count; ++i) {
+        const SW_DrawItem *item = &data->items[indices ? indices[i] : i];
+        SDL_Rect clip;
+
+        if (!SDL_IntersectRect(&item->clip, tile, &clip)) {
+            continue;
+        }
+
+        switch (item->command) {
+        case SDL_RENDERCMD_CLEAR:
+        case SDL_RENDERCMD_FILL_RECTS:
+            SW_RasterFillRect(dst, &clip, &item->rect, item->color, item->blend);
+            break;
+
+        case SDL_RENDERCMD_DRAW_POINTS:
+            SW_RasterPoints(dst, &clip, (const SDL_FPoint *)item->data, item->count,
+                            item->origin_x, item->origin_y, item->color, item->blend);
+            break;
+
+        case SDL_RENDERCMD_DRAW_LINES:
+            SW_RasterLines(dst, &clip, (const SDL_FPoint *)item->data, item->count,
+                           item->origin_x, item->origin_y, item->color, item->blend);
+            break;
+
+        case SDL_RENDERCMD_COPY:
+            SW_DrawCopy(worker, dst, &clip, item);
+            break;
+
+        case SDL_RENDERCMD_COPY_EX:
+        case SDL_RENDERCMD_GEOMETRY:
+            SW_RasterTriangles(dst, &clip, (const SW_Vertex *)item->data, item->count,
+                               item->origin_x, item->origin_y,
+                               item->texture ? ((SW_TextureData *)item->texture->driverdata)->surface : NULL,
+                               item->blend, item->texture ? item->texture->scaleMode : SDL_ScaleModeNearest);
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+static void SW_DrawTiles(SW_RenderData *data, SW_Worker *worker)
+{
+    const int num_tiles = data->tiles_x * data->tiles_y;
+    SDL_Surface *target = worker->target;
+
+    for (;;) {
+        const int tile = SDL_AtomicAdd(&data->next_tile, 1);
+        int first;
+        SDL_Rect rect;
+
+        if (tile >= num_tiles) {
+            break;
+        }
+        first = data->tile_offsets[tile];
+        rect.x = (tile % data->tiles_x) * SW_TILE_SIZE;
+        rect.y = (tile / data->tiles_x) * SW_TILE_SIZE;
+        rect.w = SDL_min(SW_TILE_SIZE, target->w - rect.x);
+        rect.h = SDL_min(SW_TILE_SIZE, target->h - rect.y);
+        SW_DrawTile(data, worker, &rect, &data->tile_items[first], data->tile_offsets[tile + 1] - first);
+    }
+}
+
+static int SDLCALL SW_WorkerThread(void *arg)
+{
+    SW_Worker *worker = (SW_Worker *)arg;
+    SW_RenderData *data = worker->data;
+
+    for (;;) {
+        SDL_SemWait(data->work_sem);
+        if (SDL_AtomicGet(&data->quit)) {
+            break;
+        }
+        SW_DrawTiles(data, worker);
+        SDL_SemPost(data->done_sem);
+    }
+    return 0;
+}
+
+static void SW_FreeTargetViews(SW_RenderData *data)
+{
+    int i;
+
+    for (i = 0; i < data->num_threads; ++i) {
+        SDL_FreeSurface(data->workers[i].target);
+        data->workers[i].target = NULL;
+    }
+    data->view_surface = NULL;
+}
+
+/* Give every thread its own surface for the target, the blitters cache
+   state in the destination surface too. */
+static int SW_UpdateTargetViews(SW_RenderData *data, SDL_Surface *surface)
+{
+    int i;
+
+    if (data->view_surface == surface && data->view_pixels == surface->pixels &&
+        data->view_w == surface->w && data->view_h == surface->h &&
+        data->view_pitch == surface->pitch && data->view_format == surface->format->format) {
+        return 0;
+    }
+
+    SW_FreeTargetViews(data);
+    for (i = 0; i < data->num_threads; ++i) {
+        SDL_Surface *view = SDL_CreateRGBSurfaceWithFormatFrom(surface->pixels, surface->w, surface->h, 0,
+                                                               surface->pitch, surface->format->format);
+        if (!view) {
+            SW_FreeTargetViews(data);
+            return -1;
+        }
+        if (surface->format->palette) {
+            SDL_SetSurfacePalette(view, surface->format->palette);
+        }
+        data->workers[i].target = view;
+    }
+    data->view_surface = surface;
+    data->view_pixels = surface->pixels;
+    data->view_w = surface->w;
+    data->view_h = surface->h;
+    data->view_pitch = surface->pitch;
+    data->view_format = surface->format->format;
+    return 0;
+}
+
+static int SW_DrawItems(SW_RenderData *data, SDL_Surface *surface)
+{
+    Sint64 pixels = 0;
+    int i;
+
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_LockSurface(surface);
+    }
+    if (SW_UpdateTargetViews(data, surface) < 0) {
+        if (SDL_MUSTLOCK(surface)) {
+            SDL_UnlockSurface(surface);
+        }
+        return -1;
+    }
+
+    for (i = 0; i < data->num_items; ++i) {
+        pixels += (Sint64)data->items[i].bounds.w * data->items[i].bounds.h;
+    }
+
+    if (data->num_threads > 1 && pixels >= SW_MIN_PARALLEL_PIXELS && SW_BinDrawItems(data, surface) == 0) {
+        SDL_AtomicSet(&data->next_tile, 0);
+        for (i = 1; i < data->num_threads; ++i) {
+            SDL_SemPost(data->work_sem);
+        }
+        SW_DrawTiles(data, &data->workers[0]);
+        for (i = 1; i < data->num_threads; ++i) {
+            SDL_SemWait(data->done_sem);
+        }
+    } else {
+        const SDL_Rect rect = { 0, 0, surface->w, surface->h };
+        SW_DrawTile(data, &data->workers[0], &rect, NULL, data->num_items);
+    }
+
+    if (SDL_MUSTLOCK(surface)) {
+        SDL_UnlockSurface(surface);
+    }
+    return 0;
+}
+
+static int SW_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+    SDL_Surface *surface = SW_ActivateRenderer(renderer);
+    SW_ClipState state;
+
+    if (!surface) {
+        return -1;
+    }
+
+    state.viewport.x = state.viewport.y = 0;
+    state.viewport.w = surface->w;
+    state.viewport.h = surface->h;
+    state.cliprect = state.viewport;
+    state.cliprect_enabled = SDL_FALSE;
+
+    /* Queued texture updates split the queue into runs of draws */
+    while (cmd) {
+        if (SW_BuildDrawItems(data, surface, &state, &cmd, vertices) < 0) {
+            return -1;
+        }
+        if (data->num_items > 0 && SW_DrawItems(data, surface) < 0) {
+            return -1;
+        }
+        if (cmd) {
+            const SDL_Rect *rect = &cmd->data.update.rect;
+            const int pitch = rect->w * SDL_BYTESPERPIXEL(cmd->data.update.texture->format);
+            SW_UpdateTexture(renderer, cmd->data.update.texture, rect,
+                             SDL_GetRenderVertexData(vertices, cmd->data.update.first), pitch);
+            cmd = cmd->next;
+        }
+    }
+    return 0;
+}
+
+static int SW_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
+                               Uint32 format, void *pixels, int pitch)
+{
+    SDL_Surface *surface = SW_ActivateRenderer(renderer);
+    Uint32 src_format;
+    void *src_pixels;
+
+    if (!surface) {
+        return -1;
+    }
+
+    /* NOTE: The rect is already adjusted according to the viewport by
+     * SDL_RenderReadPixels.
+     */
+
+    if (rect->x < 0 || rect->x + rect->w > surface->w ||
+        rect->y < 0 || rect->y + rect->h > surface->h) {
+        return SDL_SetError("Tried to read outside of surface bounds");
+    }
+
+    src_format = surface->format->format;
+    src_pixels = (void *)((Uint8 *)surface->pixels +
+                          rect->y * surface->pitch +
+                          rect->x * surface->format->BytesPerPixel);
+
+    return SDL_ConvertPixels(rect->w, rect->h,
+                             src_format, src_pixels, surface->pitch,
+                             format, pixels, pitch);
+}
+
+static int SW_RenderPresent(SDL_Renderer *renderer)
+{
+    SDL_Window *window = renderer->window;
+
+    if (!window) {
+        return SDL_SetError("Software renderer has no window to present to");
+    }
+    if (renderer->num_present_damage_rects > 0) {
+        return SDL_UpdateWindowSurfaceRects(window, renderer->present_damage_rects, renderer->num_present_damage_rects);
+    }
+    return SDL_UpdateWindowSurface(window);
+}
+
+static int SW_GetBufferAge(SDL_Renderer *renderer)
+{
+    /* The window surface keeps its contents between presents */
+    return renderer->window ? 1 : 0;
+}
+
+static void SW_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    SW_TextureData *texturedata = (SW_TextureData *)texture->driverdata;
+    int i;
+
+    if (!texturedata) {
+        return;
+    }
+    for (i = 0; i < SW_MAX_THREADS; ++i) {
+        SDL_FreeSurface(texturedata->views[i]);
+    }
+    SDL_FreeSurface(texturedata->surface);
+    SDL_free(texturedata);
+    texture->driverdata = NULL;
+}
+
+static void SW_DestroyRenderer(SDL_Renderer *renderer)
+{
+    SW_RenderData *data = (SW_RenderData *)renderer->driverdata;
+    int i;
+
+    if (data) {
+        SDL_AtomicSet(&data->quit, 1);
+        for (i = 1; i < data->num_threads; ++i) {
+            if (data->workers[i].thread) {
+                SDL_SemPost(data->work_sem);
+            }
+        }
+        for (i = 1; i < data->num_threads; ++i) {
+            if (data->workers[i].thread) {
+                SDL_WaitThread(data->workers[i].thread, NULL);
+            }
+        }
+        SW_FreeTargetViews(data);
+        if (data->work_sem) {
+            SDL_DestroySemaphore(data->work_sem);
+        }
+        if (data->done_sem) {
+            SDL_DestroySemaphore(data->done_sem);
+        }
+        SDL_free(data->items);
+        SDL_free(data->tile_offsets);
+        SDL_free(data->tile_items);
+        SDL_free(data);
+    }
+    SDL_free(renderer);
+}
+
+static int SW_GetThreadCount(void)
+{
+    const char *hint = SDL_GetHint(SDL_HINT_RENDER_SOFTWARE_THREADS);
+    int count = 0;
+
+    if (hint) {
+        count = SDL_atoi(hint);
+    }
+    if (count <= 0) {
+        count = SDL_GetCPUCount();
+    }
+    return SDL_clamp(count, 1, SW_MAX_THREADS);
+}
+
+static int SW_StartWorkers(SW_RenderData *data)
+{
+    int i;
+
+    data->num_threads = SW_GetThreadCount();
+    for (i = 0; i < data->num_threads; ++i) {
+        data->workers[i].data = data;
+        data->workers[i].index = i;
+    }
+    if (data->num_threads == 1) {
+        return 0;
+    }
+
+    data->work_sem = SDL_CreateSemaphore(0);
+    data->done_sem = SDL_CreateSemaphore(0);
+    if (!data->work_sem || !data->done_sem) {
+        return -1;
+    }
+
+    /* The calling thread renders too, it's worker 0 */
+    for (i = 1; i < data->num_threads; ++i) {
+        data->workers[i].thread = SDL_CreateThreadInternal(SW_WorkerThread, "SDLSoftwareRender", 0, &data->workers[i]);
+        if (!data->workers[i].thread) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+SDL_Renderer *SW_CreateRendererForSurface(SDL_Surface *surface)
+{
+    SDL_Renderer *renderer;
+    SW_RenderData *data;
+
+    if (!surface) {
+        SDL_InvalidParamError("surface");
+        return NULL;
+    }
+
+    renderer = (SDL_Renderer *)SDL_calloc(1, sizeof(*renderer));
+    if (!renderer) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+
+    data = (SW_RenderData *)SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        SW_DestroyRenderer(renderer);
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    data->surface = surface;
+    data->window = surface;
+    renderer->driverdata = data;
+
+    if (SW_StartWorkers(data) < 0) {
+        SW_DestroyRenderer(renderer);
+        return NULL;
+    }
+
+    renderer->WindowEvent = SW_WindowEvent;
+    renderer->GetOutputSize = SW_GetOutputSize;
+    renderer->SupportsBlendMode = SW_SupportsBlendMode;
+    renderer->CreateTexture = SW_CreateTexture;
+    renderer->UpdateTexture = SW_UpdateTexture;
+    renderer->LockTexture = SW_LockTexture;
+    renderer->UnlockTexture = SW_UnlockTexture;
+    renderer->SetTextureScaleMode = SW_SetTextureScaleMode;
+    renderer->SetRenderTarget = SW_SetRenderTarget;
+    renderer->QueueSetViewport = SW_QueueSetViewport;
+    renderer->QueueSetDrawColor = SW_QueueSetViewport; /* SetViewport and SetDrawColor are (currently) no-ops. */
+    renderer->QueueDrawPoints = SW_QueueDrawPoints;
+    renderer->QueueDrawLines = SW_QueueDrawPoints; /* lines and points queue vertices the same way. */
+    renderer->QueueFillRects = SW_QueueFillRects;
+    renderer->QueueCopy = SW_QueueCopy;
+    renderer->QueueCopyEx = SW_QueueCopyEx;
+    renderer->QueueGeometry = SW_QueueGeometry;
+    renderer->QueueUpdateTexture = SW_QueueUpdateTexture;
+    renderer->RunCommandQueue = SW_RunCommandQueue;
+    renderer->RenderReadPixels = SW_RenderReadPixels;
+    renderer->RenderPresent = SW_RenderPresent;
+    renderer->GetBufferAge = SW_GetBufferAge;
+    renderer->DestroyTexture = SW_DestroyTexture;
+    renderer->DestroyRenderer = SW_DestroyRenderer;
+    renderer->info = SW_RenderDriver.info;
+
+    SW_ActivateRenderer(renderer);
+
+    return renderer;
+}
+
+static SDL_Renderer *SW_CreateRenderer(SDL_Window *window, Uint32 flags)
+{
+    SDL_Surface *surface;
+
+    surface = SDL_GetWindowSurface(window);
+    if (!surface) {
+        return NULL;
+    }
+
+    return SW_CreateRendererForSurface(surface);
+}
+
+SDL_RenderDriver SW_RenderDriver = {
+    SW_CreateRenderer,
+    { "software",
+      SDL_RENDERER_SOFTWARE | SDL_RENDERER_TARGETTEXTURE,
+      8,
+      { SDL_PIXELFORMAT_ARGB8888,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_PIXELFORMAT_RGBA8888,
+        SDL_PIXELFORMAT_BGRA8888,
+        SDL_PIXELFORMAT_RGB888,
+        SDL_PIXELFORMAT_BGR888,
+        SDL_PIXELFORMAT_RGBX8888,
+        SDL_PIXELFORMAT_BGRX8888 },
+      0,
+      0 }
+};
+
+#endif /* SDL_VIDEO_RENDER_SW && !SDL_RENDER_DISABLED */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,551 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_SW && !defined(SDL_RENDER_DISABLED)
+
+#include "SDL_swraster_c.h"
+
+/* How to read and write pixels of a surface. Formats with 8-bit channels
+   packed in 32-bit pixels, which covers every texture format the software
+   renderer exposes, take a shift based path; everything else goes through
+   SDL_GetRGBA()/SDL_MapRGBA(). */
+typedef struct SW_PixelAccess
+{
+    SDL_PixelFormat *format;
+    int bpp;
+    SDL_bool fast;
+    Uint32 Amask;
+    Uint8 Rshift, Gshift, Bshift, Ashift;
+} SW_PixelAccess;
+
+static void SW_InitPixelAccess(SW_PixelAccess *pa, SDL_PixelFormat *format)
+{
+    pa->format = format;
+    pa->bpp = format->BytesPerPixel;
+    pa->fast = (format->BytesPerPixel == 4 &&
+                format->Rloss == 0 && format->Gloss == 0 && format->Bloss == 0 &&
+                (format->Amask == 0 || format->Aloss == 0))
+                   ? SDL_TRUE
+                   : SDL_FALSE;
+    pa->Amask = format->Amask;
+    pa->Rshift = format->Rshift;
+    pa->Gshift = format->Gshift;
+    pa->Bshift = format->Bshift;
+    pa->Ashift = format->Ashift;
+}
+
+static SDL_INLINE void SW_GetPixel(const SW_PixelAccess *pa, const Uint8 *p, SDL_Color *c)
+{
+    if (pa->fast) {
+        const Uint32 pixel = *(const Uint32 *)p;
+        c->r = (Uint8)(pixel >> pa->Rshift);
+        c->g = (Uint8)(pixel >> pa->Gshift);
+        c->b = (Uint8)(pixel >> pa->Bshift);
+        c->a = pa->Amask ? (Uint8)(pixel >> pa->Ashift) : 0xFF;
+    } else {
+        Uint32 pixel;
+        switch (pa->bpp) {
+        case 1:
+            pixel = *p;
+            break;
+        case 2:
+            pixel = *(const Uint16 *)p;
+            break;
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            pixel = p[0] | (p[1] << 8) | (p[2] << 16);
+#else
+            pixel = (p[0] << 16) | (p[1] << 8) | p[2];
+#endif
+            break;
+        default:
+            pixel = *(const Uint32 *)p;
+            break;
+        }
+        SDL_GetRGBA(pixel, pa->format, &c->r, &c->g, &c->b, &c->a);
+    }
+}
+
+static SDL_INLINE void SW_PutPixel(const SW_PixelAccess *pa, Uint8 *p, const SDL_Color *c)
+{
+    if (pa->fast) {
+        *(Uint32 *)p = ((Uint32)c->r << pa->Rshift) |
+                       ((Uint32)c->g << pa->Gshift) |
+                       ((Uint32)c->b << pa->Bshift) |
+                       (((Uint32)c->a << pa->Ashift) & pa->Amask);
+    } else {
+        const Uint32 pixel = SDL_MapRGBA(pa->format, c->r, c->g, c->b, c->a);
+        switch (pa->bpp) {
+        case 1:
+            *p = (Uint8)pixel;
+            break;
+        case 2:
+            *(Uint16 *)p = (Uint16)pixel;
+            break;
+        case 3:
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+            p[0] = (Uint8)pixel;
+            p[1] = (Uint8)(pixel >> 8);
+            p[2] = (Uint8)(pixel >> 16);
+#else
+            p[0] = (Uint8)(pixel >> 16);
+            p[1] = (Uint8)(pixel >> 8);
+            p[2] = (Uint8)pixel;
+#endif
+            break;
+        default:
+            *(Uint32 *)p = pixel;
+            break;
+        }
+    }
+}
+
+/* a * b / 255, correctly rounded */
+static SDL_INLINE Uint32 SW_Mul8(Uint32 a, Uint32 b)
+{
+    const Uint32 t = a * b + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+static SDL_INLINE void SW_Modulate(SDL_Color *c, const SDL_Color *mod)
+{
+    c->r = (Uint8)SW_Mul8(c->r, mod->r);
+    c->g = (Uint8)SW_Mul8(c->g, mod->g);
+    c->b = (Uint8)SW_Mul8(c->b, mod->b);
+    c->a = (Uint8)SW_Mul8(c->a, mod->a);
+}
+
+/* The standard blend modes, as documented for SDL_BlendMode */
+static SDL_INLINE void SW_BlendColor(SDL_BlendMode blendMode, const SDL_Color *src, SDL_Color *dst)
+{
+    Uint32 inv;
+
+    switch (blendMode) {
+    case SDL_BLENDMODE_BLEND:
+        inv = 255 - src->a;
+        dst->r = (Uint8)(SW_Mul8(src->r, src->a) + SW_Mul8(dst->r, inv));
+        dst->g = (Uint8)(SW_Mul8(src->g, src->a) + SW_Mul8(dst->g, inv));
+        dst->b = (Uint8)(SW_Mul8(src->b, src->a) + SW_Mul8(dst->b, inv));
+        dst->a = (Uint8)(src->a + SW_Mul8(dst->a, inv));
+        break;
+    case SDL_BLENDMODE_ADD:
+        dst->r = (Uint8)SDL_min(255, SW_Mul8(src->r, src->a) + dst->r);
+        dst->g = (Uint8)SDL_min(255, SW_Mul8(src->g, src->a) + dst->g);
+        dst->b = (Uint8)SDL_min(255, SW_Mul8(src->b, src->a) + dst->b);
+        break;
+    case SDL_BLENDMODE_MOD:
+        dst->r = (Uint8)SW_Mul8(src->r, dst->r);
+        dst->g = (Uint8)SW_Mul8(src->g, dst->g);
+        dst->b = (Uint8)SW_Mul8(src->b, dst->b);
+        break;
+    case SDL_BLENDMODE_MUL:
+        inv = 255 - src->a;
+        dst->r = (Uint8)SDL_min(255, SW_Mul8(src->r, dst->r) + SW_Mul8(dst->r, inv));
+        dst->g = (Uint8)SDL_min(255, SW_Mul8(src->g, dst->g) + SW_Mul8(dst->g, inv));
+        dst->b = (Uint8)SDL_min(255, SW_Mul8(src->b, dst->b) + SW_Mul8(dst->b, inv));
+        break;
+    default:
+        *dst = *src;
+        break;
+    }
+}
+
+static SDL_INLINE void SW_BlendPixel(const SW_PixelAccess *pa, Uint8 *p, const SDL_Color *src, SDL_BlendMode blendMode)
+{
+    if (blendMode == SDL_BLENDMODE_NONE) {
+        SW_PutPixel(pa, p, src);
+    } else {
+        SDL_Color dst;
+        SW_GetPixel(pa, p, &dst);
+        SW_BlendColor(blendMode, src, &dst);
+        SW_PutPixel(pa, p, &dst);
+    }
+}
+
+static SDL_INLINE int SW_Floor(float f)
+{
+    const int i = (int)f;
+    return (f < (float)i) ? (i - 1) : i;
+}
+
+static SDL_INLINE int SW_Clamp(int v, int lo, int hi)
+{
+    return (v < lo) ? lo : ((v > hi) ? hi : v);
+}
+
+/* Sample a texel at continuous texel coordinates, clamped to 'bounds' */
+static SDL_INLINE void SW_Sample(const SW_PixelAccess *pa, const SDL_Surface *src, const SDL_Rect *bounds,
+                                 float u, float v, SDL_ScaleMode scaleMode, SDL_Color *c)
+{
+    const Uint8 *pixels = (const Uint8 *)src->pixels;
+    const int maxx = bounds->x + bounds->w - 1;
+    const int maxy = bounds->y + bounds->h - 1;
+
+    if (scaleMode == SDL_ScaleModeNearest) {
+        const int x = SW_Clamp(SW_Floor(u), bounds->x, maxx);
+        const int y = SW_Clamp(SW_Floor(v), bounds->y, maxy);
+        SW_GetPixel(pa, pixels + y * src->pitch + x * pa->bpp, c);
+    } else {
+        SDL_Color c00, c10, c01, c11;
+        const int fx0 = SW_Floor(u - 0.5f);
+        const int fy0 = SW_Floor(v - 0.5f);
+        const Uint32 wx = (Uint32)((u - 0.5f - fx0) * 256.0f);
+        const Uint32 wy = (Uint32)((v - 0.5f - fy0) * 256.0f);
+        const int x0 = SW_Clamp(fx0, bounds->x, maxx);
+        const int x1 = SW_Clamp(fx0 + 1, bounds->x, maxx);
+        const Uint8 *row0 = pixels + SW_Clamp(fy0, bounds->y, maxy) * src->pitch;
+        const Uint8 *row1 = pixels + SW_Clamp(fy0 + 1, bounds->y, maxy) * src->pitch;
+
+        SW_GetPixel(pa, row0 + x0 * pa->bpp, &c00);
+        SW_GetPixel(pa, row0 + x1 * pa->bpp, &c10);
+        SW_GetPixel(pa, row1 + x0 * pa->bpp, &c01);
+        SW_GetPixel(pa, row1 + x1 * pa->bpp, &c11);
+
+#define SW_BILERP(ch)                                                                  \
+    c->ch = (Uint8)(((c00.ch * (256 - wx) + c10.ch * wx) * (256 - wy) +              \
+                     (c01.ch * (256 - wx) + c11.ch * wx) * wy + 32768) >> 16)
+        SW_BILERP(r);
+        SW_BILERP(g);
+        SW_BILERP(b);
+        SW_BILERP(a);
+#undef SW_BILERP
+    }
+}
+
+SDL_bool SW_RasterSupportsBlendMode(SDL_BlendMode blendMode)
+{
+    switch (blendMode) {
+    case SDL_BLENDMODE_NONE:
+    case SDL_BLENDMODE_BLEND:
+    case SDL_BLENDMODE_ADD:
+    case SDL_BLENDMODE_MOD:
+    case SDL_BLENDMODE_MUL:
+        return SDL_TRUE;
+    default:
+        return SDL_FALSE;
+    }
+}
+
+void SW_RasterFillRect(SDL_Surface *dst, const SDL_Rect *clip, const SDL_Rect *rect,
+                       SDL_Color color, SDL_BlendMode blendMode)
+{
+    SW_PixelAccess pa;
+    SDL_Rect r;
+    int x, y;
+
+    if (!SDL_IntersectRect(rect, clip, &r)) {
+        return;
+    }
+
+    if (blendMode == SDL_BLENDMODE_NONE ||
+        (blendMode == SDL_BLENDMODE_BLEND && color.a == 0xFF)) {
+        /* Straight fill, this goes through the SIMD fill routines */
+        SDL_FillRect(dst, &r, SDL_MapRGBA(dst->format, color.r, color.g, color.b, color.a));
+        return;
+    }
+
+    SW_InitPixelAccess(&pa, dst->format);
+    for (y = r.y; y < (r.y + r.h); ++y) {
+        Uint8 *p = (Uint8 *)dst->pixels + y * dst->pitch + r.x * pa.bpp;
+        for (x = 0; x < r.w; ++x, p += pa.bpp) {
+            SW_BlendPixel(&pa, p, &color, blendMode);
+        }
+    }
+}
+
+void SW_RasterPoints(SDL_Surface *dst, const SDL_Rect *clip, const SDL_FPoint *points, int count,
+                     int origin_x, int origin_y, SDL_Color color, SDL_BlendMode blendMode)
+{
+    SW_PixelAccess pa;
+    int i;
+
+    SW_InitPixelAccess(&pa, dst->format);
+    for (i = 0; i < count; ++i) {
+        const int x = origin_x + SW_Floor(points[i].x);
+        const int y = origin_y + SW_Floor(points[i].y);
+        if (x >= clip->x && y >= clip->y && x < (clip->x + clip->w) && y < (clip->y + clip->h)) {
+            SW_BlendPixel(&pa, (Uint8 *)dst->pixels + y * dst->pitch + x * pa.bpp, &color, blendMode);
+        }
+    }
+}
+
+static void SW_RasterLine(const SW_PixelAccess *pa, SDL_Surface *dst, const SDL_Rect *clip,
+                          int x0, int y0, int x1, int y1, SDL_bool draw_end,
+                          const SDL_Color *color, SDL_BlendMode blendMode)
+{
+    const int dx = SDL_abs(x1 - x0);
+    const int dy = -SDL_abs(y1 - y0);
+    const int sx = (x0 < x1) ? 1 : -1;
+    const int sy = (y0 < y1) ? 1 : -1;
+    const int clip_x2 = clip->x + clip->w;
+    const int clip_y2 = clip->y + clip->h;
+    int err = dx + dy;
+
+    /* Trivially reject lines that can't touch the clip rectangle */
+    if (SDL_max(x0, x1) < clip->x || SDL_min(x0, x1) >= clip_x2 ||
+        SDL_max(y0, y1) < clip->y || SDL_min(y0, y1) >= clip_y2) {
+        return;
+    }
+
+    for (;;) {
+        const SDL_bool last = (x0 == x1 && y0 == y1) ? SDL_TRUE : SDL_FALSE;
+        int e2;
+
+        if (last && !draw_end) {
+            break;
+        }
+        if (x0 >= clip->x && y0 >= clip->y && x0 < clip_x2 && y0 < clip_y2) {
+            SW_BlendPixel(pa, (Uint8 *)dst->pixels + y0 * dst->pitch + x0 * pa->bpp, color, blendMode);
+        }
+        if (last) {
+            break;
+        }
+        e2 = 2 * err;
+        if (e2 >= dy) {
+            err += dy;
+            x0 += sx;
+        }
+        if (e2 <= dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void SW_RasterLines(SDL_Surface *dst, const SDL_Rect *clip, const SDL_FPoint *points, int count,
+                    int origin_x, int origin_y, SDL_Color color, SDL_BlendMode blendMode)
+{
+    SW_PixelAccess pa;
+    SDL_bool closed;
+    int i;
+
+    if (count < 2) {
+        return;
+    }
+
+    /* Shared endpoints are only drawn once, so blended lines don't double up */
+    closed = (points[0].x == points[count - 1].x && points[0].y == points[count - 1].y) ? SDL_TRUE : SDL_FALSE;
+
+    SW_InitPixelAccess(&pa, dst->format);
+    for (i = 0; i < (count - 1); ++i) {
+        const SDL_bool draw_end = (i == (count - 2) && !closed) ? SDL_TRUE : SDL_FALSE;
+        SW_RasterLine(&pa, dst, clip,
+                      origin_x + SW_Floor(points[i].x), origin_y + SW_Floor(points[i].y),
+                      origin_x + SW_Floor(points[i + 1].x), origin_y + SW_Floor(points[i + 1].y),
+                      draw_end, &color, blendMode);
+    }
+}
+
+void SW_RasterStretch(SDL_Surface *dst, const SDL_Rect *clip, SDL_Surface *src, const SDL_Rect *srcrect,
+                      const SDL_FRect *dstrect, SDL_Color color, SDL_BlendMode blendMode, SDL_ScaleMode scaleMode)
+{
+    SW_PixelAccess pa, spa;
+    const SDL_bool modulate = (color.r != 0xFF || color.g != 0xFF || color.b != 0xFF || color.a != 0xFF) ? SDL_TRUE : SDL_FALSE;
+    const float scale_x = (float)srcrect->w / dstrect->w;
+    const float scale_y = (float)srcrect->h / dstrect->h;
+    int x0, y0, x1, y1, x, y;
+
+    if (dstrect->w <= 0.0f || dstrect->h <= 0.0f) {
+        return;
+    }
+
+    /* Pixels whose centers fall inside the destination rectangle */
+    x0 = SDL_max(clip->x, (int)SDL_ceilf(dstrect->x - 0.5f));
+    y0 = SDL_max(clip->y, (int)SDL_ceilf(dstrect->y - 0.5f));
+    x1 = SDL_min(clip->x + clip->w, (int)SDL_ceilf(dstrect->x + dstrect->w - 0.5f));
+    y1 = SDL_min(clip->y + clip->h, (int)SDL_ceilf(dstrect->y + dstrect->h - 0.5f));
+    if (x0 >= x1 || y0 >= y1) {
+        return;
+    }
+
+    SW_InitPixelAccess(&pa, dst->format);
+    SW_InitPixelAccess(&spa, src->format);
+
+    for (y = y0; y < y1; ++y) {
+        const float v = srcrect->y + ((float)y + 0.5f - dstrect->y) * scale_y;
+        Uint8 *p = (Uint8 *)dst->pixels + y * dst->pitch + x0 * pa.bpp;
+        for (x = x0; x < x1; ++x, p += pa.bpp) {
+            const float u = srcrect->x + ((float)x + 0.5f - dstrect->x) * scale_x;
+            SDL_Color c;
+            SW_Sample(&spa, src, srcrect, u, v, scaleMode, &c);
+            if (modulate) {
+                SW_Modulate(&c, &color);
+            }
+            SW_BlendPixel(&pa, p, &c, blendMode);
+        }
+    }
+}
+
+/* Triangles are set up in 24.8 fixed point and walked with exact integer
+   edge functions, with a top-left fill rule, so triangles sharing an edge
+   never overlap or leave gaps, no matter how the target is split up. */
+#define SW_SUBPIXEL_BITS 8
+#define SW_SUBPIXEL_ONE  (1 << SW_SUBPIXEL_BITS)
+#define SW_SUBPIXEL_HALF (SW_SUBPIXEL_ONE / 2)
+
+static SDL_INLINE Sint64 SW_Edge(Sint64 ax, Sint64 ay, Sint64 bx, Sint64 by, Sint64 px, Sint64 py)
+{
+    return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+static SDL_INLINE Sint64 SW_EdgeBias(Sint64 ax, Sint64 ay, Sint64 bx, Sint64 by)
+{
+    const SDL_bool top = (ay == by && bx > ax) ? SDL_TRUE : SDL_FALSE;
+    const SDL_bool left = (by < ay) ? SDL_TRUE : SDL_FALSE;
+    return (top || left) ? 0 : -1;
+}
+
+static SDL_INLINE SDL_bool SW_SameColor(const SDL_Color *a, const SDL_Color *b)
+{
+    return (a->r == b->r && a->g == b->g && a->b == b->b && a->a == b->a) ? SDL_TRUE : SDL_FALSE;
+}
+
+static void SW_RasterTriangle(const SW_PixelAccess *pa, SDL_Surface *dst, const SDL_Rect *clip,
+                              const SW_Vertex *v0, const SW_Vertex *v1, const SW_Vertex *v2,
+                              int origin_x, int origin_y,
+                              const SW_PixelAccess *tpa, SDL_Surface *texture, const SDL_Rect *texbounds,
+                              SDL_BlendMode blendMode, SDL_ScaleMode scaleMode)
+{
+    Sint64 x0 = (Sint64)SDL_floorf((v0->x + origin_x) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 y0 = (Sint64)SDL_floorf((v0->y + origin_y) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 x1 = (Sint64)SDL_floorf((v1->x + origin_x) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 y1 = (Sint64)SDL_floorf((v1->y + origin_y) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 x2 = (Sint64)SDL_floorf((v2->x + origin_x) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 y2 = (Sint64)SDL_floorf((v2->y + origin_y) * SW_SUBPIXEL_ONE + 0.5f);
+    Sint64 area = SW_Edge(x0, y0, x1, y1, x2, y2);
+    Sint64 bias0, bias1, bias2;
+    Sint64 step0, step1, step2;
+    SDL_bool flat_color;
+    float inv_area;
+    int minx, miny, maxx, maxy, x, y;
+
+    if (area == 0) {
+        return;
+    }
+    if (area < 0) {
+        /* Make the winding consistent */
+        const SW_Vertex *tv = v1;
+        Sint64 t;
+        v1 = v2;
+        v2 = tv;
+        t = x1;
+        x1 = x2;
+        x2 = t;
+        t = y1;
+        y1 = y2;
+        y2 = t;
+        area = -area;
+    }
+
+    minx = (int)(SDL_min(x0, SDL_min(x1, x2)) >> SW_SUBPIXEL_BITS);
+    miny = (int)(SDL_min(y0, SDL_min(y1, y2)) >> SW_SUBPIXEL_BITS);
+    maxx = (int)((SDL_max(x0, SDL_max(x1, x2)) + SW_SUBPIXEL_ONE - 1) >> SW_SUBPIXEL_BITS);
+    maxy = (int)((SDL_max(y0, SDL_max(y1, y2)) + SW_SUBPIXEL_ONE - 1) >> SW_SUBPIXEL_BITS);
+    minx = SDL_max(minx, clip->x);
+    miny = SDL_max(miny, clip->y);
+    maxx = SDL_min(maxx, clip->x + clip->w - 1);
+    maxy = SDL_min(maxy, clip->y + clip->h - 1);
+    if (minx > maxx || miny > maxy) {
+        return;
+    }
+
+    /* Edge i is the one opposite vertex i, so it is also that vertex's weight */
+    bias0 = SW_EdgeBias(x1, y1, x2, y2);
+    bias1 = SW_EdgeBias(x2, y2, x0, y0);
+    bias2 = SW_EdgeBias(x0, y0, x1, y1);
+    step0 = -(y2 - y1) * SW_SUBPIXEL_ONE;
+    step1 = -(y0 - y2) * SW_SUBPIXEL_ONE;
+    step2 = -(y1 - y0) * SW_SUBPIXEL_ONE;
+
+    flat_color = (SW_SameColor(&v0->color, &v1->color) && SW_SameColor(&v0->color, &v2->color)) ? SDL_TRUE : SDL_FALSE;
+    inv_area = 1.0f / (float)area;
+
+    for (y = miny; y <= maxy; ++y) {
+        const Sint64 py = ((Sint64)y << SW_SUBPIXEL_BITS) + SW_SUBPIXEL_HALF;
+        const Sint64 px = ((Sint64)minx << SW_SUBPIXEL_BITS) + SW_SUBPIXEL_HALF;
+        Sint64 w0 = SW_Edge(x1, y1, x2, y2, px, py);
+        Sint64 w1 = SW_Edge(x2, y2, x0, y0, px, py);
+        Sint64 w2 = SW_Edge(x0, y0, x1, y1, px, py);
+        Uint8 *p = (Uint8 *)dst->pixels + y * dst->pitch + minx * pa->bpp;
+
+        for (x = minx; x <= maxx; ++x, p += pa->bpp, w0 += step0, w1 += step1, w2 += step2) {
+            SDL_Color c;
+            float b0, b1, b2;
+
+            if ((w0 + bias0) < 0 || (w1 + bias1) < 0 || (w2 + bias2) < 0) {
+                continue;
+            }
+
+            b0 = (float)w0 * inv_area;
+            b1 = (float)w1 * inv_area;
+            b2 = 1.0f - b0 - b1;
+
+            if (flat_color) {
+                c = v0->color;
+            } else {
+                c.r = (Uint8)(b0 * v0->color.r + b1 * v1->color.r + b2 * v2->color.r + 0.5f);
+                c.g = (Uint8)(b0 * v0->color.g + b1 * v1->color.g + b2 * v2->color.g + 0.5f);
+                c.b = (Uint8)(b0 * v0->color.b + b1 * v1->color.b + b2 * v2->color.b + 0.5f);
+                c.a = (Uint8)(b0 * v0->color.a + b1 * v1->color.a + b2 * v2->color.a + 0.5f);
+            }
+
+            if (texture) {
+                SDL_Color t;
+                const float u = b0 * v0->u + b1 * v1->u + b2 * v2->u;
+                const float v = b0 * v0->v + b1 * v1->v + b2 * v2->v;
+                SW_Sample(tpa, texture, texbounds, u, v, scaleMode, &t);
+                SW_Modulate(&t, &c);
+                c = t;
+            }
+
+            SW_BlendPixel(pa, p, &c, blendMode);
+        }
+    }
+}
+
+void SW_RasterTriangles(SDL_Surface *dst, const SDL_Rect *clip, const SW_Vertex *vertices, int count,
+                        int origin_x, int origin_y, SDL_Surface *texture,
+                        SDL_BlendMode blendMode, SDL_ScaleMode scaleMode)
+{
+    SW_PixelAccess pa, tpa;
+    SDL_Rect texbounds;
+    int i;
+
+    SDL_zero(tpa);
+    SDL_zero(texbounds);
+    SW_InitPixelAccess(&pa, dst->format);
+    if (texture) {
+        SW_InitPixelAccess(&tpa, texture->format);
+        texbounds.w = texture->w;
+        texbounds.h = texture->h;
+    }
+
+    for (i = 0; (i + 2) < count; i += 3) {
+        SW_RasterTriangle(&pa, dst, clip, &vertices[i], &vertices[i + 1], &vertices[i + 2],
+                          origin_x, origin_y, texture ? &tpa : NULL, texture, &texbounds,
+                          blendMode, scaleMode);
+    }
+}
+
+#endif /* SDL_VIDEO_RENDER_SW && !SDL_RENDER_DISABLED */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,65 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifndef SDL_swraster_c_h_
+#define SDL_swraster_c_h_
+
+#include "SDL_render.h"
+#include "SDL_surface.h"
+
+/* Scalar rasterizers used by the software renderer.
+
+   Every function only touches pixels inside 'clip', which the caller has
+   already intersected with the destination surface. All coordinates are
+   evaluated in absolute target space, so the same primitive drawn through
+   several adjacent clip rectangles produces exactly the same pixels as
+   drawing it once. The tile renderer relies on this to avoid seams.
+*/
+
+typedef struct SW_Vertex
+{
+    float x, y;
+    SDL_Color color;
+    float u, v; /* in texels, unused for untextured geometry */
+} SW_Vertex;
+
+extern SDL_bool SW_RasterSupportsBlendMode(SDL_BlendMode blendMode);
+
+extern void SW_RasterFillRect(SDL_Surface *dst, const SDL_Rect *clip, const SDL_Rect *rect,
+                              SDL_Color color, SDL_BlendMode blendMode);
+
+extern void SW_RasterPoints(SDL_Surface *dst, const SDL_Rect *clip, const SDL_FPoint *points, int count,
+                            int origin_x, int origin_y, SDL_Color color, SDL_BlendMode blendMode);
+
+extern void SW_RasterLines(SDL_Surface *dst, const SDL_Rect *clip, const SDL_FPoint *points, int count,
+                           int origin_x, int origin_y, SDL_Color color, SDL_BlendMode blendMode);
+
+extern void SW_RasterStretch(SDL_Surface *dst, const SDL_Rect *clip, SDL_Surface *src, const SDL_Rect *srcrect,
+                             const SDL_FRect *dstrect, SDL_Color color, SDL_BlendMode blendMode, SDL_ScaleMode scaleMode);
+
+extern void SW_RasterTriangles(SDL_Surface *dst, const SDL_Rect *clip, const SW_Vertex *vertices, int count,
+                               int origin_x, int origin_y, SDL_Surface *texture,
+                               SDL_BlendMode blendMode, SDL_ScaleMode scaleMode);
+
+#endif /* SDL_swraster_c_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
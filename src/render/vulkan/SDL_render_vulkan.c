@@ -0,0 +1,2943 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_VULKAN
+#include "SDL_hints.h"
+#include "../../video/SDL_sysvideo.h" /* For SDL_RecreateWindow */
+#include "../../video/SDL_vulkan_internal.h"
+#include "../SDL_sysrender.h"
+#include "SDL_shaders_vulkan.h"
+
+/* Vulkan renderer implementation
+
+   Each frame is recorded into a command buffer of its own, and up to
+   VULKAN_FRAMES_IN_FLIGHT frames are submitted before we wait for the
+   oldest one. Every frame has a ring of vertex memory and one of uniform
+   memory, which are reused once its fence is signaled, and the resources
+   released while it was recorded are destroyed at that point too.
+
+   Textures have a persistent descriptor set for each scale mode, and the
+   pipelines are created as they're needed, through a pipeline cache that
+   can be kept across runs.
+*/
+
+#define VULKAN_FRAMES_IN_FLIGHT 2
+
+/* Initial sizes of the per-frame rings, they grow as needed */
+#define VULKAN_VERTEX_BUFFER_SIZE  (256 * 1024)
+#define VULKAN_UNIFORM_BUFFER_SIZE (16 * 1024)
+
+/* Descriptor sets in each descriptor pool */
+#define VULKAN_DESCRIPTOR_POOL_SIZE 128
+
+#define VULKAN_MAX_RENDER_PASSES 4
+
+#define VULKAN_PIPELINE_CACHE_MAGIC 0x56534453 /* "SDSV" */
+
+static const float inv255f = 1.0f / 255.0f;
+
+/* Points, lines and untextured geometry */
+typedef struct
+{
+    float x, y;
+    SDL_Color color;
+} VULKAN_SolidVertex;
+
+/* Textured geometry */
+typedef struct
+{
+    float x, y;
+    SDL_Color color;
+    float u, v;
+} VULKAN_TextureVertex;
+
+/* The uniforms of the vertex shaders */
+typedef struct
+{
+    float scale[2];
+    float offset[2];
+} VULKAN_Globals;
+
+typedef struct
+{
+    VkBuffer buffer;
+    VkDeviceMemory memory;
+    Uint8 *mapping;
+    VkDeviceSize size;
+} VULKAN_Buffer;
+
+/* Memory handed out in order and reset once the frame is done. The uniform
+   rings have a descriptor set for the buffer. */
+typedef struct
+{
+    VULKAN_Buffer buffer;
+    VkDeviceSize used;
+    VkDescriptorPool pool;
+    VkDescriptorSet set;
+} VULKAN_Ring;
+
+/* Resources released while a frame was recorded, destroyed when it's done */
+typedef struct VULKAN_Garbage
+{
+    VULKAN_Buffer buffer;
+    VkImage image;
+    VkImageView views[2];
+    VkDeviceMemory memory;
+    VkFramebuffer framebuffer;
+    VkDescriptorPool pool;
+    VkDescriptorSet sets[2];
+    Uint32 num_sets;
+    struct VULKAN_Garbage *next;
+} VULKAN_Garbage;
+
+typedef struct
+{
+    VkCommandBuffer command_buffer;
+    VkFence fence;
+    VkSemaphore image_available;
+    SDL_bool submitted;
+    VULKAN_Ring vertices;
+    VULKAN_Ring uniforms;
+    VULKAN_Garbage *garbage;
+} VULKAN_Frame;
+
+typedef struct
+{
+    VULKAN_Shader shader;
+    VkPrimitiveTopology topology;
+    SDL_BlendMode blend;
+    VkFormat format;
+    VkPipeline pipeline;
+} VULKAN_Pipeline;
+
+typedef struct
+{
+    VkFormat format;
+    VkRenderPass render_pass;
+} VULKAN_RenderPass;
+
+typedef struct
+{
+    SDL_Texture *target;
+    SDL_bool viewport_dirty;
+    SDL_Rect viewport;
+    SDL_bool cliprect_enabled;
+    SDL_bool cliprect_dirty;
+    SDL_Rect cliprect;
+    SDL_bool uniforms_dirty;
+    VkPipeline pipeline;
+    VULKAN_Shader shader;
+    SDL_BlendMode blend;
+    VkDescriptorSet texture_set;
+    VkBuffer vertex_buffer;
+    VkDeviceSize vertex_offset;
+} VULKAN_DrawStateCache;
+
+typedef struct
+{
+    /* Vulkan functions */
+    PFN_vkGetInstanceProcAddr vkGetInstanceProcAddr;
+#define VULKAN_GLOBAL_FUNCTION(name)   PFN_##name name;
+#define VULKAN_INSTANCE_FUNCTION(name) PFN_##name name;
+#define VULKAN_DEVICE_FUNCTION(name)   PFN_##name name;
+#include "SDL_vulkanfuncs.h"
+
+    VkInstance instance;
+    VkSurfaceKHR surface;
+    VkPhysicalDevice physical_device;
+    VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceMemoryProperties memory_properties;
+    Uint32 queue_family;
+    VkDevice device;
+    VkQueue queue;
+
+    VkCommandPool command_pool;
+    VkDescriptorSetLayout globals_layout;
+    VkDescriptorSetLayout texture_layout;
+    VkPipelineLayout pipeline_layout;
+    VkSampler samplers[2]; /* nearest, linear */
+    VkShaderModule vertex_shaders[VULKAN_NUM_SHADERS];
+    VkShaderModule fragment_shaders[VULKAN_NUM_SHADERS];
+
+    VkDescriptorPool *descriptor_pools;
+    int num_descriptor_pools;
+
+    VkPipelineCache pipeline_cache;
+    SDL_bool pipeline_cache_dirty;
+    VULKAN_Pipeline *pipelines;
+    int num_pipelines;
+    VULKAN_RenderPass render_passes[VULKAN_MAX_RENDER_PASSES];
+    int num_render_passes;
+
+    /* The window's swapchain, there is none while the window has no size */
+    VkSwapchainKHR swapchain;
+    VkFormat swapchain_format;
+    VkExtent2D swapchain_extent;
+    SDL_bool swapchain_readable;
+    Uint32 swapchain_image_count;
+    VkImage *swapchain_images;
+    VkImageView *swapchain_views;
+    VkFramebuffer *swapchain_framebuffers;
+    VkImageLayout *swapchain_layouts;
+    VkSemaphore *render_finished;
+    SDL_bool recreate_swapchain;
+    SDL_bool vsync;
+    SDL_bool image_acquired;
+    SDL_bool acquire_wait_pending;
+    Uint32 image_index;
+
+    VULKAN_Frame frames[VULKAN_FRAMES_IN_FLIGHT];
+    int frame;
+    SDL_bool recording;
+
+    /* The render pass being recorded */
+    SDL_bool in_render_pass;
+    SDL_Texture *pass_target;
+    VkFormat pass_format;
+    VkExtent2D pass_extent;
+
+    VULKAN_Buffer readback;
+
+    SDL_RenderStats *stats;
+
+    VULKAN_DrawStateCache drawstate;
+} VULKAN_RenderData;
+
+typedef struct
+{
+    VkImage image;
+    VkDeviceMemory memory;
+    VkImageView view;        /* for sampling, formats without alpha read it as 1 */
+    VkImageView target_view; /* for rendering, when the view for sampling swizzles */
+    VkFramebuffer framebuffer;
+    VkFormat format;
+    VkImageLayout layout;
+    VkDescriptorPool pool;
+    VkDescriptorSet sets[2]; /* one for each sampler */
+    SDL_ScaleMode scale_mode;
+    void *pixels;
+    int pitch;
+    SDL_Rect locked_rect;
+} VULKAN_TextureData;
+
+static int VULKAN_SetError(const char *function, VkResult result)
+{
+    return SDL_SetError("%s failed: %s", function, SDL_Vulkan_GetResultString(result));
+}
+
+static void VULKAN_WindowEvent(SDL_Renderer *renderer, const SDL_WindowEvent *event)
+{
+    if (event->event == SDL_WINDOWEVENT_SIZE_CHANGED) {
+        VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+        data->recreate_swapchain = SDL_TRUE;
+    }
+}
+
+static int VULKAN_GetOutputSize(SDL_Renderer *renderer, int *w, int *h)
+{
+    SDL_Vulkan_GetDrawableSize(renderer->window, w, h);
+    return 0;
+}
+
+static VkBlendFactor GetBlendFactor(SDL_BlendFactor factor)
+{
+    switch (factor) {
+    case SDL_BLENDFACTOR_ZERO:
+        return VK_BLEND_FACTOR_ZERO;
+    case SDL_BLENDFACTOR_ONE:
+        return VK_BLEND_FACTOR_ONE;
+    case SDL_BLENDFACTOR_SRC_COLOR:
+        return VK_BLEND_FACTOR_SRC_COLOR;
+    case SDL_BLENDFACTOR_ONE_MINUS_SRC_COLOR:
+        return VK_BLEND_FACTOR_ONE_MINUS_SRC_COLOR;
+    case SDL_BLENDFACTOR_SRC_ALPHA:
+        return VK_BLEND_FACTOR_SRC_ALPHA;
+    case SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA:
+        return VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+    case SDL_BLENDFACTOR_DST_COLOR:
+        return VK_BLEND_FACTOR_DST_COLOR;
+    case SDL_BLENDFACTOR_ONE_MINUS_DST_COLOR:
+        return VK_BLEND_FACTOR_ONE_MINUS_DST_COLOR;
+    case SDL_BLENDFACTOR_DST_ALPHA:
+        return VK_BLEND_FACTOR_DST_ALPHA;
+    case SDL_BLENDFACTOR_ONE_MINUS_DST_ALPHA:
+        return VK_BLEND_FACTOR_ONE_MINUS_DST_ALPHA;
+    default:
+        return VK_BLEND_FACTOR_MAX_ENUM;
+    }
+}
+
+static VkBlendOp GetBlendOp(SDL_BlendOperation operation)
+{
+    switch (operation) {
+    case SDL_BLENDOPERATION_ADD:
+        return VK_BLEND_OP_ADD;
+    case SDL_BLENDOPERATION_SUBTRACT:
+        return VK_BLEND_OP_SUBTRACT;
+    case SDL_BLENDOPERATION_REV_SUBTRACT:
+        return VK_BLEND_OP_REVERSE_SUBTRACT;
+    case SDL_BLENDOPERATION_MINIMUM:
+        return VK_BLEND_OP_MIN;
+    case SDL_BLENDOPERATION_MAXIMUM:
+        return VK_BLEND_OP_MAX;
+    default:
+        return VK_BLEND_OP_MAX_ENUM;
+    }
+}
+
+static SDL_bool VULKAN_SupportsBlendMode(SDL_Renderer *renderer, SDL_BlendMode blendMode)
+{
+    if (GetBlendFactor(SDL_GetBlendModeSrcColorFactor(blendMode)) == VK_BLEND_FACTOR_MAX_ENUM ||
+        GetBlendFactor(SDL_GetBlendModeSrcAlphaFactor(blendMode)) == VK_BLEND_FACTOR_MAX_ENUM ||
+        GetBlendOp(SDL_GetBlendModeColorOperation(blendMode)) == VK_BLEND_OP_MAX_ENUM ||
+        GetBlendFactor(SDL_GetBlendModeDstColorFactor(blendMode)) == VK_BLEND_FACTOR_MAX_ENUM ||
+        GetBlendFactor(SDL_GetBlendModeDstAlphaFactor(blendMode)) == VK_BLEND_FACTOR_MAX_ENUM ||
+        GetBlendOp(SDL_GetBlendModeAlphaOperation(blendMode)) == VK_BLEND_OP_MAX_ENUM) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+static VkFormat VULKAN_GetTextureFormat(Uint32 format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_ARGB8888:
+    case SDL_PIXELFORMAT_RGB888:
+        return VK_FORMAT_B8G8R8A8_UNORM;
+    case SDL_PIXELFORMAT_ABGR8888:
+    case SDL_PIXELFORMAT_BGR888:
+        return VK_FORMAT_R8G8B8A8_UNORM;
+    default:
+        return VK_FORMAT_UNDEFINED;
+    }
+}
+
+static Uint32 VULKAN_GetPixelFormat(VkFormat format)
+{
+    switch (format) {
+    case VK_FORMAT_B8G8R8A8_UNORM:
+        return SDL_PIXELFORMAT_ARGB8888;
+    case VK_FORMAT_R8G8B8A8_UNORM:
+        return SDL_PIXELFORMAT_ABGR8888;
+    default:
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+}
+
+static int VULKAN_AllocateMemory(VULKAN_RenderData *data, const VkMemoryRequirements *requirements,
+                                 VkMemoryPropertyFlags required, VkMemoryPropertyFlags preferred, VkDeviceMemory *memory)
+{
+    VkMemoryAllocateInfo allocate_info;
+    VkResult result;
+    int pass;
+
+    /* Look for a type with the preferred properties first */
+    for (pass = 0; pass < 2; ++pass) {
+        const VkMemoryPropertyFlags flags = required | (pass == 0 ? preferred : 0);
+        Uint32 i;
+
+        for (i = 0; i < data->memory_properties.memoryTypeCount; ++i) {
+            if ((requirements->memoryTypeBits & (1u << i)) &&
+                (data->memory_properties.memoryTypes[i].propertyFlags & flags) == flags) {
+                SDL_zero(allocate_info);
+                allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+                allocate_info.allocationSize = requirements->size;
+                allocate_info.memoryTypeIndex = i;
+                result = data->vkAllocateMemory(data->device, &allocate_info, NULL, memory);
+                if (result != VK_SUCCESS) {
+                    return VULKAN_SetError("vkAllocateMemory()", result);
+                }
+                return 0;
+            }
+        }
+    }
+    return SDL_SetError("No suitable Vulkan memory type");
+}
+
+/* Buffers are host visible and stay mapped */
+static int VULKAN_CreateBuffer(VULKAN_RenderData *data, VkDeviceSize size, VkBufferUsageFlags usage, VULKAN_Buffer *buffer)
+{
+    VkBufferCreateInfo buffer_info;
+    VkMemoryRequirements requirements;
+    VkResult result;
+    void *mapping = NULL;
+
+    SDL_zerop(buffer);
+
+    SDL_zero(buffer_info);
+    buffer_info.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    buffer_info.size = size;
+    buffer_info.usage = usage;
+    buffer_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    result = data->vkCreateBuffer(data->device, &buffer_info, NULL, &buffer->buffer);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateBuffer()", result);
+    }
+
+    data->vkGetBufferMemoryRequirements(data->device, buffer->buffer, &requirements);
+    if (VULKAN_AllocateMemory(data, &requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, 0, &buffer->memory) < 0) {
+        goto error;
+    }
+    result = data->vkBindBufferMemory(data->device, buffer->buffer, buffer->memory, 0);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkBindBufferMemory()", result);
+        goto error;
+    }
+    result = data->vkMapMemory(data->device, buffer->memory, 0, VK_WHOLE_SIZE, 0, &mapping);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkMapMemory()", result);
+        goto error;
+    }
+    buffer->mapping = (Uint8 *)mapping;
+    buffer->size = size;
+    return 0;
+
+error:
+    if (buffer->memory) {
+        data->vkFreeMemory(data->device, buffer->memory, NULL);
+    }
+    data->vkDestroyBuffer(data->device, buffer->buffer, NULL);
+    SDL_zerop(buffer);
+    return -1;
+}
+
+static void VULKAN_DestroyBuffer(VULKAN_RenderData *data, VULKAN_Buffer *buffer)
+{
+    if (buffer->buffer) {
+        data->vkDestroyBuffer(data->device, buffer->buffer, NULL);
+    }
+    if (buffer->memory) {
+        data->vkFreeMemory(data->device, buffer->memory, NULL); /* this unmaps it too */
+    }
+    SDL_zerop(buffer);
+}
+
+/* Descriptor sets come from a list of pools, a new one is added when they're all full */
+static int VULKAN_AllocateDescriptorSets(VULKAN_RenderData *data, VkDescriptorSetLayout layout,
+                                         Uint32 count, VkDescriptorSet *sets, VkDescriptorPool *pool)
+{
+    VkDescriptorSetLayout layouts[2];
+    VkDescriptorSetAllocateInfo allocate_info;
+    VkDescriptorPoolCreateInfo pool_info;
+    VkDescriptorPoolSize pool_sizes[2];
+    VkDescriptorPool *pools;
+    VkResult result;
+    Uint32 i;
+    int j;
+
+    SDL_assert(count <= SDL_arraysize(layouts));
+    for (i = 0; i < count; ++i) {
+        layouts[i] = layout;
+    }
+
+    SDL_zero(allocate_info);
+    allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocate_info.descriptorSetCount = count;
+    allocate_info.pSetLayouts = layouts;
+
+    /* The newest pool is the most likely to have room */
+    for (j = data->num_descriptor_pools - 1; j >= 0; --j) {
+        allocate_info.descriptorPool = data->descriptor_pools[j];
+        if (data->vkAllocateDescriptorSets(data->device, &allocate_info, sets) == VK_SUCCESS) {
+            *pool = data->descriptor_pools[j];
+            return 0;
+        }
+    }
+
+    pools = (VkDescriptorPool *)SDL_realloc(data->descriptor_pools, (data->num_descriptor_pools + 1) * sizeof(*pools));
+    if (!pools) {
+        return SDL_OutOfMemory();
+    }
+    data->descriptor_pools = pools;
+
+    pool_sizes[0].type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    pool_sizes[0].descriptorCount = VULKAN_DESCRIPTOR_POOL_SIZE;
+    pool_sizes[1].type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    pool_sizes[1].descriptorCount = VULKAN_FRAMES_IN_FLIGHT * 2;
+
+    SDL_zero(pool_info);
+    pool_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    pool_info.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+    pool_info.maxSets = VULKAN_DESCRIPTOR_POOL_SIZE;
+    pool_info.poolSizeCount = SDL_arraysize(pool_sizes);
+    pool_info.pPoolSizes = pool_sizes;
+    result = data->vkCreateDescriptorPool(data->device, &pool_info, NULL, &pools[data->num_descriptor_pools]);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateDescriptorPool()", result);
+    }
+    allocate_info.descriptorPool = pools[data->num_descriptor_pools++];
+
+    result = data->vkAllocateDescriptorSets(data->device, &allocate_info, sets);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkAllocateDescriptorSets()", result);
+    }
+    *pool = allocate_info.descriptorPool;
+    return 0;
+}
+
+static void VULKAN_DestroyGarbage(VULKAN_RenderData *data, VULKAN_Garbage *garbage)
+{
+    int i;
+
+    VULKAN_DestroyBuffer(data, &garbage->buffer);
+    if (garbage->framebuffer) {
+        data->vkDestroyFramebuffer(data->device, garbage->framebuffer, NULL);
+    }
+    for (i = 0; i < SDL_arraysize(garbage->views); ++i) {
+        if (garbage->views[i]) {
+            data->vkDestroyImageView(data->device, garbage->views[i], NULL);
+        }
+    }
+    if (garbage->image) {
+        data->vkDestroyImage(data->device, garbage->image, NULL);
+    }
+    if (garbage->memory) {
+        data->vkFreeMemory(data->device, garbage->memory, NULL);
+    }
+    if (garbage->num_sets) {
+        data->vkFreeDescriptorSets(data->device, garbage->pool, garbage->num_sets, garbage->sets);
+    }
+}
+
+/* Destroy the resources once the frame being recorded is done with them */
+static void VULKAN_AddGarbage(VULKAN_RenderData *data, const VULKAN_Garbage *garbage)
+{
+    VULKAN_Frame *frame = &data->frames[data->frame];
+    VULKAN_Garbage *item;
+
+    SDL_assert(data->recording);
+
+    item = (VULKAN_Garbage *)SDL_malloc(sizeof(*item));
+    if (!item) {
+        /* Out of memory, wait until nothing uses them instead */
+        data->vkDeviceWaitIdle(data->device);
+        VULKAN_DestroyGarbage(data, (VULKAN_Garbage *)garbage);
+        return;
+    }
+    SDL_copyp(item, garbage);
+    item->next = frame->garbage;
+    frame->garbage = item;
+}
+
+static void VULKAN_FreeGarbage(VULKAN_RenderData *data, VULKAN_Frame *frame)
+{
+    while (frame->garbage) {
+        VULKAN_Garbage *next = frame->garbage->next;
+        VULKAN_DestroyGarbage(data, frame->garbage);
+        SDL_free(frame->garbage);
+        frame->garbage = next;
+    }
+}
+
+static int VULKAN_CreateRingBuffer(VULKAN_RenderData *data, VULKAN_Ring *ring, VkDeviceSize size, VkBufferUsageFlags usage)
+{
+    VkDescriptorBufferInfo buffer_info;
+    VkWriteDescriptorSet write;
+
+    if (VULKAN_CreateBuffer(data, size, usage, &ring->buffer) < 0) {
+        return -1;
+    }
+    ring->used = 0;
+
+    if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) {
+        if (VULKAN_AllocateDescriptorSets(data, data->globals_layout, 1, &ring->set, &ring->pool) < 0) {
+            VULKAN_DestroyBuffer(data, &ring->buffer);
+            return -1;
+        }
+
+        buffer_info.buffer = ring->buffer.buffer;
+        buffer_info.offset = 0;
+        buffer_info.range = sizeof(VULKAN_Globals);
+
+        SDL_zero(write);
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = ring->set;
+        write.dstBinding = 0;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+        write.pBufferInfo = &buffer_info;
+        data->vkUpdateDescriptorSets(data->device, 1, &write, 0, NULL);
+    }
+    return 0;
+}
+
+/* Allocate memory from the current frame's ring, growing it if it's full.
+   The old buffer is released along with the frame. */
+static int VULKAN_AllocateFromRing(VULKAN_RenderData *data, VULKAN_Ring *ring, VkDeviceSize size, VkDeviceSize align,
+                                   VkBufferUsageFlags usage, VkDeviceSize *offset)
+{
+    VkDeviceSize start = (ring->used + align - 1) & ~(align - 1);
+
+    if (start + size > ring->buffer.size) {
+        VULKAN_Ring old_ring = *ring;
+        VkDeviceSize new_size = old_ring.buffer.size * 2;
+
+        while (new_size < size) {
+            new_size *= 2;
+        }
+        if (VULKAN_CreateRingBuffer(data, ring, new_size, usage) < 0) {
+            *ring = old_ring;
+            return -1;
+        }
+
+        if (old_ring.buffer.buffer) {
+            VULKAN_Garbage garbage;
+            SDL_zero(garbage);
+            garbage.buffer = old_ring.buffer;
+            if (old_ring.set) {
+                garbage.pool = old_ring.pool;
+                garbage.sets[0] = old_ring.set;
+                garbage.num_sets = 1;
+            }
+            VULKAN_AddGarbage(data, &garbage);
+        }
+        start = 0;
+    }
+
+    ring->used = start + size;
+    *offset = start;
+    return 0;
+}
+
+static void VULKAN_InvalidateDrawState(VULKAN_RenderData *data)
+{
+    data->drawstate.viewport_dirty = SDL_TRUE;
+    data->drawstate.cliprect_dirty = SDL_TRUE;
+    data->drawstate.uniforms_dirty = SDL_TRUE;
+    data->drawstate.pipeline = VK_NULL_HANDLE;
+    data->drawstate.shader = VULKAN_NUM_SHADERS;
+    data->drawstate.blend = SDL_BLENDMODE_INVALID;
+    data->drawstate.texture_set = VK_NULL_HANDLE;
+    data->drawstate.vertex_buffer = VK_NULL_HANDLE;
+}
+
+/* Start recording the current frame, waiting for its last submission first */
+static int VULKAN_BeginFrame(VULKAN_RenderData *data)
+{
+    VULKAN_Frame *frame = &data->frames[data->frame];
+    VkCommandBufferBeginInfo begin_info;
+    VkResult result;
+
+    if (data->recording) {
+        return 0;
+    }
+
+    if (frame->submitted) {
+        result = data->vkWaitForFences(data->device, 1, &frame->fence, VK_TRUE, UINT64_MAX);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkWaitForFences()", result);
+        }
+        data->vkResetFences(data->device, 1, &frame->fence);
+        frame->submitted = SDL_FALSE;
+    }
+    VULKAN_FreeGarbage(data, frame);
+    frame->vertices.used = 0;
+    frame->uniforms.used = 0;
+
+    data->vkResetCommandBuffer(frame->command_buffer, 0);
+    SDL_zero(begin_info);
+    begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    begin_info.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    result = data->vkBeginCommandBuffer(frame->command_buffer, &begin_info);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkBeginCommandBuffer()", result);
+    }
+    data->recording = SDL_TRUE;
+
+    /* Nothing is bound in a new command buffer */
+    VULKAN_InvalidateDrawState(data);
+    return 0;
+}
+
+static void VULKAN_GetLayoutAccess(VkImageLayout layout, VkPipelineStageFlags *stage, VkAccessFlags *access)
+{
+    switch (layout) {
+    case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+        *stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        *access = VK_ACCESS_TRANSFER_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+        *stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+        *access = VK_ACCESS_TRANSFER_READ_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+        *stage = VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
+        *access = VK_ACCESS_SHADER_READ_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+        *stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        *access = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        break;
+    case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+        *stage = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+        *access = 0;
+        break;
+    default:
+        /* Undefined, for swapchain images this has to come after the
+           semaphore wait for the acquire, which is at this stage. */
+        *stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        *access = 0;
+        break;
+    }
+}
+
+static void VULKAN_TransitionImage(VULKAN_RenderData *data, VkImage image, VkImageLayout *layout, VkImageLayout new_layout)
+{
+    VkImageMemoryBarrier barrier;
+    VkPipelineStageFlags src_stage, dst_stage;
+
+    if (*layout == new_layout) {
+        return;
+    }
+
+    SDL_zero(barrier);
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.oldLayout = *layout;
+    barrier.newLayout = new_layout;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.layerCount = 1;
+    VULKAN_GetLayoutAccess(*layout, &src_stage, &barrier.srcAccessMask);
+    VULKAN_GetLayoutAccess(new_layout, &dst_stage, &barrier.dstAccessMask);
+    data->vkCmdPipelineBarrier(data->frames[data->frame].command_buffer, src_stage, dst_stage,
+                               0, 0, NULL, 0, NULL, 1, &barrier);
+    *layout = new_layout;
+}
+
+static VkRenderPass VULKAN_GetRenderPass(VULKAN_RenderData *data, VkFormat format)
+{
+    VkAttachmentDescription attachment;
+    VkAttachmentReference reference;
+    VkSubpassDescription subpass;
+    VkRenderPassCreateInfo render_pass_info;
+    VkRenderPass render_pass;
+    VkResult result;
+    int i;
+
+    for (i = 0; i < data->num_render_passes; ++i) {
+        if (data->render_passes[i].format == format) {
+            return data->render_passes[i].render_pass;
+        }
+    }
+    if (data->num_render_passes == VULKAN_MAX_RENDER_PASSES) {
+        SDL_SetError("Too many Vulkan render target formats");
+        return VK_NULL_HANDLE;
+    }
+
+    /* The images are transitioned outside of the render pass, and keep their contents */
+    SDL_zero(attachment);
+    attachment.format = format;
+    attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+    attachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+    attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+    attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+    attachment.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+    attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    reference.attachment = 0;
+    reference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+    SDL_zero(subpass);
+    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpass.colorAttachmentCount = 1;
+    subpass.pColorAttachments = &reference;
+
+    SDL_zero(render_pass_info);
+    render_pass_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+    render_pass_info.attachmentCount = 1;
+    render_pass_info.pAttachments = &attachment;
+    render_pass_info.subpassCount = 1;
+    render_pass_info.pSubpasses = &subpass;
+    result = data->vkCreateRenderPass(data->device, &render_pass_info, NULL, &render_pass);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkCreateRenderPass()", result);
+        return VK_NULL_HANDLE;
+    }
+
+    data->render_passes[data->num_render_passes].format = format;
+    data->render_passes[data->num_render_passes].render_pass = render_pass;
+    ++data->num_render_passes;
+    return render_pass;
+}
+
+static int VULKAN_CreateFramebuffer(VULKAN_RenderData *data, VkFormat format, VkImageView view,
+                                    Uint32 width, Uint32 height, VkFramebuffer *framebuffer)
+{
+    VkFramebufferCreateInfo framebuffer_info;
+    VkResult result;
+
+    SDL_zero(framebuffer_info);
+    framebuffer_info.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+    framebuffer_info.renderPass = VULKAN_GetRenderPass(data, format);
+    if (!framebuffer_info.renderPass) {
+        return -1;
+    }
+    framebuffer_info.attachmentCount = 1;
+    framebuffer_info.pAttachments = &view;
+    framebuffer_info.width = width;
+    framebuffer_info.height = height;
+    framebuffer_info.layers = 1;
+    result = data->vkCreateFramebuffer(data->device, &framebuffer_info, NULL, framebuffer);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateFramebuffer()", result);
+    }
+    return 0;
+}
+
+static int VULKAN_CreateImageView(VULKAN_RenderData *data, VkImage image, VkFormat format, SDL_bool opaque, VkImageView *view)
+{
+    VkImageViewCreateInfo view_info;
+    VkResult result;
+
+    SDL_zero(view_info);
+    view_info.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    view_info.image = image;
+    view_info.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    view_info.format = format;
+    view_info.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
+    view_info.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
+    view_info.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
+    /* Whatever is in the unused byte, these are opaque */
+    view_info.components.a = opaque ? VK_COMPONENT_SWIZZLE_ONE : VK_COMPONENT_SWIZZLE_IDENTITY;
+    view_info.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    view_info.subresourceRange.levelCount = 1;
+    view_info.subresourceRange.layerCount = 1;
+    result = data->vkCreateImageView(data->device, &view_info, NULL, view);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateImageView()", result);
+    }
+    return 0;
+}
+
+static void VULKAN_DestroySwapchainResources(VULKAN_RenderData *data)
+{
+    Uint32 i;
+
+    for (i = 0; i < data->swapchain_image_count; ++i) {
+        if (data->swapchain_framebuffers && data->swapchain_framebuffers[i]) {
+            data->vkDestroyFramebuffer(data->device, data->swapchain_framebuffers[i], NULL);
+        }
+        if (data->swapchain_views && data->swapchain_views[i]) {
+            data->vkDestroyImageView(data->device, data->swapchain_views[i], NULL);
+        }
+        if (data->render_finished && data->render_finished[i]) {
+            data->vkDestroySemaphore(data->device, data->render_finished[i], NULL);
+        }
+    }
+    SDL_free(data->swapchain_images);
+    SDL_free(data->swapchain_views);
+    SDL_free(data->swapchain_framebuffers);
+    SDL_free(data->swapchain_layouts);
+    SDL_free(data->render_finished);
+    data->swapchain_images = NULL;
+    data->swapchain_views = NULL;
+    data->swapchain_framebuffers = NULL;
+    data->swapchain_layouts = NULL;
+    data->render_finished = NULL;
+    data->swapchain_image_count = 0;
+}
+
+static VkPresentModeKHR VULKAN_ChoosePresentMode(VULKAN_RenderData *data, SDL_bool vsync)
+{
+    VkPresentModeKHR modes[8];
+    Uint32 count = SDL_arraysize(modes);
+    VkPresentModeKHR mode = VK_PRESENT_MODE_FIFO_KHR; /* always supported */
+    Uint32 i;
+
+    if (vsync) {
+        return mode;
+    }
+
+    /* VK_INCOMPLETE is fine, the ones we want come first */
+    data->vkGetPhysicalDeviceSurfacePresentModesKHR(data->physical_device, data->surface, &count, modes);
+    for (i = 0; i < count; ++i) {
+        if (modes[i] == VK_PRESENT_MODE_MAILBOX_KHR) {
+            return modes[i];
+        } else if (modes[i] == VK_PRESENT_MODE_IMMEDIATE_KHR) {
+            mode = modes[i];
+        }
+    }
+    return mode;
+}
+
+static int VULKAN_CreateSwapchain(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VkSurfaceCapabilitiesKHR caps;
+    VkSurfaceFormatKHR *formats = NULL;
+    VkSurfaceFormatKHR format;
+    VkSwapchainCreateInfoKHR swapchain_info;
+    VkSwapchainKHR old_swapchain = data->swapchain;
+    VkSemaphoreCreateInfo semaphore_info;
+    VkExtent2D extent;
+    Uint32 count = 0;
+    Uint32 i;
+    VkResult result;
+
+    data->recreate_swapchain = SDL_FALSE;
+
+    result = data->vkGetPhysicalDeviceSurfaceCapabilitiesKHR(data->physical_device, data->surface, &caps);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkGetPhysicalDeviceSurfaceCapabilitiesKHR()", result);
+    }
+    if (caps.currentExtent.width == 0xFFFFFFFF) {
+        int w, h;
+        SDL_Vulkan_GetDrawableSize(renderer->window, &w, &h);
+        extent.width = SDL_clamp((Uint32)w, caps.minImageExtent.width, caps.maxImageExtent.width);
+        extent.height = SDL_clamp((Uint32)h, caps.minImageExtent.height, caps.maxImageExtent.height);
+    } else {
+        extent = caps.currentExtent;
+    }
+
+    /* The images in flight may use the old swapchain */
+    if (old_swapchain) {
+        data->vkDeviceWaitIdle(data->device);
+        VULKAN_DestroySwapchainResources(data);
+    }
+
+    if (extent.width == 0 || extent.height == 0) {
+        /* The window is minimized, try again when it's presented next time */
+        if (old_swapchain) {
+            data->vkDestroySwapchainKHR(data->device, old_swapchain, NULL);
+            data->swapchain = VK_NULL_HANDLE;
+        }
+        data->recreate_swapchain = SDL_TRUE;
+        return 0;
+    }
+
+    result = data->vkGetPhysicalDeviceSurfaceFormatsKHR(data->physical_device, data->surface, &count, NULL);
+    if (result != VK_SUCCESS || count == 0) {
+        return VULKAN_SetError("vkGetPhysicalDeviceSurfaceFormatsKHR()", result);
+    }
+    formats = (VkSurfaceFormatKHR *)SDL_malloc(count * sizeof(*formats));
+    if (!formats) {
+        return SDL_OutOfMemory();
+    }
+    data->vkGetPhysicalDeviceSurfaceFormatsKHR(data->physical_device, data->surface, &count, formats);
+    format = formats[0];
+    if (count == 1 && format.format == VK_FORMAT_UNDEFINED) {
+        format.format = VK_FORMAT_B8G8R8A8_UNORM; /* anything goes */
+    } else {
+        for (i = 0; i < count; ++i) {
+            if ((formats[i].format == VK_FORMAT_B8G8R8A8_UNORM || formats[i].format == VK_FORMAT_R8G8B8A8_UNORM) &&
+                formats[i].colorSpace == VK_COLOR_SPACE_SRGB_NONLINEAR_KHR) {
+                format = formats[i];
+                break;
+            }
+        }
+    }
+    SDL_free(formats);
+    if (VULKAN_GetPixelFormat(format.format) == SDL_PIXELFORMAT_UNKNOWN) {
+        return SDL_SetError("The window has no Vulkan surface format the renderer can use");
+    }
+
+    SDL_zero(swapchain_info);
+    swapchain_info.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR;
+    swapchain_info.surface = data->surface;
+    swapchain_info.minImageCount = caps.minImageCount + 1;
+    if (caps.maxImageCount && swapchain_info.minImageCount > caps.maxImageCount) {
+        swapchain_info.minImageCount = caps.maxImageCount;
+    }
+    swapchain_info.imageFormat = format.format;
+    swapchain_info.imageColorSpace = format.colorSpace;
+    swapchain_info.imageExtent = extent;
+    swapchain_info.imageArrayLayers = 1;
+    swapchain_info.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+    if (caps.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) {
+        /* For SDL_RenderReadPixels() */
+        swapchain_info.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    swapchain_info.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    swapchain_info.preTransform = caps.currentTransform;
+    if (caps.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR) {
+        swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
+    } else if (caps.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR) {
+        swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+    } else if (caps.supportedCompositeAlpha & VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR) {
+        swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR;
+    } else {
+        swapchain_info.compositeAlpha = VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR;
+    }
+    swapchain_info.presentMode = VULKAN_ChoosePresentMode(data, data->vsync);
+    swapchain_info.clipped = VK_TRUE;
+    swapchain_info.oldSwapchain = old_swapchain;
+    result = data->vkCreateSwapchainKHR(data->device, &swapchain_info, NULL, &data->swapchain);
+    if (old_swapchain) {
+        data->vkDestroySwapchainKHR(data->device, old_swapchain, NULL);
+    }
+    if (result != VK_SUCCESS) {
+        data->swapchain = VK_NULL_HANDLE;
+        return VULKAN_SetError("vkCreateSwapchainKHR()", result);
+    }
+    data->swapchain_format = format.format;
+    data->swapchain_extent = extent;
+    data->swapchain_readable = (swapchain_info.imageUsage & VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ? SDL_TRUE : SDL_FALSE;
+
+    data->vkGetSwapchainImagesKHR(data->device, data->swapchain, &count, NULL);
+    data->swapchain_images = (VkImage *)SDL_calloc(count, sizeof(*data->swapchain_images));
+    data->swapchain_views = (VkImageView *)SDL_calloc(count, sizeof(*data->swapchain_views));
+    data->swapchain_framebuffers = (VkFramebuffer *)SDL_calloc(count, sizeof(*data->swapchain_framebuffers));
+    data->swapchain_layouts = (VkImageLayout *)SDL_calloc(count, sizeof(*data->swapchain_layouts));
+    data->render_finished = (VkSemaphore *)SDL_calloc(count, sizeof(*data->render_finished));
+    if (!data->swapchain_images || !data->swapchain_views || !data->swapchain_framebuffers ||
+        !data->swapchain_layouts || !data->render_finished) {
+        VULKAN_DestroySwapchainResources(data);
+        return SDL_OutOfMemory();
+    }
+    data->swapchain_image_count = count;
+    data->vkGetSwapchainImagesKHR(data->device, data->swapchain, &count, data->swapchain_images);
+
+    SDL_zero(semaphore_info);
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (i = 0; i < count; ++i) {
+        data->swapchain_layouts[i] = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (VULKAN_CreateImageView(data, data->swapchain_images[i], format.format, SDL_FALSE, &data->swapchain_views[i]) < 0 ||
+            VULKAN_CreateFramebuffer(data, format.format, data->swapchain_views[i], extent.width, extent.height, &data->swapchain_framebuffers[i]) < 0) {
+            return -1;
+        }
+        result = data->vkCreateSemaphore(data->device, &semaphore_info, NULL, &data->render_finished[i]);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkCreateSemaphore()", result);
+        }
+    }
+    return 0;
+}
+
+/* Get the swapchain image for this frame, if the window has one */
+static int VULKAN_AcquireImage(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_Frame *frame = &data->frames[data->frame];
+    VkResult result;
+    int attempt;
+
+    if (data->image_acquired) {
+        return 0;
+    }
+
+    for (attempt = 0; attempt < 2; ++attempt) {
+        if (data->recreate_swapchain || !data->swapchain) {
+            if (VULKAN_CreateSwapchain(renderer) < 0) {
+                return -1;
+            }
+            if (!data->swapchain) {
+                return 0;
+            }
+        }
+
+        result = data->vkAcquireNextImageKHR(data->device, data->swapchain, UINT64_MAX,
+                                             frame->image_available, VK_NULL_HANDLE, &data->image_index);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            data->recreate_swapchain = SDL_TRUE;
+            continue;
+        }
+        if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+            return VULKAN_SetError("vkAcquireNextImageKHR()", result);
+        }
+        if (result == VK_SUBOPTIMAL_KHR) {
+            data->recreate_swapchain = SDL_TRUE; /* after this frame */
+        }
+        data->image_acquired = SDL_TRUE;
+        data->acquire_wait_pending = SDL_TRUE;
+        /* Whatever was in the image is gone */
+        data->swapchain_layouts[data->image_index] = VK_IMAGE_LAYOUT_UNDEFINED;
+        return 0;
+    }
+    return 0;
+}
+
+static void VULKAN_EndRenderPass(VULKAN_RenderData *data)
+{
+    if (!data->in_render_pass) {
+        return;
+    }
+
+    data->vkCmdEndRenderPass(data->frames[data->frame].command_buffer);
+    if (data->pass_target) {
+        VULKAN_TextureData *texturedata = (VULKAN_TextureData *)data->pass_target->driverdata;
+        VULKAN_TransitionImage(data, texturedata->image, &texturedata->layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    }
+    data->in_render_pass = SDL_FALSE;
+    data->pass_target = NULL;
+}
+
+/* Make sure we're drawing to the current target, returns SDL_FALSE if there's nothing to draw to */
+static SDL_bool VULKAN_BeginRenderPass(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    SDL_Texture *target = data->drawstate.target;
+    VkRenderPassBeginInfo begin_info;
+    VkFormat format;
+
+    if (data->in_render_pass && data->pass_target == target) {
+        return SDL_TRUE;
+    }
+    VULKAN_EndRenderPass(data);
+
+    SDL_zero(begin_info);
+    begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    if (target) {
+        VULKAN_TextureData *texturedata = (VULKAN_TextureData *)target->driverdata;
+
+        if (!texturedata->framebuffer &&
+            VULKAN_CreateFramebuffer(data, texturedata->format,
+                                     texturedata->target_view ? texturedata->target_view : texturedata->view,
+                                     target->w, target->h, &texturedata->framebuffer) < 0) {
+            return SDL_FALSE;
+        }
+        VULKAN_TransitionImage(data, texturedata->image, &texturedata->layout, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        format = texturedata->format;
+        begin_info.framebuffer = texturedata->framebuffer;
+        begin_info.renderArea.extent.width = target->w;
+        begin_info.renderArea.extent.height = target->h;
+    } else {
+        if (VULKAN_AcquireImage(renderer) < 0 || !data->image_acquired) {
+            return SDL_FALSE;
+        }
+        VULKAN_TransitionImage(data, data->swapchain_images[data->image_index],
+                               &data->swapchain_layouts[data->image_index], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+        format = data->swapchain_format;
+        begin_info.framebuffer = data->swapchain_framebuffers[data->image_index];
+        begin_info.renderArea.extent = data->swapchain_extent;
+    }
+    begin_info.renderPass = VULKAN_GetRenderPass(data, format);
+    data->vkCmdBeginRenderPass(data->frames[data->frame].command_buffer, &begin_info, VK_SUBPASS_CONTENTS_INLINE);
+
+    data->in_render_pass = SDL_TRUE;
+    data->pass_target = target;
+    data->pass_format = format;
+    data->pass_extent = begin_info.renderArea.extent;
+
+    /* The pipelines depend on the format, and the scissor is clamped to the size */
+    data->drawstate.pipeline = VK_NULL_HANDLE;
+    data->drawstate.viewport_dirty = SDL_TRUE;
+    data->drawstate.cliprect_dirty = SDL_TRUE;
+    return SDL_TRUE;
+}
+
+/* Submit the commands recorded for the current frame, presenting the swapchain image if there is one */
+static int VULKAN_SubmitFrame(VULKAN_RenderData *data, SDL_bool present)
+{
+    VULKAN_Frame *frame = &data->frames[data->frame];
+    const VkPipelineStageFlags wait_stage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    VkSubmitInfo submit_info;
+    VkResult result;
+
+    SDL_assert(data->recording);
+
+    VULKAN_EndRenderPass(data);
+    if (present) {
+        VULKAN_TransitionImage(data, data->swapchain_images[data->image_index],
+                               &data->swapchain_layouts[data->image_index], VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
+    }
+
+    data->recording = SDL_FALSE;
+    result = data->vkEndCommandBuffer(frame->command_buffer);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkEndCommandBuffer()", result);
+    }
+
+    SDL_zero(submit_info);
+    submit_info.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    if (data->acquire_wait_pending) {
+        submit_info.waitSemaphoreCount = 1;
+        submit_info.pWaitSemaphores = &frame->image_available;
+        submit_info.pWaitDstStageMask = &wait_stage;
+        data->acquire_wait_pending = SDL_FALSE;
+    }
+    submit_info.commandBufferCount = 1;
+    submit_info.pCommandBuffers = &frame->command_buffer;
+    if (present) {
+        submit_info.signalSemaphoreCount = 1;
+        submit_info.pSignalSemaphores = &data->render_finished[data->image_index];
+    }
+    result = data->vkQueueSubmit(data->queue, 1, &submit_info, frame->fence);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkQueueSubmit()", result);
+    }
+    frame->submitted = SDL_TRUE;
+    return 0;
+}
+
+static void VULKAN_DestroyTextureData(VULKAN_RenderData *data, VULKAN_TextureData *texturedata)
+{
+    VULKAN_Garbage garbage;
+
+    SDL_zero(garbage);
+    garbage.image = texturedata->image;
+    garbage.memory = texturedata->memory;
+    garbage.views[0] = texturedata->view;
+    garbage.views[1] = texturedata->target_view;
+    garbage.framebuffer = texturedata->framebuffer;
+    if (texturedata->sets[0]) {
+        garbage.pool = texturedata->pool;
+        garbage.sets[0] = texturedata->sets[0];
+        garbage.sets[1] = texturedata->sets[1];
+        garbage.num_sets = 2;
+    }
+
+    /* The frames in flight may still use it */
+    if (VULKAN_BeginFrame(data) == 0) {
+        VULKAN_AddGarbage(data, &garbage);
+    } else {
+        data->vkDeviceWaitIdle(data->device);
+        VULKAN_DestroyGarbage(data, &garbage);
+    }
+    SDL_free(texturedata->pixels);
+    SDL_free(texturedata);
+}
+
+static int VULKAN_CreateTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    VULKAN_RenderData *renderdata = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_TextureData *data;
+    const SDL_bool opaque = SDL_ISPIXELFORMAT_ALPHA(texture->format) ? SDL_FALSE : SDL_TRUE;
+    VkImageCreateInfo image_info;
+    VkMemoryRequirements requirements;
+    VkDescriptorImageInfo image_infos[2];
+    VkWriteDescriptorSet writes[2];
+    VkClearColorValue clear_color;
+    VkImageSubresourceRange range;
+    VkResult result;
+    int i;
+
+    image_info.format = VULKAN_GetTextureFormat(texture->format);
+    if (image_info.format == VK_FORMAT_UNDEFINED) {
+        return SDL_SetError("Texture format %s not supported by Vulkan",
+                            SDL_GetPixelFormatName(texture->format));
+    }
+
+    data = (VULKAN_TextureData *)SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        return SDL_OutOfMemory();
+    }
+    data->format = image_info.format;
+    data->layout = VK_IMAGE_LAYOUT_UNDEFINED;
+    data->scale_mode = texture->scaleMode;
+
+    if (texture->access == SDL_TEXTUREACCESS_STREAMING) {
+        data->pitch = texture->w * SDL_BYTESPERPIXEL(texture->format);
+        data->pixels = SDL_calloc(1, (size_t)texture->h * data->pitch);
+        if (!data->pixels) {
+            SDL_free(data);
+            return SDL_OutOfMemory();
+        }
+    }
+    texture->driverdata = data;
+
+    SDL_zero(image_info);
+    image_info.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    image_info.imageType = VK_IMAGE_TYPE_2D;
+    image_info.format = data->format;
+    image_info.extent.width = texture->w;
+    image_info.extent.height = texture->h;
+    image_info.extent.depth = 1;
+    image_info.mipLevels = 1;
+    image_info.arrayLayers = 1;
+    image_info.samples = VK_SAMPLE_COUNT_1_BIT;
+    image_info.tiling = VK_IMAGE_TILING_OPTIMAL;
+    image_info.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+    if (texture->access == SDL_TEXTUREACCESS_TARGET) {
+        image_info.usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+    }
+    image_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    image_info.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    result = renderdata->vkCreateImage(renderdata->device, &image_info, NULL, &data->image);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkCreateImage()", result);
+        goto error;
+    }
+
+    renderdata->vkGetImageMemoryRequirements(renderdata->device, data->image, &requirements);
+    if (VULKAN_AllocateMemory(renderdata, &requirements, 0, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, &data->memory) < 0) {
+        goto error;
+    }
+    result = renderdata->vkBindImageMemory(renderdata->device, data->image, data->memory, 0);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkBindImageMemory()", result);
+        goto error;
+    }
+
+    if (VULKAN_CreateImageView(renderdata, data->image, data->format, opaque, &data->view) < 0) {
+        goto error;
+    }
+    if (opaque && texture->access == SDL_TEXTUREACCESS_TARGET) {
+        /* Render targets can't have a swizzle */
+        if (VULKAN_CreateImageView(renderdata, data->image, data->format, SDL_FALSE, &data->target_view) < 0) {
+            goto error;
+        }
+    }
+
+    /* A descriptor set for each sampler, the one for the scale mode is bound when drawing */
+    if (VULKAN_AllocateDescriptorSets(renderdata, renderdata->texture_layout, 2, data->sets, &data->pool) < 0) {
+        goto error;
+    }
+    for (i = 0; i < 2; ++i) {
+        image_infos[i].sampler = renderdata->samplers[i];
+        image_infos[i].imageView = data->view;
+        image_infos[i].imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+
+        SDL_zero(writes[i]);
+        writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        writes[i].dstSet = data->sets[i];
+        writes[i].dstBinding = 0;
+        writes[i].descriptorCount = 1;
+        writes[i].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        writes[i].pImageInfo = &image_infos[i];
+    }
+    renderdata->vkUpdateDescriptorSets(renderdata->device, 2, writes, 0, NULL);
+
+    /* Clear it, so it has defined contents and can be sampled right away */
+    if (VULKAN_BeginFrame(renderdata) < 0) {
+        goto error;
+    }
+    VULKAN_EndRenderPass(renderdata);
+    VULKAN_TransitionImage(renderdata, data->image, &data->layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    SDL_zero(clear_color);
+    SDL_zero(range);
+    range.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    range.levelCount = 1;
+    range.layerCount = 1;
+    renderdata->vkCmdClearColorImage(renderdata->frames[renderdata->frame].command_buffer, data->image,
+                                     VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, &clear_color, 1, &range);
+    VULKAN_TransitionImage(renderdata, data->image, &data->layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    return 0;
+
+error:
+    VULKAN_DestroyTextureData(renderdata, data);
+    texture->driverdata = NULL;
+    return -1;
+}
+
+/* Copy pixels from a buffer into the texture, outside of the render pass */
+static void VULKAN_CopyToTexture(VULKAN_RenderData *data, VULKAN_TextureData *texturedata,
+                                 VkBuffer buffer, VkDeviceSize offset, const SDL_Rect *rect)
+{
+    VkBufferImageCopy region;
+
+    VULKAN_EndRenderPass(data);
+    VULKAN_TransitionImage(data, texturedata->image, &texturedata->layout, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+
+    SDL_zero(region);
+    region.bufferOffset = offset;
+    region.bufferRowLength = rect->w;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset.x = rect->x;
+    region.imageOffset.y = rect->y;
+    region.imageExtent.width = rect->w;
+    region.imageExtent.height = rect->h;
+    region.imageExtent.depth = 1;
+    data->vkCmdCopyBufferToImage(data->frames[data->frame].command_buffer, buffer, texturedata->image,
+                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    VULKAN_TransitionImage(data, texturedata->image, &texturedata->layout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+/* The pixels are staged in the frame's vertex ring, the copy is recorded without waiting for anything */
+static int VULKAN_UpdateTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                                const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_TextureData *texturedata = (VULKAN_TextureData *)texture->driverdata;
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    VULKAN_Ring *ring;
+    VkDeviceSize offset;
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    if (rect->w <= 0 || rect->h <= 0) {
+        return 0;
+    }
+
+    if (VULKAN_BeginFrame(data) < 0) {
+        return -1;
+    }
+    ring = &data->frames[data->frame].vertices;
+    if (VULKAN_AllocateFromRing(data, ring, length * rect->h, 16, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &offset) < 0) {
+        return -1;
+    }
+
+    dst = ring->buffer.mapping + offset;
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+
+    VULKAN_CopyToTexture(data, texturedata, ring->buffer.buffer, offset, rect);
+    return 0;
+}
+
+static int VULKAN_LockTexture(SDL_Renderer *renderer, SDL_Texture *texture,
+                              const SDL_Rect *rect, void **pixels, int *pitch)
+{
+    VULKAN_TextureData *data = (VULKAN_TextureData *)texture->driverdata;
+
+    data->locked_rect = *rect;
+    *pixels =
+        (void *)((Uint8 *)data->pixels + rect->y * data->pitch +
+                 rect->x * SDL_BYTESPERPIXEL(texture->format));
+    *pitch = data->pitch;
+    return 0;
+}
+
+static void VULKAN_UnlockTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    VULKAN_TextureData *data = (VULKAN_TextureData *)texture->driverdata;
+    const SDL_Rect *rect;
+    void *pixels;
+
+    rect = &data->locked_rect;
+    pixels =
+        (void *)((Uint8 *)data->pixels + rect->y * data->pitch +
+                 rect->x * SDL_BYTESPERPIXEL(texture->format));
+    VULKAN_UpdateTexture(renderer, texture, rect, pixels, data->pitch);
+}
+
+static void VULKAN_SetTextureScaleMode(SDL_Renderer *renderer, SDL_Texture *texture, SDL_ScaleMode scaleMode)
+{
+    VULKAN_RenderData *renderdata = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_TextureData *data = (VULKAN_TextureData *)texture->driverdata;
+
+    data->scale_mode = scaleMode;
+    renderdata->drawstate.texture_set = VK_NULL_HANDLE; /* we trash this state. */
+}
+
+static int VULKAN_SetRenderTarget(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    return 0; /* the render pass for the target is started when something is drawn */
+}
+
+static int VULKAN_QueueNoOp(SDL_Renderer *renderer, SDL_RenderCommand *cmd)
+{
+    return 0; /* nothing to do in this backend, the color is part of the vertices. */
+}
+
+static void VULKAN_GetDrawColor(const SDL_RenderCommand *cmd, SDL_Color *color)
+{
+    color->r = cmd->data.draw.r;
+    color->g = cmd->data.draw.g;
+    color->b = cmd->data.draw.b;
+    color->a = cmd->data.draw.a;
+}
+
+static int VULKAN_QueueDrawPoints(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
+{
+    VULKAN_SolidVertex *verts = (VULKAN_SolidVertex *)SDL_AllocateRenderVertices(renderer, count * sizeof(VULKAN_SolidVertex), 4, &cmd->data.draw.first);
+    SDL_Color color;
+    int i;
+
+    if (!verts) {
+        return -1;
+    }
+
+    VULKAN_GetDrawColor(cmd, &color);
+    cmd->data.draw.count = count;
+    for (i = 0; i < count; i++) {
+        verts[i].x = 0.5f + points[i].x;
+        verts[i].y = 0.5f + points[i].y;
+        verts[i].color = color;
+    }
+
+    return 0;
+}
+
+static int VULKAN_QueueDrawLines(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_FPoint *points, int count)
+{
+    int i;
+    float prevx, prevy;
+    SDL_Color color;
+    VULKAN_SolidVertex *verts = (VULKAN_SolidVertex *)SDL_AllocateRenderVertices(renderer, count * sizeof(VULKAN_SolidVertex), 4, &cmd->data.draw.first);
+
+    if (!verts) {
+        return -1;
+    }
+    VULKAN_GetDrawColor(cmd, &color);
+    cmd->data.draw.count = count;
+
+    /* 0.5f offset to hit the center of the pixel. */
+    prevx = 0.5f + points->x;
+    prevy = 0.5f + points->y;
+    verts[0].x = prevx;
+    verts[0].y = prevy;
+    verts[0].color = color;
+
+    /* bump the end of each line segment out a quarter of a pixel, to provoke
+       the diamond-exit rule. Without this, you won't just drop the last
+       pixel of the last line segment, but you might also drop pixels at the
+       edge of any given line segment along the way too. */
+    for (i = 1; i < count; i++) {
+        const float xstart = prevx;
+        const float ystart = prevy;
+        const float xend = points[i].x + 0.5f; /* 0.5f to hit pixel center. */
+        const float yend = points[i].y + 0.5f;
+        /* bump a little in the direction we are moving in. */
+        const float deltax = xend - xstart;
+        const float deltay = yend - ystart;
+        const float angle = SDL_atan2f(deltay, deltax);
+        prevx = xend + (SDL_cosf(angle) * 0.25f);
+        prevy = yend + (SDL_sinf(angle) * 0.25f);
+        verts[i].x = prevx;
+        verts[i].y = prevy;
+        verts[i].color = color;
+    }
+
+    return 0;
+}
+
+/* The pixels are copied next to the vertices, so they can be uploaded from
+   the same buffer when the queue runs */
+static int VULKAN_QueueUpdateTexture(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                                     const SDL_Rect *rect, const void *pixels, int pitch)
+{
+    const size_t length = (size_t)rect->w * SDL_BYTESPERPIXEL(texture->format);
+    const Uint8 *src = (const Uint8 *)pixels;
+    Uint8 *dst;
+    int row;
+
+    dst = (Uint8 *)SDL_AllocateRenderVertices(renderer, length * rect->h, 16, &cmd->data.update.first);
+    if (!dst) {
+        return -1;
+    }
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, length);
+        dst += length;
+        src += pitch;
+    }
+    return 0;
+}
+
+/* Small meshes are expanded, so consecutive draws can still be combined
+   into a single draw call */
+#define VULKAN_MIN_INDEXED_GEOMETRY 96
+
+static int VULKAN_QueueGeometry(SDL_Renderer *renderer, SDL_RenderCommand *cmd, SDL_Texture *texture,
+                                const float *xy, int xy_stride, const SDL_Color *color, int color_stride, const float *uv, int uv_stride,
+                                int num_vertices, const void *indices, int num_indices, int size_indices,
+                                float scale_x, float scale_y)
+{
+    int i;
+    int count = indices ? num_indices : num_vertices;
+    Uint8 *verts;
+    const size_t sz = texture ? sizeof(VULKAN_TextureVertex) : sizeof(VULKAN_SolidVertex);
+    int index_size = 0;
+
+    size_indices = indices ? size_indices : 0;
+
+    if (size_indices && num_indices >= VULKAN_MIN_INDEXED_GEOMETRY) {
+        /* Keep the indices if the shared vertices make up for their size */
+        const int needed_index_size = (num_vertices <= 0x10000) ? 2 : 4;
+        if ((size_t)num_vertices * sz + (size_t)num_indices * needed_index_size < (size_t)num_indices * sz) {
+            index_size = needed_index_size;
+            count = num_vertices;
+        }
+    }
+
+    verts = (Uint8 *)SDL_AllocateRenderVertices(renderer, count * sz + (size_t)num_indices * index_size, 4, &cmd->data.draw.first);
+    if (!verts) {
+        return -1;
+    }
+
+    cmd->data.draw.count = count;
+
+    if (index_size) {
+        /* The indices go right after the vertices, in the same buffer */
+        void *dst = verts + count * sz;
+
+        cmd->data.draw.indices = cmd->data.draw.first + count * sz;
+        cmd->data.draw.num_indices = num_indices;
+        cmd->data.draw.index_size = index_size;
+
+        if (index_size == size_indices) {
+            SDL_memcpy(dst, indices, (size_t)num_indices * index_size);
+        } else if (index_size == 2) {
+            Uint16 *dst16 = (Uint16 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 4) {
+                    dst16[i] = (Uint16)((const Uint32 *)indices)[i];
+                } else {
+                    dst16[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        } else {
+            Uint32 *dst32 = (Uint32 *)dst;
+            for (i = 0; i < num_indices; i++) {
+                if (size_indices == 2) {
+                    dst32[i] = ((const Uint16 *)indices)[i];
+                } else {
+                    dst32[i] = ((const Uint8 *)indices)[i];
+                }
+            }
+        }
+        size_indices = 0; /* the vertices are queued in order */
+    }
+
+    for (i = 0; i < count; i++) {
+        int j;
+        const float *xy_;
+        VULKAN_SolidVertex *vert = (VULKAN_SolidVertex *)verts;
+        if (size_indices == 4) {
+            j = ((const Uint32 *)indices)[i];
+        } else if (size_indices == 2) {
+            j = ((const Uint16 *)indices)[i];
+        } else if (size_indices == 1) {
+            j = ((const Uint8 *)indices)[i];
+        } else {
+            j = i;
+        }
+
+        xy_ = (const float *)((const char *)xy + j * xy_stride);
+
+        /* The textured vertex starts like the solid one */
+        vert->x = xy_[0] * scale_x;
+        vert->y = xy_[1] * scale_y;
+        vert->color = *(const SDL_Color *)((const char *)color + j * color_stride);
+
+        if (texture) {
+            const float *uv_ = (const float *)((const char *)uv + j * uv_stride);
+            VULKAN_TextureVertex *texvert = (VULKAN_TextureVertex *)verts;
+            texvert->u = uv_[0];
+            texvert->v = uv_[1];
+        }
+        verts += sz;
+    }
+    return 0;
+}
+
+static VkPipeline VULKAN_CreatePipeline(VULKAN_RenderData *data, VULKAN_Shader shader, VkPrimitiveTopology topology,
+                                        SDL_BlendMode blend, VkFormat format)
+{
+    static const VkDynamicState dynamic_states[] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+    VkPipelineShaderStageCreateInfo stages[2];
+    VkVertexInputBindingDescription binding;
+    VkVertexInputAttributeDescription attributes[3];
+    VkPipelineVertexInputStateCreateInfo vertex_input;
+    VkPipelineInputAssemblyStateCreateInfo input_assembly;
+    VkPipelineViewportStateCreateInfo viewport;
+    VkPipelineRasterizationStateCreateInfo rasterization;
+    VkPipelineMultisampleStateCreateInfo multisample;
+    VkPipelineColorBlendAttachmentState blend_attachment;
+    VkPipelineColorBlendStateCreateInfo color_blend;
+    VkPipelineDynamicStateCreateInfo dynamic;
+    VkGraphicsPipelineCreateInfo pipeline_info;
+    VULKAN_Pipeline *pipelines;
+    VkPipeline pipeline;
+    VkResult result;
+
+    SDL_zeroa(stages);
+    stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+    stages[0].module = data->vertex_shaders[shader];
+    stages[0].pName = "main";
+    stages[1].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+    stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+    stages[1].module = data->fragment_shaders[shader];
+    stages[1].pName = "main";
+
+    binding.binding = 0;
+    binding.stride = (shader == VULKAN_SHADER_TEXTURE) ? sizeof(VULKAN_TextureVertex) : sizeof(VULKAN_SolidVertex);
+    binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    attributes[0].location = 0;
+    attributes[0].binding = 0;
+    attributes[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributes[0].offset = offsetof(VULKAN_TextureVertex, x);
+    attributes[1].location = 1;
+    attributes[1].binding = 0;
+    attributes[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+    attributes[1].offset = offsetof(VULKAN_TextureVertex, color);
+    attributes[2].location = 2;
+    attributes[2].binding = 0;
+    attributes[2].format = VK_FORMAT_R32G32_SFLOAT;
+    attributes[2].offset = offsetof(VULKAN_TextureVertex, u);
+
+    SDL_zero(vertex_input);
+    vertex_input.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertex_input.vertexBindingDescriptionCount = 1;
+    vertex_input.pVertexBindingDescriptions = &binding;
+    vertex_input.vertexAttributeDescriptionCount = (shader == VULKAN_SHADER_TEXTURE) ? 3 : 2;
+    vertex_input.pVertexAttributeDescriptions = attributes;
+
+    SDL_zero(input_assembly);
+    input_assembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+    input_assembly.topology = topology;
+
+    SDL_zero(viewport);
+    viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+    viewport.viewportCount = 1;
+    viewport.scissorCount = 1;
+
+    SDL_zero(rasterization);
+    rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+    rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+    rasterization.cullMode = VK_CULL_MODE_NONE;
+    rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    rasterization.lineWidth = 1.0f;
+
+    SDL_zero(multisample);
+    multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+    multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    SDL_zero(blend_attachment);
+    if (blend != SDL_BLENDMODE_NONE) {
+        blend_attachment.blendEnable = VK_TRUE;
+        blend_attachment.srcColorBlendFactor = GetBlendFactor(SDL_GetBlendModeSrcColorFactor(blend));
+        blend_attachment.dstColorBlendFactor = GetBlendFactor(SDL_GetBlendModeDstColorFactor(blend));
+        blend_attachment.colorBlendOp = GetBlendOp(SDL_GetBlendModeColorOperation(blend));
+        blend_attachment.srcAlphaBlendFactor = GetBlendFactor(SDL_GetBlendModeSrcAlphaFactor(blend));
+        blend_attachment.dstAlphaBlendFactor = GetBlendFactor(SDL_GetBlendModeDstAlphaFactor(blend));
+        blend_attachment.alphaBlendOp = GetBlendOp(SDL_GetBlendModeAlphaOperation(blend));
+    }
+    blend_attachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+                                      VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+    SDL_zero(color_blend);
+    color_blend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+    color_blend.attachmentCount = 1;
+    color_blend.pAttachments = &blend_attachment;
+
+    SDL_zero(dynamic);
+    dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamic.dynamicStateCount = SDL_arraysize(dynamic_states);
+    dynamic.pDynamicStates = dynamic_states;
+
+    SDL_zero(pipeline_info);
+    pipeline_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+    pipeline_info.stageCount = SDL_arraysize(stages);
+    pipeline_info.pStages = stages;
+    pipeline_info.pVertexInputState = &vertex_input;
+    pipeline_info.pInputAssemblyState = &input_assembly;
+    pipeline_info.pViewportState = &viewport;
+    pipeline_info.pRasterizationState = &rasterization;
+    pipeline_info.pMultisampleState = &multisample;
+    pipeline_info.pColorBlendState = &color_blend;
+    pipeline_info.pDynamicState = &dynamic;
+    pipeline_info.layout = data->pipeline_layout;
+    pipeline_info.renderPass = VULKAN_GetRenderPass(data, format);
+    if (!pipeline_info.renderPass) {
+        return VK_NULL_HANDLE;
+    }
+
+    pipelines = (VULKAN_Pipeline *)SDL_realloc(data->pipelines, (data->num_pipelines + 1) * sizeof(*pipelines));
+    if (!pipelines) {
+        SDL_OutOfMemory();
+        return VK_NULL_HANDLE;
+    }
+    data->pipelines = pipelines;
+
+    result = data->vkCreateGraphicsPipelines(data->device, data->pipeline_cache, 1, &pipeline_info, NULL, &pipeline);
+    if (result != VK_SUCCESS) {
+        VULKAN_SetError("vkCreateGraphicsPipelines()", result);
+        return VK_NULL_HANDLE;
+    }
+    data->pipeline_cache_dirty = SDL_TRUE;
+
+    pipelines[data->num_pipelines].shader = shader;
+    pipelines[data->num_pipelines].topology = topology;
+    pipelines[data->num_pipelines].blend = blend;
+    pipelines[data->num_pipelines].format = format;
+    pipelines[data->num_pipelines].pipeline = pipeline;
+    ++data->num_pipelines;
+    return pipeline;
+}
+
+static VkPipeline VULKAN_GetPipeline(VULKAN_RenderData *data, VULKAN_Shader shader, VkPrimitiveTopology topology,
+                                     SDL_BlendMode blend, VkFormat format)
+{
+    int i;
+
+    for (i = 0; i < data->num_pipelines; ++i) {
+        const VULKAN_Pipeline *pipeline = &data->pipelines[i];
+        if (pipeline->shader == shader && pipeline->topology == topology &&
+            pipeline->blend == blend && pipeline->format == format) {
+            return pipeline->pipeline;
+        }
+    }
+    return VULKAN_CreatePipeline(data, shader, topology, blend, format);
+}
+
+static SDL_bool VULKAN_SetDrawState(SDL_Renderer *renderer, const SDL_RenderCommand *cmd,
+                                    VULKAN_Shader shader, VkPrimitiveTopology topology)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_Frame *frame = &data->frames[data->frame];
+    const VkCommandBuffer command_buffer = frame->command_buffer;
+    const SDL_Rect *viewport = &data->drawstate.viewport;
+    const SDL_BlendMode blend = cmd->data.draw.blend;
+    VkPipeline pipeline;
+
+    if (viewport->w <= 0 || viewport->h <= 0) {
+        return SDL_FALSE; /* nothing can be drawn */
+    }
+    if (!VULKAN_BeginRenderPass(renderer)) {
+        return SDL_FALSE;
+    }
+
+    if (data->drawstate.viewport_dirty) {
+        VkViewport vkviewport;
+        vkviewport.x = (float)viewport->x;
+        vkviewport.y = (float)viewport->y;
+        vkviewport.width = (float)viewport->w;
+        vkviewport.height = (float)viewport->h;
+        vkviewport.minDepth = 0.0f;
+        vkviewport.maxDepth = 1.0f;
+        data->vkCmdSetViewport(command_buffer, 0, 1, &vkviewport);
+        data->drawstate.viewport_dirty = SDL_FALSE;
+    }
+
+    if (data->drawstate.cliprect_dirty) {
+        SDL_Rect bounds, rect;
+        VkRect2D scissor;
+
+        bounds.x = 0;
+        bounds.y = 0;
+        bounds.w = (int)data->pass_extent.width;
+        bounds.h = (int)data->pass_extent.height;
+        if (data->drawstate.cliprect_enabled) {
+            rect.x = viewport->x + data->drawstate.cliprect.x;
+            rect.y = viewport->y + data->drawstate.cliprect.y;
+            rect.w = data->drawstate.cliprect.w;
+            rect.h = data->drawstate.cliprect.h;
+            if (!SDL_IntersectRect(&rect, &bounds, &rect)) {
+                SDL_zero(rect);
+            }
+        } else {
+            rect = bounds;
+        }
+        scissor.offset.x = rect.x;
+        scissor.offset.y = rect.y;
+        scissor.extent.width = rect.w;
+        scissor.extent.height = rect.h;
+        data->vkCmdSetScissor(command_buffer, 0, 1, &scissor);
+        data->drawstate.cliprect_dirty = SDL_FALSE;
+    }
+
+    if (data->drawstate.uniforms_dirty) {
+        VULKAN_Globals globals;
+        VkDeviceSize offset;
+        Uint32 dynamic_offset;
+
+        /* Map the viewport to clip space, which is top-down like SDL */
+        globals.scale[0] = 2.0f / viewport->w;
+        globals.scale[1] = 2.0f / viewport->h;
+        globals.offset[0] = -1.0f;
+        globals.offset[1] = -1.0f;
+        if (VULKAN_AllocateFromRing(data, &frame->uniforms, sizeof(globals), data->properties.limits.minUniformBufferOffsetAlignment,
+                                    VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, &offset) < 0) {
+            return SDL_FALSE;
+        }
+        SDL_memcpy(frame->uniforms.buffer.mapping + offset, &globals, sizeof(globals));
+        dynamic_offset = (Uint32)offset;
+        data->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data->pipeline_layout,
+                                      VULKAN_GLOBALS_SET, 1, &frame->uniforms.set, 1, &dynamic_offset);
+        data->drawstate.uniforms_dirty = SDL_FALSE;
+    }
+
+    pipeline = VULKAN_GetPipeline(data, shader, topology, blend, data->pass_format);
+    if (!pipeline) {
+        return SDL_FALSE;
+    }
+    if (pipeline != data->drawstate.pipeline) {
+        data->vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        data->drawstate.pipeline = pipeline;
+        if (shader != data->drawstate.shader) {
+            data->drawstate.shader = shader;
+            ++data->stats->shader_changes;
+        }
+        if (blend != data->drawstate.blend) {
+            data->drawstate.blend = blend;
+            ++data->stats->blend_changes;
+        }
+    }
+
+    if (shader == VULKAN_SHADER_TEXTURE) {
+        const VULKAN_TextureData *texturedata = (VULKAN_TextureData *)cmd->data.draw.texture->driverdata;
+        const VkDescriptorSet set = texturedata->sets[texturedata->scale_mode == SDL_ScaleModeNearest ? 0 : 1];
+
+        if (set != data->drawstate.texture_set) {
+            data->vkCmdBindDescriptorSets(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, data->pipeline_layout,
+                                          VULKAN_TEXTURE_SET, 1, &set, 0, NULL);
+            data->drawstate.texture_set = set;
+            ++data->stats->texture_binds;
+        }
+    }
+    return SDL_TRUE;
+}
+
+static void VULKAN_BindVertices(VULKAN_RenderData *data, VkBuffer buffer, VkDeviceSize offset)
+{
+    if (buffer != data->drawstate.vertex_buffer || offset != data->drawstate.vertex_offset) {
+        data->vkCmdBindVertexBuffers(data->frames[data->frame].command_buffer, 0, 1, &buffer, &offset);
+        data->drawstate.vertex_buffer = buffer;
+        data->drawstate.vertex_offset = offset;
+    }
+}
+
+/* Draw color changes don't matter here, the color is part of the vertices */
+static SDL_RenderCommand *VULKAN_NextDrawCommand(SDL_RenderCommand *cmd)
+{
+    for (cmd = cmd->next; cmd; cmd = cmd->next) {
+        if (cmd->command != SDL_RENDERCMD_SETDRAWCOLOR && cmd->command != SDL_RENDERCMD_NO_OP) {
+            break;
+        }
+    }
+    return cmd;
+}
+
+/* Draw a run of points or geometry using the same state, whose vertices
+   follow each other, with one draw call. Returns the last command drawn. */
+static SDL_RenderCommand *VULKAN_DrawArrays(VULKAN_RenderData *data, SDL_RenderCommand *cmd, VULKAN_Shader shader,
+                                            VkBuffer buffer, VkDeviceSize base)
+{
+    const size_t stride = (shader == VULKAN_SHADER_TEXTURE) ? sizeof(VULKAN_TextureVertex) : sizeof(VULKAN_SolidVertex);
+    SDL_RenderCommand *finalcmd = cmd;
+    SDL_RenderCommand *nextcmd;
+    size_t end = cmd->data.draw.first + cmd->data.draw.count * stride;
+
+    /* joined lines can't be concatenated, each is a draw of its own */
+    if (cmd->command != SDL_RENDERCMD_DRAW_LINES) {
+        while ((nextcmd = VULKAN_NextDrawCommand(finalcmd)) != NULL) {
+            if (nextcmd->command != cmd->command) {
+                break; /* can't go any further on this draw call, different render command up next. */
+            } else if (nextcmd->data.draw.index_size) {
+                break; /* can't go any further on this draw call, indexed geometry up next. */
+            } else if (nextcmd->data.draw.texture != cmd->data.draw.texture || nextcmd->data.draw.blend != cmd->data.draw.blend) {
+                break; /* can't go any further on this draw call, different texture/blendmode up next. */
+            } else if (nextcmd->data.draw.first != end) {
+                break; /* can't go any further on this draw call, the vertices aren't next to these. */
+            }
+            end = nextcmd->data.draw.first + nextcmd->data.draw.count * stride;
+            finalcmd = nextcmd;
+        }
+    }
+
+    VULKAN_BindVertices(data, buffer, base + cmd->data.draw.first);
+    data->vkCmdDraw(data->frames[data->frame].command_buffer, (Uint32)((end - cmd->data.draw.first) / stride), 1, 0, 0);
+    return finalcmd;
+}
+
+static void VULKAN_DrawCommands(SDL_Renderer *renderer, SDL_RenderCommand *cmd, VkBuffer buffer, VkDeviceSize base)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    const VkCommandBuffer command_buffer = data->frames[data->frame].command_buffer;
+
+    data->drawstate.target = renderer->target;
+
+    while (cmd) {
+        switch (cmd->command) {
+        case SDL_RENDERCMD_SETDRAWCOLOR: /* the color is part of the vertices */
+            break;
+
+        case SDL_RENDERCMD_SETVIEWPORT:
+        {
+            SDL_Rect *viewport = &data->drawstate.viewport;
+            if (SDL_memcmp(viewport, &cmd->data.viewport.rect, sizeof(cmd->data.viewport.rect)) != 0) {
+                SDL_copyp(viewport, &cmd->data.viewport.rect);
+                data->drawstate.viewport_dirty = SDL_TRUE;
+                data->drawstate.cliprect_dirty = SDL_TRUE;
+                data->drawstate.uniforms_dirty = SDL_TRUE;
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_SETCLIPRECT:
+        {
+            const SDL_Rect *rect = &cmd->data.cliprect.rect;
+            if (data->drawstate.cliprect_enabled != cmd->data.cliprect.enabled) {
+                data->drawstate.cliprect_enabled = cmd->data.cliprect.enabled;
+                data->drawstate.cliprect_dirty = SDL_TRUE;
+            }
+
+            if (SDL_memcmp(&data->drawstate.cliprect, rect, sizeof(*rect)) != 0) {
+                SDL_copyp(&data->drawstate.cliprect, rect);
+                data->drawstate.cliprect_dirty = SDL_TRUE;
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_CLEAR:
+        {
+            if (VULKAN_BeginRenderPass(renderer)) {
+                VkClearAttachment attachment;
+                VkClearRect rect;
+
+                /* The whole target, whatever the clip rectangle */
+                attachment.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+                attachment.colorAttachment = 0;
+                attachment.clearValue.color.float32[0] = cmd->data.color.r * inv255f;
+                attachment.clearValue.color.float32[1] = cmd->data.color.g * inv255f;
+                attachment.clearValue.color.float32[2] = cmd->data.color.b * inv255f;
+                attachment.clearValue.color.float32[3] = cmd->data.color.a * inv255f;
+                rect.rect.offset.x = 0;
+                rect.rect.offset.y = 0;
+                rect.rect.extent = data->pass_extent;
+                rect.baseArrayLayer = 0;
+                rect.layerCount = 1;
+                data->vkCmdClearAttachments(command_buffer, 1, &attachment, 1, &rect);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_DRAW_POINTS:
+        {
+            if (VULKAN_SetDrawState(renderer, cmd, VULKAN_SHADER_SOLID, VK_PRIMITIVE_TOPOLOGY_POINT_LIST)) {
+                cmd = VULKAN_DrawArrays(data, cmd, VULKAN_SHADER_SOLID, buffer, base);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_DRAW_LINES:
+        {
+            if (VULKAN_SetDrawState(renderer, cmd, VULKAN_SHADER_SOLID, VK_PRIMITIVE_TOPOLOGY_LINE_STRIP)) {
+                cmd = VULKAN_DrawArrays(data, cmd, VULKAN_SHADER_SOLID, buffer, base);
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_FILL_RECTS: /* unused, these go through the geometry */
+        case SDL_RENDERCMD_COPY:
+        case SDL_RENDERCMD_COPY_EX:
+            break;
+
+        case SDL_RENDERCMD_GEOMETRY:
+        {
+            const VULKAN_Shader shader = cmd->data.draw.texture ? VULKAN_SHADER_TEXTURE : VULKAN_SHADER_SOLID;
+
+            if (VULKAN_SetDrawState(renderer, cmd, shader, VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)) {
+                if (cmd->data.draw.index_size) {
+                    /* The indices are in the same buffer as the vertices */
+                    const VkIndexType type = (cmd->data.draw.index_size == 4) ? VK_INDEX_TYPE_UINT32 : VK_INDEX_TYPE_UINT16;
+                    VULKAN_BindVertices(data, buffer, base + cmd->data.draw.first);
+                    data->vkCmdBindIndexBuffer(command_buffer, buffer, base + cmd->data.draw.indices, type);
+                    data->vkCmdDrawIndexed(command_buffer, (Uint32)cmd->data.draw.num_indices, 1, 0, 0, 0);
+                } else {
+                    cmd = VULKAN_DrawArrays(data, cmd, shader, buffer, base);
+                }
+            }
+            break;
+        }
+
+        case SDL_RENDERCMD_UPDATE_TEXTURE:
+        {
+            VULKAN_TextureData *texturedata = (VULKAN_TextureData *)cmd->data.update.texture->driverdata;
+            VULKAN_CopyToTexture(data, texturedata, buffer, base + cmd->data.update.first, &cmd->data.update.rect);
+            break;
+        }
+
+        case SDL_RENDERCMD_NO_OP:
+            break;
+        }
+
+        cmd = cmd->next;
+    }
+}
+
+static int VULKAN_RunCommandQueue(SDL_Renderer *renderer, SDL_RenderCommand *cmd, const SDL_RenderVertexBlock *vertices, size_t vertsize)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_Ring *ring;
+    VkDeviceSize base = 0;
+
+    if (VULKAN_BeginFrame(data) < 0) {
+        return -1;
+    }
+
+    /* The vertices go in the frame's ring, which isn't touched again until the frame is done */
+    ring = &data->frames[data->frame].vertices;
+    if (vertsize > 0) {
+        if (VULKAN_AllocateFromRing(data, ring, vertsize, 16, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT, &base) < 0) {
+            return -1;
+        }
+        for (; vertices; vertices = vertices->next) {
+            SDL_memcpy(ring->buffer.mapping + base + vertices->offset, vertices->data, vertices->used);
+        }
+    }
+
+    VULKAN_DrawCommands(renderer, cmd, ring->buffer.buffer, base);
+    return 0;
+}
+
+static int VULKAN_RenderReadPixels(SDL_Renderer *renderer, const SDL_Rect *rect,
+                                   Uint32 pixel_format, void *pixels, int pitch)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VkCommandBuffer command_buffer;
+    VkImage image;
+    VkImageLayout *layout;
+    VkImageLayout restore_layout;
+    Uint32 temp_format;
+    VkDeviceSize size;
+    VkBufferImageCopy region;
+    VkMemoryBarrier barrier;
+    VkResult result;
+
+    if (rect->w == 0 || rect->h == 0) {
+        return 0; /* nothing to do. */
+    }
+
+    if (VULKAN_BeginFrame(data) < 0) {
+        return -1;
+    }
+    VULKAN_EndRenderPass(data);
+    command_buffer = data->frames[data->frame].command_buffer;
+
+    if (renderer->target) {
+        VULKAN_TextureData *texturedata = (VULKAN_TextureData *)renderer->target->driverdata;
+        image = texturedata->image;
+        layout = &texturedata->layout;
+        restore_layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        temp_format = VULKAN_GetPixelFormat(texturedata->format);
+    } else {
+        if (VULKAN_AcquireImage(renderer) < 0) {
+            return -1;
+        }
+        if (!data->image_acquired) {
+            return SDL_SetError("The window has no size");
+        }
+        if (!data->swapchain_readable) {
+            return SDL_SetError("The Vulkan swapchain images can't be read");
+        }
+        image = data->swapchain_images[data->image_index];
+        layout = &data->swapchain_layouts[data->image_index];
+        restore_layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        temp_format = VULKAN_GetPixelFormat(data->swapchain_format);
+    }
+
+    /* Nothing is reading the buffer, we waited for the last readback */
+    size = (VkDeviceSize)rect->w * rect->h * SDL_BYTESPERPIXEL(temp_format);
+    if (size > data->readback.size) {
+        VULKAN_DestroyBuffer(data, &data->readback);
+        if (VULKAN_CreateBuffer(data, size, VK_BUFFER_USAGE_TRANSFER_DST_BIT, &data->readback) < 0) {
+            return -1;
+        }
+    }
+
+    VULKAN_TransitionImage(data, image, layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+    SDL_zero(region);
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset.x = rect->x;
+    region.imageOffset.y = rect->y;
+    region.imageExtent.width = rect->w;
+    region.imageExtent.height = rect->h;
+    region.imageExtent.depth = 1;
+    data->vkCmdCopyImageToBuffer(command_buffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, data->readback.buffer, 1, &region);
+    VULKAN_TransitionImage(data, image, layout, restore_layout);
+
+    SDL_zero(barrier);
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    data->vkCmdPipelineBarrier(command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                               0, 1, &barrier, 0, NULL, 0, NULL);
+
+    /* Everything so far is submitted, the frame carries on recording afterwards */
+    if (VULKAN_SubmitFrame(data, SDL_FALSE) < 0) {
+        return -1;
+    }
+    result = data->vkWaitForFences(data->device, 1, &data->frames[data->frame].fence, VK_TRUE, UINT64_MAX);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkWaitForFences()", result);
+    }
+
+    return SDL_ConvertPixels(rect->w, rect->h,
+                             temp_format, data->readback.mapping, rect->w * SDL_BYTESPERPIXEL(temp_format),
+                             pixel_format, pixels, pitch);
+}
+
+static int VULKAN_RenderPresent(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VkPresentInfoKHR present_info;
+    SDL_bool present;
+    VkResult result;
+    int retval = 0;
+
+    if (VULKAN_BeginFrame(data) < 0) {
+        return -1;
+    }
+    if (VULKAN_AcquireImage(renderer) < 0) {
+        retval = -1;
+    }
+    present = data->image_acquired;
+
+    if (VULKAN_SubmitFrame(data, present) < 0) {
+        return -1;
+    }
+
+    if (present) {
+        SDL_zero(present_info);
+        present_info.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+        present_info.waitSemaphoreCount = 1;
+        present_info.pWaitSemaphores = &data->render_finished[data->image_index];
+        present_info.swapchainCount = 1;
+        present_info.pSwapchains = &data->swapchain;
+        present_info.pImageIndices = &data->image_index;
+        result = data->vkQueuePresentKHR(data->queue, &present_info);
+        data->image_acquired = SDL_FALSE;
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
+            data->recreate_swapchain = SDL_TRUE;
+        } else if (result != VK_SUCCESS) {
+            retval = VULKAN_SetError("vkQueuePresentKHR()", result);
+        }
+    }
+
+    /* The next frame goes in flight alongside this one */
+    data->frame = (data->frame + 1) % VULKAN_FRAMES_IN_FLIGHT;
+    return retval;
+}
+
+/* There's no context to release, this lets the renderer use a render thread */
+static void VULKAN_ReleaseContext(SDL_Renderer *renderer)
+{
+}
+
+static void VULKAN_DestroyTexture(SDL_Renderer *renderer, SDL_Texture *texture)
+{
+    VULKAN_RenderData *renderdata = (VULKAN_RenderData *)renderer->driverdata;
+    VULKAN_TextureData *data = (VULKAN_TextureData *)texture->driverdata;
+
+    if (renderdata->pass_target == texture) {
+        VULKAN_EndRenderPass(renderdata);
+    }
+    if (renderdata->drawstate.target == texture) {
+        renderdata->drawstate.target = NULL;
+    }
+
+    if (!data) {
+        return;
+    }
+    if (renderdata->drawstate.texture_set == data->sets[0] || renderdata->drawstate.texture_set == data->sets[1]) {
+        renderdata->drawstate.texture_set = VK_NULL_HANDLE;
+    }
+    VULKAN_DestroyTextureData(renderdata, data);
+    texture->driverdata = NULL;
+}
+
+typedef struct
+{
+    Uint32 magic;
+    Uint32 length;
+    Uint32 data_crc;
+} VULKAN_PipelineCacheHeader;
+
+static SDL_RWops *VULKAN_OpenPipelineCache(VULKAN_RenderData *data, const char *mode)
+{
+    const char *cache_path = SDL_GetHint(SDL_HINT_RENDER_VULKAN_PIPELINE_CACHE);
+    const char *separator = "/";
+    SDL_RWops *rw;
+    char *path;
+    size_t len;
+
+    if (!cache_path || !*cache_path) {
+        return NULL;
+    }
+    len = SDL_strlen(cache_path);
+    if (cache_path[len - 1] == '/' || cache_path[len - 1] == '\\') {
+        separator = "";
+    }
+    if (SDL_asprintf(&path, "%s%sSDL_vk_%08x_%08x.bin", cache_path, separator,
+                     data->properties.vendorID, data->properties.deviceID) < 0) {
+        return NULL;
+    }
+    rw = SDL_RWFromFile(path, mode);
+    SDL_free(path);
+    return rw;
+}
+
+/* Only use cached data the driver says is its own, some don't check it very well */
+static SDL_bool VULKAN_IsPipelineCacheValid(VULKAN_RenderData *data, const Uint8 *cache, Uint32 length)
+{
+    Uint32 header_length, header_version, vendor_id, device_id;
+
+    if (length < 16 + VK_UUID_SIZE) {
+        return SDL_FALSE;
+    }
+    SDL_memcpy(&header_length, cache, sizeof(Uint32));
+    SDL_memcpy(&header_version, cache + 4, sizeof(Uint32));
+    SDL_memcpy(&vendor_id, cache + 8, sizeof(Uint32));
+    SDL_memcpy(&device_id, cache + 12, sizeof(Uint32));
+    if (header_length < 16 + VK_UUID_SIZE || header_length > length ||
+        header_version != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        vendor_id != data->properties.vendorID ||
+        device_id != data->properties.deviceID ||
+        SDL_memcmp(cache + 16, data->properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+
+static int VULKAN_CreatePipelineCache(VULKAN_RenderData *data)
+{
+    VkPipelineCacheCreateInfo cache_info;
+    VULKAN_PipelineCacheHeader header;
+    void *cache = NULL;
+    SDL_RWops *rw;
+    VkResult result;
+
+    SDL_zero(cache_info);
+    cache_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+
+    rw = VULKAN_OpenPipelineCache(data, "rb");
+    if (rw) {
+        if (SDL_RWread(rw, &header, sizeof(header), 1) == 1 &&
+            header.magic == VULKAN_PIPELINE_CACHE_MAGIC &&
+            header.length > 0) {
+            cache = SDL_malloc(header.length);
+            if (cache && SDL_RWread(rw, cache, header.length, 1) == 1 &&
+                SDL_crc32(0, cache, header.length) == header.data_crc &&
+                VULKAN_IsPipelineCacheValid(data, (const Uint8 *)cache, header.length)) {
+                cache_info.initialDataSize = header.length;
+                cache_info.pInitialData = cache;
+            }
+        }
+        SDL_RWclose(rw);
+    }
+
+    result = data->vkCreatePipelineCache(data->device, &cache_info, NULL, &data->pipeline_cache);
+    if (result != VK_SUCCESS && cache_info.pInitialData) {
+        /* If the driver rejects the data, we start over */
+        cache_info.initialDataSize = 0;
+        cache_info.pInitialData = NULL;
+        result = data->vkCreatePipelineCache(data->device, &cache_info, NULL, &data->pipeline_cache);
+    }
+    SDL_free(cache);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreatePipelineCache()", result);
+    }
+    return 0;
+}
+
+static void VULKAN_SavePipelineCache(VULKAN_RenderData *data)
+{
+    VULKAN_PipelineCacheHeader header;
+    size_t length = 0;
+    void *cache;
+    SDL_RWops *rw;
+
+    if (!data->pipeline_cache_dirty ||
+        data->vkGetPipelineCacheData(data->device, data->pipeline_cache, &length, NULL) != VK_SUCCESS ||
+        length == 0) {
+        return;
+    }
+    cache = SDL_malloc(length);
+    if (!cache) {
+        return;
+    }
+    if (data->vkGetPipelineCacheData(data->device, data->pipeline_cache, &length, cache) == VK_SUCCESS) {
+        rw = VULKAN_OpenPipelineCache(data, "wb");
+        if (rw) {
+            header.magic = VULKAN_PIPELINE_CACHE_MAGIC;
+            header.length = (Uint32)length;
+            header.data_crc = SDL_crc32(0, cache, length);
+            if (SDL_RWwrite(rw, &header, sizeof(header), 1) != 1 ||
+                SDL_RWwrite(rw, cache, length, 1) != 1) {
+                SDL_LogWarn(SDL_LOG_CATEGORY_RENDER, "Couldn't write Vulkan pipeline cache: %s", SDL_GetError());
+            }
+            SDL_RWclose(rw);
+        }
+    }
+    SDL_free(cache);
+}
+
+static void VULKAN_DestroyRenderer(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+
+    if (data) {
+        if (data->device) {
+            int i;
+
+            data->vkDeviceWaitIdle(data->device);
+
+            if (data->pipeline_cache) {
+                VULKAN_SavePipelineCache(data);
+                data->vkDestroyPipelineCache(data->device, data->pipeline_cache, NULL);
+            }
+            for (i = 0; i < data->num_pipelines; ++i) {
+                data->vkDestroyPipeline(data->device, data->pipelines[i].pipeline, NULL);
+            }
+            for (i = 0; i < VULKAN_FRAMES_IN_FLIGHT; ++i) {
+                VULKAN_Frame *frame = &data->frames[i];
+
+                VULKAN_FreeGarbage(data, frame);
+                VULKAN_DestroyBuffer(data, &frame->vertices.buffer);
+                VULKAN_DestroyBuffer(data, &frame->uniforms.buffer);
+                if (frame->fence) {
+                    data->vkDestroyFence(data->device, frame->fence, NULL);
+                }
+                if (frame->image_available) {
+                    data->vkDestroySemaphore(data->device, frame->image_available, NULL);
+                }
+            }
+            VULKAN_DestroyBuffer(data, &data->readback);
+            VULKAN_DestroySwapchainResources(data);
+            if (data->swapchain) {
+                data->vkDestroySwapchainKHR(data->device, data->swapchain, NULL);
+            }
+            for (i = 0; i < data->num_render_passes; ++i) {
+                data->vkDestroyRenderPass(data->device, data->render_passes[i].render_pass, NULL);
+            }
+            /* This frees the descriptor sets too */
+            for (i = 0; i < data->num_descriptor_pools; ++i) {
+                data->vkDestroyDescriptorPool(data->device, data->descriptor_pools[i], NULL);
+            }
+            for (i = 0; i < VULKAN_NUM_SHADERS; ++i) {
+                if (data->vertex_shaders[i]) {
+                    data->vkDestroyShaderModule(data->device, data->vertex_shaders[i], NULL);
+                }
+                if (data->fragment_shaders[i]) {
+                    data->vkDestroyShaderModule(data->device, data->fragment_shaders[i], NULL);
+                }
+            }
+            for (i = 0; i < SDL_arraysize(data->samplers); ++i) {
+                if (data->samplers[i]) {
+                    data->vkDestroySampler(data->device, data->samplers[i], NULL);
+                }
+            }
+            if (data->pipeline_layout) {
+                data->vkDestroyPipelineLayout(data->device, data->pipeline_layout, NULL);
+            }
+            if (data->globals_layout) {
+                data->vkDestroyDescriptorSetLayout(data->device, data->globals_layout, NULL);
+            }
+            if (data->texture_layout) {
+                data->vkDestroyDescriptorSetLayout(data->device, data->texture_layout, NULL);
+            }
+            if (data->command_pool) {
+                data->vkDestroyCommandPool(data->device, data->command_pool, NULL);
+            }
+            data->vkDestroyDevice(data->device, NULL);
+        }
+        if (data->surface) {
+            data->vkDestroySurfaceKHR(data->instance, data->surface, NULL);
+        }
+        if (data->instance) {
+            data->vkDestroyInstance(data->instance, NULL);
+        }
+        SDL_free(data->pipelines);
+        SDL_free(data->descriptor_pools);
+        SDL_free(data);
+    }
+    SDL_free(renderer);
+}
+
+static int VULKAN_SetVSync(SDL_Renderer *renderer, const int vsync)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+
+    data->vsync = vsync ? SDL_TRUE : SDL_FALSE;
+    data->recreate_swapchain = SDL_TRUE;
+
+    if (VULKAN_ChoosePresentMode(data, data->vsync) == VK_PRESENT_MODE_FIFO_KHR) {
+        renderer->info.flags |= SDL_RENDERER_PRESENTVSYNC;
+    } else {
+        renderer->info.flags &= ~SDL_RENDERER_PRESENTVSYNC;
+    }
+    return 0;
+}
+
+static int VULKAN_LoadGlobalFunctions(VULKAN_RenderData *data)
+{
+#define VULKAN_GLOBAL_FUNCTION(name)                                                      \
+    data->name = (PFN_##name)data->vkGetInstanceProcAddr(VK_NULL_HANDLE, #name);          \
+    if (!data->name) {                                                                    \
+        return SDL_SetError("Couldn't load Vulkan function %s", #name);                   \
+    }
+#include "SDL_vulkanfuncs.h"
+    return 0;
+}
+
+static int VULKAN_LoadInstanceFunctions(VULKAN_RenderData *data)
+{
+#define VULKAN_INSTANCE_FUNCTION(name)                                                    \
+    data->name = (PFN_##name)data->vkGetInstanceProcAddr(data->instance, #name);          \
+    if (!data->name) {                                                                    \
+        return SDL_SetError("Couldn't load Vulkan function %s", #name);                   \
+    }
+#include "SDL_vulkanfuncs.h"
+    return 0;
+}
+
+static int VULKAN_LoadDeviceFunctions(VULKAN_RenderData *data)
+{
+#define VULKAN_DEVICE_FUNCTION(name)                                                      \
+    data->name = (PFN_##name)data->vkGetDeviceProcAddr(data->device, #name);              \
+    if (!data->name) {                                                                    \
+        return SDL_SetError("Couldn't load Vulkan function %s", #name);                   \
+    }
+#include "SDL_vulkanfuncs.h"
+    return 0;
+}
+
+static SDL_bool VULKAN_HasInstanceExtension(VULKAN_RenderData *data, const char *name)
+{
+    VkExtensionProperties *extensions;
+    Uint32 count = 0, i;
+    SDL_bool found = SDL_FALSE;
+
+    data->vkEnumerateInstanceExtensionProperties(NULL, &count, NULL);
+    extensions = (VkExtensionProperties *)SDL_malloc(count * sizeof(*extensions));
+    if (!extensions) {
+        return SDL_FALSE;
+    }
+    data->vkEnumerateInstanceExtensionProperties(NULL, &count, extensions);
+    for (i = 0; i < count && !found; ++i) {
+        found = (SDL_strcmp(extensions[i].extensionName, name) == 0) ? SDL_TRUE : SDL_FALSE;
+    }
+    SDL_free(extensions);
+    return found;
+}
+
+static SDL_bool VULKAN_HasDeviceExtension(VULKAN_RenderData *data, VkPhysicalDevice device, const char *name)
+{
+    VkExtensionProperties *extensions;
+    Uint32 count = 0, i;
+    SDL_bool found = SDL_FALSE;
+
+    data->vkEnumerateDeviceExtensionProperties(device, NULL, &count, NULL);
+    extensions = (VkExtensionProperties *)SDL_malloc(count * sizeof(*extensions));
+    if (!extensions) {
+        return SDL_FALSE;
+    }
+    data->vkEnumerateDeviceExtensionProperties(device, NULL, &count, extensions);
+    for (i = 0; i < count && !found; ++i) {
+        found = (SDL_strcmp(extensions[i].extensionName, name) == 0) ? SDL_TRUE : SDL_FALSE;
+    }
+    SDL_free(extensions);
+    return found;
+}
+
+static int VULKAN_CreateInstance(SDL_Renderer *renderer)
+{
+    VULKAN_RenderData *data = (VULKAN_RenderData *)renderer->driverdata;
+    VkApplicationInfo app_info;
+    VkInstanceCreateInfo instance_info;
+    const char **extensions;
+    unsigned int count = 0;
+    VkResult result;
+
+    if (!SDL_Vulkan_GetInstanceExtensions(renderer->window, &count, NULL)) {
+        return -1;
+    }
+    extensions = (const char **)SDL_calloc(count + 1, sizeof(*extensions));
+    if (!extensions) {
+        return SDL_OutOfMemory();
+    }
+    if (!SDL_Vulkan_GetInstanceExtensions(renderer->window, &count, extensions)) {
+        SDL_free(extensions);
+        return -1;
+    }
+
+    SDL_zero(app_info);
+    app_info.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    app_info.pEngineName = "SDL";
+    app_info.apiVersion = VK_API_VERSION_1_0;
+
+    SDL_zero(instance_info);
+    instance_info.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+    instance_info.pApplicationInfo = &app_info;
+    /* Drivers layered on other APIs, like MoltenVK, are only listed if we ask for them */
+    if (VULKAN_HasInstanceExtension(data, VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME)) {
+        extensions[count++] = VK_KHR_PORTABILITY_ENUMERATION_EXTENSION_NAME;
+        instance_info.flags |= VK_INSTANCE_CREATE_ENUMERATE_PORTABILITY_BIT_KHR;
+    }
+    instance_info.enabledExtensionCount = count;
+    instance_info.ppEnabledExtensionNames = extensions;
+    result = data->vkCreateInstance(&instance_info, NULL, &data->instance);
+    SDL_free(extensions);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateInstance()", result);
+    }
+
+    if (VULKAN_LoadInstanceFunctions(data) < 0) {
+        return -1;
+    }
+
+    if (!SDL_Vulkan_CreateSurface(renderer->window, data->instance, &data->surface)) {
+        return -1;
+    }
+    return 0;
+}
+
+/* Pick the device that can present to the window, preferring the dedicated ones */
+static int VULKAN_ChoosePhysicalDevice(VULKAN_RenderData *data)
+{
+    VkPhysicalDevice *devices;
+    VkQueueFamilyProperties *families;
+    Uint32 num_devices = 0, num_families, i, j;
+    int best_score = -1;
+    VkResult result;
+
+    result = data->vkEnumeratePhysicalDevices(data->instance, &num_devices, NULL);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkEnumeratePhysicalDevices()", result);
+    }
+    devices = (VkPhysicalDevice *)SDL_malloc(num_devices * sizeof(*devices) + 1);
+    if (!devices) {
+        return SDL_OutOfMemory();
+    }
+    data->vkEnumeratePhysicalDevices(data->instance, &num_devices, devices);
+
+    for (i = 0; i < num_devices; ++i) {
+        VkPhysicalDeviceProperties properties;
+        int score;
+
+        data->vkGetPhysicalDeviceProperties(devices[i], &properties);
+        switch (properties.deviceType) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+            score = 3;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+            score = 2;
+            break;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+            score = 1;
+            break;
+        default:
+            score = 0;
+            break;
+        }
+        if (score <= best_score || !VULKAN_HasDeviceExtension(data, devices[i], VK_KHR_SWAPCHAIN_EXTENSION_NAME)) {
+            continue;
+        }
+
+        num_families = 0;
+        data->vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &num_families, NULL);
+        families = (VkQueueFamilyProperties *)SDL_malloc(num_families * sizeof(*families) + 1);
+        if (!families) {
+            SDL_free(devices);
+            return SDL_OutOfMemory();
+        }
+        data->vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &num_families, families);
+        for (j = 0; j < num_families; ++j) {
+            VkBool32 supported = VK_FALSE;
+
+            if (!(families[j].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
+                continue;
+            }
+            if (data->vkGetPhysicalDeviceSurfaceSupportKHR(devices[i], j, data->surface, &supported) == VK_SUCCESS && supported) {
+                data->physical_device = devices[i];
+                data->queue_family = j;
+                best_score = score;
+                break;
+            }
+        }
+        SDL_free(families);
+    }
+    SDL_free(devices);
+
+    if (!data->physical_device) {
+        return SDL_SetError("No Vulkan device can render to the window");
+    }
+    data->vkGetPhysicalDeviceProperties(data->physical_device, &data->properties);
+    data->vkGetPhysicalDeviceMemoryProperties(data->physical_device, &data->memory_properties);
+    return 0;
+}
+
+static int VULKAN_CreateDevice(VULKAN_RenderData *data)
+{
+    const float priority = 1.0f;
+    const char *extensions[2];
+    VkDeviceQueueCreateInfo queue_info;
+    VkDeviceCreateInfo device_info;
+    VkResult result;
+
+    SDL_zero(queue_info);
+    queue_info.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+    queue_info.queueFamilyIndex = data->queue_family;
+    queue_info.queueCount = 1;
+    queue_info.pQueuePriorities = &priority;
+
+    SDL_zero(device_info);
+    device_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    device_info.queueCreateInfoCount = 1;
+    device_info.pQueueCreateInfos = &queue_info;
+    extensions[device_info.enabledExtensionCount++] = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    /* This has to be enabled if the device has it */
+    if (VULKAN_HasDeviceExtension(data, data->physical_device, "VK_KHR_portability_subset")) {
+        extensions[device_info.enabledExtensionCount++] = "VK_KHR_portability_subset";
+    }
+    device_info.ppEnabledExtensionNames = extensions;
+    result = data->vkCreateDevice(data->physical_device, &device_info, NULL, &data->device);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateDevice()", result);
+    }
+
+    if (VULKAN_LoadDeviceFunctions(data) < 0) {
+        return -1;
+    }
+    data->vkGetDeviceQueue(data->device, data->queue_family, 0, &data->queue);
+    return 0;
+}
+
+static int VULKAN_CreateShaderModule(VULKAN_RenderData *data, const Uint32 *code, size_t size, VkShaderModule *module)
+{
+    VkShaderModuleCreateInfo module_info;
+    VkResult result;
+
+    SDL_zero(module_info);
+    module_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+    module_info.codeSize = size;
+    module_info.pCode = code;
+    result = data->vkCreateShaderModule(data->device, &module_info, NULL, module);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateShaderModule()", result);
+    }
+    return 0;
+}
+
+/* Everything that doesn't depend on the swapchain */
+static int VULKAN_CreateDeviceResources(VULKAN_RenderData *data)
+{
+    VkCommandPoolCreateInfo pool_info;
+    VkCommandBufferAllocateInfo command_buffer_info;
+    VkFenceCreateInfo fence_info;
+    VkSemaphoreCreateInfo semaphore_info;
+    VkSamplerCreateInfo sampler_info;
+    VkDescriptorSetLayoutBinding binding;
+    VkDescriptorSetLayoutCreateInfo layout_info;
+    VkDescriptorSetLayout set_layouts[2];
+    VkPipelineLayoutCreateInfo pipeline_layout_info;
+    VkResult result;
+    int i;
+
+    SDL_zero(pool_info);
+    pool_info.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    pool_info.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    pool_info.queueFamilyIndex = data->queue_family;
+    result = data->vkCreateCommandPool(data->device, &pool_info, NULL, &data->command_pool);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateCommandPool()", result);
+    }
+
+    SDL_zero(binding);
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+    binding.descriptorCount = 1;
+    binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    SDL_zero(layout_info);
+    layout_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layout_info.bindingCount = 1;
+    layout_info.pBindings = &binding;
+    result = data->vkCreateDescriptorSetLayout(data->device, &layout_info, NULL, &data->globals_layout);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateDescriptorSetLayout()", result);
+    }
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    result = data->vkCreateDescriptorSetLayout(data->device, &layout_info, NULL, &data->texture_layout);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreateDescriptorSetLayout()", result);
+    }
+
+    /* One layout for all the pipelines, so the bound sets stay bound */
+    set_layouts[VULKAN_GLOBALS_SET] = data->globals_layout;
+    set_layouts[VULKAN_TEXTURE_SET] = data->texture_layout;
+    SDL_zero(pipeline_layout_info);
+    pipeline_layout_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipeline_layout_info.setLayoutCount = SDL_arraysize(set_layouts);
+    pipeline_layout_info.pSetLayouts = set_layouts;
+    result = data->vkCreatePipelineLayout(data->device, &pipeline_layout_info, NULL, &data->pipeline_layout);
+    if (result != VK_SUCCESS) {
+        return VULKAN_SetError("vkCreatePipelineLayout()", result);
+    }
+
+    SDL_zero(sampler_info);
+    sampler_info.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    sampler_info.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+    sampler_info.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    sampler_info.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+    for (i = 0; i < SDL_arraysize(data->samplers); ++i) {
+        sampler_info.magFilter = (i == 0) ? VK_FILTER_NEAREST : VK_FILTER_LINEAR;
+        sampler_info.minFilter = sampler_info.magFilter;
+        result = data->vkCreateSampler(data->device, &sampler_info, NULL, &data->samplers[i]);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkCreateSampler()", result);
+        }
+    }
+
+    for (i = 0; i < VULKAN_NUM_SHADERS; ++i) {
+        const Uint32 *code;
+        size_t size;
+
+        VULKAN_GetVertexShader((VULKAN_Shader)i, &code, &size);
+        if (VULKAN_CreateShaderModule(data, code, size, &data->vertex_shaders[i]) < 0) {
+            return -1;
+        }
+        VULKAN_GetFragmentShader((VULKAN_Shader)i, &code, &size);
+        if (VULKAN_CreateShaderModule(data, code, size, &data->fragment_shaders[i]) < 0) {
+            return -1;
+        }
+    }
+
+    if (VULKAN_CreatePipelineCache(data) < 0) {
+        return -1;
+    }
+
+    SDL_zero(command_buffer_info);
+    command_buffer_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+    command_buffer_info.commandPool = data->command_pool;
+    command_buffer_info.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+    command_buffer_info.commandBufferCount = 1;
+    SDL_zero(fence_info);
+    fence_info.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    SDL_zero(semaphore_info);
+    semaphore_info.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    for (i = 0; i < VULKAN_FRAMES_IN_FLIGHT; ++i) {
+        VULKAN_Frame *frame = &data->frames[i];
+
+        result = data->vkAllocateCommandBuffers(data->device, &command_buffer_info, &frame->command_buffer);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkAllocateCommandBuffers()", result);
+        }
+        result = data->vkCreateFence(data->device, &fence_info, NULL, &frame->fence);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkCreateFence()", result);
+        }
+        result = data->vkCreateSemaphore(data->device, &semaphore_info, NULL, &frame->image_available);
+        if (result != VK_SUCCESS) {
+            return VULKAN_SetError("vkCreateSemaphore()", result);
+        }
+        if (VULKAN_CreateRingBuffer(data, &frame->vertices, VULKAN_VERTEX_BUFFER_SIZE, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT) < 0 ||
+            VULKAN_CreateRingBuffer(data, &frame->uniforms, VULKAN_UNIFORM_BUFFER_SIZE, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static SDL_Renderer *VULKAN_CreateRenderer(SDL_Window *window, Uint32 flags)
+{
+    SDL_Renderer *renderer;
+    VULKAN_RenderData *data;
+    Uint32 window_flags;
+    SDL_bool changed_window = SDL_FALSE;
+
+    window_flags = SDL_GetWindowFlags(window);
+    if (!(window_flags & SDL_WINDOW_VULKAN)) {
+        changed_window = SDL_TRUE;
+        if (SDL_RecreateWindow(window, (window_flags & ~(SDL_WINDOW_OPENGL | SDL_WINDOW_METAL)) | SDL_WINDOW_VULKAN) < 0) {
+            goto error;
+        }
+    }
+
+    renderer = (SDL_Renderer *)SDL_calloc(1, sizeof(*renderer));
+    if (!renderer) {
+        SDL_OutOfMemory();
+        goto error;
+    }
+
+    data = (VULKAN_RenderData *)SDL_calloc(1, sizeof(*data));
+    if (!data) {
+        SDL_free(renderer);
+        SDL_OutOfMemory();
+        goto error;
+    }
+
+    renderer->WindowEvent = VULKAN_WindowEvent;
+    renderer->GetOutputSize = VULKAN_GetOutputSize;
+    renderer->SupportsBlendMode = VULKAN_SupportsBlendMode;
+    renderer->CreateTexture = VULKAN_CreateTexture;
+    renderer->UpdateTexture = VULKAN_UpdateTexture;
+    renderer->LockTexture = VULKAN_LockTexture;
+    renderer->UnlockTexture = VULKAN_UnlockTexture;
+    renderer->SetTextureScaleMode = VULKAN_SetTextureScaleMode;
+    renderer->SetRenderTarget = VULKAN_SetRenderTarget;
+    renderer->QueueSetViewport = VULKAN_QueueNoOp;
+    renderer->QueueSetDrawColor = VULKAN_QueueNoOp;
+    renderer->QueueDrawPoints = VULKAN_QueueDrawPoints;
+    renderer->QueueDrawLines = VULKAN_QueueDrawLines;
+    renderer->QueueGeometry = VULKAN_QueueGeometry;
+    renderer->QueueUpdateTexture = VULKAN_QueueUpdateTexture;
+    renderer->RunCommandQueue = VULKAN_RunCommandQueue;
+    renderer->RenderReadPixels = VULKAN_RenderReadPixels;
+    renderer->RenderPresent = VULKAN_RenderPresent;
+    renderer->ReleaseContext = VULKAN_ReleaseContext;
+    renderer->DestroyTexture = VULKAN_DestroyTexture;
+    renderer->DestroyRenderer = VULKAN_DestroyRenderer;
+    renderer->SetVSync = VULKAN_SetVSync;
+    renderer->info = VULKAN_RenderDriver.info;
+    renderer->info.flags = SDL_RENDERER_TARGETTEXTURE;
+    renderer->driverdata = data;
+    data->stats = &renderer->stats;
+    renderer->window = window;
+
+    data->vkGetInstanceProcAddr = (PFN_vkGetInstanceProcAddr)SDL_Vulkan_GetVkGetInstanceProcAddr();
+    if (!data->vkGetInstanceProcAddr ||
+        VULKAN_LoadGlobalFunctions(data) < 0 ||
+        VULKAN_CreateInstance(renderer) < 0 ||
+        VULKAN_ChoosePhysicalDevice(data) < 0 ||
+        VULKAN_CreateDevice(data) < 0 ||
+        VULKAN_CreateDeviceResources(data) < 0) {
+        VULKAN_DestroyRenderer(renderer);
+        goto error;
+    }
+
+    if (data->properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU) {
+        renderer->info.flags |= SDL_RENDERER_ACCELERATED;
+    }
+    renderer->info.max_texture_width = data->properties.limits.maxImageDimension2D;
+    renderer->info.max_texture_height = data->properties.limits.maxImageDimension2D;
+
+    VULKAN_SetVSync(renderer, (flags & SDL_RENDERER_PRESENTVSYNC) ? 1 : 0);
+
+    if (VULKAN_CreateSwapchain(renderer) < 0) {
+        VULKAN_DestroyRenderer(renderer);
+        goto error;
+    }
+    SDL_LogInfo(SDL_LOG_CATEGORY_RENDER, "Vulkan device: %s", data->properties.deviceName);
+
+    return renderer;
+
+error:
+    if (changed_window) {
+        /* Uh oh, better try to put it back... */
+        SDL_RecreateWindow(window, window_flags);
+    }
+    return NULL;
+}
+
+SDL_RenderDriver VULKAN_RenderDriver = {
+    VULKAN_CreateRenderer,
+    { "vulkan",
+      (SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC | SDL_RENDERER_TARGETTEXTURE),
+      4,
+      { SDL_PIXELFORMAT_ARGB8888,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_PIXELFORMAT_RGB888,
+        SDL_PIXELFORMAT_BGR888 },
+      0,
+      0 }
+};
+
+#endif /* SDL_VIDEO_RENDER_VULKAN */
+
+/* vi: set ts=4 sw=4 expandtab: */
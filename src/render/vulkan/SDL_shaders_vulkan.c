@@ -0,0 +1,77 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#if SDL_VIDEO_RENDER_VULKAN
+
+#include "SDL_shaders_vulkan.h"
+
+/* Vulkan shader implementation */
+
+/* The SPIR-V is assembled from SDL_shaders_vulkan_*.spvasm by build-vulkan-shaders.sh */
+
+/* *INDENT-OFF* */ /* clang-format off */
+
+#include "SDL_shaders_vulkan_spirv.h"
+
+/* *INDENT-ON* */ /* clang-format on */
+
+void VULKAN_GetVertexShader(VULKAN_Shader shader, const Uint32 **code, size_t *size)
+{
+    switch (shader) {
+    case VULKAN_SHADER_SOLID:
+        *code = VULKAN_solid_vert_spv;
+        *size = sizeof(VULKAN_solid_vert_spv);
+        break;
+    case VULKAN_SHADER_TEXTURE:
+        *code = VULKAN_texture_vert_spv;
+        *size = sizeof(VULKAN_texture_vert_spv);
+        break;
+    default:
+        SDL_assert(!"Unknown shader");
+        *code = NULL;
+        *size = 0;
+        break;
+    }
+}
+
+void VULKAN_GetFragmentShader(VULKAN_Shader shader, const Uint32 **code, size_t *size)
+{
+    switch (shader) {
+    case VULKAN_SHADER_SOLID:
+        *code = VULKAN_solid_frag_spv;
+        *size = sizeof(VULKAN_solid_frag_spv);
+        break;
+    case VULKAN_SHADER_TEXTURE:
+        *code = VULKAN_texture_frag_spv;
+        *size = sizeof(VULKAN_texture_frag_spv);
+        break;
+    default:
+        SDL_assert(!"Unknown shader");
+        *code = NULL;
+        *size = 0;
+        break;
+    }
+}
+
+#endif /* SDL_VIDEO_RENDER_VULKAN */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,46 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#ifndef SDL_shaders_vulkan_h_
+#define SDL_shaders_vulkan_h_
+
+#include "../../SDL_internal.h"
+
+/* Vulkan shader implementation */
+
+typedef enum
+{
+    VULKAN_SHADER_SOLID,   /* points, lines and untextured geometry */
+    VULKAN_SHADER_TEXTURE, /* textured geometry */
+    VULKAN_NUM_SHADERS
+} VULKAN_Shader;
+
+/* The uniform buffer with the transform is set 0, the texture is set 1 */
+#define VULKAN_GLOBALS_SET 0
+#define VULKAN_TEXTURE_SET 1
+
+/* SPIR-V code for the shaders, the size is in bytes */
+extern void VULKAN_GetVertexShader(VULKAN_Shader shader, const Uint32 **code, size_t *size);
+extern void VULKAN_GetFragmentShader(VULKAN_Shader shader, const Uint32 **code, size_t *size);
+
+#endif /* SDL_shaders_vulkan_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -0,0 +1,23 @@
+#!/bin/bash
+
+set -x
+set -e
+cd `dirname "$0"`
+
+generate_shader()
+{
+    name=$1
+    spirv-as --target-env vulkan1.0 -o ./sdl.spv ./SDL_shaders_vulkan_$name.spvasm || exit $?
+    echo "static const Uint32 VULKAN_${name}_spv[] = {"
+    od -An -v -tx4 -w16 sdl.spv | perl -w -p -e 's/ ([0-9a-f]{8})/ 0x$1,/g; s/\A /  /;'
+    echo "};"
+    rm -f sdl.spv
+}
+
+(
+    echo "/* This file is generated by build-vulkan-shaders.sh, do not edit */"
+    generate_shader solid_vert
+    generate_shader texture_vert
+    generate_shader solid_frag
+    generate_shader texture_frag
+) >./SDL_shaders_vulkan_spirv.h
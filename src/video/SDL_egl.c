@@ -452,6 +452,10 @@ static int SDL_EGL_LoadLibraryInternal(_THIS, const char *egl_path)
     LOAD_FUNC_EGLEXT(eglDupNativeFenceFDANDROID);
     LOAD_FUNC_EGLEXT(eglWaitSyncKHR);
     LOAD_FUNC_EGLEXT(eglClientWaitSyncKHR);
+    LOAD_FUNC(eglQuerySurface);
+    LOAD_FUNC_EGLEXT(eglSwapBuffersWithDamageKHR);
+    LOAD_FUNC_EGLEXT(eglSwapBuffersWithDamageEXT);
+    LOAD_FUNC_EGLEXT(eglSetDamageRegionKHR);
     /* Atomic functions end */
 
     if (path) {
@@ -1163,6 +1167,100 @@ int SDL_EGL_SwapBuffers(_THIS, EGLSurface egl_surface)
     return 0;
 }
 
+/* The damage extensions take x, y, width, height quadruples with the origin
+   at the bottom left of the surface */
+static EGLint *SDL_EGL_ConvertDamageRects(_THIS, EGLSurface egl_surface, const SDL_Rect *rects, int numrects)
+{
+    EGLint height = 0;
+    EGLint *egl_rects;
+    int i;
+
+    if (!_this->egl_data->eglQuerySurface(_this->egl_data->egl_display, egl_surface, EGL_HEIGHT, &height)) {
+        SDL_EGL_SetError("unable to get the surface height", "eglQuerySurface");
+        return NULL;
+    }
+
+    egl_rects = (EGLint *)SDL_malloc(numrects * 4 * sizeof(EGLint));
+    if (!egl_rects) {
+        SDL_OutOfMemory();
+        return NULL;
+    }
+    for (i = 0; i < numrects; ++i) {
+        egl_rects[i * 4 + 0] = rects[i].x;
+        egl_rects[i * 4 + 1] = height - (rects[i].y + rects[i].h);
+        egl_rects[i * 4 + 2] = rects[i].w;
+        egl_rects[i * 4 + 3] = rects[i].h;
+    }
+    return egl_rects;
+}
+
+int SDL_EGL_SwapBuffersWithDamage(_THIS, EGLSurface egl_surface, const SDL_Rect *rects, int numrects)
+{
+    EGLBoolean(EGLAPIENTRY *swap_with_damage)(EGLDisplay, EGLSurface, const EGLint *, EGLint) = NULL;
+    EGLint *egl_rects;
+    EGLBoolean status;
+
+    if (numrects > 0) {
+        if (_this->egl_data->eglSwapBuffersWithDamageKHR &&
+            SDL_EGL_HasExtension(_this, SDL_EGL_DISPLAY_EXTENSION, "EGL_KHR_swap_buffers_with_damage")) {
+            swap_with_damage = _this->egl_data->eglSwapBuffersWithDamageKHR;
+        } else if (_this->egl_data->eglSwapBuffersWithDamageEXT &&
+                   SDL_EGL_HasExtension(_this, SDL_EGL_DISPLAY_EXTENSION, "EGL_EXT_swap_buffers_with_damage")) {
+            swap_with_damage = _this->egl_data->eglSwapBuffersWithDamageEXT;
+        }
+    }
+    if (!swap_with_damage) {
+        return SDL_EGL_SwapBuffers(_this, egl_surface);
+    }
+
+    egl_rects = SDL_EGL_ConvertDamageRects(_this, egl_surface, rects, numrects);
+    if (!egl_rects) {
+        return SDL_EGL_SwapBuffers(_this, egl_surface);
+    }
+    status = swap_with_damage(_this->egl_data->egl_display, egl_surface, egl_rects, numrects);
+    SDL_free(egl_rects);
+    if (!status) {
+        return SDL_EGL_SetError("unable to show color buffer in an OS-native window", "eglSwapBuffersWithDamage");
+    }
+    return 0;
+}
+
+int SDL_EGL_GetBufferAge(_THIS, EGLSurface egl_surface)
+{
+    EGLint age = 0;
+
+    if (!SDL_EGL_HasExtension(_this, SDL_EGL_DISPLAY_EXTENSION, "EGL_EXT_buffer_age") &&
+        !SDL_EGL_HasExtension(_this, SDL_EGL_DISPLAY_EXTENSION, "EGL_KHR_partial_update")) {
+        return 0;
+    }
+    if (!_this->egl_data->eglQuerySurface(_this->egl_data->egl_display, egl_surface, EGL_BUFFER_AGE_EXT, &age)) {
+        return 0;
+    }
+    return age;
+}
+
+int SDL_EGL_SetDamageRegion(_THIS, EGLSurface egl_surface, const SDL_Rect *rects, int numrects)
+{
+    EGLint *egl_rects;
+    EGLBoolean status;
+
+    if (!_this->egl_data->eglSetDamageRegionKHR ||
+        !SDL_EGL_HasExtension(_this, SDL_EGL_DISPLAY_EXTENSION, "EGL_KHR_partial_update")) {
+        return 0;
+    }
+
+    egl_rects = SDL_EGL_ConvertDamageRects(_this, egl_surface, rects, numrects);
+    if (!egl_rects) {
+        return -1;
+    }
+    status = _this->egl_data->eglSetDamageRegionKHR(_this->egl_data->egl_display, egl_surface, egl_rects, numrects);
+    SDL_free(egl_rects);
+    if (!status) {
+        return SDL_EGL_SetError("unable to set the damage region", "eglSetDamageRegionKHR");
+    }
+    return 0;
+}
+
 void SDL_EGL_DeleteContext(_THIS, SDL_GLContext context)
 {
     EGLContext egl_context = (EGLContext)context;
@@ -116,6 +116,18 @@ typedef struct SDL_EGL_VideoData
     EGLint(EGLAPIENTRY *eglClientWaitSyncKHR)(EGLDisplay dpy, EGLSyncKHR sync, EGLint flags, EGLTimeKHR timeout);
 
     /* Atomic functions end */
+
+    /* Damage functions */
+
+    EGLBoolean(EGLAPIENTRY *eglQuerySurface)(EGLDisplay dpy, EGLSurface surface, EGLint attribute, EGLint *value);
+
+    EGLBoolean(EGLAPIENTRY *eglSwapBuffersWithDamageKHR)(EGLDisplay dpy, EGLSurface surface, const EGLint *rects, EGLint n_rects);
+
+    EGLBoolean(EGLAPIENTRY *eglSwapBuffersWithDamageEXT)(EGLDisplay dpy, EGLSurface surface, const EGLint *rects, EGLint n_rects);
+
+    EGLBoolean(EGLAPIENTRY *eglSetDamageRegionKHR)(EGLDisplay dpy, EGLSurface surface, EGLint *rects, EGLint n_rects);
+
+    /* Damage functions end */
 } SDL_EGL_VideoData;
 
 /* OpenGLES functions */
@@ -151,6 +163,9 @@ extern int SDL_EGL_InitializeOffscreen(_THIS, int device);
 extern SDL_GLContext SDL_EGL_CreateContext(_THIS, EGLSurface egl_surface);
 extern int SDL_EGL_MakeCurrent(_THIS, EGLSurface egl_surface, SDL_GLContext context);
 extern int SDL_EGL_SwapBuffers(_THIS, EGLSurface egl_surface);
+extern int SDL_EGL_SwapBuffersWithDamage(_THIS, EGLSurface egl_surface, const SDL_Rect *rects, int numrects);
+extern int SDL_EGL_GetBufferAge(_THIS, EGLSurface egl_surface);
+extern int SDL_EGL_SetDamageRegion(_THIS, EGLSurface egl_surface, const SDL_Rect *rects, int numrects);
 
 /* SDL Error-reporting */
 extern int SDL_EGL_SetErrorEx(const char *message, const char *eglFunctionName, EGLint eglErrorCode);
@@ -165,6 +180,27 @@ extern int SDL_EGL_SetErrorEx(const char *message, const char *eglFunctionName,
         return SDL_EGL_SwapBuffers(_this, ((SDL_WindowData *)window->driverdata)->egl_surface); \
     }
 
+#define SDL_EGL_SwapWindowWithDamage_impl(BACKEND)                                                                  \
+    int                                                                                                             \
+        BACKEND##_GLES_SwapWindowWithDamage(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects)         \
+    {                                                                                                               \
+        return SDL_EGL_SwapBuffersWithDamage(_this, ((SDL_WindowData *)window->driverdata)->egl_surface, rects, numrects); \
+    }
+
+#define SDL_EGL_GetBufferAge_impl(BACKEND)                                                         \
+    int                                                                                            \
+        BACKEND##_GLES_GetBufferAge(_THIS, SDL_Window *window)                                     \
+    {                                                                                              \
+        return SDL_EGL_GetBufferAge(_this, ((SDL_WindowData *)window->driverdata)->egl_surface); \
+    }
+
+#define SDL_EGL_SetDamageRegion_impl(BACKEND)                                                                       \
+    int                                                                                                             \
+        BACKEND##_GLES_SetDamageRegion(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects)             \
+    {                                                                                                               \
+        return SDL_EGL_SetDamageRegion(_this, ((SDL_WindowData *)window->driverdata)->egl_surface, rects, numrects); \
+    }
+
 #define SDL_EGL_MakeCurrent_impl(BACKEND)                                                                                          \
     int                                                                                                                            \
         BACKEND##_GLES_MakeCurrent(_THIS, SDL_Window *window, SDL_GLContext context)                                               \
@@ -262,6 +262,7 @@ struct SDL_VideoDevice
     void (*DestroyWindowFramebuffer) (_THIS, SDL_Window * window);
     void (*OnWindowEnter) (_THIS, SDL_Window * window);
     int (*FlashWindow) (_THIS, SDL_Window * window, SDL_FlashOperation operation);
+    int (*GetWindowPresentFeedback) (_THIS, SDL_Window * window, SDL_WindowPresentFeedback * feedback);
 
     /* * * */
     /*
@@ -286,6 +287,9 @@ struct SDL_VideoDevice
     int (*GL_SetSwapInterval) (_THIS, int interval);
     int (*GL_GetSwapInterval) (_THIS);
     int (*GL_SwapWindow) (_THIS, SDL_Window * window);
+    int (*GL_SwapWindowWithDamage) (_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects);
+    int (*GL_GetBufferAge) (_THIS, SDL_Window * window);
+    int (*GL_SetDamageRegion) (_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects);
     void (*GL_DeleteContext) (_THIS, SDL_GLContext context);
     void (*GL_DefaultProfileConfig) (_THIS, int *mask, int *major, int *minor);
 
@@ -531,6 +535,12 @@ extern int SDL_GetPointDisplayIndex(const SDL_Point *point);
 
 extern int SDL_GL_SwapWindowWithResult(SDL_Window *window);
 
+/* Partial updates of the current window, rectangles are in drawable pixels
+   with the origin at the top left */
+extern int SDL_GL_SwapWindowWithDamage(SDL_Window *window, const SDL_Rect *rects, int numrects);
+extern int SDL_GL_GetBufferAge(SDL_Window *window);
+extern int SDL_GL_SetDamageRegion(SDL_Window *window, const SDL_Rect *rects, int numrects);
+
 #if defined(SDL_VIDEO_DRIVER_X11) || defined(SDL_VIDEO_DRIVER_WAYLAND) || defined(SDL_VIDEO_DRIVER_EMSCRIPTEN)
 const char *SDL_GetCSSCursorName(SDL_SystemCursor id, const char **fallback_name);
 #endif
@@ -2684,6 +2684,12 @@ static SDL_Surface *SDL_CreateWindowFramebuffer(SDL_Window *window)
             attempt_texture_framebuffer = SDL_FALSE;
         }
 #endif
+#ifdef SDL_VIDEO_DRIVER_WAYLAND
+        /* The wl_shm framebuffer hands the pixels to the compositor directly, a renderer only adds an upload. */
+        else if (!hint && (_this->CreateWindowFramebuffer) && (SDL_strcmp(_this->name, "wayland") == 0)) {
+            attempt_texture_framebuffer = SDL_FALSE;
+        }
+#endif
 #if defined(__EMSCRIPTEN__)
         else {
             attempt_texture_framebuffer = SDL_FALSE;
@@ -3035,6 +3041,21 @@ int SDL_FlashWindow(SDL_Window *window, SDL_FlashOperation operation)
     return SDL_Unsupported();
 }
 
+int SDL_GetWindowPresentFeedback(SDL_Window *window, SDL_WindowPresentFeedback *feedback)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!feedback) {
+        return SDL_InvalidParamError("feedback");
+    }
+
+    if (_this->GetWindowPresentFeedback) {
+        return _this->GetWindowPresentFeedback(_this, window, feedback);
+    }
+
+    return SDL_Unsupported();
+}
+
 void SDL_OnWindowShown(SDL_Window *window)
 {
     SDL_OnWindowRestored(window);
@@ -4114,6 +4135,61 @@ void SDL_GL_SwapWindow(SDL_Window *window)
     SDL_GL_SwapWindowWithResult(window);
 }
 
+/* Swap, telling the window system that only these parts of the window changed */
+int SDL_GL_SwapWindowWithDamage(SDL_Window *window, const SDL_Rect *rects, int numrects)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!(window->flags & SDL_WINDOW_OPENGL)) {
+        return SDL_SetError(NOT_AN_OPENGL_WINDOW);
+    }
+
+    if (SDL_GL_GetCurrentWindow() != window) {
+        return SDL_SetError("The specified window has not been made current");
+    }
+
+    if (numrects > 0 && _this->GL_SwapWindowWithDamage) {
+        return _this->GL_SwapWindowWithDamage(_this, window, rects, numrects);
+    }
+    return _this->GL_SwapWindow(_this, window);
+}
+
+/* The number of frames since the back buffer of the current window was
+   presented, or 0 if its contents are unknown */
+int SDL_GL_GetBufferAge(SDL_Window *window)
+{
+    CHECK_WINDOW_MAGIC(window, 0);
+
+    if (!(window->flags & SDL_WINDOW_OPENGL) || SDL_GL_GetCurrentWindow() != window) {
+        return 0;
+    }
+
+    if (_this->GL_GetBufferAge) {
+        return _this->GL_GetBufferAge(_this, window);
+    }
+    return 0;
+}
+
+/* Limit rendering of this frame to parts of the window, this has to be done
+   before drawing and does nothing if the window system doesn't support it */
+int SDL_GL_SetDamageRegion(SDL_Window *window, const SDL_Rect *rects, int numrects)
+{
+    CHECK_WINDOW_MAGIC(window, -1);
+
+    if (!(window->flags & SDL_WINDOW_OPENGL)) {
+        return SDL_SetError(NOT_AN_OPENGL_WINDOW);
+    }
+
+    if (SDL_GL_GetCurrentWindow() != window) {
+        return SDL_SetError("The specified window has not been made current");
+    }
+
+    if (_this->GL_SetDamageRegion) {
+        return _this->GL_SetDamageRegion(_this, window, rects, numrects);
+    }
+    return 0;
+}
+
 void SDL_GL_DeleteContext(SDL_GLContext context)
 {
     if (!_this || !context) {
@@ -27,6 +27,32 @@
 
 #include "yuv2rgb/yuv_rgb.h"
 
+/* The AVX2 kernels are built for AVX2 per function, so they are available
+   for the SDL_HasAVX2() check even when the rest of SDL isn't */
+#if defined(HAVE_IMMINTRIN_H) && !defined(SDL_DISABLE_IMMINTRIN_H)
+#define HAVE_AVX2_INTRINSICS 1
+#endif
+#if defined __clang__
+#if (!__has_attribute(target))
+#undef HAVE_AVX2_INTRINSICS
+#endif
+#if (defined(_MSC_VER) || defined(__SCE__)) && !defined(__AVX2__)
+#undef HAVE_AVX2_INTRINSICS
+#endif
+#elif defined __GNUC__
+#if (__GNUC__ < 4) || (__GNUC__ == 4 && __GNUC_MINOR__ < 9)
+#undef HAVE_AVX2_INTRINSICS
+#endif
+#endif
+
+#ifdef HAVE_AVX2_INTRINSICS
+#if defined(__clang__) || defined(__GNUC__)
+#define SDL_TARGETING_AVX2 __attribute__((target("avx2")))
+#else
+#define SDL_TARGETING_AVX2
+#endif
+#endif
+
 #define SDL_YUV_SD_THRESHOLD 576
 
 static SDL_YUV_CONVERSION_MODE SDL_YUV_ConversionMode = SDL_YUV_CONVERSION_BT601;
@@ -617,6 +643,262 @@ int SDL_ConvertPixels_YUV_to_RGB(int width, int height,
     return SDL_SetError("Unsupported YUV conversion");
 }
 
+/* Source rows are converted to RGB two at a time, since that is the unit the
+   4:2:0 kernels work with, and cached so neighbouring output rows reuse them. */
+typedef struct
+{
+    Uint32 src_format;
+    Uint32 row_format;
+    YCbCrType yuv_type;
+    const Uint8 *y;
+    const Uint8 *u;
+    const Uint8 *v;
+    Uint32 y_stride;
+    Uint32 uv_stride;
+    int src_h;
+    int conv_w;   /* number of converted pixels per row */
+    int offset;   /* first pixel of the source rect within a converted row */
+    int pair[2];  /* row pair held in each slot, or -1 */
+    Uint32 *rows[2];
+} YUVScaleContext;
+
+static SDL_bool IsYUVScaleRowFormat(Uint32 format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_RGBX8888:
+    case SDL_PIXELFORMAT_RGBA8888:
+    case SDL_PIXELFORMAT_BGRX8888:
+    case SDL_PIXELFORMAT_BGRA8888:
+    case SDL_PIXELFORMAT_RGB888:
+    case SDL_PIXELFORMAT_ARGB8888:
+    case SDL_PIXELFORMAT_BGR888:
+    case SDL_PIXELFORMAT_ABGR8888:
+        return SDL_TRUE;
+    default:
+        return SDL_FALSE;
+    }
+}
+
+static const Uint32 *GetYUVScaleRow(YUVScaleContext *ctx, int row)
+{
+    const int pair = row / 2;
+    const int slot = (pair & 1);
+
+    if (ctx->pair[slot] != pair) {
+        const int row0 = pair * 2;
+        const Uint32 height = SDL_min(2, ctx->src_h - row0);
+        const Uint8 *y = ctx->y + row0 * ctx->y_stride;
+        const Uint8 *u, *v;
+        Uint8 *rgb = (Uint8 *)ctx->rows[slot];
+        Uint32 rgb_stride = ctx->conv_w * sizeof(Uint32);
+
+        if (IsPlanar2x2Format(ctx->src_format)) {
+            u = ctx->u + pair * ctx->uv_stride;
+            v = ctx->v + pair * ctx->uv_stride;
+        } else {
+            u = ctx->u + row0 * ctx->uv_stride;
+            v = ctx->v + row0 * ctx->uv_stride;
+        }
+
+        if (!yuv_rgb_sse(ctx->src_format, ctx->row_format, ctx->conv_w, height, y, u, v, ctx->y_stride, ctx->uv_stride, rgb, rgb_stride, ctx->yuv_type) &&
+            !yuv_rgb_lsx(ctx->src_format, ctx->row_format, ctx->conv_w, height, y, u, v, ctx->y_stride, ctx->uv_stride, rgb, rgb_stride, ctx->yuv_type)) {
+            yuv_rgb_std(ctx->src_format, ctx->row_format, ctx->conv_w, height, y, u, v, ctx->y_stride, ctx->uv_stride, rgb, rgb_stride, ctx->yuv_type);
+        }
+        ctx->pair[slot] = pair;
+    }
+    return ctx->rows[slot] + (row & 1) * ctx->conv_w + ctx->offset;
+}
+
+/* Blend two pixels channel-wise, frac is 0..256 */
+static SDL_INLINE Uint32 YUVScale_Lerp(Uint32 a, Uint32 b, Uint32 frac)
+{
+    const Uint32 rb = ((((a & 0x00FF00FF) * (256 - frac)) + ((b & 0x00FF00FF) * frac)) >> 8) & 0x00FF00FF;
+    const Uint32 ag = (((((a >> 8) & 0x00FF00FF) * (256 - frac)) + (((b >> 8) & 0x00FF00FF) * frac))) & 0xFF00FF00;
+    return rb | ag;
+}
+
+static SDL_INLINE Uint32 YUVScale_Average4(Uint32 p1, Uint32 p2, Uint32 p3, Uint32 p4)
+{
+    const Uint32 rb = (((p1 & 0x00FF00FF) + (p2 & 0x00FF00FF) + (p3 & 0x00FF00FF) + (p4 & 0x00FF00FF) + 0x00020002) >> 2) & 0x00FF00FF;
+    const Uint32 ag = ((((p1 >> 8) & 0x00FF00FF) + ((p2 >> 8) & 0x00FF00FF) + ((p3 >> 8) & 0x00FF00FF) + ((p4 >> 8) & 0x00FF00FF) + 0x00020002) << 6) & 0xFF00FF00;
+    return rb | ag;
+}
+
+/* Center-aligned 16.16 source position for a destination pixel, clamped for filtering */
+static SDL_INLINE int YUVScale_LinearPos(int i, int step, int src_nb)
+{
+    Sint64 pos = (Sint64)i * step + (step >> 1) - 0x8000;
+    if (pos < 0) {
+        pos = 0;
+    } else if (pos > ((Sint64)(src_nb - 1) << 16)) {
+        pos = ((Sint64)(src_nb - 1) << 16);
+    }
+    return (int)pos;
+}
+
+/*
+ * Convert a YUV image to RGB and resample it to the destination size in one
+ * pass, without ever holding a full resolution RGB copy of the source.
+ * 2:1 downscales with linear filtering become a 2x2 box filter and 1:2
+ * upscales with nearest sampling become pixel doubling.
+ */
+int SDL_ConvertPixels_YUV_to_RGB_Scaled(int src_w, int src_h, Uint32 src_format, const void *src, int src_pitch,
+                                        const SDL_Rect *srcrect, int dst_w, int dst_h, Uint32 dst_format, void *dst, int dst_pitch,
+                                        SDL_bool nearest)
+{
+    YUVScaleContext ctx;
+    SDL_Rect rect;
+    Uint32 *rowbuf = NULL;
+    Uint32 *tmp = NULL;
+    Uint8 *dst_row;
+    int x, j, x0;
+    int ret = 0;
+
+    if (srcrect) {
+        rect = *srcrect;
+    } else {
+        rect.x = 0;
+        rect.y = 0;
+        rect.w = src_w;
+        rect.h = src_h;
+    }
+    if (rect.x < 0 || rect.y < 0 || rect.w <= 0 || rect.h <= 0 ||
+        (rect.x + rect.w) > src_w || (rect.y + rect.h) > src_h) {
+        return SDL_InvalidParamError("srcrect");
+    }
+    if (dst_w <= 0 || dst_h <= 0) {
+        return 0;
+    }
+
+    if (rect.x == 0 && rect.y == 0 && rect.w == src_w && rect.h == src_h &&
+        dst_w == src_w && dst_h == src_h) {
+        return SDL_ConvertPixels_YUV_to_RGB(src_w, src_h, src_format, src, src_pitch, dst_format, dst, dst_pitch);
+    }
+
+    SDL_zero(ctx);
+    ctx.src_format = src_format;
+    ctx.src_h = src_h;
+    if (GetYUVPlanes(src_w, src_h, src_format, src, src_pitch, &ctx.y, &ctx.u, &ctx.v, &ctx.y_stride, &ctx.uv_stride) < 0) {
+        return -1;
+    }
+    if (GetYUVConversionType(src_w, src_h, &ctx.yuv_type) < 0) {
+        return -1;
+    }
+
+    /* Start conversion on an even column so the chroma samples line up */
+    x0 = (rect.x & ~1);
+    ctx.conv_w = (rect.x + rect.w) - x0;
+    ctx.offset = rect.x - x0;
+    if (IsPacked4Format(src_format)) {
+        ctx.y += x0 * 2;
+        ctx.u += x0 * 2;
+        ctx.v += x0 * 2;
+    } else if (src_format == SDL_PIXELFORMAT_NV12 || src_format == SDL_PIXELFORMAT_NV21) {
+        ctx.y += x0;
+        ctx.u += x0;
+        ctx.v += x0;
+    } else {
+        ctx.y += x0;
+        ctx.u += x0 / 2;
+        ctx.v += x0 / 2;
+    }
+
+    /* Rows are filtered in a 32-bit format, converting afterwards if the destination isn't one */
+    if (IsYUVScaleRowFormat(dst_format)) {
+        ctx.row_format = dst_format;
+    } else {
+        ctx.row_format = SDL_PIXELFORMAT_ARGB8888;
+        tmp = (Uint32 *)SDL_malloc(dst_w * sizeof(Uint32));
+        if (!tmp) {
+            return SDL_OutOfMemory();
+        }
+    }
+
+    rowbuf = (Uint32 *)SDL_malloc(4 * ctx.conv_w * sizeof(Uint32));
+    if (!rowbuf) {
+        SDL_free(tmp);
+        return SDL_OutOfMemory();
+    }
+    ctx.rows[0] = rowbuf;
+    ctx.rows[1] = rowbuf + 2 * ctx.conv_w;
+    ctx.pair[0] = -1;
+    ctx.pair[1] = -1;
+
+    dst_row = (Uint8 *)dst;
+
+#define YUV_SCALE_EMIT_ROW(out)                                                                   \
+    if (tmp) {                                                                                    \
+        ret = SDL_ConvertPixels(dst_w, 1, SDL_PIXELFORMAT_ARGB8888, tmp, dst_w * sizeof(Uint32), \
+                                dst_format, dst_row, dst_pitch);                                  \
+        if (ret < 0) {                                                                            \
+            break;                                                                                \
+        }                                                                                         \
+    }                                                                                             \
+    dst_row += dst_pitch;
+
+    if (!nearest && rect.w == dst_w * 2 && rect.h == dst_h * 2) {
+        /* Exact 2:1 downscale, each destination pixel is the average of a 2x2 block */
+        for (j = 0; j < dst_h; ++j) {
+            const Uint32 *s0 = GetYUVScaleRow(&ctx, rect.y + 2 * j);
+            const Uint32 *s1 = GetYUVScaleRow(&ctx, rect.y + 2 * j + 1);
+            Uint32 *out = tmp ? tmp : (Uint32 *)dst_row;
+            for (x = 0; x < dst_w; ++x) {
+                out[x] = YUVScale_Average4(s0[2 * x], s0[2 * x + 1], s1[2 * x], s1[2 * x + 1]);
+            }
+            YUV_SCALE_EMIT_ROW(out)
+        }
+    } else if (nearest && dst_w == rect.w * 2 && dst_h == rect.h * 2) {
+        /* Exact 1:2 upscale, each source pixel is doubled in both directions */
+        for (j = 0; j < dst_h; ++j) {
+            const Uint32 *s = GetYUVScaleRow(&ctx, rect.y + j / 2);
+            Uint32 *out = tmp ? tmp : (Uint32 *)dst_row;
+            for (x = 0; x < rect.w; ++x) {
+                out[2 * x] = out[2 * x + 1] = s[x];
+            }
+            YUV_SCALE_EMIT_ROW(out)
+        }
+    } else if (nearest) {
+        const int step_x = (int)(((Sint64)rect.w << 16) / dst_w);
+        const int step_y = (int)(((Sint64)rect.h << 16) / dst_h);
+        int pos_y = step_y >> 1;
+        for (j = 0; j < dst_h; ++j, pos_y += step_y) {
+            const Uint32 *s = GetYUVScaleRow(&ctx, rect.y + (pos_y >> 16));
+            Uint32 *out = tmp ? tmp : (Uint32 *)dst_row;
+            int pos_x = step_x >> 1;
+            for (x = 0; x < dst_w; ++x, pos_x += step_x) {
+                out[x] = s[pos_x >> 16];
+            }
+            YUV_SCALE_EMIT_ROW(out)
+        }
+    } else {
+        const int step_x = (int)(((Sint64)rect.w << 16) / dst_w);
+        const int step_y = (int)(((Sint64)rect.h << 16) / dst_h);
+        for (j = 0; j < dst_h; ++j) {
+            const int pos_y = YUVScale_LinearPos(j, step_y, rect.h);
+            const int sy = (pos_y >> 16);
+            const Uint32 frac_y = (pos_y & 0xFFFF) >> 8;
+            const Uint32 *s0 = GetYUVScaleRow(&ctx, rect.y + sy);
+            const Uint32 *s1 = GetYUVScaleRow(&ctx, rect.y + SDL_min(sy + 1, rect.h - 1));
+            Uint32 *out = tmp ? tmp : (Uint32 *)dst_row;
+            for (x = 0; x < dst_w; ++x) {
+                const int pos_x = YUVScale_LinearPos(x, step_x, rect.w);
+                const int sx = (pos_x >> 16);
+                const int sx1 = SDL_min(sx + 1, rect.w - 1);
+                const Uint32 frac_x = (pos_x & 0xFFFF) >> 8;
+                const Uint32 top = YUVScale_Lerp(s0[sx], s0[sx1], frac_x);
+                const Uint32 bottom = YUVScale_Lerp(s1[sx], s1[sx1], frac_x);
+                out[x] = YUVScale_Lerp(top, bottom, frac_y);
+            }
+            YUV_SCALE_EMIT_ROW(out)
+        }
+    }
+#undef YUV_SCALE_EMIT_ROW
+
+    SDL_free(rowbuf);
+    SDL_free(tmp);
+    return ret;
+}
+
 struct RGB2YUVFactors
 {
     int y_offset;
@@ -1049,6 +1331,172 @@ static int SDL_ConvertPixels_YUV_to_YUV_Copy(int width, int height, Uint32 forma
     return SDL_SetError("SDL_ConvertPixels_YUV_to_YUV_Copy: Unsupported YUV format: %s", SDL_GetPixelFormatName(format));
 }
 
+#ifdef HAVE_AVX2_INTRINSICS
+/* The row kernels return how many pixels they handled, the caller finishes the row */
+static int SDL_TARGETING_AVX2 SDL_SwapUVRow_AVX2(Uint8 *uv1, Uint8 *uv2, int width)
+{
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i a = _mm256_loadu_si256((__m256i *)(uv1 + x));
+        __m256i b = _mm256_loadu_si256((__m256i *)(uv2 + x));
+        _mm256_storeu_si256((__m256i *)(uv1 + x), b);
+        _mm256_storeu_si256((__m256i *)(uv2 + x), a);
+    }
+    return x;
+}
+
+static int SDL_TARGETING_AVX2 SDL_PackUVRow_AVX2(const Uint8 *src1, const Uint8 *src2, Uint8 *dstUV, int width)
+{
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i u = _mm256_permute4x64_epi64(_mm256_loadu_si256((__m256i *)(src1 + x)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i v = _mm256_permute4x64_epi64(_mm256_loadu_si256((__m256i *)(src2 + x)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i uv1 = _mm256_unpacklo_epi8(u, v);
+        __m256i uv2 = _mm256_unpackhi_epi8(u, v);
+        _mm256_storeu_si256((__m256i *)(dstUV + 2 * x), uv1);
+        _mm256_storeu_si256((__m256i *)(dstUV + 2 * x + 32), uv2);
+    }
+    return x;
+}
+
+static int SDL_TARGETING_AVX2 SDL_SplitUVRow_AVX2(const Uint8 *srcUV, Uint8 *dst1, Uint8 *dst2, int width)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i uv1 = _mm256_loadu_si256((__m256i *)(srcUV + 2 * x));
+        __m256i uv2 = _mm256_loadu_si256((__m256i *)(srcUV + 2 * x + 32));
+        __m256i u1 = _mm256_and_si256(uv1, mask);
+        __m256i u2 = _mm256_and_si256(uv2, mask);
+        __m256i u = _mm256_permute4x64_epi64(_mm256_packus_epi16(u1, u2), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i v1 = _mm256_srli_epi16(uv1, 8);
+        __m256i v2 = _mm256_srli_epi16(uv2, 8);
+        __m256i v = _mm256_permute4x64_epi64(_mm256_packus_epi16(v1, v2), _MM_SHUFFLE(3, 1, 2, 0));
+        _mm256_storeu_si256((__m256i *)(dst1 + x), u);
+        _mm256_storeu_si256((__m256i *)(dst2 + x), v);
+    }
+    return x;
+}
+
+static int SDL_TARGETING_AVX2 SDL_SwapNVRow_AVX2(const Uint16 *srcUV, Uint16 *dstUV, int width)
+{
+    int x = 0;
+
+    for (; x + 16 <= width; x += 16) {
+        __m256i uv = _mm256_loadu_si256((__m256i *)(srcUV + x));
+        __m256i v = _mm256_slli_epi16(uv, 8);
+        __m256i u = _mm256_srli_epi16(uv, 8);
+        _mm256_storeu_si256((__m256i *)(dstUV + x), _mm256_or_si256(v, u));
+    }
+    return x;
+}
+
+/* Reorders the bytes of each 4 byte YUV pair, width is in pairs */
+static int SDL_TARGETING_AVX2 SDL_Packed4Row_AVX2(const Uint8 *srcYUV, Uint8 *dstYUV, int width, int i0, int i1, int i2, int i3)
+{
+    const __m256i shuffle = _mm256_broadcastsi128_si256(_mm_setr_epi8(
+        (char)i0, (char)i1, (char)i2, (char)i3, (char)(4 + i0), (char)(4 + i1), (char)(4 + i2), (char)(4 + i3),
+        (char)(8 + i0), (char)(8 + i1), (char)(8 + i2), (char)(8 + i3), (char)(12 + i0), (char)(12 + i1), (char)(12 + i2), (char)(12 + i3)));
+    int x = 0;
+
+    for (; x + 8 <= width; x += 8) {
+        __m256i yuv = _mm256_loadu_si256((__m256i *)(srcYUV + 4 * x));
+        _mm256_storeu_si256((__m256i *)(dstYUV + 4 * x), _mm256_shuffle_epi8(yuv, shuffle));
+    }
+    return x;
+}
+
+/* Interleaves two rows of Y with the U and V samples they share, dst1 and dst2 point
+   at the start of the packed 4 byte groups and width is in pixels */
+static int SDL_TARGETING_AVX2 SDL_Planar2x2ToPacked4Rows_AVX2(const Uint8 *srcY1, const Uint8 *srcY2, const Uint8 *srcU, const Uint8 *srcV, int srcUV_pixel_stride,
+                                                              Uint8 *dst1, Uint8 *dst2, int dstY_offset, SDL_bool dstU_first, int width)
+{
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i y1 = _mm256_loadu_si256((__m256i *)(srcY1 + x));
+        __m256i y2 = _mm256_loadu_si256((__m256i *)(srcY2 + x));
+        __m256i uv, lo1, hi1, lo2, hi2;
+
+        if (srcUV_pixel_stride == 1) {
+            __m128i u = _mm_loadu_si128((__m128i *)(srcU + x / 2));
+            __m128i v = _mm_loadu_si128((__m128i *)(srcV + x / 2));
+            __m128i first = dstU_first ? u : v;
+            __m128i second = dstU_first ? v : u;
+            uv = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi8(first, second)), _mm_unpackhi_epi8(first, second), 1);
+        } else {
+            uv = _mm256_loadu_si256((__m256i *)(((srcU < srcV) ? srcU : srcV) + x));
+            if ((srcU < srcV) != dstU_first) {
+                uv = _mm256_or_si256(_mm256_slli_epi16(uv, 8), _mm256_srli_epi16(uv, 8));
+            }
+        }
+
+        /* The unpacks work within each 128-bit lane, so the halves come out interleaved */
+        if (dstY_offset == 0) {
+            lo1 = _mm256_unpacklo_epi8(y1, uv);
+            hi1 = _mm256_unpackhi_epi8(y1, uv);
+            lo2 = _mm256_unpacklo_epi8(y2, uv);
+            hi2 = _mm256_unpackhi_epi8(y2, uv);
+        } else {
+            lo1 = _mm256_unpacklo_epi8(uv, y1);
+            hi1 = _mm256_unpackhi_epi8(uv, y1);
+            lo2 = _mm256_unpacklo_epi8(uv, y2);
+            hi2 = _mm256_unpackhi_epi8(uv, y2);
+        }
+        _mm256_storeu_si256((__m256i *)(dst1 + 2 * x), _mm256_permute2x128_si256(lo1, hi1, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst1 + 2 * x + 32), _mm256_permute2x128_si256(lo1, hi1, 0x31));
+        _mm256_storeu_si256((__m256i *)(dst2 + 2 * x), _mm256_permute2x128_si256(lo2, hi2, 0x20));
+        _mm256_storeu_si256((__m256i *)(dst2 + 2 * x + 32), _mm256_permute2x128_si256(lo2, hi2, 0x31));
+    }
+    return x;
+}
+
+/* Splits two rows of packed 4 byte groups into Y and the average of their U and V,
+   src1 and src2 point at the start of the groups and width is in pixels */
+static int SDL_TARGETING_AVX2 SDL_Packed4ToPlanar2x2Rows_AVX2(const Uint8 *src1, const Uint8 *src2, int srcY_offset, SDL_bool srcU_first,
+                                                              Uint8 *dstY1, Uint8 *dstY2, Uint8 *dstU, Uint8 *dstV, int dstUV_pixel_stride, int width)
+{
+    const __m256i mask = _mm256_set1_epi16(0x00FF);
+    const __m256i one = _mm256_set1_epi8(1);
+    int x = 0;
+
+    for (; x + 32 <= width; x += 32) {
+        __m256i a1 = _mm256_loadu_si256((__m256i *)(src1 + 2 * x));
+        __m256i b1 = _mm256_loadu_si256((__m256i *)(src1 + 2 * x + 32));
+        __m256i a2 = _mm256_loadu_si256((__m256i *)(src2 + 2 * x));
+        __m256i b2 = _mm256_loadu_si256((__m256i *)(src2 + 2 * x + 32));
+        /* The packs work within each 128-bit lane, put the 64-bit chunks back in order */
+        __m256i even1 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a1, mask), _mm256_and_si256(b1, mask)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i odd1 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a1, 8), _mm256_srli_epi16(b1, 8)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i even2 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(a2, mask), _mm256_and_si256(b2, mask)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i odd2 = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(a2, 8), _mm256_srli_epi16(b2, 8)), _MM_SHUFFLE(3, 1, 2, 0));
+        __m256i uv1 = srcY_offset ? even1 : odd1;
+        __m256i uv2 = srcY_offset ? even2 : odd2;
+        /* Truncating average, to match the scalar code */
+        __m256i uv = _mm256_sub_epi8(_mm256_avg_epu8(uv1, uv2), _mm256_and_si256(_mm256_xor_si256(uv1, uv2), one));
+
+        _mm256_storeu_si256((__m256i *)(dstY1 + x), srcY_offset ? odd1 : even1);
+        _mm256_storeu_si256((__m256i *)(dstY2 + x), srcY_offset ? odd2 : even2);
+
+        if (dstUV_pixel_stride == 2) {
+            if (srcU_first != (dstU < dstV)) {
+                uv = _mm256_or_si256(_mm256_slli_epi16(uv, 8), _mm256_srli_epi16(uv, 8));
+            }
+            _mm256_storeu_si256((__m256i *)(((dstU < dstV) ? dstU : dstV) + x), uv);
+        } else {
+            __m256i first = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_and_si256(uv, mask), _mm256_setzero_si256()), _MM_SHUFFLE(3, 1, 2, 0));
+            __m256i second = _mm256_permute4x64_epi64(_mm256_packus_epi16(_mm256_srli_epi16(uv, 8), _mm256_setzero_si256()), _MM_SHUFFLE(3, 1, 2, 0));
+            _mm_storeu_si128((__m128i *)(dstU + x / 2), _mm256_castsi256_si128(srcU_first ? first : second));
+            _mm_storeu_si128((__m128i *)(dstV + x / 2), _mm256_castsi256_si128(srcU_first ? second : first));
+        }
+    }
+    return x;
+}
+#endif /* HAVE_AVX2_INTRINSICS */
+
 static int SDL_ConvertPixels_SwapUVPlanes(int width, int height, const void *src, int src_pitch, void *dst, int dst_pitch)
 {
     int y;
@@ -1061,23 +1509,65 @@ static int SDL_ConvertPixels_SwapUVPlanes(int width, int height, const void *src
 
     if (src == dst) {
         int UVpitch = (dst_pitch + 1) / 2;
-        Uint8 *tmp;
         Uint8 *row1 = dst;
         Uint8 *row2 = (Uint8 *)dst + UVheight * UVpitch;
+#ifdef HAVE_AVX2_INTRINSICS
+        const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
+#ifdef __SSE2__
+        const SDL_bool use_SSE2 = SDL_HasSSE2();
+#endif
+#ifdef __ARM_NEON
+        const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
-        /* Allocate a temporary row for the swap */
-        tmp = (Uint8 *)SDL_malloc(UVwidth);
-        if (!tmp) {
-            return SDL_OutOfMemory();
-        }
+        /* Swap the planes a row at a time through registers */
         for (y = 0; y < UVheight; ++y) {
-            SDL_memcpy(tmp, row1, UVwidth);
-            SDL_memcpy(row1, row2, UVwidth);
-            SDL_memcpy(row2, tmp, UVwidth);
+            Uint8 *uv1 = row1;
+            Uint8 *uv2 = row2;
+            int x = UVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+            if (use_AVX2) {
+                const int n = SDL_SwapUVRow_AVX2(uv1, uv2, x);
+                uv1 += n;
+                uv2 += n;
+                x -= n;
+            }
+#endif
+#ifdef __SSE2__
+            if (use_SSE2) {
+                while (x >= 16) {
+                    __m128i a = _mm_loadu_si128((__m128i *)uv1);
+                    __m128i b = _mm_loadu_si128((__m128i *)uv2);
+                    _mm_storeu_si128((__m128i *)uv1, b);
+                    _mm_storeu_si128((__m128i *)uv2, a);
+                    uv1 += 16;
+                    uv2 += 16;
+                    x -= 16;
+                }
+            }
+#endif
+#ifdef __ARM_NEON
+            if (use_NEON) {
+                while (x >= 16) {
+                    uint8x16_t a = vld1q_u8(uv1);
+                    uint8x16_t b = vld1q_u8(uv2);
+                    vst1q_u8(uv1, b);
+                    vst1q_u8(uv2, a);
+                    uv1 += 16;
+                    uv2 += 16;
+                    x -= 16;
+                }
+            }
+#endif
+            while (x--) {
+                Uint8 tmp = *uv1;
+                *uv1++ = *uv2;
+                *uv2++ = tmp;
+            }
             row1 += UVpitch;
             row2 += UVpitch;
         }
-        SDL_free(tmp);
     } else {
         const Uint8 *srcUV;
         Uint8 *dstUV;
@@ -1116,9 +1606,15 @@ static int SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const voi
     const Uint8 *src1, *src2;
     Uint8 *dstUV;
     Uint8 *tmp = NULL;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1146,6 +1642,15 @@ static int SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const voi
     y = UVheight;
     while (y--) {
         x = UVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            const int n = SDL_PackUVRow_AVX2(src1, src2, dstUV, x);
+            src1 += n;
+            src2 += n;
+            dstUV += 2 * n;
+            x -= n;
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             while (x >= 16) {
@@ -1161,6 +1666,20 @@ static int SDL_ConvertPixels_PackUVPlanes_to_NV(int width, int height, const voi
                 x -= 16;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 16) {
+                uint8x16x2_t uv;
+                uv.val[0] = vld1q_u8(src1);
+                uv.val[1] = vld1q_u8(src2);
+                vst2q_u8(dstUV, uv);
+                src1 += 16;
+                src2 += 16;
+                dstUV += 32;
+                x -= 16;
+            }
+        }
 #endif
         while (x--) {
             *dstUV++ = *src1++;
@@ -1189,9 +1708,15 @@ static int SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const vo
     const Uint8 *srcUV;
     Uint8 *dst1, *dst2;
     Uint8 *tmp = NULL;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1219,6 +1744,15 @@ static int SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const vo
     y = UVheight;
     while (y--) {
         x = UVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            const int n = SDL_SplitUVRow_AVX2(srcUV, dst1, dst2, x);
+            srcUV += 2 * n;
+            dst1 += n;
+            dst2 += n;
+            x -= n;
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             __m128i mask = _mm_set1_epi16(0x00FF);
@@ -1239,6 +1773,19 @@ static int SDL_ConvertPixels_SplitNV_to_UVPlanes(int width, int height, const vo
                 x -= 16;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 16) {
+                uint8x16x2_t uv = vld2q_u8(srcUV);
+                vst1q_u8(dst1, uv.val[0]);
+                vst1q_u8(dst2, uv.val[1]);
+                srcUV += 32;
+                dst1 += 16;
+                dst2 += 16;
+                x -= 16;
+            }
+        }
 #endif
         while (x--) {
             *dst1++ = *srcUV++;
@@ -1266,9 +1813,15 @@ static int SDL_ConvertPixels_SwapNV(int width, int height, const void *src, int
     const int dstUVPitchLeft = (dstUVPitch - UVwidth * 2) / sizeof(Uint16);
     const Uint16 *srcUV;
     Uint16 *dstUV;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     /* Skip the Y plane */
     src = (const Uint8 *)src + height * src_pitch;
@@ -1279,6 +1832,14 @@ static int SDL_ConvertPixels_SwapNV(int width, int height, const void *src, int
     y = UVheight;
     while (y--) {
         x = UVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            const int n = SDL_SwapNVRow_AVX2(srcUV, dstUV, x);
+            srcUV += n;
+            dstUV += n;
+            x -= n;
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             while (x >= 8) {
@@ -1292,6 +1853,17 @@ static int SDL_ConvertPixels_SwapNV(int width, int height, const void *src, int
                 x -= 8;
             }
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            while (x >= 8) {
+                uint8x16_t uv = vld1q_u8((const uint8_t *)srcUV);
+                vst1q_u8((uint8_t *)dstUV, vrev16q_u8(uv));
+                srcUV += 8;
+                dstUV += 8;
+                x -= 8;
+            }
+        }
 #endif
         while (x--) {
             *dstUV++ = SDL_Swap16(*srcUV++);
@@ -1393,6 +1965,32 @@ static int SDL_ConvertPixels_Planar2x2_to_Planar2x2(int width, int height,
 
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#define PACKED4_TO_PACKED4_ROW_AVX2(i0, i1, i2, i3)                               \
+    {                                                                            \
+        const int n = SDL_Packed4Row_AVX2(srcYUV, dstYUV, x, i0, i1, i2, i3);    \
+        srcYUV += 4 * n;                                                         \
+        dstYUV += 4 * n;                                                         \
+        x -= n;                                                                  \
+    }
+#endif
+
+#ifdef __ARM_NEON
+#define PACKED4_TO_PACKED4_ROW_NEON(i0, i1, i2, i3) \
+    while (x >= 8) {                                \
+        uint8x8x4_t yuv = vld4_u8(srcYUV);          \
+        uint8x8x4_t out;                            \
+        out.val[0] = yuv.val[i0];                   \
+        out.val[1] = yuv.val[i1];                   \
+        out.val[2] = yuv.val[i2];                   \
+        out.val[3] = yuv.val[i3];                   \
+        vst4_u8(dstYUV, out);                       \
+        srcYUV += 32;                               \
+        dstYUV += 32;                               \
+        x -= 8;                                     \
+    }
+#endif
+
 static int SDL_ConvertPixels_YUY2_to_UYVY(int width, int height, const void *src, int src_pitch, void *dst, int dst_pitch)
 {
     int x, y;
@@ -1401,17 +1999,33 @@ static int SDL_ConvertPixels_YUY2_to_UYVY(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(1, 0, 3, 2);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 3, 0, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 0, 3, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1442,17 +2056,33 @@ static int SDL_ConvertPixels_YUY2_to_YVYU(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(0, 3, 2, 1);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(1, 2, 3, 0));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(0, 3, 2, 1);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1483,17 +2113,33 @@ static int SDL_ConvertPixels_UYVY_to_YUY2(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(1, 0, 3, 2);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 3, 0, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 0, 3, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1524,17 +2170,33 @@ static int SDL_ConvertPixels_UYVY_to_YVYU(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(1, 2, 3, 0);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(0, 3, 2, 1));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(1, 2, 3, 0);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1565,17 +2227,33 @@ static int SDL_ConvertPixels_YVYU_to_YUY2(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(0, 3, 2, 1);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(1, 2, 3, 0));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(0, 3, 2, 1);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1606,17 +2284,33 @@ static int SDL_ConvertPixels_YVYU_to_UYVY(int width, int height, const void *src
     const int dstYUVPitchLeft = (dst_pitch - YUVwidth * 4);
     const Uint8 *srcYUV = (const Uint8 *)src;
     Uint8 *dstYUV = (Uint8 *)dst;
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
 #ifdef __SSE2__
     const SDL_bool use_SSE2 = SDL_HasSSE2();
 #endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     y = height;
     while (y--) {
         x = YUVwidth;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            PACKED4_TO_PACKED4_ROW_AVX2(3, 0, 1, 2);
+        }
+#endif
 #ifdef __SSE2__
         if (use_SSE2) {
             PACKED4_TO_PACKED4_ROW_SSE2(_MM_SHUFFLE(2, 1, 0, 3));
         }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            PACKED4_TO_PACKED4_ROW_NEON(3, 0, 1, 2);
+        }
 #endif
         while (x--) {
             Uint8 Y1, U, Y2, V;
@@ -1692,6 +2386,18 @@ static int SDL_ConvertPixels_Planar2x2_to_Packed4(int width, int height,
     Uint8 *dstY1, *dstY2, *dstU1, *dstU2, *dstV1, *dstV2;
     Uint32 dstY_pitch, dstUV_pitch;
     Uint32 dst_pitch_left;
+#if defined(HAVE_AVX2_INTRINSICS) || defined(__SSE2__) || defined(__ARM_NEON)
+    int dstY_offset, dstU_offset, dstV_offset;
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
+#ifdef __SSE2__
+    const SDL_bool use_SSE2 = SDL_HasSSE2();
+#endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     if (src == dst) {
         return SDL_SetError("Can't change YUV plane types in-place");
@@ -1722,9 +2428,126 @@ static int SDL_ConvertPixels_Planar2x2_to_Packed4(int width, int height,
     dstV2 = dstV1 + dstUV_pitch;
     dst_pitch_left = (dstY_pitch - 4 * ((width + 1) / 2));
 
+#if defined(HAVE_AVX2_INTRINSICS) || defined(__SSE2__) || defined(__ARM_NEON)
+    /* Byte positions of Y, U and V within each packed 4 byte group */
+    dstY_offset = (dstY1 < dstU1) ? 0 : 1;
+    dstU_offset = (int)(dstU1 - (dstY1 - dstY_offset));
+    dstV_offset = (int)(dstV1 - (dstY1 - dstY_offset));
+#endif
+
     /* Copy 2x2 blocks of pixels at a time */
     for (y = 0; y < (height - 1); y += 2) {
-        for (x = 0; x < (width - 1); x += 2) {
+        x = 0;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            /* 32x2 pixels at a time */
+            const int n = SDL_Planar2x2ToPacked4Rows_AVX2(srcY1, srcY2, srcU, srcV, srcUV_pixel_stride,
+                                                          dstY1 - dstY_offset, dstY2 - dstY_offset, dstY_offset,
+                                                          (dstU_offset < dstV_offset) ? SDL_TRUE : SDL_FALSE, width);
+            srcY1 += n;
+            srcY2 += n;
+            srcU += (n / 2) * srcUV_pixel_stride;
+            srcV += (n / 2) * srcUV_pixel_stride;
+            dstY1 += 2 * n;
+            dstY2 += 2 * n;
+            dstU1 += 2 * n;
+            dstU2 += 2 * n;
+            dstV1 += 2 * n;
+            dstV2 += 2 * n;
+            x += n;
+        }
+#endif
+#ifdef __SSE2__
+        if (use_SSE2) {
+            /* 16x2 pixels at a time */
+            while ((x + 16) <= width) {
+                __m128i y1 = _mm_loadu_si128((__m128i *)srcY1);
+                __m128i y2 = _mm_loadu_si128((__m128i *)srcY2);
+                __m128i uv;
+
+                if (srcUV_pixel_stride == 1) {
+                    __m128i u = _mm_loadl_epi64((__m128i *)srcU);
+                    __m128i v = _mm_loadl_epi64((__m128i *)srcV);
+                    uv = (dstU_offset < dstV_offset) ? _mm_unpacklo_epi8(u, v) : _mm_unpacklo_epi8(v, u);
+                } else {
+                    uv = _mm_loadu_si128((__m128i *)((srcU < srcV) ? srcU : srcV));
+                    if ((srcU < srcV) != (dstU_offset < dstV_offset)) {
+                        uv = _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8));
+                    }
+                }
+
+                if (dstY_offset == 0) {
+                    _mm_storeu_si128((__m128i *)dstY1, _mm_unpacklo_epi8(y1, uv));
+                    _mm_storeu_si128((__m128i *)(dstY1 + 16), _mm_unpackhi_epi8(y1, uv));
+                    _mm_storeu_si128((__m128i *)dstY2, _mm_unpacklo_epi8(y2, uv));
+                    _mm_storeu_si128((__m128i *)(dstY2 + 16), _mm_unpackhi_epi8(y2, uv));
+                } else {
+                    _mm_storeu_si128((__m128i *)(dstY1 - 1), _mm_unpacklo_epi8(uv, y1));
+                    _mm_storeu_si128((__m128i *)(dstY1 + 15), _mm_unpackhi_epi8(uv, y1));
+                    _mm_storeu_si128((__m128i *)(dstY2 - 1), _mm_unpacklo_epi8(uv, y2));
+                    _mm_storeu_si128((__m128i *)(dstY2 + 15), _mm_unpackhi_epi8(uv, y2));
+                }
+
+                srcY1 += 16;
+                srcY2 += 16;
+                srcU += 8 * srcUV_pixel_stride;
+                srcV += 8 * srcUV_pixel_stride;
+                dstY1 += 32;
+                dstY2 += 32;
+                dstU1 += 32;
+                dstU2 += 32;
+                dstV1 += 32;
+                dstV2 += 32;
+                x += 16;
+            }
+        }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            /* 16x2 pixels at a time */
+            while ((x + 16) <= width) {
+                uint8x8x2_t y1 = vld2_u8(srcY1);
+                uint8x8x2_t y2 = vld2_u8(srcY2);
+                uint8x8_t u, v;
+                uint8x8x4_t yuv;
+
+                if (srcUV_pixel_stride == 1) {
+                    u = vld1_u8(srcU);
+                    v = vld1_u8(srcV);
+                } else if (srcU < srcV) {
+                    uint8x8x2_t uv = vld2_u8(srcU);
+                    u = uv.val[0];
+                    v = uv.val[1];
+                } else {
+                    uint8x8x2_t vu = vld2_u8(srcV);
+                    v = vu.val[0];
+                    u = vu.val[1];
+                }
+
+                yuv.val[dstU_offset] = u;
+                yuv.val[dstV_offset] = v;
+                yuv.val[dstY_offset] = y1.val[0];
+                yuv.val[dstY_offset + 2] = y1.val[1];
+                vst4_u8(dstY1 - dstY_offset, yuv);
+                yuv.val[dstY_offset] = y2.val[0];
+                yuv.val[dstY_offset + 2] = y2.val[1];
+                vst4_u8(dstY2 - dstY_offset, yuv);
+
+                srcY1 += 16;
+                srcY2 += 16;
+                srcU += 8 * srcUV_pixel_stride;
+                srcV += 8 * srcUV_pixel_stride;
+                dstY1 += 32;
+                dstY2 += 32;
+                dstU1 += 32;
+                dstU2 += 32;
+                dstV1 += 32;
+                dstV2 += 32;
+                x += 16;
+            }
+        }
+#endif
+        for (; x < (width - 1); x += 2) {
             /* Row 1 */
             *dstY1 = *srcY1++;
             dstY1 += 2;
@@ -1834,6 +2657,18 @@ static int SDL_ConvertPixels_Packed4_to_Planar2x2(int width, int height,
     Uint8 *dstY1, *dstY2, *dstU, *dstV;
     Uint32 dstY_pitch, dstUV_pitch;
     Uint32 dstY_pitch_left, dstUV_pitch_left, dstUV_pixel_stride;
+#if defined(HAVE_AVX2_INTRINSICS) || defined(__SSE2__) || defined(__ARM_NEON)
+    int srcY_offset, srcU_offset, srcV_offset;
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    const SDL_bool use_AVX2 = SDL_HasAVX2();
+#endif
+#ifdef __SSE2__
+    const SDL_bool use_SSE2 = SDL_HasSSE2();
+#endif
+#ifdef __ARM_NEON
+    const SDL_bool use_NEON = SDL_HasNEON();
+#endif
 
     if (src == dst) {
         return SDL_SetError("Can't change YUV plane types in-place");
@@ -1864,9 +2699,135 @@ static int SDL_ConvertPixels_Packed4_to_Planar2x2(int width, int height,
         dstUV_pitch_left = (dstUV_pitch - ((width + 1) / 2));
     }
 
+#if defined(HAVE_AVX2_INTRINSICS) || defined(__SSE2__) || defined(__ARM_NEON)
+    /* Byte positions of Y, U and V within each packed 4 byte group */
+    srcY_offset = (srcY1 < srcU1) ? 0 : 1;
+    srcU_offset = (int)(srcU1 - (srcY1 - srcY_offset));
+    srcV_offset = (int)(srcV1 - (srcY1 - srcY_offset));
+#endif
+
     /* Copy 2x2 blocks of pixels at a time */
     for (y = 0; y < (height - 1); y += 2) {
-        for (x = 0; x < (width - 1); x += 2) {
+        x = 0;
+#ifdef HAVE_AVX2_INTRINSICS
+        if (use_AVX2) {
+            /* 32x2 pixels at a time */
+            const int n = SDL_Packed4ToPlanar2x2Rows_AVX2(srcY1 - srcY_offset, srcY2 - srcY_offset, srcY_offset,
+                                                          (srcU_offset < srcV_offset) ? SDL_TRUE : SDL_FALSE,
+                                                          dstY1, dstY2, dstU, dstV, dstUV_pixel_stride, width);
+            srcY1 += 2 * n;
+            srcY2 += 2 * n;
+            srcU1 += 2 * n;
+            srcU2 += 2 * n;
+            srcV1 += 2 * n;
+            srcV2 += 2 * n;
+            dstY1 += n;
+            dstY2 += n;
+            dstU += (n / 2) * dstUV_pixel_stride;
+            dstV += (n / 2) * dstUV_pixel_stride;
+            x += n;
+        }
+#endif
+#ifdef __SSE2__
+        if (use_SSE2) {
+            const __m128i mask = _mm_set1_epi16(0x00FF);
+            const __m128i one = _mm_set1_epi8(1);
+
+            /* 16x2 pixels at a time */
+            while ((x + 16) <= width) {
+                const Uint8 *row1 = srcY1 - srcY_offset;
+                const Uint8 *row2 = srcY2 - srcY_offset;
+                __m128i a1 = _mm_loadu_si128((__m128i *)row1);
+                __m128i b1 = _mm_loadu_si128((__m128i *)(row1 + 16));
+                __m128i a2 = _mm_loadu_si128((__m128i *)row2);
+                __m128i b2 = _mm_loadu_si128((__m128i *)(row2 + 16));
+                __m128i even1 = _mm_packus_epi16(_mm_and_si128(a1, mask), _mm_and_si128(b1, mask));
+                __m128i odd1 = _mm_packus_epi16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8));
+                __m128i even2 = _mm_packus_epi16(_mm_and_si128(a2, mask), _mm_and_si128(b2, mask));
+                __m128i odd2 = _mm_packus_epi16(_mm_srli_epi16(a2, 8), _mm_srli_epi16(b2, 8));
+                __m128i uv1 = srcY_offset ? even1 : odd1;
+                __m128i uv2 = srcY_offset ? even2 : odd2;
+                /* Truncating average, to match the scalar code */
+                __m128i uv = _mm_sub_epi8(_mm_avg_epu8(uv1, uv2), _mm_and_si128(_mm_xor_si128(uv1, uv2), one));
+
+                _mm_storeu_si128((__m128i *)dstY1, srcY_offset ? odd1 : even1);
+                _mm_storeu_si128((__m128i *)dstY2, srcY_offset ? odd2 : even2);
+
+                if (dstUV_pixel_stride == 2) {
+                    if ((srcU_offset < srcV_offset) != (dstU < dstV)) {
+                        uv = _mm_or_si128(_mm_slli_epi16(uv, 8), _mm_srli_epi16(uv, 8));
+                    }
+                    _mm_storeu_si128((__m128i *)((dstU < dstV) ? dstU : dstV), uv);
+                } else {
+                    __m128i first = _mm_packus_epi16(_mm_and_si128(uv, mask), _mm_setzero_si128());
+                    __m128i second = _mm_packus_epi16(_mm_srli_epi16(uv, 8), _mm_setzero_si128());
+                    _mm_storel_epi64((__m128i *)dstU, (srcU_offset < srcV_offset) ? first : second);
+                    _mm_storel_epi64((__m128i *)dstV, (srcU_offset < srcV_offset) ? second : first);
+                }
+
+                srcY1 += 32;
+                srcY2 += 32;
+                srcU1 += 32;
+                srcU2 += 32;
+                srcV1 += 32;
+                srcV2 += 32;
+                dstY1 += 16;
+                dstY2 += 16;
+                dstU += 8 * dstUV_pixel_stride;
+                dstV += 8 * dstUV_pixel_stride;
+                x += 16;
+            }
+        }
+#endif
+#ifdef __ARM_NEON
+        if (use_NEON) {
+            /* 16x2 pixels at a time */
+            while ((x + 16) <= width) {
+                uint8x8x4_t yuv1 = vld4_u8(srcY1 - srcY_offset);
+                uint8x8x4_t yuv2 = vld4_u8(srcY2 - srcY_offset);
+                uint8x8x2_t y1, y2;
+                /* vhadd truncates, matching the scalar code */
+                uint8x8_t u = vhadd_u8(yuv1.val[srcU_offset], yuv2.val[srcU_offset]);
+                uint8x8_t v = vhadd_u8(yuv1.val[srcV_offset], yuv2.val[srcV_offset]);
+
+                y1.val[0] = yuv1.val[srcY_offset];
+                y1.val[1] = yuv1.val[srcY_offset + 2];
+                y2.val[0] = yuv2.val[srcY_offset];
+                y2.val[1] = yuv2.val[srcY_offset + 2];
+                vst2_u8(dstY1, y1);
+                vst2_u8(dstY2, y2);
+
+                if (dstUV_pixel_stride == 2) {
+                    uint8x8x2_t uv;
+                    if (dstU < dstV) {
+                        uv.val[0] = u;
+                        uv.val[1] = v;
+                        vst2_u8(dstU, uv);
+                    } else {
+                        uv.val[0] = v;
+                        uv.val[1] = u;
+                        vst2_u8(dstV, uv);
+                    }
+                } else {
+                    vst1_u8(dstU, u);
+                    vst1_u8(dstV, v);
+                }
+
+                srcY1 += 32;
+                srcY2 += 32;
+                srcU1 += 32;
+                srcU2 += 32;
+                srcV1 += 32;
+                srcV2 += 32;
+                dstY1 += 16;
+                dstY2 += 16;
+                dstU += 8 * dstUV_pixel_stride;
+                dstV += 8 * dstUV_pixel_stride;
+                x += 16;
+            }
+        }
+#endif
+        for (; x < (width - 1); x += 2) {
             /* Row 1 */
             *dstY1++ = *srcY1;
             srcY1 += 2;
@@ -29,6 +29,7 @@
 extern int SDL_ConvertPixels_YUV_to_RGB(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
 extern int SDL_ConvertPixels_RGB_to_YUV(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
 extern int SDL_ConvertPixels_YUV_to_YUV(int width, int height, Uint32 src_format, const void *src, int src_pitch, Uint32 dst_format, void *dst, int dst_pitch);
+extern int SDL_ConvertPixels_YUV_to_RGB_Scaled(int src_w, int src_h, Uint32 src_format, const void *src, int src_pitch, const SDL_Rect *srcrect, int dst_w, int dst_h, Uint32 dst_format, void *dst, int dst_pitch, SDL_bool nearest);
 
 
 extern int SDL_CalculateYUVSize(Uint32 format, int w, int h, size_t *size, int *pitch);
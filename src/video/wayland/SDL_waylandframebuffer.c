@@ -0,0 +1,372 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+#include "../../SDL_internal.h"
+
+#ifdef SDL_VIDEO_DRIVER_WAYLAND
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "SDL_timer.h"
+#include "../../core/unix/SDL_poll.h"
+#include "../SDL_sysvideo.h"
+#include "SDL_waylandvideo.h"
+#include "SDL_waylandwindow.h"
+#include "SDL_waylandmouse.h"
+#include "SDL_waylandframebuffer.h"
+
+/* The window surface is copied into one of these wl_shm buffers on update.
+ * Two are enough while the compositor releases each buffer before the next
+ * update, a third is added when it holds on to both of them.
+ */
+#define WAYLAND_FRAMEBUFFER_MAX_BUFFERS 3
+
+/* How long an update waits for the compositor to release a buffer before the
+ * frame is dropped, in milliseconds.
+ */
+#define WAYLAND_FRAMEBUFFER_TIMEOUT 100
+
+typedef struct Wayland_ShmBuffer
+{
+    struct wl_buffer *buffer;
+    Uint8 *shm_data;
+    size_t shm_data_size;
+    SDL_bool busy;  /* Attached, and not released by the compositor yet */
+    SDL_Rect stale; /* Bounds of what changed since this buffer was last written */
+} Wayland_ShmBuffer;
+
+struct SDL_WaylandFramebuffer
+{
+    struct wl_event_queue *queue;
+    int width, height, pitch;
+    Uint8 *pixels;
+    Wayland_ShmBuffer buffers[WAYLAND_FRAMEBUFFER_MAX_BUFFERS];
+    int num_buffers;
+    SDL_Rect dropped; /* Bounds of the changes in dropped frames, damaged with the next commit */
+};
+
+static void framebuffer_buffer_release(void *data, struct wl_buffer *buffer)
+{
+    Wayland_ShmBuffer *shm_buffer = (Wayland_ShmBuffer *)data;
+
+    shm_buffer->busy = SDL_FALSE;
+}
+
+static const struct wl_buffer_listener framebuffer_buffer_listener = {
+    framebuffer_buffer_release
+};
+
+static int CreateShmBuffer(SDL_VideoData *viddata, SDL_WaylandFramebuffer *fb)
+{
+    Wayland_ShmBuffer *shm_buffer = &fb->buffers[fb->num_buffers];
+    struct wl_shm_pool *shm_pool;
+    int shm_fd;
+
+    shm_buffer->shm_data_size = (size_t)fb->pitch * fb->height;
+
+    shm_fd = Wayland_CreateTmpFile(shm_buffer->shm_data_size);
+    if (shm_fd < 0) {
+        return SDL_SetError("Creating window framebuffer failed.");
+    }
+
+    shm_buffer->shm_data = mmap(NULL,
+                                shm_buffer->shm_data_size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED,
+                                shm_fd,
+                                0);
+    if (shm_buffer->shm_data == MAP_FAILED) {
+        shm_buffer->shm_data = NULL;
+        close(shm_fd);
+        return SDL_SetError("mmap() failed.");
+    }
+
+    shm_pool = wl_shm_create_pool(viddata->shm, shm_fd, (int32_t)shm_buffer->shm_data_size);
+    shm_buffer->buffer = wl_shm_pool_create_buffer(shm_pool,
+                                                   0,
+                                                   fb->width,
+                                                   fb->height,
+                                                   fb->pitch,
+                                                   WL_SHM_FORMAT_XRGB8888);
+
+    /* Releases are dispatched from the update, which may have to wait for one */
+    WAYLAND_wl_proxy_set_queue((struct wl_proxy *)shm_buffer->buffer, fb->queue);
+    wl_buffer_add_listener(shm_buffer->buffer,
+                           &framebuffer_buffer_listener,
+                           shm_buffer);
+
+    wl_shm_pool_destroy(shm_pool);
+    close(shm_fd);
+
+    /* The new buffer has none of the window contents yet */
+    shm_buffer->busy = SDL_FALSE;
+    shm_buffer->stale.x = 0;
+    shm_buffer->stale.y = 0;
+    shm_buffer->stale.w = fb->width;
+    shm_buffer->stale.h = fb->height;
+
+    ++fb->num_buffers;
+    return 0;
+}
+
+static Wayland_ShmBuffer *GetFreeShmBuffer(SDL_WaylandFramebuffer *fb)
+{
+    int i;
+
+    for (i = 0; i < fb->num_buffers; ++i) {
+        if (!fb->buffers[i].busy) {
+            return &fb->buffers[i];
+        }
+    }
+    return NULL;
+}
+
+/* Wait until the compositor releases one of the buffers, like the GLES swap
+ * interval this gives up after a while so a stalled compositor can't block
+ * us indefinitely.
+ */
+static Wayland_ShmBuffer *WaitForShmBuffer(SDL_VideoData *viddata, SDL_WaylandFramebuffer *fb)
+{
+    struct wl_display *display = viddata->display;
+    const Uint32 max_wait = SDL_GetTicks() + WAYLAND_FRAMEBUFFER_TIMEOUT;
+    Wayland_ShmBuffer *shm_buffer;
+
+    while ((shm_buffer = GetFreeShmBuffer(fb)) == NULL) {
+        Uint32 now;
+
+        WAYLAND_wl_display_flush(display);
+
+        if (WAYLAND_wl_display_prepare_read_queue(display, fb->queue) != 0) {
+            WAYLAND_wl_display_dispatch_queue_pending(display, fb->queue);
+            continue;
+        }
+
+        now = SDL_GetTicks();
+        if (SDL_TICKS_PASSED(now, max_wait)) {
+            WAYLAND_wl_display_cancel_read(display);
+            break;
+        }
+
+        if (SDL_IOReady(WAYLAND_wl_display_get_fd(display), SDL_IOR_READ, max_wait - now) <= 0) {
+            WAYLAND_wl_display_cancel_read(display);
+            break;
+        }
+
+        WAYLAND_wl_display_read_events(display);
+        WAYLAND_wl_display_dispatch_queue_pending(display, fb->queue);
+    }
+    return shm_buffer;
+}
+
+static void AddRect(SDL_Rect *bounds, const SDL_Rect *rect)
+{
+    if (SDL_RectEmpty(bounds)) {
+        *bounds = *rect;
+    } else {
+        SDL_UnionRect(bounds, rect, bounds);
+    }
+}
+
+static void AddStaleRect(SDL_WaylandFramebuffer *fb, Wayland_ShmBuffer *except, const SDL_Rect *rect)
+{
+    int i;
+
+    for (i = 0; i < fb->num_buffers; ++i) {
+        Wayland_ShmBuffer *shm_buffer = &fb->buffers[i];
+        if (shm_buffer != except) {
+            AddRect(&shm_buffer->stale, rect);
+        }
+    }
+}
+
+static void DamageRect(SDL_VideoData *viddata, SDL_WindowData *data, const SDL_Rect *rect)
+{
+    if (wl_compositor_get_version(viddata->compositor) >= 4) {
+        wl_surface_damage_buffer(data->surface, rect->x, rect->y, rect->w, rect->h);
+    }
+}
+
+static void CopyRect(SDL_WaylandFramebuffer *fb, Wayland_ShmBuffer *shm_buffer, const SDL_Rect *rect)
+{
+    const size_t offset = (size_t)rect->y * fb->pitch + rect->x * 4;
+    const Uint8 *src = fb->pixels + offset;
+    Uint8 *dst = shm_buffer->shm_data + offset;
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, rect->w * 4);
+        src += fb->pitch;
+        dst += fb->pitch;
+    }
+}
+
+int Wayland_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *format,
+                                    void **pixels, int *pitch)
+{
+    SDL_VideoData *viddata = (SDL_VideoData *)_this->driverdata;
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+    SDL_WaylandFramebuffer *fb;
+    int i, w, h;
+
+    /* Free the old framebuffer surface */
+    Wayland_DestroyWindowFramebuffer(_this, window);
+
+    SDL_GetWindowSizeInPixels(window, &w, &h);
+    if (w <= 0 || h <= 0) {
+        return SDL_SetError("Window has no size");
+    }
+
+    fb = (SDL_WaylandFramebuffer *)SDL_calloc(1, sizeof(*fb));
+    if (!fb) {
+        return SDL_OutOfMemory();
+    }
+    fb->width = w;
+    fb->height = h;
+    fb->pitch = w * 4;
+    fb->pixels = (Uint8 *)SDL_calloc(1, (size_t)fb->pitch * h);
+    if (!fb->pixels) {
+        SDL_free(fb);
+        return SDL_OutOfMemory();
+    }
+    fb->queue = WAYLAND_wl_display_create_queue(viddata->display);
+    data->framebuffer = fb;
+
+    /* Start out double buffered */
+    for (i = 0; i < 2; ++i) {
+        if (CreateShmBuffer(viddata, fb) < 0) {
+            Wayland_DestroyWindowFramebuffer(_this, window);
+            return -1;
+        }
+    }
+
+    *format = SDL_PIXELFORMAT_RGB888;
+    *pixels = fb->pixels;
+    *pitch = fb->pitch;
+    return 0;
+}
+
+int Wayland_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_Rect *rects,
+                                    int numrects)
+{
+    SDL_VideoData *viddata = (SDL_VideoData *)_this->driverdata;
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+    SDL_WaylandFramebuffer *fb = data->framebuffer;
+    Wayland_ShmBuffer *shm_buffer = NULL;
+    SDL_Rect bounds, rect;
+    int i;
+
+    if (!fb) {
+        return SDL_SetError("Couldn't find framebuffer for window");
+    }
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = fb->width;
+    bounds.h = fb->height;
+
+    /* Like GLES swaps, skip presenting to hidden windows, the compositor
+     * wouldn't release the buffers.
+     */
+    if (!(window->flags & SDL_WINDOW_HIDDEN)) {
+        WAYLAND_wl_display_dispatch_queue_pending(viddata->display, fb->queue);
+
+        shm_buffer = GetFreeShmBuffer(fb);
+        if (!shm_buffer && fb->num_buffers < WAYLAND_FRAMEBUFFER_MAX_BUFFERS) {
+            if (CreateShmBuffer(viddata, fb) < 0) {
+                return -1;
+            }
+            shm_buffer = &fb->buffers[fb->num_buffers - 1];
+        }
+        if (!shm_buffer) {
+            shm_buffer = WaitForShmBuffer(viddata, fb);
+        }
+    }
+
+    if (shm_buffer && !SDL_RectEmpty(&shm_buffer->stale)) {
+        /* Catch up with the updates this buffer missed */
+        CopyRect(fb, shm_buffer, &shm_buffer->stale);
+        SDL_zero(shm_buffer->stale);
+    }
+
+    for (i = 0; i < numrects; ++i) {
+        if (!SDL_IntersectRect(&rects[i], &bounds, &rect)) {
+            continue;
+        }
+
+        /* Without a buffer the frame is dropped, and its changes go out with the next update */
+        AddStaleRect(fb, shm_buffer, &rect);
+        if (!shm_buffer) {
+            AddRect(&fb->dropped, &rect);
+            continue;
+        }
+
+        CopyRect(fb, shm_buffer, &rect);
+        DamageRect(viddata, data, &rect);
+    }
+
+    if (!shm_buffer) {
+        return 0;
+    }
+
+    if (!SDL_RectEmpty(&fb->dropped)) {
+        /* The compositor hasn't seen the changes from dropped frames yet */
+        DamageRect(viddata, data, &fb->dropped);
+        SDL_zero(fb->dropped);
+    }
+
+    if (wl_compositor_get_version(viddata->compositor) < 4) {
+        wl_surface_damage(data->surface, 0, 0, data->window_width, data->window_height);
+    }
+    wl_surface_attach(data->surface, shm_buffer->buffer, 0, 0);
+    wl_surface_commit(data->surface);
+    shm_buffer->busy = SDL_TRUE;
+
+    WAYLAND_wl_display_flush(viddata->display);
+
+    return 0;
+}
+
+void Wayland_DestroyWindowFramebuffer(_THIS, SDL_Window *window)
+{
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+    SDL_WaylandFramebuffer *fb;
+    int i;
+
+    if (!data || !data->framebuffer) {
+        /* The window wasn't fully initialized */
+        return;
+    }
+    fb = data->framebuffer;
+
+    /* The compositor keeps its own mapping of buffers it still holds */
+    for (i = 0; i < fb->num_buffers; ++i) {
+        wl_buffer_destroy(fb->buffers[i].buffer);
+        munmap(fb->buffers[i].shm_data, fb->buffers[i].shm_data_size);
+    }
+    WAYLAND_wl_event_queue_destroy(fb->queue);
+    SDL_free(fb->pixels);
+    SDL_free(fb);
+    data->framebuffer = NULL;
+}
+
+#endif /* SDL_VIDEO_DRIVER_WAYLAND */
+
+/* vi: set ts=4 sw=4 expandtab: */
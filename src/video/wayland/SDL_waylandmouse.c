@@ -326,7 +326,7 @@ static int set_tmp_file_size(int fd, off_t size)
     return 0;
 }
 
-static int wayland_create_tmp_file(off_t size)
+int Wayland_CreateTmpFile(off_t size)
 {
     int fd;
 
@@ -387,7 +387,7 @@ static int create_buffer_from_shm(Wayland_CursorData *d,
     int stride = width * 4;
     d->shm_data_size = stride * height;
 
-    shm_fd = wayland_create_tmp_file(d->shm_data_size);
+    shm_fd = Wayland_CreateTmpFile(d->shm_data_size);
     if (shm_fd < 0) {
         return SDL_SetError("Creating mouse cursor buffer failed.");
     }
@@ -27,6 +27,8 @@
 
 extern void Wayland_InitMouse(void);
 extern void Wayland_FiniMouse(SDL_VideoData *data);
+/* Creates an anonymous file of this size for wl_shm pools */
+extern int Wayland_CreateTmpFile(off_t size);
 #if 0  /* TODO RECONNECT: See waylandvideo.c for more information! */
 extern void Wayland_RecreateCursors(void);
 #endif /* 0 */
@@ -104,6 +104,11 @@ int Wayland_GLES_GetSwapInterval(_THIS)
 }
 
 int Wayland_GLES_SwapWindow(_THIS, SDL_Window *window)
+{
+    return Wayland_GLES_SwapWindowWithDamage(_this, window, NULL, 0);
+}
+
+int Wayland_GLES_SwapWindowWithDamage(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects)
 {
     SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
     const int swap_interval = _this->egl_data->egl_swapinterval;
@@ -162,9 +167,10 @@ int Wayland_GLES_SwapWindow(_THIS, SDL_Window *window)
         SDL_AtomicSet(&data->swap_interval_ready, 0);
     }
 
-    /* Feed the frame to Wayland. This will set it so the wl_surface_frame callback can fire again. */
-    if (!_this->egl_data->eglSwapBuffers(_this->egl_data->egl_display, data->egl_surface)) {
-        return SDL_EGL_SetError("unable to show color buffer in an OS-native window", "eglSwapBuffers");
+    /* Feed the frame to Wayland. This will set it so the wl_surface_frame callback can fire again.
+       With damage the compositor only has to recomposite the parts of the surface that changed. */
+    if (SDL_EGL_SwapBuffersWithDamage(_this, data->egl_surface, rects, numrects) < 0) {
+        return -1;
     }
 
     WAYLAND_wl_display_flush(data->waylandData->display);
@@ -172,6 +178,9 @@ int Wayland_GLES_SwapWindow(_THIS, SDL_Window *window)
     return 0;
 }
 
+SDL_EGL_GetBufferAge_impl(Wayland)
+SDL_EGL_SetDamageRegion_impl(Wayland)
+
 int Wayland_GLES_MakeCurrent(_THIS, SDL_Window *window, SDL_GLContext context)
 {
     int ret;
@@ -41,6 +41,9 @@ extern SDL_GLContext Wayland_GLES_CreateContext(_THIS, SDL_Window *window);
 extern int Wayland_GLES_SetSwapInterval(_THIS, int interval);
 extern int Wayland_GLES_GetSwapInterval(_THIS);
 extern int Wayland_GLES_SwapWindow(_THIS, SDL_Window *window);
+extern int Wayland_GLES_SwapWindowWithDamage(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects);
+extern int Wayland_GLES_GetBufferAge(_THIS, SDL_Window *window);
+extern int Wayland_GLES_SetDamageRegion(_THIS, SDL_Window *window, const SDL_Rect *rects, int numrects);
 extern int Wayland_GLES_MakeCurrent(_THIS, SDL_Window *window, SDL_GLContext context);
 extern void Wayland_GLES_DeleteContext(_THIS, SDL_GLContext context);
 
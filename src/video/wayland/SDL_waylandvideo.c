@@ -31,6 +31,7 @@
 #include "SDL_waylandvideo.h"
 #include "SDL_waylandevents_c.h"
 #include "SDL_waylandwindow.h"
+#include "SDL_waylandframebuffer.h"
 #include "SDL_waylandopengles.h"
 #include "SDL_waylandmouse.h"
 #include "SDL_waylandkeyboard.h"
@@ -248,6 +249,9 @@ static SDL_VideoDevice *Wayland_CreateDevice(void)
 
 #ifdef SDL_VIDEO_OPENGL_EGL
     device->GL_SwapWindow = Wayland_GLES_SwapWindow;
+    device->GL_SwapWindowWithDamage = Wayland_GLES_SwapWindowWithDamage;
+    device->GL_GetBufferAge = Wayland_GLES_GetBufferAge;
+    device->GL_SetDamageRegion = Wayland_GLES_SetDamageRegion;
     device->GL_GetSwapInterval = Wayland_GLES_GetSwapInterval;
     device->GL_SetSwapInterval = Wayland_GLES_SetSwapInterval;
     device->GL_MakeCurrent = Wayland_GLES_MakeCurrent;
@@ -278,6 +282,9 @@ static SDL_VideoDevice *Wayland_CreateDevice(void)
     device->SetWindowTitle = Wayland_SetWindowTitle;
     device->GetWindowSizeInPixels = Wayland_GetWindowSizeInPixels;
     device->DestroyWindow = Wayland_DestroyWindow;
+    device->CreateWindowFramebuffer = Wayland_CreateWindowFramebuffer;
+    device->UpdateWindowFramebuffer = Wayland_UpdateWindowFramebuffer;
+    device->DestroyWindowFramebuffer = Wayland_DestroyWindowFramebuffer;
     device->SetWindowHitTest = Wayland_SetWindowHitTest;
     device->FlashWindow = Wayland_FlashWindow;
     device->HasScreenKeyboardSupport = Wayland_HasScreenKeyboardSupport;
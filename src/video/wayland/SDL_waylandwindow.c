@@ -504,8 +504,12 @@ static void surface_damage_frame_done(void *data, struct wl_callback *cb, uint32
     /*
      * wl_surface.damage_buffer is the preferred method of setting the damage region
      * on compositor version 4 and above.
+     *
+     * Window framebuffers damage exactly the parts they update.
      */
-    if (wl_compositor_get_version(wind->waylandData->compositor) >= 4) {
+    if (wind->framebuffer) {
+        /* Nothing to do */
+    } else if (wl_compositor_get_version(wind->waylandData->compositor) >= 4) {
         wl_surface_damage_buffer(wind->surface, 0, 0,
                                  wind->drawable_width, wind->drawable_height);
     } else {
@@ -31,6 +31,7 @@
 #include "SDL_waylandvideo.h"
 
 struct SDL_WaylandInput;
+typedef struct SDL_WaylandFramebuffer SDL_WaylandFramebuffer;
 
 typedef struct
 {
@@ -77,6 +78,7 @@ typedef struct
     } shell_surface_type;
 
     struct wl_egl_window *egl_window;
+    SDL_WaylandFramebuffer *framebuffer;
     struct SDL_WaylandInput *keyboard_device;
 #ifdef SDL_VIDEO_OPENGL_EGL
     EGLSurface egl_surface;
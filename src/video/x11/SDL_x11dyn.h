@@ -58,6 +58,9 @@
 #ifdef SDL_VIDEO_DRIVER_X11_XFIXES
 #include <X11/extensions/Xfixes.h>
 #endif
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+#include <X11/extensions/Xpresent.h>
+#endif
 #ifdef SDL_VIDEO_DRIVER_X11_XRANDR
 #include <X11/extensions/Xrandr.h>
 #endif
@@ -29,9 +29,11 @@
 #include <limits.h> /* For INT_MAX */
 
 #include "SDL_x11video.h"
+#include "SDL_x11framebuffer.h"
 #include "SDL_x11touch.h"
 #include "SDL_x11xinput2.h"
 #include "SDL_x11xfixes.h"
+#include "SDL_x11present.h"
 #include "../../core/unix/SDL_poll.h"
 #include "../../events/SDL_events_c.h"
 #include "../../events/SDL_mouse_c.h"
@@ -331,6 +333,9 @@ static void X11_HandleGenericEvent(SDL_VideoData *videodata, XEvent *xev)
     XGenericEventCookie *cookie = &xev->xcookie;
     if (X11_XGetEventData(videodata->display, cookie)) {
         X11_HandleXinput2Event(videodata, cookie);
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        X11_HandlePresentEvent(videodata, cookie);
+#endif
 
         /* Send a SDL_SYSWMEVENT if the application wants them.
          * Since event data is only available until XFreeEventData is called,
@@ -906,6 +911,17 @@ static void X11_DispatchEvent(_THIS, XEvent *xevent)
             }
         }
     }
+
+#ifndef NO_SHARED_MEMORY
+    /* The server is done with a window framebuffer segment */
+    if (videodata->shm_completion_event && xevent->type == videodata->shm_completion_event) {
+        if (data) {
+            X11_HandleShmCompletion(data, xevent);
+        }
+        return;
+    }
+#endif
+
     if (!data) {
         /* The window for KeymapNotify, etc events is 0 */
         if (xevent->type == KeymapNotify) {
@@ -22,8 +22,10 @@
 
 #ifdef SDL_VIDEO_DRIVER_X11
 
+#include "SDL_hints.h"
 #include "SDL_x11video.h"
 #include "SDL_x11framebuffer.h"
+#include "SDL_x11present.h"
 
 #ifndef NO_SHARED_MEMORY
 
@@ -45,6 +47,225 @@ static SDL_bool have_mitshm(Display *dpy)
     return X11_XShmQueryExtension(dpy) ? SDL_X11_HAVE_SHM : SDL_FALSE;
 }
 
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+static SDL_bool use_present(SDL_VideoData *videodata)
+{
+    int major, minor;
+    Bool pixmaps = False;
+
+    if (!videodata->present_opcode ||
+        !SDL_GetHintBoolean(SDL_HINT_VIDEO_X11_PRESENT, SDL_FALSE)) {
+        return SDL_FALSE;
+    }
+
+    /* The segments are presented as shared memory pixmaps */
+    if (!X11_XShmQueryVersion(videodata->display, &major, &minor, &pixmaps) || !pixmaps ||
+        X11_XShmPixmapFormat(videodata->display) != ZPixmap) {
+        return SDL_FALSE;
+    }
+    return SDL_TRUE;
+}
+#endif /* SDL_VIDEO_DRIVER_X11_XPRESENT */
+
+static int X11_CreateShmSegment(Display *display, SDL_WindowData *data,
+                                int depth, int w, int h, int pitch)
+{
+    X11_ShmSegment *segment = &data->shm_segments[data->num_shm_segments];
+    XShmSegmentInfo *shminfo = &segment->shminfo;
+
+    shminfo->shmid = shmget(IPC_PRIVATE, (size_t)h * pitch, IPC_CREAT | 0777);
+    if (shminfo->shmid >= 0) {
+        shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
+        shminfo->readOnly = False;
+        if (shminfo->shmaddr != (char *)-1) {
+            shm_error = False;
+            X_handler = X11_XSetErrorHandler(shm_errhandler);
+            X11_XShmAttach(display, shminfo);
+            X11_XSync(display, False);
+            X11_XSetErrorHandler(X_handler);
+            if (shm_error) {
+                shmdt(shminfo->shmaddr);
+            }
+        } else {
+            shm_error = True;
+        }
+        shmctl(shminfo->shmid, IPC_RMID, NULL);
+    } else {
+        shm_error = True;
+    }
+    if (shm_error) {
+        return -1;
+    }
+
+    segment->ximage = X11_XShmCreateImage(display, data->visual,
+                                          depth, ZPixmap,
+                                          shminfo->shmaddr, shminfo,
+                                          w, h);
+    if (!segment->ximage) {
+        X11_XShmDetach(display, shminfo);
+        X11_XSync(display, False);
+        shmdt(shminfo->shmaddr);
+        return -1;
+    }
+    segment->ximage->byte_order = (SDL_BYTEORDER == SDL_BIG_ENDIAN) ? MSBFirst : LSBFirst;
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    segment->pixmap = None;
+    if (data->use_present) {
+        segment->pixmap = X11_XShmCreatePixmap(display, data->xwindow, shminfo->shmaddr,
+                                               shminfo, w, h, depth);
+    }
+#endif
+
+    /* The new segment has none of the window contents yet */
+    segment->pending = 0;
+    segment->stale.x = 0;
+    segment->stale.y = 0;
+    segment->stale.w = w;
+    segment->stale.h = h;
+
+    ++data->num_shm_segments;
+    return 0;
+}
+
+static void X11_DestroyShmSegments(Display *display, SDL_WindowData *data)
+{
+    int i;
+
+    for (i = 0; i < data->num_shm_segments; ++i) {
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        if (data->shm_segments[i].pixmap != None) {
+            X11_XFreePixmap(display, data->shm_segments[i].pixmap);
+        }
+#endif
+        XDestroyImage(data->shm_segments[i].ximage);
+        X11_XShmDetach(display, &data->shm_segments[i].shminfo);
+    }
+    /* Make sure the server is done with the segments before they go away */
+    X11_XSync(display, False);
+    for (i = 0; i < data->num_shm_segments; ++i) {
+        shmdt(data->shm_segments[i].shminfo.shmaddr);
+    }
+    data->num_shm_segments = 0;
+}
+
+void X11_HandleShmCompletion(SDL_WindowData *data, XEvent *xevent)
+{
+    const XShmCompletionEvent *event = (const XShmCompletionEvent *)xevent;
+    int i;
+
+    for (i = 0; i < data->num_shm_segments; ++i) {
+        X11_ShmSegment *segment = &data->shm_segments[i];
+        if (segment->shminfo.shmseg == event->shmseg) {
+            if (segment->pending > 0) {
+                --segment->pending;
+            }
+            break;
+        }
+    }
+}
+
+static Bool is_shm_completion(Display *display, XEvent *event, XPointer arg)
+{
+    SDL_WindowData *data = (SDL_WindowData *)arg;
+
+    return (event->type == data->videodata->shm_completion_event) &&
+           (event->xany.window == data->xwindow);
+}
+
+/* Handle the completions that arrived since the last update */
+static void X11_PumpShmCompletions(Display *display, SDL_WindowData *data)
+{
+    XEvent event;
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    if (data->use_present) {
+        X11_PumpPresentEvents(data->videodata);
+        return;
+    }
+#endif
+
+    while (X11_XCheckIfEvent(display, &event, is_shm_completion, (XPointer)data)) {
+        X11_HandleShmCompletion(data, &event);
+    }
+}
+
+static void X11_WaitShmCompletion(Display *display, SDL_WindowData *data)
+{
+    XEvent event;
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    if (data->use_present) {
+        /* Presented pixmaps are released with PresentIdleNotify */
+        X11_WaitPresentEvent(data->videodata);
+        return;
+    }
+#endif
+
+    /* This flushes the output buffer and blocks until the server is done with a put */
+    X11_XIfEvent(display, &event, is_shm_completion, (XPointer)data);
+    X11_HandleShmCompletion(data, &event);
+}
+
+/* Get a segment the server isn't reading from, waiting for it if needed */
+static X11_ShmSegment *X11_GetFreeShmSegment(Display *display, SDL_WindowData *data)
+{
+    int i;
+
+    X11_PumpShmCompletions(display, data);
+
+    for (;;) {
+        for (i = 0; i < data->num_shm_segments; ++i) {
+            if (data->shm_segments[i].pending == 0) {
+                return &data->shm_segments[i];
+            }
+        }
+
+        if (data->num_shm_segments < X11_FRAMEBUFFER_SHM_SEGMENTS) {
+            const XImage *ximage = data->shm_segments[0].ximage;
+            if (X11_CreateShmSegment(display, data, ximage->depth, ximage->width,
+                                     ximage->height, ximage->bytes_per_line) == 0) {
+                return &data->shm_segments[data->num_shm_segments - 1];
+            }
+        }
+
+        X11_WaitShmCompletion(display, data);
+    }
+}
+
+static void X11_AddStaleRect(SDL_WindowData *data, X11_ShmSegment *except, const SDL_Rect *rect)
+{
+    int i;
+
+    for (i = 0; i < data->num_shm_segments; ++i) {
+        X11_ShmSegment *segment = &data->shm_segments[i];
+        if (segment == except) {
+            continue;
+        }
+        if (SDL_RectEmpty(&segment->stale)) {
+            segment->stale = *rect;
+        } else {
+            SDL_UnionRect(&segment->stale, rect, &segment->stale);
+        }
+    }
+}
+
+static void X11_CopyToShmSegment(SDL_WindowData *data, X11_ShmSegment *segment, const SDL_Rect *rect)
+{
+    const XImage *ximage = segment->ximage;
+    const int bpp = ximage->bits_per_pixel / 8;
+    const size_t offset = (size_t)rect->y * ximage->bytes_per_line + rect->x * bpp;
+    const Uint8 *src = data->shm_pixels + offset;
+    Uint8 *dst = (Uint8 *)ximage->data + offset;
+    int row;
+
+    for (row = 0; row < rect->h; ++row) {
+        SDL_memcpy(dst, src, (size_t)rect->w * bpp);
+        src += ximage->bytes_per_line;
+        dst += ximage->bytes_per_line;
+    }
+}
+
 #endif /* !NO_SHARED_MEMORY */
 
 int X11_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *format,
@@ -84,45 +305,34 @@ int X11_CreateWindowFramebuffer(_THIS, SDL_Window *window, Uint32 *format,
     /* Create the actual image */
 #ifndef NO_SHARED_MEMORY
     if (have_mitshm(display)) {
-        XShmSegmentInfo *shminfo = &data->shminfo;
-
-        shminfo->shmid = shmget(IPC_PRIVATE, (size_t)h * (*pitch), IPC_CREAT | 0777);
-        if (shminfo->shmid >= 0) {
-            shminfo->shmaddr = (char *)shmat(shminfo->shmid, 0, 0);
-            shminfo->readOnly = False;
-            if (shminfo->shmaddr != (char *)-1) {
-                shm_error = False;
-                X_handler = X11_XSetErrorHandler(shm_errhandler);
-                X11_XShmAttach(display, shminfo);
-                X11_XSync(display, False);
-                X11_XSetErrorHandler(X_handler);
-                if (shm_error) {
-                    shmdt(shminfo->shmaddr);
-                }
-            } else {
-                shm_error = True;
-            }
-            shmctl(shminfo->shmid, IPC_RMID, NULL);
-        } else {
-            shm_error = True;
+        /* The application draws into its own copy of the window, which is
+           copied into a free segment on update. Puts are asynchronous, the
+           server sends a ShmCompletion event when it's done with a segment. */
+        data->videodata->shm_completion_event = X11_XShmGetEventBase(display) + ShmCompletion;
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        /* With Present the segments are flipped to the window instead */
+        data->use_present = use_present(data->videodata);
+        if (data->use_present) {
+            X11_SelectPresentInput(data);
         }
-        if (!shm_error) {
-            data->ximage = X11_XShmCreateImage(display, data->visual,
-                                               vinfo.depth, ZPixmap,
-                                               shminfo->shmaddr, shminfo,
-                                               w, h);
-            if (!data->ximage) {
-                X11_XShmDetach(display, shminfo);
-                X11_XSync(display, False);
-                shmdt(shminfo->shmaddr);
-            } else {
+#endif
+
+        if (X11_CreateShmSegment(display, data, vinfo.depth, w, h, *pitch) == 0 &&
+            X11_CreateShmSegment(display, data, vinfo.depth, w, h, *pitch) == 0) {
+            *pitch = data->shm_segments[0].ximage->bytes_per_line;
+            data->shm_pixels = (Uint8 *)SDL_calloc(1, (size_t)h * (*pitch));
+            if (data->shm_pixels) {
                 /* Done! */
-                data->ximage->byte_order = (SDL_BYTEORDER == SDL_BIG_ENDIAN) ? MSBFirst : LSBFirst;
                 data->use_mitshm = SDL_TRUE;
-                *pixels = shminfo->shmaddr;
+                *pixels = data->shm_pixels;
                 return 0;
             }
         }
+        X11_DestroyShmSegments(display, data);
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        data->use_present = SDL_FALSE;
+#endif
     }
 #endif /* not NO_SHARED_MEMORY */
 
@@ -155,6 +365,27 @@ int X11_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_Rect *rects
 
 #ifndef NO_SHARED_MEMORY
     if (data->use_mitshm) {
+        X11_ShmSegment *segment = X11_GetFreeShmSegment(display, data);
+        SDL_Rect rect;
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        XRectangle *xrects = NULL;
+        SDL_bool isstack = SDL_FALSE;
+        int numxrects = 0;
+
+        if (data->use_present) {
+            xrects = SDL_small_alloc(XRectangle, numrects, &isstack);
+            if (!xrects) {
+                return SDL_OutOfMemory();
+            }
+        }
+#endif
+
+        if (!SDL_RectEmpty(&segment->stale)) {
+            /* Catch up with the updates this segment missed */
+            X11_CopyToShmSegment(data, segment, &segment->stale);
+            SDL_zero(segment->stale);
+        }
+
         for (i = 0; i < numrects; ++i) {
             x = rects[i].x;
             y = rects[i].y;
@@ -180,9 +411,47 @@ int X11_UpdateWindowFramebuffer(_THIS, SDL_Window *window, const SDL_Rect *rects
                 h = window_h - y;
             }
 
-            X11_XShmPutImage(display, data->xwindow, data->gc, data->ximage,
-                             x, y, x, y, w, h, False);
+            rect.x = x;
+            rect.y = y;
+            rect.w = w;
+            rect.h = h;
+            X11_CopyToShmSegment(data, segment, &rect);
+            X11_AddStaleRect(data, segment, &rect);
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+            if (data->use_present) {
+                xrects[numxrects].x = x;
+                xrects[numxrects].y = y;
+                xrects[numxrects].width = w;
+                xrects[numxrects].height = h;
+                ++numxrects;
+                continue;
+            }
+#endif
+            X11_XShmPutImage(display, data->xwindow, data->gc, segment->ximage,
+                             x, y, x, y, w, h, True);
+            ++segment->pending;
+        }
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        if (data->use_present) {
+            if (numxrects > 0) {
+                /* The segment is up to date everywhere, so the whole pixmap
+                   can be flipped, the update region only limits the damage */
+                XserverRegion update = X11_XFixesCreateRegion(display, xrects, numxrects);
+                X11_XPresentPixmap(display, data->xwindow, segment->pixmap, ++data->present_serial,
+                                   None, update, 0, 0, None, None, None,
+                                   PresentOptionNone, 0, 0, 0, NULL, 0);
+                X11_XFixesDestroyRegion(display, update);
+                segment->pending = 1;
+            }
+            SDL_small_free(xrects, isstack);
         }
+#endif
+
+        /* The completion events tell us when the segment can be reused */
+        X11_XFlush(display);
+        return 0;
     } else
 #endif /* !NO_SHARED_MEMORY */
     {
@@ -233,18 +502,20 @@ void X11_DestroyWindowFramebuffer(_THIS, SDL_Window *window)
 
     display = data->videodata->display;
 
-    if (data->ximage) {
-        XDestroyImage(data->ximage);
-
 #ifndef NO_SHARED_MEMORY
-        if (data->use_mitshm) {
-            X11_XShmDetach(display, &data->shminfo);
-            X11_XSync(display, False);
-            shmdt(data->shminfo.shmaddr);
-            data->use_mitshm = SDL_FALSE;
-        }
+    if (data->use_mitshm) {
+        X11_DestroyShmSegments(display, data);
+        SDL_free(data->shm_pixels);
+        data->shm_pixels = NULL;
+        data->use_mitshm = SDL_FALSE;
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+        data->use_present = SDL_FALSE;
+#endif
+    }
 #endif /* !NO_SHARED_MEMORY */
 
+    if (data->ximage) {
+        XDestroyImage(data->ximage);
         data->ximage = NULL;
     }
     if (data->gc) {
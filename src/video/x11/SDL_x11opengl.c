@@ -266,6 +266,9 @@ int X11_GL_LoadLibrary(_THIS, const char *path)
         _this->GL_SetSwapInterval = X11_GLES_SetSwapInterval;
         _this->GL_GetSwapInterval = X11_GLES_GetSwapInterval;
         _this->GL_SwapWindow = X11_GLES_SwapWindow;
+        _this->GL_SwapWindowWithDamage = X11_GLES_SwapWindowWithDamage;
+        _this->GL_GetBufferAge = X11_GLES_GetBufferAge;
+        _this->GL_SetDamageRegion = X11_GLES_SetDamageRegion;
         _this->GL_DeleteContext = X11_GLES_DeleteContext;
         return X11_GLES_LoadLibrary(_this, NULL);
 #else
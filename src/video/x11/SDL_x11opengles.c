@@ -102,6 +102,9 @@ SDL_GLContext X11_GLES_CreateContext(_THIS, SDL_Window *window)
 }
 
 SDL_EGL_SwapWindow_impl(X11)
+SDL_EGL_SwapWindowWithDamage_impl(X11)
+SDL_EGL_GetBufferAge_impl(X11)
+SDL_EGL_SetDamageRegion_impl(X11)
     SDL_EGL_MakeCurrent_impl(X11)
 
 #endif /* SDL_VIDEO_DRIVER_X11 && SDL_VIDEO_OPENGL_EGL */
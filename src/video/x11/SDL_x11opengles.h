@@ -47,6 +47,9 @@ extern int X11_GLES_LoadLibrary(_THIS, const char *path);
 extern XVisualInfo *X11_GLES_GetVisual(_THIS, Display * display, int screen);
 extern SDL_GLContext X11_GLES_CreateContext(_THIS, SDL_Window * window);
 extern int X11_GLES_SwapWindow(_THIS, SDL_Window * window);
+extern int X11_GLES_SwapWindowWithDamage(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects);
+extern int X11_GLES_GetBufferAge(_THIS, SDL_Window * window);
+extern int X11_GLES_SetDamageRegion(_THIS, SDL_Window * window, const SDL_Rect * rects, int numrects);
 extern int X11_GLES_MakeCurrent(_THIS, SDL_Window * window, SDL_GLContext context);
 
 #endif /* SDL_VIDEO_OPENGL_EGL */
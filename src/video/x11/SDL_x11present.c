@@ -0,0 +1,208 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../../SDL_internal.h"
+
+#if defined(SDL_VIDEO_DRIVER_X11) && defined(SDL_VIDEO_DRIVER_X11_XPRESENT)
+
+#include "SDL_x11video.h"
+#include "SDL_x11xfixes.h"
+#include "SDL_x11present.h"
+
+void X11_InitPresent(_THIS)
+{
+    SDL_VideoData *data = (SDL_VideoData *)_this->driverdata;
+    int opcode, event, error;
+    int major = 1, minor = 0;
+
+    if (!SDL_X11_HAVE_XPRESENT ||
+        !X11_XPresentQueryExtension(data->display, &opcode, &event, &error)) {
+        return;
+    }
+
+    /* Update regions are XFixes regions */
+    if (!X11_XfixesIsInitialized()) {
+        return;
+    }
+
+    if (!X11_XPresentQueryVersion(data->display, &major, &minor)) {
+        return;
+    }
+
+    data->present_opcode = opcode;
+}
+
+void X11_SelectPresentInput(SDL_WindowData *data)
+{
+    if (data->present_eid == None) {
+        data->present_eid = X11_XPresentSelectInput(data->videodata->display, data->xwindow,
+                                                    PresentCompleteNotifyMask | PresentIdleNotifyMask);
+    }
+}
+
+static SDL_WindowData *X11_FindPresentWindow(SDL_VideoData *videodata, Window xwindow, XID eid)
+{
+    int i;
+
+    for (i = 0; i < videodata->numwindows; ++i) {
+        SDL_WindowData *data = videodata->windowlist[i];
+        if (data && data->xwindow == xwindow && data->present_eid == eid) {
+            return data;
+        }
+    }
+    return NULL;
+}
+
+static void X11_AddPresentFeedback(SDL_WindowData *data, const XPresentCompleteNotifyEvent *event)
+{
+    SDL_WindowPresentFeedback *feedback;
+
+    /* Drop the oldest frame if the application isn't keeping up */
+    if (data->present_feedback_count == X11_PRESENT_FEEDBACK_FRAMES) {
+        data->present_feedback_head = (data->present_feedback_head + 1) % X11_PRESENT_FEEDBACK_FRAMES;
+        --data->present_feedback_count;
+    }
+
+    feedback = &data->present_feedback[(data->present_feedback_head + data->present_feedback_count) % X11_PRESENT_FEEDBACK_FRAMES];
+    feedback->frame = data->present_frames;
+    feedback->msc = event->msc;
+    feedback->ust = event->ust;
+    ++data->present_feedback_count;
+}
+
+void X11_HandlePresentEvent(SDL_VideoData *videodata, XGenericEventCookie *cookie)
+{
+    SDL_WindowData *data;
+
+    if (cookie->extension != videodata->present_opcode) {
+        return;
+    }
+
+    switch (cookie->evtype) {
+    case PresentCompleteNotify:
+    {
+        const XPresentCompleteNotifyEvent *event = (const XPresentCompleteNotifyEvent *)cookie->data;
+
+        data = X11_FindPresentWindow(videodata, event->window, event->eid);
+        if (!data || event->kind != PresentCompleteKindPixmap) {
+            break;
+        }
+
+        /* Skipped frames count, but never made it to the screen */
+        ++data->present_frames;
+        if (data->present_feedback_enabled && event->mode != PresentCompleteModeSkip) {
+            X11_AddPresentFeedback(data, event);
+        }
+    } break;
+
+    case PresentIdleNotify:
+    {
+#ifndef NO_SHARED_MEMORY
+        const XPresentIdleNotifyEvent *event = (const XPresentIdleNotifyEvent *)cookie->data;
+        int i;
+
+        data = X11_FindPresentWindow(videodata, event->window, event->eid);
+        if (!data) {
+            break;
+        }
+
+        /* The server is done with a window framebuffer segment */
+        for (i = 0; i < data->num_shm_segments; ++i) {
+            if (data->shm_segments[i].pixmap == event->pixmap) {
+                data->shm_segments[i].pending = 0;
+                break;
+            }
+        }
+#endif /* !NO_SHARED_MEMORY */
+    } break;
+
+    default:
+        break;
+    }
+}
+
+static Bool is_present_event(Display *display, XEvent *event, XPointer arg)
+{
+    SDL_VideoData *videodata = (SDL_VideoData *)arg;
+
+    return (event->type == GenericEvent) &&
+           (event->xcookie.extension == videodata->present_opcode);
+}
+
+static void X11_DispatchPresentEvent(SDL_VideoData *videodata, XEvent *event)
+{
+    XGenericEventCookie *cookie = &event->xcookie;
+
+    if (X11_XGetEventData(videodata->display, cookie)) {
+        X11_HandlePresentEvent(videodata, cookie);
+        X11_XFreeEventData(videodata->display, cookie);
+    }
+}
+
+void X11_PumpPresentEvents(SDL_VideoData *videodata)
+{
+    XEvent event;
+
+    while (X11_XCheckIfEvent(videodata->display, &event, is_present_event, (XPointer)videodata)) {
+        X11_DispatchPresentEvent(videodata, &event);
+    }
+}
+
+void X11_WaitPresentEvent(SDL_VideoData *videodata)
+{
+    XEvent event;
+
+    /* This flushes the output buffer and blocks until the server sends a Present event */
+    X11_XIfEvent(videodata->display, &event, is_present_event, (XPointer)videodata);
+    X11_DispatchPresentEvent(videodata, &event);
+}
+
+int X11_GetWindowPresentFeedback(_THIS, SDL_Window *window, SDL_WindowPresentFeedback *feedback)
+{
+    SDL_WindowData *data = (SDL_WindowData *)window->driverdata;
+    SDL_VideoData *videodata = data->videodata;
+
+    if (!videodata->present_opcode) {
+        return SDL_Unsupported();
+    }
+
+    if (!data->present_feedback_enabled) {
+        /* This also picks up the swaps of GL drivers that present with the
+           Present extension, they are sent to every client listening */
+        X11_SelectPresentInput(data);
+        data->present_feedback_enabled = SDL_TRUE;
+    }
+
+    X11_PumpPresentEvents(videodata);
+
+    if (data->present_feedback_count == 0) {
+        return 0;
+    }
+
+    *feedback = data->present_feedback[data->present_feedback_head];
+    data->present_feedback_head = (data->present_feedback_head + 1) % X11_PRESENT_FEEDBACK_FRAMES;
+    --data->present_feedback_count;
+    return 1;
+}
+
+#endif /* SDL_VIDEO_DRIVER_X11 && SDL_VIDEO_DRIVER_X11_XPRESENT */
+
+/* vi: set ts=4 sw=4 expandtab: */
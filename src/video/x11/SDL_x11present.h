@@ -0,0 +1,40 @@
+/*
+  Simple DirectMedia Layer
+  Copyright (C) 1997-2024 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include "../../SDL_internal.h"
+
+#ifndef SDL_x11present_h_
+#define SDL_x11present_h_
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+
+extern void X11_InitPresent(_THIS);
+extern void X11_SelectPresentInput(SDL_WindowData *data);
+extern void X11_HandlePresentEvent(SDL_VideoData *videodata, XGenericEventCookie *cookie);
+extern void X11_PumpPresentEvents(SDL_VideoData *videodata);
+extern void X11_WaitPresentEvent(SDL_VideoData *videodata);
+extern int X11_GetWindowPresentFeedback(_THIS, SDL_Window *window, SDL_WindowPresentFeedback *feedback);
+
+#endif /* SDL_VIDEO_DRIVER_X11_XPRESENT */
+
+#endif /* SDL_x11present_h_ */
+
+/* vi: set ts=4 sw=4 expandtab: */
@@ -163,6 +163,17 @@ SDL_X11_SYM(void, XFixesDestroyPointerBarrier, (Display* a, PointerBarrier b), (
 SDL_X11_SYM(int, XIBarrierReleasePointer,(Display* a,  int b, PointerBarrier c, BarrierEventID d), (a,b,c,d), return) /* this is actually Xinput2 */
 SDL_X11_SYM(Status, XFixesQueryVersion,(Display* a, int* b, int* c), (a,b,c), return)
 SDL_X11_SYM(Status, XFixesSelectSelectionInput, (Display* a, Window b, Atom c, unsigned long d), (a,b,c,d), return)
+SDL_X11_SYM(XserverRegion, XFixesCreateRegion, (Display* a, XRectangle* b, int c), (a,b,c), return)
+SDL_X11_SYM(void, XFixesDestroyRegion, (Display* a, XserverRegion b), (a,b),)
+#endif
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+SDL_X11_MODULE(XPRESENT)
+SDL_X11_SYM(Bool, XPresentQueryExtension, (Display* a, int* b, int* c, int* d), (a,b,c,d), return)
+SDL_X11_SYM(Status, XPresentQueryVersion, (Display* a, int* b, int* c), (a,b,c), return)
+SDL_X11_SYM(void, XPresentPixmap, (Display* a, Window b, Pixmap c, uint32_t d, XserverRegion e, XserverRegion f, int g, int h, RRCrtc i, XSyncFence j, XSyncFence k, uint32_t l, uint64_t m, uint64_t n, uint64_t o, XPresentNotify* p, int q), (a,b,c,d,e,f,g,h,i,j,k,l,m,n,o,p,q),)
+SDL_X11_SYM(XID, XPresentSelectInput, (Display* a, Window b, unsigned c), (a,b,c), return)
+SDL_X11_SYM(void, XPresentFreeInput, (Display* a, Window b, XID c), (a,b,c),)
 #endif
 
 #ifdef SDL_VIDEO_DRIVER_X11_SUPPORTS_GENERIC_EVENTS
@@ -224,6 +235,9 @@ SDL_X11_SYM(Status,XShmPutImage,(Display* a,Drawable b,GC c,XImage* d,int e,int
 SDL_X11_SYM(XImage*,XShmCreateImage,(Display* a,Visual* b,unsigned int c,int d,char* e,XShmSegmentInfo* f,unsigned int g,unsigned int h),(a,b,c,d,e,f,g,h),return)
 SDL_X11_SYM(Pixmap,XShmCreatePixmap,(Display *a,Drawable b,char* c,XShmSegmentInfo* d, unsigned int e, unsigned int f, unsigned int g),(a,b,c,d,e,f,g),return)
 SDL_X11_SYM(Bool,XShmQueryExtension,(Display* a),(a),return)
+SDL_X11_SYM(int,XShmGetEventBase,(Display* a),(a),return)
+SDL_X11_SYM(Bool,XShmQueryVersion,(Display* a,int* b,int* c,Bool* d),(a,b,c,d),return)
+SDL_X11_SYM(int,XShmPixmapFormat,(Display* a),(a),return)
 #endif
 
 /*
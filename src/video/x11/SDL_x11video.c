@@ -37,6 +37,7 @@
 #include "SDL_x11touch.h"
 #include "SDL_x11xinput2.h"
 #include "SDL_x11xfixes.h"
+#include "SDL_x11present.h"
 #include "SDL_x11messagebox.h"
 
 #ifdef SDL_VIDEO_OPENGL_EGL
@@ -267,6 +268,9 @@ static SDL_VideoDevice *X11_CreateDevice(void)
     device->SetWindowHitTest = X11_SetWindowHitTest;
     device->AcceptDragAndDrop = X11_AcceptDragAndDrop;
     device->FlashWindow = X11_FlashWindow;
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    device->GetWindowPresentFeedback = X11_GetWindowPresentFeedback;
+#endif
 
 #ifdef SDL_VIDEO_DRIVER_X11_XFIXES
     device->SetWindowMouseRect = X11_SetWindowMouseRect;
@@ -299,6 +303,9 @@ static SDL_VideoDevice *X11_CreateDevice(void)
         device->GL_SetSwapInterval = X11_GLES_SetSwapInterval;
         device->GL_GetSwapInterval = X11_GLES_GetSwapInterval;
         device->GL_SwapWindow = X11_GLES_SwapWindow;
+        device->GL_SwapWindowWithDamage = X11_GLES_SwapWindowWithDamage;
+        device->GL_GetBufferAge = X11_GLES_GetBufferAge;
+        device->GL_SetDamageRegion = X11_GLES_SetDamageRegion;
         device->GL_DeleteContext = X11_GLES_DeleteContext;
 #ifdef SDL_VIDEO_OPENGL_GLX
     }
@@ -473,6 +480,10 @@ int X11_VideoInit(_THIS)
     X11_InitXfixes(_this);
 #endif /* SDL_VIDEO_DRIVER_X11_XFIXES */
 
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    X11_InitPresent(_this);
+#endif /* SDL_VIDEO_DRIVER_X11_XPRESENT */
+
 #ifndef X_HAVE_UTF8_STRING
 #warning X server does not support UTF8_STRING, a feature introduced in 2000! This is likely to become a hard error in a future libSDL2.
 #endif
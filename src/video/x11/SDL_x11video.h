@@ -138,6 +138,14 @@ typedef struct SDL_VideoData
 
     int xrandr_event_base;
 
+#ifndef NO_SHARED_MEMORY
+    int shm_completion_event;
+#endif
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    int present_opcode;
+#endif
+
 #ifdef SDL_VIDEO_DRIVER_X11_HAS_XKBKEYCODETOKEYSYM
     XkbDescPtr xkb;
 #endif
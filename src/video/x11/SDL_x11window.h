@@ -33,6 +33,28 @@
 #include <EGL/egl.h>
 #endif
 
+#ifndef NO_SHARED_MEMORY
+/* The window framebuffer is presented from up to this many shared memory
+   segments, so the next frame can be copied while the server reads the last */
+#define X11_FRAMEBUFFER_SHM_SEGMENTS 3
+
+typedef struct
+{
+    XShmSegmentInfo shminfo;
+    XImage *ximage;
+    int pending;    /* XShmPutImage calls without a ShmCompletion yet */
+    SDL_Rect stale; /* Bounds of what changed since the segment was last written */
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    Pixmap pixmap;  /* Shared pixmap for XPresentPixmap, idle again after PresentIdleNotify */
+#endif
+} X11_ShmSegment;
+#endif
+
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+/* How many frames of present feedback are kept for the application */
+#define X11_PRESENT_FEEDBACK_FRAMES 16
+#endif
+
 typedef enum
 {
     PENDING_FOCUS_NONE,
@@ -49,7 +71,9 @@ typedef struct
 #ifndef NO_SHARED_MEMORY
     /* MIT shared memory extension information */
     SDL_bool use_mitshm;
-    XShmSegmentInfo shminfo;
+    X11_ShmSegment shm_segments[X11_FRAMEBUFFER_SHM_SEGMENTS];
+    int num_shm_segments;
+    Uint8 *shm_pixels;
 #endif
     XImage *ximage;
     GC gc;
@@ -78,6 +102,16 @@ typedef struct
     PointerBarrier barrier[4];
     SDL_Rect barrier_rect;
 #endif /* SDL_VIDEO_DRIVER_X11_XFIXES */
+#ifdef SDL_VIDEO_DRIVER_X11_XPRESENT
+    SDL_bool use_present;
+    XID present_eid;
+    Uint32 present_serial;
+    Uint64 present_frames;
+    SDL_bool present_feedback_enabled;
+    SDL_WindowPresentFeedback present_feedback[X11_PRESENT_FEEDBACK_FRAMES];
+    int present_feedback_head;
+    int present_feedback_count;
+#endif /* SDL_VIDEO_DRIVER_X11_XPRESENT */
 } SDL_WindowData;
 
 extern void X11_SetNetWMState(_THIS, Window xwindow, Uint32 flags);